@@ -55,8 +55,10 @@ main1 hsOrC what tgtdir = case map toLower what of
 
   "curves" -> do Gen.generate_curves_proj            hsOrC tgtdir 
                  Gen.generate_curves_jac             hsOrC tgtdir 
+                 Gen.generate_curves_xyzz            hsOrC tgtdir 
                  Gen.generate_curves_affine          hsOrC tgtdir 
                  Gen.generate_curves_pairing         hsOrC tgtdir 
+                 Gen.generate_curves_gt              hsOrC tgtdir 
 
   "poly"   -> do Gen.generate_curves_poly            hsOrC tgtdir
 
@@ -86,8 +88,10 @@ mainAllWhich hsOrC tgtdir = do
 
   Gen.generate_curves_proj            hsOrC tgtdir 
   Gen.generate_curves_jac             hsOrC tgtdir 
+  Gen.generate_curves_xyzz            hsOrC tgtdir 
   Gen.generate_curves_affine          hsOrC tgtdir 
   Gen.generate_curves_pairing         hsOrC tgtdir 
+  Gen.generate_curves_gt              hsOrC tgtdir 
 
   Gen.generate_curves_poly            hsOrC tgtdir
   Gen.generate_curves_array           hsOrC tgtdir
@@ -0,0 +1,217 @@
+-- | Cofactor clearing, that is, mapping curve points into the prime-order subgroup.
+--
+-- We multiply by an \"effective cofactor\" @h_eff@ (a multiple of the cofactor
+-- coprime to the subgroup order, as in RFC 9380), chosen so that it can be
+-- computed much faster than a scalar multiplication by the cofactor itself:
+--
+-- * BLS12, G1: multiplication by @1-x@ (Wahby-Boneh)
+--
+-- * BLS12, G2: the method of Budroni-Pintore, using the endomorphism @psi@:
+--   @h_eff*P = [x^2-x-1]P + [x-1]psi(P) + psi^2(2P)@
+--
+-- * BN, G2: @[h]P = [t](P + psi(P)) - P - psi^2(P)@, as @psi^2 - [t]psi + [p] = 0@
+--   and @h = p - 1 + t@
+--
+-- * otherwise: scalar multiplication by the cofactor (or nothing if it is 1)
+--
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.Cofactor where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Zikkurat.CodeGen.Misc
+
+import Zikkurat.CodeGen.Curve.Params
+
+--------------------------------------------------------------------------------
+
+data ClearMethod
+  = ClearTrivial                       -- ^ the cofactor is 1
+  | ClearScalar   Integer              -- ^ scalar multiplication by the cofactor
+  | ClearBLS12_G1 Integer              -- ^ multiplication by @1-x@
+  | ClearBLS12_G2 Integer Integer      -- ^ Budroni-Pintore (with @x@ and the cofactor)
+  | ClearBN_G2    Integer Integer      -- ^ using the trace of Frobenius (with @x@ and the cofactor)
+  deriving Show
+
+clearMethod :: XCurve -> ClearMethod
+clearMethod xcurve = case xcurve of
+  Left  (Curve1{..}) -> case curveFamily of
+    _ | cofactor == 1           -> ClearTrivial
+    Just (BLS12 x)              -> ClearBLS12_G1 x
+    _                           -> ClearScalar cofactor
+  Right (Curve12 (Curve1{..}) (Curve2{..})) -> case (curveFamily, g2_psiCoeffs) of
+    _ | g2_cofactor == 1        -> ClearTrivial
+    (Just (BLS12 x) , Just _)   -> ClearBLS12_G2 x g2_cofactor
+    (Just (BN    x) , Just _)   -> ClearBN_G2    x g2_cofactor
+    _                           -> ClearScalar g2_cofactor
+
+-- | @clear_cofactor@ is the multiplication by this scalar
+effectiveCofactor :: XCurve -> Integer
+effectiveCofactor xcurve = case clearMethod xcurve of
+  ClearTrivial        -> 1
+  ClearScalar   h     -> h
+  ClearBLS12_G1 x     -> 1 - x
+  ClearBLS12_G2 x h   -> 3 * (x^2 - 1) * h
+  ClearBN_G2    _ h   -> h
+
+-- | The parameter @x@ of a BLS12 curve (we have a fast multiplication by it)
+blsParamX :: XCurve -> Maybe Integer
+blsParamX xcurve = case curveFamily (extractCurve1 xcurve) of
+  Just (BLS12 x) -> Just x
+  _              -> Nothing
+
+-- | The coefficients of @psi@, on G2 only
+psiCoeffs :: XCurve -> Maybe (I2,I2)
+psiCoeffs xcurve = case xcurve of
+  Left  _                  -> Nothing
+  Right (Curve12 _ curve2) -> g2_psiCoeffs curve2
+
+--------------------------------------------------------------------------------
+
+cofactor_c_header :: XCurve -> CodeGenParams -> Code
+cofactor_c_header xcurve (CodeGenParams{..}) =
+  [ ""
+  , "extern void " ++ prefix ++ "clear_cofactor( const uint64_t *src , uint64_t *tgt );"
+  ] ++
+  (case psiCoeffs xcurve of
+    Nothing -> []
+    Just _  -> [ "extern void " ++ prefix ++ "psi           ( const uint64_t *src , uint64_t *tgt );" ]
+  ) ++
+  (case blsParamX xcurve of
+    Nothing -> []
+    Just _  -> [ "extern void " ++ prefix ++ "scl_by_x      ( const uint64_t *src , uint64_t *tgt );" ]
+  )
+
+--------------------------------------------------------------------------------
+
+c_cofactor :: XCurve -> CodeGenParams -> Code
+c_cofactor xcurve cgparams@(CodeGenParams{..}) =
+  [ "//------------------------------------------------------------------------------"
+  , "// cofactor clearing"
+  , ""
+  ] ++
+  (case psiCoeffs xcurve of
+    Nothing -> []
+    Just cs -> c_psi (curveFp $ extractCurve1 xcurve) cs cgparams ++ [""]
+  ) ++
+  (case clearMethod xcurve of
+    ClearBN_G2 x _ ->
+      [ "// the trace of Frobenius t = 6x^2 + 1 = " ++ show (6*x^2+1)
+      , mkConst (nwords (6*x^2+1)) (prefix ++ "frobenius_trace") (6*x^2+1)
+      , ""
+      ]
+    _ -> []
+  ) ++
+  (case blsParamX xcurve of
+    Nothing -> []
+    Just x  -> c_scl_by_x x cgparams ++ [""]
+  ) ++
+  [ "// maps a curve point into the subgroup " ++ typeName ++ ", by multiplying with"
+  , "// the effective cofactor h_eff = " ++ show (effectiveCofactor xcurve)
+  , "void " ++ prefix ++ "clear_cofactor( const uint64_t *src , uint64_t *tgt ) {"
+  ] ++
+  (case clearMethod xcurve of
+    ClearTrivial ->
+      [ "  " ++ prefix ++ "copy( src, tgt );             // the cofactor is 1"
+      ]
+    ClearScalar h ->
+      [ "  " ++ prefix ++ "scl_generic( " ++ prefix ++ "cofactor, src, tgt, " ++ show (nwords h) ++ " );"
+      ]
+    ClearBLS12_G1 _ ->
+      [ "  // h_eff = 1 - x; this is not a multiple of the cofactor, but kills the"
+      , "  // whole cofactor part of the group (see RFC 9380, section 8.8.1)"
+      , "  uint64_t t1[3*NLIMBS_P];"
+      , "  " ++ prefix ++ "scl_by_x( src, t1 );"
+      , "  " ++ prefix ++ "sub( src, t1, tgt );"
+      ]
+    ClearBLS12_G2 _ _ ->
+      [ "  // Budroni-Pintore: h_eff*P = [x^2-x-1]P + [x-1]psi(P) + psi^2(2P)"
+      , "  // (this is the same as in appendix G.3 of RFC 9380)"
+      , "  uint64_t t1[3*NLIMBS_P];"
+      , "  uint64_t t2[3*NLIMBS_P];"
+      , "  uint64_t t3[3*NLIMBS_P];"
+      , "  " ++ prefix ++ "scl_by_x( src, t1 );             // t1 = [x]P"
+      , "  " ++ prefix ++ "psi( src, t2 );                  // t2 = psi(P)"
+      , "  " ++ prefix ++ "dbl( src, t3 );"
+      , "  " ++ prefix ++ "psi( t3, t3 );"
+      , "  " ++ prefix ++ "psi( t3, t3 );                   // t3 = psi^2(2P)"
+      , "  " ++ prefix ++ "sub_inplace( t3, t2 );"
+      , "  " ++ prefix ++ "add_inplace( t2, t1 );"
+      , "  " ++ prefix ++ "scl_by_x( t2, t2 );              // t2 = [x^2]P + [x]psi(P)"
+      , "  " ++ prefix ++ "add_inplace( t3, t2 );"
+      , "  " ++ prefix ++ "sub_inplace( t3, t1 );"
+      , "  " ++ prefix ++ "sub( t3, src, tgt );"
+      ]
+    ClearBN_G2 x _ ->
+      [ "  // [h]P = [t](P + psi(P)) - P - psi^2(P), as h = p - 1 + t and psi^2 - [t]psi + [p] = 0"
+      , "  uint64_t t1[3*NLIMBS_P];"
+      , "  uint64_t t2[3*NLIMBS_P];"
+      , "  uint64_t t3[3*NLIMBS_P];"
+      , "  " ++ prefix ++ "psi( src, t1 );"
+      , "  " ++ prefix ++ "psi( t1, t2 );                   // t2 = psi^2(P)"
+      , "  " ++ prefix ++ "add_inplace( t1, src );"
+      , "  " ++ prefix ++ "scl_generic( " ++ prefix ++ "frobenius_trace, t1, t3, " ++ show (nwords (6*x^2+1)) ++ " );"
+      , "  " ++ prefix ++ "sub_inplace( t3, src );"
+      , "  " ++ prefix ++ "sub( t3, t2, tgt );"
+      ]
+  ) ++
+  [ "}"
+  ]
+  where
+    nwords h = max 1 (div (bitLength h + 63) 64)
+    bitLength n = if n <= 0 then 0 else 1 + bitLength (shiftR n 1)
+
+----------------------------------------
+
+-- | The endomorphism @psi@ of the twisted curve, in projective coordinates.
+-- On G2 it acts as multiplication by @p mod r@; on the whole twisted curve it
+-- satisfies @psi^2 - [t]psi + [p] = 0@, where @t@ is the trace of Frobenius
+c_psi :: Integer -> (I2,I2) -> CodeGenParams -> Code
+c_psi p (cx,cy) (CodeGenParams{..}) =
+  [ "// the endomorphism psi = untwist . Frobenius . twist of the twisted curve;"
+  , "// in affine coordinates psi(x,y) = (cx*conj(x), cy*conj(y))"
+  , mkConstFp2 nlimbs_p (prefix ++ "psi_cx") (toMontFp2 cx)
+  , mkConstFp2 nlimbs_p (prefix ++ "psi_cy") (toMontFp2 cy)
+  , ""
+  , "void " ++ prefix ++ "psi( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  " ++ prefix_p ++ "conjugate( X1, X3 );"
+  , "  " ++ prefix_p ++ "conjugate( Y1, Y3 );"
+  , "  " ++ prefix_p ++ "conjugate( Z1, Z3 );"
+  , "  " ++ prefix_p ++ "mul_inplace( X3, " ++ prefix ++ "psi_cx );"
+  , "  " ++ prefix_p ++ "mul_inplace( Y3, " ++ prefix ++ "psi_cy );"
+  , "}"
+  ]
+  where
+    toMontFp2 (a,b) = (toMont a, toMont b)
+    toMont x = mod ( 2^(64 * div nlimbs_p 2) * x ) p
+
+-- | Multiplication by the (at most 64 bit) curve parameter @x@ of BLS12 curves
+c_scl_by_x :: Integer -> CodeGenParams -> Code
+c_scl_by_x x (CodeGenParams{..})
+  | absx >= 2^64 = error "c_scl_by_x: the curve parameter x does not fit into 64 bits"
+  | otherwise    =
+    [ "// multiplication by the curve parameter x = " ++ show x
+    , "void " ++ prefix ++ "scl_by_x( const uint64_t *src , uint64_t *tgt ) {"
+    , "  const uint64_t absx = " ++ showHex64 (fromInteger absx) ++ ";"
+    , "  uint64_t acc[3*NLIMBS_P];"
+    , "  " ++ prefix ++ "copy( src, acc );"
+    , "  for(int i=" ++ show (topbit - 1) ++ "; i>=0; i--) {"
+    , "    " ++ prefix ++ "dbl_inplace( acc );"
+    , "    if ((absx >> i) & 1) { " ++ prefix ++ "add_inplace( acc, src ); }"
+    , "  }"
+    , if x < 0
+        then "  " ++ prefix ++ "neg( acc, tgt );"
+        else "  " ++ prefix ++ "copy( acc, tgt );"
+    , "}"
+    ]
+  where
+    absx   = abs x
+    topbit = integerLog2 absx
+    integerLog2 n = if n <= 1 then 0 else 1 + integerLog2 (shiftR n 1)
+
+--------------------------------------------------------------------------------
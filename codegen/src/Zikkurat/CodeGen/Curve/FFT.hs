@@ -36,6 +36,7 @@ fft_hs_binding (CodeGenParams{..}) =
   , ""
   , "{-# NOINLINE forwardFFT #-}"
   , "-- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)"
+  , "-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)"
   , "forwardFFT :: FFTSubgroup Fr -> FlatArray " ++ typeName ++ " -> FlatArray " ++ typeName
   , "forwardFFT sg (MkFlatArray n fptr2)" 
   , "  | fftSubgroupSize sg /= n   = error \"forwardNTT: subgroup size differs from the array size\""
@@ -49,6 +50,7 @@ fft_hs_binding (CodeGenParams{..}) =
   , "" 
   , "{-# NOINLINE inverseFFT #-}"
   , "-- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)"
+  , "-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)"
   , "inverseFFT :: FFTSubgroup Fr -> FlatArray " ++ typeName ++ " -> FlatArray " ++ typeName
   , "inverseFFT sg (MkFlatArray n fptr2)" 
   , "  | fftSubgroupSize sg /= n   = error \"inverseNTT: subgroup size differs from the array size\""
@@ -63,141 +65,216 @@ fft_hs_binding (CodeGenParams{..}) =
   ]
 
 c_group_fft :: XCurve -> CodeGenParams -> Code
-c_group_fft curve cgparams 
-  =  c_group_forward_fft       cgparams
-  ++ c_group_inverse_fft curve cgparams
-
-c_group_inverse_fft :: XCurve -> CodeGenParams -> Code
-c_group_inverse_fft xcurve (CodeGenParams{..}) = 
+c_group_fft xcurve (CodeGenParams{..}) = 
   [ ""
-  , "// -----------------------------------------------------------------------------"
-  , ""
-  , "// inverse of 2 (standard repr)"
+  , "// inverse of 2 (Montgomery repr)"
   , mkConst nlimbs_r (prefix ++ "oneHalf") (toMont half_std)
   , ""
-  , "void " ++ prefix ++ "fft_inverse_noalloc(int m, int tgt_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {"
+  ] ++
+  [ "#define GRP_NLIMBS (3*NLIMBS_P)"
+  , ""
+  , "// -----------------------------------------------------------------------------"
+  , "// FFT of group elements"
+  , "//"
+  , "// Iterative radix-2 decimation-in-time FFT, computed in place after a bit-reversal"
+  , "// permutation. The twiddle factors are precomputed once (in standard repr, as the"
+  , "// scalar multiplication needs that); the butterflies of each layer are independent,"
+  , "// so they are distributed among the worker threads."
+  , ""
+  , "// below this many butterflies per layer, we don't bother with multithreading"
+  , "#define FFT_PARALLEL_THRESHOLD 64"
   , ""
-  , "  if (m==0) {"
-  , "    " ++ prefix ++ "copy( src, tgt );"
-  , "    return;"
+  , "// computes the twiddle factors `[ gen^j | j <- [0..N/2-1] ]` (in standard repr), `m >= 1`"
+  , "void " ++ prefix ++ "fft_twiddles( int m, const uint64_t *gen, uint64_t *twiddles ) {"
+  , "  int halfN = (1<<(m-1));"
+  , "  uint64_t acc[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "set_one( acc );"
+  , "  for(int j=0; j<halfN; j++) {"
+  , "    " ++ prefix_r ++ "to_std( acc , twiddles + j*NLIMBS_R );"
+  , "    " ++ prefix_r ++ "mul_inplace( acc , gen );"
   , "  }"
+  , "}"
   , ""
-  , "  if (m==1) {"
-  , "    // N = 2"
-  , "    " ++ prefix ++ "add( src , src + GRP_NLIMBS , tgt                         );   // x + y"
-  , "    " ++ prefix ++ "sub( src , src + GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );   // x - y"
-  , "    " ++ prefix ++ "scl_Fr_mont( " ++ prefix ++ "oneHalf , tgt                         , tgt                         );      // (x + y)/2"
-  , "    " ++ prefix ++ "scl_Fr_mont( " ++ prefix ++ "oneHalf , tgt + tgt_stride*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );      // (x - y)/2"
-  , "    return;"
+  , "// reverses the lowest `m` bits of `i`"
+  , "int " ++ prefix ++ "fft_bit_reverse( int m, int i ) {"
+  , "  int j = 0;"
+  , "  for(int k=0; k<m; k++) {"
+  , "    j = (j << 1) | (i & 1);"
+  , "    i = i >> 1;"
   , "  }"
+  , "  return j;"
+  , "}"
   , ""
+  , "// copies `src` into `tgt` in bit-reversed order (`src == tgt` is allowed)"
+  , "void " ++ prefix ++ "fft_bit_reverse_permute( int m, const uint64_t *src, uint64_t *tgt ) {"
+  , "  int N = (1<<m);"
+  , "  if (src == tgt) {"
+  , "    uint64_t tmp[GRP_NLIMBS];"
+  , "    for(int i=0; i<N; i++) {"
+  , "      int j = " ++ prefix ++ "fft_bit_reverse( m, i );"
+  , "      if (i < j) {"
+  , "        " ++ prefix ++ "copy( tgt + i*GRP_NLIMBS , tmp );"
+  , "        " ++ prefix ++ "copy( tgt + j*GRP_NLIMBS , tgt + i*GRP_NLIMBS );"
+  , "        " ++ prefix ++ "copy( tmp                , tgt + j*GRP_NLIMBS );"
+  , "      }"
+  , "    }"
+  , "  }"
   , "  else {"
-  , "  "
-  , "    int N     = (1<< m   );"
-  , "    int halfN = (1<<(m-1));"
-  , ""
-  , "    uint64_t ginv[NLIMBS_R];"
-  , "    " ++ prefix_r ++ "inv( gen , ginv );  // gen^-1"
-  , ""
-  , "    uint64_t gpow[NLIMBS_R];    "
-  , "    " ++ prefix_r ++ "copy(" ++ prefix ++ "oneHalf , gpow);  // 1/2"
-  , "    for(int j=0; j<halfN; j++) {"
-  , "      " ++ prefix   ++ "add( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + j        *GRP_NLIMBS  );    // x + y"
-  , "      " ++ prefix   ++ "sub( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS  );    // x - y"
-  , "      " ++ prefix   ++ "scl_Fr_mont( " ++ prefix ++ "oneHalf , buf + j        *GRP_NLIMBS , buf + j        *GRP_NLIMBS );    // (x + y) /  2"
-  , "      " ++ prefix   ++ "scl_Fr_mont( gpow                    , buf + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS );    // (x - y) / (2*g^k)"
-  , "      " ++ prefix_r ++ "mul_inplace( gpow , ginv );      "
+  , "    for(int i=0; i<N; i++) {"
+  , "      " ++ prefix ++ "copy( src + i*GRP_NLIMBS , tgt + " ++ prefix ++ "fft_bit_reverse( m, i )*GRP_NLIMBS );"
   , "    }"
+  , "  }"
+  , "}"
   , ""
-  , "    " ++ prefix_r ++ "sqr( gen, gpow );  // gen^2"
-  , "    " ++ prefix ++ "fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf                    , buf + N*GRP_NLIMBS , tgt                         );"
-  , "    " ++ prefix ++ "fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf + halfN*GRP_NLIMBS , buf + N*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );"
+  , "typedef struct {"
+  , "  int m;                      // log2 of the size"
+  , "  int half;                   // half the block size of the current layer"
+  , "  int chunk;                  // number of butterflies per task"
+  , "  const uint64_t *twiddles;"
+  , "  uint64_t *buf;"
+  , "} " ++ prefix ++ "fft_layer_ctx_t;"
   , ""
+  , "// the butterflies `(u,v) -> (u + w*v, u - w*v)` with indices in `[ j*chunk , (j+1)*chunk )`"
+  , "// of a layer of the FFT. The blocks of this layer have size `2*half`, and the twiddle"
+  , "// factor for the `k`-th butterfly in a block is `w = gen^(k*N/(2*half))`"
+  , "void " ++ prefix ++ "fft_layer_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "fft_layer_ctx_t *c = (" ++ prefix ++ "fft_layer_ctx_t*) ctx;"
+  , "  int half   = c->half;"
+  , "  int halfN  = (1<<(c->m-1));"
+  , "  int stride = halfN / half;"
+  , "  int a = j * c->chunk;"
+  , "  int b = a + c->chunk;"
+  , "  if (b > halfN) { b = halfN; }"
+  , "  uint64_t tmp[GRP_NLIMBS];"
+  , "  for(int t=a; t<b; t++) {"
+  , "    int k = t & (half-1);"
+  , "    uint64_t *u = c->buf + (2*(t-k) + k)*GRP_NLIMBS;"
+  , "    uint64_t *v = u + half*GRP_NLIMBS;"
+  , "    if (k == 0) {"
+  , "      " ++ prefix ++ "copy( v , tmp );"
+  , "    }"
+  , "    else {"
+  , "      " ++ scl ++ "( c->twiddles + (k*stride)*NLIMBS_R , v , tmp );       // w*v"
+  , "    }"
+  , "    " ++ prefix ++ "sub( u , tmp , v );                                          // u - w*v"
+  , "    " ++ prefix ++ "add_inplace( u , tmp );                                      // u + w*v"
   , "  }"
   , "}"
-  , " "
-  , "// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]"
-  , "// `src` and `tgt` should be `N = 2^m` sized arrays of group elements"
-  , "// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation"
-  , "// NOTE: we normalize the results"
-  , "void " ++ prefix ++ "fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {"
-  , "  int N = (1<<m);"
-  , "  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );"
-  , "  assert( buf !=0 );"
-  , "  " ++ prefix ++ "fft_inverse_noalloc( m, 1, gen, src, buf, tgt );"
-  , "  free(buf);"
-  , "  for(int i=0; i<N; i++) { "
-  , "    " ++ prefix ++ "normalize_inplace( tgt + i*GRP_NLIMBS );"
+  , ""
+  , "// in-place FFT of `N = 2^m` group elements, given in bit-reversed order"
+  , "void " ++ prefix ++ "fft_inplace_noalloc( int m, const uint64_t *twiddles, uint64_t *buf ) {"
+  , "  if (m == 0) return;"
+  , "  int halfN = (1<<(m-1));"
+  , "  int T = parallel_get_num_threads();"
+  , "  " ++ prefix ++ "fft_layer_ctx_t ctx;"
+  , "  ctx.m        = m;"
+  , "  ctx.twiddles = twiddles;"
+  , "  ctx.buf      = buf;"
+  , "  for(int half=1; half<=halfN; half<<=1) {"
+  , "    ctx.half = half;"
+  , "    if ( (halfN < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {"
+  , "      ctx.chunk = halfN;"
+  , "      " ++ prefix ++ "fft_layer_task( &ctx, 0 );"
+  , "    }"
+  , "    else {"
+  , "      ctx.chunk = (halfN + T - 1) / T;"
+  , "      parallel_for( (halfN + ctx.chunk - 1) / ctx.chunk , " ++ prefix ++ "fft_layer_task, &ctx );"
+  , "    }"
   , "  }"
   , "}"
   , ""
-  , "// -----------------------------------------------------------------------------"
+  , "typedef struct {"
+  , "  int chunk;"
+  , "  int N;"
+  , "  const uint64_t *scalar;"
+  , "  uint64_t *buf;"
+  , "} " ++ prefix ++ "fft_scale_ctx_t;"
   , ""
-  ]
-  where
-    prime_r  = curveFr (extractCurve1 xcurve) 
-    half_std = div (prime_r + 1) 2                   -- (p+1)/2 = 1/2
-    toMont x = mod (2^(64*nlimbs_r) * x) prime_r     -- but we need Montgomery repr!
-
---------------------------------------------------------------------------------
-
-c_group_forward_fft :: CodeGenParams -> Code
-c_group_forward_fft (CodeGenParams{..}) = 
-  [ ""
-  , "#define GRP_NLIMBS (3*NLIMBS_P)"
-  , ""
-  , "// -----------------------------------------------------------------------------"
-  , ""
-  , "void " ++ prefix ++ "fft_forward_noalloc( int m, int src_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {"
-  , ""
-  , "  if (m==0) {"
-  , "    " ++ prefix ++ "copy( src, tgt );"
-  , "    return;"
+  , "void " ++ prefix ++ "fft_scale_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "fft_scale_ctx_t *c = (" ++ prefix ++ "fft_scale_ctx_t*) ctx;"
+  , "  int a = j * c->chunk;"
+  , "  int b = a + c->chunk;"
+  , "  if (b > c->N) { b = c->N; }"
+  , "  for(int i=a; i<b; i++) {"
+  , "    " ++ scl ++ "( c->scalar , c->buf + i*GRP_NLIMBS , c->buf + i*GRP_NLIMBS );"
   , "  }"
+  , "}"
   , ""
-  , "  if (m==1) {"
-  , "    // N = 2"
-  , "    " ++ prefix ++ "add( src , src + src_stride*GRP_NLIMBS , tgt              );    // x + y"
-  , "    " ++ prefix ++ "sub( src , src + src_stride*GRP_NLIMBS , tgt + GRP_NLIMBS );    // x - y"
-  , "    return;"
-  , "  }"
-  , ""
-  , "  else {"
-  , "  "
-  , "    int N     = (1<< m   );"
-  , "    int halfN = (1<<(m-1));"
-  , ""
-  , "    uint64_t gpow[NLIMBS_R];"
-  , "    " ++ prefix_r ++ "sqr( gen, gpow );  // gen^2"
-  , "    "
-  , "    " ++ prefix ++ "fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src                         , buf + N*GRP_NLIMBS , buf                    );"
-  , "    " ++ prefix ++ "fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src + src_stride*GRP_NLIMBS , buf + N*GRP_NLIMBS , buf + halfN*GRP_NLIMBS );"
-  , ""
-  , "    " ++ prefix_r ++ "set_one(gpow);"
-  , "    for(int j=0; j<halfN; j++) {"
-  , "      " ++ prefix ++ "scl_Fr_mont(gpow , buf + (j+halfN)*GRP_NLIMBS  , tgt +  j *GRP_NLIMBS );  //   g*v[k]"
-  , "      " ++ prefix ++ "neg ( tgt +  j       *GRP_NLIMBS ,        tgt + (j+halfN)*GRP_NLIMBS );   // - g*v[k]"
-  , "      " ++ prefix ++ "add_inplace( tgt +  j       *GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] + g*v[k]"
-  , "      " ++ prefix ++ "add_inplace( tgt + (j+halfN)*GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] - g*v[k]"
-  , "      " ++ prefix_r ++ "mul_inplace( gpow , gen );      "
-  , "    }"
+  , "// normalizes `N` points using a single inversion: first we convert them to affine"
+  , "// coordinates (which are then packed at the beginning of the buffer), then back"
+  , "void " ++ prefix ++ "fft_normalize( int N, uint64_t *buf ) {"
+  , "  " ++ prefix ++ "batch_to_affine( N, buf, buf );"
+  , "  for(int i=N-1; i>=0; i--) {"
+  , "    uint64_t tmp[2*NLIMBS_P];"
+  , "    memcpy( tmp, buf + i*2*NLIMBS_P, 8*2*NLIMBS_P );"
+  , "    " ++ prefix ++ "from_affine( tmp, buf + i*GRP_NLIMBS );"
   , "  }"
   , "}"
   , ""
   , "// forward FFT of group elements (convert from [L_k(tau)] to [tau^i])"
-  , "// `src` and `tgt` should be `N = 2^m` sized arrays of group elements"
+  , "// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)"
   , "// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)"
   , "// NOTE: we normalize the results"
+  , "// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r"
   , "void " ++ prefix ++ "fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {"
   , "  int N = (1<<m);"
-  , "  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );"
-  , "  assert( buf !=0 );"
-  , "  " ++ prefix ++ "fft_forward_noalloc( m, 1, gen, src, buf, tgt);"
-  , "  free(buf);"
-  , "  for(int i=0; i<N; i++) { "
-  , "    " ++ prefix ++ "normalize_inplace( tgt + i*GRP_NLIMBS );"
+  , "  " ++ prefix ++ "fft_bit_reverse_permute( m, src, tgt );"
+  , "  if (m > 0) {"
+  , "    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );"
+  , "    assert( twiddles != 0 );"
+  , "    " ++ prefix ++ "fft_twiddles( m, gen, twiddles );"
+  , "    " ++ prefix ++ "fft_inplace_noalloc( m, twiddles, tgt );"
+  , "    free(twiddles);"
   , "  }"
+  , "  " ++ prefix ++ "fft_normalize( N, tgt );"
   , "}"
   , ""
+  , "// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]"
+  , "// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)"
+  , "// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation"
+  , "// This is the forward FFT with `gen^-1`, followed by scaling with `1/N`"
+  , "// NOTE: we normalize the results"
+  , "// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r"
+  , "void " ++ prefix ++ "fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {"
+  , "  int N = (1<<m);"
+  , "  " ++ prefix ++ "fft_bit_reverse_permute( m, src, tgt );"
+  , "  if (m > 0) {"
+  , "    uint64_t ginv[NLIMBS_R];"
+  , "    " ++ prefix_r ++ "inv( gen , ginv );"
+  , "    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );"
+  , "    assert( twiddles != 0 );"
+  , "    " ++ prefix ++ "fft_twiddles( m, ginv, twiddles );"
+  , "    " ++ prefix ++ "fft_inplace_noalloc( m, twiddles, tgt );"
+  , "    free(twiddles);"
+  , ""
+  , "    // 1/N = (1/2)^m"
+  , "    uint64_t ninv_mont[NLIMBS_R];"
+  , "    uint64_t ninv[NLIMBS_R];"
+  , "    " ++ prefix_r ++ "pow_uint64( " ++ prefix ++ "oneHalf , m , ninv_mont );"
+  , "    " ++ prefix_r ++ "to_std( ninv_mont , ninv );"
+  , ""
+  , "    " ++ prefix ++ "fft_scale_ctx_t ctx;"
+  , "    ctx.N      = N;"
+  , "    ctx.scalar = ninv;"
+  , "    ctx.buf    = tgt;"
+  , "    int T = parallel_get_num_threads();"
+  , "    if ( (N < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {"
+  , "      ctx.chunk = N;"
+  , "      " ++ prefix ++ "fft_scale_task( &ctx, 0 );"
+  , "    }"
+  , "    else {"
+  , "      ctx.chunk = (N + T - 1) / T;"
+  , "      parallel_for( (N + ctx.chunk - 1) / ctx.chunk , " ++ prefix ++ "fft_scale_task, &ctx );"
+  , "    }"
+  , "  }"
+  , "  " ++ prefix ++ "fft_normalize( N, tgt );"
+  , "}"
   ]
-
+  where
+    prime_r  = curveFr (extractCurve1 xcurve) 
+    half_std = div (prime_r + 1) 2                   -- (p+1)/2 = 1/2
+    toMont x = mod (2^(64*nlimbs_r) * x) prime_r     -- but we need Montgomery repr!
+    -- the scalar multiplication used for the twiddles (GLV on G1)
+    scl = if hasGLV xcurve
+      then prefix ++ "scl_glv_Fr_std"
+      else prefix ++ "scl_Fr_std"
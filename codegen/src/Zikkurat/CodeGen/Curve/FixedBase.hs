@@ -0,0 +1,229 @@
+
+-- | Fixed-base scalar multiplication, using precomputed tables (Lim-Lee comb method)
+-- (used for multiplying the generators: key generation, blinding, trusted setups)
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.FixedBase where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Zikkurat.CodeGen.Misc
+
+import Zikkurat.CodeGen.Curve.Params
+
+--------------------------------------------------------------------------------
+-- * parameters of the comb
+
+-- | Number of teeth of the comb (the table index is this many bits)
+combTeeth :: Int
+combTeeth = 8
+
+-- | Number of tables (each one is the previous one shifted by 'combSpacing' bits)
+combTables :: Int
+combTables = 4
+
+-- | Number of rows of the bit matrix of the scalar (which is @64*nlimbs_r@ bits)
+combRows :: CodeGenParams -> Int
+combRows (CodeGenParams{..}) = div (64*nlimbs_r) combTeeth
+
+-- | Number of doubling steps
+combSpacing :: CodeGenParams -> Int
+combSpacing params = div (combRows params) combTables
+
+-- | Size of a precomputed table, in 64-bit words (the entries are affine points)
+combTableNWords :: CodeGenParams -> Int
+combTableNWords (CodeGenParams{..}) = combTables * (2^combTeeth - 1) * 2 * nlimbs_p
+
+--------------------------------------------------------------------------------
+
+comb_c_header :: CodeGenParams -> Code
+comb_c_header (CodeGenParams{..}) =
+  [ "extern int  " ++ prefix ++ "comb_table_nwords();"
+  , "extern void " ++ prefix ++ "comb_precompute ( const uint64_t *src , uint64_t *table );"
+  , "extern void " ++ prefix ++ "comb_scl_Fr_std ( const uint64_t *table , const uint64_t *kst , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "comb_scl_Fr_mont( const uint64_t *table , const uint64_t *kst , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "scl_gen_Fr_std  ( const uint64_t *kst , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "scl_gen_Fr_mont ( const uint64_t *kst , uint64_t *tgt );"
+  ]
+
+--------------------------------------------------------------------------------
+
+comb_hs_binding :: CodeGenParams -> Code
+comb_hs_binding params@(CodeGenParams{..}) =
+  [ ""
+  , "foreign import ccall unsafe \"" ++ prefix ++ "comb_precompute\" c_" ++ prefix ++ "comb_precompute :: Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "comb_scl_Fr_mont\" c_" ++ prefix ++ "comb_scl_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "scl_gen_Fr_mont\" c_" ++ prefix ++ "scl_gen_Fr_mont :: Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "-- | Precomputed table for fixed-base scalar multiplication (see 'combTable')"
+  , "newtype CombTable = MkCombTable (ForeignPtr Word64)"
+  , ""
+  , "{-# NOINLINE combTable #-}"
+  , "-- | Precomputes the table for fast scalar multiplications of a fixed base point."
+  , "-- This costs about as much as 20-30 scalar multiplications (and uses " ++ show (div (8 * combTableNWords params) 1024) ++ " kilobytes),"
+  , "-- so it only pays off when the same base is multiplied many times"
+  , "combTable :: " ++ typeName ++ " -> CombTable"
+  , "combTable (Mk" ++ typeName ++ " fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray " ++ show (combTableNWords params)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_" ++ prefix ++ "comb_precompute ptr1 ptr2"
+  , "  return (MkCombTable fptr2)"
+  , ""
+  , "{-# NOINLINE sclComb #-}"
+  , "-- | Scalar multiplication of a fixed base point, using its precomputed table"
+  , "sclComb :: CombTable -> Fr -> " ++ typeName
+  , "sclComb (MkCombTable fptr1) (MkFr fptr2) = unsafePerformIO $ do"
+  , "  fptr3 <- mallocForeignPtrArray " ++ show (3*nlimbs_p)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "        c_" ++ prefix ++ "comb_scl_Fr_mont ptr1 ptr2 ptr3"
+  , "  return (Mk" ++ typeName ++ " fptr3)"
+  , ""
+  , "{-# NOINLINE sclGen #-}"
+  , "-- | Multiplies the subgroup generator by a scalar (using a table which is"
+  , "-- precomputed on first use). This is much faster than @sclFr k gen" ++ typeName ++ "@"
+  , "sclGen :: Fr -> " ++ typeName
+  , "sclGen (MkFr fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray " ++ show (3*nlimbs_p)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_" ++ prefix ++ "scl_gen_Fr_mont ptr1 ptr2"
+  , "  return (Mk" ++ typeName ++ " fptr2)"
+  , ""
+  ]
+
+--------------------------------------------------------------------------------
+
+c_comb :: CodeGenParams -> Code
+c_comb params@(CodeGenParams{..}) =
+  [ "//------------------------------------------------------------------------------"
+  , "// fixed-base scalar multiplication (Lim-Lee comb method)"
+  , "//"
+  , "// The scalar is written as a COMB_TEETH x COMB_ROWS bit matrix, that is"
+  , "//"
+  , "//   k = sum_{i,j} k[i*COMB_ROWS+j] * 2^(i*COMB_ROWS+j)"
+  , "//"
+  , "// and the column `j` is a COMB_TEETH bit number `u`. The first table contains"
+  , "// the points `sum_i u_i * 2^(i*COMB_ROWS) * P` for all nonzero `u`; the table `t`"
+  , "// is the first one multiplied by `2^(t*COMB_SPACING)`. Then a scalar multiplication"
+  , "// is only COMB_SPACING-1 doublings and COMB_ROWS mixed additions."
+  , ""
+  , "#define COMB_TEETH   " ++ show combTeeth
+  , "#define COMB_ROWS    " ++ show (combRows params)
+  , "#define COMB_TABLES  " ++ show combTables
+  , "#define COMB_SPACING " ++ show (combSpacing params)
+  , "#define COMB_ENTRIES ((1<<COMB_TEETH) - 1)"
+  , ""
+  , "#define COMB_TABLE_NWORDS (COMB_TABLES*COMB_ENTRIES*2*NLIMBS_P)"
+  , "#define COMB_ENTRY(table,t,u) ((table) + ((t)*COMB_ENTRIES + (u)-1)*(2*NLIMBS_P))"
+  , "#define COMB_TMP(t,u)         (tmp   + ((t)*COMB_ENTRIES + (u)-1)*(3*NLIMBS_P))"
+  , ""
+  , "// the size of a precomputed table, in 64-bit words"
+  , "int " ++ prefix ++ "comb_table_nwords() {"
+  , "  return COMB_TABLE_NWORDS;"
+  , "}"
+  , ""
+  , "// precomputes the table (of COMB_TABLE_NWORDS words) for the base point `src`"
+  , "void " ++ prefix ++ "comb_precompute(const uint64_t *src, uint64_t *table) {"
+  , "  uint64_t *tmp = malloc( 8*3*NLIMBS_P * COMB_TABLES*COMB_ENTRIES );"
+  , "  assert( tmp != 0 );"
+  , ""
+  , "  // the teeth: 2^(i*COMB_ROWS) * P"
+  , "  uint64_t teeth[COMB_TEETH*3*NLIMBS_P];"
+  , "  " ++ prefix ++ "copy( src, teeth );"
+  , "  for(int i=1; i<COMB_TEETH; i++) {"
+  , "    " ++ prefix ++ "copy( teeth + (i-1)*3*NLIMBS_P , teeth + i*3*NLIMBS_P );"
+  , "    for(int s=0; s<COMB_ROWS; s++) { " ++ prefix ++ "dbl_inplace( teeth + i*3*NLIMBS_P ); }"
+  , "  }"
+  , ""
+  , "  // first table: COMB_TMP(0,u) = COMB_TMP(0,u-lowbit(u)) + teeth[ctz(u)]"
+  , "  for(int u=1; u<=COMB_ENTRIES; u++) {"
+  , "    int i = 0;"
+  , "    while (!((u >> i) & 1)) { i++; }"
+  , "    int v = u & (u-1);"
+  , "    if (v == 0) {"
+  , "      " ++ prefix ++ "copy( teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );"
+  , "    }"
+  , "    else {"
+  , "      " ++ prefix ++ "add( COMB_TMP(0,v) , teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );"
+  , "    }"
+  , "  }"
+  , ""
+  , "  // the other tables: COMB_TMP(t,u) = 2^COMB_SPACING * COMB_TMP(t-1,u)"
+  , "  for(int t=1; t<COMB_TABLES; t++) {"
+  , "    for(int u=1; u<=COMB_ENTRIES; u++) {"
+  , "      " ++ prefix ++ "copy( COMB_TMP(t-1,u) , COMB_TMP(t,u) );"
+  , "      for(int s=0; s<COMB_SPACING; s++) { " ++ prefix ++ "dbl_inplace( COMB_TMP(t,u) ); }"
+  , "    }"
+  , "  }"
+  , ""
+  , "  " ++ prefix ++ "batch_to_affine( COMB_TABLES*COMB_ENTRIES , tmp , table );"
+  , "  free(tmp);"
+  , "}"
+  , ""
+  , "// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,"
+  , "// and `expo` is in Fr *in standard repr*"
+  , "void " ++ prefix ++ "comb_scl_Fr_std(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {"
+  , "  uint64_t acc[3*NLIMBS_P];"
+  , "  " ++ prefix ++ "set_infinity( acc );"
+  , "  for(int j=COMB_SPACING-1; j>=0; j--) {"
+  , "    if (j < COMB_SPACING-1) { " ++ prefix ++ "dbl_inplace( acc ); }"
+  , "    for(int t=0; t<COMB_TABLES; t++) {"
+  , "      int col = t*COMB_SPACING + j;"
+  , "      int u   = 0;"
+  , "      for(int i=0; i<COMB_TEETH; i++) {"
+  , "        int b = i*COMB_ROWS + col;"
+  , "        u |= ((expo[b>>6] >> (b&63)) & 1) << i;"
+  , "      }"
+  , "      if (u) { " ++ prefix ++ "madd_inplace( acc , COMB_ENTRY(table,t,u) ); }"
+  , "    }"
+  , "  }"
+  , "  " ++ prefix ++ "copy( acc , tgt );"
+  , "}"
+  , ""
+  , "// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,"
+  , "// and `expo` is in Fr *in Montgomery repr*"
+  , "void " ++ prefix ++ "comb_scl_Fr_mont(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {"
+  , "  uint64_t expo_std[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "to_std(expo, expo_std);"
+  , "  " ++ prefix   ++ "comb_scl_Fr_std(table, expo_std, tgt);"
+  , "}"
+  , ""
+  , "// the table for the subgroup generator is computed on first use"
+  , "uint64_t " ++ prefix ++ "gen_comb_table[COMB_TABLE_NWORDS];"
+  , "int      " ++ prefix ++ "gen_comb_table_ready = 0;"
+  , ""
+  , "void " ++ prefix ++ "gen_comb_table_init() {"
+  , "  " ++ prefix ++ "comb_precompute( " ++ prefix ++ "gen_" ++ typeName ++ " , " ++ prefix ++ "gen_comb_table );"
+  , "}"
+  , ""
+  , "// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in standard repr*"
+  , "void " ++ prefix ++ "scl_gen_Fr_std(const uint64_t *expo, uint64_t *tgt) {"
+  , "  parallel_call_once( &" ++ prefix ++ "gen_comb_table_ready , " ++ prefix ++ "gen_comb_table_init );"
+  , "  " ++ prefix ++ "comb_scl_Fr_std( " ++ prefix ++ "gen_comb_table , expo , tgt );"
+  , "}"
+  , ""
+  , "// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in Montgomery repr*"
+  , "void " ++ prefix ++ "scl_gen_Fr_mont(const uint64_t *expo, uint64_t *tgt) {"
+  , "  uint64_t expo_std[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "to_std(expo, expo_std);"
+  , "  " ++ prefix   ++ "scl_gen_Fr_std(expo_std, tgt);"
+  , "}"
+  , ""
+  , "#undef COMB_TMP"
+  , "#undef COMB_ENTRY"
+  , "#undef COMB_TABLE_NWORDS"
+  , "#undef COMB_ENTRIES"
+  , "#undef COMB_SPACING"
+  , "#undef COMB_TABLES"
+  , "#undef COMB_ROWS"
+  , "#undef COMB_TEETH"
+  ]
+
+--------------------------------------------------------------------------------
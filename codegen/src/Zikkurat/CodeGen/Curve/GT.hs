@@ -0,0 +1,588 @@
+
+-- | Arithmetic in the target group GT of the pairing (the subgroup of order @r@
+-- of the cyclotomic subgroup of Fp12): fast exponentiation, membership tests,
+-- and torus-based compression.
+--
+-- See:
+--
+-- * Galbraith, Scott: \"Exponentiation in pairing-friendly groups using homomorphisms\"
+--
+-- * Rubin, Silverberg: \"Torus-based cryptography\"
+--
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.GT where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Control.Monad
+import System.FilePath
+
+import Zikkurat.CodeGen.Curve.Params
+import Zikkurat.CodeGen.Curve.Pairing ( PairingParams(..) )
+import Zikkurat.CodeGen.Misc
+
+--------------------------------------------------------------------------------
+
+-- | The endomorphism @phi@ of GT (a Frobenius twist), acting as exponentiation
+-- by @lambda@; and the parameters of the base-@lambda@ decomposition of exponents
+c_gt_constants :: PairingParams -> Code
+c_gt_constants params@(PairingParams{..}) = case c_curve of
+  "bn128" ->
+    [ "// On GT, the Frobenius acts as exponentiation by `p = lambda0 (mod r)`,"
+    , "// where `lambda0 = 6*x^2` (x being the BN parameter)."
+    , "// We use `phi = frobenius` and `lambda = lambda0`, which is 127 bits."
+    , ""
+    , "#define GT_NDIGITS    2"
+    , "#define GT_DIGIT_BITS 128"
+    , ""
+    , "const uint64_t " ++ c_curve ++ "_gt_lambda[2] = { 0xf83e9682e87cfd46, 0x6f4d8248eeb859fb };"
+    , ""
+    , "void " ++ c_curve ++ "_gt_phi(const uint64_t *src, uint64_t *tgt) {"
+    , "  " ++ c_curve ++ "_Fp12_mont_frobenius( src , tgt );"
+    , "}"
+    ]
+  "bls12_381" ->
+    [ "// On GT, the Frobenius acts as exponentiation by `p = lambda0 (mod r)`,"
+    , "// where `lambda0 = x` is the (negative) BLS parameter. We use"
+    , "// `phi = conjugate . frobenius` and `lambda = -x`, which is 64 bits."
+    , ""
+    , "#define GT_NDIGITS    4"
+    , "#define GT_DIGIT_BITS 64"
+    , ""
+    , "const uint64_t " ++ c_curve ++ "_gt_lambda[2] = { 0xd201000000010000, 0 };"
+    , ""
+    , "void " ++ c_curve ++ "_gt_phi(const uint64_t *src, uint64_t *tgt) {"
+    , "  " ++ c_curve ++ "_Fp12_mont_frobenius( src , tgt );"
+    , "  " ++ c_curve ++ "_Fp12_mont_conjugate_inplace( tgt );"
+    , "}"
+    ]
+
+--------------------------------------------------------------------------------
+
+-- | Exponentiation by @lambda@, for cyclotomic elements
+c_gt_pow_lambda :: PairingParams -> Code
+c_gt_pow_lambda params@(PairingParams{..}) = case c_curve of
+  "bn128" ->
+    [ "// f^lambda = f^(6*x^2), for cyclotomic f"
+    , "void " ++ c_curve ++ "_gt_pow_lambda(const uint64_t *src, uint64_t *tgt) {"
+    , "  " ++ c_curve ++ "_gt_pow_gen( src , " ++ c_curve ++ "_gt_lambda , tgt , 2 );"
+    , "}"
+    ]
+  "bls12_381" ->
+    [ "// f^lambda = f^(-x), for cyclotomic f (lambda has very low Hamming weight)"
+    , "void " ++ c_curve ++ "_gt_pow_lambda(const uint64_t *src, uint64_t *tgt) {"
+    , "  " ++ c_curve ++ "_pairing_cyclotomic_pow_uint64_compressed( src , " ++ c_curve ++ "_gt_lambda[0] , tgt );"
+    , "}"
+    ]
+
+--------------------------------------------------------------------------------
+
+c_code :: PairingParams -> Code
+c_code params@(PairingParams{..}) =
+  [ "#include \"stdint.h\""
+  , "#include \"stdlib.h\""
+  , "#include \"string.h\""
+  , "#include \"assert.h\""
+  , ""
+  , "#include \"curves/fields/mont/" ++ c_curve ++ "_Fr_mont.h\""
+  , "#include \"curves/fields/mont/" ++ c_curve ++ "_Fp_mont.h\""
+  , "#include \"curves/fields/mont/" ++ c_curve ++ "_Fp2_mont.h\""
+  , "#include \"curves/fields/mont/" ++ c_curve ++ "_Fp6_mont.h\""
+  , "#include \"curves/fields/mont/" ++ c_curve ++ "_Fp12_mont.h\""
+  , ""
+  , "#include \"curves/pairing/" ++ c_curve ++ "_pairing.h\""
+  , ""
+  , "//------------------------------------------------------------------------------"
+  , ""
+  , "#define NWORDS_FR   4"
+  , "#define NWORDS_FP   " ++ show (   nwords_fp)
+  , "#define NWORDS_FP2  " ++ show ( 2*nwords_fp)
+  , "#define NWORDS_FP6  " ++ show ( 6*nwords_fp)
+  , "#define NWORDS_FP12 " ++ show (12*nwords_fp)
+  , ""
+  , "//------------------------------------------------------------------------------"
+  , ""
+  ] ++
+  c_gt_constants params ++
+  [ ""
+  ] ++
+  c_gt_pow params ++
+  [ ""
+  ] ++
+  c_gt_pow_lambda params ++
+  [ ""
+  ] ++
+  c_gt_membership params ++
+  [ ""
+  ] ++
+  c_gt_compression params
+
+--------------------------------------------------------------------------------
+
+c_gt_pow :: PairingParams -> Code
+c_gt_pow params@(PairingParams{..}) = 
+  [ "//------------------------------------------------------------------------------"
+  , "// GLS-style exponentiation"
+  , ""
+  , "// Divides the `n`-word number `a` by `lambda` (bitwise long division)."
+  , "// The quotient overwrites `a`, the remainder (two words) goes into `rem`."
+  , "// Note: `lambda < 2^127`, so the shifted remainder always fits into two words."
+  , "void " ++ c_curve ++ "_gt_divmod_lambda(int n, uint64_t *a, uint64_t *rem) {"
+  , "  const uint64_t l0 = " ++ c_curve ++ "_gt_lambda[0];"
+  , "  const uint64_t l1 = " ++ c_curve ++ "_gt_lambda[1];"
+  , "  uint64_t r0 = 0;"
+  , "  uint64_t r1 = 0;"
+  , "  for(int i=64*n-1; i>=0; i--) {"
+  , "    uint64_t mask = (1ULL << (i & 63));"
+  , "    r1 = (r1 << 1) | (r0 >> 63);"
+  , "    r0 = (r0 << 1) | ((a[i>>6] & mask) ? 1 : 0);"
+  , "    a[i>>6] &= ~mask;"
+  , "    if ( (r1 > l1) || (r1 == l1 && r0 >= l0) ) {"
+  , "      uint64_t borrow = (r0 < l0) ? 1 : 0;"
+  , "      r0 -= l0;"
+  , "      r1 -= l1 + borrow;"
+  , "      a[i>>6] |= mask;"
+  , "    }"
+  , "  }"
+  , "  rem[0] = r0;"
+  , "  rem[1] = r1;"
+  , "}"
+  , ""
+  , "// Decomposes an exponent `0 <= e < r` (in standard representation) in base `lambda`:"
+  , "//"
+  , "//   e = sum_j e_j * lambda^j"
+  , "//"
+  , "// into GT_NDIGITS digits, each of them fitting into GT_DIGIT_BITS bits."
+  , "// The digits are stored in two words each."
+  , "void " ++ c_curve ++ "_gt_decompose(const uint64_t *expo, uint64_t *digits) {"
+  , "  uint64_t a[NWORDS_FR];"
+  , "  memcpy( a , expo , 8*NWORDS_FR );"
+  , "  for(int j=0; j<GT_NDIGITS-1; j++) {"
+  , "    " ++ c_curve ++ "_gt_divmod_lambda( NWORDS_FR , a , digits + 2*j );"
+  , "  }"
+  , "  digits[2*(GT_NDIGITS-1)  ] = a[0];"
+  , "  digits[2*(GT_NDIGITS-1)+1] = a[1];"
+  , "}"
+  , ""
+  , "#define GT_WINDOW     4"
+  , "#define GT_WINDOW_MASK ((1<<GT_WINDOW) - 1)"
+  , "#define GT_TABLE_SIZE ((1<<GT_WINDOW) - 1)"
+  , ""
+  , "#define TABLE(j,k) (table + ((j)*GT_TABLE_SIZE + (k))*NWORDS_FP12)"
+  , ""
+  , "// Exponentiation in GT by an element of Fr (in standard representation)."
+  , "// With the decomposition `e = sum_j e_j * lambda^j` above, we have"
+  , "//"
+  , "//   g^e = prod_j phi^j(g)^(e_j)"
+  , "//"
+  , "// which is computed as a multi-exponentiation with fixed windows, the (cyclotomic)"
+  , "// squarings being shared between the GT_NDIGITS bases. Only the table of the first"
+  , "// base is computed by multiplications, the other ones are its images under `phi`."
+  , "//"
+  , "// Note: the input must be in GT (the decomposition is not valid outside of it);"
+  , "// for arbitrary cyclotomic elements use `pow_gen` instead."
+  , "void " ++ c_curve ++ "_gt_pow_Fr_std(const uint64_t *src, const uint64_t *expo, uint64_t *tgt) {"
+  , "  uint64_t digits[2*GT_NDIGITS];"
+  , "  " ++ c_curve ++ "_gt_decompose( expo , digits );"
+  , ""
+  , "  // TABLE(j,k) = phi^j(src)^(k+1)"
+  , "  uint64_t *table = malloc( 8*NWORDS_FP12 * GT_NDIGITS * GT_TABLE_SIZE );"
+  , "  assert( table != 0 );"
+  , "  " ++ c_curve ++ "_Fp12_mont_copy( src , TABLE(0,0) );"
+  , "  " ++ c_curve ++ "_pairing_cyclotomic_sqr( src , TABLE(0,1) );"
+  , "  for(int k=2; k<GT_TABLE_SIZE; k++) {"
+  , "    " ++ c_curve ++ "_Fp12_mont_mul( TABLE(0,k-1) , src , TABLE(0,k) );"
+  , "  }"
+  , "  for(int j=1; j<GT_NDIGITS; j++) {"
+  , "    for(int k=0; k<GT_TABLE_SIZE; k++) {"
+  , "      " ++ c_curve ++ "_gt_phi( TABLE(j-1,k) , TABLE(j,k) );"
+  , "    }"
+  , "  }"
+  , ""
+  , "  uint64_t acc[NWORDS_FP12];"
+  , "  " ++ c_curve ++ "_Fp12_mont_set_one( acc );"
+  , "  int started = 0;"
+  , "  for(int i=GT_DIGIT_BITS-GT_WINDOW; i>=0; i-=GT_WINDOW) {"
+  , "    if (started) {"
+  , "      for(int s=0; s<GT_WINDOW; s++) { " ++ c_curve ++ "_pairing_cyclotomic_sqr( acc , acc ); }"
+  , "    }"
+  , "    for(int j=0; j<GT_NDIGITS; j++) {"
+  , "      int k = (digits[2*j + (i>>6)] >> (i & 63)) & GT_WINDOW_MASK;"
+  , "      if (k) {"
+  , "        " ++ c_curve ++ "_Fp12_mont_mul_inplace( acc , TABLE(j,k-1) );"
+  , "        started = 1;"
+  , "      }"
+  , "    }"
+  , "  }"
+  , ""
+  , "  " ++ c_curve ++ "_Fp12_mont_copy( acc , tgt );"
+  , "  free(table);"
+  , "}"
+  , ""
+  , "// Exponentiation in GT by an element of Fr (in Montgomery representation)"
+  , "void " ++ c_curve ++ "_gt_pow_Fr_mont(const uint64_t *src, const uint64_t *expo, uint64_t *tgt) {"
+  , "  uint64_t std[NWORDS_FR];"
+  , "  " ++ c_curve ++ "_Fr_mont_to_std( expo , std );"
+  , "  " ++ c_curve ++ "_gt_pow_Fr_std( src , std , tgt );"
+  , "}"
+  , ""
+  , "// Exponentiation of an element of the cyclotomic subgroup by an arbitrary"
+  , "// nonnegative exponent of `expo_len` words, using cyclotomic squarings and"
+  , "// fixed windows. Unlike `pow_Fr_std`, this does not assume that the input is in GT."
+  , "void " ++ c_curve ++ "_gt_pow_gen(const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len) {"
+  , "  int nbits = 64*expo_len;"
+  , "  while( (nbits > 0) && !((expo[(nbits-1)>>6] >> ((nbits-1) & 63)) & 1) ) { nbits--; }"
+  , "  if (nbits == 0) {"
+  , "    " ++ c_curve ++ "_Fp12_mont_set_one( tgt );"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  uint64_t table[GT_TABLE_SIZE*NWORDS_FP12];"
+  , "  " ++ c_curve ++ "_Fp12_mont_copy( src , table );"
+  , "  " ++ c_curve ++ "_pairing_cyclotomic_sqr( src , table + NWORDS_FP12 );"
+  , "  for(int k=2; k<GT_TABLE_SIZE; k++) {"
+  , "    " ++ c_curve ++ "_Fp12_mont_mul( table + (k-1)*NWORDS_FP12 , src , table + k*NWORDS_FP12 );"
+  , "  }"
+  , ""
+  , "  // the windows are aligned, so they never straddle a word boundary"
+  , "  int nwin = (nbits + GT_WINDOW - 1) / GT_WINDOW;"
+  , "  uint64_t acc[NWORDS_FP12];"
+  , "  for(int w=nwin-1; w>=0; w--) {"
+  , "    int i = w*GT_WINDOW;"
+  , "    int k = (expo[i>>6] >> (i & 63)) & GT_WINDOW_MASK;"
+  , "    if (w == nwin-1) {"
+  , "      " ++ c_curve ++ "_Fp12_mont_copy( table + (k-1)*NWORDS_FP12 , acc );"
+  , "    }"
+  , "    else {"
+  , "      for(int s=0; s<GT_WINDOW; s++) { " ++ c_curve ++ "_pairing_cyclotomic_sqr( acc , acc ); }"
+  , "      if (k) { " ++ c_curve ++ "_Fp12_mont_mul_inplace( acc , table + (k-1)*NWORDS_FP12 ); }"
+  , "    }"
+  , "  }"
+  , ""
+  , "  " ++ c_curve ++ "_Fp12_mont_copy( acc , tgt );"
+  , "}"
+  , ""
+  , "#undef TABLE"
+  , ""
+  ]
+
+c_gt_membership :: PairingParams -> Code
+c_gt_membership params@(PairingParams{..}) = 
+  [ "//------------------------------------------------------------------------------"
+  , "// membership tests"
+  , ""
+  , "// Checks whether an Fp12 element is in the cyclotomic subgroup, that is,"
+  , "// whether it is nonzero and `f^(p^4-p^2+1) = 1`"
+  , "uint8_t " ++ c_curve ++ "_gt_is_cyclotomic(const uint64_t *src) {"
+  , "  if (" ++ c_curve ++ "_Fp12_mont_is_zero( src )) return 0;"
+  , "  uint64_t a[NWORDS_FP12];"
+  , "  uint64_t b[NWORDS_FP12];"
+  , "  " ++ c_curve ++ "_Fp12_mont_frobenius_k( src , 4 , a );"
+  , "  " ++ c_curve ++ "_Fp12_mont_mul_inplace( a , src );"
+  , "  " ++ c_curve ++ "_Fp12_mont_frobenius_2( src , b );"
+  , "  return " ++ c_curve ++ "_Fp12_mont_is_equal( a , b );"
+  , "}"
+  , ""
+  , "// Checks whether an Fp12 element is in GT, the subgroup of order `r`."
+  , "// The order of a cyclotomic element divides `p^4-p^2+1`, and `phi(f) = f^lambda`"
+  , "// means that it also divides `p - lambda0` (see above); the gcd of these is `r`."
+  , "// This is much cheaper than computing `f^r`."
+  , "uint8_t " ++ c_curve ++ "_gt_is_in_subgroup(const uint64_t *src) {"
+  , "  if (!" ++ c_curve ++ "_gt_is_cyclotomic( src )) return 0;"
+  , "  uint64_t a[NWORDS_FP12];"
+  , "  uint64_t b[NWORDS_FP12];"
+  , "  " ++ c_curve ++ "_gt_phi      ( src , a );"
+  , "  " ++ c_curve ++ "_gt_pow_lambda( src , b );"
+  , "  return " ++ c_curve ++ "_Fp12_mont_is_equal( a , b );"
+  , "}"
+  , ""
+  ]
+
+c_gt_compression :: PairingParams -> Code
+c_gt_compression params@(PairingParams{..}) = 
+  [ "//------------------------------------------------------------------------------"
+  , "// torus-based compression"
+  , ""
+  , "// Compression using the algebraic torus T2(Fp6). An element `f = a + b*w` of the"
+  , "// cyclotomic subgroup has norm `a^2 - v*b^2 = 1`, and if `f != 1,-1`, it is determined"
+  , "// by the single Fp6 element `c = (1+a)/b`, via `f = (c + w) / (c - w)`."
+  , "// This halves the size of GT elements. The identity is encoded by `c = 0` (which"
+  , "// would otherwise correspond to -1, but that is not in GT)."
+  , "void " ++ c_curve ++ "_gt_compress(const uint64_t *src, uint64_t *tgt) {"
+  , "  if (" ++ c_curve ++ "_Fp6_mont_is_zero( src + NWORDS_FP6 )) {"
+  , "    " ++ c_curve ++ "_Fp6_mont_set_zero( tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t t[NWORDS_FP6];"
+  , "  " ++ c_curve ++ "_Fp6_mont_set_one   ( t );"
+  , "  " ++ c_curve ++ "_Fp6_mont_add_inplace( t , src );"
+  , "  " ++ c_curve ++ "_Fp6_mont_div( t , src + NWORDS_FP6 , tgt );"
+  , "}"
+  , ""
+  , "// computes the numerator `c^2 + v` and the denominator `c^2 - v` of the"
+  , "// `1` coefficient of the decompressed element"
+  , "void " ++ c_curve ++ "_gt_decompress_num_den(const uint64_t *c, uint64_t *num, uint64_t *den) {"
+  , "  uint64_t one[NWORDS_FP2];"
+  , "  " ++ c_curve ++ "_Fp2_mont_set_one( one );"
+  , "  " ++ c_curve ++ "_Fp6_mont_sqr( c , num );"
+  , "  " ++ c_curve ++ "_Fp6_mont_copy( num , den );"
+  , "  " ++ c_curve ++ "_Fp2_mont_add_inplace( num + NWORDS_FP2 , one );"
+  , "  " ++ c_curve ++ "_Fp2_mont_sub_inplace( den + NWORDS_FP2 , one );"
+  , "}"
+  , ""
+  , "// finishes the decompression, given `c^2 + v` and `1 / (c^2 - v)`:"
+  , "//   f = (c^2 + v + 2c*w) / (c^2 - v)"
+  , "void " ++ c_curve ++ "_gt_decompress_finish(const uint64_t *c, const uint64_t *num, const uint64_t *den_inv, uint64_t *tgt) {"
+  , "  if (" ++ c_curve ++ "_Fp6_mont_is_zero( c )) {"
+  , "    " ++ c_curve ++ "_Fp12_mont_set_one( tgt );"
+  , "    return;"
+  , "  }"
+  , "  " ++ c_curve ++ "_Fp6_mont_mul( num , den_inv , tgt );"
+  , "  " ++ c_curve ++ "_Fp6_mont_add( c , c , tgt + NWORDS_FP6 );"
+  , "  " ++ c_curve ++ "_Fp6_mont_mul_inplace( tgt + NWORDS_FP6 , den_inv );"
+  , "}"
+  , ""
+  , "// Decompression from T2(Fp6). Note: the result always has norm 1, but it is not"
+  , "// necessarily in GT; for untrusted inputs, use `is_in_subgroup` to check it"
+  , "void " ++ c_curve ++ "_gt_decompress(const uint64_t *src, uint64_t *tgt) {"
+  , "  uint64_t num[NWORDS_FP6];"
+  , "  uint64_t den[NWORDS_FP6];"
+  , "  " ++ c_curve ++ "_gt_decompress_num_den( src , num , den );"
+  , "  " ++ c_curve ++ "_Fp6_mont_inv_inplace( den );"
+  , "  " ++ c_curve ++ "_gt_decompress_finish( src , num , den , tgt );"
+  , "}"
+  , ""
+  , "// Decompresses `n` elements at the same time, sharing the inversions (since"
+  , "// `v` is not a square in Fp6, the denominators are never zero)"
+  , "void " ++ c_curve ++ "_gt_batch_decompress(int n, const uint64_t *src, uint64_t *tgt) {"
+  , "  if (n <= 0) return;"
+  , "  uint64_t *num = malloc( 8*NWORDS_FP6 * n );"
+  , "  uint64_t *den = malloc( 8*NWORDS_FP6 * n );"
+  , "  assert( num != 0 );"
+  , "  assert( den != 0 );"
+  , "  for(int i=0; i<n; i++) {"
+  , "    " ++ c_curve ++ "_gt_decompress_num_den( src + i*NWORDS_FP6 , num + i*NWORDS_FP6 , den + i*NWORDS_FP6 );"
+  , "  }"
+  , "  " ++ c_curve ++ "_Fp6_mont_batch_inv( n , den , den );"
+  , "  for(int i=0; i<n; i++) {"
+  , "    " ++ c_curve ++ "_gt_decompress_finish( src + i*NWORDS_FP6 , num + i*NWORDS_FP6 , den + i*NWORDS_FP6 , tgt + i*NWORDS_FP12 );"
+  , "  }"
+  , "  free(den);"
+  , "  free(num);"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+c_header :: PairingParams -> Code
+c_header params@(PairingParams{..}) = 
+  [ "#include <stdint.h>"
+  , ""
+  , "uint8_t " ++ c_curve ++ "_gt_is_cyclotomic  (const uint64_t *src);"
+  , "uint8_t " ++ c_curve ++ "_gt_is_in_subgroup (const uint64_t *src);"
+  , ""
+  , "void " ++ c_curve ++ "_gt_pow_Fr_std (const uint64_t *src, const uint64_t *expo, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_pow_Fr_mont(const uint64_t *src, const uint64_t *expo, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_pow_gen    (const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len);"
+  , ""
+  , "void " ++ c_curve ++ "_gt_compress        (const uint64_t *src, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_decompress      (const uint64_t *src, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_batch_decompress(int n, const uint64_t *src, uint64_t *tgt);"
+  , ""
+  , "// for testing purposes:"
+  , "void " ++ c_curve ++ "_gt_phi      (const uint64_t *src, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_pow_lambda(const uint64_t *src, uint64_t *tgt);"
+  , "void " ++ c_curve ++ "_gt_decompose(const uint64_t *expo, uint64_t *digits);"
+  ]
+
+--------------------------------------------------------------------------------
+
+hs_code :: PairingParams -> Code
+hs_code params@(PairingParams{..}) = 
+  [ "-- | The target group GT of the pairing for " ++ hs_curve ++ " curve"
+  , "--"
+  , "-- GT is the subgroup of order @r@ of the multiplicative group of Fp12;"
+  , "-- its elements are represented as 'Fp12' values."
+  , ""
+  , "-- NOTE 1: This module is intented to be imported qualified"
+  , "-- NOTE 2: Generated code, do not edit!"
+  , ""
+  , "{-# LANGUAGE BangPatterns #-}"
+  , "module " ++ hsModule (mk_hs_path params) 
+  , "  ( -- * Predicates"
+  , "    isCyclotomic"
+  , "  , isInSubgroup"
+  , "    -- * Group operations"
+  , "  , inv"
+  , "  , pow"
+  , "  , powFr"
+  , "    -- * Compression"
+  , "  , compress"
+  , "  , decompress"
+  , "  , batchDecompress"
+  , "  )"
+  , "  where"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , "  "
+  , "import Data.Word"
+  , "import Foreign.C"
+  , "import Foreign.Ptr"
+  , "import Foreign.ForeignPtr"
+  , "import Foreign.Marshal"
+  , "import System.IO.Unsafe"
+  , ""
+  , "import ZK.Algebra.Class.Flat as L"
+  , "import ZK.Algebra.Helpers"
+  , ""
+  , "import ZK.Algebra.Curves." ++ hs_curve ++ ".Fr.Mont   ( Fr(..)   )"
+  , "import ZK.Algebra.Curves." ++ hs_curve ++ ".Fp6.Mont  ( Fp6(..)  )"
+  , "import ZK.Algebra.Curves." ++ hs_curve ++ ".Fp12.Mont ( Fp12(..) )"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_is_cyclotomic\"     c_gt_is_cyclotomic     :: Ptr Word64 -> IO Word8"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_is_in_subgroup\"    c_gt_is_in_subgroup    :: Ptr Word64 -> IO Word8"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_Fp12_mont_cyclotomic_inv\" c_cyclotomic_inv :: Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_pow_Fr_mont\"       c_gt_pow_Fr_mont       :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_pow_gen\"           c_gt_pow_gen           :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> CInt -> IO ()"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_compress\"          c_gt_compress          :: Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_decompress\"        c_gt_decompress        :: Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ c_curve ++ "_gt_batch_decompress\"  c_gt_batch_decompress  :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "{-# NOINLINE isCyclotomic #-}"
+  , "-- | Whether the element is in the cyclotomic subgroup (of order @p^4-p^2+1@)"
+  , "isCyclotomic :: Fp12 -> Bool"
+  , "isCyclotomic (MkFp12 fptr) = unsafePerformIO $ do"
+  , "  cret <- withForeignPtr fptr $ \\ptr -> do"
+  , "    c_gt_is_cyclotomic ptr"
+  , "  return (cret /= 0)"
+  , ""
+  , "{-# NOINLINE isInSubgroup #-}"
+  , "-- | Whether the element is in GT (the subgroup of order @r@)"
+  , "isInSubgroup :: Fp12 -> Bool"
+  , "isInSubgroup (MkFp12 fptr) = unsafePerformIO $ do"
+  , "  cret <- withForeignPtr fptr $ \\ptr -> do"
+  , "    c_gt_is_in_subgroup ptr"
+  , "  return (cret /= 0)"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "{-# NOINLINE inv #-}"
+  , "-- | Inversion in the cyclotomic subgroup (which is just the conjugation)"
+  , "inv :: Fp12 -> Fp12"
+  , "inv (MkFp12 fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray " ++ show (12*nwords_fp)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_cyclotomic_inv ptr1 ptr2"
+  , "  return (MkFp12 fptr2)"
+  , ""
+  , "-- | Exponentiation in the cyclotomic subgroup by an arbitrary integer"
+  , "pow :: Fp12 -> Integer -> Fp12"
+  , "pow x e"
+  , "  | e >= 0     =      powNonNeg x         e"
+  , "  | otherwise  = inv (powNonNeg x (negate e))"
+  , ""
+  , "{-# NOINLINE powNonNeg #-}"
+  , "powNonNeg :: Fp12 -> Integer -> Fp12"
+  , "powNonNeg (MkFp12 fptr1) expo = unsafePerformIO $ do"
+  , "  let (n,ws) = toWord64sLE_ expo"
+  , "  fptr3 <- mallocForeignPtrArray " ++ show (12*nwords_fp)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withArray (ws ++ [0]) $ \\ptr2 -> do"
+  , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "        c_gt_pow_gen ptr1 ptr2 ptr3 (fromIntegral n)"
+  , "  return (MkFp12 fptr3)"
+  , ""
+  , "{-# NOINLINE powFr #-}"
+  , "-- | Exponentiation of an element of GT by an element of Fr. This uses the"
+  , "-- Frobenius endomorphism to decompose the exponent, and is much faster than 'pow'."
+  , "-- The input must be in GT!"
+  , "powFr :: Fp12 -> Fr -> Fp12"
+  , "powFr (MkFp12 fptr1) (MkFr fptr2) = unsafePerformIO $ do"
+  , "  fptr3 <- mallocForeignPtrArray " ++ show (12*nwords_fp)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "        c_gt_pow_Fr_mont ptr1 ptr2 ptr3"
+  , "  return (MkFp12 fptr3)"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "{-# NOINLINE compress #-}"
+  , "-- | Compresses an element of GT into a single Fp6 element (torus-based compression)"
+  , "compress :: Fp12 -> Fp6"
+  , "compress (MkFp12 fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray " ++ show (6*nwords_fp)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_gt_compress ptr1 ptr2"
+  , "  return (MkFp6 fptr2)"
+  , ""
+  , "{-# NOINLINE decompress #-}"
+  , "-- | Inverse of 'compress'. Note: the result is not necessarily in GT, so"
+  , "-- untrusted inputs should be checked with 'isInSubgroup'"
+  , "decompress :: Fp6 -> Fp12"
+  , "decompress (MkFp6 fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray " ++ show (12*nwords_fp)
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_gt_decompress ptr1 ptr2"
+  , "  return (MkFp12 fptr2)"
+  , ""
+  , "{-# NOINLINE batchDecompress #-}"
+  , "-- | Decompresses many elements at once, sharing the field inversions"
+  , "batchDecompress :: [Fp6] -> [Fp12]"
+  , "batchDecompress [] = []"
+  , "batchDecompress cs = unsafePerformIO $ do"
+  , "  let MkFlatArray n fptr1 = L.packFlatArrayFromList cs"
+  , "  fptr2 <- mallocForeignPtrArray (n * " ++ show (12*nwords_fp) ++ ")"
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_gt_batch_decompress (fromIntegral n) ptr1 ptr2"
+  , "  return (L.unpackFlatArrayToList (MkFlatArray n fptr2))"
+  , ""
+  ]
+
+--------------------------------------------------------------------------------
+
+mk_c_path :: PairingParams -> Path
+mk_c_path (PairingParams{..}) = Path ["curves","gt",c_curve ++ "_gt"]
+
+mk_hs_path :: PairingParams -> Path
+mk_hs_path (PairingParams{..}) = Path ["ZK","Algebra","Curves",hs_curve,"GT"]
+
+curve_gt_c_codegen :: FilePath -> PairingParams -> IO ()
+curve_gt_c_codegen tgtdir params@(PairingParams{..}) = do
+
+  let fn_h = tgtdir </> (cFilePath "h" $ mk_c_path params)
+  let fn_c = tgtdir </> (cFilePath "c" $ mk_c_path params)
+
+  createTgtDirectory fn_h
+  createTgtDirectory fn_c
+
+  putStrLn $ "writing `" ++ fn_h ++ "`" 
+  writeFile fn_h $ unlines $ c_header params
+
+  putStrLn $ "writing `" ++ fn_c ++ "`" 
+  writeFile fn_c $ unlines $ c_code  params
+
+curve_gt_hs_codegen :: FilePath -> PairingParams -> IO ()
+curve_gt_hs_codegen tgtdir params@(PairingParams{..}) = do
+
+  let fn_hs = tgtdir </> (hsFilePath $ mk_hs_path params)
+
+  createTgtDirectory fn_hs
+
+  putStrLn $ "writing `" ++ fn_hs ++ "`" 
+  writeFile fn_hs $ unlines $ hs_code params
+
+--------------------------------------------------------------------------------
@@ -0,0 +1,498 @@
+-- | Hashing to the curve (RFC 9380): @hash_to_field@ with @expand_message_xmd@
+-- (SHA-256), the simplified SWU map (via an isogeny) or the Shallue-van de
+-- Woestijne map, and cofactor clearing
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.HashToCurve where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Zikkurat.CodeGen.Misc
+import Zikkurat.CodeGen.PrimeField.Montgomery ( powMod )
+
+import Zikkurat.CodeGen.Curve.Params
+import Zikkurat.CodeGen.Curve.Cofactor
+
+--------------------------------------------------------------------------------
+
+-- | The hash-to-curve parameters of a group, with the field elements converted
+-- to lists of prime field elements (in Montgomery representation)
+data H2C = H2C
+  { h2c_p        :: Integer               -- ^ the prime of the base field
+  , h2c_m        :: Int                   -- ^ extension degree of the base field (1 for G1, 2 for G2)
+  , h2c_nlimbs   :: Int                   -- ^ number of 64-bit limbs in the prime field
+  , h2c_params   :: HashToCurve [Integer]
+  , h2c_sqrtNegZ :: Maybe Integer         -- ^ @sqrt(-Z)@ for SSWU over a prime field with @p = 3 mod 4@
+  }
+
+xcurveH2C :: XCurve -> Maybe H2C
+xcurveH2C xcurve = case xcurve of
+  Left  (Curve1{..}) ->
+    fmap (\h2c -> H2C curveFp 1 (nlimbs curveFp) (fmap (\x -> [toMont curveFp x]) h2c) (sqrtNegZ curveFp h2c)) hashToCurve
+  Right (Curve12 (Curve1{..}) (Curve2{..})) ->
+    fmap (\h2c -> H2C curveFp 2 (nlimbs curveFp) (fmap (\(x,y) -> [toMont curveFp x, toMont curveFp y]) h2c) Nothing) g2_hashToCurve
+  where
+    nlimbs  p   = div (fromInteger (integerLog2' p) + 64) 64
+    toMont  p x = mod (2^(64 * nlimbs p) * x) p
+    sqrtNegZ p h2c = case h2c_map h2c of
+      SSWU{..} | mod p 4 == 3  -> Just (toMont p (powMod (negate sswu_Z) (div (p+1) 4) p))
+      _                        -> Nothing
+    integerLog2' :: Integer -> Integer
+    integerLog2' n = if n <= 1 then 0 else 1 + integerLog2' (shiftR n 1)
+
+hasHashToCurve :: XCurve -> Bool
+hasHashToCurve xcurve = case xcurveH2C xcurve of
+  Just _  -> True
+  Nothing -> False
+
+--------------------------------------------------------------------------------
+
+h2c_c_header :: XCurve -> CodeGenParams -> Code
+h2c_c_header xcurve (CodeGenParams{..})
+  | not (hasHashToCurve xcurve) = []
+  | otherwise =
+    [ ""
+    , "extern uint8_t " ++ prefix ++ "hash_to_field     ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int count, uint64_t *tgt );"
+    , "extern void    " ++ prefix ++ "map_to_curve      ( const uint64_t *u, uint64_t *tgt );"
+    , "extern void    " ++ prefix ++ "hash_to_curve     ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt );"
+    , "extern void    " ++ prefix ++ "encode_to_curve   ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt );"
+    , "extern void    " ++ prefix ++ "hash_to_curve_batch( int n, const uint8_t *dst, int dst_len, const uint8_t *msgs, const int *msg_lens, uint64_t *tgt );"
+    ]
+
+--------------------------------------------------------------------------------
+
+h2c_hs_binding :: XCurve -> CodeGenParams -> Code
+h2c_hs_binding xcurve (CodeGenParams{..})
+  | not (hasHashToCurve xcurve) = []
+  | otherwise =
+    [ ""
+    , "foreign import ccall unsafe \"" ++ prefix ++ "hash_to_curve\" c_" ++ prefix ++ "hash_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()"
+    , "foreign import ccall unsafe \"" ++ prefix ++ "encode_to_curve\" c_" ++ prefix ++ "encode_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()"
+    , "foreign import ccall unsafe \"" ++ prefix ++ "hash_to_curve_batch\" c_" ++ prefix ++ "hash_to_curve_batch :: CInt -> Ptr Word8 -> CInt -> Ptr Word8 -> Ptr CInt -> Ptr Word64 -> IO ()"
+    , ""
+    , "{-# NOINLINE hashToCurve #-}"
+    , "-- | Hashes a message to the subgroup (@hash_to_curve@ of RFC 9380). The first"
+    , "-- argument is the domain separation tag."
+    , "hashToCurve :: [Word8] -> [Word8] -> " ++ typeName
+    , "hashToCurve dst msg = unsafePerformIO $ do"
+    , "  fptr3 <- mallocForeignPtrArray " ++ show (3*nlimbs_p)
+    , "  withArrayLen dst $ \\dst_len ptr1 -> do"
+    , "    withArrayLen msg $ \\msg_len ptr2 -> do"
+    , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+    , "        c_" ++ prefix ++ "hash_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3"
+    , "  return (Mk" ++ typeName ++ " fptr3)"
+    , ""
+    , "{-# NOINLINE encodeToCurve #-}"
+    , "-- | The non-uniform variant @encode_to_curve@ of RFC 9380 (it is faster, but"
+    , "-- its output is not indistinguishable from a random oracle)"
+    , "encodeToCurve :: [Word8] -> [Word8] -> " ++ typeName
+    , "encodeToCurve dst msg = unsafePerformIO $ do"
+    , "  fptr3 <- mallocForeignPtrArray " ++ show (3*nlimbs_p)
+    , "  withArrayLen dst $ \\dst_len ptr1 -> do"
+    , "    withArrayLen msg $ \\msg_len ptr2 -> do"
+    , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+    , "        c_" ++ prefix ++ "encode_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3"
+    , "  return (Mk" ++ typeName ++ " fptr3)"
+    , ""
+    , "{-# NOINLINE hashToCurveMany #-}"
+    , "-- | Hashes many messages at the same time (sharing the inversions), with affine output"
+    , "hashToCurveMany :: [Word8] -> [[Word8]] -> FlatArray " ++ affineType
+    , "hashToCurveMany dst msgs = unsafePerformIO $ do"
+    , "  let n = length msgs"
+    , "  fptr3 <- mallocForeignPtrArray (n*" ++ show (2*nlimbs_p) ++ ")"
+    , "  withArrayLen dst $ \\dst_len ptr1 -> do"
+    , "    withArray (concat msgs) $ \\ptr2 -> do"
+    , "      withArray (map (fromIntegral . length) msgs) $ \\ptr_lens -> do"
+    , "        withForeignPtr fptr3 $ \\ptr3 -> do"
+    , "          c_" ++ prefix ++ "hash_to_curve_batch (fromIntegral n) ptr1 (fromIntegral dst_len) ptr2 ptr_lens ptr3"
+    , "  return (MkFlatArray n fptr3)"
+    , ""
+    ]
+  where
+    affineType = hsModule hs_path_affine ++ "." ++ typeName
+
+--------------------------------------------------------------------------------
+
+c_hash_to_curve :: XCurve -> CodeGenParams -> Code
+c_hash_to_curve xcurve cgparams@(CodeGenParams{..}) = case xcurveH2C xcurve of
+  Nothing  -> []
+  Just h2c
+    | h2c_heff (h2c_params h2c) /= effectiveCofactor xcurve
+                -> error "c_hash_to_curve: h_eff does not match the effective cofactor of `clear_cofactor`"
+    | otherwise -> c_hash_to_curve' h2c cgparams
+
+c_hash_to_curve' :: H2C -> CodeGenParams -> Code
+c_hash_to_curve' (H2C{..}) (CodeGenParams{..}) =
+  [ "//------------------------------------------------------------------------------"
+  , "// hashing to the curve (RFC 9380)"
+  , "//"
+  , "//   hash_to_curve(msg)   = clear_cofactor( map_to_curve(u0) + map_to_curve(u1) )"
+  , "//   encode_to_curve(msg) = clear_cofactor( map_to_curve(u) )"
+  , "//"
+  , "// where the field elements u0,u1 (resp. u) come from `hash_to_field`, which"
+  , "// uses expand_message_xmd with SHA-256. The map to the curve is"
+  , "// " ++ mapName ++ "."
+  , "//"
+  , "// Each map needs a single inversion; when hashing many messages, these inversions"
+  , "// (and the final conversion to affine coordinates) are batched together."
+  , ""
+  , "#define H2C_L         " ++ show h2c_L ++ "       // number of bytes per prime field element"
+  , "#define H2C_M         " ++ show h2c_m ++ "        // extension degree of the base field"
+  , "#define H2C_NLIMBS_FP " ++ show h2c_nlimbs
+  , ""
+  , "// (2^(64*(H2C_NLIMBS_FP-1)) * R^2) mod p, for reducing the hashed bytes into Fp"
+  , mkConst h2c_nlimbs (prefix ++ "h2c_bytes_hi_scale") (mod (2^(64*(h2c_nlimbs-1)) * 2^(128*h2c_nlimbs)) h2c_p)
+  , ""
+  , "// interprets `H2C_L` big-endian bytes as an integer, and reduces it modulo p"
+  , "// (into Montgomery representation). The integer is split as hi*2^(64*(n-1)) + lo"
+  , "// where both `hi` and `lo` are smaller than p."
+  , "void " ++ prefix ++ "h2c_bytes_to_Fp( const uint8_t *src, uint64_t *tgt ) {"
+  , "  uint64_t ws[H2C_L/8];"
+  , "  uint64_t lo[H2C_NLIMBS_FP];"
+  , "  uint64_t hi[H2C_NLIMBS_FP];"
+  , "  uint64_t tmp[H2C_NLIMBS_FP];"
+  , "  for(int i=0; i<H2C_L/8; i++) {"
+  , "    const uint8_t *q = src + H2C_L - 8*(i+1);"
+  , "    uint64_t w = 0;"
+  , "    for(int j=0; j<8; j++) { w = (w << 8) | q[j]; }"
+  , "    ws[i] = w;"
+  , "  }"
+  , "  memset( lo, 0, 8*H2C_NLIMBS_FP );"
+  , "  memset( hi, 0, 8*H2C_NLIMBS_FP );"
+  , "  memcpy( lo, ws                    , 8*(H2C_NLIMBS_FP-1) );"
+  , "  memcpy( hi, ws + (H2C_NLIMBS_FP-1), 8*(H2C_L/8 - H2C_NLIMBS_FP + 1) );"
+  , "  " ++ prefix_fp ++ "from_std( lo, tmp );"
+  , "  " ++ prefix_fp ++ "mul( hi, " ++ prefix ++ "h2c_bytes_hi_scale, tgt );"
+  , "  " ++ prefix_fp ++ "add_inplace( tgt, tmp );"
+  , "}"
+  , ""
+  , "// hashes a message to `count` elements of the base field (in Montgomery"
+  , "// representation). Returns 0 if `count` is too big for expand_message_xmd."
+  , "uint8_t " ++ prefix ++ "hash_to_field( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int count, uint64_t *tgt ) {"
+  , "  int len = count * H2C_M * H2C_L;"
+  , "  uint8_t *bytes = malloc( len );"
+  , "  assert( bytes != 0 );"
+  , "  if (!expand_message_xmd_sha256( dst, dst_len, msg, msg_len, len, bytes )) {"
+  , "    free(bytes);"
+  , "    return 0;"
+  , "  }"
+  , "  for(int i=0; i<count*H2C_M; i++) {"
+  , "    " ++ prefix ++ "h2c_bytes_to_Fp( bytes + i*H2C_L, tgt + i*H2C_NLIMBS_FP );"
+  , "  }"
+  , "  free(bytes);"
+  , "  return 1;"
+  , "}"
+  , ""
+  , "// the \"sign\" of a field element (RFC 9380, section 4.1)"
+  , "uint8_t " ++ prefix ++ "h2c_sgn0( const uint64_t *src ) {"
+  , "  uint64_t std[H2C_NLIMBS_FP];"
+  , "  " ++ prefix_fp ++ "to_std( src, std );"
+  ] ++
+  (if h2c_m == 1
+    then
+      [ "  return (std[0] & 1);"
+      ]
+    else
+      [ "  uint8_t sign = (std[0] & 1);"
+      , "  uint8_t zero = " ++ prefix_fp ++ "is_zero( src );"
+      , "  " ++ prefix_fp ++ "to_std( src + H2C_NLIMBS_FP, std );"
+      , "  return sign | (zero & (std[0] & 1));"
+      ]
+  ) ++
+  [ "}"
+  , ""
+  , "// computes x^3 + a*x + b"
+  , "void " ++ prefix ++ "h2c_rhs( const uint64_t *a, const uint64_t *b, const uint64_t *x, uint64_t *tgt ) {"
+  , "  uint64_t t[NLIMBS_P];"
+  , "  " ++ prefix_p ++ "sqr( x, t );"
+  , "  " ++ prefix_p ++ "add_inplace( t, a );"
+  , "  " ++ prefix_p ++ "mul( t, x, tgt );"
+  , "  " ++ prefix_p ++ "add_inplace( tgt, b );"
+  , "}"
+  , ""
+  ] ++
+  (case h2c_map of
+     SSWU{..} -> c_sswu sswu_Z iso_A iso_B iso_xnum iso_xden iso_ynum iso_yden
+     SVDW{..} -> c_svdw svdw_Z svdw_c1 svdw_c2 svdw_c3 svdw_c4
+  ) ++
+  [ ""
+  , "// maps a base field element to the curve (projective coordinates)"
+  , "void " ++ prefix ++ "map_to_curve( const uint64_t *u, uint64_t *tgt ) {"
+  , "  uint64_t den[NLIMBS_P];"
+  , "  " ++ prefix ++ "map_to_curve_denom( u, den );"
+  , "  if (!" ++ prefix_p ++ "is_zero( den )) { " ++ prefix_p ++ "inv_inplace( den ); }"
+  , "  " ++ prefix ++ "map_to_curve_inv( u, den, tgt );"
+  , "}"
+  , ""
+  , "// hashes a message to the subgroup (`hash_to_curve` of RFC 9380)"
+  , "void " ++ prefix ++ "hash_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {"
+  , "  uint64_t u [2*NLIMBS_P];"
+  , "  uint64_t q0[3*NLIMBS_P];"
+  , "  uint64_t q1[3*NLIMBS_P];"
+  , "  " ++ prefix ++ "hash_to_field( dst, dst_len, msg, msg_len, 2, u );"
+  , "  " ++ prefix ++ "map_to_curve( u           , q0 );"
+  , "  " ++ prefix ++ "map_to_curve( u + NLIMBS_P, q1 );"
+  , "  " ++ prefix ++ "add_inplace( q0, q1 );"
+  , "  " ++ prefix ++ "clear_cofactor( q0, tgt );"
+  , "}"
+  , ""
+  , "// the non-uniform variant `encode_to_curve` of RFC 9380"
+  , "void " ++ prefix ++ "encode_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {"
+  , "  uint64_t u[NLIMBS_P];"
+  , "  uint64_t q[3*NLIMBS_P];"
+  , "  " ++ prefix ++ "hash_to_field( dst, dst_len, msg, msg_len, 1, u );"
+  , "  " ++ prefix ++ "map_to_curve( u, q );"
+  , "  " ++ prefix ++ "clear_cofactor( q, tgt );"
+  , "}"
+  , ""
+  , "// hashes `n` messages (concatenated in `msgs`, with lengths `msg_lens`) to the"
+  , "// subgroup, with affine output. The result is the same as calling `hash_to_curve`"
+  , "// for each message, but the 2*n inversions in the maps are done as a single"
+  , "// batched inversion, and so is the conversion to affine coordinates."
+  , "void " ++ prefix ++ "hash_to_curve_batch( int n, const uint8_t *dst, int dst_len, const uint8_t *msgs, const int *msg_lens, uint64_t *tgt ) {"
+  , "  if (n <= 0) return;"
+  , "  uint64_t *us   = malloc( 8 * NLIMBS_P * 2*n );"
+  , "  uint64_t *dens = malloc( 8 * NLIMBS_P * 2*n );"
+  , "  uint64_t *pts  = malloc( 8 * 3*NLIMBS_P * 2*n );"
+  , "  uint8_t  *zero = malloc( 2*n );"
+  , "  assert( us != 0 && dens != 0 && pts != 0 && zero != 0 );"
+  , "  uint64_t tmp[3*NLIMBS_P];"
+  , ""
+  , "  const uint8_t *msg = msgs;"
+  , "  for(int i=0; i<n; i++) {"
+  , "    " ++ prefix ++ "hash_to_field( dst, dst_len, msg, msg_lens[i], 2, us + 2*i*NLIMBS_P );"
+  , "    msg += msg_lens[i];"
+  , "  }"
+  , ""
+  , "  // the (extremely unlikely) zero denominators are replaced by 1 before the"
+  , "  // batched inversion, and their \"inverses\" are set back to zero afterwards"
+  , "  for(int i=0; i<2*n; i++) {"
+  , "    " ++ prefix ++ "map_to_curve_denom( us + i*NLIMBS_P, dens + i*NLIMBS_P );"
+  , "    zero[i] = " ++ prefix_p ++ "is_zero( dens + i*NLIMBS_P );"
+  , "    if (zero[i]) { " ++ prefix_p ++ "set_one( dens + i*NLIMBS_P ); }"
+  , "  }"
+  , "  " ++ prefix_p ++ "batch_inv( 2*n, dens, dens );"
+  , "  for(int i=0; i<2*n; i++) {"
+  , "    if (zero[i]) { " ++ prefix_p ++ "set_zero( dens + i*NLIMBS_P ); }"
+  , "    " ++ prefix ++ "map_to_curve_inv( us + i*NLIMBS_P, dens + i*NLIMBS_P, pts + i*3*NLIMBS_P );"
+  , "  }"
+  , ""
+  , "  // the i-th result overwrites the (already used) i-th point"
+  , "  for(int i=0; i<n; i++) {"
+  , "    " ++ prefix ++ "add( pts + (2*i)*3*NLIMBS_P, pts + (2*i+1)*3*NLIMBS_P, tmp );"
+  , "    " ++ prefix ++ "clear_cofactor( tmp, pts + i*3*NLIMBS_P );"
+  , "  }"
+  , "  " ++ prefix ++ "batch_to_affine( n, pts, tgt );"
+  , ""
+  , "  free(zero);"
+  , "  free(pts);"
+  , "  free(dens);"
+  , "  free(us);"
+  , "}"
+  ]
+  where
+
+    HashToCurve{..} = h2c_params
+
+
+    mapName = case h2c_map of
+      SSWU{..} -> "the simplified SWU map to an isogenous curve, followed by an\n// isogeny of degree " ++ show (length iso_xnum - 1)
+      SVDW{..} -> "the Shallue-van de Woestijne map"
+
+    fieldConst name x = mkConstArr h2c_nlimbs (prefix ++ name) x
+    polyConst  name p = mkConstArr h2c_nlimbs (prefix ++ name) (concat p)
+
+    ----------------------------------------
+
+    c_sswu z a b xnum xden ynum yden =
+      [ "// the non-square Z of the map"
+      , fieldConst "h2c_Z" z
+      ] ++
+      (case h2c_sqrtNegZ of
+         Nothing -> []
+         Just s  -> [ "// a square root of -Z"
+                    , fieldConst "h2c_sqrt_minus_Z" [s]
+                    ]
+      ) ++
+      [ ""
+      , "// the isogenous curve E': y^2 = x^3 + A'*x + B'"
+      , fieldConst "h2c_iso_A" a
+      , fieldConst "h2c_iso_B" b
+      , ""
+      , "// the isogeny E' -> E is (x,y) -> ( xnum(x)/xden(x) , y*ynum(x)/yden(x) ),"
+      , "// the coefficients are starting from the constant term"
+      , polyConst "h2c_iso_xnum" xnum
+      , polyConst "h2c_iso_xden" xden
+      , polyConst "h2c_iso_ynum" ynum
+      , polyConst "h2c_iso_yden" yden
+      , ""
+      , "// evaluates a polynomial with `n` coefficients at x (Horner's method)"
+      , "void " ++ prefix ++ "h2c_poly_eval( int n, const uint64_t *coeffs, const uint64_t *x, uint64_t *tgt ) {"
+      , "  " ++ prefix_p ++ "copy( coeffs + (n-1)*NLIMBS_P, tgt );"
+      , "  for(int i=n-2; i>=0; i--) {"
+      , "    " ++ prefix_p ++ "mul_inplace( tgt, x );"
+      , "    " ++ prefix_p ++ "add_inplace( tgt, coeffs + i*NLIMBS_P );"
+      , "  }"
+      , "}"
+      , ""
+      , "// applies the isogeny to an affine point of E', with the result in projective"
+      , "// coordinates on E (so that no inversion is needed):"
+      , "//"
+      , "//   (X:Y:Z) = ( xnum*yden : y*ynum*xden : xden*yden )"
+      , "//"
+      , "void " ++ prefix ++ "h2c_iso_map( const uint64_t *x, const uint64_t *y, uint64_t *tgt ) {"
+      , "  uint64_t xn[NLIMBS_P];"
+      , "  uint64_t xd[NLIMBS_P];"
+      , "  uint64_t yn[NLIMBS_P];"
+      , "  uint64_t yd[NLIMBS_P];"
+      , "  " ++ prefix ++ "h2c_poly_eval( " ++ show (length xnum) ++ ", " ++ prefix ++ "h2c_iso_xnum, x, xn );"
+      , "  " ++ prefix ++ "h2c_poly_eval( " ++ show (length xden) ++ ", " ++ prefix ++ "h2c_iso_xden, x, xd );"
+      , "  " ++ prefix ++ "h2c_poly_eval( " ++ show (length ynum) ++ ", " ++ prefix ++ "h2c_iso_ynum, x, yn );"
+      , "  " ++ prefix ++ "h2c_poly_eval( " ++ show (length yden) ++ ", " ++ prefix ++ "h2c_iso_yden, x, yd );"
+      , "  " ++ prefix_p ++ "mul( xn, yd, X3 );"
+      , "  " ++ prefix_p ++ "mul( yn, xd, Y3 );"
+      , "  " ++ prefix_p ++ "mul_inplace( Y3, y );"
+      , "  " ++ prefix_p ++ "mul( xd, yd, Z3 );"
+      , "  if (" ++ prefix_p ++ "is_zero( Z3 )) {"
+      , "    // the point is in the kernel of the isogeny"
+      , "    " ++ prefix ++ "set_infinity( tgt );"
+      , "  }"
+      , "}"
+      , ""
+      , "// the denominator A'*(Z^2*u^4 + Z*u^2) of the simplified SWU map; its inverse"
+      , "// is the only one needed by `map_to_curve_inv`"
+      , "void " ++ prefix ++ "map_to_curve_denom( const uint64_t *u, uint64_t *den ) {"
+      , "  uint64_t tv[NLIMBS_P];"
+      , "  " ++ prefix_p ++ "sqr( u, tv );"
+      , "  " ++ prefix_p ++ "mul_inplace( tv, " ++ prefix ++ "h2c_Z );         // Z*u^2"
+      , "  " ++ prefix_p ++ "sqr( tv, den );"
+      , "  " ++ prefix_p ++ "add_inplace( den, tv );                  // Z^2*u^4 + Z*u^2"
+      , "  " ++ prefix_p ++ "mul_inplace( den, " ++ prefix ++ "h2c_iso_A );"
+      , "}"
+      , ""
+      , "// the simplified SWU map (RFC 9380, section 6.6.2) followed by the isogeny, given"
+      , "// the inverse of the denominator (or zero if the denominator is zero)"
+      , "void " ++ prefix ++ "map_to_curve_inv( const uint64_t *u, const uint64_t *inv_den, uint64_t *tgt ) {"
+      , "  uint64_t tv [NLIMBS_P];"
+      , "  uint64_t x  [NLIMBS_P];"
+      , "  uint64_t gx [NLIMBS_P];"
+      , "  uint64_t y  [NLIMBS_P];"
+      , "  uint64_t tmp[NLIMBS_P];"
+      , "  " ++ prefix_p ++ "sqr( u, tv );"
+      , "  " ++ prefix_p ++ "mul_inplace( tv, " ++ prefix ++ "h2c_Z );         // Z*u^2"
+      , "  if (" ++ prefix_p ++ "is_zero( inv_den )) {"
+      , "    // exceptional case: x1 = B' / (Z*A')"
+      , "    " ++ prefix_p ++ "mul( " ++ prefix ++ "h2c_Z, " ++ prefix ++ "h2c_iso_A, tmp );"
+      , "    " ++ prefix_p ++ "div( " ++ prefix ++ "h2c_iso_B, tmp, x );"
+      , "  }"
+      , "  else {"
+      , "    // x1 = -B' * (Z^2*u^4 + Z*u^2 + 1) / (A' * (Z^2*u^4 + Z*u^2))"
+      , "    " ++ prefix_p ++ "sqr( tv, x );"
+      , "    " ++ prefix_p ++ "add_inplace( x, tv );"
+      , "    " ++ prefix_p ++ "set_one( tmp );"
+      , "    " ++ prefix_p ++ "add_inplace( x, tmp );"
+      , "    " ++ prefix_p ++ "mul_inplace( x, " ++ prefix ++ "h2c_iso_B );"
+      , "    " ++ prefix_p ++ "mul_inplace( x, inv_den );"
+      , "    " ++ prefix_p ++ "neg_inplace( x );"
+      , "  }"
+      , "  " ++ prefix ++ "h2c_rhs( " ++ prefix ++ "h2c_iso_A, " ++ prefix ++ "h2c_iso_B, x, gx );"
+      ] ++
+      (case h2c_sqrtNegZ of
+         Just _ ->
+           [ "  // a single exponentiation: if g(x1) is not a square, then y^2 = -g(x1), and"
+           , "  // x2 = Z*u^2*x1 has g(x2) = (Z*u^2)^3 * g(x1), with square root Z*u^3 * sqrt(-Z) * y"
+           , "  " ++ prefix_p ++ "pow_p_plus_1_per_4( gx, y );"
+           , "  " ++ prefix_p ++ "sqr( y, tmp );"
+           , "  if (!" ++ prefix_p ++ "is_equal( tmp, gx )) {"
+           , "    " ++ prefix_p ++ "mul_inplace( x, tv );"
+           , "    " ++ prefix_p ++ "mul_inplace( y, tv );"
+           , "    " ++ prefix_p ++ "mul_inplace( y, u  );"
+           , "    " ++ prefix_p ++ "mul_inplace( y, " ++ prefix ++ "h2c_sqrt_minus_Z );"
+           , "  }"
+           ]
+         Nothing ->
+           [ "  if (!" ++ prefix_p ++ "sqrt( gx, y )) {"
+           , "    // g(x1) is not a square, so g(x2) is, where x2 = Z*u^2*x1"
+           , "    " ++ prefix_p ++ "mul_inplace( x, tv );"
+           , "    " ++ prefix ++ "h2c_rhs( " ++ prefix ++ "h2c_iso_A, " ++ prefix ++ "h2c_iso_B, x, gx );"
+           , "    " ++ prefix_p ++ "sqrt( gx, y );"
+           , "  }"
+           ]
+      ) ++
+      [ "  if (" ++ prefix ++ "h2c_sgn0( u ) != " ++ prefix ++ "h2c_sgn0( y )) {"
+      , "    " ++ prefix_p ++ "neg_inplace( y );"
+      , "  }"
+      , "  " ++ prefix ++ "h2c_iso_map( x, y, tgt );"
+      , "}"
+      ]
+
+    ----------------------------------------
+
+    c_svdw z c1 c2 c3 c4 =
+      [ "// the constants of the Shallue-van de Woestijne map"
+      , fieldConst "h2c_Z"  z
+      , fieldConst "h2c_c1" c1
+      , fieldConst "h2c_c2" c2
+      , fieldConst "h2c_c3" c3
+      , fieldConst "h2c_c4" c4
+      , ""
+      , "// the denominator (1 - c1*u^2)*(1 + c1*u^2) of the Shallue-van de Woestijne map;"
+      , "// its inverse is the only one needed by `map_to_curve_inv`"
+      , "void " ++ prefix ++ "map_to_curve_denom( const uint64_t *u, uint64_t *den ) {"
+      , "  uint64_t t1[NLIMBS_P];"
+      , "  uint64_t t2[NLIMBS_P];"
+      , "  " ++ prefix_p ++ "sqr( u, t1 );"
+      , "  " ++ prefix_p ++ "mul_inplace( t1, " ++ prefix ++ "h2c_c1 );        // c1*u^2"
+      , "  " ++ prefix_p ++ "set_one( t2 );"
+      , "  " ++ prefix_p ++ "sub( t2, t1, den );                       // 1 - c1*u^2"
+      , "  " ++ prefix_p ++ "add_inplace( t1, t2 );                    // 1 + c1*u^2"
+      , "  " ++ prefix_p ++ "mul_inplace( den, t1 );"
+      , "}"
+      , ""
+      , "// the Shallue-van de Woestijne map (RFC 9380, section 6.6.1), given the inverse"
+      , "// of the denominator (or zero if the denominator is zero)"
+      , "void " ++ prefix ++ "map_to_curve_inv( const uint64_t *u, const uint64_t *inv_den, uint64_t *tgt ) {"
+      , "  uint64_t tv1[NLIMBS_P];"
+      , "  uint64_t tv2[NLIMBS_P];"
+      , "  uint64_t tv4[NLIMBS_P];"
+      , "  uint64_t x  [NLIMBS_P];"
+      , "  uint64_t gx [NLIMBS_P];"
+      , "  uint64_t y  [NLIMBS_P];"
+      , "  " ++ prefix_p ++ "sqr( u, x );"
+      , "  " ++ prefix_p ++ "mul_inplace( x, " ++ prefix ++ "h2c_c1 );         // c1*u^2"
+      , "  " ++ prefix_p ++ "set_one( y );"
+      , "  " ++ prefix_p ++ "sub( y, x, tv1 );                         // tv1 = 1 - c1*u^2"
+      , "  " ++ prefix_p ++ "add( y, x, tv2 );                         // tv2 = 1 + c1*u^2"
+      , "  " ++ prefix_p ++ "mul( u, tv1, tv4 );"
+      , "  " ++ prefix_p ++ "mul_inplace( tv4, inv_den );"
+      , "  " ++ prefix_p ++ "mul_inplace( tv4, " ++ prefix ++ "h2c_c3 );       // tv4 = c3 * u / (1 + c1*u^2)"
+      , "  " ++ prefix_p ++ "sub( " ++ prefix ++ "h2c_c2, tv4, x );             // x1 = c2 - tv4"
+      , "  " ++ prefix ++ "h2c_rhs( " ++ prefix ++ "const_A, " ++ prefix ++ "const_B, x, gx );"
+      , "  if (!" ++ prefix_p ++ "sqrt( gx, y )) {"
+      , "    " ++ prefix_p ++ "add( " ++ prefix ++ "h2c_c2, tv4, x );           // x2 = c2 + tv4"
+      , "    " ++ prefix ++ "h2c_rhs( " ++ prefix ++ "const_A, " ++ prefix ++ "const_B, x, gx );"
+      , "    if (!" ++ prefix_p ++ "sqrt( gx, y )) {"
+      , "      // x3 = Z + c4 * ( (1 + c1*u^2)^2 / ((1 - c1*u^2)*(1 + c1*u^2)) )^2"
+      , "      " ++ prefix_p ++ "sqr( tv2, x );"
+      , "      " ++ prefix_p ++ "mul_inplace( x, inv_den );"
+      , "      " ++ prefix_p ++ "sqr_inplace( x );"
+      , "      " ++ prefix_p ++ "mul_inplace( x, " ++ prefix ++ "h2c_c4 );"
+      , "      " ++ prefix_p ++ "add_inplace( x, " ++ prefix ++ "h2c_Z );"
+      , "      " ++ prefix ++ "h2c_rhs( " ++ prefix ++ "const_A, " ++ prefix ++ "const_B, x, gx );"
+      , "      " ++ prefix_p ++ "sqrt( gx, y );"
+      , "    }"
+      , "  }"
+      , "  if (" ++ prefix ++ "h2c_sgn0( u ) != " ++ prefix ++ "h2c_sgn0( y )) {"
+      , "    " ++ prefix_p ++ "neg_inplace( y );"
+      , "  }"
+      , "  " ++ prefix_p ++ "copy( x, X3 );"
+      , "  " ++ prefix_p ++ "copy( y, Y3 );"
+      , "  " ++ prefix_p ++ "set_one( Z3 );"
+      , "}"
+      ]
+
+--------------------------------------------------------------------------------
@@ -77,12 +77,15 @@ msmCurve :: CodeGenParams -> Code
 msmCurve (CodeGenParams{..}) =
   [ "//------------------------------------------------------------------------------"
   , ""
-  , "#define SIDX(b) (SUMS + (b-1)*(3*NLIMBS_P))"
+  , "// the bucket sums are in XYZZ coordinates"
+  , "#define SIDX(b) (SUMS + (b-1)*(4*NLIMBS_P))"
   , ""
   , "// Multi-Scalar Multiplication (MSM)"
   , "// standard coefficients (NOT montgomery!)"
   , "// straightforward Pippenger bucketing method"
   , "// parametric bucket size"
+  , "// the buckets are accumulated in XYZZ coordinates (cheap mixed additions), and"
+  , "// only the window sums are converted back to " ++ point_repr ++ " coordinates"
   , "void " ++ prefix ++ "MSM_std_coeff_" ++ point_repr ++ "_out_variable(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs, int window_size) {"
   , ""
   , "  assert( (window_size > 0) && (window_size <= 64) );"
@@ -93,7 +96,7 @@ msmCurve (CodeGenParams{..}) =
   , "  " ++ prefix ++ "set_infinity(tgt);"
   , ""
   , "  // allocate memory for bucket sums"
-  , "  uint64_t *SUMS = malloc( 3*8*NLIMBS_P * (nbuckets-1) );"
+  , "  uint64_t *SUMS = malloc( 4*8*NLIMBS_P * (nbuckets-1) );"
   , "  assert( SUMS !=0 );"
   , ""
   , "  // loop over the windows"
@@ -122,7 +125,7 @@ msmCurve (CodeGenParams{..}) =
   , ""
   , "    // initalize bucket sums"
   , "    for( int b=nbuckets-1; b>0; b-- ) { "
-  , "      " ++ prefix ++ "set_infinity( SIDX(b) );"
+  , "      " ++ prefix_xyzz ++ "set_infinity( SIDX(b) );"
   , "    }"
   , ""
   , "    // compute bucket sums"
@@ -136,22 +139,24 @@ msmCurve (CodeGenParams{..}) =
   , "      e &= mask;   // bucket coeff"
   , ""
   , "      if (e>0) {"
-  , "        " ++ prefix ++ "madd_" ++ point_repr ++ "_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );"
+  , "        " ++ prefix_xyzz ++ "madd_xyzz_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );"
   , "      }"
   , "    }"
   , ""
   , "    // compute running sums"
   , ""
-  , "    uint64_t T[3*NLIMBS_P];   // cumulative sum of S-es"
-  , "    uint64_t R[3*NLIMBS_P];   // running sum = sum of T-s"
+  , "    uint64_t T[4*NLIMBS_P];   // cumulative sum of S-es"
+  , "    uint64_t R[4*NLIMBS_P];   // running sum = sum of T-s"
+  , "    uint64_t W[3*NLIMBS_P];   // the window sum, converted back"
   , ""
-  , "    " ++ prefix ++ "set_infinity(T);"
-  , "    " ++ prefix ++ "set_infinity(R);"
+  , "    " ++ prefix_xyzz ++ "set_infinity(T);"
+  , "    " ++ prefix_xyzz ++ "set_infinity(R);"
   , ""
   , "    for( int b=nbuckets-1; b>0; b-- ) { "
-  , "      " ++ prefix ++ "add_inplace( T , SIDX(b) );"
-  , "      " ++ prefix ++ "add_inplace( R , T       );"
+  , "      " ++ prefix_xyzz ++ "add_inplace( T , SIDX(b) );"
+  , "      " ++ prefix_xyzz ++ "add_inplace( R , T       );"
   , "    }"
+  , "    " ++ prefix_xyzz ++ "to_" ++ point_repr ++ "( R , W );"
   , ""
   , "    if (!" ++ prefix ++ "is_infinity(tgt)) {    // we can skip doubling when infinity"
   , "      for(int i=0; i<window_size; i++) {"
@@ -159,7 +164,7 @@ msmCurve (CodeGenParams{..}) =
   , "      }"
   , "    }"
   , ""
-  , "    " ++ prefix ++ "add_inplace( tgt, R );"
+  , "    " ++ prefix ++ "add_inplace( tgt, W );"
   , "  }"
   , ""
   , "  free(SUMS);"
@@ -18,6 +18,7 @@ import Zikkurat.CodeGen.Misc
 
 import Zikkurat.CodeGen.Curve.Params
 import Zikkurat.CodeGen.Curve.CurveFFI
+import Zikkurat.CodeGen.Curve.Shared
 import Zikkurat.CodeGen.Curve.MSM
 import Zikkurat.CodeGen.Curve.FFT
 
@@ -35,6 +36,7 @@ c_header cgparams@(CodeGenParams{..}) =
   , "extern void " ++ prefix ++ "to_affine   ( const uint64_t *src , uint64_t *tgt );"
   , "extern void " ++ prefix ++ "batch_from_affine( int N, const uint64_t *src , uint64_t *tgt );"
   , "extern void " ++ prefix ++ "batch_to_affine  ( int N, const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt );"
   , ""
   , "extern uint8_t " ++ prefix ++ "is_on_curve   ( const uint64_t *src );"
   , "extern uint8_t " ++ prefix ++ "is_infinity   ( const uint64_t *src );"
@@ -88,6 +90,7 @@ hsFFI (CodeGenParams{..}) = catCode $
   , mkffi "toAffine"    $ cfun "to_affine"        (CTyp [CArgInProj   , CArgOutAffine ] CRetVoid)
   , mkffi "batchFromAffine"  $ cfun "batch_from_affine"      (CTyp [CArgCount, CArgInAffineArray , CArgOutProjArray   ] CRetVoid)
   , mkffi "batchToAffine"    $ cfun "batch_to_affine"        (CTyp [CArgCount, CArgInProjArray   , CArgOutAffineArray ] CRetVoid)
+  , mkffi "batchToAffineParallel" $ cfun "batch_to_affine_parallel" (CTyp [CArgCount, CArgInProjArray , CArgOutAffineArray ] CRetVoid)
     --
   , mkffi "neg"         $ cfun "neg"              (CTyp [CArgInProj              , CArgOutProj ] CRetVoid)
   , mkffi "dbl"         $ cfun "dbl"              (CTyp [CArgInProj              , CArgOutProj ] CRetVoid)
@@ -123,26 +126,25 @@ hsFFI (CodeGenParams{..}) = catCode $
 
 --------------------------------------------------------------------------------
 
-hsBegin :: Curve1 -> CodeGenParams -> Code
-hsBegin (Curve1{..}) (CodeGenParams{..}) =
-  [ "-- | " ++ curveName ++ " curve, Jacobian (or weighted) projective coordinates, Montgomery field representation"
+hsBegin :: XCurve -> CodeGenParams -> Code
+hsBegin xcurve cgparams@(CodeGenParams{..}) =
+  [ "-- | " ++ full_curvename xcurve ++ " curve, Jacobian (or weighted) projective coordinates, Montgomery field representation"
   , "--"
   , "-- * NOTE 1: This module is intented to be imported qualified"
   , "--"
   , "-- * NOTE 2: Generated code, do not edit!"
   , "--"
   , ""
-  , "{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies #-}"
+  , "{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies, PatternSynonyms #-}"
   , "module " ++ hsModule hs_path_jac
   , "  ( " ++ typeName ++ "(..)"
-  , "  , primeP , primeR , cofactor , curveA , curveB"
-  , "    -- * Parameters"
-  , "  , genG1 , infinity"
-  , "    -- * Curve points"
+  ] ++ 
+  hsExportParams xcurve ++
+  [ "    -- * Curve points"
   , "  , coords , mkPoint , mkPointMaybe , unsafeMkPoint"
   , "    -- * Conversion to\\/from affine"
   , "  , fromAffine , toAffine"
-  , "  , batchFromAffine , batchToAffine"
+  , "  , batchFromAffine , batchToAffine , batchToAffineParallel"
   , "  , normalize"
   , "    -- * Predicates"
   , "  , isEqual , isSame"
@@ -152,7 +154,7 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "    -- * Scaling"
   , "  , sclFr , sclBig , sclSmall"
   , "    -- * Random"
-  , "  , rndG1 , rndG1_naive"
+  , "  , rnd" ++ typeName ++ " , rnd" ++ typeName ++ "_naive"
   , "    -- * Multi-scalar multiplication"
   , "  , msm , msmStd , msmJac"
   , "    -- * Fast-Fourier transform"
@@ -175,13 +177,30 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , ""
   , "import System.IO.Unsafe"
   , ""
-  , "import " ++ hsModule hs_path_p ++ " ( Fp(..) )"
-  , "import " ++ hsModule hs_path_r ++ " ( Fr(..) )"
-  , "import qualified " ++ hsModule hs_path_p ++ " as Fp"
-  , "import qualified " ++ hsModule hs_path_r ++ " as Fr"
-  , "import qualified " ++ hsModule hs_path_r_std 
-  , "import qualified " ++ hsModule hs_path_big_p ++ " as BigP"
-  , ""
+  ] ++
+  (case xcurve of
+    Left _ ->
+      [ "import " ++ hsModule hs_path_p ++ " ( Fp(..) )"
+      , "import " ++ hsModule hs_path_r ++ " ( Fr(..) )"
+      , "import qualified " ++ hsModule hs_path_p ++ " as Fp"
+      , "import qualified " ++ hsModule hs_path_p ++ " as Base"
+      , "import qualified " ++ hsModule hs_path_r ++ " as Fr"
+      , "import qualified " ++ hsModule hs_path_r_std 
+      , "import qualified " ++ hsModule hs_path_big_p ++ " as BigP"
+      ]
+    Right _ -> 
+      [ "import " ++ hsModule hs_path_p   ++ " ( Fp(..)  )"
+      , "import " ++ hsModule hs_path_fp2 ++ " ( Fp2(..) )"
+      , "import " ++ hsModule hs_path_r   ++ " ( Fr(..)  )"
+      , "import qualified " ++ hsModule hs_path_p   ++ " as Fp"
+      , "import qualified " ++ hsModule hs_path_fp2 ++ " as Fp2"
+      , "import qualified " ++ hsModule hs_path_fp2 ++ " as Base"
+      , "import qualified " ++ hsModule hs_path_r   ++ " as Fr"
+      , "import qualified " ++ hsModule hs_path_r_std 
+      , "import qualified " ++ hsModule hs_path_big_p ++ " as BigP"
+      ]
+  ) ++
+  [ ""
   , "import {-# SOURCE #-} qualified " ++ hsModule hs_path_affine  -- ++ " as Affine" 
   , ""
   , "import           ZK.Algebra.Class.Flat ( FlatArray(..) )"
@@ -193,45 +212,31 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , ""
   , "--------------------------------------------------------------------------------"
   , ""
-  , "-- | The sizes of the fields Fp, Fr, and the cofactor of the subgroup G1"
-  , "primeP, primeR, cofactor :: Integer"
-  , "primeP = Fp.prime"
-  , "primeR = Fr.prime"
-  , "cofactor = " ++ show cofactor
-  , ""
-  , "-- | parameters A and B of the curve equation @y^2 = x^3 + A*x + B@"
-  , "curveA, curveB :: Fp"  -- Integer
-  , "curveA = " ++ show curveA
-  , "curveB = " ++ show curveB
-  , ""
-  , "-- | generator of the r-sized subgroup G1"
-  , "genG1 :: " ++ typeName
-  , "genG1 = mkPoint (x, y, Fp.one) where"
-  , "  x = " ++ show (fst subgroupGen)
-  , "  y = " ++ show (snd subgroupGen)
-  , ""
+  ] ++ 
+  hsBegin_xcurve True xcurve cgparams ++
+  [ ""
   , "--------------------------------------------------------------------------------"
   , ""
   , "-- | An elliptic curve point, in Jacobian (weighted projective) coordinates"
   , "newtype " ++ typeName ++ " = Mk" ++ typeName ++ " (ForeignPtr Word64)"
   , ""
   , "-- | Note: this throws an exception if the point is not on the curve"
-  , "mkPoint :: (Fp, Fp, Fp) -> " ++ typeName
+  , "mkPoint :: (Base, Base, Base) -> " ++ typeName
   , "mkPoint xyz = case mkPointMaybe xyz of"
   , "  Just pt -> pt"
   , "  Nothing -> error \"mkPoint: point is not on the curve\""
   , ""
-  , "mkPointMaybe :: (Fp, Fp, Fp) -> Maybe " ++ typeName
+  , "mkPointMaybe :: (Base, Base, Base) -> Maybe " ++ typeName
   , "mkPointMaybe xyz = let pt = unsafeMkPoint xyz in"
   , "  case isOnCurve pt of { True -> Just pt ; False -> Nothing }"
   , ""
   , "-- | The point at infinity, @{1 : 1 : 0}@"
   , "infinity :: " ++ typeName
-  , "infinity = unsafeMkPoint (Fp.one, Fp.one, Fp.zero)"
+  , "infinity = unsafeMkPoint (Base.one, Base.one, Base.zero)"
   , ""
   , "{-# NOINLINE unsafeMkPoint #-}"
-  , "unsafeMkPoint :: (Fp, Fp, Fp) -> " ++ typeName
-  , "unsafeMkPoint (MkFp fptr1 , MkFp fptr2 , MkFp fptr3) = unsafePerformIO $ do"
+  , "unsafeMkPoint :: (Base, Base, Base) -> " ++ typeName
+  , "unsafeMkPoint (MkBase fptr1 , MkBase fptr2 , MkBase fptr3) = unsafePerformIO $ do"
   , "  fptr4 <- mallocForeignPtrArray " ++ show (3*nlimbs_p)
   , "  withForeignPtr fptr1 $ \\ptr1 -> do"
   , "    withForeignPtr fptr2 $ \\ptr2 -> do"
@@ -243,7 +248,7 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "  return (Mk" ++ typeName ++ " fptr4)"
   , ""
   , "{-# NOINLINE coords #-}"
-  , "coords :: " ++ typeName ++ " -> (Fp, Fp, Fp)"
+  , "coords :: " ++ typeName ++ " -> (Base, Base, Base)"
   , "coords (Mk" ++ typeName ++ " fptr4) = unsafePerformIO $ do"
   , "  fptr1 <- mallocForeignPtrArray " ++ show (nlimbs_p)
   , "  fptr2 <- mallocForeignPtrArray " ++ show (nlimbs_p)
@@ -255,18 +260,18 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "          copyBytes ptr1 (        ptr4 " ++                      "  ) " ++ show (8*nlimbs_p)
   , "          copyBytes ptr2 (plusPtr ptr4 " ++ show (  8*nlimbs_p) ++ ") " ++ show (8*nlimbs_p)
   , "          copyBytes ptr3 (plusPtr ptr4 " ++ show (2*8*nlimbs_p) ++ ") " ++ show (8*nlimbs_p)
-  , "  return (MkFp fptr1, MkFp fptr2, MkFp fptr3)"
+  , "  return (MkBase fptr1, MkBase fptr2, MkBase fptr3)"
   , ""
-  , "-- | Returns a uniformly random element /in the subgroup G1/."
+  , "-- | Returns a uniformly random element /in the subgroup " ++ typeName ++ "/."
   , "-- Note: this is slow, because it uses exponentiation."
-  , "rndG1_naive :: IO " ++ typeName
-  , "rndG1_naive = do"
+  , "rnd" ++ typeName ++ "_naive :: IO " ++ typeName
+  , "rnd" ++ typeName ++ "_naive = do"
   , "  k <- Fr.rnd :: IO Fr"
-  , "  return (sclFr k genG1)"
+  , "  return (sclFr k gen" ++ typeName ++ ")"
   , "" 
-  , "-- | Returns a uniformly random element /in the subgroup G1/"
-  , "rndG1 :: IO " ++ typeName
-  , "rndG1 = rndG1_naive"
+  , "-- | Returns a uniformly random element /in the subgroup " ++ typeName ++ "/."
+  , "rnd" ++ typeName ++ " :: IO " ++ typeName
+  , "rnd" ++ typeName ++ " = rnd" ++ typeName ++ "_naive"
   , ""
   , "--------------------------------------------------------------------------------"
   , ""
@@ -288,10 +293,10 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "  makeFlat = L.makeFlatGeneric Mk" ++ typeName ++ " " ++ show (3*nlimbs_p)
   , ""
   , "instance M.Rnd " ++ typeName ++ " where"
-  , "  rndIO = rndG1"
+  , "  rndIO = rnd" ++ typeName
   , ""
   , "instance C.Group " ++ typeName ++ " where"
-  , "  grpName _    = \"" ++ curveName ++ " / G1\""
+  , "  grpName _    = \"" ++ x_groupname xcurve ++ "\""
   , "  grpIsUnit    = " ++ hsModule hs_path_jac ++ ".isInfinity"
   , "  grpUnit      = " ++ hsModule hs_path_jac ++ ".infinity"
   , "  grpNormalize = normalize"
@@ -303,13 +308,13 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "  grpScale     = sclBig"
   , ""
   , "instance C.Curve " ++ typeName ++ " where"
-  , "  curveNamePxy _ = \"" ++ curveName ++ " ( Fp )\""
-  , "  type BaseField   " ++ typeName ++ " = Fp"
+  , "  curveNamePxy _ = \"" ++ full_curvename xcurve ++ "\""
+  , "  type BaseField   " ++ typeName ++ " = Base"
   , "  type ScalarField " ++ typeName ++ " = Fr"
   , "  isOnCurve   = " ++ hsModule hs_path_jac ++ ".isOnCurve"
   , "  isInfinity  = " ++ hsModule hs_path_jac ++ ".isInfinity"
   , "  infinity    = " ++ hsModule hs_path_jac ++ ".infinity"
-  , "  curveSubgroupGen = " ++ hsModule hs_path_jac ++ ".genG1"
+  , "  curveSubgroupGen = " ++ hsModule hs_path_jac ++ ".gen" ++ typeName
   , "  scalarMul   = " ++ hsModule hs_path_jac ++ ".sclFr"
   , "  msm         = " ++ hsModule hs_path_jac ++ ".msmJac"
 --  , "  msmStd      = " ++ hsModule hs_path_jac ++ ".msmStd"
@@ -319,9 +324,9 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "instance C.ProjCurve " ++ typeName ++ " where"
   , "  type AffinePoint " ++ typeName ++ " = " ++ hsModule hs_path_affine ++ "." ++ typeName
   , "  fromAffine = " ++ hsModule hs_path_jac ++ ".fromAffine"
+  , "  toAffine   = " ++ hsModule hs_path_jac ++ ".toAffine"
   , "  batchFromAffine = " ++ hsModule hs_path_jac ++ ".batchFromAffine"
   , "  batchToAffine   = " ++ hsModule hs_path_jac ++ ".batchToAffine"
-  , "  toAffine   = " ++ hsModule hs_path_jac ++ ".toAffine"
   , "  coords3    = " ++ hsModule hs_path_jac ++ ".coords"
   , "  mkPoint3   = " ++ hsModule hs_path_jac ++ ".mkPoint"
   , "  mixedAdd   = " ++ hsModule hs_path_jac ++ ".madd"
@@ -329,13 +334,13 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
   , "  "
   , "--------------------------------------------------------------------------------"
   , ""
-  , "sclSmall :: Int -> G1 -> G1"
+  , "sclSmall :: Int -> " ++ typeName ++ " -> " ++ typeName
   , "sclSmall k pt"
   , "  | k == 0    = infinity"
   , "  | k < 0     = neg $ sclSmallNonNeg (negate k) pt"
   , "  | otherwise =       sclSmallNonNeg (       k) pt"
   , ""
-  , "sclBig :: Integer -> G1 -> G1"
+  , "sclBig :: Integer -> " ++ typeName ++ " -> " ++ typeName
   , "sclBig k pt"
   , "  | k == 0    = infinity"
   , "  | k < 0     = neg $ sclBigNonNeg (fromInteger $ negate k) pt"
@@ -351,9 +356,9 @@ hsBegin (Curve1{..}) (CodeGenParams{..}) =
 
 --------------------------------------------------------------------------------
 
-c_begin :: Curve1 -> CodeGenParams -> Code
-c_begin curve@(Curve1{..}) cgparams@(CodeGenParams{..}) =
-  [ "// elliptic curve " ++ show curveName ++ " in projective coordinates, Montgomery field representation"
+c_begin :: XCurve -> CodeGenParams -> Code
+c_begin xcurve cgparams@(CodeGenParams{..}) =
+  [ "// elliptic curve " ++ show (full_curvename xcurve) ++ " in Jacobian coordinates, Montgomery field representation"
   , "//"
   , "// NOTE: generated code, do not edit!"
   , ""
@@ -365,8 +370,11 @@ c_begin curve@(Curve1{..}) cgparams@(CodeGenParams{..}) =
   , ""
   , "#include \"" ++ pathBaseName c_path_jac   ++ ".h\""
   , "#include \"" ++ pathBaseName c_path_affine ++ ".h\""
+  , "#include \"" ++ pathBaseName c_path_xyzz   ++ ".h\""
   , "#include \"" ++ c_basename_p  ++ ".h\""
   , "#include \"" ++ c_basename_r  ++ ".h\""
+  , "#include \"bigint" ++ show (64*nlimbs_r) ++ ".h\""
+  , "#include \"parallel.h\""
   , ""
   , "#define NLIMBS_P " ++ show nlimbs_p
   , "#define NLIMBS_R " ++ show nlimbs_r
@@ -383,134 +391,14 @@ c_begin curve@(Curve1{..}) cgparams@(CodeGenParams{..}) =
   , "#define Y3 (tgt + " ++ show (  nlimbs_p) ++ ")"
   , "#define Z3 (tgt + " ++ show (2*nlimbs_p) ++ ")"
   , ""
-  , "// the generator of the subgroup G1"
-  , mkConstArr nlimbs_p (prefix ++ "gen_G1") (map toMontgomery [ fst subgroupGen, snd subgroupGen , 1 ])
-  , ""
-  , "// the cofactor of the curve subgroup = " ++ show cofactor
-  , mkConst nlimbs_p (prefix ++ "cofactor") cofactor
-  , ""
+  ] ++
+  (case xcurve of 
+    Left  curve1  -> c_begin_curve1 True curve1  cgparams
+    Right curve12 -> c_begin_curve2 True curve12 cgparams
+  ) ++
+  [ ""
   , "//------------------------------------------------------------------------------"
   ] 
-  where
-    toMontgomery x = mod ( 2^(64*nlimbs_p) * x ) curveFp
-
---------------------------------------------------------------------------------
-
-scale_by_A ::  Curve1 -> CodeGenParams -> Code
-scale_by_A (Curve1{..}) (CodeGenParams{..}) = case curveA of
-
-  0 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       ]
-
-  1 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  // no-op"
-       , "}"
-       ]
-
-  2 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add( src, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tgt );"
-       , "}"
-       ]
-
-  _ -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "scl( " ++ show curveA ++ ", src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "scl_inplace( tgt, " ++ show curveA ++ " );"
-       , "}"
-       ]
-
-----------------------------------------
-
-scale_by_B ::  Curve1 -> CodeGenParams -> Code
-scale_by_B (Curve1{..}) (CodeGenParams{..}) = case curveB of
-
-  0 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       ]
-
-  1 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  // no-op"
-       , "}"
-       ]
-
-  2 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add( src, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tgt );"
-       , "}"
-       ]
-
-  3 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );"
-       , "  " ++ prefix_p ++ "add( src, tmp, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tmp );"
-       , "}"
-       ]
-
-  4 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );"
-       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
-       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
-       , "}"
-       ]
-
-  _ -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "scl( " ++ show curveB ++ ", src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "scl_inplace( tgt, " ++ show curveB ++ " );"
-       , "}"
-       ]
 
 --------------------------------------------------------------------------------
 
@@ -606,15 +494,90 @@ convertAffine (CodeGenParams{..}) =
   , "  }"
   , "}"
   , ""
-  , "// converts N points to affine coordinates"
+  , "// converts N points to affine coordinates, using a single field inversion for"
+  , "// all of them (Montgomery's batch inversion trick). Points at infinity are skipped"
+  , "// in the running product, and result in the special affine infinity."
+  , "// Note: the output may overlap with the input, as long as `tgt <= src`"
   , "void " ++ prefix ++ "batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {"
-  , "  const uint64_t *p = src;"
-  , "  uint64_t *q = tgt;"
+  , "  if (N <= 0) return;"
+  , "  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );"
+  , "  assert( zinvs != 0 );"
+  , ""
+  , "  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th"
+  , "  uint64_t acc[NLIMBS_P];"
+  , "  " ++ prefix_p ++ "set_one( acc );"
   , "  for(int i=0; i<N; i++) {"
-  , "    " ++ prefix ++ "to_affine(p,q);"
-  , "    p += 3*NLIMBS_P;"
-  , "    q += 2*NLIMBS_P;"
+  , "    const uint64_t *z = src + (3*i+2)*NLIMBS_P;"
+  , "    " ++ prefix_p ++ "copy( acc , zinvs + i*NLIMBS_P );"
+  , "    if (!" ++ prefix_p ++ "is_zero( z )) { " ++ prefix_p ++ "mul_inplace( acc , z ); }"
+  , "  }"
+  , ""
+  , "  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]"
+  , "  " ++ prefix_p ++ "inv_inplace( acc );"
+  , "  for(int i=N-1; i>=0; i--) {"
+  , "    const uint64_t *z = src + (3*i+2)*NLIMBS_P;"
+  , "    if (!" ++ prefix_p ++ "is_zero( z )) {"
+  , "      " ++ prefix_p ++ "mul_inplace( zinvs + i*NLIMBS_P , acc );"
+  , "      " ++ prefix_p ++ "mul_inplace( acc , z );"
+  , "    }"
   , "  }"
+  , ""
+  , "  for(int i=0; i<N; i++) {"
+  , "    const uint64_t *p = src + 3*i*NLIMBS_P;"
+  , "    uint64_t       *q = tgt + 2*i*NLIMBS_P;"
+  , "    if (" ++ prefix_p ++ "is_zero( p + 2*NLIMBS_P )) {"
+  , "      memset( q, 0xff, " ++ show (8*2*nlimbs_p) ++ " );"
+  , "    }"
+  , "    else {"
+  , "      const uint64_t *zinv = zinvs + i*NLIMBS_P;"
+  , "      uint64_t zinv2[NLIMBS_P];"
+  , "      uint64_t zinv3[NLIMBS_P];"
+  , "      " ++ prefix_p ++ "sqr( zinv , zinv2 );"
+  , "      " ++ prefix_p ++ "mul( zinv , zinv2 , zinv3 );"
+  , "      " ++ prefix_p ++ "mul( p            , zinv2 , q            );"
+  , "      " ++ prefix_p ++ "mul( p + NLIMBS_P , zinv3 , q + NLIMBS_P );"
+  , "    }"
+  , "  }"
+  , ""
+  , "  free(zinvs);"
+  , "}"
+  , ""
+  , "// below this many points, the parallel version simply calls the sequential one"
+  , "#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024"
+  , ""
+  , "typedef struct {"
+  , "  int N;"
+  , "  int chunk;"
+  , "  const uint64_t *src;"
+  , "  uint64_t *tgt;"
+  , "} " ++ prefix ++ "batch_to_affine_ctx_t;"
+  , ""
+  , "void " ++ prefix ++ "batch_to_affine_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "batch_to_affine_ctx_t *c = (" ++ prefix ++ "batch_to_affine_ctx_t*) ctx;"
+  , "  int a = j * c->chunk;"
+  , "  int b = a + c->chunk;"
+  , "  if (b > c->N) { b = c->N; }"
+  , "  " ++ prefix ++ "batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );"
+  , "}"
+  , ""
+  , "// converts N points to affine coordinates, splitting them into chunks which are"
+  , "// converted in parallel (each chunk with a single inversion). For small inputs,"
+  , "// or with a single thread, this is the same as `batch_to_affine`."
+  , "// Note: unlike `batch_to_affine`, the output must not overlap with the input"
+  , "void " ++ prefix ++ "batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {"
+  , "  int T = parallel_get_num_threads();"
+  , "  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {"
+  , "    " ++ prefix ++ "batch_to_affine( N, src, tgt );"
+  , "    return;"
+  , "  }"
+  , "  int chunk = (N + T - 1) / T;"
+  , "  int m     = (N + chunk - 1) / chunk;"
+  , "  " ++ prefix ++ "batch_to_affine_ctx_t ctx;"
+  , "  ctx.N     = N;"
+  , "  ctx.chunk = chunk;"
+  , "  ctx.src   = src;"
+  , "  ctx.tgt   = tgt;"
+  , "  parallel_for( m, " ++ prefix ++ "batch_to_affine_task, &ctx );"
   , "}"
   , ""
   , "void " ++ prefix ++ "copy( const uint64_t *src1 , uint64_t *tgt ) {"
@@ -622,8 +585,8 @@ convertAffine (CodeGenParams{..}) =
   , "}"  
   ]
 
-isOnCurve :: Curve1 -> CodeGenParams -> Code
-isOnCurve (Curve1{..}) (CodeGenParams{..}) = 
+isOnCurve :: XCurve -> CodeGenParams -> Code
+isOnCurve xcurve (CodeGenParams{..}) = 
   [ "uint8_t " ++ prefix ++ "is_infinity ( const uint64_t *src1 ) {"
   , "  if ( ( " ++ prefix_p ++ "is_zero( Z1 )) &&"
   , "       (!" ++ prefix_p ++ "is_zero( X1 )) &&"
@@ -664,13 +627,13 @@ isOnCurve (Curve1{..}) (CodeGenParams{..}) =
   , "  " ++ prefix_p ++ "sqr( Z1 , ZZ2 );            // Z^2"
   , "  " ++ prefix_p ++ "sqr( ZZ2, ZZ4 );            // Z^4"
   ] ++ 
-  (if curveA == 0 then [] else 
+  (if isCurveAZero xcurve then [] else 
     [ "  " ++ prefix_p ++ "mul( X1, ZZ4, tmp );          // X*Z^4"
     , "  " ++ prefix   ++ "scale_by_A_inplace( tmp );   // A*X*Z^4"
     , "  " ++ prefix_p ++ "add_inplace( acc, tmp );     // - Y^2 + X^3 + A*X*Z^4"
     ]
   ) ++ 
-  (if curveB == 0 then [] else 
+  (if isCurveBZero xcurve then [] else 
     [ "  " ++ prefix_p ++ "mul( ZZ2, ZZ4, tmp );        // Z^6"
     , "  " ++ prefix   ++ "scale_by_B_inplace( tmp );   // B*Z^6"
     , "  " ++ prefix_p ++ "add_inplace( acc, tmp );     // - Y^2 + X^3 + A*X*Z^4 + B*Z^6"
@@ -681,14 +644,14 @@ isOnCurve (Curve1{..}) (CodeGenParams{..}) =
   , "             (!" ++ prefix_p ++ "is_zero( Y1 )) ) );"
   , "}"
   , ""
-  , "// checks whether the given point is in the subgroup G1"
+  , "// checks whether the given point is in the subgroup " ++ typeName
   , "uint8_t " ++ prefix ++ "is_in_subgroup ( const uint64_t *src1 ) {"
   , "  uint64_t tmp[" ++ show (3*nlimbs_p) ++ "];"
   , "  if (!" ++ prefix ++ "is_on_curve(src1)) {"
   , "    return 0;"
   , "  }"
   , "  else {"
-  , "    " ++ prefix ++ "scl_Fr_std( " ++ prefix ++ "cofactor , src1 , tmp );"
+  , "    " ++ prefix ++ "scl_generic( " ++ prefix ++ "subgroup_order , src1 , tmp , NLIMBS_R );"
   , "    return " ++ prefix ++ "is_infinity( tmp );"
   , "  }"
   , "}"
@@ -713,7 +676,6 @@ negCurve (CodeGenParams{..}) =
 --------------------------------------------------------------------------------
 
 {-
- -- actuall this is the same as below, we don't need to reimplement it
  formula from https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-0.html#doubling-dbl-2009-l
  assumptions: a = 0
       A = X1^2
@@ -726,9 +688,46 @@ negCurve (CodeGenParams{..}) =
       Y3 = E*(D-X3)-8*C
       Z3 = 2*Y1*Z1
 
-dblCurveA0 :: Curve -> CodeGenParams -> Code
-dblCurveA0  = dblCurve
+ cost: 2M + 5S (versus 1M + 7S for dbl-2007-bl, which needs Z1^2 for Z3)
 -}
+dblCurveA0 :: CodeGenParams -> Code
+dblCurveA0 (CodeGenParams{..}) =
+  [ "// doubles an elliptic curve point, assuming A = 0" 
+  , "// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-0.html#doubling-dbl-2009-l>"
+  , "void " ++ prefix ++ "dbl( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  uint64_t A[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t B[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t C[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t D[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t E[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "sqr( X1, A );               // A  = X1^2"
+  , "  " ++ prefix_p ++ "sqr( Y1, B );               // B  = Y1^2"
+  , "  " ++ prefix_p ++ "sqr( B , C );               // C  = B^2"
+  , "  " ++ prefix_p ++ "add( X1, B, D );            // D  = X1+B"
+  , "  " ++ prefix_p ++ "sqr_inplace( D );           // D  = (X1+B)^2"
+  , "  " ++ prefix_p ++ "sub_inplace( D, A );        // D  = (X1+B)^2 - A"
+  , "  " ++ prefix_p ++ "sub_inplace( D, C );        // D  = (X1+B)^2 - A - C"
+  , "  " ++ prefix_p ++ "add_inplace( D, D );        // D  = 2*((X1+B)^2 - A - C)"
+  , "  " ++ prefix_p ++ "add( A, A, E );             // E  = 2*A"
+  , "  " ++ prefix_p ++ "add_inplace( E, A );        // E  = 3*A"
+  , "  " ++ prefix_p ++ "mul( Y1, Z1, Z3 );          // Z3 = Y1*Z1"
+  , "  " ++ prefix_p ++ "add_inplace( Z3, Z3 );      // Z3 = 2*Y1*Z1"
+  , "  " ++ prefix_p ++ "sqr( E, X3 );               // X3 = F = E^2"
+  , "  " ++ prefix_p ++ "sub_inplace( X3, D );       // X3 = F - D"
+  , "  " ++ prefix_p ++ "sub_inplace( X3, D );       // X3 = F - 2*D"
+  , "  " ++ prefix_p ++ "sub( D, X3, Y3 );           // Y3 = D - X3"
+  , "  " ++ prefix_p ++ "mul_inplace( Y3, E );       // Y3 = E*(D - X3)"
+  , "  " ++ prefix_p ++ "add_inplace( C, C );        // 2*C"
+  , "  " ++ prefix_p ++ "add_inplace( C, C );        // 4*C"
+  , "  " ++ prefix_p ++ "add_inplace( C, C );        // 8*C"
+  , "  " ++ prefix_p ++ "sub_inplace( Y3, C );       // Y3 = E*(D - X3) - 8*C"
+  , "}"
+  , ""
+  , "// doubles an elliptic curve point" 
+  , "void " ++ prefix ++ "dbl_inplace( uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "dbl( tgt , tgt );"
+  , "}"
+  ]
 
 ----------------------------------------
 
@@ -745,8 +744,8 @@ dblCurveA0  = dblCurve
       Y3 = M*(S-T)-8*YYYY
       Z3 = (Y1+Z1)^2-YY-ZZ
 -}
-dblCurve :: Curve1 -> CodeGenParams -> Code
-dblCurve (Curve1{..}) (CodeGenParams{..}) =
+dblCurve :: XCurve -> CodeGenParams -> Code
+dblCurve xcurve (CodeGenParams{..}) =
   [ "// doubles an elliptic curve point" 
   , "// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html#doubling-dbl-2007-bl>"
   , "void " ++ prefix ++ "dbl( const uint64_t *src1, uint64_t *tgt ) {"
@@ -768,7 +767,7 @@ dblCurve (Curve1{..}) (CodeGenParams{..}) =
   , "  " ++ prefix_p ++ "add_inplace( S, S );     // = S = 2*((X1+YY)^2-XX-YYYY)"
   , "  " ++ prefix_p ++ "add( XX, XX, M );        // = 2*XX"
   , "  " ++ prefix_p ++ "add_inplace( M, XX );    // M = 3*XX"   
-  ] ++ (if curveA == 0 then [] else 
+  ] ++ (if isCurveAZero xcurve then [] else 
     [ "  " ++ prefix_p ++ "sqr( ZZ , T );              // = ZZ^2"
     , "  " ++ prefix   ++ "scale_by_A_inplace( T );    // = a*ZZ^2"
     , "  " ++ prefix_p ++ "add_inplace ( M , T );      // M = 3*XX + a*ZZ^2"
@@ -1020,7 +1019,7 @@ mixedAddCurve (CodeGenParams{..}) =
 scaleNaive :: CodeGenParams -> Code
 scaleNaive (CodeGenParams{..}) =
   [ "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is a (non-negative) bigint"
+  , "// where `grp` is a group element in " ++ typeName ++ ", and `expo` is a (non-negative) bigint"
   , "// naive algorithm"
   , "void " ++ prefix ++ "scl_naive(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {"
   , ""
@@ -1068,7 +1067,7 @@ scaleWindowed (CodeGenParams{..}) =
   , "}"
   , ""
   , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is a (non-negative) bigint"
+  , "// where `grp` is a group element in " ++ typeName ++ ", and `expo` is a (non-negative) bigint"
   , "// generic windowed algo, 4-bit windows"
   , "void " ++ prefix ++ "scl_windowed(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {"
   , ""
@@ -1104,19 +1103,19 @@ scaleWindowed (CodeGenParams{..}) =
 scaleFpFr :: CodeGenParams -> Code
 scaleFpFr (CodeGenParams{..}) =
   [ "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is in Fr"
+  , "// where `grp` is a group element in G, and `expo` is in Fr"
   , "void " ++ prefix ++ "scl_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int nlimbs) {"
   , "  " ++ prefix ++ "scl_windowed(expo, grp, tgt, nlimbs);"
   , "}"
   , ""
   , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is in Fr *in standard repr*"
+  , "// where `grp` is a group element in G, and `expo` is in Fr *in standard repr*"
   , "void " ++ prefix ++ "scl_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
   , "  " ++ prefix ++ "scl_generic(expo, grp, tgt, NLIMBS_R);"
   , "}"
   , ""
   , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is in Fr *in Montgomery repr*"
+  , "// where `grp` is a group element in G, and `expo` is in Fr *in Montgomery repr*"
   , "void " ++ prefix ++ "scl_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
   , "  uint64_t expo_std[NLIMBS_R];"
   , "  " ++ prefix_r ++ "to_std(expo, expo_std);"
@@ -1124,13 +1123,13 @@ scaleFpFr (CodeGenParams{..}) =
   , "}"
   , ""
   , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is the same size as Fp"
+  , "// where `grp` is a group element in G, and `expo` is the same size as Fp"
   , "void " ++ prefix ++ "scl_big(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
   , "  " ++ prefix ++ "scl_generic(expo, grp, tgt, NLIMBS_P);"
   , "}"
   , ""
   , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
-  , "// where `grp` is a group element in G1, and `expo` is a 64 bit (unsigned!) word"
+  , "// where `grp` is a group element in G, and `expo` is a 64 bit (unsigned!) word"
   , "void " ++ prefix ++ "scl_small(uint64_t expo, const uint64_t *grp, uint64_t *tgt) {"
   , "  uint64_t expo_vec[1];"
   , "  expo_vec[0] = expo;"
@@ -1140,20 +1139,21 @@ scaleFpFr (CodeGenParams{..}) =
 
 --------------------------------------------------------------------------------
 
-c_code :: Curve1 -> CodeGenParams -> Code
+c_code :: XCurve -> CodeGenParams -> Code
 c_code curve params = concat $ map ("":)
   [ c_begin     curve params
     --
-  , scale_by_A  curve params
-  , scale_by_B  curve params
+  , scale_by_AB3B curve params
     --
   , normalize       params
   , convertAffine   params
   , isOnCurve   curve    params
     --
   , negCurve        params
-  , dblCurve  curve params
-  , if curveA curve == 0
+  , if isCurveAZero curve
+      then dblCurveA0     params
+      else dblCurve curve params
+  , if isCurveAZero curve
       then addCurveA0     params
       else addCurve       params
   , subCurve            params
@@ -1161,13 +1161,13 @@ c_code curve params = concat $ map ("":)
     --
   , scaleNaive          params
   , scaleWindowed       params
-  , scaleFpFr           params
+  , scaleFpFr           params ++ scaleGLV curve params
     --
   , msmCurve            params
-  , c_group_fft (Left curve) params
+  , c_group_fft   curve params
   ]
 
-hs_code :: Curve1 -> CodeGenParams -> Code
+hs_code :: XCurve -> CodeGenParams -> Code
 hs_code curve params@(CodeGenParams{..}) = concat $ map ("":)
   [ hsBegin          curve params
   , msm_hs_binding   params
@@ -1177,7 +1177,7 @@ hs_code curve params@(CodeGenParams{..}) = concat $ map ("":)
 
 --------------------------------------------------------------------------------
 
-curve_MontJac_c_codegen :: FilePath -> Curve1 -> CodeGenParams -> IO ()
+curve_MontJac_c_codegen :: FilePath -> XCurve -> CodeGenParams -> IO ()
 curve_MontJac_c_codegen tgtdir curve params@(CodeGenParams{..}) = do
 
   let fn_h = tgtdir </> (cFilePath "h" c_path_jac)
@@ -1187,12 +1187,12 @@ curve_MontJac_c_codegen tgtdir curve params@(CodeGenParams{..}) = do
   createTgtDirectory fn_c
 
   putStrLn $ "writing `" ++ fn_h ++ "`" 
-  writeFile fn_h $ unlines $ c_header params
+  writeFile fn_h $ unlines $ c_header params ++ glv_c_header curve params
 
   putStrLn $ "writing `" ++ fn_c ++ "`" 
   writeFile fn_c $ unlines $ c_code curve params
 
-curve_MontJac_hs_codegen :: FilePath -> Curve1 -> CodeGenParams -> IO ()
+curve_MontJac_hs_codegen :: FilePath -> XCurve -> CodeGenParams -> IO ()
 curve_MontJac_hs_codegen tgtdir curve params@(CodeGenParams{..}) = do
 
   let fn_hs = tgtdir </> (hsFilePath hs_path_jac)
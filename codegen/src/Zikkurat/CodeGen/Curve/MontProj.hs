@@ -21,6 +21,10 @@ import Zikkurat.CodeGen.Curve.CurveFFI
 import Zikkurat.CodeGen.Curve.Shared
 import Zikkurat.CodeGen.Curve.MSM
 import Zikkurat.CodeGen.Curve.FFT
+import Zikkurat.CodeGen.Curve.FixedBase
+import Zikkurat.CodeGen.Curve.SRS
+import Zikkurat.CodeGen.Curve.Cofactor
+import Zikkurat.CodeGen.Curve.HashToCurve
 
 --------------------------------------------------------------------------------
 
@@ -36,6 +40,7 @@ c_header cgparams@(CodeGenParams{..}) =
   , "extern void " ++ prefix ++ "to_affine   ( const uint64_t *src , uint64_t *tgt );"
   , "extern void " ++ prefix ++ "batch_from_affine( int N, const uint64_t *src , uint64_t *tgt );"
   , "extern void " ++ prefix ++ "batch_to_affine  ( int N, const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt );"
   , ""
   , "extern uint8_t " ++ prefix ++ "is_on_curve   ( const uint64_t *src );"
   , "extern uint8_t " ++ prefix ++ "is_infinity   ( const uint64_t *src );"
@@ -68,14 +73,23 @@ c_header cgparams@(CodeGenParams{..}) =
   , "extern void " ++ prefix ++ "scl_naive   ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );"
   , "extern void " ++ prefix ++ "scl_windowed( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );"
   , ""
+  , "extern void " ++ prefix ++ "dbl_ct( const uint64_t *src ,       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "scl_ct_generic( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );"
+  , "extern void " ++ prefix ++ "scl_ct_Fr_std ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "scl_ct_Fr_mont( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );"
+  , ""
   ] ++
   (msm_c_header cgparams) ++ 
-  (fft_c_header cgparams)
+  (fft_c_header cgparams) ++
+  (comb_c_header cgparams) ++
+  (srs_c_header cgparams)
   
 --------------------------------------------------------------------------------
 
-hsFFI :: CodeGenParams -> Code
-hsFFI (CodeGenParams{..}) = catCode $ 
+hsFFI :: XCurve -> CodeGenParams -> Code
+hsFFI xcurve (CodeGenParams{..}) = catCode $ 
   [ mkffi "isOnCurve"    $ cfun "is_on_curve"     (CTyp [CArgInProj] CRetBool)
   , mkffi "isInfinity"   $ cfun "is_infinity"     (CTyp [CArgInProj] CRetBool)
   , mkffi "isInSubgroup" $ cfun "is_in_subgroup"  (CTyp [CArgInProj] CRetBool)
@@ -89,6 +103,7 @@ hsFFI (CodeGenParams{..}) = catCode $
   , mkffi "toAffine"    $ cfun "to_affine"        (CTyp [CArgInProj   , CArgOutAffine ] CRetVoid)
   , mkffi "batchFromAffine"  $ cfun "batch_from_affine"      (CTyp [CArgCount, CArgInAffineArray , CArgOutProjArray   ] CRetVoid)
   , mkffi "batchToAffine"    $ cfun "batch_to_affine"        (CTyp [CArgCount, CArgInProjArray   , CArgOutAffineArray ] CRetVoid)
+  , mkffi "batchToAffineParallel" $ cfun "batch_to_affine_parallel" (CTyp [CArgCount, CArgInProjArray , CArgOutAffineArray ] CRetVoid)
     --
   , mkffi "neg"         $ cfun "neg"              (CTyp [CArgInProj              , CArgOutProj ] CRetVoid)
   , mkffi "dbl"         $ cfun "dbl"              (CTyp [CArgInProj              , CArgOutProj ] CRetVoid)
@@ -100,6 +115,14 @@ hsFFI (CodeGenParams{..}) = catCode $
   , mkffi "sclFr"          $ cfun "scl_Fr_mont"   (CTyp [CArgInScalarR , CArgInProj , CArgOutProj ] CRetVoid)
   , mkffi "sclBigNonNeg"   $ cfun "scl_big"       (CTyp [CArgInBigIntP , CArgInProj , CArgOutProj ] CRetVoid)
   , mkffi "sclSmallNonNeg" $ cfun "scl_small"     (CTyp [CArgInt       , CArgInProj , CArgOutProj ] CRetVoid)
+  , mkffi "sclFrCT"        $ cfun "scl_ct_Fr_mont" (CTyp [CArgInScalarR , CArgInProj , CArgOutProj ] CRetVoid)
+    --
+  ] ++
+  (if hasGLV xcurve
+    then [ mkffi "sclFrGLV" $ cfun "scl_glv_Fr_mont" (CTyp [CArgInScalarR , CArgInProj , CArgOutProj ] CRetVoid) ]
+    else []
+  ) ++
+  [ mkffi "clearCofactor"  $ cfun "clear_cofactor" (CTyp [CArgInProj , CArgOutProj ] CRetVoid)
    --
 --  -- FOR DEBUGGING ONLY
 --  , mkffi "scaleByA"  $ cfun "scale_by_A"  (CTyp [CArgInScalarP , CArgOutScalarP ] CRetVoid)
@@ -140,7 +163,7 @@ hsBegin xcurve cgparams@(CodeGenParams{..}) =
   , "  , coords , mkPoint , mkPointMaybe , unsafeMkPoint"
   , "    -- * Conversion to\\/from affine"
   , "  , fromAffine , toAffine"
-  , "  , batchFromAffine , batchToAffine"
+  , "  , batchFromAffine , batchToAffine , batchToAffineParallel"
   , "  , normalize"
   , "    -- * Predicates"
   , "  , isEqual , isSame"
@@ -148,8 +171,26 @@ hsBegin xcurve cgparams@(CodeGenParams{..}) =
   , "    -- * Addition and doubling"
   , "  , neg , add , madd, dbl , sub"
   , "    -- * Scaling"
-  , "  , sclFr , sclBig , sclSmall"
-  , "    -- * Random"
+  , "  , sclFr , sclBig , sclSmall , sclFrCT"
+  ] ++
+  (if hasGLV xcurve
+    then [ "  , sclFrGLV" ]
+    else []
+  ) ++
+  [ "    -- * Cofactor clearing"
+  , "  , clearCofactor"
+  , "    -- * Fixed-base scaling"
+  , "  , sclGen , CombTable , combTable , sclComb"
+  , "    -- * Structured reference strings (for testing)"
+  , "  , srsMonomial , srsLagrange , srsToLagrange"
+  ] ++
+  (if hasHashToCurve xcurve
+    then [ "    -- * Hashing to the curve"
+         , "  , hashToCurve , encodeToCurve , hashToCurveMany"
+         ]
+    else []
+  ) ++
+  [ "    -- * Random"
   , "  , rnd" ++ typeName ++ " , rnd" ++ typeName ++ "_naive"
   , "    -- * Multi-scalar multiplication"
   , "  , msm , msmStd , msmProj"
@@ -269,7 +310,9 @@ hsBegin xcurve cgparams@(CodeGenParams{..}) =
   , "" 
   , "-- | Returns a uniformly random element /in the subgroup " ++ typeName ++ "/."
   , "rnd" ++ typeName ++ " :: IO " ++ typeName
-  , "rnd" ++ typeName ++ " = rnd" ++ typeName ++ "_naive"
+  , "rnd" ++ typeName ++ " = do"
+  , "  k <- Fr.rnd :: IO Fr"
+  , "  return (sclGen k)"
   , ""
   , "--------------------------------------------------------------------------------"
   , ""
@@ -368,9 +411,16 @@ c_begin xcurve cgparams@(CodeGenParams{..}) =
   , ""
   , "#include \"" ++ pathBaseName c_path_proj   ++ ".h\""
   , "#include \"" ++ pathBaseName c_path_affine ++ ".h\""
+  , "#include \"" ++ pathBaseName c_path_xyzz   ++ ".h\""
   , "#include \"" ++ c_basename_p  ++ ".h\""
   , "#include \"" ++ c_basename_r  ++ ".h\""
-  , ""
+  , "#include \"" ++ c_basename_arr_r ++ ".h\""
+  , "#include \"bigint" ++ show (64*nlimbs_r) ++ ".h\""
+  , "#include \"parallel.h\""
+  , "#include \"sha256.h\""
+  ] ++
+  (if c_basename_fp /= c_basename_p then [ "#include \"" ++ c_basename_fp ++ ".h\"" ] else []) ++
+  [ ""
   , "#define NLIMBS_P " ++ show nlimbs_p
   , "#define NLIMBS_R " ++ show nlimbs_r
   , ""
@@ -397,261 +447,6 @@ c_begin xcurve cgparams@(CodeGenParams{..}) =
 
 --------------------------------------------------------------------------------
 
-scale_by_AB3B :: XCurve -> CodeGenParams -> Code
-scale_by_AB3B xcurve params = case xcurve of
-  Left curve1 -> concat
-    [ g1_scale_by_A  curve1 params
-    , g1_scale_by_B  curve1 params
-    , g1_scale_by_3B curve1 params
-    ]
-  Right curve12 -> concat
-    [ g2_scale_by_A  curve12 params
-    , g2_scale_by_B  curve12 params
-    , g2_scale_by_3B curve12 params
-    ]
-
---------------------------------------------------------------------------------
-
-g2_scale_by_A :: Curve12 -> CodeGenParams -> Code
-g2_scale_by_A (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveA of
-  (0,0) -> [ "// scale an Fp2 field element by A = " ++ show g2_curveA
-           , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           ]
-
-  _ ->     [ "// scale an Fp2 field element by A = " ++ show g2_curveA
-           , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_A, src, tgt );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_A );"
-           , "}"
-           ]
-
-g2_scale_by_B :: Curve12 -> CodeGenParams -> Code
-g2_scale_by_B (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveB of
-  (0,0) -> [ "// scale an Fp2 field element by B = " ++ show g2_curveB
-           , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           ]
-
-  _ ->     [ "// scale an Fp field element by B = " ++ show g2_curveB
-           , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_B, src, tgt );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_B );"
-           , "}"
-           ]
-
-g2_scale_by_3B :: Curve12 -> CodeGenParams -> Code
-g2_scale_by_3B (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveB of
-  (0,0) -> [ "// scale an Fp2 field element by 3B = 3*" ++ show g2_curveB
-           , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-           , "}"
-           ]
-
-  _ ->     [ "// scale an Fp field element by 3B = 3*" ++ show g2_curveB
-           , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_3B, src, tgt );"
-           , "}"
-           , ""
-           , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-           , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_3B );"
-           , "}"
-           ]
-
---------------------------------------------------------------------------------
-
-g1_scale_by_A ::  Curve1 -> CodeGenParams -> Code
-g1_scale_by_A (Curve1{..}) (CodeGenParams{..}) = case curveA of
-
-  0 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       ]
-
-  1 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  // no-op"
-       , "}"
-       ]
-
-  2 -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add( src, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tgt );"
-       , "}"
-       ]
-
-  _ -> [ "// scale a field element by A = " ++ show curveA
-       , "void " ++ prefix ++ "scale_by_A(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_A, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_A_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_A );"
-       , "}"
-       ]
-
-----------------------------------------
-
-g1_scale_by_B ::  Curve1 -> CodeGenParams -> Code
-g1_scale_by_B (Curve1{..}) (CodeGenParams{..}) = case curveB of
-
-  0 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       ]
-
-  1 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  // no-op"
-       , "}"
-       ]
-
-  2 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add( src, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tgt );"
-       , "}"
-       ]
-
-  3 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );"
-       , "  " ++ prefix_p ++ "add( src, tmp, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
-       , "  " ++ prefix_p ++ "add_inplace( tgt, tmp );"
-       , "}"
-       ]
-
-  4 -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );"
-       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
-       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
-       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
-       , "}"
-       ]
-
-  _ -> [ "// scale a field element by B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_B, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_B );"
-       , "}"
-       ]
-
-----------------------------------------
-
-g1_scale_by_3B ::  Curve1 -> CodeGenParams -> Code
-g1_scale_by_3B (Curve1{..}) (CodeGenParams{..}) = case curveB of
-
-  0 -> [ "// scale a field element by (3*B) = " ++ show (3*curveB)
-       , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
-       , "}"
-       ]
-
-  3 -> [ "// scale a field element by (3*B) = " ++ show (3*curveB)
-       , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp[NLIMBS_P];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );       // 2*B"
-       , "  " ++ prefix_p ++ "add_inplace( tmp, tmp );    // 4*B"
-       , "  " ++ prefix_p ++ "add_inplace( tmp, tmp );    // 8*B"
-       , "  " ++ prefix_p ++ "add( src, tmp, tgt );       // 9*B"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix ++ "scale_by_3B( tgt , tgt );"
-       , "}"
-       ]
-
-  4  ->[ "// scale a field element by (3*B) = " ++ show (3*curveB)
-       , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  uint64_t tmp [NLIMBS_P];"
-       , "  uint64_t tmp2[NLIMBS_P];"
-       , "  " ++ prefix_p ++ "add( src, src, tmp );       // 2*B"
-       , "  " ++ prefix_p ++ "add_inplace( tmp, tmp );    // 4*B"
-       , "  " ++ prefix_p ++ "add( tmp, tmp, tmp2);       // 8*B"
-       , "  " ++ prefix_p ++ "add( tmp, tmp2, tgt );      // 12*B"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix ++ "scale_by_3B( tgt , tgt );"
-       , "}"
-       ]
-
-  _ -> [ "// scale a field element by 3B = " ++ show curveB
-       , "void " ++ prefix ++ "scale_by_3B(const uint64_t *src, uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_3B, src, tgt );"
-       , "}"
-       , ""
-       , "void " ++ prefix ++ "scale_by_3B_inplace( uint64_t *tgt ) {"
-       , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_3B );"
-       , "}"
-       ]
-
---------------------------------------------------------------------------------
-
 normalize :: CodeGenParams -> Code
 normalize (CodeGenParams{..}) =
   [ "void " ++ prefix ++ "normalize( const uint64_t *src1, uint64_t *tgt ) {"
@@ -736,15 +531,86 @@ convertAffine (CodeGenParams{..}) =
   , "  }"
   , "}"
   , ""
-  , "// converts N points to affine coordinates"
+  , "// converts N points to affine coordinates, using a single field inversion for"
+  , "// all of them (Montgomery's batch inversion trick). Points at infinity are skipped"
+  , "// in the running product, and result in the special affine infinity."
+  , "// Note: the output may overlap with the input, as long as `tgt <= src`"
   , "void " ++ prefix ++ "batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {"
-  , "  const uint64_t *p = src;"
-  , "  uint64_t *q = tgt;"
+  , "  if (N <= 0) return;"
+  , "  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );"
+  , "  assert( zinvs != 0 );"
+  , ""
+  , "  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th"
+  , "  uint64_t acc[NLIMBS_P];"
+  , "  " ++ prefix_p ++ "set_one( acc );"
+  , "  for(int i=0; i<N; i++) {"
+  , "    const uint64_t *z = src + (3*i+2)*NLIMBS_P;"
+  , "    " ++ prefix_p ++ "copy( acc , zinvs + i*NLIMBS_P );"
+  , "    if (!" ++ prefix_p ++ "is_zero( z )) { " ++ prefix_p ++ "mul_inplace( acc , z ); }"
+  , "  }"
+  , ""
+  , "  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]"
+  , "  " ++ prefix_p ++ "inv_inplace( acc );"
+  , "  for(int i=N-1; i>=0; i--) {"
+  , "    const uint64_t *z = src + (3*i+2)*NLIMBS_P;"
+  , "    if (!" ++ prefix_p ++ "is_zero( z )) {"
+  , "      " ++ prefix_p ++ "mul_inplace( zinvs + i*NLIMBS_P , acc );"
+  , "      " ++ prefix_p ++ "mul_inplace( acc , z );"
+  , "    }"
+  , "  }"
+  , ""
   , "  for(int i=0; i<N; i++) {"
-  , "    " ++ prefix ++ "to_affine(p,q);"
-  , "    p += 3*NLIMBS_P;"
-  , "    q += 2*NLIMBS_P;"
+  , "    const uint64_t *p = src + 3*i*NLIMBS_P;"
+  , "    uint64_t       *q = tgt + 2*i*NLIMBS_P;"
+  , "    if (" ++ prefix_p ++ "is_zero( p + 2*NLIMBS_P )) {"
+  , "      memset( q, 0xff, " ++ show (8*2*nlimbs_p) ++ " );"
+  , "    }"
+  , "    else {"
+  , "      const uint64_t *zinv = zinvs + i*NLIMBS_P;"
+  , "      " ++ prefix_p ++ "mul( p            , zinv , q            );"
+  , "      " ++ prefix_p ++ "mul( p + NLIMBS_P , zinv , q + NLIMBS_P );"
+  , "    }"
+  , "  }"
+  , ""
+  , "  free(zinvs);"
+  , "}"
+  , ""
+  , "// below this many points, the parallel version simply calls the sequential one"
+  , "#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024"
+  , ""
+  , "typedef struct {"
+  , "  int N;"
+  , "  int chunk;"
+  , "  const uint64_t *src;"
+  , "  uint64_t *tgt;"
+  , "} " ++ prefix ++ "batch_to_affine_ctx_t;"
+  , ""
+  , "void " ++ prefix ++ "batch_to_affine_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "batch_to_affine_ctx_t *c = (" ++ prefix ++ "batch_to_affine_ctx_t*) ctx;"
+  , "  int a = j * c->chunk;"
+  , "  int b = a + c->chunk;"
+  , "  if (b > c->N) { b = c->N; }"
+  , "  " ++ prefix ++ "batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );"
+  , "}"
+  , ""
+  , "// converts N points to affine coordinates, splitting them into chunks which are"
+  , "// converted in parallel (each chunk with a single inversion). For small inputs,"
+  , "// or with a single thread, this is the same as `batch_to_affine`."
+  , "// Note: unlike `batch_to_affine`, the output must not overlap with the input"
+  , "void " ++ prefix ++ "batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {"
+  , "  int T = parallel_get_num_threads();"
+  , "  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {"
+  , "    " ++ prefix ++ "batch_to_affine( N, src, tgt );"
+  , "    return;"
   , "  }"
+  , "  int chunk = (N + T - 1) / T;"
+  , "  int m     = (N + chunk - 1) / chunk;"
+  , "  " ++ prefix ++ "batch_to_affine_ctx_t ctx;"
+  , "  ctx.N     = N;"
+  , "  ctx.chunk = chunk;"
+  , "  ctx.src   = src;"
+  , "  ctx.tgt   = tgt;"
+  , "  parallel_for( m, " ++ prefix ++ "batch_to_affine_task, &ctx );"
   , "}"
   , ""
   , "void " ++ prefix ++ "copy( const uint64_t *src1 , uint64_t *tgt ) {"
@@ -804,7 +670,7 @@ isOnCurve xcurve (CodeGenParams{..}) =
   , "    return 0;"
   , "  }"
   , "  else {"
-  , "    " ++ prefix ++ "scl_Fr_std( " ++ prefix ++ "cofactor , src1 , tmp );"
+  , "    " ++ prefix ++ "scl_generic( " ++ prefix ++ "subgroup_order , src1 , tmp , NLIMBS_R );"
   , "    return " ++ prefix ++ "is_infinity( tmp );"
   , "  }"
   , "}"
@@ -896,113 +762,177 @@ dblCurve xcurve (CodeGenParams{..}) =
 
 --------------------------------------------------------------------------------
 
+{-
+  complete doubling for A = 0, Algorithm 9 of Renes-Costello-Batina:
+  "Complete addition formulas for prime order elliptic curves" <https://eprint.iacr.org/2015/1060>
+
+    t0 = Y*Y ; Z3 = 8*t0 ; t1 = Y*Z ; t2 = Z*Z ; t2 = b3*t2
+    X3 = t2*Z3 ; Y3 = t0+t2 ; Z3 = t1*Z3 ; t2 = 3*t2 ; t0 = t0-t2
+    Y3 = t0*Y3 ; Y3 = X3+Y3 ; t1 = X*Y ; X3 = t0*t1 ; X3 = 2*X3
+
+  cost: 6M + 2S + 1*m_3b (additions only when 3B is a small integer).
+  Unlike dbl-2007-bl, this also maps the point at infinity to itself.
+-}
+dblCurveA0 :: CodeGenParams -> Code
+dblCurveA0 params@(CodeGenParams{..}) = dblCurveA0' "" params ++
+  [ ""
+  , "// doubles an elliptic curve point" 
+  , "void " ++ prefix ++ "dbl_inplace( uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "dbl( tgt , tgt );"
+  , "}"
+  ]
+
+-- | The doubling formula, with the suffix @ct@ appended to the name of the
+-- function and to the field operations it calls (see 'constTimeCurveOps')
+dblCurveA0' :: String -> CodeGenParams -> Code
+dblCurveA0' ct (CodeGenParams{..}) =
+  [ "// doubles an elliptic curve point, assuming A = 0 (complete formula)"
+  , "// Renes-Costello-Batina, Algorithm 9 <https://eprint.iacr.org/2015/1060>"
+  , "void " ++ prefix ++ "dbl" ++ ct ++ "( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  uint64_t t0[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t t1[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t t2[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t t3[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "sqr" ++ ct ++ "( Y1, t0 );                  // t0 = Y1^2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( Y1, Z1, t1 );              // t1 = Y1*Z1"
+  , "  " ++ prefix_p ++ "sqr" ++ ct ++ "( Z1, t2 );                  // t2 = Z1^2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( X1, Y1, t3 );              // t3 = X1*Y1"
+  , "  " ++ prefix   ++ "scale_by_3B_inplace" ++ ct ++ "( t2 );      // t2 = b3*Z1^2"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t0, Z3 );              // Z3 = 2*t0"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, Z3 );          // Z3 = 4*t0"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, Z3 );          // Z3 = 8*t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t2, Z3, X3 );              // X3 = t2*Z3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t2, Y3 );              // Y3 = t0+t2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( Z3, t1 );          // Z3 = t1*Z3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t2, t2, t1 );              // t1 = 2*t2"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( t2, t1 );          // t2 = 3*t2"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t0, t2 );          // t0 = t0-t2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( Y3, t0 );          // Y3 = t0*Y3"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Y3, X3 );          // Y3 = X3+Y3"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t0, t3, X3 );              // X3 = t0*t3"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( X3, X3 );          // X3 = 2*X3"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
 addCurve :: CodeGenParams -> Code
-addCurve (CodeGenParams{..}) =
+addCurve params@(CodeGenParams{..}) = addCurve' "" params ++
+  [ ""
+  , "void " ++ prefix ++ "add_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
+  , "  " ++ prefix ++ "add( tgt, src2, tgt);"
+  , "}"
+  ]
+
+-- | The addition formula, with the suffix @ct@ (see 'dblCurveA0'')
+addCurve' :: String -> CodeGenParams -> Code
+addCurve' ct (CodeGenParams{..}) =
   [ "// adds two elliptic curve points" 
   , "// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#addition-add-2015-rcb"
-  , "void " ++ prefix ++ "add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  , "void " ++ prefix ++ "add" ++ ct ++ "( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
   , "  uint64_t t0[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t1[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t2[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t3[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t4[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t5[" ++ show nlimbs_p ++ "];"  
-  , "  " ++ prefix_p ++ "mul( X1, X2, t0 );              // t0 = X1*X2"
-  , "  " ++ prefix_p ++ "mul( Y1, Y2, t1 );              // t1 = Y1*Y2"
-  , "  " ++ prefix_p ++ "mul( Z1, Z2, t2 );              // t2 = Z1*Z2"
-  , "  " ++ prefix_p ++ "add( X1, Y1, t3 );              // t3 = X1+Y1"
-  , "  " ++ prefix_p ++ "add( X2, Y2, t4 );              // t4 = X2+Y2"
-  , "  " ++ prefix_p ++ "mul_inplace( t3, t4 );          // t3 = t3*t4"
-  , "  " ++ prefix_p ++ "add( t0, t1, t4 );              // t4 = t0+t1"
-  , "  " ++ prefix_p ++ "sub_inplace( t3 , t4 );         // t3 = t3-t4"
-  , "  " ++ prefix_p ++ "add( X1, Z1, t4 );              // t4 = X1+Z1"
-  , "  " ++ prefix_p ++ "add( X2, Z2, t5 );              // t5 = X2+Z2"
-  , "  " ++ prefix_p ++ "mul_inplace( t4, t5 );          // t4 = t4*t5"
-  , "  " ++ prefix_p ++ "add( t0, t2, t5 );              // t5 = t0+t2"
-  , "  " ++ prefix_p ++ "sub_inplace( t4, t5 );          // t4 = t4-t5"
-  , "  " ++ prefix_p ++ "add( Y1, Z1, t5 );              // t5 = Y1+Z1"
-  , "  " ++ prefix_p ++ "add( Y2, Z2, X3 );              // X3 = Y2+Z2"
-  , "  " ++ prefix_p ++ "mul_inplace( t5, X3 );          // t5 = t5*X3"
-  , "  " ++ prefix_p ++ "add( t1, t2, X3 );              // X3 = t1+t2"
-  , "  " ++ prefix_p ++ "sub_inplace( t5, X3 );          // t5 = t5-X3"
-  , "  " ++ prefix   ++ "scale_by_A ( t4, Z3 );          // Z3 = a*t4 "
-  , "  " ++ prefix   ++ "scale_by_3B( t2, X3 );          // X3 = b3*t2"
-  , "  " ++ prefix_p ++ "add_inplace( Z3, X3 );          // Z3 = X3+Z3"
-  , "  " ++ prefix_p ++ "sub( t1, Z3, X3 );              // X3 = t1-Z3"
-  , "  " ++ prefix_p ++ "add_inplace( Z3, t1 );          // Z3 = t1+Z3"
-  , "  " ++ prefix_p ++ "mul( X3, Z3, Y3 );              // Y3 = X3*Z3"
-  , "  " ++ prefix_p ++ "add( t0, t0, t1 );              // t1 = t0+t0"
-  , "  " ++ prefix_p ++ "add_inplace( t1, t0 );          // t1 = t1+t0"
-  , "  " ++ prefix   ++ "scale_by_A_inplace ( t2 );      // t2 = a*t2 "
-  , "  " ++ prefix   ++ "scale_by_3B_inplace( t4 );      // t4 = b3*t4"
-  , "  " ++ prefix_p ++ "add_inplace( t1, t2 );          // t1 = t1+t2"
-  , "  " ++ prefix_p ++ "sub_inplace_reverse( t2, t0 );  // t2 = t0-t2"
-  , "  " ++ prefix   ++ "scale_by_A_inplace ( t2 );      // t2 = a*t2 "
-  , "  " ++ prefix_p ++ "add_inplace( t4, t2 );          // t4 = t4+t2"
-  , "  " ++ prefix_p ++ "mul( t1, t4, t0 );              // t0 = t1*t4"
-  , "  " ++ prefix_p ++ "add_inplace( Y3, t0 );          // Y3 = Y3+t0"
-  , "  " ++ prefix_p ++ "mul( t4, t5, t0 );              // t0 = t5*t4"
-  , "  " ++ prefix_p ++ "mul_inplace( X3, t3 );          // X3 = t3*X3"
-  , "  " ++ prefix_p ++ "sub_inplace( X3, t0 );          // X3 = X3-t0"
-  , "  " ++ prefix_p ++ "mul( t1, t3, t0 );              // t0 = t3*t1"
-  , "  " ++ prefix_p ++ "mul_inplace( Z3, t5 );          // Z3 = t5*Z3"
-  , "  " ++ prefix_p ++ "add_inplace( Z3, t0 );          // Z3 = Z3+t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( X1, X2, t0 );              // t0 = X1*X2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( Y1, Y2, t1 );              // t1 = Y1*Y2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( Z1, Z2, t2 );              // t2 = Z1*Z2"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X1, Y1, t3 );              // t3 = X1+Y1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X2, Y2, t4 );              // t4 = X2+Y2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t3, t4 );          // t3 = t3*t4"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t1, t4 );              // t4 = t0+t1"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t3 , t4 );         // t3 = t3-t4"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X1, Z1, t4 );              // t4 = X1+Z1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X2, Z2, t5 );              // t5 = X2+Z2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t4, t5 );          // t4 = t4*t5"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t2, t5 );              // t5 = t0+t2"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t4, t5 );          // t4 = t4-t5"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( Y1, Z1, t5 );              // t5 = Y1+Z1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( Y2, Z2, X3 );              // X3 = Y2+Z2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t5, X3 );          // t5 = t5*X3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t1, t2, X3 );              // X3 = t1+t2"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t5, X3 );          // t5 = t5-X3"
+  , "  " ++ prefix   ++ "scale_by_A" ++ ct ++ " ( t4, Z3 );          // Z3 = a*t4 "
+  , "  " ++ prefix   ++ "scale_by_3B" ++ ct ++ "( t2, X3 );          // X3 = b3*t2"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, X3 );          // Z3 = X3+Z3"
+  , "  " ++ prefix_p ++ "sub" ++ ct ++ "( t1, Z3, X3 );              // X3 = t1-Z3"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, t1 );          // Z3 = t1+Z3"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( X3, Z3, Y3 );              // Y3 = X3*Z3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t0, t1 );              // t1 = t0+t0"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( t1, t0 );          // t1 = t1+t0"
+  , "  " ++ prefix   ++ "scale_by_A_inplace" ++ ct ++ " ( t2 );      // t2 = a*t2 "
+  , "  " ++ prefix   ++ "scale_by_3B_inplace" ++ ct ++ "( t4 );      // t4 = b3*t4"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( t1, t2 );          // t1 = t1+t2"
+  , "  " ++ prefix_p ++ "sub_inplace_reverse" ++ ct ++ "( t2, t0 );  // t2 = t0-t2"
+  , "  " ++ prefix   ++ "scale_by_A_inplace" ++ ct ++ " ( t2 );      // t2 = a*t2 "
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( t4, t2 );          // t4 = t4+t2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t1, t4, t0 );              // t0 = t1*t4"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Y3, t0 );          // Y3 = Y3+t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t4, t5, t0 );              // t0 = t5*t4"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( X3, t3 );          // X3 = t3*X3"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( X3, t0 );          // X3 = X3-t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t1, t3, t0 );              // t0 = t3*t1"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( Z3, t5 );          // Z3 = t5*Z3"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, t0 );          // Z3 = Z3+t0"
   , "}"
-  , ""
+  ]
+
+addCurveA0 :: CodeGenParams -> Code
+addCurveA0 params@(CodeGenParams{..}) = addCurveA0' "" params ++
+  [ ""
   , "void " ++ prefix ++ "add_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
   , "  " ++ prefix ++ "add( tgt, src2, tgt);"
   , "}"
   ]
 
-addCurveA0 :: CodeGenParams -> Code
-addCurveA0 (CodeGenParams{..}) =
-  [ "// adds two elliptic curve points, assuming A = 0" 
-  , "// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#addition-add-2015-rcb"
-  , "void " ++ prefix ++ "add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+-- | The addition formula, with the suffix @ct@ (see 'dblCurveA0'')
+addCurveA0' :: String -> CodeGenParams -> Code
+addCurveA0' ct (CodeGenParams{..}) =
+  [ "// adds two elliptic curve points, assuming A = 0 (complete formula)" 
+  , "// Renes-Costello-Batina, Algorithm 7 <https://eprint.iacr.org/2015/1060>"
+  , "// cost: 12M + 2*m_3b"
+  , "void " ++ prefix ++ "add" ++ ct ++ "( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
   , "  uint64_t t0[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t1[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t2[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t3[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t4[" ++ show nlimbs_p ++ "];"
   , "  uint64_t t5[" ++ show nlimbs_p ++ "];"  
-  , "  " ++ prefix_p ++ "mul( X1, X2, t0 );              // t0 = X1*X2"
-  , "  " ++ prefix_p ++ "mul( Y1, Y2, t1 );              // t1 = Y1*Y2"
-  , "  " ++ prefix_p ++ "mul( Z1, Z2, t2 );              // t2 = Z1*Z2"
-  , "  " ++ prefix_p ++ "add( X1, Y1, t3 );              // t3 = X1+Y1"
-  , "  " ++ prefix_p ++ "add( X2, Y2, t4 );              // t4 = X2+Y2"
-  , "  " ++ prefix_p ++ "mul_inplace( t3, t4 );          // t3 = t3*t4"
-  , "  " ++ prefix_p ++ "add( t0, t1, t4 );              // t4 = t0+t1"
-  , "  " ++ prefix_p ++ "sub_inplace( t3 , t4 );         // t3 = t3-t4"
-  , "  " ++ prefix_p ++ "add( X1, Z1, t4 );              // t4 = X1+Z1"
-  , "  " ++ prefix_p ++ "add( X2, Z2, t5 );              // t5 = X2+Z2"
-  , "  " ++ prefix_p ++ "mul_inplace( t4, t5 );          // t4 = t4*t5"
-  , "  " ++ prefix_p ++ "add( t0, t2, t5 );              // t5 = t0+t2"
-  , "  " ++ prefix_p ++ "sub_inplace( t4, t5 );          // t4 = t4-t5"
-  , "  " ++ prefix_p ++ "add( Y1, Z1, t5 );              // t5 = Y1+Z1"
-  , "  " ++ prefix_p ++ "add( Y2, Z2, X3 );              // X3 = Y2+Z2"
-  , "  " ++ prefix_p ++ "mul_inplace( t5, X3 );          // t5 = t5*X3"
-  , "  " ++ prefix_p ++ "add( t1, t2, X3 );              // X3 = t1+t2"
-  , "  " ++ prefix_p ++ "sub_inplace( t5, X3 );          // t5 = t5-X3"
-  , "  " ++ prefix   ++ "scale_by_3B( t2, X3 );          // X3 = b3*t2"
-  , "  " ++ prefix_p ++ "copy( X3, Z3 );                 // Z3 = X3"
-  , "  " ++ prefix_p ++ "sub( t1, Z3, X3 );              // X3 = t1-Z3"
-  , "  " ++ prefix_p ++ "add_inplace( Z3, t1 );          // Z3 = t1+Z3"
-  , "  " ++ prefix_p ++ "mul( X3, Z3, Y3 );              // Y3 = X3*Z3"
-  , "  " ++ prefix_p ++ "add( t0, t0, t1 );              // t1 = t0+t0"
-  , "  " ++ prefix_p ++ "add_inplace( t1, t0 );          // t1 = t1+t0"
-  , "  " ++ prefix   ++ "scale_by_3B_inplace( t4 );      // t4 = b3*t4"
-  , "  " ++ prefix_p ++ "mul( t1, t4, t0 );              // t0 = t1*t4"
-  , "  " ++ prefix_p ++ "add_inplace( Y3, t0 );          // Y3 = Y3+t0"
-  , "  " ++ prefix_p ++ "mul( t4, t5, t0 );              // t0 = t5*t4"
-  , "  " ++ prefix_p ++ "mul_inplace( X3, t3 );          // X3 = t3*X3"
-  , "  " ++ prefix_p ++ "sub_inplace( X3, t0 );          // X3 = X3-t0"
-  , "  " ++ prefix_p ++ "mul( t1, t3, t0 );              // t0 = t3*t1"
-  , "  " ++ prefix_p ++ "mul_inplace( Z3, t5 );          // Z3 = t5*Z3"
-  , "  " ++ prefix_p ++ "add_inplace( Z3, t0 );          // Z3 = Z3+t0"
-  , "}"
-  , ""
-  , "void " ++ prefix ++ "add_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
-  , "  " ++ prefix ++ "add( tgt, src2, tgt);"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( X1, X2, t0 );              // t0 = X1*X2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( Y1, Y2, t1 );              // t1 = Y1*Y2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( Z1, Z2, t2 );              // t2 = Z1*Z2"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X1, Y1, t3 );              // t3 = X1+Y1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X2, Y2, t4 );              // t4 = X2+Y2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t3, t4 );          // t3 = t3*t4"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t1, t4 );              // t4 = t0+t1"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t3 , t4 );         // t3 = t3-t4"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X1, Z1, t4 );              // t4 = X1+Z1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( X2, Z2, t5 );              // t5 = X2+Z2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t4, t5 );          // t4 = t4*t5"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t2, t5 );              // t5 = t0+t2"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t4, t5 );          // t4 = t4-t5"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( Y1, Z1, t5 );              // t5 = Y1+Z1"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( Y2, Z2, X3 );              // X3 = Y2+Z2"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( t5, X3 );          // t5 = t5*X3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t1, t2, X3 );              // X3 = t1+t2"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( t5, X3 );          // t5 = t5-X3"
+  , "  " ++ prefix   ++ "scale_by_3B_inplace" ++ ct ++ "( t2 );      // t2 = b3*t2"
+  , "  " ++ prefix_p ++ "sub" ++ ct ++ "( t1, t2, X3 );              // X3 = t1-t2"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t1, t2, Z3 );              // Z3 = t1+t2"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( X3, Z3, Y3 );              // Y3 = X3*Z3"
+  , "  " ++ prefix_p ++ "add" ++ ct ++ "( t0, t0, t1 );              // t1 = t0+t0"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( t1, t0 );          // t1 = t1+t0"
+  , "  " ++ prefix   ++ "scale_by_3B_inplace" ++ ct ++ "( t4 );      // t4 = b3*t4"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t1, t4, t0 );              // t0 = t1*t4"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Y3, t0 );          // Y3 = Y3+t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t4, t5, t0 );              // t0 = t5*t4"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( X3, t3 );          // X3 = t3*X3"
+  , "  " ++ prefix_p ++ "sub_inplace" ++ ct ++ "( X3, t0 );          // X3 = X3-t0"
+  , "  " ++ prefix_p ++ "mul" ++ ct ++ "( t1, t3, t0 );              // t0 = t3*t1"
+  , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( Z3, t5 );          // Z3 = t5*Z3"
+  , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( Z3, t0 );          // Z3 = Z3+t0"
   , "}"
   ]
 
@@ -1185,6 +1115,102 @@ scaleWindowed (CodeGenParams{..}) =
   , "}"
   ]
 
+-- | Point doubling and addition using only the branch-free field operations
+-- (so the running time of these cannot depend on the input, even when we
+-- compile without @CONSTANT_TIME@)
+constTimeCurveOps :: XCurve -> CodeGenParams -> Code
+constTimeCurveOps xcurve params@(CodeGenParams{..}) = if isCurveAZero xcurve
+  then dblCurveA0' "_ct" params ++ [""] ++ addCurveA0' "_ct" params
+  else
+    -- the generic addition formula is complete, so we can double with it
+    [ "// doubles an elliptic curve point (using the complete addition formula)"
+    , "void " ++ prefix ++ "dbl_ct( const uint64_t *src1, uint64_t *tgt ) {"
+    , "  " ++ prefix ++ "add_ct( src1, src1, tgt );"
+    , "}"
+    , ""
+    ] ++ addCurve' "_ct" params
+
+{-
+  constant-time scalar multiplication, for secret scalars (eg. signing keys)
+
+  The scalar is recoded into signed 4-bit digits d_i in [-8,8] using the Booth
+  encoding, that is,
+
+    d_i = k[4i-1] + k[4i] + 2*k[4i+1] + 4*k[4i+2] - 8*k[4i+3]
+
+  so each digit only depends on 5 bits of the scalar and no carry propagation
+  is needed. Then the loop does 4 doublings, a table lookup and an addition for
+  every digit, always in the same order; the lookup reads all the 8 entries and
+  selects with masks, and the negation is also done with masks. The point
+  formulas are the complete ones, so there are no special cases for infinity.
+
+  All the field operations used here are the `_ct` ones, which are branch-free
+  even when compiled without CONSTANT_TIME (the default ones are not: for
+  example the final subtraction in Montgomery reduction is conditional).
+-}
+scaleConstTime :: XCurve -> CodeGenParams -> Code
+scaleConstTime xcurve (CodeGenParams{..}) =
+  [ "// constant-time table lookup: computes `d*g` from the table [ k*g | k <- [1..8] ],"
+  , "// where -8 <= d <= 8. All the entries are read, and there are no branches depending on `d`"
+  , "void " ++ prefix ++ "ct_lookup_window_8( const uint64_t *table, int d, uint64_t *tgt ) {"
+  , "  uint64_t sgn  = (uint64_t)( ((int64_t)d) >> 63 );                 // all ones if d < 0"
+  , "  uint64_t absd = ((uint64_t)d ^ sgn) - sgn;"
+  , "  " ++ prefix ++ "set_infinity( tgt );"
+  , "  for(int k=1; k<=8; k++) {"
+  , "    uint64_t mask = - (((absd ^ k) - 1) >> 63);                    // all ones if absd == k"
+  , "    const uint64_t *entry = TBL(k);"
+  , "    for(int i=0; i<3*NLIMBS_P; i++) { tgt[i] = (tgt[i] & ~mask) | (entry[i] & mask); }"
+  , "  }"
+  , "  uint64_t negy[NLIMBS_P];"
+  , "  " ++ prefix_p ++ "neg_ct( tgt+NLIMBS_P , negy );"
+  , "  for(int i=0; i<NLIMBS_P; i++) { tgt[NLIMBS_P+i] = (tgt[NLIMBS_P+i] & ~sgn) | (negy[i] & sgn); }"
+  , "}"
+  , ""
+  , "#define CT_BIT(j) ( ((j) < 0 || (j) >= 64*expo_len) ? 0 : (int)((expo[(j)>>6] >> ((j)&63)) & 1) )"
+  , ""
+  , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
+  , "// where `grp` is a group element in " ++ typeName ++ ", and `expo` is a (non-negative) bigint"
+  , "// constant-time algorithm (signed fixed 4-bit windows), use this for secret scalars."
+  , "// The running time only depends on `expo_len`"
+  , "void " ++ prefix ++ "scl_ct_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {"
+  , ""
+  , "  // precalculate [ k*g | k <- [1..8] ]"
+  , "  uint64_t table[8*3*NLIMBS_P];"
+  , "  " ++ prefix ++ "copy( grp , TBL(1) );"
+  , "  " ++ prefix ++ "dbl_ct( TBL(1) , TBL(2) );"
+  , "  " ++ prefix ++ "add_ct( TBL(1) , TBL(2) , TBL(3) );"
+  , "  " ++ prefix ++ "dbl_ct( TBL(2) , TBL(4) );"
+  , "  " ++ prefix ++ "add_ct( TBL(1) , TBL(4) , TBL(5) );"
+  , "  " ++ prefix ++ "dbl_ct( TBL(3) , TBL(6) );"
+  , "  " ++ prefix ++ "add_ct( TBL(1) , TBL(6) , TBL(7) );"
+  , "  " ++ prefix ++ "dbl_ct( TBL(4) , TBL(8) );"
+  , ""
+  , "  uint64_t tmp[3*NLIMBS_P];"
+  , "  " ++ prefix ++ "set_infinity( tgt );"
+  , "  for(int i=16*expo_len; i>=0; i--) {"
+  , "    for(int s=0; s<4; s++) { " ++ prefix ++ "dbl_ct( tgt , tgt ); }"
+  , "    int j = 4*i;"
+  , "    int d = CT_BIT(j-1) + CT_BIT(j) + 2*CT_BIT(j+1) + 4*CT_BIT(j+2) - 8*CT_BIT(j+3);"
+  , "    " ++ prefix ++ "ct_lookup_window_8( table, d, tmp );"
+  , "    " ++ prefix ++ "add_ct( tgt, tmp, tgt );"
+  , "  }"
+  , "}"
+  , ""
+  , "#undef CT_BIT"
+  , ""
+  , "// computes `expo*grp` in constant time, where `expo` is in Fr *in standard repr*"
+  , "void " ++ prefix ++ "scl_ct_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
+  , "  " ++ prefix ++ "scl_ct_generic(expo, grp, tgt, NLIMBS_R);"
+  , "}"
+  , ""
+  , "// computes `expo*grp` in constant time, where `expo` is in Fr *in Montgomery repr*"
+  , "void " ++ prefix ++ "scl_ct_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
+  , "  uint64_t expo_std[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "to_std_ct(expo, expo_std);"
+  , "  " ++ prefix   ++ "scl_ct_generic(expo_std, grp, tgt, NLIMBS_R);"
+  , "}"
+  ]
+
 scaleFpFr :: CodeGenParams -> Code
 scaleFpFr (CodeGenParams{..}) =
   [ "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
@@ -1235,7 +1261,9 @@ c_code curve params = concat $ map ("":)
   , isOnCurve      curve params
     --
   , negCurve       params
-  , dblCurve curve params
+  , if isCurveAZero curve 
+      then dblCurveA0   params
+      else dblCurve     curve params
   , if isCurveAZero curve 
       then addCurveA0   params
       else addCurve     params
@@ -1244,10 +1272,17 @@ c_code curve params = concat $ map ("":)
     --
   , scaleNaive       params
   , scaleWindowed    params
-  , scaleFpFr        params
+  , scale_by_A3B_ct   curve params
+  , constTimeCurveOps curve params
+  , scaleConstTime    curve params
+  , scaleFpFr        params ++ scaleGLV curve params
+  , c_comb           params
     --
   , msmCurve          params
   , c_group_fft curve params
+  , c_srs             params
+  , c_cofactor      curve params
+  , c_hash_to_curve curve params
   ]
 
 hs_code :: XCurve -> CodeGenParams -> Code
@@ -1255,8 +1290,11 @@ hs_code curve params@(CodeGenParams{..}) = concat $ map ("":)
   [ hsBegin         curve params
   , msm_hs_binding        params
   , fft_hs_binding        params
+  , comb_hs_binding       params
+  , srs_hs_binding        params
+  , h2c_hs_binding  curve params
   , hsSage          curve params
-  , hsFFI                 params
+  , hsFFI           curve params
   ]
 
 --------------------------------------------------------------------------------
@@ -1271,7 +1309,7 @@ curve_MontProj_c_codegen tgtdir curve params@(CodeGenParams{..}) = do
   createTgtDirectory fn_c
 
   putStrLn $ "writing `" ++ fn_h ++ "`" 
-  writeFile fn_h $ unlines $ c_header params
+  writeFile fn_h $ unlines $ c_header params ++ glv_c_header curve params ++ cofactor_c_header curve params ++ h2c_c_header curve params
 
   putStrLn $ "writing `" ++ fn_c ++ "`" 
   writeFile fn_c $ unlines $ c_code curve params
@@ -0,0 +1,459 @@
+-- | Extended Jacobian (XYZZ) coordinates, Montgomery field representation
+--
+-- A point is represented by @(X,Y,ZZ,ZZZ)@ with @x = X/ZZ@, @y = Y/ZZZ@ and @ZZ^3 = ZZZ^2@.
+-- These are only used internally (C only, no Haskell bindings): mixed addition
+-- with an affine point costs @8M+2S@, which makes them the best choice for
+-- accumulating the buckets in MSM.
+--
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.MontXYZZ where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Control.Monad
+import System.FilePath
+
+import Zikkurat.CodeGen.Misc
+
+import Zikkurat.CodeGen.Curve.Params
+
+--------------------------------------------------------------------------------
+
+c_header :: CodeGenParams -> Code
+c_header (CodeGenParams{..}) =
+  [ "#include <stdint.h>"
+  , ""
+  , "extern void    " ++ prefix ++ "set_infinity(       uint64_t *tgt );"
+  , "extern uint8_t " ++ prefix ++ "is_infinity ( const uint64_t *src );"
+  , "extern void    " ++ prefix ++ "copy        ( const uint64_t *src , uint64_t *tgt );"
+  , ""
+  , "extern uint8_t " ++ prefix ++ "is_on_curve ( const uint64_t *src );"
+  , "extern uint8_t " ++ prefix ++ "is_equal    ( const uint64_t *src1, const uint64_t *src2 );"
+  , ""
+  , "extern void " ++ prefix ++ "from_affine ( const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "to_affine   ( const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "to_proj     ( const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "to_jac      ( const uint64_t *src , uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "neg        ( const uint64_t *src ,       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "dbl        ( const uint64_t *src ,       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "add        ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "madd_xyzz_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "neg_inplace (       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "dbl_inplace (       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "add_inplace (       uint64_t *tgt , const uint64_t *src2 );"
+  , "extern void " ++ prefix ++ "madd_inplace(       uint64_t *tgt , const uint64_t *src2 );"
+  ]
+
+--------------------------------------------------------------------------------
+
+c_begin :: XCurve -> CodeGenParams -> Code
+c_begin xcurve (CodeGenParams{..}) =
+  [ "// elliptic curve " ++ show (full_curvename xcurve) ++ " in XYZZ coordinates, Montgomery field representation"
+  , "//"
+  , "// NOTE: generated code, do not edit!"
+  , ""
+  , "#include <string.h>"
+  , "#include <stdlib.h>"
+  , "#include <stdint.h>"
+  , "#include <assert.h>"
+  , ""
+  , "#include \"" ++ pathBaseName c_path_xyzz   ++ ".h\""
+  , "#include \"" ++ pathBaseName c_path_affine ++ ".h\""
+  , "#include \"" ++ c_basename_p  ++ ".h\""
+  , ""
+  , "#define NLIMBS_P " ++ show nlimbs_p
+  , ""
+  , "#define X1   (src1)"
+  , "#define Y1   (src1 + " ++ show (  nlimbs_p) ++ ")"
+  , "#define ZZ1  (src1 + " ++ show (2*nlimbs_p) ++ ")"
+  , "#define ZZZ1 (src1 + " ++ show (3*nlimbs_p) ++ ")"
+  , ""
+  , "#define X2   (src2)"
+  , "#define Y2   (src2 + " ++ show (  nlimbs_p) ++ ")"
+  , "#define ZZ2  (src2 + " ++ show (2*nlimbs_p) ++ ")"
+  , "#define ZZZ2 (src2 + " ++ show (3*nlimbs_p) ++ ")"
+  , ""
+  , "#define X3   (tgt)"
+  , "#define Y3   (tgt + " ++ show (  nlimbs_p) ++ ")"
+  , "#define ZZ3  (tgt + " ++ show (2*nlimbs_p) ++ ")"
+  , "#define ZZZ3 (tgt + " ++ show (3*nlimbs_p) ++ ")"
+  , ""
+  , "// the constants A and B of the equation"
+  ] ++
+  (case xcurve of
+    Left  (Curve1{..}) ->
+      [ mkConst nlimbs_p (prefix ++ "const_A") (toMontgomery curveA)
+      , mkConst nlimbs_p (prefix ++ "const_B") (toMontgomery curveB)
+      ]
+    Right (Curve12 _ (Curve2{..})) ->
+      [ mkConstFp2 nlimbs_p (prefix ++ "const_A") (toMontgomeryFp2 g2_curveA)
+      , mkConstFp2 nlimbs_p (prefix ++ "const_B") (toMontgomeryFp2 g2_curveB)
+      ]
+  ) ++
+  [ ""
+  , "//------------------------------------------------------------------------------"
+  ]
+  where
+    p = case xcurve of
+      Left  curve1                -> curveFp curve1
+      Right (Curve12 curve1 _)    -> curveFp curve1
+    nlimbs_fp = case xcurve of
+      Left  _ -> nlimbs_p
+      Right _ -> div nlimbs_p 2
+    toMontgomery x = mod ( 2^(64*nlimbs_fp) * x ) p
+    toMontgomeryFp2 (x,y) = (toMontgomery x, toMontgomery y)
+
+-- | whether the curve constant A is zero (then the corresponding terms are omitted)
+curveIsA0 :: XCurve -> Bool
+curveIsA0 xcurve = case xcurve of
+  Left  curve1                     -> curveA curve1 == 0
+  Right (Curve12 _ (Curve2{..}))   -> g2_curveA == (0,0)
+
+--------------------------------------------------------------------------------
+
+basics :: CodeGenParams -> Code
+basics (CodeGenParams{..}) =
+  [ "void " ++ prefix ++ "set_infinity( uint64_t *tgt ) {"
+  , "  " ++ prefix_p ++ "set_one ( X3  );"
+  , "  " ++ prefix_p ++ "set_one ( Y3  );"
+  , "  " ++ prefix_p ++ "set_zero( ZZ3 );"
+  , "  " ++ prefix_p ++ "set_zero( ZZZ3 );"
+  , "}"
+  , ""
+  , "uint8_t " ++ prefix ++ "is_infinity( const uint64_t *src1 ) {"
+  , "  return " ++ prefix_p ++ "is_zero( ZZ1 );"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "copy( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (tgt != src1) { memcpy( tgt, src1, " ++ show (32*nlimbs_p) ++ " ); }"
+  , "}"
+  ]
+
+isOnCurve :: XCurve -> CodeGenParams -> Code
+isOnCurve xcurve (CodeGenParams{..}) =
+  [ "// checks the curve equation `Y^2 = X^3 + A*X*ZZ^2 + B*ZZ^3` and `ZZ^3 = ZZZ^2`"
+  , "uint8_t " ++ prefix ++ "is_on_curve( const uint64_t *src1 ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) return 1;"
+  , "  uint64_t zz2[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t zz3[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t   a[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t   b[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "sqr( ZZ1 , zz2 );               // zz2 = ZZ^2"
+  , "  " ++ prefix_p ++ "mul( ZZ1 , zz2 , zz3 );         // zz3 = ZZ^3"
+  , "  " ++ prefix_p ++ "sqr( ZZZ1 , a );                // a   = ZZZ^2"
+  , "  if (!" ++ prefix_p ++ "is_equal( a , zz3 )) return 0;"
+  , "  " ++ prefix_p ++ "sqr( X1 , a );                  // a   = X^2"
+  ]
+  ++ (if isA0 then [] else
+    [ "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_A , zz2 , b );    // b   = A*ZZ^2"
+    , "  " ++ prefix_p ++ "add_inplace( a , b );           // a   = X^2 + A*ZZ^2"
+    ]) ++
+  [ "  " ++ prefix_p ++ "mul_inplace( a , X1 );          // a   = X^3 + A*X*ZZ^2"
+  , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_B , zz3 , b );    // b   = B*ZZ^3"
+  , "  " ++ prefix_p ++ "add_inplace( a , b );           // a   = X^3 + A*X*ZZ^2 + B*ZZ^3"
+  , "  " ++ prefix_p ++ "sqr( Y1 , b );                  // b   = Y^2"
+  , "  return " ++ prefix_p ++ "is_equal( a , b );"
+  , "}"
+  ]
+  where
+    isA0 = curveIsA0 xcurve
+
+isEqual :: CodeGenParams -> Code
+isEqual (CodeGenParams{..}) =
+  [ "// checks whether two points are equal (as points of the curve)"
+  , "uint8_t " ++ prefix ++ "is_equal( const uint64_t *src1, const uint64_t *src2 ) {"
+  , "  uint8_t inf1 = " ++ prefix ++ "is_infinity( src1 );"
+  , "  uint8_t inf2 = " ++ prefix ++ "is_infinity( src2 );"
+  , "  if (inf1 || inf2) { return (inf1 && inf2); }"
+  , "  uint64_t a[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t b[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "mul( X1 , ZZ2 , a );"
+  , "  " ++ prefix_p ++ "mul( X2 , ZZ1 , b );"
+  , "  if (!" ++ prefix_p ++ "is_equal( a , b )) return 0;"
+  , "  " ++ prefix_p ++ "mul( Y1 , ZZZ2 , a );"
+  , "  " ++ prefix_p ++ "mul( Y2 , ZZZ1 , b );"
+  , "  return " ++ prefix_p ++ "is_equal( a , b );"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+convert :: CodeGenParams -> Code
+convert (CodeGenParams{..}) =
+  [ "// converts from affine coordinates"
+  , "void " ++ prefix ++ "from_affine( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (" ++ prefix_affine ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix ++ "set_infinity( tgt );"
+  , "    return;"
+  , "  }"
+  , "  memcpy( tgt, src1, " ++ show (16*nlimbs_p) ++ " );"
+  , "  " ++ prefix_p ++ "set_one( ZZ3  );"
+  , "  " ++ prefix_p ++ "set_one( ZZZ3 );"
+  , "}"
+  , ""
+  , "// converts to affine coordinates:"
+  , "//   x = X/ZZ , y = Y/ZZZ"
+  , "// since `ZZ^3 = ZZZ^2`, we have `1/ZZ = (ZZ/ZZZ)^2`, so a single inversion is enough"
+  , "void " ++ prefix ++ "to_affine( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix_affine ++ "set_infinity( tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t iZZZ[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  iZZ[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "inv( ZZZ1 , iZZZ );             // iZZZ = 1/ZZZ"
+  , "  " ++ prefix_p ++ "mul( ZZ1 , iZZZ , iZZ );        //      = ZZ/ZZZ"
+  , "  " ++ prefix_p ++ "sqr_inplace( iZZ );             // iZZ  = 1/ZZ"
+  , "  " ++ prefix_p ++ "mul( X1 , iZZ  , tgt );"
+  , "  " ++ prefix_p ++ "mul( Y1 , iZZZ , tgt + " ++ show nlimbs_p ++ " );"
+  , "}"
+  , ""
+  , "// converts to homogeneous projective coordinates, with `Z = ZZ*ZZZ`"
+  , "void " ++ prefix ++ "to_proj( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix_p ++ "set_zero( tgt );"
+  , "    " ++ prefix_p ++ "set_one ( tgt + " ++ show nlimbs_p ++ " );"
+  , "    " ++ prefix_p ++ "set_zero( tgt + " ++ show (2*nlimbs_p) ++ " );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t ZZ[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "copy( ZZ1 , ZZ );               // careful, `src1` and `tgt` can overlap"
+  , "  " ++ prefix_p ++ "mul( ZZ1 , ZZZ1 , tgt + " ++ show (2*nlimbs_p) ++ " ); // Z = ZZ*ZZZ"
+  , "  " ++ prefix_p ++ "mul( X1  , ZZZ1 , tgt );        // X = X*ZZZ"
+  , "  " ++ prefix_p ++ "mul( Y1  , ZZ   , tgt + " ++ show nlimbs_p ++ " );  // Y = Y*ZZ"
+  , "}"
+  , ""
+  , "// converts to Jacobian projective coordinates, with `Z = ZZZ`:"
+  , "// since `Z^2 = ZZ^3`, we have `X = X*ZZ^2` and `Y = Y*ZZZ^2`"
+  , "void " ++ prefix ++ "to_jac( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix_p ++ "set_one ( tgt );"
+  , "    " ++ prefix_p ++ "set_one ( tgt + " ++ show nlimbs_p ++ " );"
+  , "    " ++ prefix_p ++ "set_zero( tgt + " ++ show (2*nlimbs_p) ++ " );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t a[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t b[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "sqr( ZZ1  , a );                // a = ZZ^2"
+  , "  " ++ prefix_p ++ "sqr( ZZZ1 , b );                // b = ZZZ^2"
+  , "  " ++ prefix_p ++ "copy( ZZZ1 , tgt + " ++ show (2*nlimbs_p) ++ " );      // Z = ZZZ"
+  , "  " ++ prefix_p ++ "mul( X1 , a , tgt );            // X = X*ZZ^2"
+  , "  " ++ prefix_p ++ "mul( Y1 , b , tgt + " ++ show nlimbs_p ++ " );      // Y = Y*ZZZ^2"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+negCurve :: CodeGenParams -> Code
+negCurve (CodeGenParams{..}) =
+  [ "// negates an elliptic curve point"
+  , "void " ++ prefix ++ "neg( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (tgt != src1) { memcpy( tgt, src1, " ++ show (32*nlimbs_p) ++ " ); }"
+  , "  " ++ prefix_p ++ "neg_inplace( Y3 );"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "neg_inplace( uint64_t *tgt ) {"
+  , "  " ++ prefix_p ++ "neg_inplace( Y3 );"
+  , "}"
+  ]
+
+dblCurve :: XCurve -> CodeGenParams -> Code
+dblCurve xcurve (CodeGenParams{..}) =
+  [ "// doubles an elliptic curve point"
+  , "// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#doubling-dbl-2008-s-1>"
+  , "void " ++ prefix ++ "dbl( const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix ++ "set_infinity( tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t U[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t V[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t W[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t S[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t M[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "add( Y1 , Y1 , U );             // U   = 2*Y1"
+  , "  " ++ prefix_p ++ "sqr( U , V );                   // V   = U^2"
+  , "  " ++ prefix_p ++ "mul( U , V , W );               // W   = U*V"
+  , "  " ++ prefix_p ++ "mul( X1 , V , S );              // S   = X1*V"
+  , "  " ++ prefix_p ++ "sqr( X1 , M );                  //     = X1^2"
+  , "  " ++ prefix_p ++ "add( M , M , U );               //     = 2*X1^2"
+  , "  " ++ prefix_p ++ "add_inplace( M , U );           // M   = 3*X1^2"
+  ]
+  ++ (if isA0 then [] else
+    [ "  " ++ prefix_p ++ "sqr( ZZ1 , U );                 //     = ZZ1^2"
+    , "  " ++ prefix_p ++ "mul_inplace( U , " ++ prefix ++ "const_A );   //     = A*ZZ1^2"
+    , "  " ++ prefix_p ++ "add_inplace( M , U );           // M   = 3*X1^2 + A*ZZ1^2"
+    ]) ++
+  [ "  " ++ prefix_p ++ "mul( W , Y1 , U );              // U  := W*Y1"
+  , "  " ++ prefix_p ++ "mul( V , ZZ1 , ZZ3 );           // ZZ3  = V*ZZ1"
+  , "  " ++ prefix_p ++ "mul( W , ZZZ1 , ZZZ3 );         // ZZZ3 = W*ZZZ1"
+  , "  " ++ prefix_p ++ "sqr( M , X3 );                  //      = M^2"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , S );          //      = M^2 - S"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , S );          // X3   = M^2 - 2*S"
+  , "  " ++ prefix_p ++ "sub_inplace( S , X3 );          // S   := S - X3"
+  , "  " ++ prefix_p ++ "mul( M , S , Y3 );              //      = M*(S-X3)"
+  , "  " ++ prefix_p ++ "sub_inplace( Y3 , U );          // Y3   = M*(S-X3) - W*Y1"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "dbl_inplace( uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "dbl( tgt , tgt );"
+  , "}"
+  ]
+  where
+    isA0 = curveIsA0 xcurve
+
+addCurve :: CodeGenParams -> Code
+addCurve (CodeGenParams{..}) =
+  [ "// adds two elliptic curve points"
+  , "// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-add-2008-s>"
+  , "void " ++ prefix ++ "add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix ++ "copy( src2 , tgt );"
+  , "    return;"
+  , "  }"
+  , "  if (" ++ prefix ++ "is_infinity( src2 )) {"
+  , "    " ++ prefix ++ "copy( src1 , tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t U1[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t S1[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  P[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  R[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t PP[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t PPP[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  Q[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "mul( X1 , ZZ2  , U1 );          // U1 = X1*ZZ2"
+  , "  " ++ prefix_p ++ "mul( X2 , ZZ1  , P  );          // U2 = X2*ZZ1"
+  , "  " ++ prefix_p ++ "sub_inplace( P , U1 );          // P  = U2 - U1"
+  , "  " ++ prefix_p ++ "mul( Y1 , ZZZ2 , S1 );          // S1 = Y1*ZZZ2"
+  , "  " ++ prefix_p ++ "mul( Y2 , ZZZ1 , R  );          // S2 = Y2*ZZZ1"
+  , "  " ++ prefix_p ++ "sub_inplace( R , S1 );          // R  = S2 - S1"
+  , "  if (" ++ prefix_p ++ "is_zero( P )) {"
+  , "    if (" ++ prefix_p ++ "is_zero( R )) {"
+  , "      // the two points are the same"
+  , "      " ++ prefix ++ "dbl( src1 , tgt );"
+  , "    }"
+  , "    else {"
+  , "      // the two points are negatives of each other"
+  , "      " ++ prefix ++ "set_infinity( tgt );"
+  , "    }"
+  , "    return;"
+  , "  }"
+  , "  " ++ prefix_p ++ "sqr( P , PP );                  // PP   = P^2"
+  , "  " ++ prefix_p ++ "mul( P , PP , PPP );            // PPP  = P*PP"
+  , "  " ++ prefix_p ++ "mul( U1 , PP , Q );             // Q    = U1*PP"
+  , "  " ++ prefix_p ++ "mul_inplace( S1 , PPP );        // S1  := S1*PPP"
+  , "  " ++ prefix_p ++ "mul( ZZ1  , ZZ2  , ZZ3  );      //      = ZZ1*ZZ2"
+  , "  " ++ prefix_p ++ "mul_inplace( ZZ3 , PP );        // ZZ3  = ZZ1*ZZ2*PP"
+  , "  " ++ prefix_p ++ "mul( ZZZ1 , ZZZ2 , ZZZ3 );      //      = ZZZ1*ZZZ2"
+  , "  " ++ prefix_p ++ "mul_inplace( ZZZ3 , PPP );      // ZZZ3 = ZZZ1*ZZZ2*PPP"
+  , "  " ++ prefix_p ++ "sqr( R , X3 );                  //      = R^2"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , PPP );        //      = R^2 - PPP"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , Q );          //      = R^2 - PPP - Q"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q"
+  , "  " ++ prefix_p ++ "sub_inplace( Q , X3 );          // Q   := Q - X3"
+  , "  " ++ prefix_p ++ "mul( R , Q , Y3 );              //      = R*(Q-X3)"
+  , "  " ++ prefix_p ++ "sub_inplace( Y3 , S1 );         // Y3   = R*(Q-X3) - S1*PPP"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "add_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
+  , "  " ++ prefix ++ "add( tgt , src2 , tgt );"
+  , "}"
+  ]
+
+mixedAddCurve :: CodeGenParams -> Code
+mixedAddCurve (CodeGenParams{..}) =
+  [ "// adds an XYZZ point (src1) and an affine point (src2), costing 8M + 2S"
+  , "// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-madd-2008-s>"
+  , "void " ++ prefix ++ "madd_xyzz_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  , "  if (" ++ prefix_affine ++ "is_infinity( src2 )) {"
+  , "    " ++ prefix ++ "copy( src1 , tgt );"
+  , "    return;"
+  , "  }"
+  , "  if (" ++ prefix ++ "is_infinity( src1 )) {"
+  , "    " ++ prefix ++ "from_affine( src2 , tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t  P[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  R[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t PP[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t PPP[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  Q[" ++ show nlimbs_p ++ "];"
+  , "  uint64_t  T[" ++ show nlimbs_p ++ "];"
+  , "  " ++ prefix_p ++ "mul( X2 , ZZ1  , P );           //      = X2*ZZ1"
+  , "  " ++ prefix_p ++ "sub_inplace( P , X1 );          // P    = X2*ZZ1 - X1"
+  , "  " ++ prefix_p ++ "mul( Y2 , ZZZ1 , R );           //      = Y2*ZZZ1"
+  , "  " ++ prefix_p ++ "sub_inplace( R , Y1 );          // R    = Y2*ZZZ1 - Y1"
+  , "  if (" ++ prefix_p ++ "is_zero( P )) {"
+  , "    if (" ++ prefix_p ++ "is_zero( R )) {"
+  , "      // the two points are the same"
+  , "      " ++ prefix ++ "dbl( src1 , tgt );"
+  , "    }"
+  , "    else {"
+  , "      // the two points are negatives of each other"
+  , "      " ++ prefix ++ "set_infinity( tgt );"
+  , "    }"
+  , "    return;"
+  , "  }"
+  , "  " ++ prefix_p ++ "sqr( P , PP );                  // PP   = P^2"
+  , "  " ++ prefix_p ++ "mul( P , PP , PPP );            // PPP  = P*PP"
+  , "  " ++ prefix_p ++ "mul( X1 , PP , Q );             // Q    = X1*PP"
+  , "  " ++ prefix_p ++ "mul( Y1 , PPP , T );            // T    = Y1*PPP"
+  , "  " ++ prefix_p ++ "mul( ZZ1  , PP  , ZZ3  );       // ZZ3  = ZZ1*PP"
+  , "  " ++ prefix_p ++ "mul( ZZZ1 , PPP , ZZZ3 );       // ZZZ3 = ZZZ1*PPP"
+  , "  " ++ prefix_p ++ "sqr( R , X3 );                  //      = R^2"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , PPP );        //      = R^2 - PPP"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , Q );          //      = R^2 - PPP - Q"
+  , "  " ++ prefix_p ++ "sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q"
+  , "  " ++ prefix_p ++ "sub_inplace( Q , X3 );          // Q   := Q - X3"
+  , "  " ++ prefix_p ++ "mul( R , Q , Y3 );              //      = R*(Q-X3)"
+  , "  " ++ prefix_p ++ "sub_inplace( Y3 , T );          // Y3   = R*(Q-X3) - Y1*PPP"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "madd_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
+  , "  " ++ prefix ++ "madd_xyzz_aff( tgt , src2 , tgt );"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+c_code :: XCurve -> CodeGenParams -> Code
+c_code xcurve params = concat $ map ("":)
+  [ c_begin xcurve params
+    --
+  , basics           params
+  , isOnCurve xcurve params
+  , isEqual          params
+  , convert          params
+    --
+  , negCurve         params
+  , dblCurve  xcurve params
+  , addCurve         params
+  , mixedAddCurve    params
+  ]
+
+--------------------------------------------------------------------------------
+
+curve_MontXYZZ_c_codegen :: FilePath -> XCurve -> CodeGenParams -> IO ()
+curve_MontXYZZ_c_codegen tgtdir xcurve params@(CodeGenParams{..}) = do
+
+  let fn_h = tgtdir </> (cFilePath "h" c_path_xyzz)
+  let fn_c = tgtdir </> (cFilePath "c" c_path_xyzz)
+
+  createTgtDirectory fn_h
+  createTgtDirectory fn_c
+
+  putStrLn $ "writing `" ++ fn_h ++ "`" 
+  writeFile fn_h $ unlines $ c_header params
+
+  putStrLn $ "writing `" ++ fn_c ++ "`" 
+  writeFile fn_c $ unlines $ c_code xcurve params
+
+--------------------------------------------------------------------------------
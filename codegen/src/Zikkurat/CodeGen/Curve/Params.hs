@@ -1,9 +1,11 @@
-
+{-# LANGUAGE RecordWildCards, DeriveFunctor #-}
 {-# LANGUAGE RecordWildCards #-}
 module Zikkurat.CodeGen.Curve.Params where
 
 --------------------------------------------------------------------------------
 
+import Data.Maybe
+
 import Zikkurat.CodeGen.Misc
 
 --------------------------------------------------------------------------------
@@ -30,6 +32,12 @@ isCurveBZero ei = case ei of
   Left  c1             -> curveB    c1 == 0
   Right (Curve12 _ c2) -> g2_curveB c2 == (0,0)
 
+-- | Whether we have a GLV endomorphism (we only use it on G1)
+hasGLV :: XCurve -> Bool
+hasGLV ei = case ei of
+  Left  c1 -> isJust (glvBetaLambda c1)
+  Right _  -> False
+
 --------------------------------------------------------------------------------
 
 data Curve12 = Curve12 
@@ -48,9 +56,18 @@ data Curve1 = Curve1
   , cofactor      :: Integer                    -- ^ the cofactor of the subgroup of size @r@
   , subgroupGen   :: (Integer,Integer)          -- ^ a generator g=(x,y) of the subgroup
   , glvBetaLambda :: Maybe (Integer,Integer)    -- ^ beta and lambda for the GLV trick
+  , hashToCurve   :: Maybe (HashToCurve Integer) -- ^ parameters for hashing to the curve
+  , curveFamily   :: Maybe CurveFamily          -- ^ the family of pairing-friendly curves (if any)
   }
   deriving Show
 
+-- | Families of pairing-friendly curves, with their parameter @x@ (we use these
+-- for fast cofactor clearing)
+data CurveFamily
+  = BN    Integer     -- ^ Barreto-Naehrig: @p = 36x^4 + 36x^3 + 24x^2 + 6x + 1@, trace @t = 6x^2 + 1@
+  | BLS12 Integer     -- ^ Barreto-Lynn-Scott (k=12): @p = (x-1)^2 (x^4 - x^2 + 1) / 3 + x@, trace @t = x + 1@
+  deriving Show
+
 -- | Ghetto encoding of elements of Fp2
 type I2 = (Integer,Integer)
 
@@ -60,9 +77,40 @@ data Curve2 = Curve2
   , g2_curveB        :: I2                   -- ^ the B in @y^2 = x^3 + A*x + B@
   , g2_cofactor      :: Integer              -- ^ the cofactor of the subgroup of size @r@
   , g2_subgroupGen   :: (I2,I2)              -- ^ a generator g=(x,y) of the subgroup
+  , g2_hashToCurve   :: Maybe (HashToCurve I2)  -- ^ parameters for hashing to the curve
+  , g2_psiCoeffs     :: Maybe (I2,I2)        -- ^ @(cx,cy)@ such that @psi(x,y) = (cx*conj(x), cy*conj(y))@ is the untwist-Frobenius-twist endomorphism
   }
   deriving Show
 
+-- | Parameters for hashing to the curve (RFC 9380), with field elements of type @f@
+data HashToCurve f = HashToCurve
+  { h2c_L    :: Int              -- ^ number of bytes per base field element in @hash_to_field@
+  , h2c_heff :: Integer          -- ^ the scalar used for clearing the cofactor (must agree with `clear_cofactor`)
+  , h2c_map  :: MapToCurve f     -- ^ the map from the base field to the curve
+  }
+  deriving (Show,Functor)
+
+-- | The map from the base field to the curve (polynomials are lists of 
+-- coefficients, starting from the constant term)
+data MapToCurve f
+  = SSWU                         -- ^ simplified SWU to an isogenous curve @y^2 = x^3 + A'*x + B'@, followed by the isogeny
+      { sswu_Z   :: f            -- ^ the non-square @Z@ of the map
+      , iso_A    :: f            -- ^ @A'@ of the isogenous curve (nonzero)
+      , iso_B    :: f            -- ^ @B'@ of the isogenous curve (nonzero)
+      , iso_xnum :: [f]          -- ^ the isogeny is @(x,y) -> (xnum(x)/xden(x), y*ynum(x)/yden(x))@
+      , iso_xden :: [f]
+      , iso_ynum :: [f]
+      , iso_yden :: [f]
+      }
+  | SVDW                         -- ^ Shallue-van de Woestijne method, directly to the curve
+      { svdw_Z   :: f            -- ^ the constant @Z@ of the map
+      , svdw_c1  :: f            -- ^ @g(Z)@, where @g(x) = x^3 + A*x + B@
+      , svdw_c2  :: f            -- ^ @-Z/2@
+      , svdw_c3  :: f            -- ^ @sqrt(-g(Z) * (3*Z^2 + 4*A))@, with @sgn0(c3) == 0@
+      , svdw_c4  :: f            -- ^ @-4*g(Z) / (3*Z^2 + 4*A)@
+      }
+  deriving (Show,Functor)
+
 --------------------------------------------------------------------------------
 
 data CodeGenParams = CodeGenParams
@@ -70,8 +118,11 @@ data CodeGenParams = CodeGenParams
   , prefix_affine  :: String       -- ^ prefix for C names
   , prefix_proj    :: String       -- ^ prefix for C names
   , prefix_jac     :: String       -- ^ prefix for C names
+  , prefix_xyzz    :: String       -- ^ prefix for C names (XYZZ coordinates, used internally by MSM)
   , prefix_p       :: String       -- ^ prefix for C names for Fp / Fp2 (the base field)
+  , prefix_fp      :: String       -- ^ prefix for C names for the prime field Fp (the same as @prefix_p@ for G1)
   , prefix_r       :: String       -- ^ prefix for C names for Fr
+  , prefix_arr_r   :: String       -- ^ prefix for C names for arrays of Fr elements
   , point_repr     :: String       -- one of "affine", "proj" or "jac"
   , nlimbs_p       :: Int          -- ^ number of 64-bit limbs in p
   , nlimbs_r       :: Int          -- ^ number of 64-bit limbs in r
@@ -84,12 +135,15 @@ data CodeGenParams = CodeGenParams
   , c_path_affine  :: Path         -- ^ path of the C file
   , c_path_proj    :: Path         -- ^ path of the C file
   , c_path_jac     :: Path         -- ^ path of the C file
+  , c_path_xyzz    :: Path         -- ^ path of the C file
   , hs_path        :: Path         -- ^ path of the Haskell module (what we are generating)
   , hs_path_affine :: Path         -- ^ path of the Haskell module
   , hs_path_proj   :: Path         -- ^ path of the Haskell module
   , hs_path_jac    :: Path         -- ^ path of the Haskell module
   , c_basename_p   :: String       -- ^ name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_fp  :: String       -- ^ name of the @.c@ / @.h@ file for the prime field Fp (without extension)
   , c_basename_r   :: String       -- ^ name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_arr_r :: String     -- ^ name of the @.c@ / @.h@ file for arrays of Fr elements (without extension)
   , typeName       :: String       -- ^ the name of the haskell type for curve points
   }
   deriving Show
@@ -163,6 +217,8 @@ bn128_curve1 = Curve1
       ( 2203960485148121921418603742825762020974279258880205651966
       , 4407920970296243842393367215006156084916469457145843978461 
       )
+  , hashToCurve   = Just bn128_g1_hashToCurve
+  , curveFamily   = Just (BN 4965661367192848881)
   }
 
 bn128_curve2 :: Curve2
@@ -171,6 +227,13 @@ bn128_curve2 = Curve2
   , g2_curveB        = (b1,bu) 
   , g2_cofactor      = 21888242871839275222246405745257275088844257914179612981679871602714643921549
   , g2_subgroupGen   = ( (gen_x1,gen_xu) , (gen_y1,gen_yu) )
+  , g2_hashToCurve   = Just bn128_g2_hashToCurve
+  , g2_psiCoeffs     = Just
+      ( ( 0x2fb347984f7911f74c0bec3cf559b143b78cc310c2c3330c99e39557176f553d     -- xi^((p-1)/3), where xi = 9+u
+        , 0x16c9e55061ebae204ba4cc8bd75a079432ae2a1d0b7c9dce1665d51c640fcba2 )
+      , ( 0x063cf305489af5dcdc5ec698b6e2f9b9dbaae0eda9c95998dc54014671a0135a     -- xi^((p-1)/2)
+        , 0x07c03cbcac41049a0704b5a7ec796f2b21807dc98fa25bd282d37f632623b0e3 )
+      )
   }
   where
     b1 = 19485874751759354771024239261021720505790618469301721065564631296452457478373 
@@ -180,6 +243,38 @@ bn128_curve2 = Curve2
     gen_y1 = 0x056c01168a5319461f7ca7aa19d4fcfd1c7cdf52dbfc4cbee6f915250b7f6fc8 
     gen_yu = 0x0efe500a2d02dd77f5f401329f30895df553b878fc3c0dadaaa86456a623235c 
 
+-- | There is no standard suite for BN254 in RFC 9380; we use the Shallue-van de
+-- Woestijne map (as the curve has @A = 0@ and no convenient isogeny), with
+-- the same @expand_message_xmd@ and @L = 48@. The constant @Z@ is the one
+-- found by the procedure in appendix H.1 of the RFC.
+bn128_g1_hashToCurve :: HashToCurve Integer
+bn128_g1_hashToCurve = HashToCurve
+  { h2c_L    = 48
+  , h2c_heff = 1
+  , h2c_map  = SVDW
+      { svdw_Z   = 1
+      , svdw_c1  = 0x4
+      , svdw_c2  = 0x183227397098d014dc2822db40c0ac2ecbc0b548b438e5469e10460b6c3e7ea3
+      , svdw_c3  = 0x16789af3a83522eb353c98fc6b36d713d5d8d1cc5dffffffa
+      , svdw_c4  = 0x10216f7ba065e00de81ac1e7808072c9dd2b2385cd7b438469602eb24829a9bd
+      }
+  }
+
+-- | Shallue-van de Woestijne map to the twisted curve (see the remark at 
+-- 'bn128_g1_hashToCurve'); the cofactor is cleared by a scalar multiplication
+bn128_g2_hashToCurve :: HashToCurve I2
+bn128_g2_hashToCurve = HashToCurve
+  { h2c_L    = 48
+  , h2c_heff = 21888242871839275222246405745257275088844257914179612981679871602714643921549
+  , h2c_map  = SVDW
+      { svdw_Z   = (1,0)
+      , svdw_c1  = (0x2b149d40ceb8aaae81be18991be06ac3b5b4c5e559dbefa33267e6dc24a138e6,0x9713b03af0fed4cd2cafadeed8fdf4a74fa084e52d1852e4a2bd0685c315d2)
+      , svdw_c2  = (0x183227397098d014dc2822db40c0ac2ecbc0b548b438e5469e10460b6c3e7ea3,0x0)
+      , svdw_c3  = (0x29fd332ab7260112b801fa95b21af64e2e6da55f90a3e510fcbe57377b5ca1ec,0x303d1eff1426764bf8408aee24ba0b865e76f77b1267a846b1e9154d01565034)
+      , svdw_c4  = (0x17365bbe63b1d2078632fe0eb2ac5a41b4e6a9c08b98676721010b008d4eaf99,0xf57ffe5fc79e19cd689d7aa4209cad8fe164d7f4694786b388732a995d03755)
+      }
+  }
+
 --------------------------------------------------------------------------------
 
 bls12_381_curve12 :: Curve12
@@ -201,6 +296,8 @@ bls12_381_curve1 = Curve1
       ( 4002409555221667392624310435006688643935503118305586438271171395842971157480381377015405980053539358417135540939436 
       , 228988810152649578064853576960394133503
       )
+  , hashToCurve   = Just bls12_381_g1_hashToCurve
+  , curveFamily   = Just (BLS12 (-0xd201000000010000))
   }
 
 bls12_381_curve2 :: Curve2
@@ -209,6 +306,13 @@ bls12_381_curve2 = Curve2
   , g2_curveB        = (4 , 4)   -- 4(1+i)
   , g2_cofactor      = 305502333931268344200999753193121504214466019254188142667664032982267604182971884026507427359259977847832272839041616661285803823378372096355777062779109
   , g2_subgroupGen   = ( (gen_x1,gen_xu) , (gen_y1,gen_yu) )
+  , g2_hashToCurve   = Just bls12_381_g2_hashToCurve
+  , g2_psiCoeffs     = Just
+      ( ( 0                                                                                                    -- 1 / xi^((p-1)/3), where xi = 1+u
+        , 0x1a0111ea397fe699ec02408663d4de85aa0d857d89759ad4897d29650fb85f9b409427eb4f49fffd8bfd00000000aaad )
+      , ( 0x135203e60180a68ee2e9c448d77a2cd91c3dedd930b1cf60ef396489f61eb45e304466cf3e67fa0af1ee7b04121bdea2     -- 1 / xi^((p-1)/2)
+        , 0x06af0e0437ff400b6831e36d6bd17ffe48395dabc2d3435e77f76e17009241c5ee67992f72ec05f4c81084fbede3cc09 )
+      )
   }
   where
     gen_xu = 3059144344244213709971259814753781636986470325476647558659373206291635324768958432433509563104347017837885763365758 -- *u 
@@ -216,4 +320,116 @@ bls12_381_curve2 = Curve2
     gen_yu = 927553665492332455747201965776037880757740193453592970025027978793976877002675564980949289727957565575433344219582  -- *u 
     gen_y1 = 1985150602287291935568054521177171638300868978215655730859378665066344726373823718423869104263333984641494340347905
 
+-- | The suite @BLS12381G1_XMD:SHA-256_SSWU_RO_@ of RFC 9380 (section 8.8.1),
+-- using an 11-isogeny
+bls12_381_g1_hashToCurve :: HashToCurve Integer
+bls12_381_g1_hashToCurve = HashToCurve
+  { h2c_L    = 64
+  , h2c_heff = 0xd201000000010001            -- 1 - x, where x = -0xd201000000010000
+  , h2c_map  = SSWU
+      { sswu_Z   = 11
+      , iso_A    = 0x144698a3b8e9433d693a02c96d4982b0ea985383ee66a8d8e8981aefd881ac98936f8da0e0f97f5cf428082d584c1d
+      , iso_B    = 0x12e2908d11688030018b12e8753eee3b2016c1f0f24f4070a0b9c14fcef35ef55a23215a316ceaa5d1cc48e98e172be0
+      , iso_xnum =
+          [ 0x11a05f2b1e833340b809101dd99815856b303e88a2d7005ff2627b56cdb4e2c85610c2d5f2e62d6eaeac1662734649b7
+          , 0x17294ed3e943ab2f0588bab22147a81c7c17e75b2f6a8417f565e33c70d1e86b4838f2a6f318c356e834eef1b3cb83bb
+          , 0xd54005db97678ec1d1048c5d10a9a1bce032473295983e56878e501ec68e25c958c3e3d2a09729fe0179f9dac9edcb0
+          , 0x1778e7166fcc6db74e0609d307e55412d7f5e4656a8dbf25f1b33289f1b330835336e25ce3107193c5b388641d9b6861
+          , 0xe99726a3199f4436642b4b3e4118e5499db995a1257fb3f086eeb65982fac18985a286f301e77c451154ce9ac8895d9
+          , 0x1630c3250d7313ff01d1201bf7a74ab5db3cb17dd952799b9ed3ab9097e68f90a0870d2dcae73d19cd13c1c66f652983
+          , 0xd6ed6553fe44d296a3726c38ae652bfb11586264f0f8ce19008e218f9c86b2a8da25128c1052ecaddd7f225a139ed84
+          , 0x17b81e7701abdbe2e8743884d1117e53356de5ab275b4db1a682c62ef0f2753339b7c8f8c8f475af9ccb5618e3f0c88e
+          , 0x80d3cf1f9a78fc47b90b33563be990dc43b756ce79f5574a2c596c928c5d1de4fa295f296b74e956d71986a8497e317
+          , 0x169b1f8e1bcfa7c42e0c37515d138f22dd2ecb803a0c5c99676314baf4bb1b7fa3190b2edc0327797f241067be390c9e
+          , 0x10321da079ce07e272d8ec09d2565b0dfa7dccdde6787f96d50af36003b14866f69b771f8c285decca67df3f1605fb7b
+          , 0x6e08c248e260e70bd1e962381edee3d31d79d7e22c837bc23c0bf1bc24c6b68c24b1b80b64d391fa9c8ba2e8ba2d229
+          ]
+      , iso_xden =
+          [ 0x8ca8d548cff19ae18b2e62f4bd3fa6f01d5ef4ba35b48ba9c9588617fc8ac62b558d681be343df8993cf9fa40d21b1c
+          , 0x12561a5deb559c4348b4711298e536367041e8ca0cf0800c0126c2588c48bf5713daa8846cb026e9e5c8276ec82b3bff
+          , 0xb2962fe57a3225e8137e629bff2991f6f89416f5a718cd1fca64e00b11aceacd6a3d0967c94fedcfcc239ba5cb83e19
+          , 0x3425581a58ae2fec83aafef7c40eb545b08243f16b1655154cca8abc28d6fd04976d5243eecf5c4130de8938dc62cd8
+          , 0x13a8e162022914a80a6f1d5f43e7a07dffdfc759a12062bb8d6b44e833b306da9bd29ba81f35781d539d395b3532a21e
+          , 0xe7355f8e4e667b955390f7f0506c6e9395735e9ce9cad4d0a43bcef24b8982f7400d24bc4228f11c02df9a29f6304a5
+          , 0x772caacf16936190f3e0c63e0596721570f5799af53a1894e2e073062aede9cea73b3538f0de06cec2574496ee84a3a
+          , 0x14a7ac2a9d64a8b230b3f5b074cf01996e7f63c21bca68a81996e1cdf9822c580fa5b9489d11e2d311f7d99bbdcc5a5e
+          , 0xa10ecf6ada54f825e920b3dafc7a3cce07f8d1d7161366b74100da67f39883503826692abba43704776ec3a79a1d641
+          , 0x95fc13ab9e92ad4476d6e3eb3a56680f682b4ee96f7d03776df533978f31c1593174e4b4b7865002d6384d168ecdd0a
+          , 0x1
+          ]
+      , iso_ynum =
+          [ 0x90d97c81ba24ee0259d1f094980dcfa11ad138e48a869522b52af6c956543d3cd0c7aee9b3ba3c2be9845719707bb33
+          , 0x134996a104ee5811d51036d776fb46831223e96c254f383d0f906343eb67ad34d6c56711962fa8bfe097e75a2e41c696
+          , 0xcc786baa966e66f4a384c86a3b49942552e2d658a31ce2c344be4b91400da7d26d521628b00523b8dfe240c72de1f6
+          , 0x1f86376e8981c217898751ad8746757d42aa7b90eeb791c09e4a3ec03251cf9de405aba9ec61deca6355c77b0e5f4cb
+          , 0x8cc03fdefe0ff135caf4fe2a21529c4195536fbe3ce50b879833fd221351adc2ee7f8dc099040a841b6daecf2e8fedb
+          , 0x16603fca40634b6a2211e11db8f0a6a074a7d0d4afadb7bd76505c3d3ad5544e203f6326c95a807299b23ab13633a5f0
+          , 0x4ab0b9bcfac1bbcb2c977d027796b3ce75bb8ca2be184cb5231413c4d634f3747a87ac2460f415ec961f8855fe9d6f2
+          , 0x987c8d5333ab86fde9926bd2ca6c674170a05bfe3bdd81ffd038da6c26c842642f64550fedfe935a15e4ca31870fb29
+          , 0x9fc4018bd96684be88c9e221e4da1bb8f3abd16679dc26c1e8b6e6a1f20cabe69d65201c78607a360370e577bdba587
+          , 0xe1bba7a1186bdb5223abde7ada14a23c42a0ca7915af6fe06985e7ed1e4d43b9b3f7055dd4eba6f2bafaaebca731c30
+          , 0x19713e47937cd1be0dfd0b8f1d43fb93cd2fcbcb6caf493fd1183e416389e61031bf3a5cce3fbafce813711ad011c132
+          , 0x18b46a908f36f6deb918c143fed2edcc523559b8aaf0c2462e6bfe7f911f643249d9cdf41b44d606ce07c8a4d0074d8e
+          , 0xb182cac101b9399d155096004f53f447aa7b12a3426b08ec02710e807b4633f06c851c1919211f20d4c04f00b971ef8
+          , 0x245a394ad1eca9b72fc00ae7be315dc757b3b080d4c158013e6632d3c40659cc6cf90ad1c232a6442d9d3f5db980133
+          , 0x5c129645e44cf1102a159f748c4a3fc5e673d81d7e86568d9ab0f5d396a7ce46ba1049b6579afb7866b1e715475224b
+          , 0x15e6be4e990f03ce4ea50b3b42df2eb5cb181d8f84965a3957add4fa95af01b2b665027efec01c7704b456be69c8b604
+          ]
+      , iso_yden =
+          [ 0x16112c4c3a9c98b252181140fad0eae9601a6de578980be6eec3232b5be72e7a07f3688ef60c206d01479253b03663c1
+          , 0x1962d75c2381201e1a0cbd6c43c348b885c84ff731c4d59ca4a10356f453e01f78a4260763529e3532f6102c2e49a03d
+          , 0x58df3306640da276faaae7d6e8eb15778c4855551ae7f310c35a5dd279cd2eca6757cd636f96f891e2538b53dbf67f2
+          , 0x16b7d288798e5395f20d23bf89edb4d1d115c5dbddbcd30e123da489e726af41727364f2c28297ada8d26d98445f5416
+          , 0xbe0e079545f43e4b00cc912f8228ddcc6d19c9f0f69bbb0542eda0fc9dec916a20b15dc0fd2ededda39142311a5001d
+          , 0x8d9e5297186db2d9fb266eaac783182b70152c65550d881c5ecd87b6f0f5a6449f38db9dfa9cce202c6477faaf9b7ac
+          , 0x166007c08a99db2fc3ba8734ace9824b5eecfdfa8d0cf8ef5dd365bc400a0051d5fa9c01a58b1fb93d1a1399126a775c
+          , 0x16a3ef08be3ea7ea03bcddfabba6ff6ee5a4375efa1f4fd7feb34fd206357132b920f5b00801dee460ee415a15812ed9
+          , 0x1866c8ed336c61231a1be54fd1d74cc4f9fb0ce4c6af5920abc5750c4bf39b4852cfe2f7bb9248836b233d9d55535d4a
+          , 0x167a55cda70a6e1cea820597d94a84903216f763e13d87bb5308592e7ea7d4fbc7385ea3d529b35e346ef48bb8913f55
+          , 0x4d2f259eea405bd48f010a01ad2911d9c6dd039bb61a6290e591b36e636a5c871a5c29f4f83060400f8b49cba8f6aa8
+          , 0xaccbb67481d033ff5852c1e48c50c477f94ff8aefce42d28c0f9a88cea7913516f968986f7ebbea9684b529e2561092
+          , 0xad6b9514c767fe3c3613144b45f1496543346d98adf02267d5ceef9a00d9b8693000763e3b90ac11e99b138573345cc
+          , 0x2660400eb2e4f3b628bdd0d53cd76f2bf565b94e72927c1cb748df27942480e420517bd8714cc80d1fadc1326ed06f7
+          , 0xe0fa1d816ddc03e6b24255e0d7819c171c40f65e273b853324efcd6356caa205ca2f570f13497804415473a1d634b8f
+          , 0x1
+          ]
+      }
+  }
+
+-- | The suite @BLS12381G2_XMD:SHA-256_SSWU_RO_@ of RFC 9380 (section 8.8.2),
+-- using a 3-isogeny
+bls12_381_g2_hashToCurve :: HashToCurve I2
+bls12_381_g2_hashToCurve = HashToCurve
+  { h2c_L    = 64
+  , h2c_heff = 0xbc69f08f2ee75b3584c6a0ea91b352888e2a8e9145ad7689986ff031508ffe1329c2f178731db956d82bf015d1212b02ec0ec69d7477c1ae954cbc06689f6a359894c0adebbf6b4e8020005aaa95551     -- 3*(x^2-1) * cofactor
+  , h2c_map  = SSWU
+      { sswu_Z   = (-2,-1)                   -- -(2+i)
+      , iso_A    = (0,240)                   -- 240*i
+      , iso_B    = (1012,1012)               -- 1012*(1+i)
+      , iso_xnum =
+          [ (0x5c759507e8e333ebb5b7a9a47d7ed8532c52d39fd3a042a88b58423c50ae15d5c2638e343d9c71c6238aaaaaaaa97d6,0x5c759507e8e333ebb5b7a9a47d7ed8532c52d39fd3a042a88b58423c50ae15d5c2638e343d9c71c6238aaaaaaaa97d6)
+          , (0x0,0x11560bf17baa99bc32126fced787c88f984f87adf7ae0c7f9a208c6b4f20a4181472aaa9cb8d555526a9ffffffffc71a)
+          , (0x11560bf17baa99bc32126fced787c88f984f87adf7ae0c7f9a208c6b4f20a4181472aaa9cb8d555526a9ffffffffc71e,0x8ab05f8bdd54cde190937e76bc3e447cc27c3d6fbd7063fcd104635a790520c0a395554e5c6aaaa9354ffffffffe38d)
+          , (0x171d6541fa38ccfaed6dea691f5fb614cb14b4e7f4e810aa22d6108f142b85757098e38d0f671c7188e2aaaaaaaa5ed1,0x0)
+          ]
+      , iso_xden =
+          [ (0x0,0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffaa63)
+          , (0xc,0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffaa9f)
+          , (0x1,0x0)
+          ]
+      , iso_ynum =
+          [ (0x1530477c7ab4113b59a4c18b076d11930f7da5d4a07f649bf54439d87d27e500fc8c25ebf8c92f6812cfc71c71c6d706,0x1530477c7ab4113b59a4c18b076d11930f7da5d4a07f649bf54439d87d27e500fc8c25ebf8c92f6812cfc71c71c6d706)
+          , (0x0,0x5c759507e8e333ebb5b7a9a47d7ed8532c52d39fd3a042a88b58423c50ae15d5c2638e343d9c71c6238aaaaaaaa97be)
+          , (0x11560bf17baa99bc32126fced787c88f984f87adf7ae0c7f9a208c6b4f20a4181472aaa9cb8d555526a9ffffffffc71c,0x8ab05f8bdd54cde190937e76bc3e447cc27c3d6fbd7063fcd104635a790520c0a395554e5c6aaaa9354ffffffffe38f)
+          , (0x124c9ad43b6cf79bfbf7043de3811ad0761b0f37a1e26286b0e977c69aa274524e79097a56dc4bd9e1b371c71c718b10,0x0)
+          ]
+      , iso_yden =
+          [ (0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffa8fb,0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffa8fb)
+          , (0x0,0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffa9d3)
+          , (0x12,0x1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffaa99)
+          , (0x1,0x0)
+          ]
+      }
+  }
+
 --------------------------------------------------------------------------------
@@ -0,0 +1,239 @@
+-- | Generating structured reference strings (\"powers of tau\"), for testing
+-- (in monomial and Lagrange basis)
+
+{-# LANGUAGE StrictData, RecordWildCards #-}
+module Zikkurat.CodeGen.Curve.SRS where
+
+--------------------------------------------------------------------------------
+
+import Data.List
+import Data.Word
+import Data.Bits
+
+import Zikkurat.CodeGen.Misc
+
+import Zikkurat.CodeGen.Curve.Params
+
+--------------------------------------------------------------------------------
+
+-- | The points are computed in chunks of this size (each chunk with a single
+-- inversion for the affine conversion)
+srsChunkSize :: Int
+srsChunkSize = 1024
+
+--------------------------------------------------------------------------------
+
+srs_c_header :: CodeGenParams -> Code
+srs_c_header (CodeGenParams{..}) =
+  [ "extern void " ++ prefix ++ "srs_generate           ( int N, const uint64_t *tau , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "srs_generate_lagrange  ( int m, const uint64_t *gen , const uint64_t *tau , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "srs_monomial_to_lagrange( int m, const uint64_t *gen , const uint64_t *src , uint64_t *tgt );"
+  ]
+
+--------------------------------------------------------------------------------
+
+srs_hs_binding :: CodeGenParams -> Code
+srs_hs_binding (CodeGenParams{..}) =
+  [ ""
+  , "foreign import ccall unsafe \"" ++ prefix ++ "srs_generate\" c_" ++ prefix ++ "srs_generate :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "srs_generate_lagrange\" c_" ++ prefix ++ "srs_generate_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "srs_monomial_to_lagrange\" c_" ++ prefix ++ "srs_monomial_to_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "{-# NOINLINE srsMonomial #-}"
+  , "-- | The \"powers of tau\" @[ tau^i * gen | i <- [0..n-1] ]@ in affine coordinates."
+  , "-- Only for testing: whoever knows @tau@ can forge proofs!"
+  , "srsMonomial :: Int -> Fr -> FlatArray " ++ affineType
+  , "srsMonomial n (MkFr fptr1) = unsafePerformIO $ do"
+  , "  fptr2 <- mallocForeignPtrArray (n*" ++ show (2*nlimbs_p) ++ ")"
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_" ++ prefix ++ "srs_generate (fromIntegral n) ptr1 ptr2"
+  , "  return (MkFlatArray n fptr2)"
+  , ""
+  , "{-# NOINLINE srsLagrange #-}"
+  , "-- | The same setup in the Lagrange basis of the subgroup, that is @[ L_k(tau) * gen ]@"
+  , "-- in affine coordinates. Only for testing: whoever knows @tau@ can forge proofs!"
+  , "srsLagrange :: FFTSubgroup Fr -> Fr -> FlatArray " ++ affineType
+  , "srsLagrange sg (MkFr fptr2) = unsafePerformIO $ do"
+  , "  let n = fftSubgroupSize sg"
+  , "  fptr3 <- mallocForeignPtrArray (n*" ++ show (2*nlimbs_p) ++ ")"
+  , "  L.withFlat (fftSubgroupGen sg) $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "        c_" ++ prefix ++ "srs_generate_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3"
+  , "  return (MkFlatArray n fptr3)"
+  , ""
+  , "{-# NOINLINE srsToLagrange #-}"
+  , "-- | Converts an existing setup @[tau^i * gen]@ (for example from a ceremony, where"
+  , "-- nobody knows @tau@) to the Lagrange basis, using the group FFT"
+  , "-- (so the points must be in the prime-order subgroup)"
+  , "srsToLagrange :: FFTSubgroup Fr -> FlatArray " ++ affineType ++ " -> FlatArray " ++ affineType
+  , "srsToLagrange sg (MkFlatArray n fptr2)"
+  , "  | fftSubgroupSize sg /= n   = error \"srsToLagrange: subgroup size differs from the array size\""
+  , "  | otherwise                 = unsafePerformIO $ do"
+  , "      fptr3 <- mallocForeignPtrArray (n*" ++ show (2*nlimbs_p) ++ ")"
+  , "      L.withFlat (fftSubgroupGen sg) $ \\ptr1 -> do"
+  , "        withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "          withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "            c_" ++ prefix ++ "srs_monomial_to_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3"
+  , "      return (MkFlatArray n fptr3)"
+  , ""
+  ]
+  where
+    affineType = hsModule hs_path_affine ++ "." ++ typeName
+
+--------------------------------------------------------------------------------
+
+c_srs :: CodeGenParams -> Code
+c_srs (CodeGenParams{..}) =
+  [ "//------------------------------------------------------------------------------"
+  , "// generating a structured reference string (\"powers of tau\"), for testing"
+  , "//"
+  , "// The points are computed in chunks: each chunk computes its scalars, multiplies"
+  , "// the generator by them (using the precomputed comb table), and converts the results"
+  , "// to affine coordinates with a single inversion. The chunks are distributed among"
+  , "// the worker threads, so that no N-sized temporary buffer is needed."
+  , "//"
+  , "// In the Lagrange basis of the subgroup generated by `gen` (of size N), we have"
+  , "//"
+  , "//   L_k(tau) = gen^k * (tau^N - 1) / ( N * (tau - gen^k) )"
+  , "//"
+  , "// so when `tau` is known, the Lagrange basis costs the same as the monomial one"
+  , "// (plus a batched inversion in Fr). Without `tau`, the monomial basis can be"
+  , "// converted by an inverse group FFT, which is much slower."
+  , ""
+  , "#define SRS_CHUNK " ++ show srsChunkSize
+  , ""
+  , "typedef struct {"
+  , "  int N;"
+  , "  const uint64_t *tau;       // Montgomery repr"
+  , "  const uint64_t *gen;       // generator of the subgroup (only for the Lagrange basis)"
+  , "  const uint64_t *coeff;     // (tau^N - 1) / N          (only for the Lagrange basis)"
+  , "  uint64_t *tgt;"
+  , "} " ++ prefix ++ "srs_ctx_t;"
+  , ""
+  , "// multiplies the generator by `n` scalars (in Montgomery repr), with affine output"
+  , "void " ++ prefix ++ "srs_scale_gen_chunk( int n, const uint64_t *scalars, uint64_t *tgt ) {"
+  , "  uint64_t *tmp = malloc( 8*3*NLIMBS_P * n );"
+  , "  assert( tmp != 0 );"
+  , "  for(int i=0; i<n; i++) {"
+  , "    " ++ prefix ++ "scl_gen_Fr_mont( scalars + i*NLIMBS_R , tmp + i*3*NLIMBS_P );"
+  , "  }"
+  , "  " ++ prefix ++ "batch_to_affine( n , tmp , tgt );"
+  , "  free(tmp);"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "srs_monomial_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "srs_ctx_t *c = (" ++ prefix ++ "srs_ctx_t*) ctx;"
+  , "  int a = j * SRS_CHUNK;"
+  , "  int b = a + SRS_CHUNK;"
+  , "  if (b > c->N) { b = c->N; }"
+  , "  uint64_t *scalars = malloc( 8*NLIMBS_R * (b-a) );"
+  , "  assert( scalars != 0 );"
+  , "  uint64_t start[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "pow_uint64( c->tau , a , start );"
+  , "  " ++ prefix_arr_r ++ "powers( b-a , start , c->tau , scalars );"
+  , "  " ++ prefix ++ "srs_scale_gen_chunk( b-a , scalars , c->tgt + a*2*NLIMBS_P );"
+  , "  free(scalars);"
+  , "}"
+  , ""
+  , "// computes `[ tau^i * G | i <- [0..N-1] ]` in affine coordinates, where `G` is the"
+  , "// subgroup generator and `tau` is in Fr *in Montgomery repr*"
+  , "void " ++ prefix ++ "srs_generate( int N, const uint64_t *tau, uint64_t *tgt ) {"
+  , "  if (N <= 0) return;"
+  , "  " ++ prefix ++ "srs_ctx_t ctx;"
+  , "  ctx.N     = N;"
+  , "  ctx.tau   = tau;"
+  , "  ctx.gen   = 0;"
+  , "  ctx.coeff = 0;"
+  , "  ctx.tgt   = tgt;"
+  , "  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , " ++ prefix ++ "srs_monomial_task , &ctx );"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "srs_lagrange_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "srs_ctx_t *c = (" ++ prefix ++ "srs_ctx_t*) ctx;"
+  , "  int a = j * SRS_CHUNK;"
+  , "  int b = a + SRS_CHUNK;"
+  , "  if (b > c->N) { b = c->N; }"
+  , "  int n = b - a;"
+  , "  uint64_t *scalars = malloc( 8*NLIMBS_R * n );"
+  , "  uint64_t *denoms  = malloc( 8*NLIMBS_R * n );"
+  , "  assert( scalars != 0 );"
+  , "  assert( denoms  != 0 );"
+  , ""
+  , "  // scalars[i] = gen^(a+i)"
+  , "  uint64_t start[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "pow_uint64( c->gen , a , start );"
+  , "  " ++ prefix_arr_r ++ "powers( n , start , c->gen , scalars );"
+  , ""
+  , "  if (" ++ prefix_r ++ "is_zero( c->coeff )) {"
+  , "    // tau is in the subgroup, so L_k(tau) is 1 if tau = gen^k and 0 otherwise"
+  , "    for(int i=0; i<n; i++) {"
+  , "      uint64_t *s = scalars + i*NLIMBS_R;"
+  , "      if (" ++ prefix_r ++ "is_equal( s , c->tau )) { " ++ prefix_r ++ "set_one( s ); } else { " ++ prefix_r ++ "set_zero( s ); }"
+  , "    }"
+  , "  }"
+  , "  else {"
+  , "    for(int i=0; i<n; i++) {"
+  , "      " ++ prefix_r ++ "sub( c->tau , scalars + i*NLIMBS_R , denoms + i*NLIMBS_R );"
+  , "    }"
+  , "    " ++ prefix_r ++ "batch_inv( n , denoms , denoms );"
+  , "    for(int i=0; i<n; i++) {"
+  , "      uint64_t *s = scalars + i*NLIMBS_R;"
+  , "      " ++ prefix_r ++ "mul_inplace( s , denoms + i*NLIMBS_R );"
+  , "      " ++ prefix_r ++ "mul_inplace( s , c->coeff );"
+  , "    }"
+  , "  }"
+  , ""
+  , "  " ++ prefix ++ "srs_scale_gen_chunk( n , scalars , c->tgt + a*2*NLIMBS_P );"
+  , "  free(denoms);"
+  , "  free(scalars);"
+  , "}"
+  , ""
+  , "// computes `[ L_k(tau) * G | k <- [0..N-1] ]` in affine coordinates, where `N = 2^m`,"
+  , "// `L_k` are the Lagrange polynomials of the subgroup generated by `gen`, `G` is the"
+  , "// curve subgroup generator, and both `gen` and `tau` are in Fr *in Montgomery repr*"
+  , "void " ++ prefix ++ "srs_generate_lagrange( int m, const uint64_t *gen, const uint64_t *tau, uint64_t *tgt ) {"
+  , "  int N = (1<<m);"
+  , ""
+  , "  // coeff = (tau^N - 1) / N"
+  , "  uint64_t coeff[NLIMBS_R];"
+  , "  uint64_t one  [NLIMBS_R];"
+  , "  uint64_t size [NLIMBS_R];"
+  , "  uint64_t N_std[NLIMBS_R];"
+  , "  " ++ prefix_r ++ "set_one( one );"
+  , "  memset( N_std, 0, 8*NLIMBS_R );"
+  , "  N_std[0] = N;"
+  , "  " ++ prefix_r ++ "from_std( N_std , size );"
+  , "  " ++ prefix_r ++ "pow_uint64( tau , N , coeff );"
+  , "  " ++ prefix_r ++ "sub_inplace( coeff , one );"
+  , "  " ++ prefix_r ++ "div_inplace( coeff , size );"
+  , ""
+  , "  " ++ prefix ++ "srs_ctx_t ctx;"
+  , "  ctx.N     = N;"
+  , "  ctx.tau   = tau;"
+  , "  ctx.gen   = gen;"
+  , "  ctx.coeff = coeff;"
+  , "  ctx.tgt   = tgt;"
+  , "  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , " ++ prefix ++ "srs_lagrange_task , &ctx );"
+  , "}"
+  , ""
+  , "// converts `[ tau^i * G | i <- [0..N-1] ]` (affine, where `N = 2^m`) to the Lagrange"
+  , "// basis of the subgroup generated by `gen` (in Montgomery repr), using the group FFT."
+  , "// This is useful when `tau` is not known; it needs a temporary buffer of N projective points."
+  , "// Note: the output must not overlap with the input"
+  , "// The points must be in the prime-order subgroup (as for the group FFT)"
+  , "void " ++ prefix ++ "srs_monomial_to_lagrange( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt ) {"
+  , "  int N = (1<<m);"
+  , "  uint64_t *tmp = malloc( 8*3*NLIMBS_P * N );"
+  , "  assert( tmp != 0 );"
+  , "  " ++ prefix ++ "batch_from_affine( N , src , tmp );"
+  , "  " ++ prefix ++ "fft_inverse( m , gen , tmp , tmp );"
+  , "  " ++ prefix ++ "batch_to_affine_parallel( N , tmp , tgt );"
+  , "  free(tmp);"
+  , "}"
+  , ""
+  , "#undef SRS_CHUNK"
+  ]
+
+--------------------------------------------------------------------------------
@@ -43,6 +43,9 @@ c_begin_curve1 is_proj (Curve1{..}) cgparams@(CodeGenParams{..}) =
   , "// the cofactor of the curve subgroup = " ++ show cofactor
   , mkConst nlimbs_p (prefix ++ "cofactor") cofactor
   , ""
+  , "// the order of the subgroup = " ++ show curveFr
+  , mkConst nlimbs_r (prefix ++ "subgroup_order") curveFr
+  , ""
   , "// the constants A and B of the equation"
   , mkConst nlimbs_p (prefix ++ "const_A" ) (toMontgomery curveA)
   , mkConst nlimbs_p (prefix ++ "const_B" ) (toMontgomery curveB)
@@ -61,6 +64,9 @@ c_begin_curve2 is_proj (Curve12 curve1 curve2@(Curve2{..})) cgparams@(CodeGenPar
   , "// the cofactor of the curve subgroup = " ++ show g2_cofactor
   , mkConst nlimbs_p (prefix ++ "cofactor") g2_cofactor
   , ""
+  , "// the order of the subgroup = " ++ show (curveFr curve1)
+  , mkConst nlimbs_r (prefix ++ "subgroup_order") (curveFr curve1)
+  , ""
   , "// the constants A and B of the equation"
   , mkConstFp2 nlimbs_p (prefix ++ "const_A")  (toMontgomeryFp2 g2_curveA)
   , mkConstFp2 nlimbs_p (prefix ++ "const_B")  (toMontgomeryFp2 g2_curveB)
@@ -169,3 +175,448 @@ hsSage_curve2 curve12 params =
   ]
 
 --------------------------------------------------------------------------------
+
+--------------------------------------------------------------------------------
+-- * Scaling by the curve constants (shared by projective and Jacobian coordinates)
+
+scale_by_AB3B :: XCurve -> CodeGenParams -> Code
+scale_by_AB3B xcurve params = case xcurve of
+  Left curve1 -> concat
+    [ g1_scale_by_A  "" curve1 params
+    , g1_scale_by_B     curve1 params
+    , g1_scale_by_3B "" curve1 params
+    ]
+  Right curve12 -> concat
+    [ g2_scale_by_A  "" curve12 params
+    , g2_scale_by_B     curve12 params
+    , g2_scale_by_3B "" curve12 params
+    ]
+
+-- | Scaling by @A@ and @3B@ using the branch-free field operations (these are
+-- needed by the point formulas of the constant-time scalar multiplication)
+scale_by_A3B_ct :: XCurve -> CodeGenParams -> Code
+scale_by_A3B_ct xcurve params = case xcurve of
+  Left curve1 -> concat
+    [ g1_scale_by_A  "_ct" curve1 params
+    , g1_scale_by_3B "_ct" curve1 params
+    ]
+  Right curve12 -> concat
+    [ g2_scale_by_A  "_ct" curve12 params
+    , g2_scale_by_3B "_ct" curve12 params
+    ]
+
+--------------------------------------------------------------------------------
+
+g2_scale_by_A :: String -> Curve12 -> CodeGenParams -> Code
+g2_scale_by_A ct (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveA of
+  (0,0) -> [ "// scale an Fp2 field element by A = " ++ show g2_curveA
+           , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           ]
+
+  _ ->     [ "// scale an Fp2 field element by A = " ++ show g2_curveA
+           , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul" ++ ct ++ "( " ++ prefix ++ "const_A, src, tgt );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( tgt, " ++ prefix ++ "const_A );"
+           , "}"
+           ]
+
+g2_scale_by_B :: Curve12 -> CodeGenParams -> Code
+g2_scale_by_B (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveB of
+  (0,0) -> [ "// scale an Fp2 field element by B = " ++ show g2_curveB
+           , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           ]
+
+  _ ->     [ "// scale an Fp field element by B = " ++ show g2_curveB
+           , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_B, src, tgt );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_B );"
+           , "}"
+           ]
+
+g2_scale_by_3B :: String -> Curve12 -> CodeGenParams -> Code
+g2_scale_by_3B ct (Curve12 (Curve1{..}) (Curve2{..})) (CodeGenParams{..}) = case g2_curveB of
+  (0,0) -> [ "// scale an Fp2 field element by 3B = 3*" ++ show g2_curveB
+           , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+           , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+           , "}"
+           ]
+
+  _ ->     [ "// scale an Fp field element by 3B = 3*" ++ show g2_curveB
+           , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul" ++ ct ++ "( " ++ prefix ++ "const_3B, src, tgt );"
+           , "}"
+           , ""
+           , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+           , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( tgt, " ++ prefix ++ "const_3B );"
+           , "}"
+           ]
+
+--------------------------------------------------------------------------------
+
+g1_scale_by_A :: String -> Curve1 -> CodeGenParams -> Code
+g1_scale_by_A ct (Curve1{..}) (CodeGenParams{..}) = case curveA of
+
+  0 -> [ "// scale a field element by A = " ++ show curveA
+       , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       ]
+
+  1 -> [ "// scale a field element by A = " ++ show curveA
+       , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  // no-op"
+       , "}"
+       ]
+
+  2 -> [ "// scale a field element by A = " ++ show curveA
+       , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( src, src, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( tgt, tgt );"
+       , "}"
+       ]
+
+  _ -> [ "// scale a field element by A = " ++ show curveA
+       , "void " ++ prefix ++ "scale_by_A" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul" ++ ct ++ "( " ++ prefix ++ "const_A, src, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_A_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( tgt, " ++ prefix ++ "const_A );"
+       , "}"
+       ]
+
+----------------------------------------
+
+g1_scale_by_B ::  Curve1 -> CodeGenParams -> Code
+g1_scale_by_B (Curve1{..}) (CodeGenParams{..}) = case curveB of
+
+  0 -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       ]
+
+  1 -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  if (tgt != src) { memcpy( tgt, src, " ++ show (8*nlimbs_p) ++ " ); }"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  // no-op"
+       , "}"
+       ]
+
+  2 -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "add( src, src, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "add_inplace( tgt, tgt );"
+       , "}"
+       ]
+
+  3 -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
+       , "  " ++ prefix_p ++ "add( src, src, tmp );"
+       , "  " ++ prefix_p ++ "add( src, tmp, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
+       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
+       , "  " ++ prefix_p ++ "add_inplace( tgt, tmp );"
+       , "}"
+       ]
+
+  4 -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
+       , "  " ++ prefix_p ++ "add( src, src, tmp );"
+       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  uint64_t tmp[" ++ show nlimbs_p ++ "];"
+       , "  " ++ prefix_p ++ "add( tgt, tgt, tmp );"
+       , "  " ++ prefix_p ++ "add( tmp, tmp, tgt );"
+       , "}"
+       ]
+
+  _ -> [ "// scale a field element by B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_B(const uint64_t *src, uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul( " ++ prefix ++ "const_B, src, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_B_inplace( uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul_inplace( tgt, " ++ prefix ++ "const_B );"
+       , "}"
+       ]
+
+----------------------------------------
+
+g1_scale_by_3B :: String -> Curve1 -> CodeGenParams -> Code
+g1_scale_by_3B ct (Curve1{..}) (CodeGenParams{..}) = case curveB of
+
+  0 -> [ "// scale a field element by (3*B) = " ++ show (3*curveB)
+       , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  memset( tgt, 0, " ++ show (8*nlimbs_p) ++ " );"
+       , "}"
+       ]
+
+  3 -> [ "// scale a field element by (3*B) = " ++ show (3*curveB)
+       , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  uint64_t tmp[NLIMBS_P];"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( src, src, tmp );       // 2*B"
+       , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( tmp, tmp );    // 4*B"
+       , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( tmp, tmp );    // 8*B"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( src, tmp, tgt );       // 9*B"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  " ++ prefix ++ "scale_by_3B" ++ ct ++ "( tgt , tgt );"
+       , "}"
+       ]
+
+  4  ->[ "// scale a field element by (3*B) = " ++ show (3*curveB)
+       , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  uint64_t tmp [NLIMBS_P];"
+       , "  uint64_t tmp2[NLIMBS_P];"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( src, src, tmp );       // 2*B"
+       , "  " ++ prefix_p ++ "add_inplace" ++ ct ++ "( tmp, tmp );    // 4*B"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( tmp, tmp, tmp2);       // 8*B"
+       , "  " ++ prefix_p ++ "add" ++ ct ++ "( tmp, tmp2, tgt );      // 12*B"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  " ++ prefix ++ "scale_by_3B" ++ ct ++ "( tgt , tgt );"
+       , "}"
+       ]
+
+  _ -> [ "// scale a field element by 3B = " ++ show curveB
+       , "void " ++ prefix ++ "scale_by_3B" ++ ct ++ "(const uint64_t *src, uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul" ++ ct ++ "( " ++ prefix ++ "const_3B, src, tgt );"
+       , "}"
+       , ""
+       , "void " ++ prefix ++ "scale_by_3B_inplace" ++ ct ++ "( uint64_t *tgt ) {"
+       , "  " ++ prefix_p ++ "mul_inplace" ++ ct ++ "( tgt, " ++ prefix ++ "const_3B );"
+       , "}"
+       ]
+
+--------------------------------------------------------------------------------
+
+--------------------------------------------------------------------------------
+-- * GLV scalar multiplication
+
+-- | A short basis @(a1,b1), (a2,b2)@ of the lattice @{ (a,b) | a + b*lambda = 0 mod r }@,
+-- computed with the extended Euclidean algorithm (as in the GLV paper). The signs and
+-- the order are normalized so that @a1*b2 - a2*b1 = r@, @b1 <= 0@ and @b2 >= 0@, which
+-- makes the rounding constants of the decomposition nonnegative.
+glvBasis :: Integer -> Integer -> (Integer,Integer,Integer,Integer)
+glvBasis r lambda = head [ c | c@(a1,b1,a2,b2) <- cands , a1*b2 - a2*b1 == r , b1 <= 0 , b2 >= 0 ] where
+  rts = euclid r 0 lambda 1
+  euclid r0 t0 r1 t1
+    | r1 == 0   = [(r0,t0),(r1,t1)]
+    | otherwise = (r0,t0) : euclid r1 t1 (r0 - q*r1) (t0 - q*t1) where q = div r0 r1
+  l  = last [ i | (i,(ri,_)) <- zip [0..] rts , (ri+1)*(ri+1) > r ]
+  vec i = let (ri,ti) = rts !! i in (ri, negate ti)
+  v1 = vec (l+1)
+  v2 = minimumBy (\x y -> compare (norm2 x) (norm2 y)) [ vec l , vec (l+2) ]
+  norm2 (a,b) = a*a + b*b
+  cands = [ (s1*x1, s1*y1, s2*x2, s2*y2)
+          | ((x1,y1),(x2,y2)) <- [ (v1,v2) , (v2,v1) ]
+          , s1 <- [1,-1]
+          , s2 <- [1,-1]
+          ]
+
+-- | Header declarations for 'scaleGLV'
+glv_c_header :: XCurve -> CodeGenParams -> Code
+glv_c_header xcurve (CodeGenParams{..}) = if not (hasGLV xcurve) then [] else
+  [ ""
+  , "extern void " ++ prefix ++ "endo_phi       ( const uint64_t *src , uint64_t *tgt );"
+  , "extern int  " ++ prefix ++ "glv_decompose  ( const uint64_t *k , uint64_t *k1 , uint64_t *k2 );"
+  , "extern void " ++ prefix ++ "scl_glv_Fr_std ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "scl_glv_Fr_mont( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );"
+  ]
+
+-- | GLV scalar multiplication on G1 (empty if the curve has no 'glvBetaLambda')
+scaleGLV :: XCurve -> CodeGenParams -> Code
+scaleGLV xcurve (CodeGenParams{..}) = case xcurve of
+  Right _                -> []
+  Left  (Curve1{..})     -> case glvBetaLambda of
+    Nothing              -> []
+    Just (beta,lambda)   -> let
+      (a1,b1,a2,b2) = glvBasis curveFr lambda
+      bits  = 64*nlimbs_r
+      g1    = div (  b2  * 2^bits + div curveFr 2) curveFr
+      g2    = div ((-b1) * 2^bits + div curveFr 2) curveFr
+      twos x = mod x (2^bits)
+      big   = "bigint" ++ show bits ++ "_"
+      toMontgomery x = mod ( 2^(64*nlimbs_p) * x ) curveFp
+      in
+      [ ""
+      , "//------------------------------------------------------------------------------"
+      , "// GLV scalar multiplication"
+      , "//"
+      , "// The endomorphism `phi(x,y) = (beta*x,y)` (where `beta` is a cube root of unity)"
+      , "// acts on the subgroup G1 as multiplication by `lambda`. Writing the scalar as"
+      , "// `k = k1 + k2*lambda` with `|k1|,|k2| ~ sqrt(r)`, we can compute"
+      , "//"
+      , "//   k*P = k1*P + k2*phi(P)"
+      , "//"
+      , "// with half as many doublings as a standard scalar multiplication."
+      , ""
+      , "// beta (Montgomery repr)"
+      , mkConst nlimbs_p (prefix ++ "glv_beta") (toMontgomery beta)
+      , ""
+      , "// a short basis `(a1,b1), (a2,b2)` of the lattice `{ (a,b) | a + b*lambda = 0 mod r }`"
+      , "// with determinant `r`, as two's complement numbers"
+      , mkConst nlimbs_r (prefix ++ "glv_a1") (twos a1)
+      , mkConst nlimbs_r (prefix ++ "glv_b1") (twos b1)
+      , mkConst nlimbs_r (prefix ++ "glv_a2") (twos a2)
+      , mkConst nlimbs_r (prefix ++ "glv_b2") (twos b2)
+      , ""
+      , "// `g1 = round(2^" ++ show (64*nlimbs_r) ++ " * b2 / r)` and `g2 = round(-2^" ++ show (64*nlimbs_r) ++ " * b1 / r)`"
+      , mkConst nlimbs_r (prefix ++ "glv_g1") g1
+      , mkConst nlimbs_r (prefix ++ "glv_g2") g2
+      , ""
+      , "// the endomorphism `phi(x,y) = (beta*x,y)`"
+      , "void " ++ prefix ++ "endo_phi( const uint64_t *src1, uint64_t *tgt ) {"
+      , "  " ++ prefix_p ++ "mul( X1 , " ++ prefix ++ "glv_beta , X3 );"
+      , "  if (tgt != src1) { memcpy( Y3, Y1, " ++ show (8*2*nlimbs_p) ++ " ); }"
+      , "}"
+      , ""
+      , "// computes `c = round( k*g / 2^" ++ show (64*nlimbs_r) ++ " )`"
+      , "void " ++ prefix ++ "glv_round_mul( const uint64_t *k, const uint64_t *g, uint64_t *c ) {"
+      , "  uint64_t prod[2*NLIMBS_R];"
+      , "  " ++ big ++ "mul( k , g , prod );"
+      , "  memcpy( c , prod + NLIMBS_R , 8*NLIMBS_R );"
+      , "  if (prod[NLIMBS_R-1] >> 63) { " ++ big ++ "inc_inplace( c ); }"
+      , "}"
+      , ""
+      , "// Decomposes a scalar `0 <= k < r` (in standard repr) as `k = k1 + k2*lambda (mod r)`,"
+      , "// using Babai rounding with the short basis above. The absolute values (which are at"
+      , "// most 128 bits) are written into `k1` and `k2`, the signs are returned in the"
+      , "// bits 0 and 1 of the result."
+      , "int " ++ prefix ++ "glv_decompose( const uint64_t *k, uint64_t *k1, uint64_t *k2 ) {"
+      , "  uint64_t c1[NLIMBS_R];"
+      , "  uint64_t c2[NLIMBS_R];"
+      , "  uint64_t t [NLIMBS_R];"
+      , "  " ++ prefix ++ "glv_round_mul( k , " ++ prefix ++ "glv_g1 , c1 );"
+      , "  " ++ prefix ++ "glv_round_mul( k , " ++ prefix ++ "glv_g2 , c2 );"
+      , ""
+      , "  // k1 = k - c1*a1 - c2*a2"
+      , "  " ++ big ++ "copy( k , k1 );"
+      , "  " ++ big ++ "mul_truncated( c1 , " ++ prefix ++ "glv_a1 , t );  " ++ big ++ "sub_inplace( k1 , t );"
+      , "  " ++ big ++ "mul_truncated( c2 , " ++ prefix ++ "glv_a2 , t );  " ++ big ++ "sub_inplace( k1 , t );"
+      , ""
+      , "  // k2 = - c1*b1 - c2*b2"
+      , "  " ++ big ++ "mul_truncated( c1 , " ++ prefix ++ "glv_b1 , k2 );"
+      , "  " ++ big ++ "mul_truncated( c2 , " ++ prefix ++ "glv_b2 , t  );  " ++ big ++ "add_inplace( k2 , t );"
+      , "  " ++ big ++ "neg_inplace( k2 );"
+      , ""
+      , "  int signs = 0;"
+      , "  if (k1[NLIMBS_R-1] >> 63) { " ++ big ++ "neg_inplace( k1 ); signs |= 1; }"
+      , "  if (k2[NLIMBS_R-1] >> 63) { " ++ big ++ "neg_inplace( k2 ); signs |= 2; }"
+      , "  return signs;"
+      , "}"
+      , ""
+      , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
+      , "// where `grp` is a group element in G1, and `expo` is in Fr *in standard repr*,"
+      , "// using the GLV decomposition and interleaved 4-bit windows."
+      , "// Note: this is only valid for points in the subgroup G1!"
+      , "void " ++ prefix ++ "scl_glv_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
+      , "  uint64_t k1[NLIMBS_R];"
+      , "  uint64_t k2[NLIMBS_R];"
+      , "  int signs = " ++ prefix ++ "glv_decompose( expo , k1 , k2 );"
+      , ""
+      , "  // precalculate [ k*(+-g) | k <- [1..15] ] and [ k*(+-phi(g)) | k <- [1..15] ];"
+      , "  // since `phi` is a group homomorphism, the second table is the image of the first"
+      , "  uint64_t table1[15*3*NLIMBS_P];"
+      , "  uint64_t table2[15*3*NLIMBS_P];"
+      , "  uint64_t base[3*NLIMBS_P];"
+      , "  " ++ prefix ++ "copy( grp, base );"
+      , "  if (signs & 1) { " ++ prefix ++ "neg_inplace( base ); }"
+      , "  " ++ prefix ++ "precalc_expos_window_16( base, table1 );"
+      , "  for(int j=0; j<15; j++) {"
+      , "    " ++ prefix ++ "endo_phi( table1 + j*3*NLIMBS_P , table2 + j*3*NLIMBS_P );"
+      , "    if ((signs ^ (signs >> 1)) & 1) { " ++ prefix ++ "neg_inplace( table2 + j*3*NLIMBS_P ); }"
+      , "  }"
+      , ""
+      , "  " ++ prefix ++ "set_infinity( tgt );           // tgt := infinity"
+      , ""
+      , "  int s = NLIMBS_R - 1;"
+      , "  while( (s>0) && (k1[s] == 0) && (k2[s] == 0) ) { s--; }"
+      , ""
+      , "  for(int i=s; i>=0; i--) {"
+      , "    uint64_t e1 = k1[i];"
+      , "    uint64_t e2 = k2[i];"
+      , "    for(int j=0; j<16; j++) {"
+      , "      // we can skip doubling when infinity"
+      , "      if (!" ++ prefix_p ++ "is_zero(tgt+2*NLIMBS_P)) {"
+      , "        " ++ prefix ++ "dbl_inplace( tgt );"
+      , "        " ++ prefix ++ "dbl_inplace( tgt );"
+      , "        " ++ prefix ++ "dbl_inplace( tgt );"
+      , "        " ++ prefix ++ "dbl_inplace( tgt );"
+      , "      }"
+      , "      int d1 = (e1 >> 60);"
+      , "      int d2 = (e2 >> 60);"
+      , "      if (d1) { " ++ prefix ++ "add_inplace( tgt, table1 + (d1-1)*3*NLIMBS_P ); }"
+      , "      if (d2) { " ++ prefix ++ "add_inplace( tgt, table2 + (d2-1)*3*NLIMBS_P ); }"
+      , "      e1 = e1 << 4;"
+      , "      e2 = e2 << 4;"
+      , "    }"
+      , "  }"
+      , "}"
+      , ""
+      , "// computes `expo*grp` (or `grp^expo` in multiplicative notation)"
+      , "// where `grp` is a group element in G1, and `expo` is in Fr *in Montgomery repr*,"
+      , "// using the GLV decomposition. Note: this is only valid for points in the subgroup G1!"
+      , "void " ++ prefix ++ "scl_glv_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {"
+      , "  uint64_t expo_std[NLIMBS_R];"
+      , "  " ++ prefix_r ++ "to_std(expo, expo_std);"
+      , "  " ++ prefix ++ "scl_glv_Fr_std(expo_std, grp, tgt);"
+      , "}"
+      ]
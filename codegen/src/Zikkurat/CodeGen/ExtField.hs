@@ -89,6 +89,20 @@ data ExtParams = ExtParams
 extNWords :: ExtParams -> Int
 extNWords ep = extDegree ep * baseNWords ep
 
+-- | We only implement square roots in quadratic extensions @Fp[u]/(u^2+1)@ of
+-- the prime field (which is the case for the Fp2 of both BN254 and BLS12-381)
+hasSqrtExt :: ExtParams -> Bool
+hasSqrtExt (ExtParams{..}) = extDegree == 2 && primeDegree == 2 && is_u2_plus_1 where
+  is_u2_plus_1 = case irredPoly of
+    AnyIrredPoly (IrredPoly [q,p]) -> isZero p && isOne q
+    _                              -> False
+
+-- | Branch-free versions of the basic operations (needed by the constant-time
+-- scalar multiplication on G2) are only generated for quadratic extensions
+-- of the prime field
+hasConstTimeExt :: ExtParams -> Bool
+hasConstTimeExt (ExtParams{..}) = extDegree == 2 && primeDegree == 2
+
 toCommonParams :: ExtParams -> CommonParams
 toCommonParams (ExtParams{..}) = CommonParams 
   { Common.prefix     = prefix
@@ -100,7 +114,7 @@ toCommonParams (ExtParams{..}) = CommonParams
 --------------------------------------------------------------------------------
 
 c_header :: ExtParams -> Code
-c_header (ExtParams{..}) =
+c_header extparams@(ExtParams{..}) =
   [ "#include <stdint.h>"
   , ""
   , "extern void " ++ prefix ++ "from_base_field ( const uint64_t *src , uint64_t *tgt );"
@@ -111,7 +125,24 @@ c_header (ExtParams{..}) =
   , ""
   , "extern void " ++ prefix ++ "frobenius( const uint64_t *src , uint64_t *tgt );"
   , "extern void " ++ prefix ++ "frobenius_inplace( uint64_t *tgt );"
-  ,""
+  , "extern void " ++ prefix ++ "frobenius_k( const uint64_t *src , int k , uint64_t *tgt );"
+  ] ++
+  concat
+  [ [ "extern void " ++ prefix ++ "frobenius_" ++ show k ++ "( const uint64_t *src , uint64_t *tgt );"
+    , "extern void " ++ prefix ++ "frobenius_" ++ show k ++ "_inplace( uint64_t *tgt );"
+    ]
+  | k <- frobeniusPowers extparams
+  ] ++
+  (case extDegree of
+    2 -> [ ""
+         , "extern void " ++ prefix ++ "conjugate( const uint64_t *src , uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "conjugate_inplace( uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "cyclotomic_inv( const uint64_t *src , uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "cyclotomic_inv_inplace( uint64_t *tgt );"
+         ]
+    _ -> []
+  ) ++
+  [ ""
   , "extern uint8_t " ++ prefix ++ "is_valid ( const uint64_t *src );"
   , "extern uint8_t " ++ prefix ++ "is_zero  ( const uint64_t *src );"
   , "extern uint8_t " ++ prefix ++ "is_one   ( const uint64_t *src );"
@@ -146,7 +177,31 @@ c_header (ExtParams{..}) =
   , ""
   , "extern void " ++ prefix ++ "pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );"
   , "extern void " ++ prefix ++ "pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );"
-  ]
+  , "extern void " ++ prefix ++ "pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );"
+  ] ++
+  (if hasSqrtExt extparams
+    then [ ""
+         , "extern uint8_t " ++ prefix ++ "is_square ( const uint64_t *src );"
+         , "extern uint8_t " ++ prefix ++ "sqrt      ( const uint64_t *src, uint64_t *tgt );"
+         ]
+    else []
+  ) ++
+  (if hasConstTimeExt extparams
+    then [ ""
+         , "extern void " ++ prefix ++ "neg_ct ( const uint64_t *src ,       uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "sqr_ct ( const uint64_t *src ,       uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "mul_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+         , ""
+         , "extern void " ++ prefix ++ "add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );"
+         , "extern void " ++ prefix ++ "sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );"
+         , "extern void " ++ prefix ++ "sqr_inplace_ct ( uint64_t *tgt );"
+         , "extern void " ++ prefix ++ "mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2);"
+         , "extern void " ++ prefix ++ "sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 );"
+         ]
+    else []
+  )
 
 --------------------------------------------------------------------------------
 
@@ -418,37 +473,43 @@ c_mulExtInplace ExtParams{..} =
 --------------------------------------------------------------------------------
 
 c_mulExtQuadratic :: ExtParams -> Code
-c_mulExtQuadratic ExtParams{..} =  
+c_mulExtQuadratic = c_mulExtQuadratic' ""
+
+-- | The suffix @ct@ is appended to the names of all the functions (both the
+-- ones generated and the base field ones called), so with @"_ct"@ we get the
+-- branch-free versions
+c_mulExtQuadratic' :: String -> ExtParams -> Code
+c_mulExtQuadratic' ct ExtParams{..} =  
   [ "// we use Karatsuba trick to have only 3 multiplications"
-  , "void " ++ prefix ++ "mul ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  , "void " ++ prefix ++ "mul" ++ ct ++ " ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
   , "  uint64_t p[BASE_NWORDS];"
   , "  uint64_t q[BASE_NWORDS];"
   , "  uint64_t r[BASE_NWORDS];"
   , "  uint64_t tmp[BASE_NWORDS];"
-  , "  " ++ base_prefix ++ "mul( SRC1(0) , SRC2(0) , p );         // a0*b0"
-  , "  " ++ base_prefix ++ "mul( SRC1(1) , SRC2(1) , r );         // a1*b1"
-  , "  " ++ base_prefix ++ "add( SRC1(0) , SRC1(1) , q );         // (a0+a1)"
-  , "  " ++ base_prefix ++ "add( SRC2(0) , SRC2(1) , tmp );       // (b0+b1)"
-  , "  " ++ base_prefix ++ "mul_inplace( q , tmp );               // (a0+a1)*(b0+b1)"
-  , "  " ++ base_prefix ++ "sub_inplace( q , p );"
-  , "  " ++ base_prefix ++ "sub_inplace( q , r );"
+  , "  " ++ base_prefix ++ "mul" ++ ct ++ "( SRC1(0) , SRC2(0) , p );         // a0*b0"
+  , "  " ++ base_prefix ++ "mul" ++ ct ++ "( SRC1(1) , SRC2(1) , r );         // a1*b1"
+  , "  " ++ base_prefix ++ "add" ++ ct ++ "( SRC1(0) , SRC1(1) , q );         // (a0+a1)"
+  , "  " ++ base_prefix ++ "add" ++ ct ++ "( SRC2(0) , SRC2(1) , tmp );       // (b0+b1)"
+  , "  " ++ base_prefix ++ "mul_inplace" ++ ct ++ "( q , tmp );               // (a0+a1)*(b0+b1)"
+  , "  " ++ base_prefix ++ "sub_inplace" ++ ct ++ "( q , p );"
+  , "  " ++ base_prefix ++ "sub_inplace" ++ ct ++ "( q , r );"
   ] ++
   withIrredCoeffs irredPoly termDeg0 ++
   withIrredCoeffs irredPoly termDeg1 ++ 
   [ "}"
   , ""
   , "// we use Karatsuba trick to have only 3 squarings"
-  , "void " ++ prefix ++ "sqr ( const uint64_t *src1, uint64_t *tgt ) {"
+  , "void " ++ prefix ++ "sqr" ++ ct ++ " ( const uint64_t *src1, uint64_t *tgt ) {"
   , "  uint64_t p[BASE_NWORDS];"
   , "  uint64_t q[BASE_NWORDS];"
   , "  uint64_t r[BASE_NWORDS];"
   , "  uint64_t tmp[BASE_NWORDS];"
-  , "  " ++ base_prefix ++ "sqr( SRC1(0) , p );              // a0^2"
-  , "  " ++ base_prefix ++ "sqr( SRC1(1) , r );              // a1^2"
-  , "  " ++ base_prefix ++ "add( SRC1(0) , SRC1(1) , q );    // (a0+a1)"
-  , "  " ++ base_prefix ++ "sqr_inplace( q );                // (a0+a1)^2"
-  , "  " ++ base_prefix ++ "sub_inplace( q , p );"
-  , "  " ++ base_prefix ++ "sub_inplace( q , r );"
+  , "  " ++ base_prefix ++ "sqr" ++ ct ++ "( SRC1(0) , p );              // a0^2"
+  , "  " ++ base_prefix ++ "sqr" ++ ct ++ "( SRC1(1) , r );              // a1^2"
+  , "  " ++ base_prefix ++ "add" ++ ct ++ "( SRC1(0) , SRC1(1) , q );    // (a0+a1)"
+  , "  " ++ base_prefix ++ "sqr_inplace" ++ ct ++ "( q );                // (a0+a1)^2"
+  , "  " ++ base_prefix ++ "sub_inplace" ++ ct ++ "( q , p );"
+  , "  " ++ base_prefix ++ "sub_inplace" ++ ct ++ "( q , r );"
   ] ++
   withIrredCoeffs irredPoly termDeg0 ++
   withIrredCoeffs irredPoly termDeg1 ++ 
@@ -491,22 +552,79 @@ c_mulExtQuadratic ExtParams{..} =
     
     termDeg0 [c,d]  
       | isZero     c  = [ "  " ++ base_prefix ++ "copy( p ,     TGT(0) );" ]
-      | isOne      c  = [ "  " ++ base_prefix ++ "sub(  p , r , TGT(0) );" ]
-      | isMinusOne c  = [ "  " ++ base_prefix ++ "add(  p , r , TGT(0) );" ]
-      | otherwise    =  [ "  " ++ base_prefix ++ "mul(  r , IRRED(0) , tmp );"
-                        , "  " ++ base_prefix ++ "sub(  p , tmp , TGT(0) );" 
+      | isOne      c  = [ "  " ++ base_prefix ++ "sub" ++ ct ++ "(  p , r , TGT(0) );" ]
+      | isMinusOne c  = [ "  " ++ base_prefix ++ "add" ++ ct ++ "(  p , r , TGT(0) );" ]
+      | otherwise    =  [ "  " ++ base_prefix ++ "mul" ++ ct ++ "(  r , IRRED(0) , tmp );"
+                        , "  " ++ base_prefix ++ "sub" ++ ct ++ "(  p , tmp , TGT(0) );" 
                         ]
 
     termDeg1 [c,d]
       | isZero     d  = [ "  " ++ base_prefix ++ "copy( q ,     TGT(1) );" ]
-      | isOne      d  = [ "  " ++ base_prefix ++ "sub(  q , r , TGT(1) );" ]
-      | isMinusOne d  = [ "  " ++ base_prefix ++ "add(  q , r , TGT(1) );" ]
-      | otherwise    =  [ "  " ++ base_prefix ++ "mul(  r , IRRED(1) , tmp );"
-                        , "  " ++ base_prefix ++ "sub(  q , tmp , TGT(1) );" 
+      | isOne      d  = [ "  " ++ base_prefix ++ "sub" ++ ct ++ "(  q , r , TGT(1) );" ]
+      | isMinusOne d  = [ "  " ++ base_prefix ++ "add" ++ ct ++ "(  q , r , TGT(1) );" ]
+      | otherwise    =  [ "  " ++ base_prefix ++ "mul" ++ ct ++ "(  r , IRRED(1) , tmp );"
+                        , "  " ++ base_prefix ++ "sub" ++ ct ++ "(  q , tmp , TGT(1) );" 
                         ]
 
 --------------------------------------------------------------------------------
 
+-- | Branch-free versions of the basic operations, using the branch-free
+-- operations of the prime field (see 'hasConstTimeExt')
+c_constTimeExt :: ExtParams -> Code
+c_constTimeExt extparams@(ExtParams{..})
+  | not (hasConstTimeExt extparams) = []
+  | otherwise =
+      [ "// branch-free versions of the basic operations (for the constant-time scalar multiplication)"
+      , ""
+      , "void " ++ prefix ++ "neg_ct ( const uint64_t *src1, uint64_t *tgt ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "neg_ct( SRC1(k) , TGT(k) );"
+      , "  }"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "add_ct( SRC1(k) , SRC2(k) , TGT(k) );"
+      , "  }"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "sub_ct( SRC1(k) , SRC2(k) , TGT(k) );"
+      , "  }"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "add_inplace_ct( TGT(k) , SRC2(k) );"
+      , "  }"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "sub_inplace_ct( TGT(k) , SRC2(k) );"
+      , "  }"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 ) {"
+      , "  for(int k=0; k<EXT_DEGREE; k++) {"
+      , "    " ++ base_prefix ++ "sub_inplace_reverse_ct( TGT(k) , SRC1(k) );"
+      , "  }"
+      , "}"
+      , ""
+      ] ++
+      c_mulExtQuadratic' "_ct" extparams ++
+      [ "void " ++ prefix ++ "mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {"
+      , "  " ++ prefix ++ "mul_ct( tgt, src2, tgt );"
+      , "}"
+      , ""
+      , "void " ++ prefix ++ "sqr_inplace_ct ( uint64_t *tgt ) {"
+      , "  " ++ prefix ++ "sqr_ct( tgt, tgt );"
+      , "}"
+      ]
+
+--------------------------------------------------------------------------------
+
 c_mulExtCubic :: ExtParams -> Code
 c_mulExtCubic ExtParams{..} =  
   [ "// we use Karatsuba trick to have only 6 multiplications"
@@ -843,10 +961,14 @@ c_frobenius_dense ExtParams{..} =
 ----------------------------------------
 
 frobeniusBasesSparse :: forall f. (Field f, SerializeMontgomery f, ExtField' f) => Proxy f -> ( [(Int,Int)] , [[Word64]] )
-frobeniusBasesSparse proxy = (indices, map toWordsMontgomery values) where
+frobeniusBasesSparse = frobeniusPowerBasesSparse 1
+
+-- | The sparse matrix of the @k@-th power of the Frobenius, @x -> x^(p^k)@
+frobeniusPowerBasesSparse :: forall f. (Field f, SerializeMontgomery f, ExtField' f) => Int -> Proxy f -> ( [(Int,Int)] , [[Word64]] )
+frobeniusPowerBasesSparse k proxy = (indices, map toWordsMontgomery values) where
   m  = primeDeg proxy
   bs = [ packPrimeBase (ei i) | i<-[0..m-1] ] :: [f]
-  ys = map frobenius bs :: [f]
+  ys = map (\b -> iterate frobenius b !! k) bs :: [f]
 
   ei :: Int -> [PrimeBase f]
   ei i = replicate i 0 ++ [1] ++ replicate (m-i-1) 0
@@ -888,6 +1010,153 @@ c_frobenius_sparse ExtParams{..} =
     (ijs,ws)   = case pureTypeProxy of
       AnyExtProxy proxy -> frobeniusBasesSparse proxy
 
+----------------------------------------
+
+-- | The powers of the Frobenius for which we precompute a separate sparse matrix
+frobeniusPowers :: ExtParams -> [Int]
+frobeniusPowers ExtParams{..} = [ k | k <- [2,3] , k < primeDegree ]
+
+c_frobenius_power :: Int -> ExtParams -> Code
+c_frobenius_power k ExtParams{..} = 
+  [ ""
+  , mkConstWordArray (prefix ++ "frobenius_" ++ show k ++ "_sparse_indices") [indices]
+  , "" 
+  , mkConstWordArray (prefix ++ "frobenius_" ++ show k ++ "_sparse_entries") ws
+  , "" 
+  , "// computes `x^(p^" ++ show k ++ ")` directly"
+  , "void " ++ prefix ++ "frobenius_" ++ show k ++ " ( const uint64_t *src, uint64_t *tgt ) {"
+  , "  uint64_t acc[EXT_NWORDS];"
+  , "  uint64_t tmp[PRIME_NWORDS];"
+  , "  " ++ prefix ++ "set_zero(acc);"
+  , "  for(int k=0; k<" ++ show nentries ++ "; k++) {"
+  , "    uint64_t ij = " ++ prefix ++ "frobenius_" ++ show k ++ "_sparse_indices[k];"
+  , "    uint64_t i  = (ij >> 16);"
+  , "    uint64_t j  = (ij &  0xffff);"
+  , "    " ++ prime_prefix ++ "mul( src + i*PRIME_NWORDS , " ++ prefix ++ "frobenius_" ++ show k ++ "_sparse_entries + k*PRIME_NWORDS , tmp );"
+  , "    " ++ prime_prefix ++ "add_inplace( acc + j*PRIME_NWORDS , tmp );"
+  , "  }"
+  , "  " ++ prefix ++ "copy( acc, tgt );"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "frobenius_" ++ show k ++ "_inplace ( uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "frobenius_" ++ show k ++ "( tgt, tgt );"
+  , "}"
+  ] 
+  where 
+    nentries = length ijs
+    indices  = [ fromIntegral (shiftL i 16 + j) | (i,j) <- ijs ] :: [Word64]
+    (ijs,ws)   = case pureTypeProxy of
+      AnyExtProxy proxy -> frobeniusPowerBasesSparse k proxy
+
+c_frobenius_k :: ExtParams -> Code
+c_frobenius_k extparams@(ExtParams{..}) = 
+  concat [ c_frobenius_power k extparams | k <- frobeniusPowers extparams ] ++
+  [ ""
+  , "// computes `x^(p^k)` for `k >= 0`"
+  , "void " ++ prefix ++ "frobenius_k ( const uint64_t *src, int k, uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "copy( src, tgt );"
+  , "  k = k % PRIME_DEGREE;"
+  ] ++
+  [ "  while (k >= " ++ show j ++ ") { " ++ prefix ++ "frobenius_" ++ show j ++ "_inplace( tgt ); k -= " ++ show j ++ "; }"
+  | j <- reverse (frobeniusPowers extparams)
+  ] ++
+  [ "  if    (k == 1) { " ++ prefix ++ "frobenius_inplace( tgt ); }"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+-- conjugation (quadratic extensions only)
+
+-- | Square roots using the \"complex method\": if @(c + d*u)^2 = a + b*u@, then
+--
+-- > c^2 - d^2 = a
+-- > 2*c*d     = b
+--
+-- and thus @c^2 = (a +- sqrt(a^2+b^2)) / 2@, where exactly one of the two
+-- signs gives a square (when @b /= 0@). This needs at most three square roots
+-- and one inversion in the base field.
+c_sqrtExt :: ExtParams -> Code
+c_sqrtExt extparams@(ExtParams{..}) 
+  | not (hasSqrtExt extparams) = []
+  | otherwise = 
+    [ "// checks whether the element is a square: (a + b*u) is a square"
+    , "// if and only if its norm (a^2 + b^2) is a square in the base field"
+    , "uint8_t " ++ prefix ++ "is_square( const uint64_t *src1 ) {"
+    , "  uint64_t norm[BASE_NWORDS];"
+    , "  uint64_t tmp [BASE_NWORDS];"
+    , "  " ++ base_prefix ++ "sqr( SRC1(0) , norm );"
+    , "  " ++ base_prefix ++ "sqr( SRC1(1) , tmp  );"
+    , "  " ++ base_prefix ++ "add_inplace( norm , tmp );"
+    , "  return " ++ base_prefix ++ "is_square( norm );"
+    , "}"
+    , ""
+    , "// computes a square root; returns 1 if it exists."
+    , "// If there is no square root, the result is set to zero and 0 is returned."
+    , "uint8_t " ++ prefix ++ "sqrt( const uint64_t *src1, uint64_t *tgt ) {"
+    , "  uint64_t s[BASE_NWORDS];"
+    , "  uint64_t c[BASE_NWORDS];"
+    , "  uint64_t d[BASE_NWORDS];"
+    , "  if (" ++ base_prefix ++ "is_zero( SRC1(1) )) {"
+    , "    // a + 0*u: the root is either sqrt(a) or sqrt(-a)*u (as -1 is not a square)"
+    , "    if (" ++ base_prefix ++ "sqrt( SRC1(0) , c )) {"
+    , "      " ++ base_prefix ++ "copy( c , TGT(0) );"
+    , "      " ++ base_prefix ++ "set_zero( TGT(1) );"
+    , "    }"
+    , "    else {"
+    , "      " ++ base_prefix ++ "neg( SRC1(0) , d );"
+    , "      " ++ base_prefix ++ "sqrt( d , TGT(1) );"
+    , "      " ++ base_prefix ++ "set_zero( TGT(0) );"
+    , "    }"
+    , "    return 1;"
+    , "  }"
+    , "  " ++ base_prefix ++ "sqr( SRC1(0) , s );"
+    , "  " ++ base_prefix ++ "sqr( SRC1(1) , d );"
+    , "  " ++ base_prefix ++ "add_inplace( s , d );               // a^2 + b^2"
+    , "  if (!" ++ base_prefix ++ "sqrt( s , s )) {"
+    , "    " ++ prefix ++ "set_zero( tgt );"
+    , "    return 0;"
+    , "  }"
+    , "  " ++ base_prefix ++ "add( SRC1(0) , s , d );"
+    , "  " ++ base_prefix ++ "div_by_2_inplace( d );              // (a + sqrt(a^2+b^2)) / 2"
+    , "  if (!" ++ base_prefix ++ "sqrt( d , c )) {"
+    , "    " ++ base_prefix ++ "sub( SRC1(0) , s , d );"
+    , "    " ++ base_prefix ++ "div_by_2_inplace( d );            // (a - sqrt(a^2+b^2)) / 2"
+    , "    " ++ base_prefix ++ "sqrt( d , c );"
+    , "  }"
+    , "  " ++ base_prefix ++ "add( c , c , d );"
+    , "  " ++ base_prefix ++ "inv_inplace( d );"
+    , "  " ++ base_prefix ++ "mul_inplace( d , SRC1(1) );         // d = b / (2*c)"
+    , "  " ++ base_prefix ++ "copy( c , TGT(0) );"
+    , "  " ++ base_prefix ++ "copy( d , TGT(1) );"
+    , "  return 1;"
+    , "}"
+    ]
+
+c_conjugate :: ExtParams -> Code
+c_conjugate ExtParams{..} = case extDegree of
+  2 -> 
+    [ "// the nontrivial automorphism over the base field: (a + b*u) -> (a - b*u)"
+    , "void " ++ prefix ++ "conjugate ( const uint64_t *src1, uint64_t *tgt ) {"
+    , "  " ++ base_prefix ++ "copy( SRC1(0) , TGT(0) );"
+    , "  " ++ base_prefix ++ "neg ( SRC1(1) , TGT(1) );"
+    , "}"
+    , ""
+    , "void " ++ prefix ++ "conjugate_inplace ( uint64_t *tgt ) {"
+    , "  " ++ base_prefix ++ "neg_inplace( TGT(1) );"
+    , "}"
+    , ""
+    , "// inversion of elements with norm 1 over the base field (for example"
+    , "// the cyclotomic subgroup), where the inverse is just the conjugate"
+    , "void " ++ prefix ++ "cyclotomic_inv ( const uint64_t *src1, uint64_t *tgt ) {"
+    , "  " ++ prefix ++ "conjugate( src1, tgt );"
+    , "}"
+    , ""
+    , "void " ++ prefix ++ "cyclotomic_inv_inplace ( uint64_t *tgt ) {"
+    , "  " ++ prefix ++ "conjugate_inplace( tgt );"
+    , "}"
+    ]
+  _ -> []
+
 --------------------------------------------------------------------------------
 
 hsBegin :: ExtParams -> Code
@@ -918,7 +1187,14 @@ hsBegin extparams@(ExtParams{..}) =
   , "    -- * Relation to the base and prime fields"
   , "  , embedBase" ++ postfix ++ " , embedPrime" ++ postfix 
   , "  , scaleBase" ++ postfix ++ " , scalePrime" ++ postfix 
-  , "    -- * Frobenius automorphism"
+  ] ++
+  (if hasSqrtExt extparams 
+    then [ "    -- * Square roots"
+         , "  , isSquare , squareRoot"
+         ]
+    else []
+  ) ++
+  [ "    -- * Frobenius automorphism"
   , "  , frob"
   , "    -- * Random"
   , "  , rnd"
@@ -1014,7 +1290,18 @@ hsBegin extparams@(ExtParams{..}) =
   , "instance M.Rnd " ++ typeName ++ " where"
   , "  rndIO = rnd"
   , ""
-  , "instance C.Ring " ++ typeName ++ " where"
+  ] ++
+  (if hasSqrtExt extparams 
+    then [ "-- | The square root of a field element, if it exists"
+         , "squareRoot :: " ++ typeName ++ " -> Maybe " ++ typeName
+         , "squareRoot x = case sqrt_ x of"
+         , "  (y,True) -> Just y"
+         , "  _        -> Nothing"
+         , ""
+         ]
+    else []
+  ) ++
+  [ "instance C.Ring " ++ typeName ++ " where"
   , "  ringNamePxy _ = \"" ++ extFieldName  ++ "\""
   , "  ringSizePxy _ = C.ringSizePxy (Proxy @" ++ typeNameBase ++ ") ^ " ++ show extDegree
   , "  isZero = " ++ hsModule hs_path ++ ".isZero"
@@ -1296,7 +1583,13 @@ hsFFI extparams@(ExtParams{..}) = catCode $
   , mkffi "pow_"        $ cfun "pow_uint64"       (CTyp [CArgInPtr , CArg64    , CArgOutPtr ] CRetVoid)
     --
   , mkffi "frob"        $ cfun "frobenius"        (CTyp [CArgInPtr             , CArgOutPtr ] CRetVoid)
-  ]
+  ] ++
+  (if hasSqrtExt extparams
+    then [ mkffi "isSquare" $ cfun "is_square" (CTyp [CArgInPtr             ] CRetBool)
+         , mkffi "sqrt_"    $ cfun "sqrt"      (CTyp [CArgInPtr , CArgOutPtr] CRetBool)
+         ]
+    else []
+  )
   where
     cfun  cname = CFun (prefix ++ cname)
     mkffi = ffiCall hsTyDesc
@@ -1319,6 +1612,10 @@ c_code extparams = concat $ map ("":)
   , c_invExt           extparams
   , c_divExt           extparams
   , c_frobenius_sparse extparams
+  , c_frobenius_k      extparams
+  , c_conjugate        extparams
+  , c_sqrtExt          extparams
+  , c_constTimeExt     extparams
     --
   , exponentiation (toCommonParams extparams)
   , batchInverse   (toCommonParams extparams)
@@ -6,6 +6,13 @@ module Zikkurat.CodeGen.FieldCommon where
 
 --------------------------------------------------------------------------------
 
+import Data.List
+import Data.Bits
+
+import Zikkurat.CodeGen.Misc ( partitionIntoChunks )
+
+--------------------------------------------------------------------------------
+
 data CommonParams = CommonParams 
   { prefix     :: String
   , nlimbs     :: Int
@@ -17,38 +24,155 @@ data CommonParams = CommonParams
 --------------------------------------------------------------------------------
 -- * exponentiation
 
+-- | The sliding window size used for an exponent of the given bit length
+-- (this must agree with the generated C function @pow_window_size@)
+powWindowSize :: Int -> Int
+powWindowSize nbits
+  | nbits <=  16  = 1
+  | nbits <=  64  = 3
+  | nbits <= 240  = 4
+  | otherwise     = 5
+
 exponentiation :: CommonParams  -> [String]
 exponentiation CommonParams {..} = 
-  [ "// computes `x^e mod p`"
-  , "void " ++ prefix ++ "pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {"
-  , "  uint64_t e = exponent;"
-  , "  uint64_t sqr[" ++ show nlimbs ++ "];" 
-  , "  " ++ prefix ++ "copy( src, sqr );                 // sqr := src"
-  , "  " ++ prefix ++ "set_one( tgt );                   // tgt := 1"
-  , "  while(e!=0) {"
-  , "    if (e & 1) { " ++ prefix ++ "mul_inplace(tgt, sqr); }"
-  , "    " ++ prefix ++ "mul_inplace(sqr, sqr);"
-  , "    e = e >> 1;"
+  [ "// the sliding window size used for exponents of the given bit length"
+  , "int " ++ prefix ++ "pow_window_size( int nbits ) {"
+  , "  if (nbits <=  16) return 1;"
+  , "  if (nbits <=  64) return 3;"
+  , "  if (nbits <= 240) return 4;"
+  , "  return 5;"
+  , "}"
+  , ""
+  , "// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)"
+  , "void " ++ prefix ++ "pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {"
+  , "  uint64_t x2[" ++ show nlimbs ++ "];"
+  , "  " ++ prefix ++ "copy( src, table );"
+  , "  if (w > 1) {"
+  , "    " ++ prefix ++ "sqr( src, x2 );"
+  , "    for(int k=1; k<(1<<(w-1)); k++) {"
+  , "      " ++ prefix ++ "mul( table + (k-1)*" ++ show nlimbs ++ ", x2, table + k*" ++ show nlimbs ++ " );"
+  , "    }"
   , "  }"
   , "}"
   , ""
-  , "// computes `x^e mod p` (for `e` non-negative bigint)"
+  , "#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)"
+  , ""
+  , "// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right"
+  , "// sliding windows over the bits of the exponent, with precomputed odd powers"
   , "void " ++ prefix ++ "pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {"
-  , "  uint64_t sqr[" ++ show nlimbs ++ "];"
-  , "  " ++ prefix ++ "copy( src, sqr );                 // sqr := src"
-  , "  " ++ prefix ++ "set_one( tgt );                   // tgt := 1"
-  , "  int s = expo_len - 1;"
-  , "  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers"
-  , "  for(int i=0; i<=s; i++) {"
-  , "    uint64_t e = expo[i];"
-  , "    for(int j=0; j<64; j++) {"
-  , "      if (e & 1) { " ++ prefix ++ "mul_inplace(tgt, sqr); }"
-  , "      " ++ prefix ++ "mul_inplace(sqr, sqr);"
-  , "      e = e >> 1;"
+  , "  int nbits = 64*expo_len;"
+  , "  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits"
+  , "  if (nbits == 0) {"
+  , "    " ++ prefix ++ "set_one( tgt );"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  int w = " ++ prefix ++ "pow_window_size( nbits );"
+  , "  uint64_t table[" ++ show (16*nlimbs) ++ "];"
+  , "  uint64_t acc[" ++ show nlimbs ++ "];"
+  , "  " ++ prefix ++ "pow_odd_powers( src, w, table );"
+  , ""
+  , "  int first = 1;"
+  , "  int i = nbits - 1;"
+  , "  while (i >= 0) {"
+  , "    if (!EXPO_BIT(i)) {"
+  , "      " ++ prefix ++ "sqr_inplace( acc );"
+  , "      i--;"
+  , "      continue;"
+  , "    }"
+  , "    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit"
+  , "    int j = (i >= w-1) ? (i-w+1) : 0;"
+  , "    while (!EXPO_BIT(j)) { j++; }"
+  , "    int d = 0;"
+  , "    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }"
+  , "    if (first) {"
+  , "      " ++ prefix ++ "copy( table + (d>>1)*" ++ show nlimbs ++ ", acc );"
+  , "      first = 0;"
   , "    }"
+  , "    else {"
+  , "      for(int k=i; k>=j; k--) { " ++ prefix ++ "sqr_inplace( acc ); }"
+  , "      " ++ prefix ++ "mul_inplace( acc, table + (d>>1)*" ++ show nlimbs ++ " );"
+  , "    }"
+  , "    i = j - 1;"
+  , "  }"
+  , "  " ++ prefix ++ "copy( acc, tgt );"
+  , "}"
+  , ""
+  , "#undef EXPO_BIT"
+  , ""
+  , "// computes `x^e mod p`"
+  , "void " ++ prefix ++ "pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "pow_gen( src, &exponent, tgt, 1 );"
+  , "}"
+  , ""
+  , "// computes `x^e` for a fixed exponent, given as a precomputed addition chain of"
+  , "// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`."
+  , "// The first step initializes the result, and the digit 0 means no multiplication."
+  , "// Note: the sequence of operations only depends on the (fixed) exponent."
+  , "void " ++ prefix ++ "pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {"
+  , "  uint64_t table[" ++ show (16*nlimbs) ++ "];"
+  , "  uint64_t acc[" ++ show nlimbs ++ "];"
+  , "  " ++ prefix ++ "pow_odd_powers( src, w, table );"
+  , "  " ++ prefix ++ "copy( table + (chain[1]>>1)*" ++ show nlimbs ++ ", acc );"
+  , "  for(int s=1; s<nsteps; s++) {"
+  , "    for(int k=0; k<chain[2*s]; k++) { " ++ prefix ++ "sqr_inplace( acc ); }"
+  , "    if (chain[2*s+1]) { " ++ prefix ++ "mul_inplace( acc, table + (chain[2*s+1]>>1)*" ++ show nlimbs ++ " ); }"
   , "  }"
+  , "  " ++ prefix ++ "copy( acc, tgt );"
+  , "}"
+  ]
+
+-- | Sliding window decomposition of a positive exponent, starting from the most
+-- significant bit: a list of (number of squarings, odd digit) steps, where the
+-- digit 0 means no multiplication. The first step initializes the accumulator.
+-- This is the input format of the generated C function @pow_chain@.
+slidingWindowChain :: Int -> Integer -> [(Int,Int)]
+slidingWindowChain w e = concatMap splitLong $ start $ go 0 bits where
+
+  bits = reverse (toBits e)
+  toBits 0 = []
+  toBits k = fromInteger (k .&. 1) : toBits (shiftR k 1)
+
+  go :: Int -> [Int] -> [(Int,Int)]
+  go sq []        = if sq > 0 then [(sq,0)] else []
+  go sq (0:rest)  = go (sq+1) rest
+  go sq bs        = (sq + len, digit) : go 0 (drop len bs) where
+    win   = dropWhileEnd (==0) (take w bs)
+    len   = length win
+    digit = foldl (\acc b -> 2*acc + b) 0 win
+
+  start ((_,d):rest) = (0,d) : rest
+  start []           = error "slidingWindowChain: zero exponent"
+
+  -- the squaring counts are stored in bytes
+  splitLong (n,d) = if n > 255 then (255,0) : splitLong (n-255,d) else [(n,d)]
+
+-- | Generates a function @pow_<name>@ computing @x^e@ for a fixed exponent @e@,
+-- using a precomputed addition chain
+mkPowChain :: CommonParams -> String -> String -> Integer -> [String]
+mkPowChain CommonParams{..} name descr e = 
+  [ "// addition chain for the exponent " ++ descr ++ ","
+  , "// as (number of squarings, odd digit) steps"
+  , "const uint8_t " ++ prefix ++ "chain_" ++ name ++ "[" ++ show (2*nsteps) ++ "] = "
+  ] ++ 
+  [ "  " ++ (if k == 0 then "{ " else ", ") ++ intercalate ", " [ show n ++ "," ++ show d | (n,d) <- grp ]
+  | (k,grp) <- zip [0..] (partitionIntoChunks 16 chain)
+  ] ++
+  [ "  };"
+  , ""
+  , "// computes `x^e` for the fixed exponent " ++ descr
+  , "void " ++ prefix ++ "pow_" ++ name ++ "( const uint64_t *src, uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "pow_chain( src, " ++ show w ++ ", " ++ show nsteps ++ ", " ++ prefix ++ "chain_" ++ name ++ ", tgt );"
   , "}"
   ]
+  where
+    w      = powWindowSize (length (takeWhile (>0) (iterate (`shiftR` 1) e)))
+    chain  = slidingWindowChain w e
+    nsteps = length chain
+
+-- | number of 64-bit limbs of a bigint type like @"BigInt256"@
+bigintTypeNLimbs :: String -> Int
+bigintTypeNLimbs ty = div (read (drop 6 ty)) 64
 
 --------------------------------------------------------------------------------
 
@@ -129,7 +253,7 @@ ffi_exponentiation (CommonParams{..}) =
   , "  withForeignPtr fptr1 $ \\ptr1 -> do"
   , "    withForeignPtr fptr2 $ \\ptr2 -> do"
   , "      withForeignPtr fptr3 $ \\ptr3 -> do"
-  , "        c_" ++ prefix ++ "pow_gen ptr1 ptr2 ptr3 " ++ show (nlimbs)
+  , "        c_" ++ prefix ++ "pow_gen ptr1 ptr2 ptr3 " ++ show (bigintTypeNLimbs bigintType)
   , "  return (Mk" ++ typeName ++ " fptr3)"
   , ""
   ]
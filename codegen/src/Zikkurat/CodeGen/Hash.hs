@@ -0,0 +1,221 @@
+-- | SHA-256 and the @expand_message_xmd@ function of RFC 9380 (hashing to
+-- elliptic curves). These do not depend on the curve, so they are generated
+-- only once, together with the platform-specific code.
+
+module Zikkurat.CodeGen.Hash where
+
+--------------------------------------------------------------------------------
+
+import Zikkurat.CodeGen.Misc
+
+--------------------------------------------------------------------------------
+
+sha256_header :: Code
+sha256_header =
+  [ ""
+  , "// === SHA-256 and expand_message_xmd (RFC 9380) ==="
+  , ""
+  , "#include <stdint.h>"
+  , ""
+  , "typedef struct {"
+  , "  uint32_t state[8];"
+  , "  uint64_t nbytes;           // total number of bytes processed"
+  , "  uint8_t  block[64];        // the partial block"
+  , "  int      block_len;"
+  , "} sha256_ctx_t;"
+  , ""
+  , "extern void sha256_init  ( sha256_ctx_t *ctx );"
+  , "extern void sha256_update( sha256_ctx_t *ctx, const uint8_t *msg, int len );"
+  , "extern void sha256_final ( sha256_ctx_t *ctx, uint8_t *digest );"
+  , ""
+  , "extern void sha256( const uint8_t *msg, int len, uint8_t *digest );"
+  , ""
+  , "extern uint8_t expand_message_xmd_sha256"
+  , "  ( const uint8_t *dst, int dst_len"
+  , "  , const uint8_t *msg, int msg_len"
+  , "  , int len_in_bytes, uint8_t *tgt );"
+  ]
+
+--------------------------------------------------------------------------------
+
+sha256_c :: Code
+sha256_c =
+  [ ""
+  , "#include <string.h>"
+  , "#include <stdint.h>"
+  , ""
+  , "#include \"sha256.h\""
+  , ""
+  , "//------------------------------------------------------------------------------"
+  , "// SHA-256 (FIPS 180-4)"
+  , ""
+  , "const uint32_t sha256_round_consts[64] = "
+  , "  { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5"
+  , "  , 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174"
+  , "  , 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da"
+  , "  , 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967"
+  , "  , 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85"
+  , "  , 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070"
+  , "  , 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3"
+  , "  , 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2"
+  , "  };"
+  , ""
+  , "const uint32_t sha256_initial_state[8] = "
+  , "  { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };"
+  , ""
+  , "#define ROTR32(x,k) ( ((x) >> (k)) | ((x) << (32-(k))) )"
+  , ""
+  , "// processes a single 64 byte block"
+  , "void sha256_compress( uint32_t *state, const uint8_t *block ) {"
+  , "  uint32_t w[64];"
+  , "  for(int i=0; i<16; i++) {"
+  , "    w[i] = ( ((uint32_t)block[4*i  ]) << 24 ) | ( ((uint32_t)block[4*i+1]) << 16 ) |"
+  , "           ( ((uint32_t)block[4*i+2]) <<  8 ) | ( ((uint32_t)block[4*i+3])       ) ;"
+  , "  }"
+  , "  for(int i=16; i<64; i++) {"
+  , "    uint32_t s0 = ROTR32(w[i-15], 7) ^ ROTR32(w[i-15],18) ^ (w[i-15] >>  3);"
+  , "    uint32_t s1 = ROTR32(w[i- 2],17) ^ ROTR32(w[i- 2],19) ^ (w[i- 2] >> 10);"
+  , "    w[i] = w[i-16] + s0 + w[i-7] + s1;"
+  , "  }"
+  , "  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];"
+  , "  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];"
+  , "  for(int i=0; i<64; i++) {"
+  , "    uint32_t S1  = ROTR32(e,6) ^ ROTR32(e,11) ^ ROTR32(e,25);"
+  , "    uint32_t ch  = (e & f) ^ ((~e) & g);"
+  , "    uint32_t t1  = h + S1 + ch + sha256_round_consts[i] + w[i];"
+  , "    uint32_t S0  = ROTR32(a,2) ^ ROTR32(a,13) ^ ROTR32(a,22);"
+  , "    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);"
+  , "    uint32_t t2  = S0 + maj;"
+  , "    h = g; g = f; f = e; e = d + t1;"
+  , "    d = c; c = b; b = a; a = t1 + t2;"
+  , "  }"
+  , "  state[0] += a; state[1] += b; state[2] += c; state[3] += d;"
+  , "  state[4] += e; state[5] += f; state[6] += g; state[7] += h;"
+  , "}"
+  , ""
+  , "void sha256_init( sha256_ctx_t *ctx ) {"
+  , "  memcpy( ctx->state, sha256_initial_state, 32 );"
+  , "  ctx->nbytes    = 0;"
+  , "  ctx->block_len = 0;"
+  , "}"
+  , ""
+  , "void sha256_update( sha256_ctx_t *ctx, const uint8_t *msg, int len ) {"
+  , "  ctx->nbytes += len;"
+  , "  if (ctx->block_len > 0) {"
+  , "    int k = 64 - ctx->block_len;"
+  , "    if (len < k) {"
+  , "      memcpy( ctx->block + ctx->block_len, msg, len );"
+  , "      ctx->block_len += len;"
+  , "      return;"
+  , "    }"
+  , "    memcpy( ctx->block + ctx->block_len, msg, k );"
+  , "    sha256_compress( ctx->state, ctx->block );"
+  , "    ctx->block_len = 0;"
+  , "    msg += k;"
+  , "    len -= k;"
+  , "  }"
+  , "  while (len >= 64) {"
+  , "    sha256_compress( ctx->state, msg );"
+  , "    msg += 64;"
+  , "    len -= 64;"
+  , "  }"
+  , "  memcpy( ctx->block, msg, len );"
+  , "  ctx->block_len = len;"
+  , "}"
+  , ""
+  , "// writes the 32 byte digest"
+  , "void sha256_final( sha256_ctx_t *ctx, uint8_t *digest ) {"
+  , "  uint64_t nbits = 8 * ctx->nbytes;"
+  , "  int k = ctx->block_len;"
+  , "  ctx->block[k++] = 0x80;"
+  , "  if (k > 56) {"
+  , "    memset( ctx->block + k, 0, 64 - k );"
+  , "    sha256_compress( ctx->state, ctx->block );"
+  , "    k = 0;"
+  , "  }"
+  , "  memset( ctx->block + k, 0, 56 - k );"
+  , "  for(int i=0; i<8; i++) { ctx->block[56+i] = (uint8_t)(nbits >> (56-8*i)); }"
+  , "  sha256_compress( ctx->state, ctx->block );"
+  , "  for(int i=0; i<8; i++) {"
+  , "    uint32_t x = ctx->state[i];"
+  , "    digest[4*i  ] = (uint8_t)(x >> 24);"
+  , "    digest[4*i+1] = (uint8_t)(x >> 16);"
+  , "    digest[4*i+2] = (uint8_t)(x >>  8);"
+  , "    digest[4*i+3] = (uint8_t)(x      );"
+  , "  }"
+  , "}"
+  , ""
+  , "void sha256( const uint8_t *msg, int len, uint8_t *digest ) {"
+  , "  sha256_ctx_t ctx;"
+  , "  sha256_init  ( &ctx );"
+  , "  sha256_update( &ctx, msg, len );"
+  , "  sha256_final ( &ctx, digest );"
+  , "}"
+  , ""
+  , "//------------------------------------------------------------------------------"
+  , "// expand_message_xmd from RFC 9380, section 5.3.1, instantiated with SHA-256"
+  , "//"
+  , "//   b_0 = H( Z_pad || msg || I2OSP(len_in_bytes,2) || I2OSP(0,1) || DST_prime )"
+  , "//   b_1 = H( b_0 || I2OSP(1,1) || DST_prime )"
+  , "//   b_i = H( (b_0 xor b_(i-1)) || I2OSP(i,1) || DST_prime )"
+  , "//"
+  , "// where DST_prime = DST || I2OSP(len(DST),1). Domain separation tags longer"
+  , "// than 255 bytes are replaced by H(\"H2C-OVERSIZE-DST-\" || DST) (section 5.3.3)."
+  , "// Returns 1 on success and 0 if len_in_bytes is too big."
+  , ""
+  , "uint8_t expand_message_xmd_sha256"
+  , "  ( const uint8_t *dst, int dst_len"
+  , "  , const uint8_t *msg, int msg_len"
+  , "  , int len_in_bytes, uint8_t *tgt ) {"
+  , ""
+  , "  int ell = (len_in_bytes + 31) / 32;"
+  , "  if ( (ell > 255) || (len_in_bytes > 65535) || (len_in_bytes < 0) ) return 0;"
+  , ""
+  , "  uint8_t dst_prime[256];"
+  , "  if (dst_len > 255) {"
+  , "    sha256_ctx_t ctx;"
+  , "    sha256_init  ( &ctx );"
+  , "    sha256_update( &ctx, (const uint8_t*)\"H2C-OVERSIZE-DST-\", 17 );"
+  , "    sha256_update( &ctx, dst, dst_len );"
+  , "    sha256_final ( &ctx, dst_prime );"
+  , "    dst_len = 32;"
+  , "  }"
+  , "  else {"
+  , "    memcpy( dst_prime, dst, dst_len );"
+  , "  }"
+  , "  dst_prime[dst_len] = (uint8_t)dst_len;"
+  , ""
+  , "  uint8_t z_pad[64];"
+  , "  uint8_t b0[32];"
+  , "  uint8_t bi[33];"
+  , "  uint8_t lib_str[3];"
+  , "  memset( z_pad, 0, 64 );"
+  , "  lib_str[0] = (uint8_t)(len_in_bytes >> 8);"
+  , "  lib_str[1] = (uint8_t)(len_in_bytes     );"
+  , "  lib_str[2] = 0;"
+  , ""
+  , "  sha256_ctx_t ctx;"
+  , "  sha256_init  ( &ctx );"
+  , "  sha256_update( &ctx, z_pad, 64 );"
+  , "  sha256_update( &ctx, msg, msg_len );"
+  , "  sha256_update( &ctx, lib_str, 3 );"
+  , "  sha256_update( &ctx, dst_prime, dst_len+1 );"
+  , "  sha256_final ( &ctx, b0 );"
+  , ""
+  , "  memcpy( bi, b0, 32 );"
+  , "  for(int i=1; i<=ell; i++) {"
+  , "    // bi contains (b_0 xor b_(i-1)), or b_0 when i=1"
+  , "    bi[32] = (uint8_t)i;"
+  , "    sha256_init  ( &ctx );"
+  , "    sha256_update( &ctx, bi, 33 );"
+  , "    sha256_update( &ctx, dst_prime, dst_len+1 );"
+  , "    sha256_final ( &ctx, bi );"
+  , "    int k = len_in_bytes - 32*(i-1);"
+  , "    memcpy( tgt + 32*(i-1), bi, (k < 32) ? k : 32 );"
+  , "    for(int j=0; j<32; j++) { bi[j] ^= b0[j]; }"
+  , "  }"
+  , "  return 1;"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
@@ -22,18 +22,18 @@ add_with_carry_header =
   , ""
   , "#include <x86intrin.h>"
   , ""
-  , "inline uint8_t addcarry_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
-  , "  return _addcarry_u64( carry, arg1, arg2, *tgt );"
+  , "static inline uint8_t addcarry_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
+  , "  return _addcarry_u64( carry, arg1, arg2, (unsigned long long*)tgt );"
   , "}"
   , ""
-  , "inline uint8_t subborrow_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
-  , "  return _subborrow_u64( carry, arg1, arg2, *tgt );"
+  , "static inline uint8_t subborrow_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
+  , "  return _subborrow_u64( carry, arg1, arg2, (unsigned long long*)tgt );"
   , "}"
   , ""
-  , "inline uint8_t addcarry_u128_inplace(  uint64_t *tgt_lo, uint64_t *tgt_hi, uint64_t arg_lo, uint64_t arg_hi) {"
+  , "static inline uint8_t addcarry_u128_inplace(  uint64_t *tgt_lo, uint64_t *tgt_hi, uint64_t arg_lo, uint64_t arg_hi) {"
   , "  uint8_t c;"
-  , "  c = _addcarry_u64( 0, *tgt_lo, arg_lo, tgt_lo );"
-  , "  c = _addcarry_u64( c, *tgt_hi, arg_hi, tgt_hi );"
+  , "  c = _addcarry_u64( 0, *tgt_lo, arg_lo, (unsigned long long*)tgt_lo );"
+  , "  c = _addcarry_u64( c, *tgt_hi, arg_hi, (unsigned long long*)tgt_hi );"
   , "  return c;"
   , "}"
   , ""
@@ -41,29 +41,27 @@ add_with_carry_header =
   , ""
   , "// ------ portable implementation for generic 64-bit architectures ------"
   , ""
-  , "inline uint8_t addcarry_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
+  , "static inline uint8_t addcarry_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
   , "  uint64_t u;"
   , "  u = arg1 + arg2 + carry;"
   , "  *tgt = u;"
-  , "  return ( (carry) ? (u <= arg1) : (u < arg1) );"
+  , "  return (u < arg1) | ((u == arg1) & carry);       // branch-free"
   , "}"
   , ""
-  , "inline uint8_t subborrow_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
+  , "static inline uint8_t subborrow_u64( uint8_t carry, uint64_t arg1, uint64_t arg2, uint64_t *tgt ) {"
   , "  uint64_t u;"
   , "  u = arg1 - arg2 - carry;"
   , "  *tgt = u;"
-  , "  return ( (carry) ? (u >= arg1) : (u > arg1) );"
+  , "  return (u > arg1) | ((u == arg1) & carry);       // branch-free"
   , "}"
   , ""
-  , "inline uint8_t addcarry_u128_inplace( uint64_t *tgt_lo, uint64_t *tgt_hi, uint64_t arg_lo, uint64_t arg_hi) {"
+  , "static inline uint8_t addcarry_u128_inplace( uint64_t *tgt_lo, uint64_t *tgt_hi, uint64_t arg_lo, uint64_t arg_hi) {"
   , "  uint8_t  c;"
-  , "  uint64_t u,v;"
+  , "  uint64_t u;"
   , "  u = tgt_lo[0] + arg_lo;"
-  , "  c = (u < arg_lo) ? 1 : 0; "
-  , "  c = addcarry_u64( c, tgt_hi[0], arg_hi, tgt_hi );"
+  , "  c = (u < arg_lo);"
   , "  *tgt_lo = u;"
-  , "  *tgt_hi = v;"
-  , "  return c;"
+  , "  return addcarry_u64( c, tgt_hi[0], arg_hi, tgt_hi );"
   , "}"
   , ""
   , "#endif"
@@ -90,6 +88,146 @@ add_with_carry_wrapper =
 
 --------------------------------------------------------------------------------
 
+parallel_header :: Code
+parallel_header = 
+  [ ""
+  , "// === simple multithreading support ==="
+  , "//"
+  , "// If `NO_THREADS` is defined (or on Windows), everything runs on the calling thread."
+  , ""
+  , "extern int  parallel_get_num_threads();"
+  , "extern void parallel_set_num_threads( int n );"
+  , ""
+  , "// runs `task(ctx,i)` for all `0 <= i < ntasks`, distributed among the threads."
+  , "// There is no persistent thread pool: each call creates (at most) `T-1` new threads,"
+  , "// where `T = parallel_get_num_threads()`, and joins them before returning, so this"
+  , "// is only worth it for coarse-grained work."
+  , "extern void parallel_for( int ntasks, void (*task)(void *ctx, int i), void *ctx );"
+  , ""
+  , "// runs `init()` if `*done` is not yet set, then sets it; the calls are serialized,"
+  , "// so this can be used to lazily initialize (static) tables from several threads"
+  , "extern void parallel_call_once( int *done, void (*init)() );"
+  ]
+
+parallel_c :: Code
+parallel_c = 
+  [ ""
+  , "// === simple multithreading support ==="
+  , ""
+  , "#include <stdlib.h>"
+  , "#include <assert.h>"
+  , ""
+  , "#include \"parallel.h\""
+  , ""
+  , "#if defined(_WIN32) && !defined(NO_THREADS)"
+  , "#define NO_THREADS"
+  , "#endif"
+  , ""
+  , "#ifndef NO_THREADS"
+  , "#include <pthread.h>"
+  , "#include <unistd.h>"
+  , "#endif"
+  , ""
+  , "#define MAX_THREADS 256"
+  , ""
+  , "// 0 means \"not yet initialized\". This can be accessed from several (Haskell)"
+  , "// threads at the same time, so all accesses are atomic"
+  , "int parallel_num_threads = 0;"
+  , ""
+  , "int parallel_get_num_threads() {"
+  , "#ifdef NO_THREADS"
+  , "  return 1;"
+  , "#else"
+  , "  int n = __atomic_load_n( &parallel_num_threads, __ATOMIC_RELAXED );"
+  , "  if (n <= 0) {"
+  , "    long m = sysconf( _SC_NPROCESSORS_ONLN );"
+  , "    n = (m < 1) ? 1 : ( (m > MAX_THREADS) ? MAX_THREADS : (int)m );"
+  , "    // only replaces the uninitialized value, so a concurrent `parallel_set_num_threads` wins"
+  , "    int expected = 0;"
+  , "    __atomic_compare_exchange_n( &parallel_num_threads, &expected, n, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED );"
+  , "  }"
+  , "  return n;"
+  , "#endif"
+  , "}"
+  , ""
+  , "// setting it to 0 resets to the default (the number of CPU cores)"
+  , "void parallel_set_num_threads( int n ) {"
+  , "  int m = (n > MAX_THREADS) ? MAX_THREADS : ( (n < 0) ? 0 : n );"
+  , "  __atomic_store_n( &parallel_num_threads, m, __ATOMIC_RELAXED );"
+  , "}"
+  , ""
+  , "#ifndef NO_THREADS"
+  , ""
+  , "typedef struct {"
+  , "  int   ntasks;"
+  , "  int   nthreads;"
+  , "  int   thread_idx;"
+  , "  void *ctx;"
+  , "  void (*task)(void *ctx, int i);"
+  , "} parallel_worker_t;"
+  , ""
+  , "// the worker `t` runs the tasks `t, t+T, t+2T, ...`"
+  , "void *parallel_worker( void *arg ) {"
+  , "  parallel_worker_t *w = (parallel_worker_t*) arg;"
+  , "  for(int i=w->thread_idx; i<w->ntasks; i+=w->nthreads) {"
+  , "    (w->task)( w->ctx, i );"
+  , "  }"
+  , "  return 0;"
+  , "}"
+  , ""
+  , "#endif"
+  , ""
+  , "void parallel_for( int ntasks, void (*task)(void *ctx, int i), void *ctx ) {"
+  , "  int T = parallel_get_num_threads();"
+  , "  if (T > ntasks) { T = ntasks; }"
+  , "  if (T <= 1) {"
+  , "    for(int i=0; i<ntasks; i++) { task( ctx, i ); }"
+  , "    return;"
+  , "  }"
+  , "#ifndef NO_THREADS"
+  , "  pthread_t         threads[MAX_THREADS];"
+  , "  parallel_worker_t workers[MAX_THREADS];"
+  , "  for(int t=0; t<T; t++) {"
+  , "    workers[t].ntasks     = ntasks;"
+  , "    workers[t].nthreads   = T;"
+  , "    workers[t].thread_idx = t;"
+  , "    workers[t].ctx        = ctx;"
+  , "    workers[t].task       = task;"
+  , "  }"
+  , "  // the calling thread is worker 0"
+  , "  int spawned = 1;"
+  , "  for(int t=1; t<T; t++) {"
+  , "    if (pthread_create( &threads[t], 0, parallel_worker, &workers[t] ) != 0) break;"
+  , "    spawned++;"
+  , "  }"
+  , "  // if we could not create enough threads, the remaining tasks run here"
+  , "  for(int t=spawned; t<T; t++) { parallel_worker( &workers[t] ); }"
+  , "  parallel_worker( &workers[0] );"
+  , "  for(int t=1; t<spawned; t++) { pthread_join( threads[t], 0 ); }"
+  , "#endif"
+  , "}"
+  , ""
+  , "#ifndef NO_THREADS"
+  , "pthread_mutex_t parallel_once_mutex = PTHREAD_MUTEX_INITIALIZER;"
+  , "#endif"
+  , ""
+  , "void parallel_call_once( int *done, void (*init)() ) {"
+  , "  if (__atomic_load_n( done, __ATOMIC_ACQUIRE )) return;"
+  , "#ifndef NO_THREADS"
+  , "  pthread_mutex_lock( &parallel_once_mutex );"
+  , "#endif"
+  , "  if (!*done) {"
+  , "    init();"
+  , "    __atomic_store_n( done, 1, __ATOMIC_RELEASE );"
+  , "  }"
+  , "#ifndef NO_THREADS"
+  , "  pthread_mutex_unlock( &parallel_once_mutex );"
+  , "#endif"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
 hsAddCarry :: Code
 hsAddCarry =
   [ "-- | Wrappers around platform-specific code"
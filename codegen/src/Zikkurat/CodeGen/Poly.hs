@@ -26,9 +26,12 @@ data PolyParams = PolyParams
   , c_path_r    :: Path         -- ^ path of the C module for the field (without extension)
   , hs_path     :: Path         -- ^ path of the Haskell module (without extension) 
   , hs_path_r   :: Path         -- ^ path of the Haskell module for the field (without extension)
+  , hs_path_arr :: Path         -- ^ path of the Haskell module for arrays of field elements (without extension)
+  , hs_path_lag :: Path         -- ^ path of the Haskell module for polynomials in evaluation form (without extension)
   , typeName    :: String       -- ^ name of the polynomial type
   , typeName_r  :: String       -- ^ name of the field type 
   , prime_r     :: Integer
+  , fftDomain   :: (Int,Integer)  -- ^ the largest FFT-friendly subgroup (log2 of the size, and a generator)
   }
   deriving Show
 
@@ -41,7 +44,10 @@ c_header (PolyParams{..}) =
   , "extern int " ++ prefix ++ "degree( const uint64_t *src );"
   , ""
   , "extern void " ++ prefix ++ "get_coeff( int n1, const uint64_t *src1, int k, uint64_t *tgt );"
-  , "extern void " ++ prefix ++ "eval_at  ( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt);"
+  , "extern void " ++ prefix ++ "eval_at_naive ( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt);"
+  , "extern void " ++ prefix ++ "eval_at_horner( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt);"
+  , "extern void " ++ prefix ++ "eval_at       ( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt);"
+  , "extern void " ++ prefix ++ "eval_many_at( int K, const int *ns, const uint64_t **polys, const uint64_t *loc, uint64_t *out );"
   , ""
   , "extern uint8_t " ++ prefix ++ "is_zero     ( int n1, const uint64_t *src1 );"
   , "extern uint8_t " ++ prefix ++ "is_constant ( int n1, const uint64_t *src  , uint64_t *tgt_constant);"
@@ -52,18 +58,36 @@ c_header (PolyParams{..}) =
   , "extern void " ++ prefix ++ "sub( int n1, const uint64_t *src1, int n2, const uint64_t *src2, uint64_t *tgt );"
   , "extern void " ++ prefix ++ "scale( const uint64_t *kst1, int n2, const uint64_t *src2, uint64_t *tgt );"
   , "extern void " ++ prefix ++ "mul_naive( int n1, const uint64_t *src1, int n2, const uint64_t *src2, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "mul_ntt  ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "mul      ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, uint64_t *tgt );"
   , ""
   , "extern void " ++ prefix ++ "lincomb( int K, const int *ns, const uint64_t **coeffs, const uint64_t **polys, uint64_t *tgt );"  
   , ""
-  , "extern void " ++ prefix ++ "long_div( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem );"
-  , "extern void " ++ prefix ++ "quot    ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot                          );"
-  , "extern void " ++ prefix ++ "rem     ( int n1, const uint64_t *src1, int n2, const uint64_t *src2,                            int nrem, uint64_t *rem );"
+  , "extern void " ++ prefix ++ "inv_series( int n1, const uint64_t *src1, int k, uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "long_div_naive( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem );"
+  , "extern void " ++ prefix ++ "long_div_fast ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem );"
+  , "extern void " ++ prefix ++ "long_div      ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem );"
+  , "extern void " ++ prefix ++ "quot          ( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot                          );"
+  , "extern void " ++ prefix ++ "rem           ( int n1, const uint64_t *src1, int n2, const uint64_t *src2,                            int nrem, uint64_t *rem );"
   , ""
   , "extern void    " ++ prefix ++ "div_by_vanishing ( int n1, const uint64_t *src1, int expo_n, const uint64_t *eta, int nquot, uint64_t *quot, int nrem, uint64_t *rem );"
   , "extern uint8_t " ++ prefix ++ "quot_by_vanishing( int n1, const uint64_t *src1, int expo_n, const uint64_t *eta, int nquot, uint64_t *quot );"
   , ""
   , "extern void " ++ prefix ++ "ntt_forward(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt);"
   , "extern void " ++ prefix ++ "ntt_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt);"
+  , ""
+  , "extern void " ++ prefix ++ "fft_subgroup_gen( int m, uint64_t *gen );"
+  , ""
+  , "extern int  " ++ prefix ++ "subproduct_tree_size ( int npts );"
+  , "extern void " ++ prefix ++ "subproduct_tree      ( int npts, const uint64_t *pts, uint64_t *tree );"
+  , "extern void " ++ prefix ++ "multi_eval_with_tree ( int npts, const uint64_t *tree, int n1, const uint64_t *src1, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "multi_eval           ( int n1, const uint64_t *src1, int npts, const uint64_t *pts, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "interpolate_with_tree( int npts, const uint64_t *tree, const uint64_t *ys, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "interpolate          ( int npts, const uint64_t *pts , const uint64_t *ys, uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "fft_domain      ( int m, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "eval_lagrange_at( int m, const uint64_t *domain, const uint64_t *ys, const uint64_t *loc, uint64_t *tgt );"
   ]
 
 --------------------------------------------------------------------------------
@@ -79,6 +103,7 @@ cBegin (PolyParams{..}) =
   , "#include <string.h>"
   , ""
   , "#include \"" ++ pathBaseName c_path_r ++ ".h\""
+  , "#include \"parallel.h\""
   , ""
   , "#define NLIMBS " ++ show nlimbs
   , ""
@@ -116,6 +141,7 @@ hsBegin (PolyParams{..}) =
   , "  , constTermOf"
   , "  , kthCoeff"
   , "  , evalAt"
+  , "  , evalManyAt"
   , "    -- * Constant polynomials"
   , "  , constPoly"
   , "  , mbConst"
@@ -128,16 +154,21 @@ hsBegin (PolyParams{..}) =
   , "  , showPoly, showPoly'"
   , "    -- * Ring operations"
   , "  , neg , add , sub"
-  , "  , mul , mulNaive"
+  , "  , mul , mulNaive , mulNTT"
   , "  , sqr"
   , "    -- * Linear combinations"
   , "  , scale"
 --  , "  , linComb"
   , "    -- * Polynomial division"
   , "  , longDiv , quot , rem"
+  , "  , longDivNaive , longDivFast"
   , "  , divByVanishing, quotByVanishing"
   , "    -- * NTT"
   , "  , forwardNTT , inverseNTT"
+  , "    -- * Multipoint evaluation and interpolation"
+  , "  , SubproductTree , subproductTree"
+  , "  , multiEvalAt , multiEvalWithTree"
+  , "  , interpolate , interpolateWithTree"
   , "    -- * Random"
   , "  , rndPoly , rnd"
   , "  )"  
@@ -227,8 +258,6 @@ hsBegin (PolyParams{..}) =
   , "  abs    = id"
   , "  signum = \\_ -> constPoly 1"
   , ""
-  , "mul = mulNaive       -- TEMPORARY !!!"
-  , ""
   , "sqr x = mul x x      -- TEMPORARY ???"
   , ""
   , "instance M.Rnd " ++ typeName ++ " where"
@@ -254,6 +283,7 @@ hsBegin (PolyParams{..}) =
   , "  degree          = " ++ hsModule hs_path ++ ".degree"
   , "  kthCoeff        = " ++ hsModule hs_path ++ ".kthCoeff"
   , "  evalAt          = " ++ hsModule hs_path ++ ".evalAt"
+  , "  evalManyAt      = " ++ hsModule hs_path ++ ".evalManyAt"
   , "  scale           = " ++ hsModule hs_path ++ ".scale"
   , "  mkPoly          = " ++ hsModule hs_path ++ ".mkPoly"
   , "  mkPolyFlat      = " ++ hsModule hs_path ++ ".mkPolyFlatArr"
@@ -265,6 +295,8 @@ hsBegin (PolyParams{..}) =
   , "  polyRem         = " ++ hsModule hs_path ++ ".rem"
   , "  divByVanishing  = " ++ hsModule hs_path ++ ".divByVanishing"
   , "  quotByVanishing = " ++ hsModule hs_path ++ ".quotByVanishing"
+  , "  polyMultiEval   = " ++ hsModule hs_path ++ ".multiEvalAt"
+  , "  polyInterpolate = " ++ hsModule hs_path ++ ".interpolate"
   , ""
   , "--------------------------------------------------------------------------------"
   , ""
@@ -341,6 +373,8 @@ hsPolyBasics (PolyParams{..}) =
   , "foreign import ccall unsafe \"" ++ prefix ++ "sub\"       c_" ++ prefix ++ "sub       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
   , "foreign import ccall unsafe \"" ++ prefix ++ "scale\"     c_" ++ prefix ++ "scale     :: Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
   , "foreign import ccall unsafe \"" ++ prefix ++ "mul_naive\" c_" ++ prefix ++ "mul_naive :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "mul_ntt\"   c_" ++ prefix ++ "mul_ntt   :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "mul\"       c_" ++ prefix ++ "mul       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
   , ""
   , "{-# NOINLINE degree #-}"
   , "-- | The degree of a polynomial. By definition, the degree of the constant"
@@ -435,16 +469,27 @@ hsPolyBasics (PolyParams{..}) =
   , "        c_" ++ prefix ++ "scale ptr1 (fromIntegral n2) ptr2 ptr3"
   , "  return (XPoly n3 fptr3)"
   , ""
-  , "{-# NOINLINE mulNaive #-}"
+  , "-- | Multiplication of polynomials (naive for small inputs, NTT-based for large ones)"
+  , "mul :: " ++ typeName ++ " -> " ++ typeName ++ " -> " ++ typeName
+  , "mul = mulWith c_" ++ prefix ++ "mul"
+  , ""
   , "-- | Multiplication of polynomials, naive algorithm"
   , "mulNaive :: " ++ typeName ++ " -> " ++ typeName ++ " -> " ++ typeName
-  , "mulNaive (XPoly n1 fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do"
+  , "mulNaive = mulWith c_" ++ prefix ++ "mul_naive"
+  , ""
+  , "-- | Multiplication of polynomials, using NTT"
+  , "mulNTT :: " ++ typeName ++ " -> " ++ typeName ++ " -> " ++ typeName
+  , "mulNTT = mulWith c_" ++ prefix ++ "mul_ntt"
+  , ""
+  , "{-# NOINLINE mulWith #-}"
+  , "mulWith :: (CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()) -> " ++ typeName ++ " -> " ++ typeName ++ " -> " ++ typeName
+  , "mulWith cfun (XPoly n1 fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do"
   , "  let n3 = n1 + n2 - 1"
   , "  fptr3 <- mallocForeignPtrArray (n3*" ++ show nlimbs ++ ")"
   , "  withForeignPtr fptr1 $ \\ptr1 -> do"
   , "    withForeignPtr fptr2 $ \\ptr2 -> do"
   , "      withForeignPtr fptr3 $ \\ptr3 -> do"
-  , "        c_" ++ prefix ++ "mul_naive (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 ptr3"
+  , "        cfun (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 ptr3"
   , "  return (XPoly n3 fptr3)"
   ]
 
@@ -652,8 +697,8 @@ cPolyBasics (PolyParams{..}) =
   , "  }"
   , "}"
   , ""
-  , "// evaluate a polynomial at a single point"
-  , "void " ++ prefix ++ "eval_at( int  n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {"
+  , "// evaluate a polynomial at a single point, naive algorithm"
+  , "void " ++ prefix ++ "eval_at_naive( int  n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {"
   , "  uint64_t run[NLIMBS];               // x^i"
   , "  " ++ prefix_r ++ "set_zero(tgt);"
   , "  " ++ prefix_r ++ "set_one (run);"
@@ -674,18 +719,189 @@ cPolyBasics (PolyParams{..}) =
   , "}"
   ]
 
+cPolyEval :: PolyParams -> Code
+cPolyEval (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , "// evaluation at a single point"
+  , ""
+  , "// below this size we don't bother with multithreaded evaluation"
+  , "#define EVAL_PARALLEL_THRESHOLD 16384"
+  , ""
+  , "// evaluate a polynomial at a single point, using Horner's rule"
+  , "void " ++ prefix ++ "eval_at_horner( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {"
+  , "  if (n1 <= 0) {"
+  , "    " ++ prefix_r ++ "set_zero( tgt );"
+  , "    return;"
+  , "  }"
+  , "  uint64_t acc[NLIMBS];"
+  , "  " ++ prefix_r ++ "copy( SRC1(n1-1) , acc );"
+  , "  for(int i=n1-2; i>=0; i--) {"
+  , "    " ++ prefix_r ++ "mul_inplace( acc , loc );"
+  , "    " ++ prefix_r ++ "add_inplace( acc , SRC1(i) );"
+  , "  }"
+  , "  " ++ prefix_r ++ "copy( acc , tgt );"
+  , "}"
+  , ""
+  , "typedef struct {"
+  , "  int             n1;"
+  , "  int             chunk;"
+  , "  const uint64_t *src1;"
+  , "  const uint64_t *loc;"
+  , "        uint64_t *vals;"
+  , "} " ++ prefix ++ "eval_chunks_ctx_t;"
+  , ""
+  , "// Horner evaluation of the `j`-th chunk of coefficients"
+  , "void " ++ prefix ++ "eval_chunk_task( void *ctx, int j ) {"
+  , "  " ++ prefix ++ "eval_chunks_ctx_t *c = (" ++ prefix ++ "eval_chunks_ctx_t*) ctx;"
+  , "  int a = j * c->chunk;"
+  , "  int b = MIN( a + c->chunk , c->n1 );"
+  , "  " ++ prefix ++ "eval_at_horner( b-a, c->src1 + a*NLIMBS, c->loc, c->vals + j*NLIMBS );"
+  , "}"
+  , ""
+  , "// evaluate a polynomial at a single point. Large polynomials are split into"
+  , "// chunks which are evaluated in parallel (using Horner's rule), and the"
+  , "// partial results are recombined with a Horner step in `loc^chunk_size`"
+  , "void " ++ prefix ++ "eval_at( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {"
+  , "  int T = parallel_get_num_threads();"
+  , "  if ( (n1 < EVAL_PARALLEL_THRESHOLD) || (T <= 1) ) {"
+  , "    " ++ prefix ++ "eval_at_horner( n1, src1, loc, tgt );"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  int chunk = (n1 + T - 1) / T;"
+  , "  int m     = (n1 + chunk - 1) / chunk;"
+  , "  uint64_t *vals = malloc( 8*NLIMBS * m );"
+  , "  assert( vals != 0 );"
+  , ""
+  , "  " ++ prefix ++ "eval_chunks_ctx_t ctx;"
+  , "  ctx.n1    = n1;"
+  , "  ctx.chunk = chunk;"
+  , "  ctx.src1  = src1;"
+  , "  ctx.loc   = loc;"
+  , "  ctx.vals  = vals;"
+  , "  parallel_for( m, " ++ prefix ++ "eval_chunk_task, &ctx );"
+  , ""
+  , "  uint64_t step[NLIMBS];"
+  , "  " ++ prefix_r ++ "pow_uint64( loc, (uint64_t)chunk, step );"
+  , "  " ++ prefix ++ "eval_at_horner( m, vals, step, tgt );"
+  , "  free(vals);"
+  , "}"
+  ]
+
+cPolyEvalMany :: PolyParams -> Code
+cPolyEvalMany (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , "// evaluating many polynomials at the same point"
+  , ""
+  , "typedef struct {"
+  , "  const int       *ns;"
+  , "  const uint64_t **polys;"
+  , "  const uint64_t  *pows;"
+  , "        uint64_t  *out;"
+  , "} " ++ prefix ++ "eval_many_ctx_t;"
+  , ""
+  , "// dot product of the coefficients with the power table"
+  , "void " ++ prefix ++ "eval_many_task( void *ctx, int k ) {"
+  , "  " ++ prefix ++ "eval_many_ctx_t *c = (" ++ prefix ++ "eval_many_ctx_t*) ctx;"
+  , "  const uint64_t *src1 = c->polys[k];"
+  , "  const uint64_t *pows = c->pows;"
+  , "  int n1 = c->ns[k];"
+  , "  uint64_t acc[NLIMBS];"
+  , "  uint64_t tmp[NLIMBS];"
+  , "  " ++ prefix_r ++ "set_zero( acc );"
+  , "  for(int i=0; i<n1; i++) {"
+  , "    " ++ prefix_r ++ "mul( SRC1(i) , pows + i*NLIMBS , tmp );"
+  , "    " ++ prefix_r ++ "add_inplace( acc , tmp );"
+  , "  }"
+  , "  " ++ prefix_r ++ "copy( acc , c->out + k*NLIMBS );"
+  , "}"
+  , ""
+  , "// Evaluates `K` polynomials at the same point. The powers of `loc` are computed"
+  , "// only once, then each evaluation is a dot product (these run in parallel)."
+  , "// Requires a target buffer of size `K`"
+  , "void " ++ prefix ++ "eval_many_at"
+  , "  ( int  K                           // number of polynomials"
+  , "  , const int *ns                    // sizes of the polynomials"
+  , "  , const uint64_t **polys           // pointers to the polynomials"
+  , "  , const uint64_t *loc              // the location to evaluate at"
+  , "  ,       uint64_t *out              // target buffer"
+  , "  ) {"
+  , ""
+  , "  int N = 0;"
+  , "  for(int k=0; k<K; k++) {"
+  , "    if (ns[k] > N) { N = ns[k]; }"
+  , "  }"
+  , "  if (N == 0) {"
+  , "    for(int k=0; k<K; k++) { " ++ prefix_r ++ "set_zero( out + k*NLIMBS ); }"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  uint64_t *pows = malloc( 8*NLIMBS * N );"
+  , "  assert( pows != 0 );"
+  , "  " ++ prefix_r ++ "set_one( pows );"
+  , "  for(int i=1; i<N; i++) {"
+  , "    " ++ prefix_r ++ "mul( pows + (i-1)*NLIMBS , loc , pows + i*NLIMBS );"
+  , "  }"
+  , ""
+  , "  " ++ prefix ++ "eval_many_ctx_t ctx;"
+  , "  ctx.ns    = ns;"
+  , "  ctx.polys = polys;"
+  , "  ctx.pows  = pows;"
+  , "  ctx.out   = out;"
+  , "  parallel_for( K, " ++ prefix ++ "eval_many_task, &ctx );"
+  , ""
+  , "  free(pows);"
+  , "}"
+  ]
+
+hsPolyEvalMany :: PolyParams -> Code
+hsPolyEvalMany (PolyParams{..}) =
+  [ "foreign import ccall unsafe \"" ++ prefix ++ "eval_many_at\" c_" ++ prefix ++ "eval_many_at :: CInt -> Ptr CInt -> Ptr (Ptr Word64) -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "{-# NOINLINE evalManyAt #-}"
+  , "-- | Evaluate many polynomials at the same location @x@ (the powers of @x@ are shared)"
+  , "evalManyAt :: " ++ typeName_r ++ " -> [" ++ typeName ++ "] -> [" ++ typeName_r ++ "]"
+  , "evalManyAt (Mk" ++ typeName_r ++ " fptr1) polys = unsafePerformIO $ do"
+  , "  let k = length polys"
+  , "  fptr3 <- mallocForeignPtrArray (k*" ++ show nlimbs ++ ")"
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtrList [ fptr | XPoly _ fptr <- polys ] $ \\ptrs -> do"
+  , "      withArray [ fromIntegral n | XPoly n _ <- polys ] $ \\pns -> do"
+  , "        withArray ptrs $ \\pptrs -> do"
+  , "          withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "            c_" ++ prefix ++ "eval_many_at (fromIntegral k) pns pptrs ptr1 ptr3"
+  , "  return (L.unpackFlatArrayToList (MkFlatArray k fptr3))"
+  , ""
+  , "withForeignPtrList :: [ForeignPtr a] -> ([Ptr a] -> IO b) -> IO b"
+  , "withForeignPtrList []     action = action []"
+  , "withForeignPtrList (f:fs) action = withForeignPtr f $ \\p -> withForeignPtrList fs $ \\ps -> action (p:ps)"
+  ]
+
 --------------------------------------------------------------------------------
 
 hsPolyDiv :: PolyParams -> Code
 hsPolyDiv (PolyParams{..}) =  
-  [ "foreign import ccall unsafe \"" ++ prefix ++ "long_div\" c_" ++ prefix ++ "long_div :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
-  , "foreign import ccall unsafe \"" ++ prefix ++ "quot\"     c_" ++ prefix ++ "quot     :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
-  , "foreign import ccall unsafe \"" ++ prefix ++ "rem\"      c_" ++ prefix ++ "rem      :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
+  [ "foreign import ccall unsafe \"" ++ prefix ++ "long_div\"       c_" ++ prefix ++ "long_div       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "long_div_naive\" c_" ++ prefix ++ "long_div_naive :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "long_div_fast\"  c_" ++ prefix ++ "long_div_fast  :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "quot\"           c_" ++ prefix ++ "quot           :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "rem\"            c_" ++ prefix ++ "rem            :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()"
   , "" 
-  , "{-# NOINLINE longDiv #-}"
-  , "-- | Polynomial long division"
+  , "-- | Polynomial long division (dispatches to the naive or the fast algorithm based on the sizes)"
   , "longDiv :: " ++ typeName ++ " -> " ++ typeName ++ " -> (" ++ typeName ++ ", " ++ typeName ++ ")"
-  , "longDiv poly1@(XPoly n1 fptr1) poly2@(XPoly n2 fptr2) = unsafePerformIO $ do"
+  , "longDiv = longDivWith c_" ++ prefix ++ "long_div"
+  , "" 
+  , "-- | Polynomial long division, schoolbook algorithm"
+  , "longDivNaive :: " ++ typeName ++ " -> " ++ typeName ++ " -> (" ++ typeName ++ ", " ++ typeName ++ ")"
+  , "longDivNaive = longDivWith c_" ++ prefix ++ "long_div_naive"
+  , "" 
+  , "-- | Polynomial long division, via Newton iteration and NTT-based multiplication"
+  , "longDivFast :: " ++ typeName ++ " -> " ++ typeName ++ " -> (" ++ typeName ++ ", " ++ typeName ++ ")"
+  , "longDivFast = longDivWith c_" ++ prefix ++ "long_div_fast"
+  , "" 
+  , "{-# NOINLINE longDivWith #-}"
+  , "longDivWith :: (CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()) -> " ++ typeName ++ " -> " ++ typeName ++ " -> (" ++ typeName ++ ", " ++ typeName ++ ")"
+  , "longDivWith cfun poly1@(XPoly n1 fptr1) poly2@(XPoly n2 fptr2) = unsafePerformIO $ do"
   , "  let d2 = degree poly2"
   , "  let nq = max 0 (n1-d2)"
   , "  let nr = max 0 d2"
@@ -695,7 +911,7 @@ hsPolyDiv (PolyParams{..}) =
   , "    withForeignPtr fptr2 $ \\ptr2 -> do"
   , "      withForeignPtr fptr3 $ \\ptr3 -> do"
   , "        withForeignPtr fptr4 $ \\ptr4 -> do"
-  , "          c_" ++ prefix ++ "long_div (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 (fromIntegral nq) ptr3 (fromIntegral nr) ptr4"
+  , "          cfun (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 (fromIntegral nq) ptr3 (fromIntegral nr) ptr4"
   , "  return (XPoly nq fptr3, XPoly nr fptr4)"
   , "" 
   , "{-# NOINLINE quot #-}"
@@ -767,10 +983,10 @@ hsDivVanishing (PolyParams{..}) =
 cPolyDiv :: PolyParams -> Code
 cPolyDiv (PolyParams{..}) = 
   [ ""
-  , "// polynomial long division"
+  , "// polynomial long division, schoolbook algorithm"
   , "// allocate at least `deg(p) - deg(q) + 1` field elements for the quotient"
   , "// and at least `deg(q)` for the remainder"
-  , "void " ++ prefix ++ "long_div( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {"
+  , "void " ++ prefix ++ "long_div_naive( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {"
   , "  int deg_p = " ++ prefix ++ "degree( n1, src1 );"
   , "  int deg_q = " ++ prefix ++ "degree( n2, src2 );"
   , "  assert( (!quot) || (nquot >= deg_p - deg_q + 1) );"
@@ -820,18 +1036,6 @@ cPolyDiv (PolyParams{..}) =
   , "  free(tgt);"
   , "}"
   , ""
-  , "// polynomial quotient"
-  , "// allocate at least `deg(p) - deg(q) + 1` field elements for quotient"
-  , "void " ++ prefix ++ "quot( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot ) {"
-  , "  " ++ prefix ++ "long_div( n1, src1, n2, src2, nquot, quot, 0, 0 );"
-  , "}"
-  , ""
-  , "// polynomial remainder"
-  , "// allocate at least `deg(q)` field elements for the remainder"
-  , "void " ++ prefix ++ "rem( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nrem, uint64_t *rem ) {"
-  , "  " ++ prefix ++ "long_div( n1, src1, n2, src2, 0, 0, nrem, rem );"
-  , "}"
-  , ""
   ]
 
 cDivVanishing :: PolyParams -> Code
@@ -1100,23 +1304,841 @@ hsNTT (PolyParams{..}) =
 
 --------------------------------------------------------------------------------
 
+cPolyMulNTT :: PolyParams -> Code
+cPolyMulNTT (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , ""
+  , "// the largest FFT-friendly subgroup has size `2^FFT_MAX_LOG`"
+  , "#define FFT_MAX_LOG " ++ show (fst fftDomain)
+  , ""
+  , "// the generator of the largest FFT-friendly subgroup"
+  , mkConst nlimbs (prefix ++ "fft_gen") (toMont (snd fftDomain))
+  , ""
+  , "// below this size we use the naive multiplication algorithm"
+  , "#define MUL_NTT_THRESHOLD 48"
+  , ""
+  , "// returns the generator of the multiplicative subgroup of size `2^m`"
+  , "void " ++ prefix ++ "fft_subgroup_gen( int m, uint64_t *gen ) {"
+  , "  assert( (m >= 0) && (m <= FFT_MAX_LOG) );"
+  , "  " ++ prefix_r ++ "copy( " ++ prefix ++ "fft_gen, gen );"
+  , "  for(int i=m; i<FFT_MAX_LOG; i++) { " ++ prefix_r ++ "sqr_inplace( gen ); }"
+  , "}"
+  , ""
+  , "// the smallest `m` such that `2^m >= n`"
+  , "int " ++ prefix ++ "ceil_log2( int n ) {"
+  , "  int m = 0;"
+  , "  while( (1<<m) < n ) { m++; }"
+  , "  return m;"
+  , "}"
+  , ""
+  , "// inverse NTT, computed as the forward NTT with the inverse generator followed by"
+  , "// a scaling with `1/N`; this avoids the field inversions of `ntt_inverse_noalloc`"
+  , "// `buf` should be a scratch buffer of size `2N`"
+  , "void " ++ prefix ++ "ntt_inverse_fwd_noalloc(int m, const uint64_t *gen_inv, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {"
+  , "  int N = (1<<m);"
+  , "  uint64_t ninv[NLIMBS];"
+  , "  " ++ prefix_r ++ "set_one( ninv );"
+  , "  for(int i=0; i<m; i++) { " ++ prefix_r ++ "mul_inplace( ninv , " ++ prefix ++ "oneHalf ); }     // 1/N = (1/2)^m"
+  , "  " ++ prefix ++ "ntt_forward_noalloc( m, 1, gen_inv, src, buf, tgt );"
+  , "  for(int i=0; i<N; i++) { " ++ prefix_r ++ "mul_inplace( tgt + i*NLIMBS , ninv ); }"
+  , "}"
+  , ""
+  , "// Multiply two polynomials using NTT."
+  , "// Requires a target buffer of size `(n1+n2-1)` (!)"
+  , "void " ++ prefix ++ "mul_ntt( int  n1, const uint64_t *src1"
+  , "             , int  n2, const uint64_t *src2"
+  , "             ,                uint64_t *tgt ) {"
+  , ""
+  , "  int N3 = n1+n2-1;"
+  , "  if ( (n1 <= 0) || (n2 <= 0) ) {"
+  , "    for(int k=0; k<N3; k++) { " ++ prefix_r ++ "set_zero( TGT(k) ); }"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  int m = " ++ prefix ++ "ceil_log2( N3 );"
+  , "  int N = (1<<m);"
+  , "  assert( m <= FFT_MAX_LOG );"
+  , ""
+  , "  uint64_t gen[NLIMBS];"
+  , "  uint64_t ginv[NLIMBS];"
+  , "  " ++ prefix ++ "fft_subgroup_gen( m, gen );"
+  , "  " ++ prefix_r ++ "inv( gen, ginv );"
+  , ""
+  , "  // layout: [ padded input | 1st transform | 2nd transform | NTT scratch (2N) ]"
+  , "  uint64_t *buf = malloc( 8*NLIMBS * (5*N) );"
+  , "  assert( buf != 0 );"
+  , "  uint64_t *pad = buf;"
+  , "  uint64_t *us  = buf +   N*NLIMBS;"
+  , "  uint64_t *vs  = buf + 2*N*NLIMBS;"
+  , "  uint64_t *scr = buf + 3*N*NLIMBS;"
+  , ""
+  , "  memcpy( pad, src1, 8*NLIMBS*n1 );"
+  , "  memset( pad + n1*NLIMBS, 0, 8*NLIMBS*(N-n1) );"
+  , "  " ++ prefix ++ "ntt_forward_noalloc( m, 1, gen, pad, scr, us );"
+  , ""
+  , "  if ( (src1 == src2) && (n1 == n2) ) {"
+  , "    // squaring"
+  , "    for(int i=0; i<N; i++) { " ++ prefix_r ++ "sqr_inplace( us + i*NLIMBS ); }"
+  , "  }"
+  , "  else {"
+  , "    memcpy( pad, src2, 8*NLIMBS*n2 );"
+  , "    memset( pad + n2*NLIMBS, 0, 8*NLIMBS*(N-n2) );"
+  , "    " ++ prefix ++ "ntt_forward_noalloc( m, 1, gen, pad, scr, vs );"
+  , "    for(int i=0; i<N; i++) { " ++ prefix_r ++ "mul_inplace( us + i*NLIMBS , vs + i*NLIMBS ); }"
+  , "  }"
+  , ""
+  , "  " ++ prefix ++ "ntt_inverse_fwd_noalloc( m, ginv, us, scr, pad );"
+  , "  memcpy( tgt, pad, 8*NLIMBS*N3 );"
+  , ""
+  , "  free(buf);"
+  , "}"
+  , ""
+  , "// Multiply two polynomials."
+  , "// Uses the naive algorithm for small inputs and NTT for larger ones."
+  , "// Requires a target buffer of size `(n1+n2-1)` (!)"
+  , "void " ++ prefix ++ "mul( int  n1, const uint64_t *src1"
+  , "         , int  n2, const uint64_t *src2"
+  , "         ,                uint64_t *tgt ) {"
+  , ""
+  , "  if (MIN(n1,n2) <= MUL_NTT_THRESHOLD) {"
+  , "    " ++ prefix ++ "mul_naive( n1, src1, n2, src2, tgt );"
+  , "  }"
+  , "  else {"
+  , "    " ++ prefix ++ "mul_ntt  ( n1, src1, n2, src2, tgt );"
+  , "  }"
+  , "}"
+  ]
+  where
+    toMont x = mod (2^(64*nlimbs) * x) prime_r     -- Montgomery representation
+
+cPolyFastDiv :: PolyParams -> Code
+cPolyFastDiv (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , ""
+  , "// relative cost of the NTT-based division, per `n*log2(n)` (measured)"
+  , "#define LONG_DIV_FAST_FACTOR 24"
+  , ""
+  , "// Inverse of a power series modulo `x^k`, via Newton iteration:"
+  , "//   g_{2l} = g_l * (2 - f*g_l)  mod x^{2l}"
+  , "// The constant term of the input must be nonzero."
+  , "// Requires a target buffer of size `k`"
+  , "void " ++ prefix ++ "inv_series( int n1, const uint64_t *src1, int k, uint64_t *tgt ) {"
+  , "  assert( n1 >= 1 );"
+  , "  assert( !" ++ prefix_r ++ "is_zero( SRC1(0) ) );"
+  , "  if (k <= 0) return;"
+  , ""
+  , "  " ++ prefix_r ++ "inv( SRC1(0), TGT(0) );"
+  , ""
+  , "  int Nmax = 4 * (1 << " ++ prefix ++ "ceil_log2(k));"
+  , "  uint64_t *buf = malloc( 8*NLIMBS * (5*Nmax) );"
+  , "  assert( buf != 0 );"
+  , "  uint64_t *pad = buf;"
+  , "  uint64_t *us  = buf +   Nmax*NLIMBS;"
+  , "  uint64_t *vs  = buf + 2*Nmax*NLIMBS;"
+  , "  uint64_t *scr = buf + 3*Nmax*NLIMBS;"
+  , ""
+  , "  int l = 1;"
+  , "  while (l < k) {"
+  , "    // here `tgt` contains g_l, and f*g_l = 1 mod x^l"
+  , "    int l2 = 2*l;"
+  , "    int N  = 4*l;"
+  , "    int m  = " ++ prefix ++ "ceil_log2( N );"
+  , "    uint64_t gen[NLIMBS];"
+  , "    uint64_t ginv[NLIMBS];"
+  , "    " ++ prefix ++ "fft_subgroup_gen( m, gen );"
+  , "    " ++ prefix_r ++ "inv( gen, ginv );"
+  , ""
+  , "    int nf = MIN( n1 , l2 );"
+  , "    memcpy( pad, src1, 8*NLIMBS*nf );"
+  , "    memset( pad + nf*NLIMBS, 0, 8*NLIMBS*(N-nf) );"
+  , "    " ++ prefix ++ "ntt_forward_noalloc( m, 1, gen, pad, scr, us );      // f mod x^(2l)"
+  , ""
+  , "    memcpy( pad, tgt, 8*NLIMBS*l );"
+  , "    memset( pad + l*NLIMBS, 0, 8*NLIMBS*(N-l) );"
+  , "    " ++ prefix ++ "ntt_forward_noalloc( m, 1, gen, pad, scr, vs );      // g_l"
+  , ""
+  , "    for(int i=0; i<N; i++) {"
+  , "      " ++ prefix_r ++ "mul_inplace( us + i*NLIMBS , vs + i*NLIMBS );"
+  , "      " ++ prefix_r ++ "mul_inplace( us + i*NLIMBS , vs + i*NLIMBS );      // f * g_l^2"
+  , "    }"
+  , "    " ++ prefix ++ "ntt_inverse_fwd_noalloc( m, ginv, us, scr, pad );"
+  , ""
+  , "    // since f*g_l^2 = g_l mod x^l, the lower half of 2*g_l - f*g_l^2 is simply g_l"
+  , "    int kk = MIN( l2 , k );"
+  , "    for(int i=l; i<kk; i++) {"
+  , "      " ++ prefix_r ++ "neg( pad + i*NLIMBS , TGT(i) );"
+  , "    }"
+  , "    l = l2;"
+  , "  }"
+  , ""
+  , "  free(buf);"
+  , "}"
+  , ""
+  , "// polynomial long division via reversed multiplication:"
+  , "//   rev(quot) = rev(p) * rev(q)^-1  mod x^(deg(p)-deg(q)+1)"
+  , "// where the inverse power series is computed by Newton iteration."
+  , "// allocate at least `deg(p) - deg(q) + 1` field elements for the quotient"
+  , "// and at least `deg(q)` for the remainder"
+  , "void " ++ prefix ++ "long_div_fast( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {"
+  , "  int deg_p = " ++ prefix ++ "degree( n1, src1 );"
+  , "  int deg_q = " ++ prefix ++ "degree( n2, src2 );"
+  , "  assert( (!quot) || (nquot >= deg_p - deg_q + 1) );"
+  , "  assert( (!rem ) || (nrem  >= deg_q)             );"
+  , ""
+  , "  if ( (deg_q < 0) || (deg_p < deg_q) ) {"
+  , "    // trivial cases (division by zero, or zero quotient)"
+  , "    " ++ prefix ++ "long_div_naive( n1, src1, n2, src2, nquot, quot, nrem, rem );"
+  , "    return;"
+  , "  }"
+  , ""
+  , "  int nq  = deg_p - deg_q + 1;     // size of the quotient"
+  , "  int nrq = MIN( nq , deg_q+1 );   // we only need rev(q) mod x^nq"
+  , ""
+  , "  uint64_t *revp = malloc( 8*NLIMBS * nq     );"
+  , "  uint64_t *revq = malloc( 8*NLIMBS * nrq    );"
+  , "  uint64_t *qinv = malloc( 8*NLIMBS * nq     );"
+  , "  uint64_t *prod = malloc( 8*NLIMBS * (2*nq) );"
+  , "  assert( revp != 0 );"
+  , "  assert( revq != 0 );"
+  , "  assert( qinv != 0 );"
+  , "  assert( prod != 0 );"
+  , ""
+  , "  for(int i=0; i<nq ; i++) { " ++ prefix_r ++ "copy( SRC1(deg_p-i) , revp + i*NLIMBS ); }"
+  , "  for(int i=0; i<nrq; i++) { " ++ prefix_r ++ "copy( SRC2(deg_q-i) , revq + i*NLIMBS ); }"
+  , ""
+  , "  " ++ prefix ++ "inv_series( nrq, revq, nq, qinv );"
+  , "  " ++ prefix ++ "mul( nq, revp, nq, qinv, prod );   // we only need the lowest `nq` coefficients"
+  , ""
+  , "  // the quotient is the reverse of the product mod x^nq; reuse `revp`"
+  , "  uint64_t *qt = revp;"
+  , "  for(int i=0; i<nq; i++) { " ++ prefix_r ++ "copy( prod + (nq-1-i)*NLIMBS , qt + i*NLIMBS ); }"
+  , ""
+  , "  if (quot) {"
+  , "    memcpy( quot, qt, 8*NLIMBS*nq );"
+  , "    for(int j=nq; j<nquot; j++) { " ++ prefix_r ++ "set_zero( QUOT(j) ); }"
+  , "  }"
+  , ""
+  , "  if (rem) {"
+  , "    // rem = p - q*quot mod x^deg(q)"
+  , "    if (deg_q > 0) {"
+  , "      int na = deg_q;"
+  , "      int nb = MIN( nq , deg_q );"
+  , "      uint64_t *qq = malloc( 8*NLIMBS * (na+nb-1) );"
+  , "      assert( qq != 0 );"
+  , "      " ++ prefix ++ "mul( na, src2, nb, qt, qq );"
+  , "      for(int i=0; i<deg_q; i++) {"
+  , "        " ++ prefix_r ++ "sub( SRC1(i) , qq + i*NLIMBS , REM(i) );"
+  , "      }"
+  , "      free(qq);"
+  , "    }"
+  , "    for(int j=deg_q; j<nrem; j++) { " ++ prefix_r ++ "set_zero( REM(j) ); }"
+  , "  }"
+  , ""
+  , "  free(prod);"
+  , "  free(qinv);"
+  , "  free(revq);"
+  , "  free(revp);"
+  , "}"
+  , ""
+  , "// polynomial long division"
+  , "// dispatches to the schoolbook or the fast algorithm based on the sizes:"
+  , "// schoolbook needs `(deg(p)-deg(q)+1)*(deg(q)+1)` multiplications, while"
+  , "// the fast one is a few NTTs of size `O(deg(p))`"
+  , "// allocate at least `deg(p) - deg(q) + 1` field elements for the quotient"
+  , "// and at least `deg(q)` for the remainder"
+  , "void " ++ prefix ++ "long_div( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {"
+  , "  int deg_p = " ++ prefix ++ "degree( n1, src1 );"
+  , "  int deg_q = " ++ prefix ++ "degree( n2, src2 );"
+  , "  int64_t cost_naive = (int64_t)(deg_p - deg_q + 1) * (int64_t)(deg_q + 1);"
+  , "  int64_t cost_fast  = (int64_t)LONG_DIV_FAST_FACTOR * (int64_t)(deg_p + 1) * " ++ prefix ++ "ceil_log2( deg_p + 1 );"
+  , "  if ( (deg_q >= 0) && (deg_p >= deg_q) && (cost_naive > cost_fast) ) {"
+  , "    " ++ prefix ++ "long_div_fast ( n1, src1, n2, src2, nquot, quot, nrem, rem );"
+  , "  }"
+  , "  else {"
+  , "    " ++ prefix ++ "long_div_naive( n1, src1, n2, src2, nquot, quot, nrem, rem );"
+  , "  }"
+  , "}"
+  , ""
+  , "// polynomial quotient"
+  , "// allocate at least `deg(p) - deg(q) + 1` field elements for quotient"
+  , "void " ++ prefix ++ "quot( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot ) {"
+  , "  " ++ prefix ++ "long_div( n1, src1, n2, src2, nquot, quot, 0, 0 );"
+  , "}"
+  , ""
+  , "// polynomial remainder"
+  , "// allocate at least `deg(q)` field elements for the remainder"
+  , "void " ++ prefix ++ "rem( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nrem, uint64_t *rem ) {"
+  , "  " ++ prefix ++ "long_div( n1, src1, n2, src2, 0, 0, nrem, rem );"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+cPolyLagrange :: PolyParams -> Code
+cPolyLagrange (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , "// polynomials in evaluation form (values on an FFT-friendly subgroup)"
+  , ""
+  , "// the table of the elements `[1,g,g^2,...,g^(N-1)]` of the subgroup of size `N=2^m`"
+  , "// Requires a target buffer of size `2^m`"
+  , "void " ++ prefix ++ "fft_domain( int m, uint64_t *tgt ) {"
+  , "  int N = (1<<m);"
+  , "  uint64_t gen[NLIMBS];"
+  , "  " ++ prefix ++ "fft_subgroup_gen( m, gen );"
+  , "  " ++ prefix_r ++ "set_one( TGT(0) );"
+  , "  for(int i=1; i<N; i++) {"
+  , "    " ++ prefix_r ++ "mul( TGT(i-1) , gen , TGT(i) );"
+  , "  }"
+  , "}"
+  , ""
+  , "// Barycentric evaluation of a polynomial given by its values `ys` on the subgroup"
+  , "// of size `N=2^m`, at an arbitrary location `z`:"
+  , "//"
+  , "//   p(z) = (z^N - 1)/N * sum_i ys[i] * g^i / (z - g^i)"
+  , "//"
+  , "// `domain` is the table of the subgroup elements (see `fft_domain`)."
+  , "// This needs a single batch inversion."
+  , "void " ++ prefix ++ "eval_lagrange_at( int m, const uint64_t *domain, const uint64_t *ys, const uint64_t *loc, uint64_t *tgt ) {"
+  , "  int N = (1<<m);"
+  , "  assert( N >= 1 );"
+  , ""
+  , "  for(int i=0; i<N; i++) {"
+  , "    if (" ++ prefix_r ++ "is_equal( loc , domain + i*NLIMBS )) {"
+  , "      // `z` is in the domain"
+  , "      " ++ prefix_r ++ "copy( ys + i*NLIMBS , tgt );"
+  , "      return;"
+  , "    }"
+  , "  }"
+  , ""
+  , "  uint64_t *buf = malloc( 8*NLIMBS * (2*N) );"
+  , "  assert( buf != 0 );"
+  , "  uint64_t *diff = buf;"
+  , "  uint64_t *dinv = buf + N*NLIMBS;"
+  , ""
+  , "  for(int i=0; i<N; i++) {"
+  , "    " ++ prefix_r ++ "sub( loc , domain + i*NLIMBS , diff + i*NLIMBS );"
+  , "  }"
+  , "  " ++ prefix_r ++ "batch_inv( N, diff, dinv );"
+  , ""
+  , "  uint64_t acc[NLIMBS];"
+  , "  uint64_t tmp[NLIMBS];"
+  , "  " ++ prefix_r ++ "set_zero( acc );"
+  , "  for(int i=0; i<N; i++) {"
+  , "    " ++ prefix_r ++ "mul( ys + i*NLIMBS , domain + i*NLIMBS , tmp );"
+  , "    " ++ prefix_r ++ "mul_inplace( tmp , dinv + i*NLIMBS );"
+  , "    " ++ prefix_r ++ "add_inplace( acc , tmp );"
+  , "  }"
+  , ""
+  , "  // (z^N - 1) / N"
+  , "  uint64_t zn[NLIMBS];"
+  , "  uint64_t one[NLIMBS];"
+  , "  " ++ prefix_r ++ "copy( loc , zn );"
+  , "  for(int i=0; i<m; i++) {"
+  , "    " ++ prefix_r ++ "sqr_inplace( zn );"
+  , "    " ++ prefix_r ++ "mul_inplace( acc , " ++ prefix ++ "oneHalf );"
+  , "  }"
+  , "  " ++ prefix_r ++ "set_one( one );"
+  , "  " ++ prefix_r ++ "sub_inplace( zn , one );"
+  , "  " ++ prefix_r ++ "mul( acc , zn , tgt );"
+  , ""
+  , "  free(buf);"
+  , "}"
+  ]
+
+--------------------------------------------------------------------------------
+
+cPolyMultiEval :: PolyParams -> Code
+cPolyMultiEval (PolyParams{..}) = 
+  [ "// -----------------------------------------------------------------------------"
+  , "// subproduct trees, multipoint evaluation and interpolation"
+  , "//"
+  , "// The subproduct tree of the points `a_0 .. a_{n-1}` has `ceil(log2(n))+1` levels."
+  , "// The node `k` on level `j` is the (monic) product of the linear factors `(x - a_i)`"
+  , "// for `k*2^j <= i < min( (k+1)*2^j , n )`, and is stored in a slot of `2^j+1`"
+  , "// field elements; the levels are stored consecutively, starting with the leaves."
+  , ""
+  , "// the number of points below the node `k` on level `j`"
+  , "int " ++ prefix ++ "subproduct_node_count( int npts, int j, int k ) {"
+  , "  int w = (1<<j);"
+  , "  return MIN( w , npts - k*w );"
+  , "}"
+  , ""
+  , "// offset (in field elements) of the node `k` on level `j`"
+  , "int " ++ prefix ++ "subproduct_node_offset( int npts, int j, int k ) {"
+  , "  int ofs = 0;"
+  , "  for(int i=0; i<j; i++) {"
+  , "    int w = (1<<i);"
+  , "    ofs += ((npts + w - 1) >> i) * (w + 1);"
+  , "  }"
+  , "  return ofs + k*((1<<j) + 1);"
+  , "}"
+  , ""
+  , "// below nodes of this size, multipoint evaluation falls back to direct evaluation"
+  , "#define MULTI_EVAL_LEAF_LOG 4"
+  , ""
+  , "// size of the subproduct tree buffer, in field elements"
+  , "int " ++ prefix ++ "subproduct_tree_size( int npts ) {"
+  , "  if (npts <= 0) return 0;"
+  , "  int L = " ++ prefix ++ "ceil_log2( npts );"
+  , "  return " ++ prefix ++ "subproduct_node_offset( npts, L+1, 0 );"
+  , "}"
+  , ""
+  , "// Builds the subproduct tree of a set of points."
+  , "// Requires a target buffer of size `subproduct_tree_size(npts)`"
+  , "void " ++ prefix ++ "subproduct_tree( int npts, const uint64_t *pts, uint64_t *tree ) {"
+  , "  if (npts <= 0) return;"
+  , "  int L = " ++ prefix ++ "ceil_log2( npts );"
+  , ""
+  , "  // leaves: x - a_i"
+  , "  for(int i=0; i<npts; i++) {"
+  , "    uint64_t *leaf = tree + 2*i*NLIMBS;"
+  , "    " ++ prefix_r ++ "neg    ( pts + i*NLIMBS , leaf );"
+  , "    " ++ prefix_r ++ "set_one( leaf + NLIMBS );"
+  , "  }"
+  , ""
+  , "  for(int j=1; j<=L; j++) {"
+  , "    int cnt = ( (npts + (1<<j) - 1) >> j );"
+  , "    for(int k=0; k<cnt; k++) {"
+  , "      int c  = " ++ prefix ++ "subproduct_node_count( npts, j  , k     );"
+  , "      int cl = " ++ prefix ++ "subproduct_node_count( npts, j-1, 2*k   );"
+  , "      uint64_t       *node  = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j  , k     );"
+  , "      const uint64_t *left  = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j-1, 2*k   );"
+  , "      const uint64_t *right = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j-1, 2*k+1 );"
+  , "      if (c == cl) {"
+  , "        // no right child"
+  , "        memcpy( node, left, 8*NLIMBS*(c+1) );"
+  , "      }"
+  , "      else {"
+  , "        int cr = c - cl;"
+  , "        " ++ prefix ++ "mul( cl+1, left, cr+1, right, node );"
+  , "      }"
+  , "    }"
+  , "  }"
+  , "}"
+  , ""
+  , "// Evaluates a polynomial at the points of a precomputed subproduct tree,"
+  , "// by reducing it modulo the nodes, going down the tree."
+  , "// Requires a target buffer of size `npts`"
+  , "void " ++ prefix ++ "multi_eval_with_tree( int npts, const uint64_t *tree, int n1, const uint64_t *src1, uint64_t *tgt ) {"
+  , "  if (npts <= 0) return;"
+  , "  int L = " ++ prefix ++ "ceil_log2( npts );"
+  , ""
+  , "  // remainders for all the nodes of a level; the node `k` on level `j` is at `k*2^j`"
+  , "  uint64_t *cur = malloc( 8*NLIMBS * npts );"
+  , "  uint64_t *nxt = malloc( 8*NLIMBS * npts );"
+  , "  assert( cur != 0 );"
+  , "  assert( nxt != 0 );"
+  , ""
+  , "  const uint64_t *root = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, L, 0 );"
+  , "  " ++ prefix ++ "rem( n1, src1, npts+1, root, npts, cur );"
+  , ""
+  , "  int j0 = MIN( L , MULTI_EVAL_LEAF_LOG );"
+  , "  for(int j=L; j>j0; j--) {"
+  , "    int w   = (1<<j);"
+  , "    int h   = (w>>1);"
+  , "    int cnt = ( (npts + w - 1) >> j );"
+  , "    for(int k=0; k<cnt; k++) {"
+  , "      int c  = " ++ prefix ++ "subproduct_node_count( npts, j, k );"
+  , "      const uint64_t *r = cur + k*w*NLIMBS;"
+  , "      for(int t=0; t<2; t++) {"
+  , "        int kk = 2*k + t;"
+  , "        if (kk*h >= npts) break;"
+  , "        int cc = " ++ prefix ++ "subproduct_node_count( npts, j-1, kk );"
+  , "        if (cc == c) {"
+  , "          // single child, the remainder is already reduced"
+  , "          memcpy( nxt + kk*h*NLIMBS, r, 8*NLIMBS*c );"
+  , "        }"
+  , "        else {"
+  , "          const uint64_t *child = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j-1, kk );"
+  , "          " ++ prefix ++ "rem( c, r, cc+1, child, cc, nxt + kk*h*NLIMBS );"
+  , "        }"
+  , "      }"
+  , "    }"
+  , "    uint64_t *tmp = cur; cur = nxt; nxt = tmp;"
+  , "  }"
+  , ""
+  , "  // small nodes: evaluate the remainders directly (the leaves are `x - a_i`)"
+  , "  int w0 = (1<<j0);"
+  , "  for(int i=0; i<npts; i++) {"
+  , "    uint64_t a[NLIMBS];"
+  , "    int k = (i >> j0);"
+  , "    int c = " ++ prefix ++ "subproduct_node_count( npts, j0, k );"
+  , "    " ++ prefix_r ++ "neg( tree + 2*i*NLIMBS , a );"
+  , "    " ++ prefix ++ "eval_at( c, cur + k*w0*NLIMBS, a, TGT(i) );"
+  , "  }"
+  , ""
+  , "  free(nxt);"
+  , "  free(cur);"
+  , "}"
+  , ""
+  , "// Evaluates a polynomial at `npts` arbitrary points."
+  , "// Requires a target buffer of size `npts`"
+  , "void " ++ prefix ++ "multi_eval( int n1, const uint64_t *src1, int npts, const uint64_t *pts, uint64_t *tgt ) {"
+  , "  if (npts <= 0) return;"
+  , "  uint64_t *tree = malloc( 8*NLIMBS * " ++ prefix ++ "subproduct_tree_size(npts) );"
+  , "  assert( tree != 0 );"
+  , "  " ++ prefix ++ "subproduct_tree( npts, pts, tree );"
+  , "  " ++ prefix ++ "multi_eval_with_tree( npts, tree, n1, src1, tgt );"
+  , "  free(tree);"
+  , "}"
+  , ""
+  , "// Lagrange interpolation using a precomputed subproduct tree: computes the unique"
+  , "// polynomial of degree less than `npts` taking the values `ys` at the points."
+  , "// The points must be distinct."
+  , "// Requires a target buffer of size `npts`"
+  , "void " ++ prefix ++ "interpolate_with_tree( int npts, const uint64_t *tree, const uint64_t *ys, uint64_t *tgt ) {"
+  , "  if (npts <= 0) return;"
+  , "  int L = " ++ prefix ++ "ceil_log2( npts );"
+  , ""
+  , "  uint64_t *cur = malloc( 8*NLIMBS * npts );"
+  , "  uint64_t *nxt = malloc( 8*NLIMBS * npts );"
+  , "  uint64_t *tmp = malloc( 8*NLIMBS * npts );"
+  , "  assert( cur != 0 );"
+  , "  assert( nxt != 0 );"
+  , "  assert( tmp != 0 );"
+  , ""
+  , "  // the barycentric weights are `1 / m'(a_i)`, where `m` is the root of the tree"
+  , "  const uint64_t *root = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, L, 0 );"
+  , "  uint64_t one[NLIMBS];"
+  , "  uint64_t idx[NLIMBS];"
+  , "  " ++ prefix_r ++ "set_one ( one );"
+  , "  " ++ prefix_r ++ "set_zero( idx );"
+  , "  for(int i=0; i<npts; i++) {"
+  , "    " ++ prefix_r ++ "add_inplace( idx, one );"
+  , "    " ++ prefix_r ++ "mul( root + (i+1)*NLIMBS , idx , tmp + i*NLIMBS );"
+  , "  }"
+  , "  " ++ prefix ++ "multi_eval_with_tree( npts, tree, npts, tmp, nxt );"
+  , "  " ++ prefix_r ++ "batch_inv( npts, nxt, tmp );"
+  , "  for(int i=0; i<npts; i++) {"
+  , "    " ++ prefix_r ++ "mul( ys + i*NLIMBS , tmp + i*NLIMBS , cur + i*NLIMBS );"
+  , "  }"
+  , ""
+  , "  // combine going up the tree: P = P_left * M_right + P_right * M_left"
+  , "  for(int j=1; j<=L; j++) {"
+  , "    int w   = (1<<j);"
+  , "    int h   = (w>>1);"
+  , "    int cnt = ( (npts + w - 1) >> j );"
+  , "    for(int k=0; k<cnt; k++) {"
+  , "      int c  = " ++ prefix ++ "subproduct_node_count( npts, j  , k   );"
+  , "      int cl = " ++ prefix ++ "subproduct_node_count( npts, j-1, 2*k );"
+  , "      uint64_t *pl = cur + (2*k  )*h*NLIMBS;"
+  , "      uint64_t *pr = cur + (2*k+1)*h*NLIMBS;"
+  , "      uint64_t *p  = nxt +     k  *w*NLIMBS;"
+  , "      if (c == cl) {"
+  , "        memcpy( p, pl, 8*NLIMBS*c );"
+  , "      }"
+  , "      else {"
+  , "        int cr = c - cl;"
+  , "        const uint64_t *left  = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j-1, 2*k   );"
+  , "        const uint64_t *right = tree + NLIMBS * " ++ prefix ++ "subproduct_node_offset( npts, j-1, 2*k+1 );"
+  , "        " ++ prefix ++ "mul( cl, pl, cr+1, right, p   );"
+  , "        " ++ prefix ++ "mul( cr, pr, cl+1, left , tmp );"
+  , "        for(int i=0; i<c; i++) { " ++ prefix_r ++ "add_inplace( p + i*NLIMBS , tmp + i*NLIMBS ); }"
+  , "      }"
+  , "    }"
+  , "    uint64_t *sw = cur; cur = nxt; nxt = sw;"
+  , "  }"
+  , ""
+  , "  memcpy( tgt, cur, 8*NLIMBS*npts );"
+  , "  free(tmp);"
+  , "  free(nxt);"
+  , "  free(cur);"
+  , "}"
+  , ""
+  , "// Lagrange interpolation at `npts` arbitrary (distinct) points."
+  , "// Requires a target buffer of size `npts`"
+  , "void " ++ prefix ++ "interpolate( int npts, const uint64_t *pts, const uint64_t *ys, uint64_t *tgt ) {"
+  , "  if (npts <= 0) return;"
+  , "  uint64_t *tree = malloc( 8*NLIMBS * " ++ prefix ++ "subproduct_tree_size(npts) );"
+  , "  assert( tree != 0 );"
+  , "  " ++ prefix ++ "subproduct_tree( npts, pts, tree );"
+  , "  " ++ prefix ++ "interpolate_with_tree( npts, tree, ys, tgt );"
+  , "  free(tree);"
+  , "}"
+  ]
+
+hsMultiEval :: PolyParams -> Code
+hsMultiEval (PolyParams{..}) =
+  [ "foreign import ccall unsafe \"" ++ prefix ++ "subproduct_tree_size\"  c_" ++ prefix ++ "subproduct_tree_size  :: CInt -> IO CInt"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "subproduct_tree\"       c_" ++ prefix ++ "subproduct_tree       :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "multi_eval_with_tree\"  c_" ++ prefix ++ "multi_eval_with_tree  :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "interpolate_with_tree\" c_" ++ prefix ++ "interpolate_with_tree :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "-- | A precomputed subproduct tree over a set of points, for repeated"
+  , "-- multipoint evaluation and interpolation on the same points"
+  , "data SubproductTree = MkSubproductTree !Int !(ForeignPtr Word64)"
+  , ""
+  , "{-# NOINLINE subproductTree #-}"
+  , "-- | Builds the subproduct tree of the given points"
+  , "subproductTree :: FlatArray " ++ typeName_r ++ " -> SubproductTree"
+  , "subproductTree (MkFlatArray npts fptr1) = unsafePerformIO $ do"
+  , "  size  <- fromIntegral <$> c_" ++ prefix ++ "subproduct_tree_size (fromIntegral npts)"
+  , "  fptr2 <- mallocForeignPtrArray (size*" ++ show nlimbs ++ ")"
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      c_" ++ prefix ++ "subproduct_tree (fromIntegral npts) ptr1 ptr2"
+  , "  return (MkSubproductTree npts fptr2)"
+  , ""
+  , "{-# NOINLINE multiEvalWithTree #-}"
+  , "-- | Evaluates a polynomial at the points of a precomputed subproduct tree"
+  , "multiEvalWithTree :: SubproductTree -> " ++ typeName ++ " -> FlatArray " ++ typeName_r
+  , "multiEvalWithTree (MkSubproductTree npts fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do"
+  , "  fptr3 <- mallocForeignPtrArray (npts*" ++ show nlimbs ++ ")"
+  , "  withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "    withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "      withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "        c_" ++ prefix ++ "multi_eval_with_tree (fromIntegral npts) ptr1 (fromIntegral n2) ptr2 ptr3"
+  , "  return (MkFlatArray npts fptr3)"
+  , ""
+  , "{-# NOINLINE interpolateWithTree #-}"
+  , "-- | Lagrange interpolation on the (distinct) points of a precomputed subproduct tree"
+  , "interpolateWithTree :: SubproductTree -> FlatArray " ++ typeName_r ++ " -> " ++ typeName
+  , "interpolateWithTree (MkSubproductTree npts fptr1) (MkFlatArray n2 fptr2)"
+  , "  | npts /= n2  = error \"interpolateWithTree: number of values differs from the number of points\""
+  , "  | otherwise   = unsafePerformIO $ do"
+  , "      fptr3 <- mallocForeignPtrArray (npts*" ++ show nlimbs ++ ")"
+  , "      withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "        withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "          withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "            c_" ++ prefix ++ "interpolate_with_tree (fromIntegral npts) ptr1 ptr2 ptr3"
+  , "      return (XPoly npts fptr3)"
+  , ""
+  , "-- | Evaluates a polynomial at many points (using a subproduct tree)"
+  , "multiEvalAt :: FlatArray " ++ typeName_r ++ " -> " ++ typeName ++ " -> FlatArray " ++ typeName_r
+  , "multiEvalAt pts = multiEvalWithTree (subproductTree pts)"
+  , ""
+  , "-- | Lagrange interpolation: @interpolate xs ys@ is the unique polynomial of degree"
+  , "-- less than @n@ taking the values @ys@ at the (distinct) points @xs@"
+  , "interpolate :: FlatArray " ++ typeName_r ++ " -> FlatArray " ++ typeName_r ++ " -> " ++ typeName
+  , "interpolate pts = interpolateWithTree (subproductTree pts)"
+  ]
+
+--------------------------------------------------------------------------------
+
+hsLagrange :: PolyParams -> Code
+hsLagrange (PolyParams{..}) =
+  [ "-- | Univariate polynomials over '" ++ hsModule hs_path_r ++ "." ++ typeName_r ++ "' in evaluation form,"
+  , "-- that is, given by their values on an FFT-friendly multiplicative subgroup"
+  , "-- (equivalently, as linear combinations of the Lagrange basis polynomials of the subgroup)"
+  , "--"
+  , "-- * NOTE 1: This module is intented to be imported qualified"
+  , "--"
+  , "-- * NOTE 2: Generated code, do not edit!"
+  , "--"
+  , ""
+  , "{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies, FlexibleInstances #-}"
+  , "module " ++ hsModule hs_path_lag
+  , "  ( EvalPoly(..)"
+  , "    -- * Evaluation form"
+  , "  , mkEvalPoly"
+  , "  , evalValues"
+  , "  , evalDomainLogSize"
+  , "  , evalDomain"
+  , "    -- * Conversion"
+  , "  , fromCoeffForm"
+  , "  , toCoeffForm"
+  , "    -- * Evaluation"
+  , "  , evalAt"
+  , "    -- * Pointwise operations"
+  , "  , neg , add , sub , mul"
+  , "  , scale"
+  , "    -- * Cached domains"
+  , "  , cachedSubgroup"
+  , "  , cachedDomain"
+  , "  )"
+  , "  where"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "import Data.Word"
+  , ""
+  , "import Foreign.C"
+  , "import Foreign.Ptr"
+  , "import Foreign.Marshal"
+  , "import Foreign.ForeignPtr"
+  , ""
+  , "import System.IO.Unsafe"
+  , ""
+  , "import " ++ hsModule hs_path_r ++ " ( " ++ typeName_r ++ "(..) )"
+  , "import " ++ hsModule hs_path   ++ " ( " ++ typeName   ++ "(..) )"
+  , "import qualified " ++ hsModule hs_path   ++ " as Poly"
+  , "import qualified " ++ hsModule hs_path_arr ++ " as Arr"
+  , ""
+  , "import           ZK.Algebra.Class.Flat  as L"
+  , "import           ZK.Algebra.Class.FFT   as T"
+  , "import           ZK.Algebra.Class.Misc  ( Log2(..) , fromLog2 , exp2_ , integerLog2 )"
+  , "import qualified ZK.Algebra.Class.Poly  as P"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "-- | A polynomial in evaluation form: its values on the subgroup of size @2^m@,"
+  , "-- in the natural order @[ p(1), p(g), p(g^2), ... ]@"
+  , "data EvalPoly = MkEvalPoly !Log2 !(FlatArray " ++ typeName_r ++ ")"
+  , ""
+  , "instance Eq EvalPoly where"
+  , "  (MkEvalPoly m1 arr1) == (MkEvalPoly m2 arr2) = (m1 == m2) && (arr1 == arr2)"
+  , ""
+  , "instance Show EvalPoly where"
+  , "  show (MkEvalPoly m arr) = \"EvalPoly \" ++ show (fromLog2 m) ++ \" \" ++ show (L.unpackFlatArrayToList arr)"
+  , ""
+  , "instance L.WrappedArray EvalPoly where"
+  , "  type Element EvalPoly = " ++ typeName_r
+  , "  wrapArray   = mkEvalPoly"
+  , "  unwrapArray = evalValues"
+  , ""
+  , "instance P.EvaluationForm EvalPoly where"
+  , "  type CoeffForm EvalPoly = " ++ typeName
+  , "  evalDomainLogSize = " ++ hsModule hs_path_lag ++ ".evalDomainLogSize"
+  , "  evalFormAt        = " ++ hsModule hs_path_lag ++ ".evalAt"
+  , "  fromCoeffForm     = " ++ hsModule hs_path_lag ++ ".fromCoeffForm"
+  , "  toCoeffForm       = " ++ hsModule hs_path_lag ++ ".toCoeffForm"
+  , "  evalFormMul       = " ++ hsModule hs_path_lag ++ ".mul"
+  , ""
+  , "-- | Wraps the values on a subgroup (the size must be a power of two)"
+  , "mkEvalPoly :: FlatArray " ++ typeName_r ++ " -> EvalPoly"
+  , "mkEvalPoly arr"
+  , "  | n >= 1 && exp2_ m == n  = MkEvalPoly m arr"
+  , "  | otherwise               = error \"mkEvalPoly: the size of the array is not a power of two\""
+  , "  where"
+  , "    n = flatArrayLength arr"
+  , "    m = integerLog2 (fromIntegral n)"
+  , ""
+  , "-- | The values on the subgroup"
+  , "evalValues :: EvalPoly -> FlatArray " ++ typeName_r
+  , "evalValues (MkEvalPoly _ arr) = arr"
+  , ""
+  , "-- | @log2@ of the size of the evaluation domain"
+  , "evalDomainLogSize :: EvalPoly -> Log2"
+  , "evalDomainLogSize (MkEvalPoly m _) = m"
+  , ""
+  , "-- | The evaluation domain"
+  , "evalDomain :: EvalPoly -> FFTSubgroup " ++ typeName_r
+  , "evalDomain (MkEvalPoly m _) = cachedSubgroup m"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "foreign import ccall unsafe \"" ++ prefix ++ "fft_domain\"       c_" ++ prefix ++ "fft_domain       :: CInt -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "eval_lagrange_at\" c_" ++ prefix ++ "eval_lagrange_at :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , "foreign import ccall unsafe \"" ++ prefix ++ "ntt_forward\"      c_" ++ prefix ++ "ntt_forward      :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()"
+  , ""
+  , "-- | The subgroups and their elements, indexed by @log2@ of the size"
+  , "-- (these are only computed when first needed)"
+  , "domainCache :: [(FFTSubgroup " ++ typeName_r ++ ", FlatArray " ++ typeName_r ++ ")]"
+  , "domainCache = [ (getFFTSubgroup (Log2 m), makeDomain m) | m <- [0.." ++ show (fst fftDomain) ++ "] ]"
+  , ""
+  , "{-# NOINLINE makeDomain #-}"
+  , "makeDomain :: Int -> FlatArray " ++ typeName_r
+  , "makeDomain m = unsafePerformIO $ do"
+  , "  let n = 2^m"
+  , "  fptr <- mallocForeignPtrArray (n*" ++ show nlimbs ++ ")"
+  , "  withForeignPtr fptr $ \\ptr -> c_" ++ prefix ++ "fft_domain (fromIntegral m) ptr"
+  , "  return (MkFlatArray n fptr)"
+  , ""
+  , "-- | The subgroup of size @2^m@ (cached)"
+  , "cachedSubgroup :: Log2 -> FFTSubgroup " ++ typeName_r
+  , "cachedSubgroup (Log2 m) = fst (domainCache !! m)"
+  , ""
+  , "-- | The elements @[1,g,g^2,...]@ of the subgroup of size @2^m@ (cached)"
+  , "cachedDomain :: Log2 -> FlatArray " ++ typeName_r
+  , "cachedDomain (Log2 m) = snd (domainCache !! m)"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "{-# NOINLINE fromCoeffForm #-}"
+  , "-- | Evaluates a polynomial on the subgroup of size @2^m@."
+  , "-- The degree of the polynomial must be smaller than the size of the subgroup."
+  , "fromCoeffForm :: Log2 -> " ++ typeName ++ " -> EvalPoly"
+  , "fromCoeffForm logm@(Log2 m) poly@(Mk" ++ typeName ++ " (MkFlatArray n1 fptr1))"
+  , "  | Poly.degree poly >= n  = error \"fromCoeffForm: the degree of the polynomial is too large for this domain\""
+  , "  | otherwise              = unsafePerformIO $ do"
+  , "      let k = min n n1"
+  , "      fptr2 <- mallocForeignPtrArray (n*" ++ show nlimbs ++ ")"
+  , "      fptr3 <- mallocForeignPtrArray (n*" ++ show nlimbs ++ ")"
+  , "      withFlat (fftSubgroupGen (cachedSubgroup logm)) $ \\ptr0 -> do"
+  , "        withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "          withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "            withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "              copyBytes ptr2 ptr1 (8*" ++ show nlimbs ++ "*k)"
+  , "              fillBytes (plusPtr ptr2 (8*" ++ show nlimbs ++ "*k)) 0 (8*" ++ show nlimbs ++ "*(n-k))"
+  , "              c_" ++ prefix ++ "ntt_forward (fromIntegral m) ptr0 ptr2 ptr3"
+  , "      return (MkEvalPoly logm (MkFlatArray n fptr3))"
+  , "  where"
+  , "    n = 2^m"
+  , ""
+  , "-- | Interpolates the coefficient form"
+  , "toCoeffForm :: EvalPoly -> " ++ typeName
+  , "toCoeffForm (MkEvalPoly m arr) = Poly.inverseNTT (cachedSubgroup m) arr"
+  , ""
+  , "{-# NOINLINE evalAt #-}"
+  , "-- | Evaluates at an arbitrary location (using the barycentric formula)"
+  , "evalAt :: " ++ typeName_r ++ " -> EvalPoly -> " ++ typeName_r
+  , "evalAt (Mk" ++ typeName_r ++ " fptr1) (MkEvalPoly logm@(Log2 m) (MkFlatArray _ fptr2)) = unsafePerformIO $ do"
+  , "  let MkFlatArray _ fptr0 = cachedDomain logm"
+  , "  fptr3 <- mallocForeignPtrArray " ++ show nlimbs
+  , "  withForeignPtr fptr0 $ \\ptr0 -> do"
+  , "    withForeignPtr fptr1 $ \\ptr1 -> do"
+  , "      withForeignPtr fptr2 $ \\ptr2 -> do"
+  , "        withForeignPtr fptr3 $ \\ptr3 -> do"
+  , "          c_" ++ prefix ++ "eval_lagrange_at (fromIntegral m) ptr0 ptr2 ptr1 ptr3"
+  , "  return (Mk" ++ typeName_r ++ " fptr3)"
+  , ""
+  , "--------------------------------------------------------------------------------"
+  , ""
+  , "pointwise2 :: String -> (FlatArray " ++ typeName_r ++ " -> FlatArray " ++ typeName_r ++ " -> FlatArray " ++ typeName_r ++ ") -> EvalPoly -> EvalPoly -> EvalPoly"
+  , "pointwise2 name f (MkEvalPoly m1 arr1) (MkEvalPoly m2 arr2)"
+  , "  | m1 /= m2   = error (name ++ \": incompatible evaluation domains\")"
+  , "  | otherwise  = MkEvalPoly m1 (f arr1 arr2)"
+  , ""
+  , "-- | Negation"
+  , "neg :: EvalPoly -> EvalPoly"
+  , "neg (MkEvalPoly m arr) = MkEvalPoly m (Arr.neg arr)"
+  , ""
+  , "-- | Addition"
+  , "add :: EvalPoly -> EvalPoly -> EvalPoly"
+  , "add = pointwise2 \"add\" Arr.add"
+  , ""
+  , "-- | Subtraction"
+  , "sub :: EvalPoly -> EvalPoly -> EvalPoly"
+  , "sub = pointwise2 \"sub\" Arr.sub"
+  , ""
+  , "-- | Pointwise multiplication. Note: this is the product modulo @(x^N - 1)@,"
+  , "-- so it agrees with the polynomial product only if the degree of that is less than @N@."
+  , "mul :: EvalPoly -> EvalPoly -> EvalPoly"
+  , "mul = pointwise2 \"mul\" Arr.mul"
+  , ""
+  , "-- | Multiplies by a constant"
+  , "scale :: " ++ typeName_r ++ " -> EvalPoly -> EvalPoly"
+  , "scale c (MkEvalPoly m arr) = MkEvalPoly m (Arr.scale c arr)"
+  ]
+
+
+--------------------------------------------------------------------------------
+
 c_code :: PolyParams -> Code
 c_code params = concat $ map ("":)
   [ cBegin        params
   , cPolyBasics   params
+  , cPolyEval     params
+  , cPolyEvalMany params
   , cPolyDiv      params
   , cDivVanishing params
   , cForwardNTT   params
   , cInverseNTT   params
+  , cPolyMulNTT   params
+  , cPolyFastDiv  params
+  , cPolyMultiEval params
+  , cPolyLagrange  params
   ]
 
 hs_code :: PolyParams -> Code
 hs_code params@(PolyParams{..}) = concat $ map ("":)
   [ hsBegin        params
   , hsPolyBasics   params
+  , hsPolyEvalMany params
   , hsPolyDiv      params
   , hsDivVanishing params
   , hsNTT          params
+  , hsMultiEval    params
   ]
 
 --------------------------------------------------------------------------------
@@ -1146,4 +2168,6 @@ poly_hs_codegen tgtdir params@(PolyParams{..}) = do
   putStrLn $ "writing `" ++ fn_hs ++ "`" 
   writeFile fn_hs $ unlines $ hs_code params
 
+poly_lagrange_hs_codegen :: FilePath -> PolyParams -> IO ()
+
 --------------------------------------------------------------------------------
@@ -86,6 +86,32 @@ c_header (Params{..}) =
   , ""
   , "extern void " ++ prefix ++ "pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );"
   , "extern void " ++ prefix ++ "pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );"
+  , "extern void " ++ prefix ++ "pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );"
+  , ""
+  , "extern void    " ++ prefix ++ "inv_fermat ( const uint64_t *src, uint64_t *tgt );"
+  , "extern uint8_t " ++ prefix ++ "is_square  ( const uint64_t *src );"
+  , "extern uint8_t " ++ prefix ++ "sqrt       ( const uint64_t *src, uint64_t *tgt );"
+  ] ++
+  (if mod thePrime 4 == 3
+    then [ ""
+         , "extern void " ++ prefix ++ "pow_p_plus_1_per_4( const uint64_t *src, uint64_t *tgt );"
+         ]
+    else []
+  ) ++
+  [ ""
+  , "extern void " ++ prefix ++ "neg_ct ( const uint64_t *src ,       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "sqr_ct ( const uint64_t *src ,       uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "mul_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );"
+  , ""
+  , "extern void " ++ prefix ++ "add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );"
+  , "extern void " ++ prefix ++ "sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );"
+  , "extern void " ++ prefix ++ "sqr_inplace_ct ( uint64_t *tgt );"
+  , "extern void " ++ prefix ++ "mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2);"
+  , "extern void " ++ prefix ++ "sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 );"
+  , ""
+  , "extern void " ++ prefix ++ "to_std_ct ( const uint64_t *src , uint64_t *tgt );"
   ]
 
 hsBegin :: Params -> Code
@@ -116,6 +142,8 @@ hsBegin params@(Params{..}) =
   , "  , inv , div , divBy2 , batchInv"
   , "    -- * Exponentiation"
   , "  , pow , pow_"
+  , "    -- * Square roots"
+  , "  , isSquare , squareRoot"
   ] ++ (if isJust fftDomain 
           then [ "    -- * FFT"
                , "  , fftDomain"
@@ -239,6 +267,12 @@ hsBegin params@(Params{..}) =
   , "  batchToStandardRep   = batchToStd"
   , "  batchFromStandardRep = batchFromStd"
   , ""
+  , "-- | The square root of a field element, if it exists"
+  , "squareRoot :: " ++ typeName ++ " -> Maybe " ++ typeName
+  , "squareRoot x = case sqrt_ x of"
+  , "  (y,True) -> Just y"
+  , "  _        -> Nothing"
+  , ""
   ] ++ (case fftDomain of
          Just (siz,gen) ->
            [ "fftDomain :: FFTSubgroup " ++ typeName 
@@ -332,6 +366,9 @@ hsFFI (Params{..}) = catCode $
   , mkffi "divBy2"      $ cfun "div_by_2"         (CTyp [CArgInPtr             , CArgOutPtr ] CRetVoid)
     --
   , mkffi "pow_"        $ cfun "pow_uint64"       (CTyp [CArgInPtr , CArg64    , CArgOutPtr ] CRetVoid)
+    --
+  , mkffi "isSquare"    $ cfun "is_square"        (CTyp [CArgInPtr                          ] CRetBool)
+  , mkffi "sqrt_"       $ cfun "sqrt"             (CTyp [CArgInPtr             , CArgOutPtr ] CRetBool)
   ]
   where
     cfun_ cname = CFun (bigint_   ++ cname)
@@ -392,7 +429,29 @@ addPrime Params{..} =
   , "uint8_t " ++ prefix ++ "" ++ bigint_ ++ "add_prime_plus_1_inplace( uint64_t *tgt ) {"
   , "  return " ++ bigint_ ++ "add_inplace( tgt, " ++ prefix ++ "p_plus_1);"
   , "}"
+  , ""
+  , "// adds the prime p to a bigint if `flag` is set (to 1), inplace, branch-free"
+  , "void " ++ prefix ++ "" ++ bigint_ ++ "add_prime_if_inplace_ct( uint64_t *tgt, uint8_t flag ) {"
+  , "  uint64_t mask = - (uint64_t)flag;"
+  , "  uint8_t  c    = 0;"
+  ] ++
+  [ "  c = addcarry_u64( c, " ++ index j "tgt" ++ ", " ++ showHex64 (ws!!j) ++ " & mask, tgt+" ++ show j ++ " );"
+  | j<-[0..nlimbs-1]
+  ] ++
+  [ "}"
+  , ""
+  , "// adds the prime p to a bigint if `flag` is set (to 1), inplace"
+  , "// (when compiled with CONSTANT_TIME, this is branch-free)"
+  , "void " ++ prefix ++ "" ++ bigint_ ++ "add_prime_if_inplace( uint64_t *tgt, uint8_t flag ) {"
+  , "#ifdef CONSTANT_TIME"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, flag );"
+  , "#else"
+  , "  if (flag) { " ++ prefix ++ bigint_ ++ "add_prime_inplace( tgt ); }"
+  , "#endif"
+  , "}"
   ]
+  where
+    ws = toWord64sLE thePrime
 
 subPrime :: Params -> Code
 subPrime Params{..} = 
@@ -436,14 +495,29 @@ negField Params{..} =
 
 addField :: Params -> Code
 addField Params{..} = 
-  [ "// if (x > prime) then (x - prime) else x"
+  [ "// if (x >= prime) then (x - prime) else x, branch-free"
+  , "void " ++ prefix ++ "" ++ bigint_ ++ "sub_prime_if_above_inplace_ct( uint64_t *tgt ) {"
+  , "  uint8_t b = 0;"
+  ] ++
+  [ "  b = subborrow_u64( b, " ++ index j "tgt" ++ ", " ++ showHex64 (ws!!j) ++ ", tgt+" ++ show j ++ " );"
+  | j<-[0..nlimbs-1]
+  ] ++
+  [ "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, b );  // add it back if x < prime"
+  , "}"
+  , ""
+  , "// if (x >= prime) then (x - prime) else x"
+  , "// (when compiled with CONSTANT_TIME, this is branch-free)"
   , "void " ++ prefix ++ "" ++ bigint_ ++ "sub_prime_if_above_inplace( uint64_t *tgt ) {"
+  , "#ifdef CONSTANT_TIME"
+  , "  " ++ prefix ++ bigint_ ++ "sub_prime_if_above_inplace_ct( tgt );"
+  , "#else"
   ] ++ 
   [ "  if (" ++ index (nlimbs-j-1) "tgt" ++ " <  " ++ showHex64 (ws!!(nlimbs-j-1)) ++ ") return;" ++ "\n" ++
     "  if (" ++ index (nlimbs-j-1) "tgt" ++ gt j   ++ showHex64 (ws!!(nlimbs-j-1)) ++ ") { " ++ prefix ++ bigint_ ++ "sub_prime_inplace( tgt ); return; }"
   | j<-[0..nlimbs-1]
   ] ++ 
-  [ "}"
+  [ "#endif"
+  , "}"
   , ""
   , "// adds two field elements"
   , "void " ++ prefix ++ "add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
@@ -478,21 +552,21 @@ subField Params{..} =
   , "void " ++ prefix ++ "sub( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
   , "  uint8_t b = 0;" 
   , "  b = " ++ bigint_ ++ "sub( src1, src2, tgt );"
-  , "  if (b) { " ++ prefix ++ bigint_ ++ "add_prime_inplace( tgt ); }"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace( tgt, b );"
   , "}"
   , ""
   , "// subtracts two field elements"
   , "void " ++ prefix ++ "sub_inplace( uint64_t *tgt, const uint64_t *src2 ) {"
   , "  uint8_t b = 0;" 
   , "  b = " ++ bigint_ ++ "sub_inplace( tgt, src2 );"
-  , "  if (b) { " ++ prefix ++ bigint_ ++ "add_prime_inplace( tgt ); }"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace( tgt, b );"
   , "}"
   , ""
   , "// tgt := src - tgt"
   , "void " ++ prefix ++ "sub_inplace_reverse( uint64_t *tgt, const uint64_t *src1 ) {"
   , "  uint8_t b = 0;" 
   , "  b = " ++ bigint_ ++ "sub_inplace_reverse( tgt, src1 );"
-  , "  if (b) { " ++ prefix ++ bigint_ ++ "add_prime_inplace( tgt ); }"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace( tgt, b );"
   , "}"
   ]
 
@@ -576,27 +650,13 @@ montREDC Params{..} =
   , "// WARNING: the value in T which will be overwritten!"
   , "//"
   , "void " ++ prefix ++ "REDC_unsafe( uint64_t *T, uint64_t *tgt ) {"
-  , "  T[" ++ show (2*nlimbs) ++ "] = 0;"
-  , "  for(int i=0; i<" ++ show nlimbs ++ "; i++) {"
-  , "    __uint128_t x;"
-  , "    uint64_t c;"
-  , "    uint64_t m = T[i] * " ++ showHex64 (montQ mont) ++ ";"
-  ] ++ concat
-  [ [ "    // j = " ++ show j
-    , "    x = ((__uint128_t)m) * " ++ prefix ++ "prime[" ++ show j ++ "] + T[i+" ++ show j ++ "]" ++ (if (j>0) then " + c" else "") ++ ";    // note: cannot overflow in 128 bits"
-    , "    c = x >> 64;"
-    , "    T[i+" ++ show j ++ "] = (uint64_t) x;"
-    ]
-  | j <- [0..nlimbs-1]
-  ] ++
-  [ "    uint8_t d = addcarry_u64( 0 , T[i+" ++ show nlimbs ++ "] , c , T+i+" ++ show nlimbs ++ " );"
-  , "    for(int j=" ++ show (nlimbs+1) ++ "; (d>0) && (j<=" ++ show (2*nlimbs) ++ "-i); j++) {"
-  , "      d = addcarry_u64( d , T[i+j] , 0 , T+i+j );"
-  , "    }"
-  , "  }"
-  , "  memcpy( tgt, T+" ++ show nlimbs ++ ", " ++ show (nlimbs*8) ++ ");"
-  , "  " ++ prefix ++ "" ++ bigint_ ++ "sub_prime_if_above_inplace(tgt);"
-  , "}"
+  ] ++ redcBody False ++
+  [ "}"
+  , ""
+  , "// the same as above, but always branch-free (no early exit in the carry propagation)"
+  , "void " ++ prefix ++ "REDC_unsafe_ct( uint64_t *T, uint64_t *tgt ) {"
+  ] ++ redcBody True ++
+  [ "}"
   , ""
   , "void " ++ prefix ++ "REDC( const uint64_t *src, uint64_t *tgt ) {"
   , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
@@ -606,6 +666,39 @@ montREDC Params{..} =
   ]
   where
     mont = precalcMontgomery thePrime
+    ct_ b = if b then "_ct" else ""
+
+    redcBody ct =
+      [ "  T[" ++ show (2*nlimbs) ++ "] = 0;"
+      , "  for(int i=0; i<" ++ show nlimbs ++ "; i++) {"
+      , "    __uint128_t x;"
+      , "    uint64_t c;"
+      , "    uint64_t m = T[i] * " ++ showHex64 (montQ mont) ++ ";"
+      ] ++ concat
+      [ [ "    // j = " ++ show j
+        , "    x = ((__uint128_t)m) * " ++ prefix ++ "prime[" ++ show j ++ "] + T[i+" ++ show j ++ "]" ++ (if (j>0) then " + c" else "") ++ ";    // note: cannot overflow in 128 bits"
+        , "    c = x >> 64;"
+        , "    T[i+" ++ show j ++ "] = (uint64_t) x;"
+        ]
+      | j <- [0..nlimbs-1]
+      ] ++
+      [ "    uint8_t d = addcarry_u64( 0 , T[i+" ++ show nlimbs ++ "] , c , T+i+" ++ show nlimbs ++ " );"
+      ] ++
+      (if ct
+        then [ "    for(int j=" ++ show (nlimbs+1) ++ "; j<=" ++ show (2*nlimbs) ++ "-i; j++) {                // no early exit" ]
+        else [ "#ifdef CONSTANT_TIME"
+             , "    for(int j=" ++ show (nlimbs+1) ++ "; j<=" ++ show (2*nlimbs) ++ "-i; j++) {                // no early exit"
+             , "#else"
+             , "    for(int j=" ++ show (nlimbs+1) ++ "; (d>0) && (j<=" ++ show (2*nlimbs) ++ "-i); j++) {"
+             , "#endif"
+             ]
+      ) ++
+      [ "      d = addcarry_u64( d , T[i+j] , 0 , T+i+j );"
+      , "    }"
+      , "  }"
+      , "  memcpy( tgt, T+" ++ show nlimbs ++ ", " ++ show (nlimbs*8) ++ ");"
+      , "  " ++ prefix ++ "" ++ bigint_ ++ "sub_prime_if_above_inplace" ++ ct_ ct ++ "(tgt);"
+      ]
 
 montIsValid :: Params -> Code
 montIsValid Params{..} =
@@ -769,6 +862,199 @@ montConvert Params{..} =
   , "};"
   ]
 
+--------------------------------------------------------------------------------
+-- * branch-free versions
+
+-- | Branch-free versions of the basic operations, independently of whether we
+-- compile with @CONSTANT_TIME@ (used by the constant-time scalar multiplication)
+montConstTime :: Params -> Code
+montConstTime Params{..} =
+  [ "// negates a field element (branch-free)"
+  , "void " ++ prefix ++ "neg_ct( const uint64_t *src, uint64_t *tgt ) {"
+  , "  uint64_t tmp[NLIMBS];"
+  , "  " ++ bigint_ ++ "sub( " ++ prefix ++ "prime, src, tmp );                // p - x"
+  , "  " ++ prefix ++ bigint_ ++ "sub_prime_if_above_inplace_ct( tmp );   // (p - 0) -> 0"
+  , "  memcpy( tgt, tmp, 8*NLIMBS );"
+  , "}"
+  , ""
+  , "// adds two field elements (branch-free)"
+  , "void " ++ prefix ++ "add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  ] ++ reduce_after_add (bigint_ ++ "add( src1, src2, tgt )") ++
+  [ "}"
+  , ""
+  , "// adds two field elements, inplace (branch-free)"
+  , "void " ++ prefix ++ "add_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {"
+  ] ++ reduce_after_add (bigint_ ++ "add_inplace( tgt, src2 )") ++
+  [ "}"
+  , ""
+  , "// subtracts two field elements (branch-free)"
+  , "void " ++ prefix ++ "sub_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {"
+  , "  uint8_t b = 0;"
+  , "  b = " ++ bigint_ ++ "sub( src1, src2, tgt );"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, b );"
+  , "}"
+  , ""
+  , "// subtracts two field elements, inplace (branch-free)"
+  , "void " ++ prefix ++ "sub_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {"
+  , "  uint8_t b = 0;"
+  , "  b = " ++ bigint_ ++ "sub_inplace( tgt, src2 );"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, b );"
+  , "}"
+  , ""
+  , "// tgt := src - tgt (branch-free)"
+  , "void " ++ prefix ++ "sub_inplace_reverse_ct( uint64_t *tgt, const uint64_t *src1 ) {"
+  , "  uint8_t b = 0;"
+  , "  b = " ++ bigint_ ++ "sub_inplace_reverse( tgt, src1 );"
+  , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, b );"
+  , "}"
+  , ""
+  , "void " ++ prefix ++ "sqr_ct( const uint64_t *src, uint64_t *tgt) {"
+  , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
+  , "  " ++ bigint_ ++ "sqr( src, T );"
+  , "  " ++ prefix ++ "REDC_unsafe_ct( T, tgt );"
+  , "};"
+  , ""
+  , "void " ++ prefix ++ "sqr_inplace_ct( uint64_t *tgt ) {"
+  , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
+  , "  " ++ bigint_ ++ "sqr( tgt, T );"
+  , "  " ++ prefix ++ "REDC_unsafe_ct( T, tgt );"
+  , "};"
+  , ""
+  , "void " ++ prefix ++ "mul_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt) {"
+  , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
+  , "  " ++ bigint_ ++ "mul( src1, src2, T );"
+  , "  " ++ prefix ++ "REDC_unsafe_ct( T, tgt );"
+  , "};"
+  , ""
+  , "void " ++ prefix ++ "mul_inplace_ct( uint64_t *tgt, const uint64_t *src2) {"
+  , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
+  , "  " ++ bigint_ ++ "mul( tgt, src2, T );"
+  , "  " ++ prefix ++ "REDC_unsafe_ct( T, tgt );"
+  , "};"
+  , ""
+  , "// convert a field element from Montgomery to standard representation (branch-free)"
+  , "void " ++ prefix ++ "to_std_ct( const uint64_t *src, uint64_t *tgt) {"
+  , "  uint64_t T[" ++ show (2*nlimbs+1) ++ "];"
+  , "  memcpy( T, src, " ++ show (8*nlimbs) ++ ");"
+  , "  memset( T+" ++ show nlimbs ++ ", 0, " ++ show (8*nlimbs) ++ ");"
+  , "  " ++ prefix ++ "REDC_unsafe_ct( T, tgt );"
+  , "};"
+  ]
+  where
+    ws = toWord64sLE thePrime
+    needs_check_carry = ws!!(nlimbs-1) >= 0x8000_0000_0000_0000
+    -- when the sum can overflow, we subtract the prime, and add it back only
+    -- if there was no overflow and the result was below the prime
+    reduce_after_add bigint_add = if needs_check_carry
+      then [ "  uint8_t c = " ++ bigint_add ++ ";"
+           , "  uint8_t b = " ++ prefix ++ bigint_ ++ "sub_prime_inplace( tgt );"
+           , "  " ++ prefix ++ bigint_ ++ "add_prime_if_inplace_ct( tgt, b & (c^1) );"
+           ]
+      else [ "  " ++ bigint_add ++ ";"
+           , "  " ++ prefix ++ bigint_ ++ "sub_prime_if_above_inplace_ct( tgt );"
+           ]
+
+--------------------------------------------------------------------------------
+-- * fixed exponents: Fermat inversion, square roots
+
+-- | @p-1 = 2^S * Q@ with @Q@ odd
+twoAdicDecomposition :: Integer -> (Int,Integer)
+twoAdicDecomposition p = go 0 (p-1) where
+  go !s !q = if even q then go (s+1) (div q 2) else (s,q)
+
+montFixedPow :: Params -> Code
+montFixedPow params@Params{..} = 
+  mkPowChain common "p_minus_2"     "`p-2`"     (thePrime - 2)           ++ [""] ++
+  mkPowChain common "p_minus_1_per_2" "`(p-1)/2`" (div (thePrime - 1) 2) ++ [""] ++
+  [ "// inversion via Fermat's little theorem `1/x = x^(p-2)`. This is slower than the"
+  , "// Euclidean algorithm, but the sequence of operations does not depend on the input."
+  , "// The inverse of zero is zero."
+  , "void " ++ prefix ++ "inv_fermat( const uint64_t *src, uint64_t *tgt ) {"
+  , "  " ++ prefix ++ "pow_p_minus_2( src, tgt );"
+  , "}"
+  , ""
+  , "// checks whether a field element is a square (Euler's criterion). Zero is a square."
+  , "uint8_t " ++ prefix ++ "is_square( const uint64_t *src ) {"
+  , "  if (" ++ prefix ++ "is_zero( src )) return 1;"
+  , "  uint64_t e[" ++ show nlimbs ++ "];"
+  , "  " ++ prefix ++ "pow_p_minus_1_per_2( src, e );"
+  , "  return " ++ prefix ++ "is_one( e );"
+  , "}"
+  , ""
+  ] ++ 
+  (if mod thePrime 4 == 3 then sqrt34 else sqrtTS)
+  where
+    common = toCommonParams params
+    mont   = precalcMontgomery thePrime
+    (twoS,oddQ) = twoAdicDecomposition thePrime
+
+    sqrt34 = 
+      mkPowChain common "p_plus_1_per_4" "`(p+1)/4`" (div (thePrime + 1) 4) ++
+      [ ""
+      , "// computes the square root `x^((p+1)/4)` (here `p = 3 mod 4`); returns 1 if it exists."
+      , "// If there is no square root, the result is set to zero and 0 is returned."
+      , "uint8_t " ++ prefix ++ "sqrt( const uint64_t *src, uint64_t *tgt ) {"
+      , "  uint64_t r[" ++ show nlimbs ++ "];"
+      , "  uint64_t s[" ++ show nlimbs ++ "];"
+      , "  " ++ prefix ++ "pow_p_plus_1_per_4( src, r );"
+      , "  " ++ prefix ++ "sqr( r, s );"
+      , "  if (" ++ prefix ++ "is_equal( s, src )) {"
+      , "    " ++ prefix ++ "copy( r, tgt );"
+      , "    return 1;"
+      , "  }"
+      , "  else {"
+      , "    " ++ prefix ++ "set_zero( tgt );"
+      , "    return 0;"
+      , "  }"
+      , "}"
+      ]
+
+    sqrtTS = 
+      mkPowChain common "q_minus_1_per_2" "`(Q-1)/2`" (div (oddQ - 1) 2) ++
+      [ ""
+      , "// a non-residue raised to the power `Q`, a primitive `2^" ++ show twoS ++ "`-th root of unity"
+      , mkConst nlimbs (prefix ++ "sqrt_z") (mod (powMod primGen oddQ thePrime * montR mont) thePrime)
+      , ""
+      , "// computes a square root using the Tonelli-Shanks algorithm, where `p-1 = 2^S * Q`"
+      , "// with `S = " ++ show twoS ++ "`; returns 1 if it exists. If there is no square root,"
+      , "// the result is set to zero and 0 is returned."
+      , "uint8_t " ++ prefix ++ "sqrt( const uint64_t *src, uint64_t *tgt ) {"
+      , "  if (" ++ prefix ++ "is_zero( src )) {"
+      , "    " ++ prefix ++ "set_zero( tgt );"
+      , "    return 1;"
+      , "  }"
+      , "  uint64_t w[" ++ show nlimbs ++ "];"
+      , "  uint64_t r[" ++ show nlimbs ++ "];"
+      , "  uint64_t t[" ++ show nlimbs ++ "];"
+      , "  uint64_t c[" ++ show nlimbs ++ "];"
+      , "  uint64_t b[" ++ show nlimbs ++ "];"
+      , "  " ++ prefix ++ "pow_q_minus_1_per_2( src, w );     // w = x^((Q-1)/2)"
+      , "  " ++ prefix ++ "mul( src, w, r );                   // r = x^((Q+1)/2)"
+      , "  " ++ prefix ++ "mul( r  , w, t );                   // t = x^Q"
+      , "  " ++ prefix ++ "copy( " ++ prefix ++ "sqrt_z, c );"
+      , "  int m = " ++ show twoS ++ ";"
+      , "  while (!" ++ prefix ++ "is_one( t )) {"
+      , "    // find the smallest `i` such that `t^(2^i) = 1`"
+      , "    int i = 0;"
+      , "    " ++ prefix ++ "copy( t, b );"
+      , "    while ((i < m) && !" ++ prefix ++ "is_one( b )) { " ++ prefix ++ "sqr_inplace( b ); i++; }"
+      , "    if (i == m) {"
+      , "      // not a square"
+      , "      " ++ prefix ++ "set_zero( tgt );"
+      , "      return 0;"
+      , "    }"
+      , "    " ++ prefix ++ "copy( c, b );"
+      , "    for(int k=0; k<m-i-1; k++) { " ++ prefix ++ "sqr_inplace( b ); }"
+      , "    " ++ prefix ++ "mul_inplace( r, b );"
+      , "    " ++ prefix ++ "sqr( b, c );"
+      , "    " ++ prefix ++ "mul_inplace( t, c );"
+      , "    m = i;"
+      , "  }"
+      , "  " ++ prefix ++ "copy( r, tgt );"
+      , "  return 1;"
+      , "}"
+      ]
+
 --------------------------------------------------------------------------------
 
 c_code :: Params -> Code
@@ -789,10 +1075,13 @@ c_code params = concat $ map ("":)
     --
   , exponentiation (toCommonParams params)
   , batchInverse   (toCommonParams params)
+  , montFixedPow   params
     --
   , montIsValid params
   , montIsOne   params
   , montConvert params
+    --
+  , montConstTime params
   ]
 
 hs_code :: Params -> Code
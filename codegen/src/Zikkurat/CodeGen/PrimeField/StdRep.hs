@@ -81,6 +81,7 @@ c_header (Params{..}) =
   , ""
   , "extern void " ++ prefix ++ "pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );"
   , "extern void " ++ prefix ++ "pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );"
+  , "extern void " ++ prefix ++ "pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );"
   , ""
   ]
 
@@ -9,9 +9,11 @@ module Zikkurat.Generate
   , generate_curves_affine
   , generate_curves_proj
   , generate_curves_jac
+  , generate_curves_xyzz
   , generate_curves_poly
   , generate_curves_array
   , generate_curves_pairing
+  , generate_curves_gt
   , generate_reexports
   ) 
   where
@@ -26,6 +28,7 @@ import System.FilePath
 import System.Directory
 
 import qualified Zikkurat.CodeGen.Platform              as Platform
+import qualified Zikkurat.CodeGen.Hash                  as Hash
 import qualified Zikkurat.CodeGen.BigInt                as BigInt
 import qualified Zikkurat.CodeGen.PrimeField.StdRep     as FpStd
 import qualified Zikkurat.CodeGen.PrimeField.Montgomery as FpMont
@@ -34,7 +37,9 @@ import qualified Zikkurat.CodeGen.Towers                as Tow
 import qualified Zikkurat.CodeGen.Curve.MontAffine      as Affine
 import qualified Zikkurat.CodeGen.Curve.MontProj        as Proj
 import qualified Zikkurat.CodeGen.Curve.MontJac         as Jac
+import qualified Zikkurat.CodeGen.Curve.MontXYZZ        as XYZZ
 import qualified Zikkurat.CodeGen.Curve.Pairing         as Pairing
+import qualified Zikkurat.CodeGen.Curve.GT              as GT
 import qualified Zikkurat.CodeGen.Curve.ReExport        as RE
 import qualified Zikkurat.CodeGen.Poly                  as Poly
 import qualified Zikkurat.CodeGen.Pointwise             as PW
@@ -67,6 +72,10 @@ generate_platform hsOrC tgtdir = do
       createDirectoryIfMissing True c_tgtdir
       writeFile (c_tgtdir </> "platform.h") (unlines Platform.add_with_carry_header)
       writeFile (c_tgtdir </> "platform.c") (unlines Platform.add_with_carry_wrapper)
+      writeFile (c_tgtdir </> "parallel.h") (unlines Platform.parallel_header)
+      writeFile (c_tgtdir </> "parallel.c") (unlines Platform.parallel_c)
+      writeFile (c_tgtdir </> "sha256.h"  ) (unlines Hash.sha256_header)
+      writeFile (c_tgtdir </> "sha256.c"  ) (unlines Hash.sha256_c)
     Hs -> do
       createDirectoryIfMissing True hs_tgtdir
       writeFile (hs_tgtdir </> "Platform.hs") (unlines Platform.hsAddCarry)
@@ -224,8 +233,11 @@ bn128_cgParams_G1 = CodeGenParams
   , prefix_affine  = "bn128_G1_affine_"                                          -- prefix for C names
   , prefix_proj    = "bn128_G1_proj_"                                            -- prefix for C names
   , prefix_jac     = "bn128_G1_jac_"                                             -- prefix for C names
+  , prefix_xyzz    = "bn128_G1_xyzz_"                                            -- prefix for C names
   , prefix_p       = "bn128_Fp_mont_"                                            -- prefix for C names for Fp
+  , prefix_fp      = "bn128_Fp_mont_"                                            -- prefix for C names for the prime field Fp
   , prefix_r       = "bn128_Fr_mont_"                                            -- prefix for C names for Fq
+  , prefix_arr_r   = "bn128_arr_mont_"                                           -- prefix for C names for arrays of Fr elements
   , point_repr     = error "bn128 / point_repr"                                  -- one of "affine", "proj" or "jac"
   , nlimbs_p       = 4                                                           -- number of 64-bit limbs in p
   , nlimbs_r       = 4                                                           -- number of 64-bit limbs in r
@@ -238,12 +250,15 @@ bn128_cgParams_G1 = CodeGenParams
   , c_path_affine  = Path ["curves","g1","affine","bn128_G1_affine"]               -- path of the C file
   , c_path_proj    = Path ["curves","g1","proj"  ,"bn128_G1_proj"]                 -- path of the C file
   , c_path_jac     = Path ["curves","g1","jac"   ,"bn128_G1_jac"]                  -- path of the C file
+  , c_path_xyzz    = Path ["curves","g1","xyzz"  ,"bn128_G1_xyzz"]                 -- path of the C file
   , hs_path        = error "bn128 / hs_path"
   , hs_path_affine = Path ["ZK","Algebra","Curves","BN128","G1","Affine"]        -- path of the Haskell module
   , hs_path_proj   = Path ["ZK","Algebra","Curves","BN128","G1","Proj"]          -- path of the Haskell module
   , hs_path_jac    = Path ["ZK","Algebra","Curves","BN128","G1","Jac"]           -- path of the Haskell module
   , c_basename_p   = "bn128_Fp_mont"                                             -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_fp  = "bn128_Fp_mont"                                             -- name of the @.c@ / @.h@ file for the prime field Fp (without extension)
   , c_basename_r   = "bn128_Fr_mont"                                             -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_arr_r = "bn128_arr_mont"                                          -- name of the @.c@ / @.h@ file for arrays of Fr elements (without extension)
   , typeName       = "G1"                                                        -- the name of the haskell type for curve points
   }
 
@@ -253,8 +268,11 @@ bn128_cgParams_G2 = CodeGenParams
   , prefix_affine  = "bn128_G2_affine_"                                          -- prefix for C names
   , prefix_proj    = "bn128_G2_proj_"                                            -- prefix for C names
   , prefix_jac     = "bn128_G2_jac_"                                             -- prefix for C names
+  , prefix_xyzz    = "bn128_G2_xyzz_"                                            -- prefix for C names
   , prefix_p       = "bn128_Fp2_mont_"                                           -- prefix for C names for Fp
+  , prefix_fp      = "bn128_Fp_mont_"                                            -- prefix for C names for the prime field Fp
   , prefix_r       = "bn128_Fr_mont_"                                            -- prefix for C names for Fq
+  , prefix_arr_r   = "bn128_arr_mont_"                                           -- prefix for C names for arrays of Fr elements
   , point_repr     = error "bn128 / point_repr"                                  -- one of "affine", "proj" or "jac"
   , nlimbs_p       = 8                                                           -- number of 64-bit limbs in p
   , nlimbs_r       = 4                                                           -- number of 64-bit limbs in r
@@ -267,12 +285,15 @@ bn128_cgParams_G2 = CodeGenParams
   , c_path_affine  = Path ["curves","g2","affine","bn128_G2_affine"]               -- path of the C file
   , c_path_proj    = Path ["curves","g2","proj"  ,"bn128_G2_proj"]                 -- path of the C file
   , c_path_jac     = Path ["curves","g2","jac"   ,"bn128_G2_jac"]                  -- path of the C file
+  , c_path_xyzz    = Path ["curves","g2","xyzz"  ,"bn128_G2_xyzz"]                 -- path of the C file
   , hs_path        = error "bn128 / hs_path"
   , hs_path_affine = Path ["ZK","Algebra","Curves","BN128","G2","Affine"]        -- path of the Haskell module
   , hs_path_proj   = Path ["ZK","Algebra","Curves","BN128","G2","Proj"]          -- path of the Haskell module
   , hs_path_jac    = Path ["ZK","Algebra","Curves","BN128","G2","Jac"]           -- path of the Haskell module
   , c_basename_p   = "bn128_Fp2_mont"                                            -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_fp  = "bn128_Fp_mont"                                             -- name of the @.c@ / @.h@ file for the prime field Fp (without extension)
   , c_basename_r   = "bn128_Fr_mont"                                             -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_arr_r = "bn128_arr_mont"                                          -- name of the @.c@ / @.h@ file for arrays of Fr elements (without extension)
   , typeName       = "G2"                                                        -- the name of the haskell type for curve points
   }
 
@@ -285,9 +306,12 @@ bn128_polyParams = Poly.PolyParams
   , Poly.c_path_r   = Path ["curves","fields", "mont", "bn128_Fr_mont" ]
   , Poly.hs_path    = Path ["ZK","Algebra","Curves","BN128","Poly"]
   , Poly.hs_path_r  = Path ["ZK","Algebra","Curves","BN128","Fr","Mont"] 
+  , Poly.hs_path_arr = Path ["ZK","Algebra","Curves","BN128","Array"]
+  , Poly.hs_path_lag = Path ["ZK","Algebra","Curves","BN128","Poly","Lagrange"]
   , Poly.typeName   = "Poly" 
   , Poly.typeName_r = "Fr"
   , Poly.prime_r    = bn128_scalar_r   
+  , Poly.fftDomain  = domain_BN128
   }
 
 bn128_pwParams :: PwParams 
@@ -320,8 +344,11 @@ bls12_381_cgParams_G1 = CodeGenParams
   , prefix_affine  = "bls12_381_G1_affine_"                                      -- prefix for C names
   , prefix_proj    = "bls12_381_G1_proj_"                                        -- prefix for C names
   , prefix_jac     = "bls12_381_G1_jac_"                                         -- prefix for C names
+  , prefix_xyzz    = "bls12_381_G1_xyzz_"                                        -- prefix for C names
   , prefix_p       = "bls12_381_Fp_mont_"                                        -- prefix for C names for Fp
+  , prefix_fp      = "bls12_381_Fp_mont_"                                        -- prefix for C names for the prime field Fp
   , prefix_r       = "bls12_381_Fr_mont_"                                        -- prefix for C names for Fq
+  , prefix_arr_r   = "bls12_381_arr_mont_"                                       -- prefix for C names for arrays of Fr elements
   , point_repr     = error "bn128 / point_repr"                                  -- one of "affine", "proj" or "jac"
   , nlimbs_p       = 6                                                           -- number of 64-bit limbs in p
   , nlimbs_r       = 4                                                           -- number of 64-bit limbs in r
@@ -334,12 +361,15 @@ bls12_381_cgParams_G1 = CodeGenParams
   , c_path_affine  = Path ["curves","g1","affine","bls12_381_G1_affine"]           -- path of the C file
   , c_path_proj    = Path ["curves","g1","proj"  ,"bls12_381_G1_proj"]             -- path of the C file
   , c_path_jac     = Path ["curves","g1","jac"   ,"bls12_381_G1_jac"]              -- path of the C file
+  , c_path_xyzz    = Path ["curves","g1","xyzz"  ,"bls12_381_G1_xyzz"]             -- path of the C file
   , hs_path        = error "bls12_381 / hs_path"
   , hs_path_affine = Path ["ZK","Algebra","Curves","BLS12_381","G1","Affine"]    -- path of the Haskell module
   , hs_path_proj   = Path ["ZK","Algebra","Curves","BLS12_381","G1","Proj"]      -- path of the Haskell module
   , hs_path_jac    = Path ["ZK","Algebra","Curves","BLS12_381","G1","Jac"]       -- path of the Haskell module
   , c_basename_p   = "bls12_381_Fp_mont"                                         -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_fp  = "bls12_381_Fp_mont"                                         -- name of the @.c@ / @.h@ file for the prime field Fp (without extension)
   , c_basename_r   = "bls12_381_Fr_mont"                                         -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_arr_r = "bls12_381_arr_mont"                                      -- name of the @.c@ / @.h@ file for arrays of Fr elements (without extension)
   , typeName       = "G1"                                                        -- the name of the haskell type for curve points
   }
 
@@ -349,8 +379,11 @@ bls12_381_cgParams_G2 = CodeGenParams
   , prefix_affine  = "bls12_381_G2_affine_"                                      -- prefix for C names
   , prefix_proj    = "bls12_381_G2_proj_"                                        -- prefix for C names
   , prefix_jac     = "bls12_381_G2_jac_"                                         -- prefix for C names
+  , prefix_xyzz    = "bls12_381_G2_xyzz_"                                        -- prefix for C names
   , prefix_p       = "bls12_381_Fp2_mont_"                                       -- prefix for C names for Fp
+  , prefix_fp      = "bls12_381_Fp_mont_"                                        -- prefix for C names for the prime field Fp
   , prefix_r       = "bls12_381_Fr_mont_"                                        -- prefix for C names for Fq
+  , prefix_arr_r   = "bls12_381_arr_mont_"                                       -- prefix for C names for arrays of Fr elements
   , point_repr     = error "bn128 / point_repr"                                  -- one of "affine", "proj" or "jac"
   , nlimbs_p       = 12                                                          -- number of 64-bit limbs in p
   , nlimbs_r       = 4                                                           -- number of 64-bit limbs in r
@@ -363,12 +396,15 @@ bls12_381_cgParams_G2 = CodeGenParams
   , c_path_affine  = Path ["curves","g2","affine","bls12_381_G2_affine"]           -- path of the C file
   , c_path_proj    = Path ["curves","g2","proj"  ,"bls12_381_G2_proj"]             -- path of the C file
   , c_path_jac     = Path ["curves","g2","jac"   ,"bls12_381_G2_jac"]              -- path of the C file
+  , c_path_xyzz    = Path ["curves","g2","xyzz"  ,"bls12_381_G2_xyzz"]             -- path of the C file
   , hs_path        = error "bls12_381 / hs_path"
   , hs_path_affine = Path ["ZK","Algebra","Curves","BLS12_381","G2","Affine"]    -- path of the Haskell module
   , hs_path_proj   = Path ["ZK","Algebra","Curves","BLS12_381","G2","Proj"]      -- path of the Haskell module
   , hs_path_jac    = Path ["ZK","Algebra","Curves","BLS12_381","G2","Jac"]       -- path of the Haskell module
   , c_basename_p   = "bls12_381_Fp2_mont"                                        -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_fp  = "bls12_381_Fp_mont"                                         -- name of the @.c@ / @.h@ file for the prime field Fp (without extension)
   , c_basename_r   = "bls12_381_Fr_mont"                                         -- name of the @.c@ / @.h@ file for Fr (without extension)
+  , c_basename_arr_r = "bls12_381_arr_mont"                                      -- name of the @.c@ / @.h@ file for arrays of Fr elements (without extension)
   , typeName       = "G2"                                                        -- the name of the haskell type for curve points
   }
 
@@ -381,9 +417,12 @@ bls12_381_polyParams = Poly.PolyParams
   , Poly.c_path_r   = Path ["curves","fields", "mont", "bls12_381_Fr_mont" ]
   , Poly.hs_path    = Path ["ZK","Algebra","Curves","BLS12_381","Poly"]
   , Poly.hs_path_r  = Path ["ZK","Algebra","Curves","BLS12_381","Fr","Mont"] 
+  , Poly.hs_path_arr = Path ["ZK","Algebra","Curves","BLS12_381","Array"]
+  , Poly.hs_path_lag = Path ["ZK","Algebra","Curves","BLS12_381","Poly","Lagrange"]
   , Poly.typeName   = "Poly" 
   , Poly.typeName_r = "Fr"
   , Poly.prime_r    = bls12_381_scalar_r
+  , Poly.fftDomain  = domain_BLS12_381
   }
 
 bls12_381_pwParams :: PwParams 
@@ -414,7 +453,9 @@ generate_curves_poly hsOrC tgtdir = do
   forM_ curveList $ \(curve,_,polyparams,_) -> do
     case hsOrC of 
       C  -> Poly.poly_c_codegen  tgtdir polyparams
-      Hs -> Poly.poly_hs_codegen tgtdir polyparams
+      Hs -> do
+        Poly.poly_hs_codegen          tgtdir polyparams
+        Poly.poly_lagrange_hs_codegen tgtdir polyparams
 
 generate_curves_array :: HsOrC -> FilePath -> IO ()
 generate_curves_array hsOrC tgtdir = do
@@ -433,6 +474,16 @@ generate_curves_pairing hsOrC tgtdir = do
       C  -> Pairing.curve_pairing_c_codegen  tgtdir params
       Hs -> Pairing.curve_pairing_hs_codegen tgtdir params
 
+generate_curves_gt :: HsOrC -> FilePath -> IO ()
+generate_curves_gt hsOrC tgtdir = do
+  let list = [ Pairing.pairingParams_BN128 
+             , Pairing.pairingParams_BLS12_381
+             ]
+  forM_ list $ \params -> do
+    case hsOrC of 
+      C  -> GT.curve_gt_c_codegen  tgtdir params
+      Hs -> GT.curve_gt_hs_codegen tgtdir params
+
 generate_reexports :: HsOrC -> FilePath -> IO ()
 generate_reexports hsOrC tgtdir = do
   let list = [ bn128_reexport
@@ -501,13 +552,47 @@ generate_curves_jac hsOrC tgtdir = do
       (Left curve1, Left cg1) -> do
         let cgparams1 = local_cgparams cg1
         case hsOrC of 
-          C  -> Jac.curve_MontJac_c_codegen  tgtdir curve1 cgparams1
-          Hs -> Jac.curve_MontJac_hs_codegen tgtdir curve1 cgparams1
+          C  -> Jac.curve_MontJac_c_codegen  tgtdir (Left curve1) cgparams1
+          Hs -> Jac.curve_MontJac_hs_codegen tgtdir (Left curve1) cgparams1
+
+      -- we have both G1 and G2 curves
       (Right curve12@(Curve12 curve1 curve2) , Right (cg1,cg2)) -> do
+        let cgparams1 = local_cgparams cg1
+        let cgparams2 = local_cgparams cg2
+        case hsOrC of 
+          C  -> do
+            Jac.curve_MontJac_c_codegen  tgtdir (Left  curve1 ) cgparams1   -- G1
+            Jac.curve_MontJac_c_codegen  tgtdir (Right curve12) cgparams2   -- G2
+          Hs -> do
+            Jac.curve_MontJac_hs_codegen tgtdir (Left  curve1 ) cgparams1
+            Jac.curve_MontJac_hs_codegen tgtdir (Right curve12) cgparams2
+
+-- | XYZZ coordinates are only used internally (for MSM buckets), so there are no Haskell bindings
+generate_curves_xyzz :: HsOrC -> FilePath -> IO ()
+generate_curves_xyzz hsOrC tgtdir = do
+  let local_cgparams cgparams0 = cgparams0 
+          { prefix  = prefix_xyzz  cgparams0
+          , c_path  = c_path_xyzz  cgparams0 
+          , point_repr = "xyzz"
+          }
+  forM_ curveList $ \(xcurve,xcgparams,_,_) -> do
+    case (xcurve,xcgparams) of
+
+      (Left curve1, Left cg1) -> do
         let cgparams1 = local_cgparams cg1
         case hsOrC of 
-          C  -> Jac.curve_MontJac_c_codegen  tgtdir curve1 cgparams1
-          Hs -> Jac.curve_MontJac_hs_codegen tgtdir curve1 cgparams1
+          C  -> XYZZ.curve_MontXYZZ_c_codegen tgtdir (Left curve1) cgparams1
+          Hs -> return ()
+
+      -- we have both G1 and G2 curves
+      (Right curve12@(Curve12 curve1 curve2), Right (cg1,cg2)) -> do
+        let cgparams1 = local_cgparams cg1
+        let cgparams2 = local_cgparams cg2
+        case hsOrC of 
+          C  -> do 
+            XYZZ.curve_MontXYZZ_c_codegen tgtdir (Left  curve1 ) cgparams1   -- G1 
+            XYZZ.curve_MontXYZZ_c_codegen tgtdir (Right curve12) cgparams2   -- G2
+          Hs -> return ()
 
 generate_curves_affine :: HsOrC -> FilePath -> IO ()
 generate_curves_affine hsOrC tgtdir = do
@@ -1,130 +1,24 @@
 
 {-# LANGUAGE 
       ScopedTypeVariables, TypeFamilies, DataKinds, KindSignatures,
-      BangPatterns, StandaloneDeriving
+      BangPatterns, TypeApplications
   #-}
 module KZG where
 
 --------------------------------------------------------------------------------
 
 import Data.Proxy
-import Data.Kind
 
 import Control.Monad
 
 import ZK.Algebra.API
 import ZK.Algebra.Class.Pairing
+import ZK.Algebra.KZG
 
 import qualified ZK.Algebra.Curves.BN128 as BN128
 
 --------------------------------------------------------------------------------
 
-data KZGSetup (c :: SomeCurve) = MkKZGSetup 
-  { _kzgDomain    :: FFTDomain (Fr c)
-  , _tauG1s       :: FlatArray (G1 c)
-  , _lagrangeTaus :: FlatArray (G1 c)
-  , _g2TauG2      :: (G2 c, G2 c)
-  }
-
-data VerifierKey (c :: SomeCurve) = VerifKey 
-  { _g1   :: !(G1 c)
-  , _g2   :: !(G2 c)
-  , _tau2 :: !(G2 c)
-  }
-
-extractVerifierKey :: forall c. PairingCurve c => KZGSetup c -> VerifierKey c
-extractVerifierKey setup = VerifKey g1 g2 tau2 where
-  g1 = peekFlatArray (_tauG1s setup) 0
-  (g2,tau2) = _g2TauG2 setup
-
---------------------------------------------------------------------------------
-
-mkKZGSetup :: forall c. PairingCurve c => Proxy c -> Fr c -> Log2 -> KZGSetup c
-mkKZGSetup pxy tau m = setup where
- 
-  n      = exp2_ m
-  dom    = getFFTDomain m
-  tauG1s = packFlatArrayFromList' n (taus tau n)
-
-  g1 = curveSubgroupGen :: G1 c
-  g2 = curveSubgroupGen :: G2 c
- 
-  setup = MkKZGSetup 
-    { _kzgDomain    = dom
-    , _tauG1s       = tauG1s
-    , _lagrangeTaus = curveIFFT dom tauG1s
-    , _g2TauG2      = (g2, tau <**> g2)
-    } 
-
-  taus :: Fr c -> Int -> [G1 c]
-  taus !tau n = go n 1 where
-    go 0 _    = []
-    go k !acc = acc <**> g1 : go (k-1) (tau*acc)
-
-newKZGSetup :: forall c. PairingCurve c => Proxy c -> Log2 -> IO (KZGSetup c)
-newKZGSetup pxy m = do
-  tau <- rndIO 
-  return $ mkKZGSetup pxy tau m
-
---------------------------------------------------------------------------------
-
-newtype Commitment c 
-  = Com (G1 c)
-  
-deriving instance PairingCurve c => Eq   (Commitment c)
-deriving instance PairingCurve c => Show (Commitment c)
-
-commitPoly :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> Poly c -> Commitment c
-commitPoly pxy setup poly = (Com com) where
-  coeffs = unwrapArray poly
-  tauG1s = takeFlatArray (flatArrayLength coeffs) (_tauG1s setup)
-  com    = msm coeffs tauG1s
-
-commitValues :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> FlatArray (Fr c) -> Commitment c
-commitValues pxy setup values
-  | fftDomainSize dom == flatArrayLength values = (Com com)
-  | otherwise = error "commitValues: expecting a vector of the same size as the KZG setup domain" 
-  where
-    com = msm values (_lagrangeTaus setup)
-    dom = _kzgDomain setup
-  
-commitInterpolate :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> FlatArray (Fr c) -> Commitment c
-commitInterpolate pxy setup values 
-  | fftDomainSize dom == flatArrayLength values = com
-  | otherwise = error "commitInterpolate: expecting a vector of the same size as the KZG setup domain" 
-  where
-    com = commitPoly pxy setup (intt dom values)
-    dom = _kzgDomain setup
-
---------------------------------------------------------------------------------
-
-data Opening c = Opening
-  { _location :: !(Fr c) 
-  , _value    :: !(Fr c)
-  , _proof    :: !(G1 c)
-  }
-
-deriving instance PairingCurve c => Eq   (Opening c)
-deriving instance PairingCurve c => Show (Opening c)
-
-openingProof :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> Poly c -> Fr c -> Opening c
-openingProof pxy setup poly loc = Opening loc val prf where 
-  val = evalAt loc poly
-  mb  = quotByVanishing (poly - constPoly val) (1,loc)   -- divide (p-val) by (x-loc)
-  prf = case mb of
-    Just q  -> let Com prf = commitPoly pxy setup q in prf
-    Nothing -> error "openingProof: fatal error, should not happen" 
-
---------------------------------------------------------------------------------
-
-verifyProof :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> Commitment c -> Opening c -> Bool
-verifyProof pxy (VerifKey g1 g2 tau2) (Com comP) (Opening x0 y0 comQ) = (lhs == rhs) where
-  lhs = pairing pxy comQ  tau2
-  rhs = pairing pxy point g2 
-  point = comP <+> (scalarMul x0 comQ <-> scalarMul y0 g1)
-
---------------------------------------------------------------------------------
-
 main :: IO ()
 main = do
   let pxy = Proxy @BN128
@@ -147,5 +41,16 @@ main = do
   putStrLn $ "y0 = " ++ show (_value prf)
   let ok = verifyProof pxy vkey com1 prf
   putStrLn $ "verificiation succeeded: " ++ show ok
+  locs <- replicateM 10 rndIO :: IO [BN128.Fr]
+  let prfs = [ openingProof pxy setup poly x | x <- locs ]
+  let bad  = (prfs!!7) { _value = _value (prfs!!7) + 1 }
+  let items1 = [ (com1,p) | p <- prfs ]
+  let items2 = [ (com1,p) | p <- take 7 prfs ++ [bad] ++ drop 8 prfs ]
+  ok1 <- batchVerifyProofs pxy vkey items1
+  ok2 <- batchVerifyProofs pxy vkey items2
+  putStrLn $ "batch verification of valid proofs succeeded: " ++ show ok1
+  putStrLn $ "batch verification with an invalid proof succeeded: " ++ show ok2
+  idxs <- batchVerifyProofsBisect pxy vkey items2
+  putStrLn $ "the invalid proofs are: " ++ show idxs
 
 --------------------------------------------------------------------------------
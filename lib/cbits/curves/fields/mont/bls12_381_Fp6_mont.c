@@ -351,34 +351,169 @@ void bls12_381_Fp6_mont_frobenius_inplace ( uint64_t *tgt ) {
   bls12_381_Fp6_mont_frobenius( tgt, tgt );
 }
 
-// computes `x^e mod p`
-void bls12_381_Fp6_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[36];
-  bls12_381_Fp6_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fp6_mont_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bls12_381_Fp6_mont_mul_inplace(tgt, sqr); }
-    bls12_381_Fp6_mont_mul_inplace(sqr, sqr);
-    e = e >> 1;
+
+const uint64_t bls12_381_Fp6_mont_frobenius_2_sparse_indices[6] = 
+  { 0x0000000000000000, 0x0000000000010001, 0x0000000000020002, 0x0000000000030003, 0x0000000000040004, 0x0000000000050005
+  };
+
+
+const uint64_t bls12_381_Fp6_mont_frobenius_2_sparse_entries[36] = 
+  { 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  , 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  , 0x30f1361b798a64e8, 0xf3b8ddab7ece5a2a, 0x16a8ca3ac61577f7, 0xc26a2ff874fd029b, 0x3636b76660701c6e, 0x051ba4ab241b6160
+  , 0x30f1361b798a64e8, 0xf3b8ddab7ece5a2a, 0x16a8ca3ac61577f7, 0xc26a2ff874fd029b, 0x3636b76660701c6e, 0x051ba4ab241b6160
+  , 0xcd03c9e48671f071, 0x5dab22461fcda5d2, 0x587042afd3851b95, 0x8eb60ebe01bacb9e, 0x03f97d6e83d050d2, 0x18f0206554638741
+  , 0xcd03c9e48671f071, 0x5dab22461fcda5d2, 0x587042afd3851b95, 0x8eb60ebe01bacb9e, 0x03f97d6e83d050d2, 0x18f0206554638741
+  };
+
+
+// computes `x^(p^2)` directly
+void bls12_381_Fp6_mont_frobenius_2 ( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t acc[EXT_NWORDS];
+  uint64_t tmp[PRIME_NWORDS];
+  bls12_381_Fp6_mont_set_zero(acc);
+  for(int k=0; k<6; k++) {
+    uint64_t ij = bls12_381_Fp6_mont_frobenius_2_sparse_indices[k];
+    uint64_t i  = (ij >> 16);
+    uint64_t j  = (ij &  0xffff);
+    bls12_381_Fp_mont_mul( src + i*PRIME_NWORDS , bls12_381_Fp6_mont_frobenius_2_sparse_entries + k*PRIME_NWORDS , tmp );
+    bls12_381_Fp_mont_add_inplace( acc + j*PRIME_NWORDS , tmp );
   }
+  bls12_381_Fp6_mont_copy( acc, tgt );
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+void bls12_381_Fp6_mont_frobenius_2_inplace ( uint64_t *tgt ) {
+  bls12_381_Fp6_mont_frobenius_2( tgt, tgt );
+}
+
+const uint64_t bls12_381_Fp6_mont_frobenius_3_sparse_indices[6] = 
+  { 0x0000000000000000, 0x0000000000010001, 0x0000000000020003, 0x0000000000030002, 0x0000000000040004, 0x0000000000050005
+  };
+
+
+const uint64_t bls12_381_Fp6_mont_frobenius_3_sparse_entries[36] = 
+  { 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  , 0x43f5fffffffcaaae, 0x32b7fff2ed47fffd, 0x07e83a49a2e99d69, 0xeca8f3318332bb7a, 0xef148d1ea0f4c069, 0x040ab3263eff0206
+  , 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  , 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  , 0x43f5fffffffcaaae, 0x32b7fff2ed47fffd, 0x07e83a49a2e99d69, 0xeca8f3318332bb7a, 0xef148d1ea0f4c069, 0x040ab3263eff0206
+  , 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493
+  };
+
+
+// computes `x^(p^3)` directly
+void bls12_381_Fp6_mont_frobenius_3 ( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t acc[EXT_NWORDS];
+  uint64_t tmp[PRIME_NWORDS];
+  bls12_381_Fp6_mont_set_zero(acc);
+  for(int k=0; k<6; k++) {
+    uint64_t ij = bls12_381_Fp6_mont_frobenius_3_sparse_indices[k];
+    uint64_t i  = (ij >> 16);
+    uint64_t j  = (ij &  0xffff);
+    bls12_381_Fp_mont_mul( src + i*PRIME_NWORDS , bls12_381_Fp6_mont_frobenius_3_sparse_entries + k*PRIME_NWORDS , tmp );
+    bls12_381_Fp_mont_add_inplace( acc + j*PRIME_NWORDS , tmp );
+  }
+  bls12_381_Fp6_mont_copy( acc, tgt );
+}
+
+void bls12_381_Fp6_mont_frobenius_3_inplace ( uint64_t *tgt ) {
+  bls12_381_Fp6_mont_frobenius_3( tgt, tgt );
+}
+
+// computes `x^(p^k)` for `k >= 0`
+void bls12_381_Fp6_mont_frobenius_k ( const uint64_t *src, int k, uint64_t *tgt ) {
+  bls12_381_Fp6_mont_copy( src, tgt );
+  k = k % PRIME_DEGREE;
+  while (k >= 3) { bls12_381_Fp6_mont_frobenius_3_inplace( tgt ); k -= 3; }
+  while (k >= 2) { bls12_381_Fp6_mont_frobenius_2_inplace( tgt ); k -= 2; }
+  if    (k == 1) { bls12_381_Fp6_mont_frobenius_inplace( tgt ); }
+}
+
+
+// the sliding window size used for exponents of the given bit length
+int bls12_381_Fp6_mont_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bls12_381_Fp6_mont_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[36];
+  bls12_381_Fp6_mont_copy( src, table );
+  if (w > 1) {
+    bls12_381_Fp6_mont_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bls12_381_Fp6_mont_mul( table + (k-1)*36, x2, table + k*36 );
+    }
+  }
+}
+
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bls12_381_Fp6_mont_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[36];
-  bls12_381_Fp6_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fp6_mont_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bls12_381_Fp6_mont_mul_inplace(tgt, sqr); }
-      bls12_381_Fp6_mont_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bls12_381_Fp6_mont_set_one( tgt );
+    return;
+  }
+
+  int w = bls12_381_Fp6_mont_pow_window_size( nbits );
+  uint64_t table[576];
+  uint64_t acc[36];
+  bls12_381_Fp6_mont_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bls12_381_Fp6_mont_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bls12_381_Fp6_mont_copy( table + (d>>1)*36, acc );
+      first = 0;
+    }
+    else {
+      for(int k=i; k>=j; k--) { bls12_381_Fp6_mont_sqr_inplace( acc ); }
+      bls12_381_Fp6_mont_mul_inplace( acc, table + (d>>1)*36 );
     }
+    i = j - 1;
   }
+  bls12_381_Fp6_mont_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bls12_381_Fp6_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bls12_381_Fp6_mont_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bls12_381_Fp6_mont_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[576];
+  uint64_t acc[36];
+  bls12_381_Fp6_mont_pow_odd_powers( src, w, table );
+  bls12_381_Fp6_mont_copy( table + (chain[1]>>1)*36, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bls12_381_Fp6_mont_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bls12_381_Fp6_mont_mul_inplace( acc, table + (chain[2*s+1]>>1)*36 ); }
+  }
+  bls12_381_Fp6_mont_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*36)
@@ -8,6 +8,11 @@ extern void bls12_381_Fp6_mont_scale_by_prime_field( const uint64_t *coeff , con
 
 extern void bls12_381_Fp6_mont_frobenius( const uint64_t *src , uint64_t *tgt );
 extern void bls12_381_Fp6_mont_frobenius_inplace( uint64_t *tgt );
+extern void bls12_381_Fp6_mont_frobenius_k( const uint64_t *src , int k , uint64_t *tgt );
+extern void bls12_381_Fp6_mont_frobenius_2( const uint64_t *src , uint64_t *tgt );
+extern void bls12_381_Fp6_mont_frobenius_2_inplace( uint64_t *tgt );
+extern void bls12_381_Fp6_mont_frobenius_3( const uint64_t *src , uint64_t *tgt );
+extern void bls12_381_Fp6_mont_frobenius_3_inplace( uint64_t *tgt );
 
 extern uint8_t bls12_381_Fp6_mont_is_valid ( const uint64_t *src );
 extern uint8_t bls12_381_Fp6_mont_is_zero  ( const uint64_t *src );
@@ -43,3 +48,4 @@ extern void bls12_381_Fp6_mont_batch_inv( int n, const uint64_t *src, uint64_t *
 
 extern void bls12_381_Fp6_mont_pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );
 extern void bls12_381_Fp6_mont_pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );
+extern void bls12_381_Fp6_mont_pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );
@@ -34,6 +34,28 @@ uint8_t bls12_381_Fp_mont_bigint384_add_prime_plus_1_inplace( uint64_t *tgt ) {
   return bigint384_add_inplace( tgt, bls12_381_Fp_mont_p_plus_1);
 }
 
+// adds the prime p to a bigint if `flag` is set (to 1), inplace, branch-free
+void bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( uint64_t *tgt, uint8_t flag ) {
+  uint64_t mask = - (uint64_t)flag;
+  uint8_t  c    = 0;
+  c = addcarry_u64( c, tgt[0], 0xb9feffffffffaaab & mask, tgt+0 );
+  c = addcarry_u64( c, tgt[1], 0x1eabfffeb153ffff & mask, tgt+1 );
+  c = addcarry_u64( c, tgt[2], 0x6730d2a0f6b0f624 & mask, tgt+2 );
+  c = addcarry_u64( c, tgt[3], 0x64774b84f38512bf & mask, tgt+3 );
+  c = addcarry_u64( c, tgt[4], 0x4b1ba7b6434bacd7 & mask, tgt+4 );
+  c = addcarry_u64( c, tgt[5], 0x1a0111ea397fe69a & mask, tgt+5 );
+}
+
+// adds the prime p to a bigint if `flag` is set (to 1), inplace
+// (when compiled with CONSTANT_TIME, this is branch-free)
+void bls12_381_Fp_mont_bigint384_add_prime_if_inplace( uint64_t *tgt, uint8_t flag ) {
+#ifdef CONSTANT_TIME
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( tgt, flag );
+#else
+  if (flag) { bls12_381_Fp_mont_bigint384_add_prime_inplace( tgt ); }
+#endif
+}
+
 // subtracts the prime p from a bigint, inplace
 uint8_t bls12_381_Fp_mont_bigint384_sub_prime_inplace( uint64_t *tgt ) {
   return bigint384_sub_inplace( tgt, bls12_381_Fp_mont_prime);
@@ -70,8 +92,24 @@ void bls12_381_Fp_mont_neg_inplace( uint64_t *tgt ) {
   }
 }
 
-// if (x > prime) then (x - prime) else x
+// if (x >= prime) then (x - prime) else x, branch-free
+void bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct( uint64_t *tgt ) {
+  uint8_t b = 0;
+  b = subborrow_u64( b, tgt[0], 0xb9feffffffffaaab, tgt+0 );
+  b = subborrow_u64( b, tgt[1], 0x1eabfffeb153ffff, tgt+1 );
+  b = subborrow_u64( b, tgt[2], 0x6730d2a0f6b0f624, tgt+2 );
+  b = subborrow_u64( b, tgt[3], 0x64774b84f38512bf, tgt+3 );
+  b = subborrow_u64( b, tgt[4], 0x4b1ba7b6434bacd7, tgt+4 );
+  b = subborrow_u64( b, tgt[5], 0x1a0111ea397fe69a, tgt+5 );
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( tgt, b );  // add it back if x < prime
+}
+
+// if (x >= prime) then (x - prime) else x
+// (when compiled with CONSTANT_TIME, this is branch-free)
 void bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace( uint64_t *tgt ) {
+#ifdef CONSTANT_TIME
+  bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct( tgt );
+#else
   if (tgt[5] <  0x1a0111ea397fe69a) return;
   if (tgt[5] >  0x1a0111ea397fe69a) { bls12_381_Fp_mont_bigint384_sub_prime_inplace( tgt ); return; }
   if (tgt[4] <  0x4b1ba7b6434bacd7) return;
@@ -84,6 +122,7 @@ void bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace( uint64_t *tgt ) {
   if (tgt[1] >  0x1eabfffeb153ffff) { bls12_381_Fp_mont_bigint384_sub_prime_inplace( tgt ); return; }
   if (tgt[0] <  0xb9feffffffffaaab) return;
   if (tgt[0] >= 0xb9feffffffffaaab) { bls12_381_Fp_mont_bigint384_sub_prime_inplace( tgt ); return; }
+#endif
 }
 
 // adds two field elements
@@ -104,21 +143,21 @@ void bls12_381_Fp_mont_add_inplace( uint64_t *tgt, const uint64_t *src2 ) {
 void bls12_381_Fp_mont_sub( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
   uint8_t b = 0;
   b = bigint384_sub( src1, src2, tgt );
-  if (b) { bls12_381_Fp_mont_bigint384_add_prime_inplace( tgt ); }
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace( tgt, b );
 }
 
 // subtracts two field elements
 void bls12_381_Fp_mont_sub_inplace( uint64_t *tgt, const uint64_t *src2 ) {
   uint8_t b = 0;
   b = bigint384_sub_inplace( tgt, src2 );
-  if (b) { bls12_381_Fp_mont_bigint384_add_prime_inplace( tgt ); }
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace( tgt, b );
 }
 
 // tgt := src - tgt
 void bls12_381_Fp_mont_sub_inplace_reverse( uint64_t *tgt, const uint64_t *src1 ) {
   uint8_t b = 0;
   b = bigint384_sub_inplace_reverse( tgt, src1 );
-  if (b) { bls12_381_Fp_mont_bigint384_add_prime_inplace( tgt ); }
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace( tgt, b );
 }
 
 // divides by 2
@@ -174,7 +213,11 @@ void bls12_381_Fp_mont_REDC_unsafe( uint64_t *T, uint64_t *tgt ) {
     c = x >> 64;
     T[i+5] = (uint64_t) x;
     uint8_t d = addcarry_u64( 0 , T[i+6] , c , T+i+6 );
+#ifdef CONSTANT_TIME
+    for(int j=7; j<=12-i; j++) {                // no early exit
+#else
     for(int j=7; (d>0) && (j<=12-i); j++) {
+#endif
       d = addcarry_u64( d , T[i+j] , 0 , T+i+j );
     }
   }
@@ -182,6 +225,46 @@ void bls12_381_Fp_mont_REDC_unsafe( uint64_t *T, uint64_t *tgt ) {
   bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace(tgt);
 }
 
+// the same as above, but always branch-free (no early exit in the carry propagation)
+void bls12_381_Fp_mont_REDC_unsafe_ct( uint64_t *T, uint64_t *tgt ) {
+  T[12] = 0;
+  for(int i=0; i<6; i++) {
+    __uint128_t x;
+    uint64_t c;
+    uint64_t m = T[i] * 0x89f3fffcfffcfffd;
+    // j = 0
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[0] + T[i+0];    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+0] = (uint64_t) x;
+    // j = 1
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[1] + T[i+1] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+1] = (uint64_t) x;
+    // j = 2
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[2] + T[i+2] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+2] = (uint64_t) x;
+    // j = 3
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[3] + T[i+3] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+3] = (uint64_t) x;
+    // j = 4
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[4] + T[i+4] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+4] = (uint64_t) x;
+    // j = 5
+    x = ((__uint128_t)m) * bls12_381_Fp_mont_prime[5] + T[i+5] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+5] = (uint64_t) x;
+    uint8_t d = addcarry_u64( 0 , T[i+6] , c , T+i+6 );
+    for(int j=7; j<=12-i; j++) {                // no early exit
+      d = addcarry_u64( d , T[i+j] , 0 , T+i+j );
+    }
+  }
+  memcpy( tgt, T+6, 48);
+  bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct(tgt);
+}
+
 void bls12_381_Fp_mont_REDC( const uint64_t *src, uint64_t *tgt ) {
   uint64_t T[13];
   memcpy( T, src, 96 );
@@ -232,34 +315,90 @@ void bls12_381_Fp_mont_div_inplace( uint64_t *tgt, const uint64_t *src2) {
   bls12_381_Fp_mont_mul_inplace( tgt, bls12_381_Fp_mont_R_squared );
 };
 
-// computes `x^e mod p`
-void bls12_381_Fp_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[6];
-  bls12_381_Fp_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fp_mont_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bls12_381_Fp_mont_mul_inplace(tgt, sqr); }
-    bls12_381_Fp_mont_mul_inplace(sqr, sqr);
-    e = e >> 1;
+// the sliding window size used for exponents of the given bit length
+int bls12_381_Fp_mont_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bls12_381_Fp_mont_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[6];
+  bls12_381_Fp_mont_copy( src, table );
+  if (w > 1) {
+    bls12_381_Fp_mont_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bls12_381_Fp_mont_mul( table + (k-1)*6, x2, table + k*6 );
+    }
   }
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bls12_381_Fp_mont_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[6];
-  bls12_381_Fp_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fp_mont_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bls12_381_Fp_mont_mul_inplace(tgt, sqr); }
-      bls12_381_Fp_mont_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bls12_381_Fp_mont_set_one( tgt );
+    return;
+  }
+
+  int w = bls12_381_Fp_mont_pow_window_size( nbits );
+  uint64_t table[96];
+  uint64_t acc[6];
+  bls12_381_Fp_mont_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bls12_381_Fp_mont_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bls12_381_Fp_mont_copy( table + (d>>1)*6, acc );
+      first = 0;
     }
+    else {
+      for(int k=i; k>=j; k--) { bls12_381_Fp_mont_sqr_inplace( acc ); }
+      bls12_381_Fp_mont_mul_inplace( acc, table + (d>>1)*6 );
+    }
+    i = j - 1;
+  }
+  bls12_381_Fp_mont_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bls12_381_Fp_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bls12_381_Fp_mont_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bls12_381_Fp_mont_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[96];
+  uint64_t acc[6];
+  bls12_381_Fp_mont_pow_odd_powers( src, w, table );
+  bls12_381_Fp_mont_copy( table + (chain[1]>>1)*6, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bls12_381_Fp_mont_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bls12_381_Fp_mont_mul_inplace( acc, table + (chain[2*s+1]>>1)*6 ); }
   }
+  bls12_381_Fp_mont_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*6)
@@ -298,6 +437,83 @@ void bls12_381_Fp_mont_batch_inv( int n, const uint64_t *src, uint64_t *tgt ) {
   free(prods);
 }
 
+// addition chain for the exponent `p-2`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fp_mont_chain_p_minus_2[136] = 
+  { 0,13, 13,17, 7,15, 4,5, 6,7, 7,23, 5,31, 5,25, 3,5, 6,13, 6,9, 3,3, 8,27, 3,5, 6,15, 6,27
+  , 3,1, 8,13, 7,23, 5,11, 6,13, 6,29, 4,9, 8,29, 4,13, 7,23, 9,19, 5,25, 2,3, 7,5, 7,9, 6,23
+  , 5,29, 5,19, 5,19, 8,13, 7,21, 9,15, 5,13, 3,3, 8,15, 3,3, 7,9, 9,15, 6,21, 6,31, 5,31, 5,31
+  , 4,13, 3,3, 8,21, 7,31, 5,31, 5,31, 4,15, 4,7, 7,31, 5,29, 5,31, 5,31, 5,31, 5,31, 5,31, 5,31
+  , 4,13, 6,21, 4,5, 3,1
+  };
+
+// computes `x^e` for the fixed exponent `p-2`
+void bls12_381_Fp_mont_pow_p_minus_2( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fp_mont_pow_chain( src, 5, 68, bls12_381_Fp_mont_chain_p_minus_2, tgt );
+}
+
+// addition chain for the exponent `(p-1)/2`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fp_mont_chain_p_minus_1_per_2[134] = 
+  { 0,13, 13,17, 7,15, 4,5, 6,7, 7,23, 5,31, 5,25, 3,5, 6,13, 6,9, 3,3, 8,27, 3,5, 6,15, 6,27
+  , 3,1, 8,13, 7,23, 5,11, 6,13, 6,29, 4,9, 8,29, 4,13, 7,23, 9,19, 5,25, 2,3, 7,5, 7,9, 6,23
+  , 5,29, 5,19, 5,19, 8,13, 7,21, 9,15, 5,13, 3,3, 8,15, 3,3, 7,9, 9,15, 6,21, 6,31, 5,31, 5,31
+  , 4,13, 3,3, 8,21, 7,31, 5,31, 5,31, 4,15, 4,7, 7,31, 5,29, 5,31, 5,31, 5,31, 5,31, 5,31, 5,31
+  , 4,13, 6,21, 6,21
+  };
+
+// computes `x^e` for the fixed exponent `(p-1)/2`
+void bls12_381_Fp_mont_pow_p_minus_1_per_2( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fp_mont_pow_chain( src, 5, 67, bls12_381_Fp_mont_chain_p_minus_1_per_2, tgt );
+}
+
+// inversion via Fermat's little theorem `1/x = x^(p-2)`. This is slower than the
+// Euclidean algorithm, but the sequence of operations does not depend on the input.
+// The inverse of zero is zero.
+void bls12_381_Fp_mont_inv_fermat( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fp_mont_pow_p_minus_2( src, tgt );
+}
+
+// checks whether a field element is a square (Euler's criterion). Zero is a square.
+uint8_t bls12_381_Fp_mont_is_square( const uint64_t *src ) {
+  if (bls12_381_Fp_mont_is_zero( src )) return 1;
+  uint64_t e[6];
+  bls12_381_Fp_mont_pow_p_minus_1_per_2( src, e );
+  return bls12_381_Fp_mont_is_one( e );
+}
+
+// addition chain for the exponent `(p+1)/4`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fp_mont_chain_p_plus_1_per_4[134] = 
+  { 0,13, 13,17, 7,15, 4,5, 6,7, 7,23, 5,31, 5,25, 3,5, 6,13, 6,9, 3,3, 8,27, 3,5, 6,15, 6,27
+  , 3,1, 8,13, 7,23, 5,11, 6,13, 6,29, 4,9, 8,29, 4,13, 7,23, 9,19, 5,25, 2,3, 7,5, 7,9, 6,23
+  , 5,29, 5,19, 5,19, 8,13, 7,21, 9,15, 5,13, 3,3, 8,15, 3,3, 7,9, 9,15, 6,21, 6,31, 5,31, 5,31
+  , 4,13, 3,3, 8,21, 7,31, 5,31, 5,31, 4,15, 4,7, 7,31, 5,29, 5,31, 5,31, 5,31, 5,31, 5,31, 5,31
+  , 4,13, 6,21, 5,11
+  };
+
+// computes `x^e` for the fixed exponent `(p+1)/4`
+void bls12_381_Fp_mont_pow_p_plus_1_per_4( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fp_mont_pow_chain( src, 5, 67, bls12_381_Fp_mont_chain_p_plus_1_per_4, tgt );
+}
+
+// computes the square root `x^((p+1)/4)` (here `p = 3 mod 4`); returns 1 if it exists.
+// If there is no square root, the result is set to zero and 0 is returned.
+uint8_t bls12_381_Fp_mont_sqrt( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t r[6];
+  uint64_t s[6];
+  bls12_381_Fp_mont_pow_p_plus_1_per_4( src, r );
+  bls12_381_Fp_mont_sqr( r, s );
+  if (bls12_381_Fp_mont_is_equal( s, src )) {
+    bls12_381_Fp_mont_copy( r, tgt );
+    return 1;
+  }
+  else {
+    bls12_381_Fp_mont_set_zero( tgt );
+    return 0;
+  }
+}
+
 // checks if (x < prime)
 uint8_t bls12_381_Fp_mont_is_valid( const uint64_t *src ) {
   if (src[5] <  0x1a0111ea397fe69a) return 1;
@@ -373,3 +589,76 @@ void bls12_381_Fp_mont_batch_to_std( int N, const uint64_t *src, uint64_t *tgt)
     q += NLIMBS;
   }
 };
+
+// negates a field element (branch-free)
+void bls12_381_Fp_mont_neg_ct( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t tmp[NLIMBS];
+  bigint384_sub( bls12_381_Fp_mont_prime, src, tmp );                // p - x
+  bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct( tmp );   // (p - 0) -> 0
+  memcpy( tgt, tmp, 8*NLIMBS );
+}
+
+// adds two field elements (branch-free)
+void bls12_381_Fp_mont_add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  bigint384_add( src1, src2, tgt );
+  bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct( tgt );
+}
+
+// adds two field elements, inplace (branch-free)
+void bls12_381_Fp_mont_add_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {
+  bigint384_add_inplace( tgt, src2 );
+  bls12_381_Fp_mont_bigint384_sub_prime_if_above_inplace_ct( tgt );
+}
+
+// subtracts two field elements (branch-free)
+void bls12_381_Fp_mont_sub_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint8_t b = 0;
+  b = bigint384_sub( src1, src2, tgt );
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( tgt, b );
+}
+
+// subtracts two field elements, inplace (branch-free)
+void bls12_381_Fp_mont_sub_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {
+  uint8_t b = 0;
+  b = bigint384_sub_inplace( tgt, src2 );
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( tgt, b );
+}
+
+// tgt := src - tgt (branch-free)
+void bls12_381_Fp_mont_sub_inplace_reverse_ct( uint64_t *tgt, const uint64_t *src1 ) {
+  uint8_t b = 0;
+  b = bigint384_sub_inplace_reverse( tgt, src1 );
+  bls12_381_Fp_mont_bigint384_add_prime_if_inplace_ct( tgt, b );
+}
+
+void bls12_381_Fp_mont_sqr_ct( const uint64_t *src, uint64_t *tgt) {
+  uint64_t T[13];
+  bigint384_sqr( src, T );
+  bls12_381_Fp_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fp_mont_sqr_inplace_ct( uint64_t *tgt ) {
+  uint64_t T[13];
+  bigint384_sqr( tgt, T );
+  bls12_381_Fp_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fp_mont_mul_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt) {
+  uint64_t T[13];
+  bigint384_mul( src1, src2, T );
+  bls12_381_Fp_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fp_mont_mul_inplace_ct( uint64_t *tgt, const uint64_t *src2) {
+  uint64_t T[13];
+  bigint384_mul( tgt, src2, T );
+  bls12_381_Fp_mont_REDC_unsafe_ct( T, tgt );
+};
+
+// convert a field element from Montgomery to standard representation (branch-free)
+void bls12_381_Fp_mont_to_std_ct( const uint64_t *src, uint64_t *tgt) {
+  uint64_t T[13];
+  memcpy( T, src, 48);
+  memset( T+6, 0, 48);
+  bls12_381_Fp_mont_REDC_unsafe_ct( T, tgt );
+};
@@ -34,6 +34,26 @@ uint8_t bls12_381_Fr_mont_bigint256_add_prime_plus_1_inplace( uint64_t *tgt ) {
   return bigint256_add_inplace( tgt, bls12_381_Fr_mont_p_plus_1);
 }
 
+// adds the prime p to a bigint if `flag` is set (to 1), inplace, branch-free
+void bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( uint64_t *tgt, uint8_t flag ) {
+  uint64_t mask = - (uint64_t)flag;
+  uint8_t  c    = 0;
+  c = addcarry_u64( c, tgt[0], 0xffffffff00000001 & mask, tgt+0 );
+  c = addcarry_u64( c, tgt[1], 0x53bda402fffe5bfe & mask, tgt+1 );
+  c = addcarry_u64( c, tgt[2], 0x3339d80809a1d805 & mask, tgt+2 );
+  c = addcarry_u64( c, tgt[3], 0x73eda753299d7d48 & mask, tgt+3 );
+}
+
+// adds the prime p to a bigint if `flag` is set (to 1), inplace
+// (when compiled with CONSTANT_TIME, this is branch-free)
+void bls12_381_Fr_mont_bigint256_add_prime_if_inplace( uint64_t *tgt, uint8_t flag ) {
+#ifdef CONSTANT_TIME
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( tgt, flag );
+#else
+  if (flag) { bls12_381_Fr_mont_bigint256_add_prime_inplace( tgt ); }
+#endif
+}
+
 // subtracts the prime p from a bigint, inplace
 uint8_t bls12_381_Fr_mont_bigint256_sub_prime_inplace( uint64_t *tgt ) {
   return bigint256_sub_inplace( tgt, bls12_381_Fr_mont_prime);
@@ -68,8 +88,22 @@ void bls12_381_Fr_mont_neg_inplace( uint64_t *tgt ) {
   }
 }
 
-// if (x > prime) then (x - prime) else x
+// if (x >= prime) then (x - prime) else x, branch-free
+void bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct( uint64_t *tgt ) {
+  uint8_t b = 0;
+  b = subborrow_u64( b, tgt[0], 0xffffffff00000001, tgt+0 );
+  b = subborrow_u64( b, tgt[1], 0x53bda402fffe5bfe, tgt+1 );
+  b = subborrow_u64( b, tgt[2], 0x3339d80809a1d805, tgt+2 );
+  b = subborrow_u64( b, tgt[3], 0x73eda753299d7d48, tgt+3 );
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( tgt, b );  // add it back if x < prime
+}
+
+// if (x >= prime) then (x - prime) else x
+// (when compiled with CONSTANT_TIME, this is branch-free)
 void bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace( uint64_t *tgt ) {
+#ifdef CONSTANT_TIME
+  bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct( tgt );
+#else
   if (tgt[3] <  0x73eda753299d7d48) return;
   if (tgt[3] >  0x73eda753299d7d48) { bls12_381_Fr_mont_bigint256_sub_prime_inplace( tgt ); return; }
   if (tgt[2] <  0x3339d80809a1d805) return;
@@ -78,6 +112,7 @@ void bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace( uint64_t *tgt ) {
   if (tgt[1] >  0x53bda402fffe5bfe) { bls12_381_Fr_mont_bigint256_sub_prime_inplace( tgt ); return; }
   if (tgt[0] <  0xffffffff00000001) return;
   if (tgt[0] >= 0xffffffff00000001) { bls12_381_Fr_mont_bigint256_sub_prime_inplace( tgt ); return; }
+#endif
 }
 
 // adds two field elements
@@ -98,21 +133,21 @@ void bls12_381_Fr_mont_add_inplace( uint64_t *tgt, const uint64_t *src2 ) {
 void bls12_381_Fr_mont_sub( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
   uint8_t b = 0;
   b = bigint256_sub( src1, src2, tgt );
-  if (b) { bls12_381_Fr_mont_bigint256_add_prime_inplace( tgt ); }
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace( tgt, b );
 }
 
 // subtracts two field elements
 void bls12_381_Fr_mont_sub_inplace( uint64_t *tgt, const uint64_t *src2 ) {
   uint8_t b = 0;
   b = bigint256_sub_inplace( tgt, src2 );
-  if (b) { bls12_381_Fr_mont_bigint256_add_prime_inplace( tgt ); }
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace( tgt, b );
 }
 
 // tgt := src - tgt
 void bls12_381_Fr_mont_sub_inplace_reverse( uint64_t *tgt, const uint64_t *src1 ) {
   uint8_t b = 0;
   b = bigint256_sub_inplace_reverse( tgt, src1 );
-  if (b) { bls12_381_Fr_mont_bigint256_add_prime_inplace( tgt ); }
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace( tgt, b );
 }
 
 // divides by 2
@@ -160,7 +195,11 @@ void bls12_381_Fr_mont_REDC_unsafe( uint64_t *T, uint64_t *tgt ) {
     c = x >> 64;
     T[i+3] = (uint64_t) x;
     uint8_t d = addcarry_u64( 0 , T[i+4] , c , T+i+4 );
+#ifdef CONSTANT_TIME
+    for(int j=5; j<=8-i; j++) {                // no early exit
+#else
     for(int j=5; (d>0) && (j<=8-i); j++) {
+#endif
       d = addcarry_u64( d , T[i+j] , 0 , T+i+j );
     }
   }
@@ -168,6 +207,38 @@ void bls12_381_Fr_mont_REDC_unsafe( uint64_t *T, uint64_t *tgt ) {
   bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace(tgt);
 }
 
+// the same as above, but always branch-free (no early exit in the carry propagation)
+void bls12_381_Fr_mont_REDC_unsafe_ct( uint64_t *T, uint64_t *tgt ) {
+  T[8] = 0;
+  for(int i=0; i<4; i++) {
+    __uint128_t x;
+    uint64_t c;
+    uint64_t m = T[i] * 0xfffffffeffffffff;
+    // j = 0
+    x = ((__uint128_t)m) * bls12_381_Fr_mont_prime[0] + T[i+0];    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+0] = (uint64_t) x;
+    // j = 1
+    x = ((__uint128_t)m) * bls12_381_Fr_mont_prime[1] + T[i+1] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+1] = (uint64_t) x;
+    // j = 2
+    x = ((__uint128_t)m) * bls12_381_Fr_mont_prime[2] + T[i+2] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+2] = (uint64_t) x;
+    // j = 3
+    x = ((__uint128_t)m) * bls12_381_Fr_mont_prime[3] + T[i+3] + c;    // note: cannot overflow in 128 bits
+    c = x >> 64;
+    T[i+3] = (uint64_t) x;
+    uint8_t d = addcarry_u64( 0 , T[i+4] , c , T+i+4 );
+    for(int j=5; j<=8-i; j++) {                // no early exit
+      d = addcarry_u64( d , T[i+j] , 0 , T+i+j );
+    }
+  }
+  memcpy( tgt, T+4, 32);
+  bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct(tgt);
+}
+
 void bls12_381_Fr_mont_REDC( const uint64_t *src, uint64_t *tgt ) {
   uint64_t T[9];
   memcpy( T, src, 64 );
@@ -218,34 +289,90 @@ void bls12_381_Fr_mont_div_inplace( uint64_t *tgt, const uint64_t *src2) {
   bls12_381_Fr_mont_mul_inplace( tgt, bls12_381_Fr_mont_R_squared );
 };
 
-// computes `x^e mod p`
-void bls12_381_Fr_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[4];
-  bls12_381_Fr_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fr_mont_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bls12_381_Fr_mont_mul_inplace(tgt, sqr); }
-    bls12_381_Fr_mont_mul_inplace(sqr, sqr);
-    e = e >> 1;
+// the sliding window size used for exponents of the given bit length
+int bls12_381_Fr_mont_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bls12_381_Fr_mont_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[4];
+  bls12_381_Fr_mont_copy( src, table );
+  if (w > 1) {
+    bls12_381_Fr_mont_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bls12_381_Fr_mont_mul( table + (k-1)*4, x2, table + k*4 );
+    }
   }
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bls12_381_Fr_mont_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[4];
-  bls12_381_Fr_mont_copy( src, sqr );                 // sqr := src
-  bls12_381_Fr_mont_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bls12_381_Fr_mont_mul_inplace(tgt, sqr); }
-      bls12_381_Fr_mont_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bls12_381_Fr_mont_set_one( tgt );
+    return;
+  }
+
+  int w = bls12_381_Fr_mont_pow_window_size( nbits );
+  uint64_t table[64];
+  uint64_t acc[4];
+  bls12_381_Fr_mont_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bls12_381_Fr_mont_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bls12_381_Fr_mont_copy( table + (d>>1)*4, acc );
+      first = 0;
+    }
+    else {
+      for(int k=i; k>=j; k--) { bls12_381_Fr_mont_sqr_inplace( acc ); }
+      bls12_381_Fr_mont_mul_inplace( acc, table + (d>>1)*4 );
     }
+    i = j - 1;
   }
+  bls12_381_Fr_mont_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bls12_381_Fr_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bls12_381_Fr_mont_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bls12_381_Fr_mont_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[64];
+  uint64_t acc[4];
+  bls12_381_Fr_mont_pow_odd_powers( src, w, table );
+  bls12_381_Fr_mont_copy( table + (chain[1]>>1)*4, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bls12_381_Fr_mont_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bls12_381_Fr_mont_mul_inplace( acc, table + (chain[2*s+1]>>1)*4 ); }
+  }
+  bls12_381_Fr_mont_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*4)
@@ -284,6 +411,102 @@ void bls12_381_Fr_mont_batch_inv( int n, const uint64_t *src, uint64_t *tgt ) {
   free(prods);
 }
 
+// addition chain for the exponent `p-2`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fr_mont_chain_p_minus_2[90] = 
+  { 0,7, 7,31, 6,27, 6,19, 5,21, 7,25, 6,19, 7,29, 6,31, 4,5, 3,1, 10,25, 5,19, 5,19, 4,11, 8,1
+  , 12,19, 2,1, 9,29, 1,1, 13,21, 6,19, 5,23, 4,11, 5,9, 13,23, 5,31, 5,31, 5,25, 6,27, 5,31, 5,27
+  , 5,31, 5,31, 5,31, 5,31, 5,31, 4,15, 6,31, 5,31, 5,31, 5,31, 5,31, 5,31, 2,3
+  };
+
+// computes `x^e` for the fixed exponent `p-2`
+void bls12_381_Fr_mont_pow_p_minus_2( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fr_mont_pow_chain( src, 5, 45, bls12_381_Fr_mont_chain_p_minus_2, tgt );
+}
+
+// addition chain for the exponent `(p-1)/2`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fr_mont_chain_p_minus_1_per_2[78] = 
+  { 0,7, 7,31, 6,27, 6,19, 5,21, 7,25, 6,19, 7,29, 6,31, 4,5, 3,1, 10,25, 5,19, 5,19, 4,11, 8,1
+  , 12,19, 2,1, 9,29, 1,1, 13,21, 6,19, 5,23, 4,11, 5,9, 13,23, 5,31, 5,31, 5,25, 6,27, 5,31, 5,27
+  , 5,31, 5,31, 5,31, 5,31, 5,31, 5,31, 31,0
+  };
+
+// computes `x^e` for the fixed exponent `(p-1)/2`
+void bls12_381_Fr_mont_pow_p_minus_1_per_2( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fr_mont_pow_chain( src, 5, 39, bls12_381_Fr_mont_chain_p_minus_1_per_2, tgt );
+}
+
+// inversion via Fermat's little theorem `1/x = x^(p-2)`. This is slower than the
+// Euclidean algorithm, but the sequence of operations does not depend on the input.
+// The inverse of zero is zero.
+void bls12_381_Fr_mont_inv_fermat( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fr_mont_pow_p_minus_2( src, tgt );
+}
+
+// checks whether a field element is a square (Euler's criterion). Zero is a square.
+uint8_t bls12_381_Fr_mont_is_square( const uint64_t *src ) {
+  if (bls12_381_Fr_mont_is_zero( src )) return 1;
+  uint64_t e[4];
+  bls12_381_Fr_mont_pow_p_minus_1_per_2( src, e );
+  return bls12_381_Fr_mont_is_one( e );
+}
+
+// addition chain for the exponent `(Q-1)/2`,
+// as (number of squarings, odd digit) steps
+const uint8_t bls12_381_Fr_mont_chain_q_minus_1_per_2[92] = 
+  { 0,7, 6,15, 4,11, 5,13, 5,7, 4,5, 4,3, 5,5, 4,3, 5,7, 5,11, 3,7, 4,5, 3,1, 7,3, 4,3
+  , 5,7, 5,7, 3,3, 8,1, 11,9, 3,5, 7,7, 3,3, 11,5, 4,5, 5,7, 5,15, 5,13, 3,1, 12,11, 4,15
+  , 4,15, 4,15, 4,9, 5,13, 4,15, 4,15, 5,15, 4,15, 4,15, 4,15, 4,15, 4,15, 4,15, 3,7
+  };
+
+// computes `x^e` for the fixed exponent `(Q-1)/2`
+void bls12_381_Fr_mont_pow_q_minus_1_per_2( const uint64_t *src, uint64_t *tgt ) {
+  bls12_381_Fr_mont_pow_chain( src, 4, 46, bls12_381_Fr_mont_chain_q_minus_1_per_2, tgt );
+}
+
+// a non-residue raised to the power `Q`, a primitive `2^32`-th root of unity
+const uint64_t bls12_381_Fr_mont_sqrt_z[4] = { 0xb9b58d8c5f0e466a, 0x5b1b4c801819d7ec, 0x0af53ae352a31e64, 0x5bf3adda19e9b27b };
+
+// computes a square root using the Tonelli-Shanks algorithm, where `p-1 = 2^S * Q`
+// with `S = 32`; returns 1 if it exists. If there is no square root,
+// the result is set to zero and 0 is returned.
+uint8_t bls12_381_Fr_mont_sqrt( const uint64_t *src, uint64_t *tgt ) {
+  if (bls12_381_Fr_mont_is_zero( src )) {
+    bls12_381_Fr_mont_set_zero( tgt );
+    return 1;
+  }
+  uint64_t w[4];
+  uint64_t r[4];
+  uint64_t t[4];
+  uint64_t c[4];
+  uint64_t b[4];
+  bls12_381_Fr_mont_pow_q_minus_1_per_2( src, w );     // w = x^((Q-1)/2)
+  bls12_381_Fr_mont_mul( src, w, r );                   // r = x^((Q+1)/2)
+  bls12_381_Fr_mont_mul( r  , w, t );                   // t = x^Q
+  bls12_381_Fr_mont_copy( bls12_381_Fr_mont_sqrt_z, c );
+  int m = 32;
+  while (!bls12_381_Fr_mont_is_one( t )) {
+    // find the smallest `i` such that `t^(2^i) = 1`
+    int i = 0;
+    bls12_381_Fr_mont_copy( t, b );
+    while ((i < m) && !bls12_381_Fr_mont_is_one( b )) { bls12_381_Fr_mont_sqr_inplace( b ); i++; }
+    if (i == m) {
+      // not a square
+      bls12_381_Fr_mont_set_zero( tgt );
+      return 0;
+    }
+    bls12_381_Fr_mont_copy( c, b );
+    for(int k=0; k<m-i-1; k++) { bls12_381_Fr_mont_sqr_inplace( b ); }
+    bls12_381_Fr_mont_mul_inplace( r, b );
+    bls12_381_Fr_mont_sqr( b, c );
+    bls12_381_Fr_mont_mul_inplace( t, c );
+    m = i;
+  }
+  bls12_381_Fr_mont_copy( r, tgt );
+  return 1;
+}
+
 // checks if (x < prime)
 uint8_t bls12_381_Fr_mont_is_valid( const uint64_t *src ) {
   if (src[3] <  0x73eda753299d7d48) return 1;
@@ -355,3 +578,76 @@ void bls12_381_Fr_mont_batch_to_std( int N, const uint64_t *src, uint64_t *tgt)
     q += NLIMBS;
   }
 };
+
+// negates a field element (branch-free)
+void bls12_381_Fr_mont_neg_ct( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t tmp[NLIMBS];
+  bigint256_sub( bls12_381_Fr_mont_prime, src, tmp );                // p - x
+  bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct( tmp );   // (p - 0) -> 0
+  memcpy( tgt, tmp, 8*NLIMBS );
+}
+
+// adds two field elements (branch-free)
+void bls12_381_Fr_mont_add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  bigint256_add( src1, src2, tgt );
+  bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct( tgt );
+}
+
+// adds two field elements, inplace (branch-free)
+void bls12_381_Fr_mont_add_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {
+  bigint256_add_inplace( tgt, src2 );
+  bls12_381_Fr_mont_bigint256_sub_prime_if_above_inplace_ct( tgt );
+}
+
+// subtracts two field elements (branch-free)
+void bls12_381_Fr_mont_sub_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint8_t b = 0;
+  b = bigint256_sub( src1, src2, tgt );
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( tgt, b );
+}
+
+// subtracts two field elements, inplace (branch-free)
+void bls12_381_Fr_mont_sub_inplace_ct( uint64_t *tgt, const uint64_t *src2 ) {
+  uint8_t b = 0;
+  b = bigint256_sub_inplace( tgt, src2 );
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( tgt, b );
+}
+
+// tgt := src - tgt (branch-free)
+void bls12_381_Fr_mont_sub_inplace_reverse_ct( uint64_t *tgt, const uint64_t *src1 ) {
+  uint8_t b = 0;
+  b = bigint256_sub_inplace_reverse( tgt, src1 );
+  bls12_381_Fr_mont_bigint256_add_prime_if_inplace_ct( tgt, b );
+}
+
+void bls12_381_Fr_mont_sqr_ct( const uint64_t *src, uint64_t *tgt) {
+  uint64_t T[9];
+  bigint256_sqr( src, T );
+  bls12_381_Fr_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fr_mont_sqr_inplace_ct( uint64_t *tgt ) {
+  uint64_t T[9];
+  bigint256_sqr( tgt, T );
+  bls12_381_Fr_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fr_mont_mul_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt) {
+  uint64_t T[9];
+  bigint256_mul( src1, src2, T );
+  bls12_381_Fr_mont_REDC_unsafe_ct( T, tgt );
+};
+
+void bls12_381_Fr_mont_mul_inplace_ct( uint64_t *tgt, const uint64_t *src2) {
+  uint64_t T[9];
+  bigint256_mul( tgt, src2, T );
+  bls12_381_Fr_mont_REDC_unsafe_ct( T, tgt );
+};
+
+// convert a field element from Montgomery to standard representation (branch-free)
+void bls12_381_Fr_mont_to_std_ct( const uint64_t *src, uint64_t *tgt) {
+  uint64_t T[9];
+  memcpy( T, src, 32);
+  memset( T+4, 0, 32);
+  bls12_381_Fr_mont_REDC_unsafe_ct( T, tgt );
+};
@@ -38,3 +38,22 @@ extern void bls12_381_Fr_mont_batch_inv ( int n, const uint64_t *src, uint64_t *
 
 extern void bls12_381_Fr_mont_pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );
 extern void bls12_381_Fr_mont_pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );
+extern void bls12_381_Fr_mont_pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );
+
+extern void    bls12_381_Fr_mont_inv_fermat ( const uint64_t *src, uint64_t *tgt );
+extern uint8_t bls12_381_Fr_mont_is_square  ( const uint64_t *src );
+extern uint8_t bls12_381_Fr_mont_sqrt       ( const uint64_t *src, uint64_t *tgt );
+
+extern void bls12_381_Fr_mont_neg_ct ( const uint64_t *src ,       uint64_t *tgt );
+extern void bls12_381_Fr_mont_add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+extern void bls12_381_Fr_mont_sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+extern void bls12_381_Fr_mont_sqr_ct ( const uint64_t *src ,       uint64_t *tgt );
+extern void bls12_381_Fr_mont_mul_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+
+extern void bls12_381_Fr_mont_add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );
+extern void bls12_381_Fr_mont_sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );
+extern void bls12_381_Fr_mont_sqr_inplace_ct ( uint64_t *tgt );
+extern void bls12_381_Fr_mont_mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2);
+extern void bls12_381_Fr_mont_sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 );
+
+extern void bls12_381_Fr_mont_to_std_ct ( const uint64_t *src , uint64_t *tgt );
@@ -311,34 +311,210 @@ void bn128_Fp12_mont_frobenius_inplace ( uint64_t *tgt ) {
   bn128_Fp12_mont_frobenius( tgt, tgt );
 }
 
-// computes `x^e mod p`
-void bn128_Fp12_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[48];
-  bn128_Fp12_mont_copy( src, sqr );                 // sqr := src
-  bn128_Fp12_mont_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bn128_Fp12_mont_mul_inplace(tgt, sqr); }
-    bn128_Fp12_mont_mul_inplace(sqr, sqr);
-    e = e >> 1;
+
+const uint64_t bn128_Fp12_mont_frobenius_2_sparse_indices[12] = 
+  { 0x0000000000000000, 0x0000000000010001, 0x0000000000020002, 0x0000000000030003, 0x0000000000040004, 0x0000000000050005, 0x0000000000060006, 0x0000000000070007, 0x0000000000080008, 0x0000000000090009, 0x00000000000a000a, 0x00000000000b000b
+  };
+
+
+const uint64_t bn128_Fp12_mont_frobenius_2_sparse_entries[48] = 
+  { 0xd35d438dc58f0d9d, 0x0a78eb28f5c70b3d, 0x666ea36f7879462c, 0x0e0a77c19a07df2f
+  , 0xd35d438dc58f0d9d, 0x0a78eb28f5c70b3d, 0x666ea36f7879462c, 0x0e0a77c19a07df2f
+  , 0x3350c88e13e80b9c, 0x7dce557cdb5e56b9, 0x6001b4b8b615564a, 0x2682e617020217e0
+  , 0x3350c88e13e80b9c, 0x7dce557cdb5e56b9, 0x6001b4b8b615564a, 0x2682e617020217e0
+  , 0x71930c11d782e155, 0xa6bb947cffbe3323, 0xaa303344d4741444, 0x2c3b3f0d26594943
+  , 0x71930c11d782e155, 0xa6bb947cffbe3323, 0xaa303344d4741444, 0x2c3b3f0d26594943
+  , 0xca8d800500fa1bf2, 0xf0c5d61468b39769, 0x0e201271ad0d4418, 0x04290f65bad856e6
+  , 0xca8d800500fa1bf2, 0xf0c5d61468b39769, 0x0e201271ad0d4418, 0x04290f65bad856e6
+  , 0x68c3488912edefaa, 0x8d087f6872aabf4f, 0x51e1a24709081231, 0x2259d6b14729c0fa
+  , 0x68c3488912edefaa, 0x8d087f6872aabf4f, 0x51e1a24709081231, 0x2259d6b14729c0fa
+  , 0x08cfc388c494f1ab, 0x19b315148d1373d4, 0x584e90fdcb6c0213, 0x09e1685bdf2f8849
+  , 0x08cfc388c494f1ab, 0x19b315148d1373d4, 0x584e90fdcb6c0213, 0x09e1685bdf2f8849
+  };
+
+
+// computes `x^(p^2)` directly
+void bn128_Fp12_mont_frobenius_2 ( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t acc[EXT_NWORDS];
+  uint64_t tmp[PRIME_NWORDS];
+  bn128_Fp12_mont_set_zero(acc);
+  for(int k=0; k<12; k++) {
+    uint64_t ij = bn128_Fp12_mont_frobenius_2_sparse_indices[k];
+    uint64_t i  = (ij >> 16);
+    uint64_t j  = (ij &  0xffff);
+    bn128_Fp_mont_mul( src + i*PRIME_NWORDS , bn128_Fp12_mont_frobenius_2_sparse_entries + k*PRIME_NWORDS , tmp );
+    bn128_Fp_mont_add_inplace( acc + j*PRIME_NWORDS , tmp );
+  }
+  bn128_Fp12_mont_copy( acc, tgt );
+}
+
+void bn128_Fp12_mont_frobenius_2_inplace ( uint64_t *tgt ) {
+  bn128_Fp12_mont_frobenius_2( tgt, tgt );
+}
+
+const uint64_t bn128_Fp12_mont_frobenius_3_sparse_indices[22] = 
+  { 0x0000000000000000, 0x0000000000010001, 0x0000000000020002, 0x0000000000020003, 0x0000000000030002, 0x0000000000030003, 0x0000000000040004, 0x0000000000040005, 0x0000000000050004, 0x0000000000050005, 0x0000000000060006, 0x0000000000060007, 0x0000000000070006, 0x0000000000070007, 0x0000000000080008, 0x0000000000080009, 0x0000000000090008, 0x0000000000090009, 0x00000000000a000a, 0x00000000000a000b, 0x00000000000b000a, 0x00000000000b000b
+  };
+
+
+const uint64_t bn128_Fp12_mont_frobenius_3_sparse_entries[88] = 
+  { 0xd35d438dc58f0d9d, 0x0a78eb28f5c70b3d, 0x666ea36f7879462c, 0x0e0a77c19a07df2f
+  , 0x68c3488912edefaa, 0x8d087f6872aabf4f, 0x51e1a24709081231, 0x2259d6b14729c0fa
+  , 0xc9af22f716ad6bad, 0xb311782a4aa662b2, 0x19eeaf64e248c7f4, 0x20273e77e3439f82
+  , 0xacc02860f7ce93ac, 0x3933d5817ba76b4c, 0x69e6188b446c8467, 0x0a46036d4417cc55
+  , 0xacc02860f7ce93ac, 0x3933d5817ba76b4c, 0x69e6188b446c8467, 0x0a46036d4417cc55
+  , 0x7271691fc1cf919a, 0xe46ff2671dcb67da, 0x9e6196519f389068, 0x103d0ffafdee00a7
+  , 0x448a93a57b6762df, 0xbfd62df528fdeadf, 0xd858f5d00e9bd47a, 0x06b03d4d3476ec58
+  , 0x2b19daf4bcc936d1, 0xa1a54e7a56f4299f, 0xb533eee05adeaef1, 0x170c812b84dda0b2
+  , 0x2b19daf4bcc936d1, 0xa1a54e7a56f4299f, 0xb533eee05adeaef1, 0x170c812b84dda0b2
+  , 0xf795f8715d159a68, 0xd7ab3c9c3f73dfad, 0xdff74fe672e583e2, 0x29b41125acbab3d0
+  , 0x365316184e46d97d, 0x0af7129ed4c96d9f, 0x659da72fca1009b5, 0x08116d8983a20d23
+  , 0xb1df4af7c39c1939, 0x3d9f02878a73bf7f, 0x9b2220928caf0ae0, 0x26684515eff054a6
+  , 0xb1df4af7c39c1939, 0x3d9f02878a73bf7f, 0x9b2220928caf0ae0, 0x26684515eff054a6
+  , 0x05cd75fe8a3623ca, 0x8c8a57f293a85cee, 0x52b29e86b7714ea8, 0x2852e0e95d8f9306
+  , 0x5764af0aaf46471e, 0xdc50792e873e0fc1, 0x86a673ff881d04f6, 0x0b2eddb43c30a74c
+  , 0x9a490f32787e8580, 0x8fd16d7ff04af8b1, 0x4b39888ec6027bf2, 0x03dd2e705b52a15d
+  , 0x9a490f32787e8580, 0x8fd16d7ff04af8b1, 0x4b39888ec6027bf2, 0x03dd2e705b52a15d
+  , 0xe4bbdd0c2936b629, 0xbb30f162e133bacb, 0x31a9d1b6f9645366, 0x253570bea500f8dd
+  , 0xe0bc4b2275cf559f, 0xc238b945c154e60f, 0x803982a5929a7d5e, 0x15ce052df7e4a37e
+  , 0x2d28efbdbf3799a7, 0x9b097e3c1ad60773, 0x982d4113af4a535b, 0x24e18991e3056063
+  , 0x2d28efbdbf3799a7, 0x9b097e3c1ad60773, 0x982d4113af4a535b, 0x24e18991e3056063
+  , 0x5b6440f462ada7a8, 0xd548b14ba71ce47d, 0x3816c310eee6dafe, 0x1a964944e94cfcab
+  };
+
+
+// computes `x^(p^3)` directly
+void bn128_Fp12_mont_frobenius_3 ( const uint64_t *src, uint64_t *tgt ) {
+  uint64_t acc[EXT_NWORDS];
+  uint64_t tmp[PRIME_NWORDS];
+  bn128_Fp12_mont_set_zero(acc);
+  for(int k=0; k<22; k++) {
+    uint64_t ij = bn128_Fp12_mont_frobenius_3_sparse_indices[k];
+    uint64_t i  = (ij >> 16);
+    uint64_t j  = (ij &  0xffff);
+    bn128_Fp_mont_mul( src + i*PRIME_NWORDS , bn128_Fp12_mont_frobenius_3_sparse_entries + k*PRIME_NWORDS , tmp );
+    bn128_Fp_mont_add_inplace( acc + j*PRIME_NWORDS , tmp );
   }
+  bn128_Fp12_mont_copy( acc, tgt );
+}
+
+void bn128_Fp12_mont_frobenius_3_inplace ( uint64_t *tgt ) {
+  bn128_Fp12_mont_frobenius_3( tgt, tgt );
+}
+
+// computes `x^(p^k)` for `k >= 0`
+void bn128_Fp12_mont_frobenius_k ( const uint64_t *src, int k, uint64_t *tgt ) {
+  bn128_Fp12_mont_copy( src, tgt );
+  k = k % PRIME_DEGREE;
+  while (k >= 3) { bn128_Fp12_mont_frobenius_3_inplace( tgt ); k -= 3; }
+  while (k >= 2) { bn128_Fp12_mont_frobenius_2_inplace( tgt ); k -= 2; }
+  if    (k == 1) { bn128_Fp12_mont_frobenius_inplace( tgt ); }
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+// the nontrivial automorphism over the base field: (a + b*u) -> (a - b*u)
+void bn128_Fp12_mont_conjugate ( const uint64_t *src1, uint64_t *tgt ) {
+  bn128_Fp6_mont_copy( SRC1(0) , TGT(0) );
+  bn128_Fp6_mont_neg ( SRC1(1) , TGT(1) );
+}
+
+void bn128_Fp12_mont_conjugate_inplace ( uint64_t *tgt ) {
+  bn128_Fp6_mont_neg_inplace( TGT(1) );
+}
+
+// inversion of elements with norm 1 over the base field (for example
+// the cyclotomic subgroup), where the inverse is just the conjugate
+void bn128_Fp12_mont_cyclotomic_inv ( const uint64_t *src1, uint64_t *tgt ) {
+  bn128_Fp12_mont_conjugate( src1, tgt );
+}
+
+void bn128_Fp12_mont_cyclotomic_inv_inplace ( uint64_t *tgt ) {
+  bn128_Fp12_mont_conjugate_inplace( tgt );
+}
+
+// the sliding window size used for exponents of the given bit length
+int bn128_Fp12_mont_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bn128_Fp12_mont_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[48];
+  bn128_Fp12_mont_copy( src, table );
+  if (w > 1) {
+    bn128_Fp12_mont_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bn128_Fp12_mont_mul( table + (k-1)*48, x2, table + k*48 );
+    }
+  }
+}
+
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bn128_Fp12_mont_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[48];
-  bn128_Fp12_mont_copy( src, sqr );                 // sqr := src
-  bn128_Fp12_mont_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bn128_Fp12_mont_mul_inplace(tgt, sqr); }
-      bn128_Fp12_mont_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bn128_Fp12_mont_set_one( tgt );
+    return;
+  }
+
+  int w = bn128_Fp12_mont_pow_window_size( nbits );
+  uint64_t table[768];
+  uint64_t acc[48];
+  bn128_Fp12_mont_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bn128_Fp12_mont_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bn128_Fp12_mont_copy( table + (d>>1)*48, acc );
+      first = 0;
     }
+    else {
+      for(int k=i; k>=j; k--) { bn128_Fp12_mont_sqr_inplace( acc ); }
+      bn128_Fp12_mont_mul_inplace( acc, table + (d>>1)*48 );
+    }
+    i = j - 1;
   }
+  bn128_Fp12_mont_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bn128_Fp12_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bn128_Fp12_mont_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bn128_Fp12_mont_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[768];
+  uint64_t acc[48];
+  bn128_Fp12_mont_pow_odd_powers( src, w, table );
+  bn128_Fp12_mont_copy( table + (chain[1]>>1)*48, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bn128_Fp12_mont_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bn128_Fp12_mont_mul_inplace( acc, table + (chain[2*s+1]>>1)*48 ); }
+  }
+  bn128_Fp12_mont_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*48)
@@ -8,6 +8,16 @@ extern void bn128_Fp12_mont_scale_by_prime_field( const uint64_t *coeff , const
 
 extern void bn128_Fp12_mont_frobenius( const uint64_t *src , uint64_t *tgt );
 extern void bn128_Fp12_mont_frobenius_inplace( uint64_t *tgt );
+extern void bn128_Fp12_mont_frobenius_k( const uint64_t *src , int k , uint64_t *tgt );
+extern void bn128_Fp12_mont_frobenius_2( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp12_mont_frobenius_2_inplace( uint64_t *tgt );
+extern void bn128_Fp12_mont_frobenius_3( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp12_mont_frobenius_3_inplace( uint64_t *tgt );
+
+extern void bn128_Fp12_mont_conjugate( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp12_mont_conjugate_inplace( uint64_t *tgt );
+extern void bn128_Fp12_mont_cyclotomic_inv( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp12_mont_cyclotomic_inv_inplace( uint64_t *tgt );
 
 extern uint8_t bn128_Fp12_mont_is_valid ( const uint64_t *src );
 extern uint8_t bn128_Fp12_mont_is_zero  ( const uint64_t *src );
@@ -43,3 +53,4 @@ extern void bn128_Fp12_mont_batch_inv( int n, const uint64_t *src, uint64_t *tgt
 
 extern void bn128_Fp12_mont_pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );
 extern void bn128_Fp12_mont_pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );
+extern void bn128_Fp12_mont_pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );
@@ -278,34 +278,249 @@ void bn128_Fp2_mont_frobenius_inplace ( uint64_t *tgt ) {
   bn128_Fp2_mont_frobenius( tgt, tgt );
 }
 
-// computes `x^e mod p`
-void bn128_Fp2_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[8];
-  bn128_Fp2_mont_copy( src, sqr );                 // sqr := src
-  bn128_Fp2_mont_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bn128_Fp2_mont_mul_inplace(tgt, sqr); }
-    bn128_Fp2_mont_mul_inplace(sqr, sqr);
-    e = e >> 1;
+
+// computes `x^(p^k)` for `k >= 0`
+void bn128_Fp2_mont_frobenius_k ( const uint64_t *src, int k, uint64_t *tgt ) {
+  bn128_Fp2_mont_copy( src, tgt );
+  k = k % PRIME_DEGREE;
+  if    (k == 1) { bn128_Fp2_mont_frobenius_inplace( tgt ); }
+}
+
+// the nontrivial automorphism over the base field: (a + b*u) -> (a - b*u)
+void bn128_Fp2_mont_conjugate ( const uint64_t *src1, uint64_t *tgt ) {
+  bn128_Fp_mont_copy( SRC1(0) , TGT(0) );
+  bn128_Fp_mont_neg ( SRC1(1) , TGT(1) );
+}
+
+void bn128_Fp2_mont_conjugate_inplace ( uint64_t *tgt ) {
+  bn128_Fp_mont_neg_inplace( TGT(1) );
+}
+
+// inversion of elements with norm 1 over the base field (for example
+// the cyclotomic subgroup), where the inverse is just the conjugate
+void bn128_Fp2_mont_cyclotomic_inv ( const uint64_t *src1, uint64_t *tgt ) {
+  bn128_Fp2_mont_conjugate( src1, tgt );
+}
+
+void bn128_Fp2_mont_cyclotomic_inv_inplace ( uint64_t *tgt ) {
+  bn128_Fp2_mont_conjugate_inplace( tgt );
+}
+
+// checks whether the element is a square: (a + b*u) is a square
+// if and only if its norm (a^2 + b^2) is a square in the base field
+uint8_t bn128_Fp2_mont_is_square( const uint64_t *src1 ) {
+  uint64_t norm[BASE_NWORDS];
+  uint64_t tmp [BASE_NWORDS];
+  bn128_Fp_mont_sqr( SRC1(0) , norm );
+  bn128_Fp_mont_sqr( SRC1(1) , tmp  );
+  bn128_Fp_mont_add_inplace( norm , tmp );
+  return bn128_Fp_mont_is_square( norm );
+}
+
+// computes a square root; returns 1 if it exists.
+// If there is no square root, the result is set to zero and 0 is returned.
+uint8_t bn128_Fp2_mont_sqrt( const uint64_t *src1, uint64_t *tgt ) {
+  uint64_t s[BASE_NWORDS];
+  uint64_t c[BASE_NWORDS];
+  uint64_t d[BASE_NWORDS];
+  if (bn128_Fp_mont_is_zero( SRC1(1) )) {
+    // a + 0*u: the root is either sqrt(a) or sqrt(-a)*u (as -1 is not a square)
+    if (bn128_Fp_mont_sqrt( SRC1(0) , c )) {
+      bn128_Fp_mont_copy( c , TGT(0) );
+      bn128_Fp_mont_set_zero( TGT(1) );
+    }
+    else {
+      bn128_Fp_mont_neg( SRC1(0) , d );
+      bn128_Fp_mont_sqrt( d , TGT(1) );
+      bn128_Fp_mont_set_zero( TGT(0) );
+    }
+    return 1;
+  }
+  bn128_Fp_mont_sqr( SRC1(0) , s );
+  bn128_Fp_mont_sqr( SRC1(1) , d );
+  bn128_Fp_mont_add_inplace( s , d );               // a^2 + b^2
+  if (!bn128_Fp_mont_sqrt( s , s )) {
+    bn128_Fp2_mont_set_zero( tgt );
+    return 0;
+  }
+  bn128_Fp_mont_add( SRC1(0) , s , d );
+  bn128_Fp_mont_div_by_2_inplace( d );              // (a + sqrt(a^2+b^2)) / 2
+  if (!bn128_Fp_mont_sqrt( d , c )) {
+    bn128_Fp_mont_sub( SRC1(0) , s , d );
+    bn128_Fp_mont_div_by_2_inplace( d );            // (a - sqrt(a^2+b^2)) / 2
+    bn128_Fp_mont_sqrt( d , c );
+  }
+  bn128_Fp_mont_add( c , c , d );
+  bn128_Fp_mont_inv_inplace( d );
+  bn128_Fp_mont_mul_inplace( d , SRC1(1) );         // d = b / (2*c)
+  bn128_Fp_mont_copy( c , TGT(0) );
+  bn128_Fp_mont_copy( d , TGT(1) );
+  return 1;
+}
+
+// branch-free versions of the basic operations (for the constant-time scalar multiplication)
+
+void bn128_Fp2_mont_neg_ct ( const uint64_t *src1, uint64_t *tgt ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_neg_ct( SRC1(k) , TGT(k) );
+  }
+}
+
+void bn128_Fp2_mont_add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_add_ct( SRC1(k) , SRC2(k) , TGT(k) );
+  }
+}
+
+void bn128_Fp2_mont_sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_sub_ct( SRC1(k) , SRC2(k) , TGT(k) );
   }
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+void bn128_Fp2_mont_add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_add_inplace_ct( TGT(k) , SRC2(k) );
+  }
+}
+
+void bn128_Fp2_mont_sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_sub_inplace_ct( TGT(k) , SRC2(k) );
+  }
+}
+
+void bn128_Fp2_mont_sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 ) {
+  for(int k=0; k<EXT_DEGREE; k++) {
+    bn128_Fp_mont_sub_inplace_reverse_ct( TGT(k) , SRC1(k) );
+  }
+}
+
+// we use Karatsuba trick to have only 3 multiplications
+void bn128_Fp2_mont_mul_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint64_t p[BASE_NWORDS];
+  uint64_t q[BASE_NWORDS];
+  uint64_t r[BASE_NWORDS];
+  uint64_t tmp[BASE_NWORDS];
+  bn128_Fp_mont_mul_ct( SRC1(0) , SRC2(0) , p );         // a0*b0
+  bn128_Fp_mont_mul_ct( SRC1(1) , SRC2(1) , r );         // a1*b1
+  bn128_Fp_mont_add_ct( SRC1(0) , SRC1(1) , q );         // (a0+a1)
+  bn128_Fp_mont_add_ct( SRC2(0) , SRC2(1) , tmp );       // (b0+b1)
+  bn128_Fp_mont_mul_inplace_ct( q , tmp );               // (a0+a1)*(b0+b1)
+  bn128_Fp_mont_sub_inplace_ct( q , p );
+  bn128_Fp_mont_sub_inplace_ct( q , r );
+  bn128_Fp_mont_sub_ct(  p , r , TGT(0) );
+  bn128_Fp_mont_copy( q ,     TGT(1) );
+}
+
+// we use Karatsuba trick to have only 3 squarings
+void bn128_Fp2_mont_sqr_ct ( const uint64_t *src1, uint64_t *tgt ) {
+  uint64_t p[BASE_NWORDS];
+  uint64_t q[BASE_NWORDS];
+  uint64_t r[BASE_NWORDS];
+  uint64_t tmp[BASE_NWORDS];
+  bn128_Fp_mont_sqr_ct( SRC1(0) , p );              // a0^2
+  bn128_Fp_mont_sqr_ct( SRC1(1) , r );              // a1^2
+  bn128_Fp_mont_add_ct( SRC1(0) , SRC1(1) , q );    // (a0+a1)
+  bn128_Fp_mont_sqr_inplace_ct( q );                // (a0+a1)^2
+  bn128_Fp_mont_sub_inplace_ct( q , p );
+  bn128_Fp_mont_sub_inplace_ct( q , r );
+  bn128_Fp_mont_sub_ct(  p , r , TGT(0) );
+  bn128_Fp_mont_copy( q ,     TGT(1) );
+}
+
+void bn128_Fp2_mont_mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2 ) {
+  bn128_Fp2_mont_mul_ct( tgt, src2, tgt );
+}
+
+void bn128_Fp2_mont_sqr_inplace_ct ( uint64_t *tgt ) {
+  bn128_Fp2_mont_sqr_ct( tgt, tgt );
+}
+
+// the sliding window size used for exponents of the given bit length
+int bn128_Fp2_mont_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bn128_Fp2_mont_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[8];
+  bn128_Fp2_mont_copy( src, table );
+  if (w > 1) {
+    bn128_Fp2_mont_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bn128_Fp2_mont_mul( table + (k-1)*8, x2, table + k*8 );
+    }
+  }
+}
+
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bn128_Fp2_mont_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[8];
-  bn128_Fp2_mont_copy( src, sqr );                 // sqr := src
-  bn128_Fp2_mont_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bn128_Fp2_mont_mul_inplace(tgt, sqr); }
-      bn128_Fp2_mont_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bn128_Fp2_mont_set_one( tgt );
+    return;
+  }
+
+  int w = bn128_Fp2_mont_pow_window_size( nbits );
+  uint64_t table[128];
+  uint64_t acc[8];
+  bn128_Fp2_mont_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bn128_Fp2_mont_sqr_inplace( acc );
+      i--;
+      continue;
     }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bn128_Fp2_mont_copy( table + (d>>1)*8, acc );
+      first = 0;
+    }
+    else {
+      for(int k=i; k>=j; k--) { bn128_Fp2_mont_sqr_inplace( acc ); }
+      bn128_Fp2_mont_mul_inplace( acc, table + (d>>1)*8 );
+    }
+    i = j - 1;
+  }
+  bn128_Fp2_mont_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bn128_Fp2_mont_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bn128_Fp2_mont_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bn128_Fp2_mont_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[128];
+  uint64_t acc[8];
+  bn128_Fp2_mont_pow_odd_powers( src, w, table );
+  bn128_Fp2_mont_copy( table + (chain[1]>>1)*8, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bn128_Fp2_mont_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bn128_Fp2_mont_mul_inplace( acc, table + (chain[2*s+1]>>1)*8 ); }
   }
+  bn128_Fp2_mont_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*8)
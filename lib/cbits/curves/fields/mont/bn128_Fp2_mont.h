@@ -8,6 +8,12 @@ extern void bn128_Fp2_mont_scale_by_prime_field( const uint64_t *coeff , const u
 
 extern void bn128_Fp2_mont_frobenius( const uint64_t *src , uint64_t *tgt );
 extern void bn128_Fp2_mont_frobenius_inplace( uint64_t *tgt );
+extern void bn128_Fp2_mont_frobenius_k( const uint64_t *src , int k , uint64_t *tgt );
+
+extern void bn128_Fp2_mont_conjugate( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp2_mont_conjugate_inplace( uint64_t *tgt );
+extern void bn128_Fp2_mont_cyclotomic_inv( const uint64_t *src , uint64_t *tgt );
+extern void bn128_Fp2_mont_cyclotomic_inv_inplace( uint64_t *tgt );
 
 extern uint8_t bn128_Fp2_mont_is_valid ( const uint64_t *src );
 extern uint8_t bn128_Fp2_mont_is_zero  ( const uint64_t *src );
@@ -43,3 +49,19 @@ extern void bn128_Fp2_mont_batch_inv( int n, const uint64_t *src, uint64_t *tgt
 
 extern void bn128_Fp2_mont_pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );
 extern void bn128_Fp2_mont_pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );
+extern void bn128_Fp2_mont_pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );
+
+extern uint8_t bn128_Fp2_mont_is_square ( const uint64_t *src );
+extern uint8_t bn128_Fp2_mont_sqrt      ( const uint64_t *src, uint64_t *tgt );
+
+extern void bn128_Fp2_mont_neg_ct ( const uint64_t *src ,       uint64_t *tgt );
+extern void bn128_Fp2_mont_add_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+extern void bn128_Fp2_mont_sub_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+extern void bn128_Fp2_mont_sqr_ct ( const uint64_t *src ,       uint64_t *tgt );
+extern void bn128_Fp2_mont_mul_ct ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+
+extern void bn128_Fp2_mont_add_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );
+extern void bn128_Fp2_mont_sub_inplace_ct ( uint64_t *tgt , const uint64_t *src2 );
+extern void bn128_Fp2_mont_sqr_inplace_ct ( uint64_t *tgt );
+extern void bn128_Fp2_mont_mul_inplace_ct ( uint64_t *tgt , const uint64_t *src2);
+extern void bn128_Fp2_mont_sub_inplace_reverse_ct ( uint64_t *tgt , const uint64_t *src1 );
@@ -36,4 +36,5 @@ extern void bls12_381_Fp_std_reduce_modp     ( const uint64_t *src , uint64_t *t
 
 extern void bls12_381_Fp_std_pow_uint64( const uint64_t *src,       uint64_t  exponent, uint64_t *tgt );
 extern void bls12_381_Fp_std_pow_gen   ( const uint64_t *src, const uint64_t *expo    , uint64_t *tgt, int expo_len );
+extern void bls12_381_Fp_std_pow_chain ( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt );
 
@@ -342,34 +342,90 @@ void bn128_Fr_std_div_inplace( uint64_t *tgt, const uint64_t *src2 ) {
   bn128_Fr_std_div(tgt,src2,tgt);
 }
 
-// computes `x^e mod p`
-void bn128_Fr_std_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
-  uint64_t e = exponent;
-  uint64_t sqr[4];
-  bn128_Fr_std_copy( src, sqr );                 // sqr := src
-  bn128_Fr_std_set_one( tgt );                   // tgt := 1
-  while(e!=0) {
-    if (e & 1) { bn128_Fr_std_mul_inplace(tgt, sqr); }
-    bn128_Fr_std_mul_inplace(sqr, sqr);
-    e = e >> 1;
+// the sliding window size used for exponents of the given bit length
+int bn128_Fr_std_pow_window_size( int nbits ) {
+  if (nbits <=  16) return 1;
+  if (nbits <=  64) return 3;
+  if (nbits <= 240) return 4;
+  return 5;
+}
+
+// precomputes the odd powers `x^(2k+1)` for `0 <= k < 2^(w-1)` (at most 16 of them)
+void bn128_Fr_std_pow_odd_powers( const uint64_t *src, int w, uint64_t *table ) {
+  uint64_t x2[4];
+  bn128_Fr_std_copy( src, table );
+  if (w > 1) {
+    bn128_Fr_std_sqr( src, x2 );
+    for(int k=1; k<(1<<(w-1)); k++) {
+      bn128_Fr_std_mul( table + (k-1)*4, x2, table + k*4 );
+    }
   }
 }
 
-// computes `x^e mod p` (for `e` non-negative bigint)
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// computes `x^e mod p` (for `e` non-negative bigint), using left-to-right
+// sliding windows over the bits of the exponent, with precomputed odd powers
 void bn128_Fr_std_pow_gen( const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len ) {
-  uint64_t sqr[4];
-  bn128_Fr_std_copy( src, sqr );                 // sqr := src
-  bn128_Fr_std_set_one( tgt );                   // tgt := 1
-  int s = expo_len - 1;
-  while ((expo[s] == 0) && (s>0)) { s--; }          // skip the unneeded largest powers
-  for(int i=0; i<=s; i++) {
-    uint64_t e = expo[i];
-    for(int j=0; j<64; j++) {
-      if (e & 1) { bn128_Fr_std_mul_inplace(tgt, sqr); }
-      bn128_Fr_std_mul_inplace(sqr, sqr);
-      e = e >> 1;
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }     // skip the leading zero bits
+  if (nbits == 0) {
+    bn128_Fr_std_set_one( tgt );
+    return;
+  }
+
+  int w = bn128_Fr_std_pow_window_size( nbits );
+  uint64_t table[64];
+  uint64_t acc[4];
+  bn128_Fr_std_pow_odd_powers( src, w, table );
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bn128_Fr_std_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    // the longest window `e[i..j]` of at most `w` bits, ending with a 1 bit
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bn128_Fr_std_copy( table + (d>>1)*4, acc );
+      first = 0;
     }
+    else {
+      for(int k=i; k>=j; k--) { bn128_Fr_std_sqr_inplace( acc ); }
+      bn128_Fr_std_mul_inplace( acc, table + (d>>1)*4 );
+    }
+    i = j - 1;
+  }
+  bn128_Fr_std_copy( acc, tgt );
+}
+
+#undef EXPO_BIT
+
+// computes `x^e mod p`
+void bn128_Fr_std_pow_uint64( const uint64_t *src, uint64_t exponent, uint64_t *tgt ) {
+  bn128_Fr_std_pow_gen( src, &exponent, tgt, 1 );
+}
+
+// computes `x^e` for a fixed exponent, given as a precomputed addition chain of
+// `nsteps` (number of squarings, odd digit) steps, using windows of size `w`.
+// The first step initializes the result, and the digit 0 means no multiplication.
+// Note: the sequence of operations only depends on the (fixed) exponent.
+void bn128_Fr_std_pow_chain( const uint64_t *src, int w, int nsteps, const uint8_t *chain, uint64_t *tgt ) {
+  uint64_t table[64];
+  uint64_t acc[4];
+  bn128_Fr_std_pow_odd_powers( src, w, table );
+  bn128_Fr_std_copy( table + (chain[1]>>1)*4, acc );
+  for(int s=1; s<nsteps; s++) {
+    for(int k=0; k<chain[2*s]; k++) { bn128_Fr_std_sqr_inplace( acc ); }
+    if (chain[2*s+1]) { bn128_Fr_std_mul_inplace( acc, table + (chain[2*s+1]>>1)*4 ); }
   }
+  bn128_Fr_std_copy( acc, tgt );
 }
 
 #define I_SRC(i)   (src    + (i)*4)
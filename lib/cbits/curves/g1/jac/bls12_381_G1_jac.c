@@ -1,5 +1,5 @@
 
-// elliptic curve "BLS12-381" in projective coordinates, Montgomery field representation
+// elliptic curve "BLS12-381 ( Fp ) " in Jacobian coordinates, Montgomery field representation
 //
 // NOTE: generated code, do not edit!
 
@@ -11,8 +11,11 @@
 
 #include "bls12_381_G1_jac.h"
 #include "bls12_381_G1_affine.h"
+#include "bls12_381_G1_xyzz.h"
 #include "bls12_381_Fp_mont.h"
 #include "bls12_381_Fr_mont.h"
+#include "bigint256.h"
+#include "parallel.h"
 
 #define NLIMBS_P 6
 #define NLIMBS_R 4
@@ -35,6 +38,14 @@ const uint64_t bls12_381_G1_jac_gen_G1[18] = { 0x5cb38790fd530c16, 0x7817fc67997
 // the cofactor of the curve subgroup = 76329603384216526031706109802092473003
 const uint64_t bls12_381_G1_jac_cofactor[6] = { 0x8c00aaab0000aaab, 0x396c8c005555e156, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
+// the order of the subgroup = 52435875175126190479447740508185965837690552500527637822603658699938581184513
+const uint64_t bls12_381_G1_jac_subgroup_order[4] = { 0xffffffff00000001, 0x53bda402fffe5bfe, 0x3339d80809a1d805, 0x73eda753299d7d48 };
+
+// the constants A and B of the equation
+const uint64_t bls12_381_G1_jac_const_A[6] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G1_jac_const_B[6] = { 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e };
+const uint64_t bls12_381_G1_jac_const_3B[6] = { 0x447600000027552e, 0xdcb8009a43480020, 0x6f7ee9ce4a6e8b59, 0xb10330b7c0a95bc6, 0x6140b1fcfb1e54b7, 0x0381be097f0bb4e1 };
+
 //------------------------------------------------------------------------------
 
 // scale a field element by A = 0
@@ -45,7 +56,6 @@ void bls12_381_G1_jac_scale_by_A(const uint64_t *src, uint64_t *tgt ) {
 void bls12_381_G1_jac_scale_by_A_inplace( uint64_t *tgt ) {
   memset( tgt, 0, 48 );
 }
-
 // scale a field element by B = 4
 void bls12_381_G1_jac_scale_by_B(const uint64_t *src, uint64_t *tgt ) {
   uint64_t tmp[6];
@@ -58,6 +68,19 @@ void bls12_381_G1_jac_scale_by_B_inplace( uint64_t *tgt ) {
   bls12_381_Fp_mont_add( tgt, tgt, tmp );
   bls12_381_Fp_mont_add( tmp, tmp, tgt );
 }
+// scale a field element by (3*B) = 12
+void bls12_381_G1_jac_scale_by_3B(const uint64_t *src, uint64_t *tgt ) {
+  uint64_t tmp [NLIMBS_P];
+  uint64_t tmp2[NLIMBS_P];
+  bls12_381_Fp_mont_add( src, src, tmp );       // 2*B
+  bls12_381_Fp_mont_add_inplace( tmp, tmp );    // 4*B
+  bls12_381_Fp_mont_add( tmp, tmp, tmp2);       // 8*B
+  bls12_381_Fp_mont_add( tmp, tmp2, tgt );      // 12*B
+}
+
+void bls12_381_G1_jac_scale_by_3B_inplace( uint64_t *tgt ) {
+  bls12_381_G1_jac_scale_by_3B( tgt , tgt );
+}
 
 void bls12_381_G1_jac_normalize( const uint64_t *src1, uint64_t *tgt ) {
   if (bls12_381_Fp_mont_is_zero( Z1 ) ) {
@@ -146,15 +169,90 @@ void bls12_381_G1_jac_batch_from_affine( int N, const uint64_t *src , uint64_t *
   }
 }
 
-// converts N points to affine coordinates
+// converts N points to affine coordinates, using a single field inversion for
+// all of them (Montgomery's batch inversion trick). Points at infinity are skipped
+// in the running product, and result in the special affine infinity.
+// Note: the output may overlap with the input, as long as `tgt <= src`
 void bls12_381_G1_jac_batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {
-  const uint64_t *p = src;
-  uint64_t *q = tgt;
+  if (N <= 0) return;
+  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );
+  assert( zinvs != 0 );
+
+  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th
+  uint64_t acc[NLIMBS_P];
+  bls12_381_Fp_mont_set_one( acc );
   for(int i=0; i<N; i++) {
-    bls12_381_G1_jac_to_affine(p,q);
-    p += 3*NLIMBS_P;
-    q += 2*NLIMBS_P;
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    bls12_381_Fp_mont_copy( acc , zinvs + i*NLIMBS_P );
+    if (!bls12_381_Fp_mont_is_zero( z )) { bls12_381_Fp_mont_mul_inplace( acc , z ); }
+  }
+
+  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]
+  bls12_381_Fp_mont_inv_inplace( acc );
+  for(int i=N-1; i>=0; i--) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    if (!bls12_381_Fp_mont_is_zero( z )) {
+      bls12_381_Fp_mont_mul_inplace( zinvs + i*NLIMBS_P , acc );
+      bls12_381_Fp_mont_mul_inplace( acc , z );
+    }
   }
+
+  for(int i=0; i<N; i++) {
+    const uint64_t *p = src + 3*i*NLIMBS_P;
+    uint64_t       *q = tgt + 2*i*NLIMBS_P;
+    if (bls12_381_Fp_mont_is_zero( p + 2*NLIMBS_P )) {
+      memset( q, 0xff, 96 );
+    }
+    else {
+      const uint64_t *zinv = zinvs + i*NLIMBS_P;
+      uint64_t zinv2[NLIMBS_P];
+      uint64_t zinv3[NLIMBS_P];
+      bls12_381_Fp_mont_sqr( zinv , zinv2 );
+      bls12_381_Fp_mont_mul( zinv , zinv2 , zinv3 );
+      bls12_381_Fp_mont_mul( p            , zinv2 , q            );
+      bls12_381_Fp_mont_mul( p + NLIMBS_P , zinv3 , q + NLIMBS_P );
+    }
+  }
+
+  free(zinvs);
+}
+
+// below this many points, the parallel version simply calls the sequential one
+#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024
+
+typedef struct {
+  int N;
+  int chunk;
+  const uint64_t *src;
+  uint64_t *tgt;
+} bls12_381_G1_jac_batch_to_affine_ctx_t;
+
+void bls12_381_G1_jac_batch_to_affine_task( void *ctx, int j ) {
+  bls12_381_G1_jac_batch_to_affine_ctx_t *c = (bls12_381_G1_jac_batch_to_affine_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  bls12_381_G1_jac_batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );
+}
+
+// converts N points to affine coordinates, splitting them into chunks which are
+// converted in parallel (each chunk with a single inversion). For small inputs,
+// or with a single thread, this is the same as `batch_to_affine`.
+// Note: unlike `batch_to_affine`, the output must not overlap with the input
+void bls12_381_G1_jac_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {
+  int T = parallel_get_num_threads();
+  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {
+    bls12_381_G1_jac_batch_to_affine( N, src, tgt );
+    return;
+  }
+  int chunk = (N + T - 1) / T;
+  int m     = (N + chunk - 1) / chunk;
+  bls12_381_G1_jac_batch_to_affine_ctx_t ctx;
+  ctx.N     = N;
+  ctx.chunk = chunk;
+  ctx.src   = src;
+  ctx.tgt   = tgt;
+  parallel_for( m, bls12_381_G1_jac_batch_to_affine_task, &ctx );
 }
 
 void bls12_381_G1_jac_copy( const uint64_t *src1 , uint64_t *tgt ) {
@@ -215,7 +313,7 @@ uint8_t bls12_381_G1_jac_is_in_subgroup ( const uint64_t *src1 ) {
     return 0;
   }
   else {
-    bls12_381_G1_jac_scl_Fr_std( bls12_381_G1_jac_cofactor , src1 , tmp );
+    bls12_381_G1_jac_scl_generic( bls12_381_G1_jac_subgroup_order , src1 , tmp , NLIMBS_R );
     return bls12_381_G1_jac_is_infinity( tmp );
   }
 }
@@ -231,41 +329,35 @@ void bls12_381_G1_jac_neg_inplace( uint64_t *tgt ) {
   bls12_381_Fp_mont_neg_inplace( Y3 );
 }
 
-// doubles an elliptic curve point
-// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html#doubling-dbl-2007-bl>
+// doubles an elliptic curve point, assuming A = 0
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-0.html#doubling-dbl-2009-l>
 void bls12_381_G1_jac_dbl( const uint64_t *src1, uint64_t *tgt ) {
-  uint64_t   XX[6];
-  uint64_t   YY[6];
-  uint64_t YYYY[6];
-  uint64_t   ZZ[6];
-  uint64_t    S[6];
-  uint64_t    M[6];
-  uint64_t    T[6];
-  bls12_381_Fp_mont_sqr( X1, XX );           // XX = X1^2
-  bls12_381_Fp_mont_sqr( Y1, YY );           // YY = Y1^2
-  bls12_381_Fp_mont_sqr( YY, YYYY );         // YYYY = Y1^4
-  bls12_381_Fp_mont_sqr( Z1, ZZ );           // ZZ = Z1^2
-  bls12_381_Fp_mont_add( X1, YY , S );       // = (X1+YY)
-  bls12_381_Fp_mont_sqr_inplace( S );        // = (X1+YY)^2
-  bls12_381_Fp_mont_sub_inplace( S, XX );    // = (X1+YY)^2 - XX
-  bls12_381_Fp_mont_sub_inplace( S, YYYY );  // = (X1+YY)^2 - XX -YYYY
-  bls12_381_Fp_mont_add_inplace( S, S );     // = S = 2*((X1+YY)^2-XX-YYYY)
-  bls12_381_Fp_mont_add( XX, XX, M );        // = 2*XX
-  bls12_381_Fp_mont_add_inplace( M, XX );    // M = 3*XX
-  bls12_381_Fp_mont_sqr( M, T );                // T = M^2
-  bls12_381_Fp_mont_sub_inplace( T, S );        // T = M^2 - S
-  bls12_381_Fp_mont_sub_inplace( T, S );        // T = M^2 - 2*S
-  bls12_381_Fp_mont_copy( T, X3 );              // X3  = T
-  bls12_381_Fp_mont_add( Z1, Y1, Z3 );          // Z3  = Y1+Z1
-  bls12_381_Fp_mont_sqr_inplace( Z3 );          // Z3  = (Y1+Z1)^2
-  bls12_381_Fp_mont_sub_inplace( Z3, YY );      // Z3  = (Y1+Z1)^2 - YY
-  bls12_381_Fp_mont_sub_inplace( Z3, ZZ );      // Z3  = (Y1+Z1)^2 - YY - ZZ
-  bls12_381_Fp_mont_sub( S, T, Y3 );            // Y3  = S - T
-  bls12_381_Fp_mont_mul_inplace( Y3, M );       // Y3  = M*(S - T)
-  bls12_381_Fp_mont_add_inplace( YYYY , YYYY ); // 2 * YYYY
-  bls12_381_Fp_mont_add_inplace( YYYY , YYYY ); // 4 * YYYY
-  bls12_381_Fp_mont_add_inplace( YYYY , YYYY ); // 8 * YYYY
-  bls12_381_Fp_mont_sub_inplace( Y3 , YYYY);    // Y3  = M*(S - T) - 8*YYYY
+  uint64_t A[6];
+  uint64_t B[6];
+  uint64_t C[6];
+  uint64_t D[6];
+  uint64_t E[6];
+  bls12_381_Fp_mont_sqr( X1, A );               // A  = X1^2
+  bls12_381_Fp_mont_sqr( Y1, B );               // B  = Y1^2
+  bls12_381_Fp_mont_sqr( B , C );               // C  = B^2
+  bls12_381_Fp_mont_add( X1, B, D );            // D  = X1+B
+  bls12_381_Fp_mont_sqr_inplace( D );           // D  = (X1+B)^2
+  bls12_381_Fp_mont_sub_inplace( D, A );        // D  = (X1+B)^2 - A
+  bls12_381_Fp_mont_sub_inplace( D, C );        // D  = (X1+B)^2 - A - C
+  bls12_381_Fp_mont_add_inplace( D, D );        // D  = 2*((X1+B)^2 - A - C)
+  bls12_381_Fp_mont_add( A, A, E );             // E  = 2*A
+  bls12_381_Fp_mont_add_inplace( E, A );        // E  = 3*A
+  bls12_381_Fp_mont_mul( Y1, Z1, Z3 );          // Z3 = Y1*Z1
+  bls12_381_Fp_mont_add_inplace( Z3, Z3 );      // Z3 = 2*Y1*Z1
+  bls12_381_Fp_mont_sqr( E, X3 );               // X3 = F = E^2
+  bls12_381_Fp_mont_sub_inplace( X3, D );       // X3 = F - D
+  bls12_381_Fp_mont_sub_inplace( X3, D );       // X3 = F - 2*D
+  bls12_381_Fp_mont_sub( D, X3, Y3 );           // Y3 = D - X3
+  bls12_381_Fp_mont_mul_inplace( Y3, E );       // Y3 = E*(D - X3)
+  bls12_381_Fp_mont_add_inplace( C, C );        // 2*C
+  bls12_381_Fp_mont_add_inplace( C, C );        // 4*C
+  bls12_381_Fp_mont_add_inplace( C, C );        // 8*C
+  bls12_381_Fp_mont_sub_inplace( Y3, C );       // Y3 = E*(D - X3) - 8*C
 }
 
 // doubles an elliptic curve point
@@ -511,19 +603,19 @@ void bls12_381_G1_jac_scl_windowed(const uint64_t *expo, const uint64_t *grp, ui
 }
 
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
-// where `grp` is a group element in G1, and `expo` is in Fr
+// where `grp` is a group element in G, and `expo` is in Fr
 void bls12_381_G1_jac_scl_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int nlimbs) {
   bls12_381_G1_jac_scl_windowed(expo, grp, tgt, nlimbs);
 }
 
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
-// where `grp` is a group element in G1, and `expo` is in Fr *in standard repr*
+// where `grp` is a group element in G, and `expo` is in Fr *in standard repr*
 void bls12_381_G1_jac_scl_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
   bls12_381_G1_jac_scl_generic(expo, grp, tgt, NLIMBS_R);
 }
 
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
-// where `grp` is a group element in G1, and `expo` is in Fr *in Montgomery repr*
+// where `grp` is a group element in G, and `expo` is in Fr *in Montgomery repr*
 void bls12_381_G1_jac_scl_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
   uint64_t expo_std[NLIMBS_R];
   bls12_381_Fr_mont_to_std(expo, expo_std);
@@ -531,27 +623,153 @@ void bls12_381_G1_jac_scl_Fr_mont(const uint64_t *expo, const uint64_t *grp, uin
 }
 
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
-// where `grp` is a group element in G1, and `expo` is the same size as Fp
+// where `grp` is a group element in G, and `expo` is the same size as Fp
 void bls12_381_G1_jac_scl_big(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
   bls12_381_G1_jac_scl_generic(expo, grp, tgt, NLIMBS_P);
 }
 
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
-// where `grp` is a group element in G1, and `expo` is a 64 bit (unsigned!) word
+// where `grp` is a group element in G, and `expo` is a 64 bit (unsigned!) word
 void bls12_381_G1_jac_scl_small(uint64_t expo, const uint64_t *grp, uint64_t *tgt) {
   uint64_t expo_vec[1];
   expo_vec[0] = expo;
   bls12_381_G1_jac_scl_generic(expo_vec, grp, tgt, 1);
 }
 
+//------------------------------------------------------------------------------
+// GLV scalar multiplication
+//
+// The endomorphism `phi(x,y) = (beta*x,y)` (where `beta` is a cube root of unity)
+// acts on the subgroup G1 as multiplication by `lambda`. Writing the scalar as
+// `k = k1 + k2*lambda` with `|k1|,|k2| ~ sqrt(r)`, we can compute
+//
+//   k*P = k1*P + k2*phi(P)
+//
+// with half as many doublings as a standard scalar multiplication.
+
+// beta (Montgomery repr)
+const uint64_t bls12_381_G1_jac_glv_beta[6] = { 0xcd03c9e48671f071, 0x5dab22461fcda5d2, 0x587042afd3851b95, 0x8eb60ebe01bacb9e, 0x03f97d6e83d050d2, 0x18f0206554638741 };
+
+// a short basis `(a1,b1), (a2,b2)` of the lattice `{ (a,b) | a + b*lambda = 0 mod r }`
+// with determinant `r`, as two's complement numbers
+const uint64_t bls12_381_G1_jac_glv_a1[4] = { 0x00000000ffffffff, 0xac45a4010001a402, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G1_jac_glv_b1[4] = { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff };
+const uint64_t bls12_381_G1_jac_glv_a2[4] = { 0x0000000000000001, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G1_jac_glv_b2[4] = { 0x0000000100000000, 0xac45a4010001a402, 0x0000000000000000, 0x0000000000000000 };
+
+// `g1 = round(2^256 * b2 / r)` and `g2 = round(-2^256 * b1 / r)`
+const uint64_t bls12_381_G1_jac_glv_g1[4] = { 0x63f6e522f6cfee30, 0x7c6becf1e01faadd, 0x0000000000000001, 0x0000000000000000 };
+const uint64_t bls12_381_G1_jac_glv_g2[4] = { 0x0000000000000002, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+
+// the endomorphism `phi(x,y) = (beta*x,y)`
+void bls12_381_G1_jac_endo_phi( const uint64_t *src1, uint64_t *tgt ) {
+  bls12_381_Fp_mont_mul( X1 , bls12_381_G1_jac_glv_beta , X3 );
+  if (tgt != src1) { memcpy( Y3, Y1, 96 ); }
+}
+
+// computes `c = round( k*g / 2^256 )`
+void bls12_381_G1_jac_glv_round_mul( const uint64_t *k, const uint64_t *g, uint64_t *c ) {
+  uint64_t prod[2*NLIMBS_R];
+  bigint256_mul( k , g , prod );
+  memcpy( c , prod + NLIMBS_R , 8*NLIMBS_R );
+  if (prod[NLIMBS_R-1] >> 63) { bigint256_inc_inplace( c ); }
+}
+
+// Decomposes a scalar `0 <= k < r` (in standard repr) as `k = k1 + k2*lambda (mod r)`,
+// using Babai rounding with the short basis above. The absolute values (which are at
+// most 128 bits) are written into `k1` and `k2`, the signs are returned in the
+// bits 0 and 1 of the result.
+int bls12_381_G1_jac_glv_decompose( const uint64_t *k, uint64_t *k1, uint64_t *k2 ) {
+  uint64_t c1[NLIMBS_R];
+  uint64_t c2[NLIMBS_R];
+  uint64_t t [NLIMBS_R];
+  bls12_381_G1_jac_glv_round_mul( k , bls12_381_G1_jac_glv_g1 , c1 );
+  bls12_381_G1_jac_glv_round_mul( k , bls12_381_G1_jac_glv_g2 , c2 );
+
+  // k1 = k - c1*a1 - c2*a2
+  bigint256_copy( k , k1 );
+  bigint256_mul_truncated( c1 , bls12_381_G1_jac_glv_a1 , t );  bigint256_sub_inplace( k1 , t );
+  bigint256_mul_truncated( c2 , bls12_381_G1_jac_glv_a2 , t );  bigint256_sub_inplace( k1 , t );
+
+  // k2 = - c1*b1 - c2*b2
+  bigint256_mul_truncated( c1 , bls12_381_G1_jac_glv_b1 , k2 );
+  bigint256_mul_truncated( c2 , bls12_381_G1_jac_glv_b2 , t  );  bigint256_add_inplace( k2 , t );
+  bigint256_neg_inplace( k2 );
+
+  int signs = 0;
+  if (k1[NLIMBS_R-1] >> 63) { bigint256_neg_inplace( k1 ); signs |= 1; }
+  if (k2[NLIMBS_R-1] >> 63) { bigint256_neg_inplace( k2 ); signs |= 2; }
+  return signs;
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G1, and `expo` is in Fr *in standard repr*,
+// using the GLV decomposition and interleaved 4-bit windows.
+// Note: this is only valid for points in the subgroup G1!
+void bls12_381_G1_jac_scl_glv_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t k1[NLIMBS_R];
+  uint64_t k2[NLIMBS_R];
+  int signs = bls12_381_G1_jac_glv_decompose( expo , k1 , k2 );
+
+  // precalculate [ k*(+-g) | k <- [1..15] ] and [ k*(+-phi(g)) | k <- [1..15] ];
+  // since `phi` is a group homomorphism, the second table is the image of the first
+  uint64_t table1[15*3*NLIMBS_P];
+  uint64_t table2[15*3*NLIMBS_P];
+  uint64_t base[3*NLIMBS_P];
+  bls12_381_G1_jac_copy( grp, base );
+  if (signs & 1) { bls12_381_G1_jac_neg_inplace( base ); }
+  bls12_381_G1_jac_precalc_expos_window_16( base, table1 );
+  for(int j=0; j<15; j++) {
+    bls12_381_G1_jac_endo_phi( table1 + j*3*NLIMBS_P , table2 + j*3*NLIMBS_P );
+    if ((signs ^ (signs >> 1)) & 1) { bls12_381_G1_jac_neg_inplace( table2 + j*3*NLIMBS_P ); }
+  }
+
+  bls12_381_G1_jac_set_infinity( tgt );           // tgt := infinity
+
+  int s = NLIMBS_R - 1;
+  while( (s>0) && (k1[s] == 0) && (k2[s] == 0) ) { s--; }
+
+  for(int i=s; i>=0; i--) {
+    uint64_t e1 = k1[i];
+    uint64_t e2 = k2[i];
+    for(int j=0; j<16; j++) {
+      // we can skip doubling when infinity
+      if (!bls12_381_Fp_mont_is_zero(tgt+2*NLIMBS_P)) {
+        bls12_381_G1_jac_dbl_inplace( tgt );
+        bls12_381_G1_jac_dbl_inplace( tgt );
+        bls12_381_G1_jac_dbl_inplace( tgt );
+        bls12_381_G1_jac_dbl_inplace( tgt );
+      }
+      int d1 = (e1 >> 60);
+      int d2 = (e2 >> 60);
+      if (d1) { bls12_381_G1_jac_add_inplace( tgt, table1 + (d1-1)*3*NLIMBS_P ); }
+      if (d2) { bls12_381_G1_jac_add_inplace( tgt, table2 + (d2-1)*3*NLIMBS_P ); }
+      e1 = e1 << 4;
+      e2 = e2 << 4;
+    }
+  }
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G1, and `expo` is in Fr *in Montgomery repr*,
+// using the GLV decomposition. Note: this is only valid for points in the subgroup G1!
+void bls12_381_G1_jac_scl_glv_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bls12_381_Fr_mont_to_std(expo, expo_std);
+  bls12_381_G1_jac_scl_glv_Fr_std(expo_std, grp, tgt);
+}
+
 //------------------------------------------------------------------------------
 
-#define SIDX(b) (SUMS + (b-1)*(3*NLIMBS_P))
+// the bucket sums are in XYZZ coordinates
+#define SIDX(b) (SUMS + (b-1)*(4*NLIMBS_P))
 
 // Multi-Scalar Multiplication (MSM)
 // standard coefficients (NOT montgomery!)
 // straightforward Pippenger bucketing method
 // parametric bucket size
+// the buckets are accumulated in XYZZ coordinates (cheap mixed additions), and
+// only the window sums are converted back to jac coordinates
 void bls12_381_G1_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs, int window_size) {
 
   assert( (window_size > 0) && (window_size <= 64) );
@@ -562,7 +780,7 @@ void bls12_381_G1_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t
   bls12_381_G1_jac_set_infinity(tgt);
 
   // allocate memory for bucket sums
-  uint64_t *SUMS = malloc( 3*8*NLIMBS_P * (nbuckets-1) );
+  uint64_t *SUMS = malloc( 4*8*NLIMBS_P * (nbuckets-1) );
   assert( SUMS !=0 );
 
   // loop over the windows
@@ -591,7 +809,7 @@ void bls12_381_G1_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t
 
     // initalize bucket sums
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bls12_381_G1_jac_set_infinity( SIDX(b) );
+      bls12_381_G1_xyzz_set_infinity( SIDX(b) );
     }
 
     // compute bucket sums
@@ -605,22 +823,24 @@ void bls12_381_G1_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t
       e &= mask;   // bucket coeff
 
       if (e>0) {
-        bls12_381_G1_jac_madd_jac_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
+        bls12_381_G1_xyzz_madd_xyzz_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
       }
     }
 
     // compute running sums
 
-    uint64_t T[3*NLIMBS_P];   // cumulative sum of S-es
-    uint64_t R[3*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t T[4*NLIMBS_P];   // cumulative sum of S-es
+    uint64_t R[4*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t W[3*NLIMBS_P];   // the window sum, converted back
 
-    bls12_381_G1_jac_set_infinity(T);
-    bls12_381_G1_jac_set_infinity(R);
+    bls12_381_G1_xyzz_set_infinity(T);
+    bls12_381_G1_xyzz_set_infinity(R);
 
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bls12_381_G1_jac_add_inplace( T , SIDX(b) );
-      bls12_381_G1_jac_add_inplace( R , T       );
+      bls12_381_G1_xyzz_add_inplace( T , SIDX(b) );
+      bls12_381_G1_xyzz_add_inplace( R , T       );
     }
+    bls12_381_G1_xyzz_to_jac( R , W );
 
     if (!bls12_381_G1_jac_is_infinity(tgt)) {    // we can skip doubling when infinity
       for(int i=0; i<window_size; i++) {
@@ -628,7 +848,7 @@ void bls12_381_G1_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t
       }
     }
 
-    bls12_381_G1_jac_add_inplace( tgt, R );
+    bls12_381_G1_jac_add_inplace( tgt, W );
   }
 
   free(SUMS);
@@ -720,122 +940,204 @@ void bls12_381_G1_jac_MSM_mont_coeff_affine_out(int npoints, const uint64_t *exp
 //------------------------------------------------------------------------------
 
 
+// inverse of 2 (Montgomery repr)
+const uint64_t bls12_381_G1_jac_oneHalf[4] = { 0x00000000ffffffff, 0xac425bfd0001a401, 0xccc627f7f65e27fa, 0x0c1258acd66282b7 };
+
 #define GRP_NLIMBS (3*NLIMBS_P)
 
 // -----------------------------------------------------------------------------
-
-void bls12_381_G1_jac_fft_forward_noalloc( int m, int src_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
-
-  if (m==0) {
-    bls12_381_G1_jac_copy( src, tgt );
-    return;
+// FFT of group elements
+//
+// Iterative radix-2 decimation-in-time FFT, computed in place after a bit-reversal
+// permutation. The twiddle factors are precomputed once (in standard repr, as the
+// scalar multiplication needs that); the butterflies of each layer are independent,
+// so they are distributed among the worker threads.
+
+// below this many butterflies per layer, we don't bother with multithreading
+#define FFT_PARALLEL_THRESHOLD 64
+
+// computes the twiddle factors `[ gen^j | j <- [0..N/2-1] ]` (in standard repr), `m >= 1`
+void bls12_381_G1_jac_fft_twiddles( int m, const uint64_t *gen, uint64_t *twiddles ) {
+  int halfN = (1<<(m-1));
+  uint64_t acc[NLIMBS_R];
+  bls12_381_Fr_mont_set_one( acc );
+  for(int j=0; j<halfN; j++) {
+    bls12_381_Fr_mont_to_std( acc , twiddles + j*NLIMBS_R );
+    bls12_381_Fr_mont_mul_inplace( acc , gen );
   }
+}
 
-  if (m==1) {
-    // N = 2
-    bls12_381_G1_jac_add( src , src + src_stride*GRP_NLIMBS , tgt              );    // x + y
-    bls12_381_G1_jac_sub( src , src + src_stride*GRP_NLIMBS , tgt + GRP_NLIMBS );    // x - y
-    return;
+// reverses the lowest `m` bits of `i`
+int bls12_381_G1_jac_fft_bit_reverse( int m, int i ) {
+  int j = 0;
+  for(int k=0; k<m; k++) {
+    j = (j << 1) | (i & 1);
+    i = i >> 1;
   }
+  return j;
+}
 
+// copies `src` into `tgt` in bit-reversed order (`src == tgt` is allowed)
+void bls12_381_G1_jac_fft_bit_reverse_permute( int m, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  if (src == tgt) {
+    uint64_t tmp[GRP_NLIMBS];
+    for(int i=0; i<N; i++) {
+      int j = bls12_381_G1_jac_fft_bit_reverse( m, i );
+      if (i < j) {
+        bls12_381_G1_jac_copy( tgt + i*GRP_NLIMBS , tmp );
+        bls12_381_G1_jac_copy( tgt + j*GRP_NLIMBS , tgt + i*GRP_NLIMBS );
+        bls12_381_G1_jac_copy( tmp                , tgt + j*GRP_NLIMBS );
+      }
+    }
+  }
   else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
-
-    uint64_t gpow[NLIMBS_R];
-    bls12_381_Fr_mont_sqr( gen, gpow );  // gen^2
-    
-    bls12_381_G1_jac_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src                         , buf + N*GRP_NLIMBS , buf                    );
-    bls12_381_G1_jac_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src + src_stride*GRP_NLIMBS , buf + N*GRP_NLIMBS , buf + halfN*GRP_NLIMBS );
-
-    bls12_381_Fr_mont_set_one(gpow);
-    for(int j=0; j<halfN; j++) {
-      bls12_381_G1_jac_scl_Fr_mont(gpow , buf + (j+halfN)*GRP_NLIMBS  , tgt +  j *GRP_NLIMBS );  //   g*v[k]
-      bls12_381_G1_jac_neg ( tgt +  j       *GRP_NLIMBS ,        tgt + (j+halfN)*GRP_NLIMBS );   // - g*v[k]
-      bls12_381_G1_jac_add_inplace( tgt +  j       *GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] + g*v[k]
-      bls12_381_G1_jac_add_inplace( tgt + (j+halfN)*GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] - g*v[k]
-      bls12_381_Fr_mont_mul_inplace( gpow , gen );      
+    for(int i=0; i<N; i++) {
+      bls12_381_G1_jac_copy( src + i*GRP_NLIMBS , tgt + bls12_381_G1_jac_fft_bit_reverse( m, i )*GRP_NLIMBS );
     }
   }
 }
 
-// forward FFT of group elements (convert from [L_k(tau)] to [tau^i])
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
-// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)
-// NOTE: we normalize the results
-void bls12_381_G1_jac_fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
-  int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bls12_381_G1_jac_fft_forward_noalloc( m, 1, gen, src, buf, tgt);
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bls12_381_G1_jac_normalize_inplace( tgt + i*GRP_NLIMBS );
+typedef struct {
+  int m;                      // log2 of the size
+  int half;                   // half the block size of the current layer
+  int chunk;                  // number of butterflies per task
+  const uint64_t *twiddles;
+  uint64_t *buf;
+} bls12_381_G1_jac_fft_layer_ctx_t;
+
+// the butterflies `(u,v) -> (u + w*v, u - w*v)` with indices in `[ j*chunk , (j+1)*chunk )`
+// of a layer of the FFT. The blocks of this layer have size `2*half`, and the twiddle
+// factor for the `k`-th butterfly in a block is `w = gen^(k*N/(2*half))`
+void bls12_381_G1_jac_fft_layer_task( void *ctx, int j ) {
+  bls12_381_G1_jac_fft_layer_ctx_t *c = (bls12_381_G1_jac_fft_layer_ctx_t*) ctx;
+  int half   = c->half;
+  int halfN  = (1<<(c->m-1));
+  int stride = halfN / half;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > halfN) { b = halfN; }
+  uint64_t tmp[GRP_NLIMBS];
+  for(int t=a; t<b; t++) {
+    int k = t & (half-1);
+    uint64_t *u = c->buf + (2*(t-k) + k)*GRP_NLIMBS;
+    uint64_t *v = u + half*GRP_NLIMBS;
+    if (k == 0) {
+      bls12_381_G1_jac_copy( v , tmp );
+    }
+    else {
+      bls12_381_G1_jac_scl_glv_Fr_std( c->twiddles + (k*stride)*NLIMBS_R , v , tmp );       // w*v
+    }
+    bls12_381_G1_jac_sub( u , tmp , v );                                          // u - w*v
+    bls12_381_G1_jac_add_inplace( u , tmp );                                      // u + w*v
   }
 }
 
-
-// -----------------------------------------------------------------------------
-
-// inverse of 2 (standard repr)
-const uint64_t bls12_381_G1_jac_oneHalf[4] = { 0x00000000ffffffff, 0xac425bfd0001a401, 0xccc627f7f65e27fa, 0x0c1258acd66282b7 };
-
-void bls12_381_G1_jac_fft_inverse_noalloc(int m, int tgt_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
-
-  if (m==0) {
-    bls12_381_G1_jac_copy( src, tgt );
-    return;
+// in-place FFT of `N = 2^m` group elements, given in bit-reversed order
+void bls12_381_G1_jac_fft_inplace_noalloc( int m, const uint64_t *twiddles, uint64_t *buf ) {
+  if (m == 0) return;
+  int halfN = (1<<(m-1));
+  int T = parallel_get_num_threads();
+  bls12_381_G1_jac_fft_layer_ctx_t ctx;
+  ctx.m        = m;
+  ctx.twiddles = twiddles;
+  ctx.buf      = buf;
+  for(int half=1; half<=halfN; half<<=1) {
+    ctx.half = half;
+    if ( (halfN < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = halfN;
+      bls12_381_G1_jac_fft_layer_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (halfN + T - 1) / T;
+      parallel_for( (halfN + ctx.chunk - 1) / ctx.chunk , bls12_381_G1_jac_fft_layer_task, &ctx );
+    }
   }
+}
 
-  if (m==1) {
-    // N = 2
-    bls12_381_G1_jac_add( src , src + GRP_NLIMBS , tgt                         );   // x + y
-    bls12_381_G1_jac_sub( src , src + GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );   // x - y
-    bls12_381_G1_jac_scl_Fr_mont( bls12_381_G1_jac_oneHalf , tgt                         , tgt                         );      // (x + y)/2
-    bls12_381_G1_jac_scl_Fr_mont( bls12_381_G1_jac_oneHalf , tgt + tgt_stride*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );      // (x - y)/2
-    return;
+typedef struct {
+  int chunk;
+  int N;
+  const uint64_t *scalar;
+  uint64_t *buf;
+} bls12_381_G1_jac_fft_scale_ctx_t;
+
+void bls12_381_G1_jac_fft_scale_task( void *ctx, int j ) {
+  bls12_381_G1_jac_fft_scale_ctx_t *c = (bls12_381_G1_jac_fft_scale_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  for(int i=a; i<b; i++) {
+    bls12_381_G1_jac_scl_glv_Fr_std( c->scalar , c->buf + i*GRP_NLIMBS , c->buf + i*GRP_NLIMBS );
   }
+}
 
-  else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
-
-    uint64_t ginv[NLIMBS_R];
-    bls12_381_Fr_mont_inv( gen , ginv );  // gen^-1
-
-    uint64_t gpow[NLIMBS_R];    
-    bls12_381_Fr_mont_copy(bls12_381_G1_jac_oneHalf , gpow);  // 1/2
-    for(int j=0; j<halfN; j++) {
-      bls12_381_G1_jac_add( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + j        *GRP_NLIMBS  );    // x + y
-      bls12_381_G1_jac_sub( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS  );    // x - y
-      bls12_381_G1_jac_scl_Fr_mont( bls12_381_G1_jac_oneHalf , buf + j        *GRP_NLIMBS , buf + j        *GRP_NLIMBS );    // (x + y) /  2
-      bls12_381_G1_jac_scl_Fr_mont( gpow                    , buf + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS );    // (x - y) / (2*g^k)
-      bls12_381_Fr_mont_mul_inplace( gpow , ginv );      
-    }
-
-    bls12_381_Fr_mont_sqr( gen, gpow );  // gen^2
-    bls12_381_G1_jac_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf                    , buf + N*GRP_NLIMBS , tgt                         );
-    bls12_381_G1_jac_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf + halfN*GRP_NLIMBS , buf + N*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );
+// normalizes `N` points using a single inversion: first we convert them to affine
+// coordinates (which are then packed at the beginning of the buffer), then back
+void bls12_381_G1_jac_fft_normalize( int N, uint64_t *buf ) {
+  bls12_381_G1_jac_batch_to_affine( N, buf, buf );
+  for(int i=N-1; i>=0; i--) {
+    uint64_t tmp[2*NLIMBS_P];
+    memcpy( tmp, buf + i*2*NLIMBS_P, 8*2*NLIMBS_P );
+    bls12_381_G1_jac_from_affine( tmp, buf + i*GRP_NLIMBS );
+  }
+}
 
+// forward FFT of group elements (convert from [L_k(tau)] to [tau^i])
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
+// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)
+// NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
+void bls12_381_G1_jac_fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
+  int N = (1<<m);
+  bls12_381_G1_jac_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bls12_381_G1_jac_fft_twiddles( m, gen, twiddles );
+    bls12_381_G1_jac_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
   }
+  bls12_381_G1_jac_fft_normalize( N, tgt );
 }
- 
+
 // inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
 // `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
+// This is the forward FFT with `gen^-1`, followed by scaling with `1/N`
 // NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
 void bls12_381_G1_jac_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
   int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bls12_381_G1_jac_fft_inverse_noalloc( m, 1, gen, src, buf, tgt );
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bls12_381_G1_jac_normalize_inplace( tgt + i*GRP_NLIMBS );
+  bls12_381_G1_jac_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t ginv[NLIMBS_R];
+    bls12_381_Fr_mont_inv( gen , ginv );
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bls12_381_G1_jac_fft_twiddles( m, ginv, twiddles );
+    bls12_381_G1_jac_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
+
+    // 1/N = (1/2)^m
+    uint64_t ninv_mont[NLIMBS_R];
+    uint64_t ninv[NLIMBS_R];
+    bls12_381_Fr_mont_pow_uint64( bls12_381_G1_jac_oneHalf , m , ninv_mont );
+    bls12_381_Fr_mont_to_std( ninv_mont , ninv );
+
+    bls12_381_G1_jac_fft_scale_ctx_t ctx;
+    ctx.N      = N;
+    ctx.scalar = ninv;
+    ctx.buf    = tgt;
+    int T = parallel_get_num_threads();
+    if ( (N < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = N;
+      bls12_381_G1_jac_fft_scale_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (N + T - 1) / T;
+      parallel_for( (N + ctx.chunk - 1) / ctx.chunk , bls12_381_G1_jac_fft_scale_task, &ctx );
+    }
   }
+  bls12_381_G1_jac_fft_normalize( N, tgt );
 }
-
-// -----------------------------------------------------------------------------
-
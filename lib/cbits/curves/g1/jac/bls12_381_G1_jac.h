@@ -8,6 +8,7 @@ extern void bls12_381_G1_jac_from_affine ( const uint64_t *src , uint64_t *tgt )
 extern void bls12_381_G1_jac_to_affine   ( const uint64_t *src , uint64_t *tgt );
 extern void bls12_381_G1_jac_batch_from_affine( int N, const uint64_t *src , uint64_t *tgt );
 extern void bls12_381_G1_jac_batch_to_affine  ( int N, const uint64_t *src , uint64_t *tgt );
+extern void bls12_381_G1_jac_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt );
 
 extern uint8_t bls12_381_G1_jac_is_on_curve   ( const uint64_t *src );
 extern uint8_t bls12_381_G1_jac_is_infinity   ( const uint64_t *src );
@@ -47,3 +48,8 @@ extern void bls12_381_G1_jac_MSM_mont_coeff_affine_out(int npoints, const uint64
 extern void bls12_381_G1_jac_MSM_std_coeff_jacc_out_slow_reference(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs);
 extern void bls12_381_G1_jac_fft_forward( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt );
 extern void bls12_381_G1_jac_fft_inverse( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt );
+
+extern void bls12_381_G1_jac_endo_phi       ( const uint64_t *src , uint64_t *tgt );
+extern int  bls12_381_G1_jac_glv_decompose  ( const uint64_t *k , uint64_t *k1 , uint64_t *k2 );
+extern void bls12_381_G1_jac_scl_glv_Fr_std ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );
+extern void bls12_381_G1_jac_scl_glv_Fr_mont( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );
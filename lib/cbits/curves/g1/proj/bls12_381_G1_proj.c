@@ -11,8 +11,13 @@
 
 #include "bls12_381_G1_proj.h"
 #include "bls12_381_G1_affine.h"
+#include "bls12_381_G1_xyzz.h"
 #include "bls12_381_Fp_mont.h"
 #include "bls12_381_Fr_mont.h"
+#include "bls12_381_arr_mont.h"
+#include "bigint256.h"
+#include "parallel.h"
+#include "sha256.h"
 
 #define NLIMBS_P 6
 #define NLIMBS_R 4
@@ -35,6 +40,9 @@ const uint64_t bls12_381_G1_proj_gen_G1[18] = { 0x5cb38790fd530c16, 0x7817fc6799
 // the cofactor of the curve subgroup = 76329603384216526031706109802092473003
 const uint64_t bls12_381_G1_proj_cofactor[6] = { 0x8c00aaab0000aaab, 0x396c8c005555e156, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
+// the order of the subgroup = 52435875175126190479447740508185965837690552500527637822603658699938581184513
+const uint64_t bls12_381_G1_proj_subgroup_order[4] = { 0xffffffff00000001, 0x53bda402fffe5bfe, 0x3339d80809a1d805, 0x73eda753299d7d48 };
+
 // the constants A and B of the equation
 const uint64_t bls12_381_G1_proj_const_A[6] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bls12_381_G1_proj_const_B[6] = { 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e };
@@ -155,15 +163,86 @@ void bls12_381_G1_proj_batch_from_affine( int N, const uint64_t *src , uint64_t
   }
 }
 
-// converts N points to affine coordinates
+// converts N points to affine coordinates, using a single field inversion for
+// all of them (Montgomery's batch inversion trick). Points at infinity are skipped
+// in the running product, and result in the special affine infinity.
+// Note: the output may overlap with the input, as long as `tgt <= src`
 void bls12_381_G1_proj_batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {
-  const uint64_t *p = src;
-  uint64_t *q = tgt;
+  if (N <= 0) return;
+  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );
+  assert( zinvs != 0 );
+
+  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th
+  uint64_t acc[NLIMBS_P];
+  bls12_381_Fp_mont_set_one( acc );
   for(int i=0; i<N; i++) {
-    bls12_381_G1_proj_to_affine(p,q);
-    p += 3*NLIMBS_P;
-    q += 2*NLIMBS_P;
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    bls12_381_Fp_mont_copy( acc , zinvs + i*NLIMBS_P );
+    if (!bls12_381_Fp_mont_is_zero( z )) { bls12_381_Fp_mont_mul_inplace( acc , z ); }
+  }
+
+  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]
+  bls12_381_Fp_mont_inv_inplace( acc );
+  for(int i=N-1; i>=0; i--) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    if (!bls12_381_Fp_mont_is_zero( z )) {
+      bls12_381_Fp_mont_mul_inplace( zinvs + i*NLIMBS_P , acc );
+      bls12_381_Fp_mont_mul_inplace( acc , z );
+    }
+  }
+
+  for(int i=0; i<N; i++) {
+    const uint64_t *p = src + 3*i*NLIMBS_P;
+    uint64_t       *q = tgt + 2*i*NLIMBS_P;
+    if (bls12_381_Fp_mont_is_zero( p + 2*NLIMBS_P )) {
+      memset( q, 0xff, 96 );
+    }
+    else {
+      const uint64_t *zinv = zinvs + i*NLIMBS_P;
+      bls12_381_Fp_mont_mul( p            , zinv , q            );
+      bls12_381_Fp_mont_mul( p + NLIMBS_P , zinv , q + NLIMBS_P );
+    }
+  }
+
+  free(zinvs);
+}
+
+// below this many points, the parallel version simply calls the sequential one
+#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024
+
+typedef struct {
+  int N;
+  int chunk;
+  const uint64_t *src;
+  uint64_t *tgt;
+} bls12_381_G1_proj_batch_to_affine_ctx_t;
+
+void bls12_381_G1_proj_batch_to_affine_task( void *ctx, int j ) {
+  bls12_381_G1_proj_batch_to_affine_ctx_t *c = (bls12_381_G1_proj_batch_to_affine_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  bls12_381_G1_proj_batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );
+}
+
+// converts N points to affine coordinates, splitting them into chunks which are
+// converted in parallel (each chunk with a single inversion). For small inputs,
+// or with a single thread, this is the same as `batch_to_affine`.
+// Note: unlike `batch_to_affine`, the output must not overlap with the input
+void bls12_381_G1_proj_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {
+  int T = parallel_get_num_threads();
+  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {
+    bls12_381_G1_proj_batch_to_affine( N, src, tgt );
+    return;
   }
+  int chunk = (N + T - 1) / T;
+  int m     = (N + chunk - 1) / chunk;
+  bls12_381_G1_proj_batch_to_affine_ctx_t ctx;
+  ctx.N     = N;
+  ctx.chunk = chunk;
+  ctx.src   = src;
+  ctx.tgt   = tgt;
+  parallel_for( m, bls12_381_G1_proj_batch_to_affine_task, &ctx );
 }
 
 void bls12_381_G1_proj_copy( const uint64_t *src1 , uint64_t *tgt ) {
@@ -210,7 +289,7 @@ uint8_t bls12_381_G1_proj_is_in_subgroup ( const uint64_t *src1 ) {
     return 0;
   }
   else {
-    bls12_381_G1_proj_scl_Fr_std( bls12_381_G1_proj_cofactor , src1 , tmp );
+    bls12_381_G1_proj_scl_generic( bls12_381_G1_proj_subgroup_order , src1 , tmp , NLIMBS_R );
     return bls12_381_G1_proj_is_infinity( tmp );
   }
 }
@@ -226,41 +305,31 @@ void bls12_381_G1_proj_neg_inplace( uint64_t *tgt ) {
   bls12_381_Fp_mont_neg_inplace( Y3 );
 }
 
-// doubles an elliptic curve point
-// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#doubling-dbl-2007-bl
+// doubles an elliptic curve point, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 9 <https://eprint.iacr.org/2015/1060>
 void bls12_381_G1_proj_dbl( const uint64_t *src1, uint64_t *tgt ) {
-  uint64_t  XX[6];
-  uint64_t  ZZ[6];
-  uint64_t   w[6];
-  uint64_t   s[6];
-  uint64_t  ss[6];
-  uint64_t sss[6];
-  uint64_t   R[6];
-  uint64_t  RR[6];
-  uint64_t   B[6];
-  uint64_t   h[6];
-  bls12_381_Fp_mont_sqr( X1 , XX );         // XX = X1^2
-  bls12_381_Fp_mont_sqr( Z1 , ZZ );         // ZZ = Z1^2
-  bls12_381_Fp_mont_add( XX, XX, w );       // w  = 2*XX
-  bls12_381_Fp_mont_add_inplace( w, XX );   // w  = 3*XX
-  bls12_381_Fp_mont_mul( Y1 , Z1 , s );         // s   = Y1*Z1
-  bls12_381_Fp_mont_add_inplace( s, s );        // s   = 2*Y1*Z1
-  bls12_381_Fp_mont_sqr( s , ss );              // ss  = s^2
-  bls12_381_Fp_mont_mul( Y1 , s , R);           // R   = Y1*s
-  bls12_381_Fp_mont_sqr( R , RR );              // RR  = R^2
-  bls12_381_Fp_mont_add( X1 , R , B);           // B   = (X1+R)
-  bls12_381_Fp_mont_sqr_inplace( B );           // B   = (X1+R)^2
-  bls12_381_Fp_mont_sub_inplace( B , XX );      // B   = (X1+R)^2 - XX
-  bls12_381_Fp_mont_sub_inplace( B , RR );      // B   = (X1+R)^2 - XX - RR
-  bls12_381_Fp_mont_sqr( w , h );               // h   = w^2
-  bls12_381_Fp_mont_sub_inplace( h , B );       // h   = w^2 - B
-  bls12_381_Fp_mont_sub_inplace( h , B );       // h   = w^2 - 2*B
-  bls12_381_Fp_mont_mul( s , ss , Z3 );         // Z3  = s^3
-  bls12_381_Fp_mont_mul( h , s , X3 );          // X3  = h*s
-  bls12_381_Fp_mont_sub( B , h , Y3 );          // Y3  = B-h
-  bls12_381_Fp_mont_mul_inplace( Y3 , w  );     // Y3  = w*(B-h)
-  bls12_381_Fp_mont_sub_inplace( Y3 , RR );     // Y3  = w*(B-h) - RR
-  bls12_381_Fp_mont_sub_inplace( Y3 , RR );     // Y3  = w*(B-h) - 2*RR
+  uint64_t t0[6];
+  uint64_t t1[6];
+  uint64_t t2[6];
+  uint64_t t3[6];
+  bls12_381_Fp_mont_sqr( Y1, t0 );                  // t0 = Y1^2
+  bls12_381_Fp_mont_mul( Y1, Z1, t1 );              // t1 = Y1*Z1
+  bls12_381_Fp_mont_sqr( Z1, t2 );                  // t2 = Z1^2
+  bls12_381_Fp_mont_mul( X1, Y1, t3 );              // t3 = X1*Y1
+  bls12_381_G1_proj_scale_by_3B_inplace( t2 );      // t2 = b3*Z1^2
+  bls12_381_Fp_mont_add( t0, t0, Z3 );              // Z3 = 2*t0
+  bls12_381_Fp_mont_add_inplace( Z3, Z3 );          // Z3 = 4*t0
+  bls12_381_Fp_mont_add_inplace( Z3, Z3 );          // Z3 = 8*t0
+  bls12_381_Fp_mont_mul( t2, Z3, X3 );              // X3 = t2*Z3
+  bls12_381_Fp_mont_add( t0, t2, Y3 );              // Y3 = t0+t2
+  bls12_381_Fp_mont_mul_inplace( Z3, t1 );          // Z3 = t1*Z3
+  bls12_381_Fp_mont_add( t2, t2, t1 );              // t1 = 2*t2
+  bls12_381_Fp_mont_add_inplace( t2, t1 );          // t2 = 3*t2
+  bls12_381_Fp_mont_sub_inplace( t0, t2 );          // t0 = t0-t2
+  bls12_381_Fp_mont_mul_inplace( Y3, t0 );          // Y3 = t0*Y3
+  bls12_381_Fp_mont_add_inplace( Y3, X3 );          // Y3 = X3+Y3
+  bls12_381_Fp_mont_mul( t0, t3, X3 );              // X3 = t0*t3
+  bls12_381_Fp_mont_add_inplace( X3, X3 );          // X3 = 2*X3
 }
 
 // doubles an elliptic curve point
@@ -268,8 +337,9 @@ void bls12_381_G1_proj_dbl_inplace( uint64_t *tgt ) {
   bls12_381_G1_proj_dbl( tgt , tgt );
 }
 
-// adds two elliptic curve points, assuming A = 0
-// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#addition-add-2015-rcb
+// adds two elliptic curve points, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 7 <https://eprint.iacr.org/2015/1060>
+// cost: 12M + 2*m_3b
 void bls12_381_G1_proj_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
   uint64_t t0[6];
   uint64_t t1[6];
@@ -295,10 +365,9 @@ void bls12_381_G1_proj_add( const uint64_t *src1, const uint64_t *src2, uint64_t
   bls12_381_Fp_mont_mul_inplace( t5, X3 );          // t5 = t5*X3
   bls12_381_Fp_mont_add( t1, t2, X3 );              // X3 = t1+t2
   bls12_381_Fp_mont_sub_inplace( t5, X3 );          // t5 = t5-X3
-  bls12_381_G1_proj_scale_by_3B( t2, X3 );          // X3 = b3*t2
-  bls12_381_Fp_mont_copy( X3, Z3 );                 // Z3 = X3
-  bls12_381_Fp_mont_sub( t1, Z3, X3 );              // X3 = t1-Z3
-  bls12_381_Fp_mont_add_inplace( Z3, t1 );          // Z3 = t1+Z3
+  bls12_381_G1_proj_scale_by_3B_inplace( t2 );      // t2 = b3*t2
+  bls12_381_Fp_mont_sub( t1, t2, X3 );              // X3 = t1-t2
+  bls12_381_Fp_mont_add( t1, t2, Z3 );              // Z3 = t1+t2
   bls12_381_Fp_mont_mul( X3, Z3, Y3 );              // Y3 = X3*Z3
   bls12_381_Fp_mont_add( t0, t0, t1 );              // t1 = t0+t0
   bls12_381_Fp_mont_add_inplace( t1, t0 );          // t1 = t1+t0
@@ -462,6 +531,160 @@ void bls12_381_G1_proj_scl_windowed(const uint64_t *expo, const uint64_t *grp, u
   }
 }
 
+// scale a field element by A = 0
+void bls12_381_G1_proj_scale_by_A_ct(const uint64_t *src, uint64_t *tgt ) {
+  memset( tgt, 0, 48 );
+}
+
+void bls12_381_G1_proj_scale_by_A_inplace_ct( uint64_t *tgt ) {
+  memset( tgt, 0, 48 );
+}
+// scale a field element by (3*B) = 12
+void bls12_381_G1_proj_scale_by_3B_ct(const uint64_t *src, uint64_t *tgt ) {
+  uint64_t tmp [NLIMBS_P];
+  uint64_t tmp2[NLIMBS_P];
+  bls12_381_Fp_mont_add_ct( src, src, tmp );       // 2*B
+  bls12_381_Fp_mont_add_inplace_ct( tmp, tmp );    // 4*B
+  bls12_381_Fp_mont_add_ct( tmp, tmp, tmp2);       // 8*B
+  bls12_381_Fp_mont_add_ct( tmp, tmp2, tgt );      // 12*B
+}
+
+void bls12_381_G1_proj_scale_by_3B_inplace_ct( uint64_t *tgt ) {
+  bls12_381_G1_proj_scale_by_3B_ct( tgt , tgt );
+}
+
+// doubles an elliptic curve point, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 9 <https://eprint.iacr.org/2015/1060>
+void bls12_381_G1_proj_dbl_ct( const uint64_t *src1, uint64_t *tgt ) {
+  uint64_t t0[6];
+  uint64_t t1[6];
+  uint64_t t2[6];
+  uint64_t t3[6];
+  bls12_381_Fp_mont_sqr_ct( Y1, t0 );                  // t0 = Y1^2
+  bls12_381_Fp_mont_mul_ct( Y1, Z1, t1 );              // t1 = Y1*Z1
+  bls12_381_Fp_mont_sqr_ct( Z1, t2 );                  // t2 = Z1^2
+  bls12_381_Fp_mont_mul_ct( X1, Y1, t3 );              // t3 = X1*Y1
+  bls12_381_G1_proj_scale_by_3B_inplace_ct( t2 );      // t2 = b3*Z1^2
+  bls12_381_Fp_mont_add_ct( t0, t0, Z3 );              // Z3 = 2*t0
+  bls12_381_Fp_mont_add_inplace_ct( Z3, Z3 );          // Z3 = 4*t0
+  bls12_381_Fp_mont_add_inplace_ct( Z3, Z3 );          // Z3 = 8*t0
+  bls12_381_Fp_mont_mul_ct( t2, Z3, X3 );              // X3 = t2*Z3
+  bls12_381_Fp_mont_add_ct( t0, t2, Y3 );              // Y3 = t0+t2
+  bls12_381_Fp_mont_mul_inplace_ct( Z3, t1 );          // Z3 = t1*Z3
+  bls12_381_Fp_mont_add_ct( t2, t2, t1 );              // t1 = 2*t2
+  bls12_381_Fp_mont_add_inplace_ct( t2, t1 );          // t2 = 3*t2
+  bls12_381_Fp_mont_sub_inplace_ct( t0, t2 );          // t0 = t0-t2
+  bls12_381_Fp_mont_mul_inplace_ct( Y3, t0 );          // Y3 = t0*Y3
+  bls12_381_Fp_mont_add_inplace_ct( Y3, X3 );          // Y3 = X3+Y3
+  bls12_381_Fp_mont_mul_ct( t0, t3, X3 );              // X3 = t0*t3
+  bls12_381_Fp_mont_add_inplace_ct( X3, X3 );          // X3 = 2*X3
+}
+
+// adds two elliptic curve points, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 7 <https://eprint.iacr.org/2015/1060>
+// cost: 12M + 2*m_3b
+void bls12_381_G1_proj_add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint64_t t0[6];
+  uint64_t t1[6];
+  uint64_t t2[6];
+  uint64_t t3[6];
+  uint64_t t4[6];
+  uint64_t t5[6];
+  bls12_381_Fp_mont_mul_ct( X1, X2, t0 );              // t0 = X1*X2
+  bls12_381_Fp_mont_mul_ct( Y1, Y2, t1 );              // t1 = Y1*Y2
+  bls12_381_Fp_mont_mul_ct( Z1, Z2, t2 );              // t2 = Z1*Z2
+  bls12_381_Fp_mont_add_ct( X1, Y1, t3 );              // t3 = X1+Y1
+  bls12_381_Fp_mont_add_ct( X2, Y2, t4 );              // t4 = X2+Y2
+  bls12_381_Fp_mont_mul_inplace_ct( t3, t4 );          // t3 = t3*t4
+  bls12_381_Fp_mont_add_ct( t0, t1, t4 );              // t4 = t0+t1
+  bls12_381_Fp_mont_sub_inplace_ct( t3 , t4 );         // t3 = t3-t4
+  bls12_381_Fp_mont_add_ct( X1, Z1, t4 );              // t4 = X1+Z1
+  bls12_381_Fp_mont_add_ct( X2, Z2, t5 );              // t5 = X2+Z2
+  bls12_381_Fp_mont_mul_inplace_ct( t4, t5 );          // t4 = t4*t5
+  bls12_381_Fp_mont_add_ct( t0, t2, t5 );              // t5 = t0+t2
+  bls12_381_Fp_mont_sub_inplace_ct( t4, t5 );          // t4 = t4-t5
+  bls12_381_Fp_mont_add_ct( Y1, Z1, t5 );              // t5 = Y1+Z1
+  bls12_381_Fp_mont_add_ct( Y2, Z2, X3 );              // X3 = Y2+Z2
+  bls12_381_Fp_mont_mul_inplace_ct( t5, X3 );          // t5 = t5*X3
+  bls12_381_Fp_mont_add_ct( t1, t2, X3 );              // X3 = t1+t2
+  bls12_381_Fp_mont_sub_inplace_ct( t5, X3 );          // t5 = t5-X3
+  bls12_381_G1_proj_scale_by_3B_inplace_ct( t2 );      // t2 = b3*t2
+  bls12_381_Fp_mont_sub_ct( t1, t2, X3 );              // X3 = t1-t2
+  bls12_381_Fp_mont_add_ct( t1, t2, Z3 );              // Z3 = t1+t2
+  bls12_381_Fp_mont_mul_ct( X3, Z3, Y3 );              // Y3 = X3*Z3
+  bls12_381_Fp_mont_add_ct( t0, t0, t1 );              // t1 = t0+t0
+  bls12_381_Fp_mont_add_inplace_ct( t1, t0 );          // t1 = t1+t0
+  bls12_381_G1_proj_scale_by_3B_inplace_ct( t4 );      // t4 = b3*t4
+  bls12_381_Fp_mont_mul_ct( t1, t4, t0 );              // t0 = t1*t4
+  bls12_381_Fp_mont_add_inplace_ct( Y3, t0 );          // Y3 = Y3+t0
+  bls12_381_Fp_mont_mul_ct( t4, t5, t0 );              // t0 = t5*t4
+  bls12_381_Fp_mont_mul_inplace_ct( X3, t3 );          // X3 = t3*X3
+  bls12_381_Fp_mont_sub_inplace_ct( X3, t0 );          // X3 = X3-t0
+  bls12_381_Fp_mont_mul_ct( t1, t3, t0 );              // t0 = t3*t1
+  bls12_381_Fp_mont_mul_inplace_ct( Z3, t5 );          // Z3 = t5*Z3
+  bls12_381_Fp_mont_add_inplace_ct( Z3, t0 );          // Z3 = Z3+t0
+}
+
+// constant-time table lookup: computes `d*g` from the table [ k*g | k <- [1..8] ],
+// where -8 <= d <= 8. All the entries are read, and there are no branches depending on `d`
+void bls12_381_G1_proj_ct_lookup_window_8( const uint64_t *table, int d, uint64_t *tgt ) {
+  uint64_t sgn  = (uint64_t)( ((int64_t)d) >> 63 );                 // all ones if d < 0
+  uint64_t absd = ((uint64_t)d ^ sgn) - sgn;
+  bls12_381_G1_proj_set_infinity( tgt );
+  for(int k=1; k<=8; k++) {
+    uint64_t mask = - (((absd ^ k) - 1) >> 63);                    // all ones if absd == k
+    const uint64_t *entry = TBL(k);
+    for(int i=0; i<3*NLIMBS_P; i++) { tgt[i] = (tgt[i] & ~mask) | (entry[i] & mask); }
+  }
+  uint64_t negy[NLIMBS_P];
+  bls12_381_Fp_mont_neg_ct( tgt+NLIMBS_P , negy );
+  for(int i=0; i<NLIMBS_P; i++) { tgt[NLIMBS_P+i] = (tgt[NLIMBS_P+i] & ~sgn) | (negy[i] & sgn); }
+}
+
+#define CT_BIT(j) ( ((j) < 0 || (j) >= 64*expo_len) ? 0 : (int)((expo[(j)>>6] >> ((j)&63)) & 1) )
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G1, and `expo` is a (non-negative) bigint
+// constant-time algorithm (signed fixed 4-bit windows), use this for secret scalars.
+// The running time only depends on `expo_len`
+void bls12_381_G1_proj_scl_ct_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {
+
+  // precalculate [ k*g | k <- [1..8] ]
+  uint64_t table[8*3*NLIMBS_P];
+  bls12_381_G1_proj_copy( grp , TBL(1) );
+  bls12_381_G1_proj_dbl_ct( TBL(1) , TBL(2) );
+  bls12_381_G1_proj_add_ct( TBL(1) , TBL(2) , TBL(3) );
+  bls12_381_G1_proj_dbl_ct( TBL(2) , TBL(4) );
+  bls12_381_G1_proj_add_ct( TBL(1) , TBL(4) , TBL(5) );
+  bls12_381_G1_proj_dbl_ct( TBL(3) , TBL(6) );
+  bls12_381_G1_proj_add_ct( TBL(1) , TBL(6) , TBL(7) );
+  bls12_381_G1_proj_dbl_ct( TBL(4) , TBL(8) );
+
+  uint64_t tmp[3*NLIMBS_P];
+  bls12_381_G1_proj_set_infinity( tgt );
+  for(int i=16*expo_len; i>=0; i--) {
+    for(int s=0; s<4; s++) { bls12_381_G1_proj_dbl_ct( tgt , tgt ); }
+    int j = 4*i;
+    int d = CT_BIT(j-1) + CT_BIT(j) + 2*CT_BIT(j+1) + 4*CT_BIT(j+2) - 8*CT_BIT(j+3);
+    bls12_381_G1_proj_ct_lookup_window_8( table, d, tmp );
+    bls12_381_G1_proj_add_ct( tgt, tmp, tgt );
+  }
+}
+
+#undef CT_BIT
+
+// computes `expo*grp` in constant time, where `expo` is in Fr *in standard repr*
+void bls12_381_G1_proj_scl_ct_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  bls12_381_G1_proj_scl_ct_generic(expo, grp, tgt, NLIMBS_R);
+}
+
+// computes `expo*grp` in constant time, where `expo` is in Fr *in Montgomery repr*
+void bls12_381_G1_proj_scl_ct_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bls12_381_Fr_mont_to_std_ct(expo, expo_std);
+  bls12_381_G1_proj_scl_ct_generic(expo_std, grp, tgt, NLIMBS_R);
+}
+
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
 // where `grp` is a group element in G, and `expo` is in Fr
 void bls12_381_G1_proj_scl_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int nlimbs) {
@@ -497,13 +720,262 @@ void bls12_381_G1_proj_scl_small(uint64_t expo, const uint64_t *grp, uint64_t *t
 }
 
 //------------------------------------------------------------------------------
+// GLV scalar multiplication
+//
+// The endomorphism `phi(x,y) = (beta*x,y)` (where `beta` is a cube root of unity)
+// acts on the subgroup G1 as multiplication by `lambda`. Writing the scalar as
+// `k = k1 + k2*lambda` with `|k1|,|k2| ~ sqrt(r)`, we can compute
+//
+//   k*P = k1*P + k2*phi(P)
+//
+// with half as many doublings as a standard scalar multiplication.
+
+// beta (Montgomery repr)
+const uint64_t bls12_381_G1_proj_glv_beta[6] = { 0xcd03c9e48671f071, 0x5dab22461fcda5d2, 0x587042afd3851b95, 0x8eb60ebe01bacb9e, 0x03f97d6e83d050d2, 0x18f0206554638741 };
+
+// a short basis `(a1,b1), (a2,b2)` of the lattice `{ (a,b) | a + b*lambda = 0 mod r }`
+// with determinant `r`, as two's complement numbers
+const uint64_t bls12_381_G1_proj_glv_a1[4] = { 0x00000000ffffffff, 0xac45a4010001a402, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G1_proj_glv_b1[4] = { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff };
+const uint64_t bls12_381_G1_proj_glv_a2[4] = { 0x0000000000000001, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G1_proj_glv_b2[4] = { 0x0000000100000000, 0xac45a4010001a402, 0x0000000000000000, 0x0000000000000000 };
+
+// `g1 = round(2^256 * b2 / r)` and `g2 = round(-2^256 * b1 / r)`
+const uint64_t bls12_381_G1_proj_glv_g1[4] = { 0x63f6e522f6cfee30, 0x7c6becf1e01faadd, 0x0000000000000001, 0x0000000000000000 };
+const uint64_t bls12_381_G1_proj_glv_g2[4] = { 0x0000000000000002, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+
+// the endomorphism `phi(x,y) = (beta*x,y)`
+void bls12_381_G1_proj_endo_phi( const uint64_t *src1, uint64_t *tgt ) {
+  bls12_381_Fp_mont_mul( X1 , bls12_381_G1_proj_glv_beta , X3 );
+  if (tgt != src1) { memcpy( Y3, Y1, 96 ); }
+}
+
+// computes `c = round( k*g / 2^256 )`
+void bls12_381_G1_proj_glv_round_mul( const uint64_t *k, const uint64_t *g, uint64_t *c ) {
+  uint64_t prod[2*NLIMBS_R];
+  bigint256_mul( k , g , prod );
+  memcpy( c , prod + NLIMBS_R , 8*NLIMBS_R );
+  if (prod[NLIMBS_R-1] >> 63) { bigint256_inc_inplace( c ); }
+}
+
+// Decomposes a scalar `0 <= k < r` (in standard repr) as `k = k1 + k2*lambda (mod r)`,
+// using Babai rounding with the short basis above. The absolute values (which are at
+// most 128 bits) are written into `k1` and `k2`, the signs are returned in the
+// bits 0 and 1 of the result.
+int bls12_381_G1_proj_glv_decompose( const uint64_t *k, uint64_t *k1, uint64_t *k2 ) {
+  uint64_t c1[NLIMBS_R];
+  uint64_t c2[NLIMBS_R];
+  uint64_t t [NLIMBS_R];
+  bls12_381_G1_proj_glv_round_mul( k , bls12_381_G1_proj_glv_g1 , c1 );
+  bls12_381_G1_proj_glv_round_mul( k , bls12_381_G1_proj_glv_g2 , c2 );
+
+  // k1 = k - c1*a1 - c2*a2
+  bigint256_copy( k , k1 );
+  bigint256_mul_truncated( c1 , bls12_381_G1_proj_glv_a1 , t );  bigint256_sub_inplace( k1 , t );
+  bigint256_mul_truncated( c2 , bls12_381_G1_proj_glv_a2 , t );  bigint256_sub_inplace( k1 , t );
+
+  // k2 = - c1*b1 - c2*b2
+  bigint256_mul_truncated( c1 , bls12_381_G1_proj_glv_b1 , k2 );
+  bigint256_mul_truncated( c2 , bls12_381_G1_proj_glv_b2 , t  );  bigint256_add_inplace( k2 , t );
+  bigint256_neg_inplace( k2 );
+
+  int signs = 0;
+  if (k1[NLIMBS_R-1] >> 63) { bigint256_neg_inplace( k1 ); signs |= 1; }
+  if (k2[NLIMBS_R-1] >> 63) { bigint256_neg_inplace( k2 ); signs |= 2; }
+  return signs;
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G1, and `expo` is in Fr *in standard repr*,
+// using the GLV decomposition and interleaved 4-bit windows.
+// Note: this is only valid for points in the subgroup G1!
+void bls12_381_G1_proj_scl_glv_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t k1[NLIMBS_R];
+  uint64_t k2[NLIMBS_R];
+  int signs = bls12_381_G1_proj_glv_decompose( expo , k1 , k2 );
+
+  // precalculate [ k*(+-g) | k <- [1..15] ] and [ k*(+-phi(g)) | k <- [1..15] ];
+  // since `phi` is a group homomorphism, the second table is the image of the first
+  uint64_t table1[15*3*NLIMBS_P];
+  uint64_t table2[15*3*NLIMBS_P];
+  uint64_t base[3*NLIMBS_P];
+  bls12_381_G1_proj_copy( grp, base );
+  if (signs & 1) { bls12_381_G1_proj_neg_inplace( base ); }
+  bls12_381_G1_proj_precalc_expos_window_16( base, table1 );
+  for(int j=0; j<15; j++) {
+    bls12_381_G1_proj_endo_phi( table1 + j*3*NLIMBS_P , table2 + j*3*NLIMBS_P );
+    if ((signs ^ (signs >> 1)) & 1) { bls12_381_G1_proj_neg_inplace( table2 + j*3*NLIMBS_P ); }
+  }
+
+  bls12_381_G1_proj_set_infinity( tgt );           // tgt := infinity
 
-#define SIDX(b) (SUMS + (b-1)*(3*NLIMBS_P))
+  int s = NLIMBS_R - 1;
+  while( (s>0) && (k1[s] == 0) && (k2[s] == 0) ) { s--; }
+
+  for(int i=s; i>=0; i--) {
+    uint64_t e1 = k1[i];
+    uint64_t e2 = k2[i];
+    for(int j=0; j<16; j++) {
+      // we can skip doubling when infinity
+      if (!bls12_381_Fp_mont_is_zero(tgt+2*NLIMBS_P)) {
+        bls12_381_G1_proj_dbl_inplace( tgt );
+        bls12_381_G1_proj_dbl_inplace( tgt );
+        bls12_381_G1_proj_dbl_inplace( tgt );
+        bls12_381_G1_proj_dbl_inplace( tgt );
+      }
+      int d1 = (e1 >> 60);
+      int d2 = (e2 >> 60);
+      if (d1) { bls12_381_G1_proj_add_inplace( tgt, table1 + (d1-1)*3*NLIMBS_P ); }
+      if (d2) { bls12_381_G1_proj_add_inplace( tgt, table2 + (d2-1)*3*NLIMBS_P ); }
+      e1 = e1 << 4;
+      e2 = e2 << 4;
+    }
+  }
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G1, and `expo` is in Fr *in Montgomery repr*,
+// using the GLV decomposition. Note: this is only valid for points in the subgroup G1!
+void bls12_381_G1_proj_scl_glv_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bls12_381_Fr_mont_to_std(expo, expo_std);
+  bls12_381_G1_proj_scl_glv_Fr_std(expo_std, grp, tgt);
+}
+
+//------------------------------------------------------------------------------
+// fixed-base scalar multiplication (Lim-Lee comb method)
+//
+// The scalar is written as a COMB_TEETH x COMB_ROWS bit matrix, that is
+//
+//   k = sum_{i,j} k[i*COMB_ROWS+j] * 2^(i*COMB_ROWS+j)
+//
+// and the column `j` is a COMB_TEETH bit number `u`. The first table contains
+// the points `sum_i u_i * 2^(i*COMB_ROWS) * P` for all nonzero `u`; the table `t`
+// is the first one multiplied by `2^(t*COMB_SPACING)`. Then a scalar multiplication
+// is only COMB_SPACING-1 doublings and COMB_ROWS mixed additions.
+
+#define COMB_TEETH   8
+#define COMB_ROWS    32
+#define COMB_TABLES  4
+#define COMB_SPACING 8
+#define COMB_ENTRIES ((1<<COMB_TEETH) - 1)
+
+#define COMB_TABLE_NWORDS (COMB_TABLES*COMB_ENTRIES*2*NLIMBS_P)
+#define COMB_ENTRY(table,t,u) ((table) + ((t)*COMB_ENTRIES + (u)-1)*(2*NLIMBS_P))
+#define COMB_TMP(t,u)         (tmp   + ((t)*COMB_ENTRIES + (u)-1)*(3*NLIMBS_P))
+
+// the size of a precomputed table, in 64-bit words
+int bls12_381_G1_proj_comb_table_nwords() {
+  return COMB_TABLE_NWORDS;
+}
+
+// precomputes the table (of COMB_TABLE_NWORDS words) for the base point `src`
+void bls12_381_G1_proj_comb_precompute(const uint64_t *src, uint64_t *table) {
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * COMB_TABLES*COMB_ENTRIES );
+  assert( tmp != 0 );
+
+  // the teeth: 2^(i*COMB_ROWS) * P
+  uint64_t teeth[COMB_TEETH*3*NLIMBS_P];
+  bls12_381_G1_proj_copy( src, teeth );
+  for(int i=1; i<COMB_TEETH; i++) {
+    bls12_381_G1_proj_copy( teeth + (i-1)*3*NLIMBS_P , teeth + i*3*NLIMBS_P );
+    for(int s=0; s<COMB_ROWS; s++) { bls12_381_G1_proj_dbl_inplace( teeth + i*3*NLIMBS_P ); }
+  }
+
+  // first table: COMB_TMP(0,u) = COMB_TMP(0,u-lowbit(u)) + teeth[ctz(u)]
+  for(int u=1; u<=COMB_ENTRIES; u++) {
+    int i = 0;
+    while (!((u >> i) & 1)) { i++; }
+    int v = u & (u-1);
+    if (v == 0) {
+      bls12_381_G1_proj_copy( teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );
+    }
+    else {
+      bls12_381_G1_proj_add( COMB_TMP(0,v) , teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );
+    }
+  }
+
+  // the other tables: COMB_TMP(t,u) = 2^COMB_SPACING * COMB_TMP(t-1,u)
+  for(int t=1; t<COMB_TABLES; t++) {
+    for(int u=1; u<=COMB_ENTRIES; u++) {
+      bls12_381_G1_proj_copy( COMB_TMP(t-1,u) , COMB_TMP(t,u) );
+      for(int s=0; s<COMB_SPACING; s++) { bls12_381_G1_proj_dbl_inplace( COMB_TMP(t,u) ); }
+    }
+  }
+
+  bls12_381_G1_proj_batch_to_affine( COMB_TABLES*COMB_ENTRIES , tmp , table );
+  free(tmp);
+}
+
+// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,
+// and `expo` is in Fr *in standard repr*
+void bls12_381_G1_proj_comb_scl_Fr_std(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t acc[3*NLIMBS_P];
+  bls12_381_G1_proj_set_infinity( acc );
+  for(int j=COMB_SPACING-1; j>=0; j--) {
+    if (j < COMB_SPACING-1) { bls12_381_G1_proj_dbl_inplace( acc ); }
+    for(int t=0; t<COMB_TABLES; t++) {
+      int col = t*COMB_SPACING + j;
+      int u   = 0;
+      for(int i=0; i<COMB_TEETH; i++) {
+        int b = i*COMB_ROWS + col;
+        u |= ((expo[b>>6] >> (b&63)) & 1) << i;
+      }
+      if (u) { bls12_381_G1_proj_madd_inplace( acc , COMB_ENTRY(table,t,u) ); }
+    }
+  }
+  bls12_381_G1_proj_copy( acc , tgt );
+}
+
+// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,
+// and `expo` is in Fr *in Montgomery repr*
+void bls12_381_G1_proj_comb_scl_Fr_mont(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bls12_381_Fr_mont_to_std(expo, expo_std);
+  bls12_381_G1_proj_comb_scl_Fr_std(table, expo_std, tgt);
+}
+
+// the table for the subgroup generator is computed on first use
+uint64_t bls12_381_G1_proj_gen_comb_table[COMB_TABLE_NWORDS];
+int      bls12_381_G1_proj_gen_comb_table_ready = 0;
+
+void bls12_381_G1_proj_gen_comb_table_init() {
+  bls12_381_G1_proj_comb_precompute( bls12_381_G1_proj_gen_G1 , bls12_381_G1_proj_gen_comb_table );
+}
+
+// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in standard repr*
+void bls12_381_G1_proj_scl_gen_Fr_std(const uint64_t *expo, uint64_t *tgt) {
+  parallel_call_once( &bls12_381_G1_proj_gen_comb_table_ready , bls12_381_G1_proj_gen_comb_table_init );
+  bls12_381_G1_proj_comb_scl_Fr_std( bls12_381_G1_proj_gen_comb_table , expo , tgt );
+}
+
+// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in Montgomery repr*
+void bls12_381_G1_proj_scl_gen_Fr_mont(const uint64_t *expo, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bls12_381_Fr_mont_to_std(expo, expo_std);
+  bls12_381_G1_proj_scl_gen_Fr_std(expo_std, tgt);
+}
+
+#undef COMB_TMP
+#undef COMB_ENTRY
+#undef COMB_TABLE_NWORDS
+#undef COMB_ENTRIES
+#undef COMB_SPACING
+#undef COMB_TABLES
+#undef COMB_ROWS
+#undef COMB_TEETH
+
+//------------------------------------------------------------------------------
+
+// the bucket sums are in XYZZ coordinates
+#define SIDX(b) (SUMS + (b-1)*(4*NLIMBS_P))
 
 // Multi-Scalar Multiplication (MSM)
 // standard coefficients (NOT montgomery!)
 // straightforward Pippenger bucketing method
 // parametric bucket size
+// the buckets are accumulated in XYZZ coordinates (cheap mixed additions), and
+// only the window sums are converted back to proj coordinates
 void bls12_381_G1_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs, int window_size) {
 
   assert( (window_size > 0) && (window_size <= 64) );
@@ -514,7 +986,7 @@ void bls12_381_G1_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64
   bls12_381_G1_proj_set_infinity(tgt);
 
   // allocate memory for bucket sums
-  uint64_t *SUMS = malloc( 3*8*NLIMBS_P * (nbuckets-1) );
+  uint64_t *SUMS = malloc( 4*8*NLIMBS_P * (nbuckets-1) );
   assert( SUMS !=0 );
 
   // loop over the windows
@@ -543,7 +1015,7 @@ void bls12_381_G1_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64
 
     // initalize bucket sums
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bls12_381_G1_proj_set_infinity( SIDX(b) );
+      bls12_381_G1_xyzz_set_infinity( SIDX(b) );
     }
 
     // compute bucket sums
@@ -557,22 +1029,24 @@ void bls12_381_G1_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64
       e &= mask;   // bucket coeff
 
       if (e>0) {
-        bls12_381_G1_proj_madd_proj_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
+        bls12_381_G1_xyzz_madd_xyzz_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
       }
     }
 
     // compute running sums
 
-    uint64_t T[3*NLIMBS_P];   // cumulative sum of S-es
-    uint64_t R[3*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t T[4*NLIMBS_P];   // cumulative sum of S-es
+    uint64_t R[4*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t W[3*NLIMBS_P];   // the window sum, converted back
 
-    bls12_381_G1_proj_set_infinity(T);
-    bls12_381_G1_proj_set_infinity(R);
+    bls12_381_G1_xyzz_set_infinity(T);
+    bls12_381_G1_xyzz_set_infinity(R);
 
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bls12_381_G1_proj_add_inplace( T , SIDX(b) );
-      bls12_381_G1_proj_add_inplace( R , T       );
+      bls12_381_G1_xyzz_add_inplace( T , SIDX(b) );
+      bls12_381_G1_xyzz_add_inplace( R , T       );
     }
+    bls12_381_G1_xyzz_to_proj( R , W );
 
     if (!bls12_381_G1_proj_is_infinity(tgt)) {    // we can skip doubling when infinity
       for(int i=0; i<window_size; i++) {
@@ -580,7 +1054,7 @@ void bls12_381_G1_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64
       }
     }
 
-    bls12_381_G1_proj_add_inplace( tgt, R );
+    bls12_381_G1_proj_add_inplace( tgt, W );
   }
 
   free(SUMS);
@@ -672,122 +1146,631 @@ void bls12_381_G1_proj_MSM_mont_coeff_affine_out(int npoints, const uint64_t *ex
 //------------------------------------------------------------------------------
 
 
+// inverse of 2 (Montgomery repr)
+const uint64_t bls12_381_G1_proj_oneHalf[4] = { 0x00000000ffffffff, 0xac425bfd0001a401, 0xccc627f7f65e27fa, 0x0c1258acd66282b7 };
+
 #define GRP_NLIMBS (3*NLIMBS_P)
 
 // -----------------------------------------------------------------------------
+// FFT of group elements
+//
+// Iterative radix-2 decimation-in-time FFT, computed in place after a bit-reversal
+// permutation. The twiddle factors are precomputed once (in standard repr, as the
+// scalar multiplication needs that); the butterflies of each layer are independent,
+// so they are distributed among the worker threads.
+
+// below this many butterflies per layer, we don't bother with multithreading
+#define FFT_PARALLEL_THRESHOLD 64
+
+// computes the twiddle factors `[ gen^j | j <- [0..N/2-1] ]` (in standard repr), `m >= 1`
+void bls12_381_G1_proj_fft_twiddles( int m, const uint64_t *gen, uint64_t *twiddles ) {
+  int halfN = (1<<(m-1));
+  uint64_t acc[NLIMBS_R];
+  bls12_381_Fr_mont_set_one( acc );
+  for(int j=0; j<halfN; j++) {
+    bls12_381_Fr_mont_to_std( acc , twiddles + j*NLIMBS_R );
+    bls12_381_Fr_mont_mul_inplace( acc , gen );
+  }
+}
 
-void bls12_381_G1_proj_fft_forward_noalloc( int m, int src_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
+// reverses the lowest `m` bits of `i`
+int bls12_381_G1_proj_fft_bit_reverse( int m, int i ) {
+  int j = 0;
+  for(int k=0; k<m; k++) {
+    j = (j << 1) | (i & 1);
+    i = i >> 1;
+  }
+  return j;
+}
 
-  if (m==0) {
-    bls12_381_G1_proj_copy( src, tgt );
-    return;
+// copies `src` into `tgt` in bit-reversed order (`src == tgt` is allowed)
+void bls12_381_G1_proj_fft_bit_reverse_permute( int m, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  if (src == tgt) {
+    uint64_t tmp[GRP_NLIMBS];
+    for(int i=0; i<N; i++) {
+      int j = bls12_381_G1_proj_fft_bit_reverse( m, i );
+      if (i < j) {
+        bls12_381_G1_proj_copy( tgt + i*GRP_NLIMBS , tmp );
+        bls12_381_G1_proj_copy( tgt + j*GRP_NLIMBS , tgt + i*GRP_NLIMBS );
+        bls12_381_G1_proj_copy( tmp                , tgt + j*GRP_NLIMBS );
+      }
+    }
   }
+  else {
+    for(int i=0; i<N; i++) {
+      bls12_381_G1_proj_copy( src + i*GRP_NLIMBS , tgt + bls12_381_G1_proj_fft_bit_reverse( m, i )*GRP_NLIMBS );
+    }
+  }
+}
 
-  if (m==1) {
-    // N = 2
-    bls12_381_G1_proj_add( src , src + src_stride*GRP_NLIMBS , tgt              );    // x + y
-    bls12_381_G1_proj_sub( src , src + src_stride*GRP_NLIMBS , tgt + GRP_NLIMBS );    // x - y
-    return;
+typedef struct {
+  int m;                      // log2 of the size
+  int half;                   // half the block size of the current layer
+  int chunk;                  // number of butterflies per task
+  const uint64_t *twiddles;
+  uint64_t *buf;
+} bls12_381_G1_proj_fft_layer_ctx_t;
+
+// the butterflies `(u,v) -> (u + w*v, u - w*v)` with indices in `[ j*chunk , (j+1)*chunk )`
+// of a layer of the FFT. The blocks of this layer have size `2*half`, and the twiddle
+// factor for the `k`-th butterfly in a block is `w = gen^(k*N/(2*half))`
+void bls12_381_G1_proj_fft_layer_task( void *ctx, int j ) {
+  bls12_381_G1_proj_fft_layer_ctx_t *c = (bls12_381_G1_proj_fft_layer_ctx_t*) ctx;
+  int half   = c->half;
+  int halfN  = (1<<(c->m-1));
+  int stride = halfN / half;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > halfN) { b = halfN; }
+  uint64_t tmp[GRP_NLIMBS];
+  for(int t=a; t<b; t++) {
+    int k = t & (half-1);
+    uint64_t *u = c->buf + (2*(t-k) + k)*GRP_NLIMBS;
+    uint64_t *v = u + half*GRP_NLIMBS;
+    if (k == 0) {
+      bls12_381_G1_proj_copy( v , tmp );
+    }
+    else {
+      bls12_381_G1_proj_scl_glv_Fr_std( c->twiddles + (k*stride)*NLIMBS_R , v , tmp );       // w*v
+    }
+    bls12_381_G1_proj_sub( u , tmp , v );                                          // u - w*v
+    bls12_381_G1_proj_add_inplace( u , tmp );                                      // u + w*v
   }
+}
 
-  else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
-
-    uint64_t gpow[NLIMBS_R];
-    bls12_381_Fr_mont_sqr( gen, gpow );  // gen^2
-    
-    bls12_381_G1_proj_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src                         , buf + N*GRP_NLIMBS , buf                    );
-    bls12_381_G1_proj_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src + src_stride*GRP_NLIMBS , buf + N*GRP_NLIMBS , buf + halfN*GRP_NLIMBS );
-
-    bls12_381_Fr_mont_set_one(gpow);
-    for(int j=0; j<halfN; j++) {
-      bls12_381_G1_proj_scl_Fr_mont(gpow , buf + (j+halfN)*GRP_NLIMBS  , tgt +  j *GRP_NLIMBS );  //   g*v[k]
-      bls12_381_G1_proj_neg ( tgt +  j       *GRP_NLIMBS ,        tgt + (j+halfN)*GRP_NLIMBS );   // - g*v[k]
-      bls12_381_G1_proj_add_inplace( tgt +  j       *GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] + g*v[k]
-      bls12_381_G1_proj_add_inplace( tgt + (j+halfN)*GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] - g*v[k]
-      bls12_381_Fr_mont_mul_inplace( gpow , gen );      
+// in-place FFT of `N = 2^m` group elements, given in bit-reversed order
+void bls12_381_G1_proj_fft_inplace_noalloc( int m, const uint64_t *twiddles, uint64_t *buf ) {
+  if (m == 0) return;
+  int halfN = (1<<(m-1));
+  int T = parallel_get_num_threads();
+  bls12_381_G1_proj_fft_layer_ctx_t ctx;
+  ctx.m        = m;
+  ctx.twiddles = twiddles;
+  ctx.buf      = buf;
+  for(int half=1; half<=halfN; half<<=1) {
+    ctx.half = half;
+    if ( (halfN < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = halfN;
+      bls12_381_G1_proj_fft_layer_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (halfN + T - 1) / T;
+      parallel_for( (halfN + ctx.chunk - 1) / ctx.chunk , bls12_381_G1_proj_fft_layer_task, &ctx );
     }
   }
 }
 
+typedef struct {
+  int chunk;
+  int N;
+  const uint64_t *scalar;
+  uint64_t *buf;
+} bls12_381_G1_proj_fft_scale_ctx_t;
+
+void bls12_381_G1_proj_fft_scale_task( void *ctx, int j ) {
+  bls12_381_G1_proj_fft_scale_ctx_t *c = (bls12_381_G1_proj_fft_scale_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  for(int i=a; i<b; i++) {
+    bls12_381_G1_proj_scl_glv_Fr_std( c->scalar , c->buf + i*GRP_NLIMBS , c->buf + i*GRP_NLIMBS );
+  }
+}
+
+// normalizes `N` points using a single inversion: first we convert them to affine
+// coordinates (which are then packed at the beginning of the buffer), then back
+void bls12_381_G1_proj_fft_normalize( int N, uint64_t *buf ) {
+  bls12_381_G1_proj_batch_to_affine( N, buf, buf );
+  for(int i=N-1; i>=0; i--) {
+    uint64_t tmp[2*NLIMBS_P];
+    memcpy( tmp, buf + i*2*NLIMBS_P, 8*2*NLIMBS_P );
+    bls12_381_G1_proj_from_affine( tmp, buf + i*GRP_NLIMBS );
+  }
+}
+
 // forward FFT of group elements (convert from [L_k(tau)] to [tau^i])
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
 // `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)
 // NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
 void bls12_381_G1_proj_fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
   int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bls12_381_G1_proj_fft_forward_noalloc( m, 1, gen, src, buf, tgt);
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bls12_381_G1_proj_normalize_inplace( tgt + i*GRP_NLIMBS );
+  bls12_381_G1_proj_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bls12_381_G1_proj_fft_twiddles( m, gen, twiddles );
+    bls12_381_G1_proj_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
   }
+  bls12_381_G1_proj_fft_normalize( N, tgt );
 }
 
+// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
+// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
+// This is the forward FFT with `gen^-1`, followed by scaling with `1/N`
+// NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
+void bls12_381_G1_proj_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
+  int N = (1<<m);
+  bls12_381_G1_proj_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t ginv[NLIMBS_R];
+    bls12_381_Fr_mont_inv( gen , ginv );
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bls12_381_G1_proj_fft_twiddles( m, ginv, twiddles );
+    bls12_381_G1_proj_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
+
+    // 1/N = (1/2)^m
+    uint64_t ninv_mont[NLIMBS_R];
+    uint64_t ninv[NLIMBS_R];
+    bls12_381_Fr_mont_pow_uint64( bls12_381_G1_proj_oneHalf , m , ninv_mont );
+    bls12_381_Fr_mont_to_std( ninv_mont , ninv );
+
+    bls12_381_G1_proj_fft_scale_ctx_t ctx;
+    ctx.N      = N;
+    ctx.scalar = ninv;
+    ctx.buf    = tgt;
+    int T = parallel_get_num_threads();
+    if ( (N < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = N;
+      bls12_381_G1_proj_fft_scale_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (N + T - 1) / T;
+      parallel_for( (N + ctx.chunk - 1) / ctx.chunk , bls12_381_G1_proj_fft_scale_task, &ctx );
+    }
+  }
+  bls12_381_G1_proj_fft_normalize( N, tgt );
+}
 
-// -----------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// generating a structured reference string ("powers of tau"), for testing
+//
+// The points are computed in chunks: each chunk computes its scalars, multiplies
+// the generator by them (using the precomputed comb table), and converts the results
+// to affine coordinates with a single inversion. The chunks are distributed among
+// the worker threads, so that no N-sized temporary buffer is needed.
+//
+// In the Lagrange basis of the subgroup generated by `gen` (of size N), we have
+//
+//   L_k(tau) = gen^k * (tau^N - 1) / ( N * (tau - gen^k) )
+//
+// so when `tau` is known, the Lagrange basis costs the same as the monomial one
+// (plus a batched inversion in Fr). Without `tau`, the monomial basis can be
+// converted by an inverse group FFT, which is much slower.
+
+#define SRS_CHUNK 1024
+
+typedef struct {
+  int N;
+  const uint64_t *tau;       // Montgomery repr
+  const uint64_t *gen;       // generator of the subgroup (only for the Lagrange basis)
+  const uint64_t *coeff;     // (tau^N - 1) / N          (only for the Lagrange basis)
+  uint64_t *tgt;
+} bls12_381_G1_proj_srs_ctx_t;
+
+// multiplies the generator by `n` scalars (in Montgomery repr), with affine output
+void bls12_381_G1_proj_srs_scale_gen_chunk( int n, const uint64_t *scalars, uint64_t *tgt ) {
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * n );
+  assert( tmp != 0 );
+  for(int i=0; i<n; i++) {
+    bls12_381_G1_proj_scl_gen_Fr_mont( scalars + i*NLIMBS_R , tmp + i*3*NLIMBS_P );
+  }
+  bls12_381_G1_proj_batch_to_affine( n , tmp , tgt );
+  free(tmp);
+}
 
-// inverse of 2 (standard repr)
-const uint64_t bls12_381_G1_proj_oneHalf[4] = { 0x00000000ffffffff, 0xac425bfd0001a401, 0xccc627f7f65e27fa, 0x0c1258acd66282b7 };
+void bls12_381_G1_proj_srs_monomial_task( void *ctx, int j ) {
+  bls12_381_G1_proj_srs_ctx_t *c = (bls12_381_G1_proj_srs_ctx_t*) ctx;
+  int a = j * SRS_CHUNK;
+  int b = a + SRS_CHUNK;
+  if (b > c->N) { b = c->N; }
+  uint64_t *scalars = malloc( 8*NLIMBS_R * (b-a) );
+  assert( scalars != 0 );
+  uint64_t start[NLIMBS_R];
+  bls12_381_Fr_mont_pow_uint64( c->tau , a , start );
+  bls12_381_arr_mont_powers( b-a , start , c->tau , scalars );
+  bls12_381_G1_proj_srs_scale_gen_chunk( b-a , scalars , c->tgt + a*2*NLIMBS_P );
+  free(scalars);
+}
 
-void bls12_381_G1_proj_fft_inverse_noalloc(int m, int tgt_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
+// computes `[ tau^i * G | i <- [0..N-1] ]` in affine coordinates, where `G` is the
+// subgroup generator and `tau` is in Fr *in Montgomery repr*
+void bls12_381_G1_proj_srs_generate( int N, const uint64_t *tau, uint64_t *tgt ) {
+  if (N <= 0) return;
+  bls12_381_G1_proj_srs_ctx_t ctx;
+  ctx.N     = N;
+  ctx.tau   = tau;
+  ctx.gen   = 0;
+  ctx.coeff = 0;
+  ctx.tgt   = tgt;
+  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , bls12_381_G1_proj_srs_monomial_task , &ctx );
+}
 
-  if (m==0) {
-    bls12_381_G1_proj_copy( src, tgt );
-    return;
+void bls12_381_G1_proj_srs_lagrange_task( void *ctx, int j ) {
+  bls12_381_G1_proj_srs_ctx_t *c = (bls12_381_G1_proj_srs_ctx_t*) ctx;
+  int a = j * SRS_CHUNK;
+  int b = a + SRS_CHUNK;
+  if (b > c->N) { b = c->N; }
+  int n = b - a;
+  uint64_t *scalars = malloc( 8*NLIMBS_R * n );
+  uint64_t *denoms  = malloc( 8*NLIMBS_R * n );
+  assert( scalars != 0 );
+  assert( denoms  != 0 );
+
+  // scalars[i] = gen^(a+i)
+  uint64_t start[NLIMBS_R];
+  bls12_381_Fr_mont_pow_uint64( c->gen , a , start );
+  bls12_381_arr_mont_powers( n , start , c->gen , scalars );
+
+  if (bls12_381_Fr_mont_is_zero( c->coeff )) {
+    // tau is in the subgroup, so L_k(tau) is 1 if tau = gen^k and 0 otherwise
+    for(int i=0; i<n; i++) {
+      uint64_t *s = scalars + i*NLIMBS_R;
+      if (bls12_381_Fr_mont_is_equal( s , c->tau )) { bls12_381_Fr_mont_set_one( s ); } else { bls12_381_Fr_mont_set_zero( s ); }
+    }
+  }
+  else {
+    for(int i=0; i<n; i++) {
+      bls12_381_Fr_mont_sub( c->tau , scalars + i*NLIMBS_R , denoms + i*NLIMBS_R );
+    }
+    bls12_381_Fr_mont_batch_inv( n , denoms , denoms );
+    for(int i=0; i<n; i++) {
+      uint64_t *s = scalars + i*NLIMBS_R;
+      bls12_381_Fr_mont_mul_inplace( s , denoms + i*NLIMBS_R );
+      bls12_381_Fr_mont_mul_inplace( s , c->coeff );
+    }
   }
 
-  if (m==1) {
-    // N = 2
-    bls12_381_G1_proj_add( src , src + GRP_NLIMBS , tgt                         );   // x + y
-    bls12_381_G1_proj_sub( src , src + GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );   // x - y
-    bls12_381_G1_proj_scl_Fr_mont( bls12_381_G1_proj_oneHalf , tgt                         , tgt                         );      // (x + y)/2
-    bls12_381_G1_proj_scl_Fr_mont( bls12_381_G1_proj_oneHalf , tgt + tgt_stride*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );      // (x - y)/2
-    return;
+  bls12_381_G1_proj_srs_scale_gen_chunk( n , scalars , c->tgt + a*2*NLIMBS_P );
+  free(denoms);
+  free(scalars);
+}
+
+// computes `[ L_k(tau) * G | k <- [0..N-1] ]` in affine coordinates, where `N = 2^m`,
+// `L_k` are the Lagrange polynomials of the subgroup generated by `gen`, `G` is the
+// curve subgroup generator, and both `gen` and `tau` are in Fr *in Montgomery repr*
+void bls12_381_G1_proj_srs_generate_lagrange( int m, const uint64_t *gen, const uint64_t *tau, uint64_t *tgt ) {
+  int N = (1<<m);
+
+  // coeff = (tau^N - 1) / N
+  uint64_t coeff[NLIMBS_R];
+  uint64_t one  [NLIMBS_R];
+  uint64_t size [NLIMBS_R];
+  uint64_t N_std[NLIMBS_R];
+  bls12_381_Fr_mont_set_one( one );
+  memset( N_std, 0, 8*NLIMBS_R );
+  N_std[0] = N;
+  bls12_381_Fr_mont_from_std( N_std , size );
+  bls12_381_Fr_mont_pow_uint64( tau , N , coeff );
+  bls12_381_Fr_mont_sub_inplace( coeff , one );
+  bls12_381_Fr_mont_div_inplace( coeff , size );
+
+  bls12_381_G1_proj_srs_ctx_t ctx;
+  ctx.N     = N;
+  ctx.tau   = tau;
+  ctx.gen   = gen;
+  ctx.coeff = coeff;
+  ctx.tgt   = tgt;
+  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , bls12_381_G1_proj_srs_lagrange_task , &ctx );
+}
+
+// converts `[ tau^i * G | i <- [0..N-1] ]` (affine, where `N = 2^m`) to the Lagrange
+// basis of the subgroup generated by `gen` (in Montgomery repr), using the group FFT.
+// This is useful when `tau` is not known; it needs a temporary buffer of N projective points.
+// Note: the output must not overlap with the input
+// The points must be in the prime-order subgroup (as for the group FFT)
+void bls12_381_G1_proj_srs_monomial_to_lagrange( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * N );
+  assert( tmp != 0 );
+  bls12_381_G1_proj_batch_from_affine( N , src , tmp );
+  bls12_381_G1_proj_fft_inverse( m , gen , tmp , tmp );
+  bls12_381_G1_proj_batch_to_affine_parallel( N , tmp , tgt );
+  free(tmp);
+}
+
+#undef SRS_CHUNK
+
+//------------------------------------------------------------------------------
+// cofactor clearing
+
+// multiplication by the curve parameter x = -15132376222941642752
+void bls12_381_G1_proj_scl_by_x( const uint64_t *src , uint64_t *tgt ) {
+  const uint64_t absx = 0xd201000000010000;
+  uint64_t acc[3*NLIMBS_P];
+  bls12_381_G1_proj_copy( src, acc );
+  for(int i=62; i>=0; i--) {
+    bls12_381_G1_proj_dbl_inplace( acc );
+    if ((absx >> i) & 1) { bls12_381_G1_proj_add_inplace( acc, src ); }
   }
+  bls12_381_G1_proj_neg( acc, tgt );
+}
 
-  else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
+// maps a curve point into the subgroup G1, by multiplying with
+// the effective cofactor h_eff = 15132376222941642753
+void bls12_381_G1_proj_clear_cofactor( const uint64_t *src , uint64_t *tgt ) {
+  // h_eff = 1 - x; this is not a multiple of the cofactor, but kills the
+  // whole cofactor part of the group (see RFC 9380, section 8.8.1)
+  uint64_t t1[3*NLIMBS_P];
+  bls12_381_G1_proj_scl_by_x( src, t1 );
+  bls12_381_G1_proj_sub( src, t1, tgt );
+}
 
-    uint64_t ginv[NLIMBS_R];
-    bls12_381_Fr_mont_inv( gen , ginv );  // gen^-1
-
-    uint64_t gpow[NLIMBS_R];    
-    bls12_381_Fr_mont_copy(bls12_381_G1_proj_oneHalf , gpow);  // 1/2
-    for(int j=0; j<halfN; j++) {
-      bls12_381_G1_proj_add( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + j        *GRP_NLIMBS  );    // x + y
-      bls12_381_G1_proj_sub( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS  );    // x - y
-      bls12_381_G1_proj_scl_Fr_mont( bls12_381_G1_proj_oneHalf , buf + j        *GRP_NLIMBS , buf + j        *GRP_NLIMBS );    // (x + y) /  2
-      bls12_381_G1_proj_scl_Fr_mont( gpow                    , buf + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS );    // (x - y) / (2*g^k)
-      bls12_381_Fr_mont_mul_inplace( gpow , ginv );      
-    }
+//------------------------------------------------------------------------------
+// hashing to the curve (RFC 9380)
+//
+//   hash_to_curve(msg)   = clear_cofactor( map_to_curve(u0) + map_to_curve(u1) )
+//   encode_to_curve(msg) = clear_cofactor( map_to_curve(u) )
+//
+// where the field elements u0,u1 (resp. u) come from `hash_to_field`, which
+// uses expand_message_xmd with SHA-256. The map to the curve is
+// the simplified SWU map to an isogenous curve, followed by an
+// isogeny of degree 11.
+//
+// Each map needs a single inversion; when hashing many messages, these inversions
+// (and the final conversion to affine coordinates) are batched together.
+
+#define H2C_L         64       // number of bytes per prime field element
+#define H2C_M         1        // extension degree of the base field
+#define H2C_NLIMBS_FP 6
+
+// (2^(64*(H2C_NLIMBS_FP-1)) * R^2) mod p, for reducing the hashed bytes into Fp
+const uint64_t bls12_381_G1_proj_h2c_bytes_hi_scale[6] = { 0x92519ca996fb76ca, 0x3b0a1ec9a6ad99cc, 0xe940082835cca96a, 0x901598abcc972ced, 0xff891f519194a48b, 0x152d85031974e49e };
+
+// interprets `H2C_L` big-endian bytes as an integer, and reduces it modulo p
+// (into Montgomery representation). The integer is split as hi*2^(64*(n-1)) + lo
+// where both `hi` and `lo` are smaller than p.
+void bls12_381_G1_proj_h2c_bytes_to_Fp( const uint8_t *src, uint64_t *tgt ) {
+  uint64_t ws[H2C_L/8];
+  uint64_t lo[H2C_NLIMBS_FP];
+  uint64_t hi[H2C_NLIMBS_FP];
+  uint64_t tmp[H2C_NLIMBS_FP];
+  for(int i=0; i<H2C_L/8; i++) {
+    const uint8_t *q = src + H2C_L - 8*(i+1);
+    uint64_t w = 0;
+    for(int j=0; j<8; j++) { w = (w << 8) | q[j]; }
+    ws[i] = w;
+  }
+  memset( lo, 0, 8*H2C_NLIMBS_FP );
+  memset( hi, 0, 8*H2C_NLIMBS_FP );
+  memcpy( lo, ws                    , 8*(H2C_NLIMBS_FP-1) );
+  memcpy( hi, ws + (H2C_NLIMBS_FP-1), 8*(H2C_L/8 - H2C_NLIMBS_FP + 1) );
+  bls12_381_Fp_mont_from_std( lo, tmp );
+  bls12_381_Fp_mont_mul( hi, bls12_381_G1_proj_h2c_bytes_hi_scale, tgt );
+  bls12_381_Fp_mont_add_inplace( tgt, tmp );
+}
+
+// hashes a message to `count` elements of the base field (in Montgomery
+// representation). Returns 0 if `count` is too big for expand_message_xmd.
+uint8_t bls12_381_G1_proj_hash_to_field( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int count, uint64_t *tgt ) {
+  int len = count * H2C_M * H2C_L;
+  uint8_t *bytes = malloc( len );
+  assert( bytes != 0 );
+  if (!expand_message_xmd_sha256( dst, dst_len, msg, msg_len, len, bytes )) {
+    free(bytes);
+    return 0;
+  }
+  for(int i=0; i<count*H2C_M; i++) {
+    bls12_381_G1_proj_h2c_bytes_to_Fp( bytes + i*H2C_L, tgt + i*H2C_NLIMBS_FP );
+  }
+  free(bytes);
+  return 1;
+}
 
-    bls12_381_Fr_mont_sqr( gen, gpow );  // gen^2
-    bls12_381_G1_proj_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf                    , buf + N*GRP_NLIMBS , tgt                         );
-    bls12_381_G1_proj_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf + halfN*GRP_NLIMBS , buf + N*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );
+// the "sign" of a field element (RFC 9380, section 4.1)
+uint8_t bls12_381_G1_proj_h2c_sgn0( const uint64_t *src ) {
+  uint64_t std[H2C_NLIMBS_FP];
+  bls12_381_Fp_mont_to_std( src, std );
+  return (std[0] & 1);
+}
+
+// computes x^3 + a*x + b
+void bls12_381_G1_proj_h2c_rhs( const uint64_t *a, const uint64_t *b, const uint64_t *x, uint64_t *tgt ) {
+  uint64_t t[NLIMBS_P];
+  bls12_381_Fp_mont_sqr( x, t );
+  bls12_381_Fp_mont_add_inplace( t, a );
+  bls12_381_Fp_mont_mul( t, x, tgt );
+  bls12_381_Fp_mont_add_inplace( tgt, b );
+}
 
+// the non-square Z of the map
+const uint64_t bls12_381_G1_proj_h2c_Z[6] = { 0x886c00000023ffdc, 0x0f70008d3090001d, 0x77672417ed5828c3, 0x9dac23e943dc1740, 0x50553f1b9c131521, 0x078c712fbe0ab6e8 };
+// a square root of -Z
+const uint64_t bls12_381_G1_proj_h2c_sqrt_minus_Z[6] = { 0xf37b0ced8fb71e24, 0xf02dc8a4535a8779, 0x732ed835f7eb14ea, 0x524ca41ecb2bce0d, 0x095e3801e90b5fc1, 0x0252ad055472a90e };
+
+// the isogenous curve E': y^2 = x^3 + A'*x + B'
+const uint64_t bls12_381_G1_proj_h2c_iso_A[6] = { 0x2f65aa0e9af5aa51, 0x86464c2d1e8416c3, 0xb85ce591b7bd31e2, 0x27e11c91b5f24e7c, 0x28376eda6bfc1835, 0x155455c3e5071d85 };
+const uint64_t bls12_381_G1_proj_h2c_iso_B[6] = { 0xfb996971fe22a1e0, 0x9aa93eb35b742d6f, 0x8c476013de99c5c4, 0x873e27c3a221e571, 0xca72b5e45a52d888, 0x06824061418a386b };
+
+// the isogeny E' -> E is (x,y) -> ( xnum(x)/xden(x) , y*ynum(x)/yden(x) ),
+// the coefficients are starting from the constant term
+const uint64_t bls12_381_G1_proj_h2c_iso_xnum[72] = { 0x4d18b6f3af00131c, 0x19fa219793fee28c, 0x3f2885f1467f19ae, 0x23dcea34f2ffb304, 0xd15b58d2ffc00054, 0x0913be200a20bef4, 0x898985385cdbbd8b, 0x3c79e43cc7d966aa, 0x1597e193f4cd233a, 0x8637ef1e4d6623ad, 0x11b22deed20d827b, 0x07097bc5998784ad, 0xa542583a480b664b, 0xfc7169c026e568c6, 0x5ba2ef314ed8b5a6, 0x5b5491c05102f0e7, 0xdf6e99707d2a0079, 0x0784151ed7605524, 0x494e212870f72741, 0xab9be52fbda43021, 0x26f5577994e34c3d, 0x049dfee82aefbd60, 0x65dadd7828505289, 0x0e93d431ea011aeb, 0x90ee774bd6a74d45, 0x7ada1c8a41bfb185, 0x0f1a8953b325f464, 0x104c24211be4805c, 0x169139d319ea7a8f, 0x09f20ead8e532bf6, 0x6ddd93e2f43626b7, 0xa5482c9aa1ccd7bd, 0x143245631883f4bd, 0x2e0a94ccf77ec0db, 0xb0282d480e56489f, 0x18f4bfcbb4368929, 0x23c5f0c953402dfd, 0x7a43ff6958ce4fe9, 0x2c390d3d2da5df63, 0xd0df5c98e1f9d70f, 0xffd89869a572b297, 0x1277ffc72f25e8fe, 0x79f4f0490f06a8a6, 0x85f894a88030fd81, 0x12da3054b18b6410, 0xe2a57f6505880d65, 0xbba074f260e400f1, 0x08b76279f621d028, 0xe67245ba78d5b00b, 0x8456ba9a1f186475, 0x7888bff6e6b33bb4, 0xe21585b9a30f86cb, 0x05a69cdcef55feee, 0x09e699dd9adfa5ac, 0x0de5c357bff57107, 0x0a0db4ae6b1a10b2, 0xe256bb67b3b3cd8d, 0x8ad456574e9db24f, 0x0443915f50fd4179, 0x098c4bf7de8b6375, 0xe6b0617e7dd929c7, 0xfe6e37d442537375, 0x1dafdeda137a489e, 0xe4efd1ad3f767ceb, 0x4a51d8667f0fe1cf, 0x054fdf4bbf1d821c, 0x72db2a50658d767b, 0x8abf91faa257b3d5, 0xe969d6833764ab47, 0x464170142a1009eb, 0xb14f01aadb30be2f, 0x18ae6a856f40715d };
+const uint64_t bls12_381_G1_proj_h2c_iso_xden[66] = { 0xb962a077fdb0f945, 0xa6a9740fefda13a0, 0xc14d568c3ed6c544, 0xb43fc37b908b133e, 0x9c0b3ac929599016, 0x0165aa6c93ad115f, 0x23279a3ba506c1d9, 0x92cfca0a9465176a, 0x3b294ab13755f0ff, 0x116dda1c5070ae93, 0xed4530924cec2045, 0x083383d6ed81f1ce, 0x9885c2a6449fecfc, 0x4a2b54ccd37733f0, 0x17da9ffd8738c142, 0xa0fba72732b3fafd, 0xff364f36e54b6812, 0x0f29c13c660523e2, 0xe349cc118278f041, 0xd487228f2f3204fb, 0xc9d325849ade5150, 0x43a92bd69c15c2df, 0x1c2c7844bc417be4, 0x12025184f407440c, 0x587f65ae6acb057b, 0x1444ef325140201f, 0xfbf995e71270da49, 0xccda066072436a42, 0x7408904f0f186bb2, 0x13b93c63edf6c015, 0xfb918622cd141920, 0x4a4c64423ecaddb4, 0x0beb232927f7fb26, 0x30f94df6f83a3dc2, 0xaeedd424d780f388, 0x06cc402dd594bbeb, 0xd41f761151b23f8f, 0x32a92465435719b3, 0x64f436e888c62cb9, 0xdf70a9a1f757c6e4, 0x6933a38d5b594c81, 0x0c6f7f7237b46606, 0x693c08747876c8f7, 0x22c9850bf9cf80f0, 0x8e9071dab950c124, 0x89bc62d61c7baf23, 0xbc6be2d8dad57c23, 0x17916987aa14a122, 0x1be3ff439c1316fd, 0x9965243a7571dfa7, 0xc7f7f62962f5cd81, 0x32c6aa9af394361c, 0xbbc2ee18e1c227f4, 0x0c102cbac531bb34, 0x997614c97bacbf07, 0x61f86372b99192c0, 0x5b8c95fc14353fc3, 0xca2b066c2a87492f, 0x16178f5bbf698711, 0x12a6dcd7f0f4e0e8, 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493 };
+const uint64_t bls12_381_G1_proj_h2c_iso_ynum[96] = { 0x2b567ff3e2837267, 0x1d4d9e57b958a767, 0xce028fea04bd7373, 0xcc31a30a0b6cd3df, 0x7d7b18a682692693, 0x0d300744d42a0310, 0x99c2555fa542493f, 0xfe7f53cc4874f878, 0x5df0608b8f97608a, 0x14e03832052b49c8, 0x706326a6957dd5a4, 0x0a8dadd9c2414555, 0x13d942922a5cf63a, 0x357e33e36e261e7d, 0xcf05a27c8456088d, 0x0000bd1de7ba50f0, 0x83d0c7532f8c1fde, 0x13f70bf38bbf2905, 0x5c57fd95bfafbdbb, 0x28a359a65e541707, 0x3983ceb4f6360b6d, 0xafe19ff6f97e6d53, 0xb3468f4550192bf7, 0x0bb6cde49d8ba257, 0x590b62c7ff8a513f, 0x314b4ce372cacefd, 0x6bef32ce94b8a800, 0x6ddf84a095713d5f, 0x64eace4cb0982191, 0x0386213c651b888d, 0xa5310a31111bbcdd, 0xa14ac0f5da148982, 0xf9ad9cc95423d2e9, 0xaa6ec095283ee4a7, 0xcf5b1f022e1c9107, 0x01fddf5aed881793, 0x65a572b0d7a7d950, 0xe25c2d8183473a19, 0xc2fcebe7cb877dbd, 0x05b2d36c769a89b0, 0xba12961be86e9efb, 0x07eb1b29c1dfde1f, 0x93e09572f7c4cd24, 0x364e929076795091, 0x8569467e68af51b5, 0xa47da89439f5340f, 0xf4fa918082e44d64, 0x0ad52ba3e6695a79, 0x911429844e0d5f54, 0xd03f51a3516bb233, 0x3d587e5640536e66, 0xfa86d2a3a9a73482, 0xa90ed5adf1ed5537, 0x149c9c326a5e7393, 0x462bbeb03c12921a, 0xdc9af5fa0a274a17, 0x9a558ebde836ebed, 0x649ef8f11a4fae46, 0x8100e1652b3cdc62, 0x1862bd62c291dacb, 0x05c9b8ca89f12c26, 0x0194160fa9b9ac4f, 0x6a643d5a6879fa2c, 0x14665bdd8846e19d, 0xbb1d0d53af3ff6bf, 0x12c7e1c3b28962e5, 0xb55ebf900b8a3e17, 0xfedc77ec1a9201c4, 0x1f07db10ea1a4df4, 0x0dfbd15dc41a594d, 0x389547f2334a5391, 0x02419f98165871a4, 0xb416af000745fc20, 0x8e563e9d1ea6d0f5, 0x7c763e17763a0652, 0x01458ef0159ebbef, 0x8346fe421f96bb13, 0x0d2d7b829ce324d2, 0x93096bb538d64615, 0x6f2a2619951d823a, 0x8f66b3ea59514fa4, 0xf563e63704f7092f, 0x724b136c4cf2d9fa, 0x046959cfcfd0bf49, 0xea748d4b6e405346, 0x91e9079c2c02d58f, 0x41064965946d9b59, 0xa06731f1d2bbe1ee, 0x07f897e267a33f1b, 0x1017290919210e5f, 0x872aa6c17d985097, 0xeecc53161264562a, 0x07afe37afff55002, 0x54759078e5be6838, 0xc4b92d15db8acca8, 0x106d87d1b51d13b9 };
+const uint64_t bls12_381_G1_proj_h2c_iso_yden[96] = { 0xeb6c359d47e52b1c, 0x18ef5f8a10634d60, 0xddfa71a0889d5b7e, 0x723e71dcc5fc1323, 0x52f45700b70d5c69, 0x0a8b981ee47691f1, 0x616a3c4f5535b9fb, 0x6f5f037395dbd911, 0xf25f4cc5e35c65da, 0x3e50dffea3c62658, 0x6a33dca523560776, 0x0fadeff77b6bfe3e, 0x2be9b66df470059c, 0x24a2c159a3d36742, 0x115dbe7ad10c2a37, 0xb6634a652ee5884d, 0x04fe8bb2b8d81af4, 0x01c2a7a256fe9c41, 0xf27bf8ef3b75a386, 0x898b367476c9073f, 0x24482e6b8c2f4e5f, 0xc8e0bbd6fe110806, 0x59b0c17f7631448a, 0x11037cd58b3dbfbd, 0x31c7912ea267eec6, 0x1dbf6f1c5fcdb700, 0xd30d4fe3ba86fdb1, 0x3cae528fbee9a2a4, 0xb1cce69b6aa9ad9a, 0x044393bb632d94fb, 0xc66ef6efeeb5c7e8, 0x9824c289dd72bb55, 0x71b1a4d2f119981d, 0x104fc1aafb0919cc, 0x0e49df01d942a628, 0x096c3a09773272d4, 0x9abc11eb5fadeff4, 0x32dca50a885728f0, 0xfb1fa3721569734c, 0xc4b76271ea6506b3, 0xd466a75599ce728e, 0x0c81d4645f4cb6ed, 0x4199f10e5b8be45b, 0xda64e495b1e87930, 0xcb353efe9b33e4ff, 0x9e9efb24aa6424c6, 0xf08d33680a237465, 0x0d3378023e4c7406, 0x7eb4ae92ec74d3a5, 0xc341b4aa9fac3497, 0x5be603899e907687, 0x03bfd9cca75cbdeb, 0x564c2935a96bfa93, 0x0ef3c33371e2fdb5, 0x7ee91fd449f6ac2e, 0xe5d5bd5cb9357a30, 0x773a8ca5196b1380, 0xd0fda172174ed023, 0x6cb95e0fa776aead, 0x0d22d5a40cec7cff, 0xf727e09285fd8519, 0xdc9d55a83017897b, 0x7549d8bd057894ae, 0x178419613d90d8f8, 0xfce95ebdeb5b490a, 0x0467ffaef23fc49e, 0xc1769e6a7c385f1b, 0x79bc930deac01c03, 0x5461c75a23ede3b5, 0x6e20829e5c230c45, 0x828e0f1e772a53cd, 0x116aefa749127bff, 0x101c10bf2744c10a, 0xbbf18d053a6a3154, 0xa0ecf39ef026f602, 0xfc009d4996dc5153, 0xb9000209d5bd08d3, 0x189e5fe4470cd73c, 0x7ebd546ca1575ed2, 0xe47d5a981d081b55, 0x57b2b625b6d4ca21, 0xb0a1ba04228520cc, 0x98738983c2107ff3, 0x13dddbc4799d81d6, 0x09319f2e39834935, 0x039e952cbdb05c21, 0x55ba77a9a2f76493, 0xfd04e3dfc6086467, 0xfb95832e7d78742e, 0x0ef9c24eccaf5e0e, 0x760900000002fffd, 0xebf4000bc40c0002, 0x5f48985753c758ba, 0x77ce585370525745, 0x5c071a97a256ec6d, 0x15f65ec3fa80e493 };
+
+// evaluates a polynomial with `n` coefficients at x (Horner's method)
+void bls12_381_G1_proj_h2c_poly_eval( int n, const uint64_t *coeffs, const uint64_t *x, uint64_t *tgt ) {
+  bls12_381_Fp_mont_copy( coeffs + (n-1)*NLIMBS_P, tgt );
+  for(int i=n-2; i>=0; i--) {
+    bls12_381_Fp_mont_mul_inplace( tgt, x );
+    bls12_381_Fp_mont_add_inplace( tgt, coeffs + i*NLIMBS_P );
   }
 }
- 
-// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
-// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
-// NOTE: we normalize the results
-void bls12_381_G1_proj_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
-  int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bls12_381_G1_proj_fft_inverse_noalloc( m, 1, gen, src, buf, tgt );
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bls12_381_G1_proj_normalize_inplace( tgt + i*GRP_NLIMBS );
+
+// applies the isogeny to an affine point of E', with the result in projective
+// coordinates on E (so that no inversion is needed):
+//
+//   (X:Y:Z) = ( xnum*yden : y*ynum*xden : xden*yden )
+//
+void bls12_381_G1_proj_h2c_iso_map( const uint64_t *x, const uint64_t *y, uint64_t *tgt ) {
+  uint64_t xn[NLIMBS_P];
+  uint64_t xd[NLIMBS_P];
+  uint64_t yn[NLIMBS_P];
+  uint64_t yd[NLIMBS_P];
+  bls12_381_G1_proj_h2c_poly_eval( 12, bls12_381_G1_proj_h2c_iso_xnum, x, xn );
+  bls12_381_G1_proj_h2c_poly_eval( 11, bls12_381_G1_proj_h2c_iso_xden, x, xd );
+  bls12_381_G1_proj_h2c_poly_eval( 16, bls12_381_G1_proj_h2c_iso_ynum, x, yn );
+  bls12_381_G1_proj_h2c_poly_eval( 16, bls12_381_G1_proj_h2c_iso_yden, x, yd );
+  bls12_381_Fp_mont_mul( xn, yd, X3 );
+  bls12_381_Fp_mont_mul( yn, xd, Y3 );
+  bls12_381_Fp_mont_mul_inplace( Y3, y );
+  bls12_381_Fp_mont_mul( xd, yd, Z3 );
+  if (bls12_381_Fp_mont_is_zero( Z3 )) {
+    // the point is in the kernel of the isogeny
+    bls12_381_G1_proj_set_infinity( tgt );
   }
 }
 
-// -----------------------------------------------------------------------------
+// the denominator A'*(Z^2*u^4 + Z*u^2) of the simplified SWU map; its inverse
+// is the only one needed by `map_to_curve_inv`
+void bls12_381_G1_proj_map_to_curve_denom( const uint64_t *u, uint64_t *den ) {
+  uint64_t tv[NLIMBS_P];
+  bls12_381_Fp_mont_sqr( u, tv );
+  bls12_381_Fp_mont_mul_inplace( tv, bls12_381_G1_proj_h2c_Z );         // Z*u^2
+  bls12_381_Fp_mont_sqr( tv, den );
+  bls12_381_Fp_mont_add_inplace( den, tv );                  // Z^2*u^4 + Z*u^2
+  bls12_381_Fp_mont_mul_inplace( den, bls12_381_G1_proj_h2c_iso_A );
+}
+
+// the simplified SWU map (RFC 9380, section 6.6.2) followed by the isogeny, given
+// the inverse of the denominator (or zero if the denominator is zero)
+void bls12_381_G1_proj_map_to_curve_inv( const uint64_t *u, const uint64_t *inv_den, uint64_t *tgt ) {
+  uint64_t tv [NLIMBS_P];
+  uint64_t x  [NLIMBS_P];
+  uint64_t gx [NLIMBS_P];
+  uint64_t y  [NLIMBS_P];
+  uint64_t tmp[NLIMBS_P];
+  bls12_381_Fp_mont_sqr( u, tv );
+  bls12_381_Fp_mont_mul_inplace( tv, bls12_381_G1_proj_h2c_Z );         // Z*u^2
+  if (bls12_381_Fp_mont_is_zero( inv_den )) {
+    // exceptional case: x1 = B' / (Z*A')
+    bls12_381_Fp_mont_mul( bls12_381_G1_proj_h2c_Z, bls12_381_G1_proj_h2c_iso_A, tmp );
+    bls12_381_Fp_mont_div( bls12_381_G1_proj_h2c_iso_B, tmp, x );
+  }
+  else {
+    // x1 = -B' * (Z^2*u^4 + Z*u^2 + 1) / (A' * (Z^2*u^4 + Z*u^2))
+    bls12_381_Fp_mont_sqr( tv, x );
+    bls12_381_Fp_mont_add_inplace( x, tv );
+    bls12_381_Fp_mont_set_one( tmp );
+    bls12_381_Fp_mont_add_inplace( x, tmp );
+    bls12_381_Fp_mont_mul_inplace( x, bls12_381_G1_proj_h2c_iso_B );
+    bls12_381_Fp_mont_mul_inplace( x, inv_den );
+    bls12_381_Fp_mont_neg_inplace( x );
+  }
+  bls12_381_G1_proj_h2c_rhs( bls12_381_G1_proj_h2c_iso_A, bls12_381_G1_proj_h2c_iso_B, x, gx );
+  // a single exponentiation: if g(x1) is not a square, then y^2 = -g(x1), and
+  // x2 = Z*u^2*x1 has g(x2) = (Z*u^2)^3 * g(x1), with square root Z*u^3 * sqrt(-Z) * y
+  bls12_381_Fp_mont_pow_p_plus_1_per_4( gx, y );
+  bls12_381_Fp_mont_sqr( y, tmp );
+  if (!bls12_381_Fp_mont_is_equal( tmp, gx )) {
+    bls12_381_Fp_mont_mul_inplace( x, tv );
+    bls12_381_Fp_mont_mul_inplace( y, tv );
+    bls12_381_Fp_mont_mul_inplace( y, u  );
+    bls12_381_Fp_mont_mul_inplace( y, bls12_381_G1_proj_h2c_sqrt_minus_Z );
+  }
+  if (bls12_381_G1_proj_h2c_sgn0( u ) != bls12_381_G1_proj_h2c_sgn0( y )) {
+    bls12_381_Fp_mont_neg_inplace( y );
+  }
+  bls12_381_G1_proj_h2c_iso_map( x, y, tgt );
+}
 
+// maps a base field element to the curve (projective coordinates)
+void bls12_381_G1_proj_map_to_curve( const uint64_t *u, uint64_t *tgt ) {
+  uint64_t den[NLIMBS_P];
+  bls12_381_G1_proj_map_to_curve_denom( u, den );
+  if (!bls12_381_Fp_mont_is_zero( den )) { bls12_381_Fp_mont_inv_inplace( den ); }
+  bls12_381_G1_proj_map_to_curve_inv( u, den, tgt );
+}
+
+// hashes a message to the subgroup (`hash_to_curve` of RFC 9380)
+void bls12_381_G1_proj_hash_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {
+  uint64_t u [2*NLIMBS_P];
+  uint64_t q0[3*NLIMBS_P];
+  uint64_t q1[3*NLIMBS_P];
+  bls12_381_G1_proj_hash_to_field( dst, dst_len, msg, msg_len, 2, u );
+  bls12_381_G1_proj_map_to_curve( u           , q0 );
+  bls12_381_G1_proj_map_to_curve( u + NLIMBS_P, q1 );
+  bls12_381_G1_proj_add_inplace( q0, q1 );
+  bls12_381_G1_proj_clear_cofactor( q0, tgt );
+}
+
+// the non-uniform variant `encode_to_curve` of RFC 9380
+void bls12_381_G1_proj_encode_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {
+  uint64_t u[NLIMBS_P];
+  uint64_t q[3*NLIMBS_P];
+  bls12_381_G1_proj_hash_to_field( dst, dst_len, msg, msg_len, 1, u );
+  bls12_381_G1_proj_map_to_curve( u, q );
+  bls12_381_G1_proj_clear_cofactor( q, tgt );
+}
+
+// hashes `n` messages (concatenated in `msgs`, with lengths `msg_lens`) to the
+// subgroup, with affine output. The result is the same as calling `hash_to_curve`
+// for each message, but the 2*n inversions in the maps are done as a single
+// batched inversion, and so is the conversion to affine coordinates.
+void bls12_381_G1_proj_hash_to_curve_batch( int n, const uint8_t *dst, int dst_len, const uint8_t *msgs, const int *msg_lens, uint64_t *tgt ) {
+  if (n <= 0) return;
+  uint64_t *us   = malloc( 8 * NLIMBS_P * 2*n );
+  uint64_t *dens = malloc( 8 * NLIMBS_P * 2*n );
+  uint64_t *pts  = malloc( 8 * 3*NLIMBS_P * 2*n );
+  uint8_t  *zero = malloc( 2*n );
+  assert( us != 0 && dens != 0 && pts != 0 && zero != 0 );
+  uint64_t tmp[3*NLIMBS_P];
+
+  const uint8_t *msg = msgs;
+  for(int i=0; i<n; i++) {
+    bls12_381_G1_proj_hash_to_field( dst, dst_len, msg, msg_lens[i], 2, us + 2*i*NLIMBS_P );
+    msg += msg_lens[i];
+  }
+
+  // the (extremely unlikely) zero denominators are replaced by 1 before the
+  // batched inversion, and their "inverses" are set back to zero afterwards
+  for(int i=0; i<2*n; i++) {
+    bls12_381_G1_proj_map_to_curve_denom( us + i*NLIMBS_P, dens + i*NLIMBS_P );
+    zero[i] = bls12_381_Fp_mont_is_zero( dens + i*NLIMBS_P );
+    if (zero[i]) { bls12_381_Fp_mont_set_one( dens + i*NLIMBS_P ); }
+  }
+  bls12_381_Fp_mont_batch_inv( 2*n, dens, dens );
+  for(int i=0; i<2*n; i++) {
+    if (zero[i]) { bls12_381_Fp_mont_set_zero( dens + i*NLIMBS_P ); }
+    bls12_381_G1_proj_map_to_curve_inv( us + i*NLIMBS_P, dens + i*NLIMBS_P, pts + i*3*NLIMBS_P );
+  }
+
+  // the i-th result overwrites the (already used) i-th point
+  for(int i=0; i<n; i++) {
+    bls12_381_G1_proj_add( pts + (2*i)*3*NLIMBS_P, pts + (2*i+1)*3*NLIMBS_P, tmp );
+    bls12_381_G1_proj_clear_cofactor( tmp, pts + i*3*NLIMBS_P );
+  }
+  bls12_381_G1_proj_batch_to_affine( n, pts, tgt );
+
+  free(zero);
+  free(pts);
+  free(dens);
+  free(us);
+}
@@ -33,6 +33,9 @@ const uint64_t bls12_381_G2_affine_gen_G2[36] = { 0xf5f28fa202940a10, 0xb3f5fb26
 // the cofactor of the curve subgroup = 305502333931268344200999753193121504214466019254188142667664032982267604182971884026507427359259977847832272839041616661285803823378372096355777062779109
 const uint64_t bls12_381_G2_affine_cofactor[12] = { 0xcf1c38e31c7238e5, 0x1616ec6e786f0c70, 0x21537e293a6691ae, 0xa628f1cb4d9e82ef, 0xa68a205b2e5a7ddf, 0xcd91de4547085aba, 0x091d50792876a202, 0x05d543a95414e7f1, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
+// the order of the subgroup = 52435875175126190479447740508185965837690552500527637822603658699938581184513
+const uint64_t bls12_381_G2_affine_subgroup_order[4] = { 0xffffffff00000001, 0x53bda402fffe5bfe, 0x3339d80809a1d805, 0x73eda753299d7d48 };
+
 // the constants A and B of the equation
 const uint64_t bls12_381_G2_affine_const_A[12] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bls12_381_G2_affine_const_B[12] = { 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e, 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e };
@@ -122,7 +125,7 @@ uint8_t bls12_381_G2_affine_is_in_subgroup ( const uint64_t *src1 ) {
       uint64_t proj[36];
       uint64_t tmp [36];
       bls12_381_G2_proj_from_affine( src1, proj );
-      bls12_381_G2_proj_scl_Fr_std( bls12_381_G2_affine_cofactor , proj , tmp );
+      bls12_381_G2_proj_scl_generic( bls12_381_G2_affine_subgroup_order , proj , tmp , NLIMBS_R );
       return bls12_381_G2_proj_is_infinity( tmp );
     }
   }
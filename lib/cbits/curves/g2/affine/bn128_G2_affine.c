@@ -33,6 +33,9 @@ const uint64_t bn128_G2_affine_gen_G2[24] = { 0xaf2f35351efbe5db, 0x66a2e3e98253
 // the cofactor of the curve subgroup = 21888242871839275222246405745257275088844257914179612981679871602714643921549
 const uint64_t bn128_G2_affine_cofactor[8] = { 0x345f2299c0f9fa8d, 0x06ceecda572a2489, 0xb85045b68181585e, 0x30644e72e131a029, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
+// the order of the subgroup = 21888242871839275222246405745257275088548364400416034343698204186575808495617
+const uint64_t bn128_G2_affine_subgroup_order[4] = { 0x43e1f593f0000001, 0x2833e84879b97091, 0xb85045b68181585d, 0x30644e72e131a029 };
+
 // the constants A and B of the equation
 const uint64_t bn128_G2_affine_const_A[8] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bn128_G2_affine_const_B[8] = { 0x3bf938e377b802a8, 0x020b1b273633535d, 0x26b7edf049755260, 0x2514c6324384a86d, 0x38e7ecccd1dcff67, 0x65f0b37d93ce0d3e, 0xd749d0dd22ac00aa, 0x0141b9ce4a688d4d };
@@ -122,7 +125,7 @@ uint8_t bn128_G2_affine_is_in_subgroup ( const uint64_t *src1 ) {
       uint64_t proj[24];
       uint64_t tmp [24];
       bn128_G2_proj_from_affine( src1, proj );
-      bn128_G2_proj_scl_Fr_std( bn128_G2_affine_cofactor , proj , tmp );
+      bn128_G2_proj_scl_generic( bn128_G2_affine_subgroup_order , proj , tmp , NLIMBS_R );
       return bn128_G2_proj_is_infinity( tmp );
     }
   }
@@ -0,0 +1,1011 @@
+
+// elliptic curve "BN128 ( Fp2 ) " in Jacobian coordinates, Montgomery field representation
+//
+// NOTE: generated code, do not edit!
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <math.h>         // used only for log2()
+
+#include "bn128_G2_jac.h"
+#include "bn128_G2_affine.h"
+#include "bn128_G2_xyzz.h"
+#include "bn128_Fp2_mont.h"
+#include "bn128_Fr_mont.h"
+#include "bigint256.h"
+#include "parallel.h"
+
+#define NLIMBS_P 8
+#define NLIMBS_R 4
+
+#define X1 (src1)
+#define Y1 (src1 + 8)
+#define Z1 (src1 + 16)
+
+#define X2 (src2)
+#define Y2 (src2 + 8)
+#define Z2 (src2 + 16)
+
+#define X3 (tgt)
+#define Y3 (tgt + 8)
+#define Z3 (tgt + 16)
+
+// the generator of the subgroup G2
+const uint64_t bn128_G2_jac_gen_G2[24] = { 0xaf2f35351efbe5db, 0x66a2e3e98253e7ad, 0x36701d8c0c66d66d, 0x128787e74c6d089f, 0x4560607a2d4afc95, 0x58dd4111299cc567, 0xb028be49345b3b5f, 0x0875b5e4294a6cdd, 0x71a551578f9ba639, 0xd03ece4a4bffb6c4, 0x957d3a7a01ba9551, 0x2a613ea3aa6bbddf, 0x9f0a4cbbfbeae987, 0xa5471bec20650a0b, 0xafa055cd8bd3c0dd, 0x1e979413b23ade5e, 0xd35d438dc58f0d9d, 0x0a78eb28f5c70b3d, 0x666ea36f7879462c, 0x0e0a77c19a07df2f, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+
+// the cofactor of the curve subgroup = 21888242871839275222246405745257275088844257914179612981679871602714643921549
+const uint64_t bn128_G2_jac_cofactor[8] = { 0x345f2299c0f9fa8d, 0x06ceecda572a2489, 0xb85045b68181585e, 0x30644e72e131a029, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+
+// the order of the subgroup = 21888242871839275222246405745257275088548364400416034343698204186575808495617
+const uint64_t bn128_G2_jac_subgroup_order[4] = { 0x43e1f593f0000001, 0x2833e84879b97091, 0xb85045b68181585d, 0x30644e72e131a029 };
+
+// the constants A and B of the equation
+const uint64_t bn128_G2_jac_const_A[8] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bn128_G2_jac_const_B[8] = { 0x3bf938e377b802a8, 0x020b1b273633535d, 0x26b7edf049755260, 0x2514c6324384a86d, 0x38e7ecccd1dcff67, 0x65f0b37d93ce0d3e, 0xd749d0dd22ac00aa, 0x0141b9ce4a688d4d };
+const uint64_t bn128_G2_jac_const_3B[8] = { 0x3baa927cb62e0d6a, 0xd71e7c52d1b664fd, 0x03873e63d95d4664, 0x0e75b5b1082ab8f4, 0xaab7c6667596fe35, 0x31d21a78bb6a27ba, 0x85dd7297680401ff, 0x03c52d6adf39a7e9 };
+
+//------------------------------------------------------------------------------
+
+// scale an Fp2 field element by A = (0,0)
+void bn128_G2_jac_scale_by_A(const uint64_t *src, uint64_t *tgt ) {
+  memset( tgt, 0, 64 );
+}
+
+void bn128_G2_jac_scale_by_A_inplace( uint64_t *tgt ) {
+  memset( tgt, 0, 64 );
+}
+// scale an Fp field element by B = (19485874751759354771024239261021720505790618469301721065564631296452457478373,266929791119991161246907387137283842545076965332900288569378510910307636690)
+void bn128_G2_jac_scale_by_B(const uint64_t *src, uint64_t *tgt ) {
+  bn128_Fp2_mont_mul( bn128_G2_jac_const_B, src, tgt );
+}
+
+void bn128_G2_jac_scale_by_B_inplace( uint64_t *tgt ) {
+  bn128_Fp2_mont_mul_inplace( tgt, bn128_G2_jac_const_B );
+}
+// scale an Fp field element by 3B = 3*(19485874751759354771024239261021720505790618469301721065564631296452457478373,266929791119991161246907387137283842545076965332900288569378510910307636690)
+void bn128_G2_jac_scale_by_3B(const uint64_t *src, uint64_t *tgt ) {
+  bn128_Fp2_mont_mul( bn128_G2_jac_const_3B, src, tgt );
+}
+
+void bn128_G2_jac_scale_by_3B_inplace( uint64_t *tgt ) {
+  bn128_Fp2_mont_mul_inplace( tgt, bn128_G2_jac_const_3B );
+}
+
+void bn128_G2_jac_normalize( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_Fp2_mont_is_zero( Z1 ) ) {
+    // Z == 0, it must be the point at infinity
+    memset( tgt, 0, 192 );
+    bn128_Fp2_mont_set_one( Y3 );
+  }
+  else {
+    if (bn128_Fp2_mont_is_one( Z1 )) {
+      // already normalized
+      if (tgt != src1) { memcpy( tgt, src1, 192 ); }
+    }
+    else {
+      uint64_t zinv [8];
+      uint64_t zinv2[8];
+      uint64_t zinv3[8];
+      bn128_Fp2_mont_inv( Z1, zinv );
+      bn128_Fp2_mont_sqr( zinv, zinv2 );
+      bn128_Fp2_mont_mul( zinv, zinv2, zinv3 );
+      bn128_Fp2_mont_mul( X1, zinv2, X3 );
+      bn128_Fp2_mont_mul( Y1, zinv3, Y3 );
+      bn128_Fp2_mont_set_one( Z3 );
+    }
+  }
+}
+
+void bn128_G2_jac_normalize_inplace( uint64_t *tgt ) {
+  bn128_G2_jac_normalize( tgt, tgt );
+}
+
+// checks whether the underlying representation (projective coordinates) are the same
+uint8_t bn128_G2_jac_is_same( const uint64_t *src1, const uint64_t *src2 ) {
+  return ( bn128_Fp2_mont_is_equal( X1, X2 ) &&
+           bn128_Fp2_mont_is_equal( Y1, Y2 ) &&
+           bn128_Fp2_mont_is_equal( Z1, Z2 ) );
+}
+
+// checks whether two curve points are equal
+uint8_t bn128_G2_jac_is_equal( const uint64_t *src1, const uint64_t *src2 ) {
+  uint64_t tmp1[24];
+  uint64_t tmp2[24];
+  bn128_G2_jac_normalize( src1, tmp1 );
+  bn128_G2_jac_normalize( src2, tmp2 );
+  return bn128_G2_jac_is_same( tmp1, tmp2 );
+}
+
+// converts from affine coordinates
+void bn128_G2_jac_from_affine( const uint64_t *src1 , uint64_t *tgt ) {
+  memcpy( tgt, src1, 128 );
+  if (bn128_G2_affine_is_infinity( src1 )) {
+    bn128_G2_jac_set_infinity( tgt );
+  }
+  else {
+    bn128_Fp2_mont_set_one( Z3 );
+  }
+}
+
+// converts to affine coordinates
+// remark: the point at infinity will result in the special string `0xffff...ffff`
+void bn128_G2_jac_to_affine( const uint64_t *src1 , uint64_t *tgt ) {
+  if (bn128_Fp2_mont_is_zero( Z1 )) {
+    // in the affine coordinate system, the point at infinity is represented by a hack
+    // consisting all 0xff bytes (note that that's an invalid value for prime fields)
+    memset( tgt, 0xff, 128 );
+  }
+  else {
+    uint64_t zinv [8];
+    uint64_t zinv2[8];
+    uint64_t zinv3[8];
+    bn128_Fp2_mont_inv( Z1, zinv );
+    bn128_Fp2_mont_mul( zinv, zinv , zinv2 );
+    bn128_Fp2_mont_mul( zinv, zinv2, zinv3 );
+    bn128_Fp2_mont_mul( X1, zinv2, X3 );
+    bn128_Fp2_mont_mul( Y1, zinv3, Y3 );
+  }
+}
+
+// converts N points from affine coordinates
+void bn128_G2_jac_batch_from_affine( int N, const uint64_t *src , uint64_t *tgt ) {
+  const uint64_t *p = src;
+  uint64_t *q = tgt;
+  for(int i=0; i<N; i++) {
+    bn128_G2_jac_from_affine(p,q);
+    p += 2*NLIMBS_P;
+    q += 3*NLIMBS_P;
+  }
+}
+
+// converts N points to affine coordinates, using a single field inversion for
+// all of them (Montgomery's batch inversion trick). Points at infinity are skipped
+// in the running product, and result in the special affine infinity.
+// Note: the output may overlap with the input, as long as `tgt <= src`
+void bn128_G2_jac_batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {
+  if (N <= 0) return;
+  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );
+  assert( zinvs != 0 );
+
+  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th
+  uint64_t acc[NLIMBS_P];
+  bn128_Fp2_mont_set_one( acc );
+  for(int i=0; i<N; i++) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    bn128_Fp2_mont_copy( acc , zinvs + i*NLIMBS_P );
+    if (!bn128_Fp2_mont_is_zero( z )) { bn128_Fp2_mont_mul_inplace( acc , z ); }
+  }
+
+  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]
+  bn128_Fp2_mont_inv_inplace( acc );
+  for(int i=N-1; i>=0; i--) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    if (!bn128_Fp2_mont_is_zero( z )) {
+      bn128_Fp2_mont_mul_inplace( zinvs + i*NLIMBS_P , acc );
+      bn128_Fp2_mont_mul_inplace( acc , z );
+    }
+  }
+
+  for(int i=0; i<N; i++) {
+    const uint64_t *p = src + 3*i*NLIMBS_P;
+    uint64_t       *q = tgt + 2*i*NLIMBS_P;
+    if (bn128_Fp2_mont_is_zero( p + 2*NLIMBS_P )) {
+      memset( q, 0xff, 128 );
+    }
+    else {
+      const uint64_t *zinv = zinvs + i*NLIMBS_P;
+      uint64_t zinv2[NLIMBS_P];
+      uint64_t zinv3[NLIMBS_P];
+      bn128_Fp2_mont_sqr( zinv , zinv2 );
+      bn128_Fp2_mont_mul( zinv , zinv2 , zinv3 );
+      bn128_Fp2_mont_mul( p            , zinv2 , q            );
+      bn128_Fp2_mont_mul( p + NLIMBS_P , zinv3 , q + NLIMBS_P );
+    }
+  }
+
+  free(zinvs);
+}
+
+// below this many points, the parallel version simply calls the sequential one
+#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024
+
+typedef struct {
+  int N;
+  int chunk;
+  const uint64_t *src;
+  uint64_t *tgt;
+} bn128_G2_jac_batch_to_affine_ctx_t;
+
+void bn128_G2_jac_batch_to_affine_task( void *ctx, int j ) {
+  bn128_G2_jac_batch_to_affine_ctx_t *c = (bn128_G2_jac_batch_to_affine_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  bn128_G2_jac_batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );
+}
+
+// converts N points to affine coordinates, splitting them into chunks which are
+// converted in parallel (each chunk with a single inversion). For small inputs,
+// or with a single thread, this is the same as `batch_to_affine`.
+// Note: unlike `batch_to_affine`, the output must not overlap with the input
+void bn128_G2_jac_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {
+  int T = parallel_get_num_threads();
+  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {
+    bn128_G2_jac_batch_to_affine( N, src, tgt );
+    return;
+  }
+  int chunk = (N + T - 1) / T;
+  int m     = (N + chunk - 1) / chunk;
+  bn128_G2_jac_batch_to_affine_ctx_t ctx;
+  ctx.N     = N;
+  ctx.chunk = chunk;
+  ctx.src   = src;
+  ctx.tgt   = tgt;
+  parallel_for( m, bn128_G2_jac_batch_to_affine_task, &ctx );
+}
+
+void bn128_G2_jac_copy( const uint64_t *src1 , uint64_t *tgt ) {
+  if (tgt != src1) { memcpy( tgt, src1, 192 ); }
+}
+
+uint8_t bn128_G2_jac_is_infinity ( const uint64_t *src1 ) {
+  if ( ( bn128_Fp2_mont_is_zero( Z1 )) &&
+       (!bn128_Fp2_mont_is_zero( X1 )) &&
+       (!bn128_Fp2_mont_is_zero( Y1 )) ) {
+    // for Z=0 we have the equation Y^2 = X^3
+    uint64_t XX [8];
+    uint64_t XXX[8];
+    uint64_t YY [8];
+    bn128_Fp2_mont_sqr(X1, XX);
+    bn128_Fp2_mont_mul(X1, XX, XXX);
+    bn128_Fp2_mont_sqr(Y1, YY);
+    return bn128_Fp2_mont_is_equal( YY, XXX );
+  }
+  else {
+    return 0;
+  }
+}
+
+// note: In Jacobian coordinates, the point at infinity is [1:1:0]
+void bn128_G2_jac_set_infinity ( uint64_t *tgt ) {
+  bn128_Fp2_mont_set_one ( X3 );
+  bn128_Fp2_mont_set_one ( Y3 );
+  bn128_Fp2_mont_set_zero( Z3 );
+}
+
+// checks the curve equation
+//   y^2 == x^3 + A*x*z^4 + B*z^6
+uint8_t bn128_G2_jac_is_on_curve ( const uint64_t *src1 ) {
+  uint64_t ZZ2[8];
+  uint64_t ZZ4[8];
+  uint64_t acc[8];
+  uint64_t tmp[8];
+  bn128_Fp2_mont_sqr( Y1, acc );             // Y^2
+  bn128_Fp2_mont_neg_inplace( acc );         // -Y^2
+  bn128_Fp2_mont_sqr( X1, tmp );             // X^2
+  bn128_Fp2_mont_mul_inplace( tmp, X1 );     // X^3
+  bn128_Fp2_mont_add_inplace( acc, tmp );    // - Y^2 + X^3
+  bn128_Fp2_mont_sqr( Z1 , ZZ2 );            // Z^2
+  bn128_Fp2_mont_sqr( ZZ2, ZZ4 );            // Z^4
+  bn128_Fp2_mont_mul( ZZ2, ZZ4, tmp );        // Z^6
+  bn128_G2_jac_scale_by_B_inplace( tmp );   // B*Z^6
+  bn128_Fp2_mont_add_inplace( acc, tmp );     // - Y^2 + X^3 + A*X*Z^4 + B*Z^6
+  return (bn128_Fp2_mont_is_zero( acc ) &&
+           ( (!bn128_Fp2_mont_is_zero( Z1 )) || 
+             (!bn128_Fp2_mont_is_zero( Y1 )) ) );
+}
+
+// checks whether the given point is in the subgroup G2
+uint8_t bn128_G2_jac_is_in_subgroup ( const uint64_t *src1 ) {
+  uint64_t tmp[24];
+  if (!bn128_G2_jac_is_on_curve(src1)) {
+    return 0;
+  }
+  else {
+    bn128_G2_jac_scl_generic( bn128_G2_jac_subgroup_order , src1 , tmp , NLIMBS_R );
+    return bn128_G2_jac_is_infinity( tmp );
+  }
+}
+
+// negates an elliptic curve point
+void bn128_G2_jac_neg( const uint64_t *src, uint64_t *tgt ) {
+  if (tgt != src) { memcpy( tgt, src, 192 ); }
+  bn128_Fp2_mont_neg_inplace( Y3 );
+}
+
+// negates an elliptic curve point
+void bn128_G2_jac_neg_inplace( uint64_t *tgt ) {
+  bn128_Fp2_mont_neg_inplace( Y3 );
+}
+
+// doubles an elliptic curve point, assuming A = 0
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-0.html#doubling-dbl-2009-l>
+void bn128_G2_jac_dbl( const uint64_t *src1, uint64_t *tgt ) {
+  uint64_t A[8];
+  uint64_t B[8];
+  uint64_t C[8];
+  uint64_t D[8];
+  uint64_t E[8];
+  bn128_Fp2_mont_sqr( X1, A );               // A  = X1^2
+  bn128_Fp2_mont_sqr( Y1, B );               // B  = Y1^2
+  bn128_Fp2_mont_sqr( B , C );               // C  = B^2
+  bn128_Fp2_mont_add( X1, B, D );            // D  = X1+B
+  bn128_Fp2_mont_sqr_inplace( D );           // D  = (X1+B)^2
+  bn128_Fp2_mont_sub_inplace( D, A );        // D  = (X1+B)^2 - A
+  bn128_Fp2_mont_sub_inplace( D, C );        // D  = (X1+B)^2 - A - C
+  bn128_Fp2_mont_add_inplace( D, D );        // D  = 2*((X1+B)^2 - A - C)
+  bn128_Fp2_mont_add( A, A, E );             // E  = 2*A
+  bn128_Fp2_mont_add_inplace( E, A );        // E  = 3*A
+  bn128_Fp2_mont_mul( Y1, Z1, Z3 );          // Z3 = Y1*Z1
+  bn128_Fp2_mont_add_inplace( Z3, Z3 );      // Z3 = 2*Y1*Z1
+  bn128_Fp2_mont_sqr( E, X3 );               // X3 = F = E^2
+  bn128_Fp2_mont_sub_inplace( X3, D );       // X3 = F - D
+  bn128_Fp2_mont_sub_inplace( X3, D );       // X3 = F - 2*D
+  bn128_Fp2_mont_sub( D, X3, Y3 );           // Y3 = D - X3
+  bn128_Fp2_mont_mul_inplace( Y3, E );       // Y3 = E*(D - X3)
+  bn128_Fp2_mont_add_inplace( C, C );        // 2*C
+  bn128_Fp2_mont_add_inplace( C, C );        // 4*C
+  bn128_Fp2_mont_add_inplace( C, C );        // 8*C
+  bn128_Fp2_mont_sub_inplace( Y3, C );       // Y3 = E*(D - X3) - 8*C
+}
+
+// doubles an elliptic curve point
+void bn128_G2_jac_dbl_inplace( uint64_t *tgt ) {
+  bn128_G2_jac_dbl( tgt , tgt );
+}
+
+// adds two elliptic curve points
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html#addition-add-2007-bl>
+void bn128_G2_jac_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bn128_G2_jac_is_infinity(src1)) {
+    if (tgt != src2) { memcpy( tgt, src2, 192); }
+    return;
+  }
+  if (bn128_G2_jac_is_infinity(src2)) {
+    if (tgt != src1) { memcpy( tgt, src1, 192); }
+    return;
+  }
+  uint64_t Z1Z1[8];
+  uint64_t Z2Z2[8];
+  uint64_t U1[8];
+  uint64_t U2[8];
+  uint64_t S1[8];
+  uint64_t S2[8];
+  uint64_t  H[8];
+  uint64_t  I[8];
+  uint64_t  J[8];
+  uint64_t  r[8];
+  uint64_t  V[8];
+  bn128_Fp2_mont_sqr( Z1, Z1Z1 );           // Z1Z1 = Z1^2
+  bn128_Fp2_mont_sqr( Z2, Z2Z2 );           // Z2Z2 = Z2^2
+  bn128_Fp2_mont_mul( X1, Z2Z2 , U1 );      // U1 = X1*Z2Z2
+  bn128_Fp2_mont_mul( X2, Z1Z1 , U2 );      // U2 = X2*Z1Z1
+  bn128_Fp2_mont_mul( Y1, Z2 , S1 );        //    = Y1 * Z2
+  bn128_Fp2_mont_mul_inplace(  S1, Z2Z2 );  // S1 = Y1 * Z2 * Z2Z2
+  bn128_Fp2_mont_mul( Y2, Z1 , S2 );        //    = Y2 * Z1
+  bn128_Fp2_mont_mul_inplace(  S2, Z1Z1 );  // S2 = Y2 * Z1 * Z1Z1
+  bn128_Fp2_mont_sub( U2, U1, H );          // H  = U2-U1
+  if (bn128_Fp2_mont_is_zero( H )) {
+    // X1/Z1^2 == X2/Z2^2
+    // so either Y1/Z1^3 == Y2/Z2^3, in which case it's a doubling
+    // or not, in which case Y1/Z1^3 == - Y2/Z2^3 and the result is infinity
+    if (bn128_Fp2_mont_is_equal( S1, S2)) {
+      // Y1/Z1^3 == Y2/Z2^3
+      bn128_G2_jac_dbl( src1, tgt );
+      return;
+    }
+    else {
+      // Y1/Z1^3 != Y2/Z2^3
+      bn128_G2_jac_set_infinity( tgt );
+      return;
+    }
+  }
+  bn128_Fp2_mont_add( H, H, I );            //    = 2*H
+  bn128_Fp2_mont_sqr_inplace( I );          // I  = (2*H)^2
+  bn128_Fp2_mont_mul( H, I, J );            // J  = H*I
+  bn128_Fp2_mont_sub( S2, S1, r );          //    = S2-S1
+  bn128_Fp2_mont_add_inplace( r, r );       // r  = 2*(S2-S1)
+  bn128_Fp2_mont_mul( U1, I, V );           // V  = U1*I
+  bn128_Fp2_mont_sqr( r, X3 );              //    = r^2
+  bn128_Fp2_mont_sub_inplace( X3, J );      //    = r^2 - J
+  bn128_Fp2_mont_sub_inplace( X3, V );      //    = r^2 - J - V
+  bn128_Fp2_mont_sub_inplace( X3, V );      // X3 = r^2 - J - 2*V
+  bn128_Fp2_mont_sub( V, X3, Y3 );          //    = V-X3
+  bn128_Fp2_mont_mul_inplace( Y3, r );      //    = r*(V-X3)
+  bn128_Fp2_mont_mul_inplace( J, S1 );      // J := S1*J
+  bn128_Fp2_mont_sub_inplace( Y3, J );      //    = r*(V-X3) - S1*J
+  bn128_Fp2_mont_sub_inplace( Y3, J );      // Y3 = r*(V-X3) - 2*S1*J
+  bn128_Fp2_mont_add( Z1, Z2, Z3 );         //    = Z1+Z2
+  bn128_Fp2_mont_sqr_inplace( Z3 );         //    = (Z1+Z2)^2
+  bn128_Fp2_mont_sub_inplace( Z3, Z1Z1 );   //    = (Z1+Z2)^2-Z1Z1
+  bn128_Fp2_mont_sub_inplace( Z3, Z2Z2 );   //    = (Z1+Z2)^2-Z1Z1-Z2Z2
+  bn128_Fp2_mont_mul_inplace( Z3, H );      // Z3 = ((Z1+Z2)^2-Z1Z1-Z2Z2)*H
+}
+
+void bn128_G2_jac_add_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bn128_G2_jac_add( tgt, src2, tgt);
+}
+
+void bn128_G2_jac_sub( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint64_t tmp[24];
+  bn128_G2_jac_neg( src2, tmp );
+  bn128_G2_jac_add( src1, tmp, tgt );
+}
+
+void bn128_G2_jac_sub_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  uint64_t tmp[24];
+  bn128_G2_jac_neg( src2, tmp );
+  bn128_G2_jac_add( tgt , tmp, tgt );
+}
+
+// adds a Jacobian projective point (src1) to an affine point (src2)
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html#addition-madd-2007-bl>
+void bn128_G2_jac_madd_jac_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bn128_G2_jac_is_infinity( src1 )) {
+    // the formula is not valid for this case
+    bn128_G2_jac_from_affine( src2 , tgt );
+    return;
+  }
+  if (bn128_G2_affine_is_infinity( src2 )) {
+    bn128_G2_jac_copy( src1 , tgt );
+    return;
+  }
+  uint64_t Z1Z1[8];
+  uint64_t U2[8];
+  uint64_t S2[8];
+  uint64_t  H[8];
+  uint64_t HH[8];
+  uint64_t  I[8];
+  uint64_t  J[8];
+  uint64_t  r[8];
+  uint64_t  V[8];
+  bn128_Fp2_mont_sqr( Z1, Z1Z1 );           // Z1Z1 = Z1^2
+  bn128_Fp2_mont_mul( X2, Z1Z1 , U2 );      // U2 = X2*Z1Z1
+  bn128_Fp2_mont_mul( Y2, Z1 , S2 );        //    = Y2 * Z1
+  bn128_Fp2_mont_mul_inplace( S2, Z1Z1 );   // S2 = Y2 * Z1 * Z1Z1
+  bn128_Fp2_mont_sub( U2, X1, H );          // H  = U2-X1
+  bn128_Fp2_mont_sqr( H, HH );              // HH = H^2
+  bn128_Fp2_mont_add( HH, HH, I );          //    = 2*HH
+  bn128_Fp2_mont_add_inplace( I, I );       // I  = 4*HH
+  bn128_Fp2_mont_mul( H, I, J );            // J  = H*I
+  bn128_Fp2_mont_sub( S2, Y1, r );          //    = S2-Y1
+  if (bn128_Fp2_mont_is_zero(H)) {
+    // H=0  <==>  X1/Z1^2 = X2
+    // either a doubling or the result is infinity
+    if (bn128_Fp2_mont_is_zero(r)) {
+      // r=0  <==>  Y1/Z1^2 = Y2
+      // it's a doubling
+      bn128_G2_jac_dbl( src1, tgt );
+      return;
+    }
+    else {
+      // X1/Z1^2 = X2 but Y1/Z1^2 /= Y2
+      // so the result must be infinity
+      bn128_G2_jac_set_infinity( tgt );
+      return;
+    }
+  }
+  bn128_Fp2_mont_add_inplace( r, r );       // r  = 2*(S2-Y1)
+  bn128_Fp2_mont_mul( X1, I, V );           // V  = X1*I
+  bn128_Fp2_mont_sqr( r, X3 );              //    = r^2
+  bn128_Fp2_mont_sub_inplace( X3, J );      //    = r^2 - J
+  bn128_Fp2_mont_sub_inplace( X3, V );      //    = r^2 - J - V
+  bn128_Fp2_mont_sub_inplace( X3, V );      // X3 = r^2 - J - 2*V
+  bn128_Fp2_mont_mul_inplace( J, Y1 );      // J := Y1*J - careful, in the next row we possibly overwrite Y1!
+  bn128_Fp2_mont_sub( V, X3, Y3 );          //    = V-X3
+  bn128_Fp2_mont_mul_inplace( Y3, r );      // Y3 = r*(V-X3)
+  bn128_Fp2_mont_sub_inplace( Y3, J );      //    = r*(V-X3) - Y1*J
+  bn128_Fp2_mont_sub_inplace( Y3, J );      // Y3 = r*(V-X3) - 2*Y1*J
+  bn128_Fp2_mont_add( Z1, H , Z3 );         //    = Z1+H
+  bn128_Fp2_mont_sqr_inplace( Z3 );         //    = (Z1+H)^2
+  bn128_Fp2_mont_sub_inplace( Z3, Z1Z1 );   //    = (Z1+H)^2-Z1Z1
+  bn128_Fp2_mont_sub_inplace( Z3, HH );     // Z3 = (Z1+H)^2-Z1Z1-HH
+}
+
+// adds an affine point (src1) to a projective one (src2)
+// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#addition-add-2015-rcb
+void bn128_G2_jac_madd_aff_jac( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  bn128_G2_jac_madd_jac_aff( src2, src1, tgt );
+}
+
+// adds to a projective point (tgt) an affine point (src2), in place
+void bn128_G2_jac_madd_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bn128_G2_jac_madd_jac_aff( tgt, src2, tgt );
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G2, and `expo` is a (non-negative) bigint
+// naive algorithm
+void bn128_G2_jac_scl_naive(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {
+
+  uint64_t dbl[3*NLIMBS_P];
+  bn128_G2_jac_copy( grp, dbl );              // dbl := grp
+  bn128_G2_jac_set_infinity( tgt );           // tgt := infinity
+
+  int s = expo_len - 1;
+  while( (s>0) && (expo[s] == 0) ) { s--; }      // skip the unneeded largest powers
+
+  for(int i=0; i<=s; i++) {
+    uint64_t e = expo[i];
+    for(int j=0; j<64; j++) {
+      if (e & 1) { 
+        bn128_G2_jac_add( tgt, dbl, tgt ); 
+      }
+      bn128_G2_jac_dbl( dbl, dbl );
+      e = e >> 1;
+    }
+  }
+}
+
+#define TBL(k) (table + (k-1)*3*NLIMBS_P)
+
+// precalculate [ k*g | k <- [1..15] ]
+void bn128_G2_jac_precalc_expos_window_16( const uint64_t *grp, uint64_t *table ) {
+  bn128_G2_jac_copy( grp              , TBL( 1) );           //  1*g
+  bn128_G2_jac_dbl ( TBL(1)           , TBL( 2) );           //  2*g
+  bn128_G2_jac_dbl ( TBL(2)           , TBL( 4) );           //  4*g
+  bn128_G2_jac_dbl ( TBL(4)           , TBL( 8) );           //  8*g
+  bn128_G2_jac_add ( TBL(1) , TBL( 2) , TBL( 3) );           //  3*g
+  bn128_G2_jac_dbl ( TBL(3) ,           TBL( 6) );           //  6*g
+  bn128_G2_jac_dbl ( TBL(6) ,           TBL(12) );           // 12*g
+  bn128_G2_jac_add ( TBL(1) , TBL( 4) , TBL( 5) );           //  5*g
+  bn128_G2_jac_dbl ( TBL(5) ,           TBL(10) );           // 10*g
+  bn128_G2_jac_add ( TBL(1) , TBL( 6) , TBL( 7) );           //  7*g
+  bn128_G2_jac_dbl ( TBL(7) ,           TBL(14) );           // 14*g
+  bn128_G2_jac_add ( TBL(1) , TBL( 8) , TBL( 9) );           //  9*g
+  bn128_G2_jac_add ( TBL(1) , TBL(10) , TBL(11) );           // 11*g
+  bn128_G2_jac_add ( TBL(1) , TBL(12) , TBL(13) );           // 13*g
+  bn128_G2_jac_add ( TBL(1) , TBL(14) , TBL(15) );           // 15*g
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G2, and `expo` is a (non-negative) bigint
+// generic windowed algo, 4-bit windows
+void bn128_G2_jac_scl_windowed(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {
+
+  // precalculate [ k*g | k <- [1..15] ]
+  uint64_t table[15*3*NLIMBS_P];
+  bn128_G2_jac_precalc_expos_window_16( grp, table );
+
+  bn128_G2_jac_set_infinity( tgt );           // tgt := infinity
+
+  int s = expo_len - 1;
+  while( (s>0) && (expo[s] == 0) ) { s--; }      // skip the unneeded largest powers
+
+  for(int i=s; i>=0; i--) {
+    uint64_t e = expo[i];
+    for(int j=0; j<16; j++) {
+      // we can skip doubling when infinity
+      if (!bn128_Fp2_mont_is_zero(tgt+2*NLIMBS_P)) {
+        bn128_G2_jac_dbl_inplace( tgt );
+        bn128_G2_jac_dbl_inplace( tgt );
+        bn128_G2_jac_dbl_inplace( tgt );
+        bn128_G2_jac_dbl_inplace( tgt );
+      }
+      int k = (e >> 60);
+      if (k) { 
+        bn128_G2_jac_add_inplace( tgt, TBL(k) ); 
+      }
+      e = e << 4;
+    }
+  }
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G, and `expo` is in Fr
+void bn128_G2_jac_scl_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int nlimbs) {
+  bn128_G2_jac_scl_windowed(expo, grp, tgt, nlimbs);
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G, and `expo` is in Fr *in standard repr*
+void bn128_G2_jac_scl_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  bn128_G2_jac_scl_generic(expo, grp, tgt, NLIMBS_R);
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G, and `expo` is in Fr *in Montgomery repr*
+void bn128_G2_jac_scl_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bn128_Fr_mont_to_std(expo, expo_std);
+  bn128_G2_jac_scl_generic(expo_std, grp, tgt, NLIMBS_R);
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G, and `expo` is the same size as Fp
+void bn128_G2_jac_scl_big(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  bn128_G2_jac_scl_generic(expo, grp, tgt, NLIMBS_P);
+}
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G, and `expo` is a 64 bit (unsigned!) word
+void bn128_G2_jac_scl_small(uint64_t expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_vec[1];
+  expo_vec[0] = expo;
+  bn128_G2_jac_scl_generic(expo_vec, grp, tgt, 1);
+}
+
+//------------------------------------------------------------------------------
+
+// the bucket sums are in XYZZ coordinates
+#define SIDX(b) (SUMS + (b-1)*(4*NLIMBS_P))
+
+// Multi-Scalar Multiplication (MSM)
+// standard coefficients (NOT montgomery!)
+// straightforward Pippenger bucketing method
+// parametric bucket size
+// the buckets are accumulated in XYZZ coordinates (cheap mixed additions), and
+// only the window sums are converted back to jac coordinates
+void bn128_G2_jac_MSM_std_coeff_jac_out_variable(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs, int window_size) {
+
+  assert( (window_size > 0) && (window_size <= 64) );
+
+  int nwindows = (64*expo_nlimbs + window_size - 1) / window_size;
+  int nbuckets = (1 << window_size);
+
+  bn128_G2_jac_set_infinity(tgt);
+
+  // allocate memory for bucket sums
+  uint64_t *SUMS = malloc( 4*8*NLIMBS_P * (nbuckets-1) );
+  assert( SUMS !=0 );
+
+  // loop over the windows
+  for(int K=nwindows-1; K >= 0; K-- ) {
+
+    // K-th window
+    int A = K*window_size;
+    int B = A + window_size;
+    if (B > 64*expo_nlimbs ) { B = 64*expo_nlimbs; }
+
+    uint64_t mask = (1<<(B-A)) - 1;
+
+    int Adiv = (A >> 6);    // A / 64
+    int Amod = (A & 0x3f);  // A mod 64
+
+    int Bdiv = Adiv;
+    int Bshl = 0;
+    if (((B-1)>>6) != Adiv) { 
+      // the window intersects qword boundary...
+      Bdiv = Adiv + 1; 
+      Bshl = 64*Bdiv - A; 
+    }
+
+    // we could do this in constant memory, but then would have 
+    // to we go over the points way many (=bucket_size) times...
+
+    // initalize bucket sums
+    for( int b=nbuckets-1; b>0; b-- ) { 
+      bn128_G2_xyzz_set_infinity( SIDX(b) );
+    }
+
+    // compute bucket sums
+    for(int j=0; j<npoints; j++) {
+
+      int ofs = expo_nlimbs*j + Adiv;
+      uint64_t e = (expos[ofs] >> Amod);
+      if (Bdiv != Adiv) {
+        e |= (expos[ofs+1] << Bshl);
+      }
+      e &= mask;   // bucket coeff
+
+      if (e>0) {
+        bn128_G2_xyzz_madd_xyzz_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
+      }
+    }
+
+    // compute running sums
+
+    uint64_t T[4*NLIMBS_P];   // cumulative sum of S-es
+    uint64_t R[4*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t W[3*NLIMBS_P];   // the window sum, converted back
+
+    bn128_G2_xyzz_set_infinity(T);
+    bn128_G2_xyzz_set_infinity(R);
+
+    for( int b=nbuckets-1; b>0; b-- ) { 
+      bn128_G2_xyzz_add_inplace( T , SIDX(b) );
+      bn128_G2_xyzz_add_inplace( R , T       );
+    }
+    bn128_G2_xyzz_to_jac( R , W );
+
+    if (!bn128_G2_jac_is_infinity(tgt)) {    // we can skip doubling when infinity
+      for(int i=0; i<window_size; i++) {
+        bn128_G2_jac_dbl_inplace(tgt);
+      }
+    }
+
+    bn128_G2_jac_add_inplace( tgt, W );
+  }
+
+  free(SUMS);
+}
+
+//------------------------------------------------------------------------------
+
+// Multi-Scalar Multiplication (MSM)
+// inputs: 
+//  - standard coefficients (1 field element per point)
+//  - affine Montgomery points (2 field elements per point)
+// output:
+//  - weighted projective Montgomery point
+void bn128_G2_jac_MSM_std_coeff_jac_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs) {
+
+  // guess optimal window size
+  int c = round( log2(npoints) - 3.5 );
+  if (c < 1 ) { c = 1;  }
+  if (c > 64) { c = 64; }
+
+  bn128_G2_jac_MSM_std_coeff_jac_out_variable(npoints, expos, grps, tgt, expo_nlimbs, c);  
+}
+
+//------------------------------------------------------------------------------
+
+// reference (slow) implementation of MSM
+// for testing purposes
+void bn128_G2_jac_MSM_std_coeff_jac_out_slow_reference(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs) {
+  uint64_t grp[3*NLIMBS_P];
+  uint64_t tmp[3*NLIMBS_P];
+  bn128_G2_jac_set_infinity( tgt );
+  for(int i=0; i<npoints; i++) { 
+    bn128_G2_jac_from_affine( grps  + i*2*NLIMBS_P , grp );                      // convert to proj coords
+    bn128_G2_jac_scl_generic( expos + i*expo_nlimbs , grp , tmp , expo_nlimbs );     // exponentiate
+    bn128_G2_jac_add_inplace( tgt , tmp );                                     // add to the running sum
+  }
+}
+
+//------------------------------------------------------------------------------
+
+// Multi-Scalar Multiplication (MSM)
+// inputs: 
+//  - Montgomery coefficients (1 field element per point)
+//  - affine Montgomery points (2 field elements per point)
+// output:
+//  - weighted projective Montgomery point
+void bn128_G2_jac_MSM_mont_coeff_jac_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs) {
+  uint64_t *std_expos = malloc(8*expo_nlimbs*npoints);
+  assert( std_expos != 0);
+  const uint64_t *p;
+  uint64_t *q;
+  p = expos;
+  q = std_expos;
+  for(int i=0; i<npoints; i++) {
+    bn128_Fr_mont_to_std( p , q );
+    p += expo_nlimbs;
+    q += expo_nlimbs;
+  }
+  bn128_G2_jac_MSM_std_coeff_jac_out(npoints, std_expos, grps, tgt, expo_nlimbs);
+  free(std_expos);
+}
+
+//------------------------------------------------------------------------------
+
+// Multi-Scalar Multiplication (MSM)
+// inputs: 
+//  - standard coefficients (1 field element per point)
+//  - affine Montgomery points (2 field elements per point)
+// output:
+//  - affine Montgomery point
+void bn128_G2_jac_MSM_std_coeff_affine_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs) {
+  uint64_t tmp[3*NLIMBS_P];
+  bn128_G2_jac_MSM_std_coeff_jac_out(npoints, expos, grps, tmp, expo_nlimbs);
+  bn128_G2_jac_to_affine(tmp, tgt);
+}
+
+// Multi-Scalar Multiplication (MSM)
+// inputs: 
+//  - Montgomery coefficients (1 field element per point)
+//  - affine Montgomery points (2 field elements per point)
+// output:
+//  - affine Montgomery point
+void bn128_G2_jac_MSM_mont_coeff_affine_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs) {
+  uint64_t tmp[3*NLIMBS_P];
+  bn128_G2_jac_MSM_mont_coeff_jac_out(npoints, expos, grps, tmp, expo_nlimbs);
+  bn128_G2_jac_to_affine(tmp, tgt);
+}
+
+//------------------------------------------------------------------------------
+
+
+// inverse of 2 (Montgomery repr)
+const uint64_t bn128_G2_jac_oneHalf[4] = { 0x783c14d81ffffffe, 0xaf982f6f0c8d1edd, 0x8f5f7492fcfd4f45, 0x1f37631a3d9cbfac };
+
+#define GRP_NLIMBS (3*NLIMBS_P)
+
+// -----------------------------------------------------------------------------
+// FFT of group elements
+//
+// Iterative radix-2 decimation-in-time FFT, computed in place after a bit-reversal
+// permutation. The twiddle factors are precomputed once (in standard repr, as the
+// scalar multiplication needs that); the butterflies of each layer are independent,
+// so they are distributed among the worker threads.
+
+// below this many butterflies per layer, we don't bother with multithreading
+#define FFT_PARALLEL_THRESHOLD 64
+
+// computes the twiddle factors `[ gen^j | j <- [0..N/2-1] ]` (in standard repr), `m >= 1`
+void bn128_G2_jac_fft_twiddles( int m, const uint64_t *gen, uint64_t *twiddles ) {
+  int halfN = (1<<(m-1));
+  uint64_t acc[NLIMBS_R];
+  bn128_Fr_mont_set_one( acc );
+  for(int j=0; j<halfN; j++) {
+    bn128_Fr_mont_to_std( acc , twiddles + j*NLIMBS_R );
+    bn128_Fr_mont_mul_inplace( acc , gen );
+  }
+}
+
+// reverses the lowest `m` bits of `i`
+int bn128_G2_jac_fft_bit_reverse( int m, int i ) {
+  int j = 0;
+  for(int k=0; k<m; k++) {
+    j = (j << 1) | (i & 1);
+    i = i >> 1;
+  }
+  return j;
+}
+
+// copies `src` into `tgt` in bit-reversed order (`src == tgt` is allowed)
+void bn128_G2_jac_fft_bit_reverse_permute( int m, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  if (src == tgt) {
+    uint64_t tmp[GRP_NLIMBS];
+    for(int i=0; i<N; i++) {
+      int j = bn128_G2_jac_fft_bit_reverse( m, i );
+      if (i < j) {
+        bn128_G2_jac_copy( tgt + i*GRP_NLIMBS , tmp );
+        bn128_G2_jac_copy( tgt + j*GRP_NLIMBS , tgt + i*GRP_NLIMBS );
+        bn128_G2_jac_copy( tmp                , tgt + j*GRP_NLIMBS );
+      }
+    }
+  }
+  else {
+    for(int i=0; i<N; i++) {
+      bn128_G2_jac_copy( src + i*GRP_NLIMBS , tgt + bn128_G2_jac_fft_bit_reverse( m, i )*GRP_NLIMBS );
+    }
+  }
+}
+
+typedef struct {
+  int m;                      // log2 of the size
+  int half;                   // half the block size of the current layer
+  int chunk;                  // number of butterflies per task
+  const uint64_t *twiddles;
+  uint64_t *buf;
+} bn128_G2_jac_fft_layer_ctx_t;
+
+// the butterflies `(u,v) -> (u + w*v, u - w*v)` with indices in `[ j*chunk , (j+1)*chunk )`
+// of a layer of the FFT. The blocks of this layer have size `2*half`, and the twiddle
+// factor for the `k`-th butterfly in a block is `w = gen^(k*N/(2*half))`
+void bn128_G2_jac_fft_layer_task( void *ctx, int j ) {
+  bn128_G2_jac_fft_layer_ctx_t *c = (bn128_G2_jac_fft_layer_ctx_t*) ctx;
+  int half   = c->half;
+  int halfN  = (1<<(c->m-1));
+  int stride = halfN / half;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > halfN) { b = halfN; }
+  uint64_t tmp[GRP_NLIMBS];
+  for(int t=a; t<b; t++) {
+    int k = t & (half-1);
+    uint64_t *u = c->buf + (2*(t-k) + k)*GRP_NLIMBS;
+    uint64_t *v = u + half*GRP_NLIMBS;
+    if (k == 0) {
+      bn128_G2_jac_copy( v , tmp );
+    }
+    else {
+      bn128_G2_jac_scl_Fr_std( c->twiddles + (k*stride)*NLIMBS_R , v , tmp );       // w*v
+    }
+    bn128_G2_jac_sub( u , tmp , v );                                          // u - w*v
+    bn128_G2_jac_add_inplace( u , tmp );                                      // u + w*v
+  }
+}
+
+// in-place FFT of `N = 2^m` group elements, given in bit-reversed order
+void bn128_G2_jac_fft_inplace_noalloc( int m, const uint64_t *twiddles, uint64_t *buf ) {
+  if (m == 0) return;
+  int halfN = (1<<(m-1));
+  int T = parallel_get_num_threads();
+  bn128_G2_jac_fft_layer_ctx_t ctx;
+  ctx.m        = m;
+  ctx.twiddles = twiddles;
+  ctx.buf      = buf;
+  for(int half=1; half<=halfN; half<<=1) {
+    ctx.half = half;
+    if ( (halfN < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = halfN;
+      bn128_G2_jac_fft_layer_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (halfN + T - 1) / T;
+      parallel_for( (halfN + ctx.chunk - 1) / ctx.chunk , bn128_G2_jac_fft_layer_task, &ctx );
+    }
+  }
+}
+
+typedef struct {
+  int chunk;
+  int N;
+  const uint64_t *scalar;
+  uint64_t *buf;
+} bn128_G2_jac_fft_scale_ctx_t;
+
+void bn128_G2_jac_fft_scale_task( void *ctx, int j ) {
+  bn128_G2_jac_fft_scale_ctx_t *c = (bn128_G2_jac_fft_scale_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  for(int i=a; i<b; i++) {
+    bn128_G2_jac_scl_Fr_std( c->scalar , c->buf + i*GRP_NLIMBS , c->buf + i*GRP_NLIMBS );
+  }
+}
+
+// normalizes `N` points using a single inversion: first we convert them to affine
+// coordinates (which are then packed at the beginning of the buffer), then back
+void bn128_G2_jac_fft_normalize( int N, uint64_t *buf ) {
+  bn128_G2_jac_batch_to_affine( N, buf, buf );
+  for(int i=N-1; i>=0; i--) {
+    uint64_t tmp[2*NLIMBS_P];
+    memcpy( tmp, buf + i*2*NLIMBS_P, 8*2*NLIMBS_P );
+    bn128_G2_jac_from_affine( tmp, buf + i*GRP_NLIMBS );
+  }
+}
+
+// forward FFT of group elements (convert from [L_k(tau)] to [tau^i])
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
+// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)
+// NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
+void bn128_G2_jac_fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
+  int N = (1<<m);
+  bn128_G2_jac_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bn128_G2_jac_fft_twiddles( m, gen, twiddles );
+    bn128_G2_jac_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
+  }
+  bn128_G2_jac_fft_normalize( N, tgt );
+}
+
+// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
+// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
+// This is the forward FFT with `gen^-1`, followed by scaling with `1/N`
+// NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
+void bn128_G2_jac_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
+  int N = (1<<m);
+  bn128_G2_jac_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t ginv[NLIMBS_R];
+    bn128_Fr_mont_inv( gen , ginv );
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bn128_G2_jac_fft_twiddles( m, ginv, twiddles );
+    bn128_G2_jac_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
+
+    // 1/N = (1/2)^m
+    uint64_t ninv_mont[NLIMBS_R];
+    uint64_t ninv[NLIMBS_R];
+    bn128_Fr_mont_pow_uint64( bn128_G2_jac_oneHalf , m , ninv_mont );
+    bn128_Fr_mont_to_std( ninv_mont , ninv );
+
+    bn128_G2_jac_fft_scale_ctx_t ctx;
+    ctx.N      = N;
+    ctx.scalar = ninv;
+    ctx.buf    = tgt;
+    int T = parallel_get_num_threads();
+    if ( (N < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = N;
+      bn128_G2_jac_fft_scale_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (N + T - 1) / T;
+      parallel_for( (N + ctx.chunk - 1) / ctx.chunk , bn128_G2_jac_fft_scale_task, &ctx );
+    }
+  }
+  bn128_G2_jac_fft_normalize( N, tgt );
+}
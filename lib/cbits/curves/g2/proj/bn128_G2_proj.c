@@ -11,8 +11,14 @@
 
 #include "bn128_G2_proj.h"
 #include "bn128_G2_affine.h"
+#include "bn128_G2_xyzz.h"
 #include "bn128_Fp2_mont.h"
 #include "bn128_Fr_mont.h"
+#include "bn128_arr_mont.h"
+#include "bigint256.h"
+#include "parallel.h"
+#include "sha256.h"
+#include "bn128_Fp_mont.h"
 
 #define NLIMBS_P 8
 #define NLIMBS_R 4
@@ -35,6 +41,9 @@ const uint64_t bn128_G2_proj_gen_G2[24] = { 0xaf2f35351efbe5db, 0x66a2e3e98253e7
 // the cofactor of the curve subgroup = 21888242871839275222246405745257275088844257914179612981679871602714643921549
 const uint64_t bn128_G2_proj_cofactor[8] = { 0x345f2299c0f9fa8d, 0x06ceecda572a2489, 0xb85045b68181585e, 0x30644e72e131a029, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
+// the order of the subgroup = 21888242871839275222246405745257275088548364400416034343698204186575808495617
+const uint64_t bn128_G2_proj_subgroup_order[4] = { 0x43e1f593f0000001, 0x2833e84879b97091, 0xb85045b68181585d, 0x30644e72e131a029 };
+
 // the constants A and B of the equation
 const uint64_t bn128_G2_proj_const_A[8] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bn128_G2_proj_const_B[8] = { 0x3bf938e377b802a8, 0x020b1b273633535d, 0x26b7edf049755260, 0x2514c6324384a86d, 0x38e7ecccd1dcff67, 0x65f0b37d93ce0d3e, 0xd749d0dd22ac00aa, 0x0141b9ce4a688d4d };
@@ -146,15 +155,86 @@ void bn128_G2_proj_batch_from_affine( int N, const uint64_t *src , uint64_t *tgt
   }
 }
 
-// converts N points to affine coordinates
+// converts N points to affine coordinates, using a single field inversion for
+// all of them (Montgomery's batch inversion trick). Points at infinity are skipped
+// in the running product, and result in the special affine infinity.
+// Note: the output may overlap with the input, as long as `tgt <= src`
 void bn128_G2_proj_batch_to_affine( int N, const uint64_t *src , uint64_t *tgt ) {
-  const uint64_t *p = src;
-  uint64_t *q = tgt;
+  if (N <= 0) return;
+  uint64_t *zinvs = malloc( 8*NLIMBS_P * N );
+  assert( zinvs != 0 );
+
+  // zinvs[i] = the product of the nonzero Z coordinates of the points before the i-th
+  uint64_t acc[NLIMBS_P];
+  bn128_Fp2_mont_set_one( acc );
+  for(int i=0; i<N; i++) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    bn128_Fp2_mont_copy( acc , zinvs + i*NLIMBS_P );
+    if (!bn128_Fp2_mont_is_zero( z )) { bn128_Fp2_mont_mul_inplace( acc , z ); }
+  }
+
+  // a single inversion, then going backwards: zinvs[i] = 1 / Z[i]
+  bn128_Fp2_mont_inv_inplace( acc );
+  for(int i=N-1; i>=0; i--) {
+    const uint64_t *z = src + (3*i+2)*NLIMBS_P;
+    if (!bn128_Fp2_mont_is_zero( z )) {
+      bn128_Fp2_mont_mul_inplace( zinvs + i*NLIMBS_P , acc );
+      bn128_Fp2_mont_mul_inplace( acc , z );
+    }
+  }
+
   for(int i=0; i<N; i++) {
-    bn128_G2_proj_to_affine(p,q);
-    p += 3*NLIMBS_P;
-    q += 2*NLIMBS_P;
+    const uint64_t *p = src + 3*i*NLIMBS_P;
+    uint64_t       *q = tgt + 2*i*NLIMBS_P;
+    if (bn128_Fp2_mont_is_zero( p + 2*NLIMBS_P )) {
+      memset( q, 0xff, 128 );
+    }
+    else {
+      const uint64_t *zinv = zinvs + i*NLIMBS_P;
+      bn128_Fp2_mont_mul( p            , zinv , q            );
+      bn128_Fp2_mont_mul( p + NLIMBS_P , zinv , q + NLIMBS_P );
+    }
+  }
+
+  free(zinvs);
+}
+
+// below this many points, the parallel version simply calls the sequential one
+#define BATCH_TO_AFFINE_PARALLEL_THRESHOLD 1024
+
+typedef struct {
+  int N;
+  int chunk;
+  const uint64_t *src;
+  uint64_t *tgt;
+} bn128_G2_proj_batch_to_affine_ctx_t;
+
+void bn128_G2_proj_batch_to_affine_task( void *ctx, int j ) {
+  bn128_G2_proj_batch_to_affine_ctx_t *c = (bn128_G2_proj_batch_to_affine_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  bn128_G2_proj_batch_to_affine( b-a, c->src + 3*a*NLIMBS_P, c->tgt + 2*a*NLIMBS_P );
+}
+
+// converts N points to affine coordinates, splitting them into chunks which are
+// converted in parallel (each chunk with a single inversion). For small inputs,
+// or with a single thread, this is the same as `batch_to_affine`.
+// Note: unlike `batch_to_affine`, the output must not overlap with the input
+void bn128_G2_proj_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt ) {
+  int T = parallel_get_num_threads();
+  if ( (N < BATCH_TO_AFFINE_PARALLEL_THRESHOLD) || (T <= 1) ) {
+    bn128_G2_proj_batch_to_affine( N, src, tgt );
+    return;
   }
+  int chunk = (N + T - 1) / T;
+  int m     = (N + chunk - 1) / chunk;
+  bn128_G2_proj_batch_to_affine_ctx_t ctx;
+  ctx.N     = N;
+  ctx.chunk = chunk;
+  ctx.src   = src;
+  ctx.tgt   = tgt;
+  parallel_for( m, bn128_G2_proj_batch_to_affine_task, &ctx );
 }
 
 void bn128_G2_proj_copy( const uint64_t *src1 , uint64_t *tgt ) {
@@ -201,7 +281,7 @@ uint8_t bn128_G2_proj_is_in_subgroup ( const uint64_t *src1 ) {
     return 0;
   }
   else {
-    bn128_G2_proj_scl_Fr_std( bn128_G2_proj_cofactor , src1 , tmp );
+    bn128_G2_proj_scl_generic( bn128_G2_proj_subgroup_order , src1 , tmp , NLIMBS_R );
     return bn128_G2_proj_is_infinity( tmp );
   }
 }
@@ -217,41 +297,31 @@ void bn128_G2_proj_neg_inplace( uint64_t *tgt ) {
   bn128_Fp2_mont_neg_inplace( Y3 );
 }
 
-// doubles an elliptic curve point
-// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#doubling-dbl-2007-bl
+// doubles an elliptic curve point, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 9 <https://eprint.iacr.org/2015/1060>
 void bn128_G2_proj_dbl( const uint64_t *src1, uint64_t *tgt ) {
-  uint64_t  XX[8];
-  uint64_t  ZZ[8];
-  uint64_t   w[8];
-  uint64_t   s[8];
-  uint64_t  ss[8];
-  uint64_t sss[8];
-  uint64_t   R[8];
-  uint64_t  RR[8];
-  uint64_t   B[8];
-  uint64_t   h[8];
-  bn128_Fp2_mont_sqr( X1 , XX );         // XX = X1^2
-  bn128_Fp2_mont_sqr( Z1 , ZZ );         // ZZ = Z1^2
-  bn128_Fp2_mont_add( XX, XX, w );       // w  = 2*XX
-  bn128_Fp2_mont_add_inplace( w, XX );   // w  = 3*XX
-  bn128_Fp2_mont_mul( Y1 , Z1 , s );         // s   = Y1*Z1
-  bn128_Fp2_mont_add_inplace( s, s );        // s   = 2*Y1*Z1
-  bn128_Fp2_mont_sqr( s , ss );              // ss  = s^2
-  bn128_Fp2_mont_mul( Y1 , s , R);           // R   = Y1*s
-  bn128_Fp2_mont_sqr( R , RR );              // RR  = R^2
-  bn128_Fp2_mont_add( X1 , R , B);           // B   = (X1+R)
-  bn128_Fp2_mont_sqr_inplace( B );           // B   = (X1+R)^2
-  bn128_Fp2_mont_sub_inplace( B , XX );      // B   = (X1+R)^2 - XX
-  bn128_Fp2_mont_sub_inplace( B , RR );      // B   = (X1+R)^2 - XX - RR
-  bn128_Fp2_mont_sqr( w , h );               // h   = w^2
-  bn128_Fp2_mont_sub_inplace( h , B );       // h   = w^2 - B
-  bn128_Fp2_mont_sub_inplace( h , B );       // h   = w^2 - 2*B
-  bn128_Fp2_mont_mul( s , ss , Z3 );         // Z3  = s^3
-  bn128_Fp2_mont_mul( h , s , X3 );          // X3  = h*s
-  bn128_Fp2_mont_sub( B , h , Y3 );          // Y3  = B-h
-  bn128_Fp2_mont_mul_inplace( Y3 , w  );     // Y3  = w*(B-h)
-  bn128_Fp2_mont_sub_inplace( Y3 , RR );     // Y3  = w*(B-h) - RR
-  bn128_Fp2_mont_sub_inplace( Y3 , RR );     // Y3  = w*(B-h) - 2*RR
+  uint64_t t0[8];
+  uint64_t t1[8];
+  uint64_t t2[8];
+  uint64_t t3[8];
+  bn128_Fp2_mont_sqr( Y1, t0 );                  // t0 = Y1^2
+  bn128_Fp2_mont_mul( Y1, Z1, t1 );              // t1 = Y1*Z1
+  bn128_Fp2_mont_sqr( Z1, t2 );                  // t2 = Z1^2
+  bn128_Fp2_mont_mul( X1, Y1, t3 );              // t3 = X1*Y1
+  bn128_G2_proj_scale_by_3B_inplace( t2 );      // t2 = b3*Z1^2
+  bn128_Fp2_mont_add( t0, t0, Z3 );              // Z3 = 2*t0
+  bn128_Fp2_mont_add_inplace( Z3, Z3 );          // Z3 = 4*t0
+  bn128_Fp2_mont_add_inplace( Z3, Z3 );          // Z3 = 8*t0
+  bn128_Fp2_mont_mul( t2, Z3, X3 );              // X3 = t2*Z3
+  bn128_Fp2_mont_add( t0, t2, Y3 );              // Y3 = t0+t2
+  bn128_Fp2_mont_mul_inplace( Z3, t1 );          // Z3 = t1*Z3
+  bn128_Fp2_mont_add( t2, t2, t1 );              // t1 = 2*t2
+  bn128_Fp2_mont_add_inplace( t2, t1 );          // t2 = 3*t2
+  bn128_Fp2_mont_sub_inplace( t0, t2 );          // t0 = t0-t2
+  bn128_Fp2_mont_mul_inplace( Y3, t0 );          // Y3 = t0*Y3
+  bn128_Fp2_mont_add_inplace( Y3, X3 );          // Y3 = X3+Y3
+  bn128_Fp2_mont_mul( t0, t3, X3 );              // X3 = t0*t3
+  bn128_Fp2_mont_add_inplace( X3, X3 );          // X3 = 2*X3
 }
 
 // doubles an elliptic curve point
@@ -259,8 +329,9 @@ void bn128_G2_proj_dbl_inplace( uint64_t *tgt ) {
   bn128_G2_proj_dbl( tgt , tgt );
 }
 
-// adds two elliptic curve points, assuming A = 0
-// https://hyperelliptic.org/EFD/g1p/auto-shortw-projective.html#addition-add-2015-rcb
+// adds two elliptic curve points, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 7 <https://eprint.iacr.org/2015/1060>
+// cost: 12M + 2*m_3b
 void bn128_G2_proj_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
   uint64_t t0[8];
   uint64_t t1[8];
@@ -286,10 +357,9 @@ void bn128_G2_proj_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tg
   bn128_Fp2_mont_mul_inplace( t5, X3 );          // t5 = t5*X3
   bn128_Fp2_mont_add( t1, t2, X3 );              // X3 = t1+t2
   bn128_Fp2_mont_sub_inplace( t5, X3 );          // t5 = t5-X3
-  bn128_G2_proj_scale_by_3B( t2, X3 );          // X3 = b3*t2
-  bn128_Fp2_mont_copy( X3, Z3 );                 // Z3 = X3
-  bn128_Fp2_mont_sub( t1, Z3, X3 );              // X3 = t1-Z3
-  bn128_Fp2_mont_add_inplace( Z3, t1 );          // Z3 = t1+Z3
+  bn128_G2_proj_scale_by_3B_inplace( t2 );      // t2 = b3*t2
+  bn128_Fp2_mont_sub( t1, t2, X3 );              // X3 = t1-t2
+  bn128_Fp2_mont_add( t1, t2, Z3 );              // Z3 = t1+t2
   bn128_Fp2_mont_mul( X3, Z3, Y3 );              // Y3 = X3*Z3
   bn128_Fp2_mont_add( t0, t0, t1 );              // t1 = t0+t0
   bn128_Fp2_mont_add_inplace( t1, t0 );          // t1 = t1+t0
@@ -453,6 +523,155 @@ void bn128_G2_proj_scl_windowed(const uint64_t *expo, const uint64_t *grp, uint6
   }
 }
 
+// scale an Fp2 field element by A = (0,0)
+void bn128_G2_proj_scale_by_A_ct(const uint64_t *src, uint64_t *tgt ) {
+  memset( tgt, 0, 64 );
+}
+
+void bn128_G2_proj_scale_by_A_inplace_ct( uint64_t *tgt ) {
+  memset( tgt, 0, 64 );
+}
+// scale an Fp field element by 3B = 3*(19485874751759354771024239261021720505790618469301721065564631296452457478373,266929791119991161246907387137283842545076965332900288569378510910307636690)
+void bn128_G2_proj_scale_by_3B_ct(const uint64_t *src, uint64_t *tgt ) {
+  bn128_Fp2_mont_mul_ct( bn128_G2_proj_const_3B, src, tgt );
+}
+
+void bn128_G2_proj_scale_by_3B_inplace_ct( uint64_t *tgt ) {
+  bn128_Fp2_mont_mul_inplace_ct( tgt, bn128_G2_proj_const_3B );
+}
+
+// doubles an elliptic curve point, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 9 <https://eprint.iacr.org/2015/1060>
+void bn128_G2_proj_dbl_ct( const uint64_t *src1, uint64_t *tgt ) {
+  uint64_t t0[8];
+  uint64_t t1[8];
+  uint64_t t2[8];
+  uint64_t t3[8];
+  bn128_Fp2_mont_sqr_ct( Y1, t0 );                  // t0 = Y1^2
+  bn128_Fp2_mont_mul_ct( Y1, Z1, t1 );              // t1 = Y1*Z1
+  bn128_Fp2_mont_sqr_ct( Z1, t2 );                  // t2 = Z1^2
+  bn128_Fp2_mont_mul_ct( X1, Y1, t3 );              // t3 = X1*Y1
+  bn128_G2_proj_scale_by_3B_inplace_ct( t2 );      // t2 = b3*Z1^2
+  bn128_Fp2_mont_add_ct( t0, t0, Z3 );              // Z3 = 2*t0
+  bn128_Fp2_mont_add_inplace_ct( Z3, Z3 );          // Z3 = 4*t0
+  bn128_Fp2_mont_add_inplace_ct( Z3, Z3 );          // Z3 = 8*t0
+  bn128_Fp2_mont_mul_ct( t2, Z3, X3 );              // X3 = t2*Z3
+  bn128_Fp2_mont_add_ct( t0, t2, Y3 );              // Y3 = t0+t2
+  bn128_Fp2_mont_mul_inplace_ct( Z3, t1 );          // Z3 = t1*Z3
+  bn128_Fp2_mont_add_ct( t2, t2, t1 );              // t1 = 2*t2
+  bn128_Fp2_mont_add_inplace_ct( t2, t1 );          // t2 = 3*t2
+  bn128_Fp2_mont_sub_inplace_ct( t0, t2 );          // t0 = t0-t2
+  bn128_Fp2_mont_mul_inplace_ct( Y3, t0 );          // Y3 = t0*Y3
+  bn128_Fp2_mont_add_inplace_ct( Y3, X3 );          // Y3 = X3+Y3
+  bn128_Fp2_mont_mul_ct( t0, t3, X3 );              // X3 = t0*t3
+  bn128_Fp2_mont_add_inplace_ct( X3, X3 );          // X3 = 2*X3
+}
+
+// adds two elliptic curve points, assuming A = 0 (complete formula)
+// Renes-Costello-Batina, Algorithm 7 <https://eprint.iacr.org/2015/1060>
+// cost: 12M + 2*m_3b
+void bn128_G2_proj_add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  uint64_t t0[8];
+  uint64_t t1[8];
+  uint64_t t2[8];
+  uint64_t t3[8];
+  uint64_t t4[8];
+  uint64_t t5[8];
+  bn128_Fp2_mont_mul_ct( X1, X2, t0 );              // t0 = X1*X2
+  bn128_Fp2_mont_mul_ct( Y1, Y2, t1 );              // t1 = Y1*Y2
+  bn128_Fp2_mont_mul_ct( Z1, Z2, t2 );              // t2 = Z1*Z2
+  bn128_Fp2_mont_add_ct( X1, Y1, t3 );              // t3 = X1+Y1
+  bn128_Fp2_mont_add_ct( X2, Y2, t4 );              // t4 = X2+Y2
+  bn128_Fp2_mont_mul_inplace_ct( t3, t4 );          // t3 = t3*t4
+  bn128_Fp2_mont_add_ct( t0, t1, t4 );              // t4 = t0+t1
+  bn128_Fp2_mont_sub_inplace_ct( t3 , t4 );         // t3 = t3-t4
+  bn128_Fp2_mont_add_ct( X1, Z1, t4 );              // t4 = X1+Z1
+  bn128_Fp2_mont_add_ct( X2, Z2, t5 );              // t5 = X2+Z2
+  bn128_Fp2_mont_mul_inplace_ct( t4, t5 );          // t4 = t4*t5
+  bn128_Fp2_mont_add_ct( t0, t2, t5 );              // t5 = t0+t2
+  bn128_Fp2_mont_sub_inplace_ct( t4, t5 );          // t4 = t4-t5
+  bn128_Fp2_mont_add_ct( Y1, Z1, t5 );              // t5 = Y1+Z1
+  bn128_Fp2_mont_add_ct( Y2, Z2, X3 );              // X3 = Y2+Z2
+  bn128_Fp2_mont_mul_inplace_ct( t5, X3 );          // t5 = t5*X3
+  bn128_Fp2_mont_add_ct( t1, t2, X3 );              // X3 = t1+t2
+  bn128_Fp2_mont_sub_inplace_ct( t5, X3 );          // t5 = t5-X3
+  bn128_G2_proj_scale_by_3B_inplace_ct( t2 );      // t2 = b3*t2
+  bn128_Fp2_mont_sub_ct( t1, t2, X3 );              // X3 = t1-t2
+  bn128_Fp2_mont_add_ct( t1, t2, Z3 );              // Z3 = t1+t2
+  bn128_Fp2_mont_mul_ct( X3, Z3, Y3 );              // Y3 = X3*Z3
+  bn128_Fp2_mont_add_ct( t0, t0, t1 );              // t1 = t0+t0
+  bn128_Fp2_mont_add_inplace_ct( t1, t0 );          // t1 = t1+t0
+  bn128_G2_proj_scale_by_3B_inplace_ct( t4 );      // t4 = b3*t4
+  bn128_Fp2_mont_mul_ct( t1, t4, t0 );              // t0 = t1*t4
+  bn128_Fp2_mont_add_inplace_ct( Y3, t0 );          // Y3 = Y3+t0
+  bn128_Fp2_mont_mul_ct( t4, t5, t0 );              // t0 = t5*t4
+  bn128_Fp2_mont_mul_inplace_ct( X3, t3 );          // X3 = t3*X3
+  bn128_Fp2_mont_sub_inplace_ct( X3, t0 );          // X3 = X3-t0
+  bn128_Fp2_mont_mul_ct( t1, t3, t0 );              // t0 = t3*t1
+  bn128_Fp2_mont_mul_inplace_ct( Z3, t5 );          // Z3 = t5*Z3
+  bn128_Fp2_mont_add_inplace_ct( Z3, t0 );          // Z3 = Z3+t0
+}
+
+// constant-time table lookup: computes `d*g` from the table [ k*g | k <- [1..8] ],
+// where -8 <= d <= 8. All the entries are read, and there are no branches depending on `d`
+void bn128_G2_proj_ct_lookup_window_8( const uint64_t *table, int d, uint64_t *tgt ) {
+  uint64_t sgn  = (uint64_t)( ((int64_t)d) >> 63 );                 // all ones if d < 0
+  uint64_t absd = ((uint64_t)d ^ sgn) - sgn;
+  bn128_G2_proj_set_infinity( tgt );
+  for(int k=1; k<=8; k++) {
+    uint64_t mask = - (((absd ^ k) - 1) >> 63);                    // all ones if absd == k
+    const uint64_t *entry = TBL(k);
+    for(int i=0; i<3*NLIMBS_P; i++) { tgt[i] = (tgt[i] & ~mask) | (entry[i] & mask); }
+  }
+  uint64_t negy[NLIMBS_P];
+  bn128_Fp2_mont_neg_ct( tgt+NLIMBS_P , negy );
+  for(int i=0; i<NLIMBS_P; i++) { tgt[NLIMBS_P+i] = (tgt[NLIMBS_P+i] & ~sgn) | (negy[i] & sgn); }
+}
+
+#define CT_BIT(j) ( ((j) < 0 || (j) >= 64*expo_len) ? 0 : (int)((expo[(j)>>6] >> ((j)&63)) & 1) )
+
+// computes `expo*grp` (or `grp^expo` in multiplicative notation)
+// where `grp` is a group element in G2, and `expo` is a (non-negative) bigint
+// constant-time algorithm (signed fixed 4-bit windows), use this for secret scalars.
+// The running time only depends on `expo_len`
+void bn128_G2_proj_scl_ct_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int expo_len) {
+
+  // precalculate [ k*g | k <- [1..8] ]
+  uint64_t table[8*3*NLIMBS_P];
+  bn128_G2_proj_copy( grp , TBL(1) );
+  bn128_G2_proj_dbl_ct( TBL(1) , TBL(2) );
+  bn128_G2_proj_add_ct( TBL(1) , TBL(2) , TBL(3) );
+  bn128_G2_proj_dbl_ct( TBL(2) , TBL(4) );
+  bn128_G2_proj_add_ct( TBL(1) , TBL(4) , TBL(5) );
+  bn128_G2_proj_dbl_ct( TBL(3) , TBL(6) );
+  bn128_G2_proj_add_ct( TBL(1) , TBL(6) , TBL(7) );
+  bn128_G2_proj_dbl_ct( TBL(4) , TBL(8) );
+
+  uint64_t tmp[3*NLIMBS_P];
+  bn128_G2_proj_set_infinity( tgt );
+  for(int i=16*expo_len; i>=0; i--) {
+    for(int s=0; s<4; s++) { bn128_G2_proj_dbl_ct( tgt , tgt ); }
+    int j = 4*i;
+    int d = CT_BIT(j-1) + CT_BIT(j) + 2*CT_BIT(j+1) + 4*CT_BIT(j+2) - 8*CT_BIT(j+3);
+    bn128_G2_proj_ct_lookup_window_8( table, d, tmp );
+    bn128_G2_proj_add_ct( tgt, tmp, tgt );
+  }
+}
+
+#undef CT_BIT
+
+// computes `expo*grp` in constant time, where `expo` is in Fr *in standard repr*
+void bn128_G2_proj_scl_ct_Fr_std(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  bn128_G2_proj_scl_ct_generic(expo, grp, tgt, NLIMBS_R);
+}
+
+// computes `expo*grp` in constant time, where `expo` is in Fr *in Montgomery repr*
+void bn128_G2_proj_scl_ct_Fr_mont(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bn128_Fr_mont_to_std_ct(expo, expo_std);
+  bn128_G2_proj_scl_ct_generic(expo_std, grp, tgt, NLIMBS_R);
+}
+
 // computes `expo*grp` (or `grp^expo` in multiplicative notation)
 // where `grp` is a group element in G, and `expo` is in Fr
 void bn128_G2_proj_scl_generic(const uint64_t *expo, const uint64_t *grp, uint64_t *tgt, int nlimbs) {
@@ -488,13 +707,139 @@ void bn128_G2_proj_scl_small(uint64_t expo, const uint64_t *grp, uint64_t *tgt)
 }
 
 //------------------------------------------------------------------------------
+// fixed-base scalar multiplication (Lim-Lee comb method)
+//
+// The scalar is written as a COMB_TEETH x COMB_ROWS bit matrix, that is
+//
+//   k = sum_{i,j} k[i*COMB_ROWS+j] * 2^(i*COMB_ROWS+j)
+//
+// and the column `j` is a COMB_TEETH bit number `u`. The first table contains
+// the points `sum_i u_i * 2^(i*COMB_ROWS) * P` for all nonzero `u`; the table `t`
+// is the first one multiplied by `2^(t*COMB_SPACING)`. Then a scalar multiplication
+// is only COMB_SPACING-1 doublings and COMB_ROWS mixed additions.
+
+#define COMB_TEETH   8
+#define COMB_ROWS    32
+#define COMB_TABLES  4
+#define COMB_SPACING 8
+#define COMB_ENTRIES ((1<<COMB_TEETH) - 1)
+
+#define COMB_TABLE_NWORDS (COMB_TABLES*COMB_ENTRIES*2*NLIMBS_P)
+#define COMB_ENTRY(table,t,u) ((table) + ((t)*COMB_ENTRIES + (u)-1)*(2*NLIMBS_P))
+#define COMB_TMP(t,u)         (tmp   + ((t)*COMB_ENTRIES + (u)-1)*(3*NLIMBS_P))
+
+// the size of a precomputed table, in 64-bit words
+int bn128_G2_proj_comb_table_nwords() {
+  return COMB_TABLE_NWORDS;
+}
+
+// precomputes the table (of COMB_TABLE_NWORDS words) for the base point `src`
+void bn128_G2_proj_comb_precompute(const uint64_t *src, uint64_t *table) {
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * COMB_TABLES*COMB_ENTRIES );
+  assert( tmp != 0 );
+
+  // the teeth: 2^(i*COMB_ROWS) * P
+  uint64_t teeth[COMB_TEETH*3*NLIMBS_P];
+  bn128_G2_proj_copy( src, teeth );
+  for(int i=1; i<COMB_TEETH; i++) {
+    bn128_G2_proj_copy( teeth + (i-1)*3*NLIMBS_P , teeth + i*3*NLIMBS_P );
+    for(int s=0; s<COMB_ROWS; s++) { bn128_G2_proj_dbl_inplace( teeth + i*3*NLIMBS_P ); }
+  }
 
-#define SIDX(b) (SUMS + (b-1)*(3*NLIMBS_P))
+  // first table: COMB_TMP(0,u) = COMB_TMP(0,u-lowbit(u)) + teeth[ctz(u)]
+  for(int u=1; u<=COMB_ENTRIES; u++) {
+    int i = 0;
+    while (!((u >> i) & 1)) { i++; }
+    int v = u & (u-1);
+    if (v == 0) {
+      bn128_G2_proj_copy( teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );
+    }
+    else {
+      bn128_G2_proj_add( COMB_TMP(0,v) , teeth + i*3*NLIMBS_P , COMB_TMP(0,u) );
+    }
+  }
+
+  // the other tables: COMB_TMP(t,u) = 2^COMB_SPACING * COMB_TMP(t-1,u)
+  for(int t=1; t<COMB_TABLES; t++) {
+    for(int u=1; u<=COMB_ENTRIES; u++) {
+      bn128_G2_proj_copy( COMB_TMP(t-1,u) , COMB_TMP(t,u) );
+      for(int s=0; s<COMB_SPACING; s++) { bn128_G2_proj_dbl_inplace( COMB_TMP(t,u) ); }
+    }
+  }
+
+  bn128_G2_proj_batch_to_affine( COMB_TABLES*COMB_ENTRIES , tmp , table );
+  free(tmp);
+}
+
+// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,
+// and `expo` is in Fr *in standard repr*
+void bn128_G2_proj_comb_scl_Fr_std(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t acc[3*NLIMBS_P];
+  bn128_G2_proj_set_infinity( acc );
+  for(int j=COMB_SPACING-1; j>=0; j--) {
+    if (j < COMB_SPACING-1) { bn128_G2_proj_dbl_inplace( acc ); }
+    for(int t=0; t<COMB_TABLES; t++) {
+      int col = t*COMB_SPACING + j;
+      int u   = 0;
+      for(int i=0; i<COMB_TEETH; i++) {
+        int b = i*COMB_ROWS + col;
+        u |= ((expo[b>>6] >> (b&63)) & 1) << i;
+      }
+      if (u) { bn128_G2_proj_madd_inplace( acc , COMB_ENTRY(table,t,u) ); }
+    }
+  }
+  bn128_G2_proj_copy( acc , tgt );
+}
+
+// computes `expo*P` where the table was precomputed from `P` by `comb_precompute`,
+// and `expo` is in Fr *in Montgomery repr*
+void bn128_G2_proj_comb_scl_Fr_mont(const uint64_t *table, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bn128_Fr_mont_to_std(expo, expo_std);
+  bn128_G2_proj_comb_scl_Fr_std(table, expo_std, tgt);
+}
+
+// the table for the subgroup generator is computed on first use
+uint64_t bn128_G2_proj_gen_comb_table[COMB_TABLE_NWORDS];
+int      bn128_G2_proj_gen_comb_table_ready = 0;
+
+void bn128_G2_proj_gen_comb_table_init() {
+  bn128_G2_proj_comb_precompute( bn128_G2_proj_gen_G2 , bn128_G2_proj_gen_comb_table );
+}
+
+// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in standard repr*
+void bn128_G2_proj_scl_gen_Fr_std(const uint64_t *expo, uint64_t *tgt) {
+  parallel_call_once( &bn128_G2_proj_gen_comb_table_ready , bn128_G2_proj_gen_comb_table_init );
+  bn128_G2_proj_comb_scl_Fr_std( bn128_G2_proj_gen_comb_table , expo , tgt );
+}
+
+// computes `expo*gen` where `gen` is the subgroup generator, and `expo` is in Fr *in Montgomery repr*
+void bn128_G2_proj_scl_gen_Fr_mont(const uint64_t *expo, uint64_t *tgt) {
+  uint64_t expo_std[NLIMBS_R];
+  bn128_Fr_mont_to_std(expo, expo_std);
+  bn128_G2_proj_scl_gen_Fr_std(expo_std, tgt);
+}
+
+#undef COMB_TMP
+#undef COMB_ENTRY
+#undef COMB_TABLE_NWORDS
+#undef COMB_ENTRIES
+#undef COMB_SPACING
+#undef COMB_TABLES
+#undef COMB_ROWS
+#undef COMB_TEETH
+
+//------------------------------------------------------------------------------
+
+// the bucket sums are in XYZZ coordinates
+#define SIDX(b) (SUMS + (b-1)*(4*NLIMBS_P))
 
 // Multi-Scalar Multiplication (MSM)
 // standard coefficients (NOT montgomery!)
 // straightforward Pippenger bucketing method
 // parametric bucket size
+// the buckets are accumulated in XYZZ coordinates (cheap mixed additions), and
+// only the window sums are converted back to proj coordinates
 void bn128_G2_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs, int window_size) {
 
   assert( (window_size > 0) && (window_size <= 64) );
@@ -505,7 +850,7 @@ void bn128_G2_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *
   bn128_G2_proj_set_infinity(tgt);
 
   // allocate memory for bucket sums
-  uint64_t *SUMS = malloc( 3*8*NLIMBS_P * (nbuckets-1) );
+  uint64_t *SUMS = malloc( 4*8*NLIMBS_P * (nbuckets-1) );
   assert( SUMS !=0 );
 
   // loop over the windows
@@ -534,7 +879,7 @@ void bn128_G2_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *
 
     // initalize bucket sums
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bn128_G2_proj_set_infinity( SIDX(b) );
+      bn128_G2_xyzz_set_infinity( SIDX(b) );
     }
 
     // compute bucket sums
@@ -548,22 +893,24 @@ void bn128_G2_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *
       e &= mask;   // bucket coeff
 
       if (e>0) {
-        bn128_G2_proj_madd_proj_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
+        bn128_G2_xyzz_madd_xyzz_aff( SIDX(e) , grps + (2*NLIMBS_P*j) , SIDX(e) );
       }
     }
 
     // compute running sums
 
-    uint64_t T[3*NLIMBS_P];   // cumulative sum of S-es
-    uint64_t R[3*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t T[4*NLIMBS_P];   // cumulative sum of S-es
+    uint64_t R[4*NLIMBS_P];   // running sum = sum of T-s
+    uint64_t W[3*NLIMBS_P];   // the window sum, converted back
 
-    bn128_G2_proj_set_infinity(T);
-    bn128_G2_proj_set_infinity(R);
+    bn128_G2_xyzz_set_infinity(T);
+    bn128_G2_xyzz_set_infinity(R);
 
     for( int b=nbuckets-1; b>0; b-- ) { 
-      bn128_G2_proj_add_inplace( T , SIDX(b) );
-      bn128_G2_proj_add_inplace( R , T       );
+      bn128_G2_xyzz_add_inplace( T , SIDX(b) );
+      bn128_G2_xyzz_add_inplace( R , T       );
     }
+    bn128_G2_xyzz_to_proj( R , W );
 
     if (!bn128_G2_proj_is_infinity(tgt)) {    // we can skip doubling when infinity
       for(int i=0; i<window_size; i++) {
@@ -571,7 +918,7 @@ void bn128_G2_proj_MSM_std_coeff_proj_out_variable(int npoints, const uint64_t *
       }
     }
 
-    bn128_G2_proj_add_inplace( tgt, R );
+    bn128_G2_proj_add_inplace( tgt, W );
   }
 
   free(SUMS);
@@ -663,122 +1010,601 @@ void bn128_G2_proj_MSM_mont_coeff_affine_out(int npoints, const uint64_t *expos,
 //------------------------------------------------------------------------------
 
 
+// inverse of 2 (Montgomery repr)
+const uint64_t bn128_G2_proj_oneHalf[4] = { 0x783c14d81ffffffe, 0xaf982f6f0c8d1edd, 0x8f5f7492fcfd4f45, 0x1f37631a3d9cbfac };
+
 #define GRP_NLIMBS (3*NLIMBS_P)
 
 // -----------------------------------------------------------------------------
+// FFT of group elements
+//
+// Iterative radix-2 decimation-in-time FFT, computed in place after a bit-reversal
+// permutation. The twiddle factors are precomputed once (in standard repr, as the
+// scalar multiplication needs that); the butterflies of each layer are independent,
+// so they are distributed among the worker threads.
+
+// below this many butterflies per layer, we don't bother with multithreading
+#define FFT_PARALLEL_THRESHOLD 64
+
+// computes the twiddle factors `[ gen^j | j <- [0..N/2-1] ]` (in standard repr), `m >= 1`
+void bn128_G2_proj_fft_twiddles( int m, const uint64_t *gen, uint64_t *twiddles ) {
+  int halfN = (1<<(m-1));
+  uint64_t acc[NLIMBS_R];
+  bn128_Fr_mont_set_one( acc );
+  for(int j=0; j<halfN; j++) {
+    bn128_Fr_mont_to_std( acc , twiddles + j*NLIMBS_R );
+    bn128_Fr_mont_mul_inplace( acc , gen );
+  }
+}
 
-void bn128_G2_proj_fft_forward_noalloc( int m, int src_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
+// reverses the lowest `m` bits of `i`
+int bn128_G2_proj_fft_bit_reverse( int m, int i ) {
+  int j = 0;
+  for(int k=0; k<m; k++) {
+    j = (j << 1) | (i & 1);
+    i = i >> 1;
+  }
+  return j;
+}
 
-  if (m==0) {
-    bn128_G2_proj_copy( src, tgt );
-    return;
+// copies `src` into `tgt` in bit-reversed order (`src == tgt` is allowed)
+void bn128_G2_proj_fft_bit_reverse_permute( int m, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  if (src == tgt) {
+    uint64_t tmp[GRP_NLIMBS];
+    for(int i=0; i<N; i++) {
+      int j = bn128_G2_proj_fft_bit_reverse( m, i );
+      if (i < j) {
+        bn128_G2_proj_copy( tgt + i*GRP_NLIMBS , tmp );
+        bn128_G2_proj_copy( tgt + j*GRP_NLIMBS , tgt + i*GRP_NLIMBS );
+        bn128_G2_proj_copy( tmp                , tgt + j*GRP_NLIMBS );
+      }
+    }
   }
+  else {
+    for(int i=0; i<N; i++) {
+      bn128_G2_proj_copy( src + i*GRP_NLIMBS , tgt + bn128_G2_proj_fft_bit_reverse( m, i )*GRP_NLIMBS );
+    }
+  }
+}
 
-  if (m==1) {
-    // N = 2
-    bn128_G2_proj_add( src , src + src_stride*GRP_NLIMBS , tgt              );    // x + y
-    bn128_G2_proj_sub( src , src + src_stride*GRP_NLIMBS , tgt + GRP_NLIMBS );    // x - y
-    return;
+typedef struct {
+  int m;                      // log2 of the size
+  int half;                   // half the block size of the current layer
+  int chunk;                  // number of butterflies per task
+  const uint64_t *twiddles;
+  uint64_t *buf;
+} bn128_G2_proj_fft_layer_ctx_t;
+
+// the butterflies `(u,v) -> (u + w*v, u - w*v)` with indices in `[ j*chunk , (j+1)*chunk )`
+// of a layer of the FFT. The blocks of this layer have size `2*half`, and the twiddle
+// factor for the `k`-th butterfly in a block is `w = gen^(k*N/(2*half))`
+void bn128_G2_proj_fft_layer_task( void *ctx, int j ) {
+  bn128_G2_proj_fft_layer_ctx_t *c = (bn128_G2_proj_fft_layer_ctx_t*) ctx;
+  int half   = c->half;
+  int halfN  = (1<<(c->m-1));
+  int stride = halfN / half;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > halfN) { b = halfN; }
+  uint64_t tmp[GRP_NLIMBS];
+  for(int t=a; t<b; t++) {
+    int k = t & (half-1);
+    uint64_t *u = c->buf + (2*(t-k) + k)*GRP_NLIMBS;
+    uint64_t *v = u + half*GRP_NLIMBS;
+    if (k == 0) {
+      bn128_G2_proj_copy( v , tmp );
+    }
+    else {
+      bn128_G2_proj_scl_Fr_std( c->twiddles + (k*stride)*NLIMBS_R , v , tmp );       // w*v
+    }
+    bn128_G2_proj_sub( u , tmp , v );                                          // u - w*v
+    bn128_G2_proj_add_inplace( u , tmp );                                      // u + w*v
   }
+}
 
-  else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
-
-    uint64_t gpow[NLIMBS_R];
-    bn128_Fr_mont_sqr( gen, gpow );  // gen^2
-    
-    bn128_G2_proj_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src                         , buf + N*GRP_NLIMBS , buf                    );
-    bn128_G2_proj_fft_forward_noalloc( m-1 , src_stride<<1 , gpow , src + src_stride*GRP_NLIMBS , buf + N*GRP_NLIMBS , buf + halfN*GRP_NLIMBS );
-
-    bn128_Fr_mont_set_one(gpow);
-    for(int j=0; j<halfN; j++) {
-      bn128_G2_proj_scl_Fr_mont(gpow , buf + (j+halfN)*GRP_NLIMBS  , tgt +  j *GRP_NLIMBS );  //   g*v[k]
-      bn128_G2_proj_neg ( tgt +  j       *GRP_NLIMBS ,        tgt + (j+halfN)*GRP_NLIMBS );   // - g*v[k]
-      bn128_G2_proj_add_inplace( tgt +  j       *GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] + g*v[k]
-      bn128_G2_proj_add_inplace( tgt + (j+halfN)*GRP_NLIMBS , buf + j*GRP_NLIMBS );           // u[k] - g*v[k]
-      bn128_Fr_mont_mul_inplace( gpow , gen );      
+// in-place FFT of `N = 2^m` group elements, given in bit-reversed order
+void bn128_G2_proj_fft_inplace_noalloc( int m, const uint64_t *twiddles, uint64_t *buf ) {
+  if (m == 0) return;
+  int halfN = (1<<(m-1));
+  int T = parallel_get_num_threads();
+  bn128_G2_proj_fft_layer_ctx_t ctx;
+  ctx.m        = m;
+  ctx.twiddles = twiddles;
+  ctx.buf      = buf;
+  for(int half=1; half<=halfN; half<<=1) {
+    ctx.half = half;
+    if ( (halfN < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = halfN;
+      bn128_G2_proj_fft_layer_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (halfN + T - 1) / T;
+      parallel_for( (halfN + ctx.chunk - 1) / ctx.chunk , bn128_G2_proj_fft_layer_task, &ctx );
     }
   }
 }
 
+typedef struct {
+  int chunk;
+  int N;
+  const uint64_t *scalar;
+  uint64_t *buf;
+} bn128_G2_proj_fft_scale_ctx_t;
+
+void bn128_G2_proj_fft_scale_task( void *ctx, int j ) {
+  bn128_G2_proj_fft_scale_ctx_t *c = (bn128_G2_proj_fft_scale_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = a + c->chunk;
+  if (b > c->N) { b = c->N; }
+  for(int i=a; i<b; i++) {
+    bn128_G2_proj_scl_Fr_std( c->scalar , c->buf + i*GRP_NLIMBS , c->buf + i*GRP_NLIMBS );
+  }
+}
+
+// normalizes `N` points using a single inversion: first we convert them to affine
+// coordinates (which are then packed at the beginning of the buffer), then back
+void bn128_G2_proj_fft_normalize( int N, uint64_t *buf ) {
+  bn128_G2_proj_batch_to_affine( N, buf, buf );
+  for(int i=N-1; i>=0; i--) {
+    uint64_t tmp[2*NLIMBS_P];
+    memcpy( tmp, buf + i*2*NLIMBS_P, 8*2*NLIMBS_P );
+    bn128_G2_proj_from_affine( tmp, buf + i*GRP_NLIMBS );
+  }
+}
+
 // forward FFT of group elements (convert from [L_k(tau)] to [tau^i])
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
 // `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N` (in _Montgomery_ representation)
 // NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
 void bn128_G2_proj_fft_forward (int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
   int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bn128_G2_proj_fft_forward_noalloc( m, 1, gen, src, buf, tgt);
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bn128_G2_proj_normalize_inplace( tgt + i*GRP_NLIMBS );
+  bn128_G2_proj_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bn128_G2_proj_fft_twiddles( m, gen, twiddles );
+    bn128_G2_proj_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
   }
+  bn128_G2_proj_fft_normalize( N, tgt );
 }
 
+// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
+// `src` and `tgt` should be `N = 2^m` sized arrays of group elements (they can be the same)
+// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
+// This is the forward FFT with `gen^-1`, followed by scaling with `1/N`
+// NOTE: we normalize the results
+// NOTE: the points must be in the prime-order subgroup, as the scalars are only defined modulo r
+void bn128_G2_proj_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
+  int N = (1<<m);
+  bn128_G2_proj_fft_bit_reverse_permute( m, src, tgt );
+  if (m > 0) {
+    uint64_t ginv[NLIMBS_R];
+    bn128_Fr_mont_inv( gen , ginv );
+    uint64_t *twiddles = malloc( 8*NLIMBS_R * (N/2) );
+    assert( twiddles != 0 );
+    bn128_G2_proj_fft_twiddles( m, ginv, twiddles );
+    bn128_G2_proj_fft_inplace_noalloc( m, twiddles, tgt );
+    free(twiddles);
+
+    // 1/N = (1/2)^m
+    uint64_t ninv_mont[NLIMBS_R];
+    uint64_t ninv[NLIMBS_R];
+    bn128_Fr_mont_pow_uint64( bn128_G2_proj_oneHalf , m , ninv_mont );
+    bn128_Fr_mont_to_std( ninv_mont , ninv );
+
+    bn128_G2_proj_fft_scale_ctx_t ctx;
+    ctx.N      = N;
+    ctx.scalar = ninv;
+    ctx.buf    = tgt;
+    int T = parallel_get_num_threads();
+    if ( (N < FFT_PARALLEL_THRESHOLD) || (T <= 1) ) {
+      ctx.chunk = N;
+      bn128_G2_proj_fft_scale_task( &ctx, 0 );
+    }
+    else {
+      ctx.chunk = (N + T - 1) / T;
+      parallel_for( (N + ctx.chunk - 1) / ctx.chunk , bn128_G2_proj_fft_scale_task, &ctx );
+    }
+  }
+  bn128_G2_proj_fft_normalize( N, tgt );
+}
 
-// -----------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// generating a structured reference string ("powers of tau"), for testing
+//
+// The points are computed in chunks: each chunk computes its scalars, multiplies
+// the generator by them (using the precomputed comb table), and converts the results
+// to affine coordinates with a single inversion. The chunks are distributed among
+// the worker threads, so that no N-sized temporary buffer is needed.
+//
+// In the Lagrange basis of the subgroup generated by `gen` (of size N), we have
+//
+//   L_k(tau) = gen^k * (tau^N - 1) / ( N * (tau - gen^k) )
+//
+// so when `tau` is known, the Lagrange basis costs the same as the monomial one
+// (plus a batched inversion in Fr). Without `tau`, the monomial basis can be
+// converted by an inverse group FFT, which is much slower.
+
+#define SRS_CHUNK 1024
+
+typedef struct {
+  int N;
+  const uint64_t *tau;       // Montgomery repr
+  const uint64_t *gen;       // generator of the subgroup (only for the Lagrange basis)
+  const uint64_t *coeff;     // (tau^N - 1) / N          (only for the Lagrange basis)
+  uint64_t *tgt;
+} bn128_G2_proj_srs_ctx_t;
+
+// multiplies the generator by `n` scalars (in Montgomery repr), with affine output
+void bn128_G2_proj_srs_scale_gen_chunk( int n, const uint64_t *scalars, uint64_t *tgt ) {
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * n );
+  assert( tmp != 0 );
+  for(int i=0; i<n; i++) {
+    bn128_G2_proj_scl_gen_Fr_mont( scalars + i*NLIMBS_R , tmp + i*3*NLIMBS_P );
+  }
+  bn128_G2_proj_batch_to_affine( n , tmp , tgt );
+  free(tmp);
+}
 
-// inverse of 2 (standard repr)
-const uint64_t bn128_G2_proj_oneHalf[4] = { 0x783c14d81ffffffe, 0xaf982f6f0c8d1edd, 0x8f5f7492fcfd4f45, 0x1f37631a3d9cbfac };
+void bn128_G2_proj_srs_monomial_task( void *ctx, int j ) {
+  bn128_G2_proj_srs_ctx_t *c = (bn128_G2_proj_srs_ctx_t*) ctx;
+  int a = j * SRS_CHUNK;
+  int b = a + SRS_CHUNK;
+  if (b > c->N) { b = c->N; }
+  uint64_t *scalars = malloc( 8*NLIMBS_R * (b-a) );
+  assert( scalars != 0 );
+  uint64_t start[NLIMBS_R];
+  bn128_Fr_mont_pow_uint64( c->tau , a , start );
+  bn128_arr_mont_powers( b-a , start , c->tau , scalars );
+  bn128_G2_proj_srs_scale_gen_chunk( b-a , scalars , c->tgt + a*2*NLIMBS_P );
+  free(scalars);
+}
 
-void bn128_G2_proj_fft_inverse_noalloc(int m, int tgt_stride, const uint64_t *gen, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
+// computes `[ tau^i * G | i <- [0..N-1] ]` in affine coordinates, where `G` is the
+// subgroup generator and `tau` is in Fr *in Montgomery repr*
+void bn128_G2_proj_srs_generate( int N, const uint64_t *tau, uint64_t *tgt ) {
+  if (N <= 0) return;
+  bn128_G2_proj_srs_ctx_t ctx;
+  ctx.N     = N;
+  ctx.tau   = tau;
+  ctx.gen   = 0;
+  ctx.coeff = 0;
+  ctx.tgt   = tgt;
+  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , bn128_G2_proj_srs_monomial_task , &ctx );
+}
 
-  if (m==0) {
-    bn128_G2_proj_copy( src, tgt );
-    return;
+void bn128_G2_proj_srs_lagrange_task( void *ctx, int j ) {
+  bn128_G2_proj_srs_ctx_t *c = (bn128_G2_proj_srs_ctx_t*) ctx;
+  int a = j * SRS_CHUNK;
+  int b = a + SRS_CHUNK;
+  if (b > c->N) { b = c->N; }
+  int n = b - a;
+  uint64_t *scalars = malloc( 8*NLIMBS_R * n );
+  uint64_t *denoms  = malloc( 8*NLIMBS_R * n );
+  assert( scalars != 0 );
+  assert( denoms  != 0 );
+
+  // scalars[i] = gen^(a+i)
+  uint64_t start[NLIMBS_R];
+  bn128_Fr_mont_pow_uint64( c->gen , a , start );
+  bn128_arr_mont_powers( n , start , c->gen , scalars );
+
+  if (bn128_Fr_mont_is_zero( c->coeff )) {
+    // tau is in the subgroup, so L_k(tau) is 1 if tau = gen^k and 0 otherwise
+    for(int i=0; i<n; i++) {
+      uint64_t *s = scalars + i*NLIMBS_R;
+      if (bn128_Fr_mont_is_equal( s , c->tau )) { bn128_Fr_mont_set_one( s ); } else { bn128_Fr_mont_set_zero( s ); }
+    }
   }
-
-  if (m==1) {
-    // N = 2
-    bn128_G2_proj_add( src , src + GRP_NLIMBS , tgt                         );   // x + y
-    bn128_G2_proj_sub( src , src + GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );   // x - y
-    bn128_G2_proj_scl_Fr_mont( bn128_G2_proj_oneHalf , tgt                         , tgt                         );      // (x + y)/2
-    bn128_G2_proj_scl_Fr_mont( bn128_G2_proj_oneHalf , tgt + tgt_stride*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );      // (x - y)/2
-    return;
+  else {
+    for(int i=0; i<n; i++) {
+      bn128_Fr_mont_sub( c->tau , scalars + i*NLIMBS_R , denoms + i*NLIMBS_R );
+    }
+    bn128_Fr_mont_batch_inv( n , denoms , denoms );
+    for(int i=0; i<n; i++) {
+      uint64_t *s = scalars + i*NLIMBS_R;
+      bn128_Fr_mont_mul_inplace( s , denoms + i*NLIMBS_R );
+      bn128_Fr_mont_mul_inplace( s , c->coeff );
+    }
   }
 
-  else {
-  
-    int N     = (1<< m   );
-    int halfN = (1<<(m-1));
+  bn128_G2_proj_srs_scale_gen_chunk( n , scalars , c->tgt + a*2*NLIMBS_P );
+  free(denoms);
+  free(scalars);
+}
 
-    uint64_t ginv[NLIMBS_R];
-    bn128_Fr_mont_inv( gen , ginv );  // gen^-1
-
-    uint64_t gpow[NLIMBS_R];    
-    bn128_Fr_mont_copy(bn128_G2_proj_oneHalf , gpow);  // 1/2
-    for(int j=0; j<halfN; j++) {
-      bn128_G2_proj_add( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + j        *GRP_NLIMBS  );    // x + y
-      bn128_G2_proj_sub( src +  j* GRP_NLIMBS , src + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS  );    // x - y
-      bn128_G2_proj_scl_Fr_mont( bn128_G2_proj_oneHalf , buf + j        *GRP_NLIMBS , buf + j        *GRP_NLIMBS );    // (x + y) /  2
-      bn128_G2_proj_scl_Fr_mont( gpow                    , buf + (j+halfN)*GRP_NLIMBS , buf + (j+halfN)*GRP_NLIMBS );    // (x - y) / (2*g^k)
-      bn128_Fr_mont_mul_inplace( gpow , ginv );      
-    }
+// computes `[ L_k(tau) * G | k <- [0..N-1] ]` in affine coordinates, where `N = 2^m`,
+// `L_k` are the Lagrange polynomials of the subgroup generated by `gen`, `G` is the
+// curve subgroup generator, and both `gen` and `tau` are in Fr *in Montgomery repr*
+void bn128_G2_proj_srs_generate_lagrange( int m, const uint64_t *gen, const uint64_t *tau, uint64_t *tgt ) {
+  int N = (1<<m);
+
+  // coeff = (tau^N - 1) / N
+  uint64_t coeff[NLIMBS_R];
+  uint64_t one  [NLIMBS_R];
+  uint64_t size [NLIMBS_R];
+  uint64_t N_std[NLIMBS_R];
+  bn128_Fr_mont_set_one( one );
+  memset( N_std, 0, 8*NLIMBS_R );
+  N_std[0] = N;
+  bn128_Fr_mont_from_std( N_std , size );
+  bn128_Fr_mont_pow_uint64( tau , N , coeff );
+  bn128_Fr_mont_sub_inplace( coeff , one );
+  bn128_Fr_mont_div_inplace( coeff , size );
+
+  bn128_G2_proj_srs_ctx_t ctx;
+  ctx.N     = N;
+  ctx.tau   = tau;
+  ctx.gen   = gen;
+  ctx.coeff = coeff;
+  ctx.tgt   = tgt;
+  parallel_for( (N + SRS_CHUNK - 1) / SRS_CHUNK , bn128_G2_proj_srs_lagrange_task , &ctx );
+}
+
+// converts `[ tau^i * G | i <- [0..N-1] ]` (affine, where `N = 2^m`) to the Lagrange
+// basis of the subgroup generated by `gen` (in Montgomery repr), using the group FFT.
+// This is useful when `tau` is not known; it needs a temporary buffer of N projective points.
+// Note: the output must not overlap with the input
+// The points must be in the prime-order subgroup (as for the group FFT)
+void bn128_G2_proj_srs_monomial_to_lagrange( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt ) {
+  int N = (1<<m);
+  uint64_t *tmp = malloc( 8*3*NLIMBS_P * N );
+  assert( tmp != 0 );
+  bn128_G2_proj_batch_from_affine( N , src , tmp );
+  bn128_G2_proj_fft_inverse( m , gen , tmp , tmp );
+  bn128_G2_proj_batch_to_affine_parallel( N , tmp , tgt );
+  free(tmp);
+}
+
+#undef SRS_CHUNK
+
+//------------------------------------------------------------------------------
+// cofactor clearing
+
+// the endomorphism psi = untwist . Frobenius . twist of the twisted curve;
+// in affine coordinates psi(x,y) = (cx*conj(x), cy*conj(y))
+const uint64_t bn128_G2_proj_psi_cx[8] = { 0xb5773b104563ab30, 0x347f91c8a9aa6454, 0x7a007127242e0991, 0x1956bcd8118214ec, 0x6e849f1ea0aa4757, 0xaa1c7b6d89f89141, 0xb6e713cdfae0ca3a, 0x26694fbb4e82ebc3 };
+const uint64_t bn128_G2_proj_psi_cy[8] = { 0xe4bbdd0c2936b629, 0xbb30f162e133bacb, 0x31a9d1b6f9645366, 0x253570bea500f8dd, 0xa1d77ce45ffe77c7, 0x07affd117826d1db, 0x6d16bd27bb7edc6b, 0x2c87200285defecc };
+
+void bn128_G2_proj_psi( const uint64_t *src1, uint64_t *tgt ) {
+  bn128_Fp2_mont_conjugate( X1, X3 );
+  bn128_Fp2_mont_conjugate( Y1, Y3 );
+  bn128_Fp2_mont_conjugate( Z1, Z3 );
+  bn128_Fp2_mont_mul_inplace( X3, bn128_G2_proj_psi_cx );
+  bn128_Fp2_mont_mul_inplace( Y3, bn128_G2_proj_psi_cy );
+}
 
-    bn128_Fr_mont_sqr( gen, gpow );  // gen^2
-    bn128_G2_proj_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf                    , buf + N*GRP_NLIMBS , tgt                         );
-    bn128_G2_proj_fft_inverse_noalloc( m-1 , tgt_stride<<1 , gpow , buf + halfN*GRP_NLIMBS , buf + N*GRP_NLIMBS , tgt + tgt_stride*GRP_NLIMBS );
+// the trace of Frobenius t = 6x^2 + 1 = 147946756881789318990833708069417712967
+const uint64_t bn128_G2_proj_frobenius_trace[2] = { 0xf83e9682e87cfd47, 0x6f4d8248eeb859fb };
+
+// maps a curve point into the subgroup G2, by multiplying with
+// the effective cofactor h_eff = 21888242871839275222246405745257275088844257914179612981679871602714643921549
+void bn128_G2_proj_clear_cofactor( const uint64_t *src , uint64_t *tgt ) {
+  // [h]P = [t](P + psi(P)) - P - psi^2(P), as h = p - 1 + t and psi^2 - [t]psi + [p] = 0
+  uint64_t t1[3*NLIMBS_P];
+  uint64_t t2[3*NLIMBS_P];
+  uint64_t t3[3*NLIMBS_P];
+  bn128_G2_proj_psi( src, t1 );
+  bn128_G2_proj_psi( t1, t2 );                   // t2 = psi^2(P)
+  bn128_G2_proj_add_inplace( t1, src );
+  bn128_G2_proj_scl_generic( bn128_G2_proj_frobenius_trace, t1, t3, 2 );
+  bn128_G2_proj_sub_inplace( t3, src );
+  bn128_G2_proj_sub( t3, t2, tgt );
+}
 
+//------------------------------------------------------------------------------
+// hashing to the curve (RFC 9380)
+//
+//   hash_to_curve(msg)   = clear_cofactor( map_to_curve(u0) + map_to_curve(u1) )
+//   encode_to_curve(msg) = clear_cofactor( map_to_curve(u) )
+//
+// where the field elements u0,u1 (resp. u) come from `hash_to_field`, which
+// uses expand_message_xmd with SHA-256. The map to the curve is
+// the Shallue-van de Woestijne map.
+//
+// Each map needs a single inversion; when hashing many messages, these inversions
+// (and the final conversion to affine coordinates) are batched together.
+
+#define H2C_L         48       // number of bytes per prime field element
+#define H2C_M         2        // extension degree of the base field
+#define H2C_NLIMBS_FP 4
+
+// (2^(64*(H2C_NLIMBS_FP-1)) * R^2) mod p, for reducing the hashed bytes into Fp
+const uint64_t bn128_G2_proj_h2c_bytes_hi_scale[4] = { 0x546d01727eaa3ef9, 0xfefbac5857489fad, 0x09e1756a39352261, 0x1eefbf060a6e1a7d };
+
+// interprets `H2C_L` big-endian bytes as an integer, and reduces it modulo p
+// (into Montgomery representation). The integer is split as hi*2^(64*(n-1)) + lo
+// where both `hi` and `lo` are smaller than p.
+void bn128_G2_proj_h2c_bytes_to_Fp( const uint8_t *src, uint64_t *tgt ) {
+  uint64_t ws[H2C_L/8];
+  uint64_t lo[H2C_NLIMBS_FP];
+  uint64_t hi[H2C_NLIMBS_FP];
+  uint64_t tmp[H2C_NLIMBS_FP];
+  for(int i=0; i<H2C_L/8; i++) {
+    const uint8_t *q = src + H2C_L - 8*(i+1);
+    uint64_t w = 0;
+    for(int j=0; j<8; j++) { w = (w << 8) | q[j]; }
+    ws[i] = w;
   }
+  memset( lo, 0, 8*H2C_NLIMBS_FP );
+  memset( hi, 0, 8*H2C_NLIMBS_FP );
+  memcpy( lo, ws                    , 8*(H2C_NLIMBS_FP-1) );
+  memcpy( hi, ws + (H2C_NLIMBS_FP-1), 8*(H2C_L/8 - H2C_NLIMBS_FP + 1) );
+  bn128_Fp_mont_from_std( lo, tmp );
+  bn128_Fp_mont_mul( hi, bn128_G2_proj_h2c_bytes_hi_scale, tgt );
+  bn128_Fp_mont_add_inplace( tgt, tmp );
 }
- 
-// inverse FFT of group elements (convert from [tau^i] to [L_k(tau)]
-// `src` and `tgt` should be `N = 2^m` sized arrays of group elements
-// `gen` should be the generator of the multiplicative subgroup (of the scalar field) sized `N`, in _Montgomery_ representation
-// NOTE: we normalize the results
-void bn128_G2_proj_fft_inverse(int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt) {
-  int N = (1<<m);
-  uint64_t *buf = malloc( 8*GRP_NLIMBS * (2*N) );
-  assert( buf !=0 );
-  bn128_G2_proj_fft_inverse_noalloc( m, 1, gen, src, buf, tgt );
-  free(buf);
-  for(int i=0; i<N; i++) { 
-    bn128_G2_proj_normalize_inplace( tgt + i*GRP_NLIMBS );
+
+// hashes a message to `count` elements of the base field (in Montgomery
+// representation). Returns 0 if `count` is too big for expand_message_xmd.
+uint8_t bn128_G2_proj_hash_to_field( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int count, uint64_t *tgt ) {
+  int len = count * H2C_M * H2C_L;
+  uint8_t *bytes = malloc( len );
+  assert( bytes != 0 );
+  if (!expand_message_xmd_sha256( dst, dst_len, msg, msg_len, len, bytes )) {
+    free(bytes);
+    return 0;
+  }
+  for(int i=0; i<count*H2C_M; i++) {
+    bn128_G2_proj_h2c_bytes_to_Fp( bytes + i*H2C_L, tgt + i*H2C_NLIMBS_FP );
   }
+  free(bytes);
+  return 1;
 }
 
-// -----------------------------------------------------------------------------
+// the "sign" of a field element (RFC 9380, section 4.1)
+uint8_t bn128_G2_proj_h2c_sgn0( const uint64_t *src ) {
+  uint64_t std[H2C_NLIMBS_FP];
+  bn128_Fp_mont_to_std( src, std );
+  uint8_t sign = (std[0] & 1);
+  uint8_t zero = bn128_Fp_mont_is_zero( src );
+  bn128_Fp_mont_to_std( src + H2C_NLIMBS_FP, std );
+  return sign | (zero & (std[0] & 1));
+}
+
+// computes x^3 + a*x + b
+void bn128_G2_proj_h2c_rhs( const uint64_t *a, const uint64_t *b, const uint64_t *x, uint64_t *tgt ) {
+  uint64_t t[NLIMBS_P];
+  bn128_Fp2_mont_sqr( x, t );
+  bn128_Fp2_mont_add_inplace( t, a );
+  bn128_Fp2_mont_mul( t, x, tgt );
+  bn128_Fp2_mont_add_inplace( tgt, b );
+}
+
+// the constants of the Shallue-van de Woestijne map
+const uint64_t bn128_G2_proj_h2c_Z[8] = { 0xd35d438dc58f0d9d, 0x0a78eb28f5c70b3d, 0x666ea36f7879462c, 0x0e0a77c19a07df2f, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bn128_G2_proj_h2c_c1[8] = { 0xd335f05a64ca12fe, 0x75029bbec388940d, 0xd4d64ba9406d402e, 0x02baef80fc5ae772, 0x38e7ecccd1dcff67, 0x65f0b37d93ce0d3e, 0xd749d0dd22ac00aa, 0x0141b9ce4a688d4d };
+const uint64_t bn128_G2_proj_h2c_c2[8] = { 0xb461a4448976f7d5, 0xc6843fb439555fa7, 0x28f0d12384840918, 0x112ceb58a394e07d, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bn128_G2_proj_h2c_c3[8] = { 0xaaad0cab9a24277f, 0xf2209f5b7e5b757a, 0xc3a46b7e850013a7, 0x1f9e7f3768c5c9af, 0x412278c8de85d863, 0xfe3e4c7f559d375a, 0x5e44b9da0a96ad23, 0x297d818d387725c8 };
+const uint64_t bn128_G2_proj_h2c_c4[8] = { 0x63cdc796b49b3a32, 0x73a8220d40eb16f6, 0xb46d1eed55c49000, 0x1c9ef4f5f0528b82, 0x9aeb505b1600fe13, 0x64eb25e9f8b4638f, 0x43edd9e4fdf1577a, 0x2eb756b528a63917 };
+
+// the denominator (1 - c1*u^2)*(1 + c1*u^2) of the Shallue-van de Woestijne map;
+// its inverse is the only one needed by `map_to_curve_inv`
+void bn128_G2_proj_map_to_curve_denom( const uint64_t *u, uint64_t *den ) {
+  uint64_t t1[NLIMBS_P];
+  uint64_t t2[NLIMBS_P];
+  bn128_Fp2_mont_sqr( u, t1 );
+  bn128_Fp2_mont_mul_inplace( t1, bn128_G2_proj_h2c_c1 );        // c1*u^2
+  bn128_Fp2_mont_set_one( t2 );
+  bn128_Fp2_mont_sub( t2, t1, den );                       // 1 - c1*u^2
+  bn128_Fp2_mont_add_inplace( t1, t2 );                    // 1 + c1*u^2
+  bn128_Fp2_mont_mul_inplace( den, t1 );
+}
+
+// the Shallue-van de Woestijne map (RFC 9380, section 6.6.1), given the inverse
+// of the denominator (or zero if the denominator is zero)
+void bn128_G2_proj_map_to_curve_inv( const uint64_t *u, const uint64_t *inv_den, uint64_t *tgt ) {
+  uint64_t tv1[NLIMBS_P];
+  uint64_t tv2[NLIMBS_P];
+  uint64_t tv4[NLIMBS_P];
+  uint64_t x  [NLIMBS_P];
+  uint64_t gx [NLIMBS_P];
+  uint64_t y  [NLIMBS_P];
+  bn128_Fp2_mont_sqr( u, x );
+  bn128_Fp2_mont_mul_inplace( x, bn128_G2_proj_h2c_c1 );         // c1*u^2
+  bn128_Fp2_mont_set_one( y );
+  bn128_Fp2_mont_sub( y, x, tv1 );                         // tv1 = 1 - c1*u^2
+  bn128_Fp2_mont_add( y, x, tv2 );                         // tv2 = 1 + c1*u^2
+  bn128_Fp2_mont_mul( u, tv1, tv4 );
+  bn128_Fp2_mont_mul_inplace( tv4, inv_den );
+  bn128_Fp2_mont_mul_inplace( tv4, bn128_G2_proj_h2c_c3 );       // tv4 = c3 * u / (1 + c1*u^2)
+  bn128_Fp2_mont_sub( bn128_G2_proj_h2c_c2, tv4, x );             // x1 = c2 - tv4
+  bn128_G2_proj_h2c_rhs( bn128_G2_proj_const_A, bn128_G2_proj_const_B, x, gx );
+  if (!bn128_Fp2_mont_sqrt( gx, y )) {
+    bn128_Fp2_mont_add( bn128_G2_proj_h2c_c2, tv4, x );           // x2 = c2 + tv4
+    bn128_G2_proj_h2c_rhs( bn128_G2_proj_const_A, bn128_G2_proj_const_B, x, gx );
+    if (!bn128_Fp2_mont_sqrt( gx, y )) {
+      // x3 = Z + c4 * ( (1 + c1*u^2)^2 / ((1 - c1*u^2)*(1 + c1*u^2)) )^2
+      bn128_Fp2_mont_sqr( tv2, x );
+      bn128_Fp2_mont_mul_inplace( x, inv_den );
+      bn128_Fp2_mont_sqr_inplace( x );
+      bn128_Fp2_mont_mul_inplace( x, bn128_G2_proj_h2c_c4 );
+      bn128_Fp2_mont_add_inplace( x, bn128_G2_proj_h2c_Z );
+      bn128_G2_proj_h2c_rhs( bn128_G2_proj_const_A, bn128_G2_proj_const_B, x, gx );
+      bn128_Fp2_mont_sqrt( gx, y );
+    }
+  }
+  if (bn128_G2_proj_h2c_sgn0( u ) != bn128_G2_proj_h2c_sgn0( y )) {
+    bn128_Fp2_mont_neg_inplace( y );
+  }
+  bn128_Fp2_mont_copy( x, X3 );
+  bn128_Fp2_mont_copy( y, Y3 );
+  bn128_Fp2_mont_set_one( Z3 );
+}
 
+// maps a base field element to the curve (projective coordinates)
+void bn128_G2_proj_map_to_curve( const uint64_t *u, uint64_t *tgt ) {
+  uint64_t den[NLIMBS_P];
+  bn128_G2_proj_map_to_curve_denom( u, den );
+  if (!bn128_Fp2_mont_is_zero( den )) { bn128_Fp2_mont_inv_inplace( den ); }
+  bn128_G2_proj_map_to_curve_inv( u, den, tgt );
+}
+
+// hashes a message to the subgroup (`hash_to_curve` of RFC 9380)
+void bn128_G2_proj_hash_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {
+  uint64_t u [2*NLIMBS_P];
+  uint64_t q0[3*NLIMBS_P];
+  uint64_t q1[3*NLIMBS_P];
+  bn128_G2_proj_hash_to_field( dst, dst_len, msg, msg_len, 2, u );
+  bn128_G2_proj_map_to_curve( u           , q0 );
+  bn128_G2_proj_map_to_curve( u + NLIMBS_P, q1 );
+  bn128_G2_proj_add_inplace( q0, q1 );
+  bn128_G2_proj_clear_cofactor( q0, tgt );
+}
+
+// the non-uniform variant `encode_to_curve` of RFC 9380
+void bn128_G2_proj_encode_to_curve( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt ) {
+  uint64_t u[NLIMBS_P];
+  uint64_t q[3*NLIMBS_P];
+  bn128_G2_proj_hash_to_field( dst, dst_len, msg, msg_len, 1, u );
+  bn128_G2_proj_map_to_curve( u, q );
+  bn128_G2_proj_clear_cofactor( q, tgt );
+}
+
+// hashes `n` messages (concatenated in `msgs`, with lengths `msg_lens`) to the
+// subgroup, with affine output. The result is the same as calling `hash_to_curve`
+// for each message, but the 2*n inversions in the maps are done as a single
+// batched inversion, and so is the conversion to affine coordinates.
+void bn128_G2_proj_hash_to_curve_batch( int n, const uint8_t *dst, int dst_len, const uint8_t *msgs, const int *msg_lens, uint64_t *tgt ) {
+  if (n <= 0) return;
+  uint64_t *us   = malloc( 8 * NLIMBS_P * 2*n );
+  uint64_t *dens = malloc( 8 * NLIMBS_P * 2*n );
+  uint64_t *pts  = malloc( 8 * 3*NLIMBS_P * 2*n );
+  uint8_t  *zero = malloc( 2*n );
+  assert( us != 0 && dens != 0 && pts != 0 && zero != 0 );
+  uint64_t tmp[3*NLIMBS_P];
+
+  const uint8_t *msg = msgs;
+  for(int i=0; i<n; i++) {
+    bn128_G2_proj_hash_to_field( dst, dst_len, msg, msg_lens[i], 2, us + 2*i*NLIMBS_P );
+    msg += msg_lens[i];
+  }
+
+  // the (extremely unlikely) zero denominators are replaced by 1 before the
+  // batched inversion, and their "inverses" are set back to zero afterwards
+  for(int i=0; i<2*n; i++) {
+    bn128_G2_proj_map_to_curve_denom( us + i*NLIMBS_P, dens + i*NLIMBS_P );
+    zero[i] = bn128_Fp2_mont_is_zero( dens + i*NLIMBS_P );
+    if (zero[i]) { bn128_Fp2_mont_set_one( dens + i*NLIMBS_P ); }
+  }
+  bn128_Fp2_mont_batch_inv( 2*n, dens, dens );
+  for(int i=0; i<2*n; i++) {
+    if (zero[i]) { bn128_Fp2_mont_set_zero( dens + i*NLIMBS_P ); }
+    bn128_G2_proj_map_to_curve_inv( us + i*NLIMBS_P, dens + i*NLIMBS_P, pts + i*3*NLIMBS_P );
+  }
+
+  // the i-th result overwrites the (already used) i-th point
+  for(int i=0; i<n; i++) {
+    bn128_G2_proj_add( pts + (2*i)*3*NLIMBS_P, pts + (2*i+1)*3*NLIMBS_P, tmp );
+    bn128_G2_proj_clear_cofactor( tmp, pts + i*3*NLIMBS_P );
+  }
+  bn128_G2_proj_batch_to_affine( n, pts, tgt );
+
+  free(zero);
+  free(pts);
+  free(dens);
+  free(us);
+}
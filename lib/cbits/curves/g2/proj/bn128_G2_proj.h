@@ -8,6 +8,7 @@ extern void bn128_G2_proj_from_affine ( const uint64_t *src , uint64_t *tgt );
 extern void bn128_G2_proj_to_affine   ( const uint64_t *src , uint64_t *tgt );
 extern void bn128_G2_proj_batch_from_affine( int N, const uint64_t *src , uint64_t *tgt );
 extern void bn128_G2_proj_batch_to_affine  ( int N, const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_proj_batch_to_affine_parallel( int N, const uint64_t *src , uint64_t *tgt );
 
 extern uint8_t bn128_G2_proj_is_on_curve   ( const uint64_t *src );
 extern uint8_t bn128_G2_proj_is_infinity   ( const uint64_t *src );
@@ -40,6 +41,13 @@ extern void bn128_G2_proj_scl_small  (       uint64_t  kst , const uint64_t *src
 extern void bn128_G2_proj_scl_naive   ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );
 extern void bn128_G2_proj_scl_windowed( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );
 
+extern void bn128_G2_proj_dbl_ct( const uint64_t *src ,       uint64_t *tgt );
+extern void bn128_G2_proj_add_ct( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+
+extern void bn128_G2_proj_scl_ct_generic( const uint64_t *kst , const uint64_t *src , uint64_t *tgt , int kst_len );
+extern void bn128_G2_proj_scl_ct_Fr_std ( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_proj_scl_ct_Fr_mont( const uint64_t *kst , const uint64_t *src , uint64_t *tgt );
+
 extern void bn128_G2_proj_MSM_std_coeff_proj_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs);
 extern void bn128_G2_proj_MSM_mont_coeff_proj_out(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs);
 extern void bn128_G2_proj_MSM_std_coeff_affine_out (int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs);
@@ -47,3 +55,21 @@ extern void bn128_G2_proj_MSM_mont_coeff_affine_out(int npoints, const uint64_t
 extern void bn128_G2_proj_MSM_std_coeff_projc_out_slow_reference(int npoints, const uint64_t *expos, const uint64_t *grps, uint64_t *tgt, int expo_nlimbs);
 extern void bn128_G2_proj_fft_forward( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt );
 extern void bn128_G2_proj_fft_inverse( int m, const uint64_t *gen, const uint64_t *src, uint64_t *tgt );
+extern int  bn128_G2_proj_comb_table_nwords();
+extern void bn128_G2_proj_comb_precompute ( const uint64_t *src , uint64_t *table );
+extern void bn128_G2_proj_comb_scl_Fr_std ( const uint64_t *table , const uint64_t *kst , uint64_t *tgt );
+extern void bn128_G2_proj_comb_scl_Fr_mont( const uint64_t *table , const uint64_t *kst , uint64_t *tgt );
+extern void bn128_G2_proj_scl_gen_Fr_std  ( const uint64_t *kst , uint64_t *tgt );
+extern void bn128_G2_proj_scl_gen_Fr_mont ( const uint64_t *kst , uint64_t *tgt );
+extern void bn128_G2_proj_srs_generate           ( int N, const uint64_t *tau , uint64_t *tgt );
+extern void bn128_G2_proj_srs_generate_lagrange  ( int m, const uint64_t *gen , const uint64_t *tau , uint64_t *tgt );
+extern void bn128_G2_proj_srs_monomial_to_lagrange( int m, const uint64_t *gen , const uint64_t *src , uint64_t *tgt );
+
+extern void bn128_G2_proj_clear_cofactor( const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_proj_psi           ( const uint64_t *src , uint64_t *tgt );
+
+extern uint8_t bn128_G2_proj_hash_to_field     ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int count, uint64_t *tgt );
+extern void    bn128_G2_proj_map_to_curve      ( const uint64_t *u, uint64_t *tgt );
+extern void    bn128_G2_proj_hash_to_curve     ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt );
+extern void    bn128_G2_proj_encode_to_curve   ( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, uint64_t *tgt );
+extern void    bn128_G2_proj_hash_to_curve_batch( int n, const uint8_t *dst, int dst_len, const uint8_t *msgs, const int *msg_lens, uint64_t *tgt );
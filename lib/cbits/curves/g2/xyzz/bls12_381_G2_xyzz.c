@@ -0,0 +1,297 @@
+
+// elliptic curve "BLS12-381 ( Fp2 ) " in XYZZ coordinates, Montgomery field representation
+//
+// NOTE: generated code, do not edit!
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "bls12_381_G2_xyzz.h"
+#include "bls12_381_G2_affine.h"
+#include "bls12_381_Fp2_mont.h"
+
+#define NLIMBS_P 12
+
+#define X1   (src1)
+#define Y1   (src1 + 12)
+#define ZZ1  (src1 + 24)
+#define ZZZ1 (src1 + 36)
+
+#define X2   (src2)
+#define Y2   (src2 + 12)
+#define ZZ2  (src2 + 24)
+#define ZZZ2 (src2 + 36)
+
+#define X3   (tgt)
+#define Y3   (tgt + 12)
+#define ZZ3  (tgt + 24)
+#define ZZZ3 (tgt + 36)
+
+// the constants A and B of the equation
+const uint64_t bls12_381_G2_xyzz_const_A[12] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bls12_381_G2_xyzz_const_B[12] = { 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e, 0xaa270000000cfff3, 0x53cc0032fc34000a, 0x478fe97a6b0a807f, 0xb1d37ebee6ba24d7, 0x8ec9733bbf78ab2f, 0x09d645513d83de7e };
+
+//------------------------------------------------------------------------------
+
+void bls12_381_G2_xyzz_set_infinity( uint64_t *tgt ) {
+  bls12_381_Fp2_mont_set_one ( X3  );
+  bls12_381_Fp2_mont_set_one ( Y3  );
+  bls12_381_Fp2_mont_set_zero( ZZ3 );
+  bls12_381_Fp2_mont_set_zero( ZZZ3 );
+}
+
+uint8_t bls12_381_G2_xyzz_is_infinity( const uint64_t *src1 ) {
+  return bls12_381_Fp2_mont_is_zero( ZZ1 );
+}
+
+void bls12_381_G2_xyzz_copy( const uint64_t *src1, uint64_t *tgt ) {
+  if (tgt != src1) { memcpy( tgt, src1, 384 ); }
+}
+
+// checks the curve equation `Y^2 = X^3 + A*X*ZZ^2 + B*ZZ^3` and `ZZ^3 = ZZZ^2`
+uint8_t bls12_381_G2_xyzz_is_on_curve( const uint64_t *src1 ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) return 1;
+  uint64_t zz2[12];
+  uint64_t zz3[12];
+  uint64_t   a[12];
+  uint64_t   b[12];
+  bls12_381_Fp2_mont_sqr( ZZ1 , zz2 );               // zz2 = ZZ^2
+  bls12_381_Fp2_mont_mul( ZZ1 , zz2 , zz3 );         // zz3 = ZZ^3
+  bls12_381_Fp2_mont_sqr( ZZZ1 , a );                // a   = ZZZ^2
+  if (!bls12_381_Fp2_mont_is_equal( a , zz3 )) return 0;
+  bls12_381_Fp2_mont_sqr( X1 , a );                  // a   = X^2
+  bls12_381_Fp2_mont_mul_inplace( a , X1 );          // a   = X^3 + A*X*ZZ^2
+  bls12_381_Fp2_mont_mul( bls12_381_G2_xyzz_const_B , zz3 , b );    // b   = B*ZZ^3
+  bls12_381_Fp2_mont_add_inplace( a , b );           // a   = X^3 + A*X*ZZ^2 + B*ZZ^3
+  bls12_381_Fp2_mont_sqr( Y1 , b );                  // b   = Y^2
+  return bls12_381_Fp2_mont_is_equal( a , b );
+}
+
+// checks whether two points are equal (as points of the curve)
+uint8_t bls12_381_G2_xyzz_is_equal( const uint64_t *src1, const uint64_t *src2 ) {
+  uint8_t inf1 = bls12_381_G2_xyzz_is_infinity( src1 );
+  uint8_t inf2 = bls12_381_G2_xyzz_is_infinity( src2 );
+  if (inf1 || inf2) { return (inf1 && inf2); }
+  uint64_t a[12];
+  uint64_t b[12];
+  bls12_381_Fp2_mont_mul( X1 , ZZ2 , a );
+  bls12_381_Fp2_mont_mul( X2 , ZZ1 , b );
+  if (!bls12_381_Fp2_mont_is_equal( a , b )) return 0;
+  bls12_381_Fp2_mont_mul( Y1 , ZZZ2 , a );
+  bls12_381_Fp2_mont_mul( Y2 , ZZZ1 , b );
+  return bls12_381_Fp2_mont_is_equal( a , b );
+}
+
+// converts from affine coordinates
+void bls12_381_G2_xyzz_from_affine( const uint64_t *src1, uint64_t *tgt ) {
+  if (bls12_381_G2_affine_is_infinity( src1 )) {
+    bls12_381_G2_xyzz_set_infinity( tgt );
+    return;
+  }
+  memcpy( tgt, src1, 192 );
+  bls12_381_Fp2_mont_set_one( ZZ3  );
+  bls12_381_Fp2_mont_set_one( ZZZ3 );
+}
+
+// converts to affine coordinates:
+//   x = X/ZZ , y = Y/ZZZ
+// since `ZZ^3 = ZZZ^2`, we have `1/ZZ = (ZZ/ZZZ)^2`, so a single inversion is enough
+void bls12_381_G2_xyzz_to_affine( const uint64_t *src1, uint64_t *tgt ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_G2_affine_set_infinity( tgt );
+    return;
+  }
+  uint64_t iZZZ[12];
+  uint64_t  iZZ[12];
+  bls12_381_Fp2_mont_inv( ZZZ1 , iZZZ );             // iZZZ = 1/ZZZ
+  bls12_381_Fp2_mont_mul( ZZ1 , iZZZ , iZZ );        //      = ZZ/ZZZ
+  bls12_381_Fp2_mont_sqr_inplace( iZZ );             // iZZ  = 1/ZZ
+  bls12_381_Fp2_mont_mul( X1 , iZZ  , tgt );
+  bls12_381_Fp2_mont_mul( Y1 , iZZZ , tgt + 12 );
+}
+
+// converts to homogeneous projective coordinates, with `Z = ZZ*ZZZ`
+void bls12_381_G2_xyzz_to_proj( const uint64_t *src1, uint64_t *tgt ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_Fp2_mont_set_zero( tgt );
+    bls12_381_Fp2_mont_set_one ( tgt + 12 );
+    bls12_381_Fp2_mont_set_zero( tgt + 24 );
+    return;
+  }
+  uint64_t ZZ[12];
+  bls12_381_Fp2_mont_copy( ZZ1 , ZZ );               // careful, `src1` and `tgt` can overlap
+  bls12_381_Fp2_mont_mul( ZZ1 , ZZZ1 , tgt + 24 ); // Z = ZZ*ZZZ
+  bls12_381_Fp2_mont_mul( X1  , ZZZ1 , tgt );        // X = X*ZZZ
+  bls12_381_Fp2_mont_mul( Y1  , ZZ   , tgt + 12 );  // Y = Y*ZZ
+}
+
+// converts to Jacobian projective coordinates, with `Z = ZZZ`:
+// since `Z^2 = ZZ^3`, we have `X = X*ZZ^2` and `Y = Y*ZZZ^2`
+void bls12_381_G2_xyzz_to_jac( const uint64_t *src1, uint64_t *tgt ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_Fp2_mont_set_one ( tgt );
+    bls12_381_Fp2_mont_set_one ( tgt + 12 );
+    bls12_381_Fp2_mont_set_zero( tgt + 24 );
+    return;
+  }
+  uint64_t a[12];
+  uint64_t b[12];
+  bls12_381_Fp2_mont_sqr( ZZ1  , a );                // a = ZZ^2
+  bls12_381_Fp2_mont_sqr( ZZZ1 , b );                // b = ZZZ^2
+  bls12_381_Fp2_mont_copy( ZZZ1 , tgt + 24 );      // Z = ZZZ
+  bls12_381_Fp2_mont_mul( X1 , a , tgt );            // X = X*ZZ^2
+  bls12_381_Fp2_mont_mul( Y1 , b , tgt + 12 );      // Y = Y*ZZZ^2
+}
+
+// negates an elliptic curve point
+void bls12_381_G2_xyzz_neg( const uint64_t *src1, uint64_t *tgt ) {
+  if (tgt != src1) { memcpy( tgt, src1, 384 ); }
+  bls12_381_Fp2_mont_neg_inplace( Y3 );
+}
+
+void bls12_381_G2_xyzz_neg_inplace( uint64_t *tgt ) {
+  bls12_381_Fp2_mont_neg_inplace( Y3 );
+}
+
+// doubles an elliptic curve point
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#doubling-dbl-2008-s-1>
+void bls12_381_G2_xyzz_dbl( const uint64_t *src1, uint64_t *tgt ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_G2_xyzz_set_infinity( tgt );
+    return;
+  }
+  uint64_t U[12];
+  uint64_t V[12];
+  uint64_t W[12];
+  uint64_t S[12];
+  uint64_t M[12];
+  bls12_381_Fp2_mont_add( Y1 , Y1 , U );             // U   = 2*Y1
+  bls12_381_Fp2_mont_sqr( U , V );                   // V   = U^2
+  bls12_381_Fp2_mont_mul( U , V , W );               // W   = U*V
+  bls12_381_Fp2_mont_mul( X1 , V , S );              // S   = X1*V
+  bls12_381_Fp2_mont_sqr( X1 , M );                  //     = X1^2
+  bls12_381_Fp2_mont_add( M , M , U );               //     = 2*X1^2
+  bls12_381_Fp2_mont_add_inplace( M , U );           // M   = 3*X1^2
+  bls12_381_Fp2_mont_mul( W , Y1 , U );              // U  := W*Y1
+  bls12_381_Fp2_mont_mul( V , ZZ1 , ZZ3 );           // ZZ3  = V*ZZ1
+  bls12_381_Fp2_mont_mul( W , ZZZ1 , ZZZ3 );         // ZZZ3 = W*ZZZ1
+  bls12_381_Fp2_mont_sqr( M , X3 );                  //      = M^2
+  bls12_381_Fp2_mont_sub_inplace( X3 , S );          //      = M^2 - S
+  bls12_381_Fp2_mont_sub_inplace( X3 , S );          // X3   = M^2 - 2*S
+  bls12_381_Fp2_mont_sub_inplace( S , X3 );          // S   := S - X3
+  bls12_381_Fp2_mont_mul( M , S , Y3 );              //      = M*(S-X3)
+  bls12_381_Fp2_mont_sub_inplace( Y3 , U );          // Y3   = M*(S-X3) - W*Y1
+}
+
+void bls12_381_G2_xyzz_dbl_inplace( uint64_t *tgt ) {
+  bls12_381_G2_xyzz_dbl( tgt , tgt );
+}
+
+// adds two elliptic curve points
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-add-2008-s>
+void bls12_381_G2_xyzz_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_G2_xyzz_copy( src2 , tgt );
+    return;
+  }
+  if (bls12_381_G2_xyzz_is_infinity( src2 )) {
+    bls12_381_G2_xyzz_copy( src1 , tgt );
+    return;
+  }
+  uint64_t U1[12];
+  uint64_t S1[12];
+  uint64_t  P[12];
+  uint64_t  R[12];
+  uint64_t PP[12];
+  uint64_t PPP[12];
+  uint64_t  Q[12];
+  bls12_381_Fp2_mont_mul( X1 , ZZ2  , U1 );          // U1 = X1*ZZ2
+  bls12_381_Fp2_mont_mul( X2 , ZZ1  , P  );          // U2 = X2*ZZ1
+  bls12_381_Fp2_mont_sub_inplace( P , U1 );          // P  = U2 - U1
+  bls12_381_Fp2_mont_mul( Y1 , ZZZ2 , S1 );          // S1 = Y1*ZZZ2
+  bls12_381_Fp2_mont_mul( Y2 , ZZZ1 , R  );          // S2 = Y2*ZZZ1
+  bls12_381_Fp2_mont_sub_inplace( R , S1 );          // R  = S2 - S1
+  if (bls12_381_Fp2_mont_is_zero( P )) {
+    if (bls12_381_Fp2_mont_is_zero( R )) {
+      // the two points are the same
+      bls12_381_G2_xyzz_dbl( src1 , tgt );
+    }
+    else {
+      // the two points are negatives of each other
+      bls12_381_G2_xyzz_set_infinity( tgt );
+    }
+    return;
+  }
+  bls12_381_Fp2_mont_sqr( P , PP );                  // PP   = P^2
+  bls12_381_Fp2_mont_mul( P , PP , PPP );            // PPP  = P*PP
+  bls12_381_Fp2_mont_mul( U1 , PP , Q );             // Q    = U1*PP
+  bls12_381_Fp2_mont_mul_inplace( S1 , PPP );        // S1  := S1*PPP
+  bls12_381_Fp2_mont_mul( ZZ1  , ZZ2  , ZZ3  );      //      = ZZ1*ZZ2
+  bls12_381_Fp2_mont_mul_inplace( ZZ3 , PP );        // ZZ3  = ZZ1*ZZ2*PP
+  bls12_381_Fp2_mont_mul( ZZZ1 , ZZZ2 , ZZZ3 );      //      = ZZZ1*ZZZ2
+  bls12_381_Fp2_mont_mul_inplace( ZZZ3 , PPP );      // ZZZ3 = ZZZ1*ZZZ2*PPP
+  bls12_381_Fp2_mont_sqr( R , X3 );                  //      = R^2
+  bls12_381_Fp2_mont_sub_inplace( X3 , PPP );        //      = R^2 - PPP
+  bls12_381_Fp2_mont_sub_inplace( X3 , Q );          //      = R^2 - PPP - Q
+  bls12_381_Fp2_mont_sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q
+  bls12_381_Fp2_mont_sub_inplace( Q , X3 );          // Q   := Q - X3
+  bls12_381_Fp2_mont_mul( R , Q , Y3 );              //      = R*(Q-X3)
+  bls12_381_Fp2_mont_sub_inplace( Y3 , S1 );         // Y3   = R*(Q-X3) - S1*PPP
+}
+
+void bls12_381_G2_xyzz_add_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bls12_381_G2_xyzz_add( tgt , src2 , tgt );
+}
+
+// adds an XYZZ point (src1) and an affine point (src2), costing 8M + 2S
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-madd-2008-s>
+void bls12_381_G2_xyzz_madd_xyzz_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bls12_381_G2_affine_is_infinity( src2 )) {
+    bls12_381_G2_xyzz_copy( src1 , tgt );
+    return;
+  }
+  if (bls12_381_G2_xyzz_is_infinity( src1 )) {
+    bls12_381_G2_xyzz_from_affine( src2 , tgt );
+    return;
+  }
+  uint64_t  P[12];
+  uint64_t  R[12];
+  uint64_t PP[12];
+  uint64_t PPP[12];
+  uint64_t  Q[12];
+  uint64_t  T[12];
+  bls12_381_Fp2_mont_mul( X2 , ZZ1  , P );           //      = X2*ZZ1
+  bls12_381_Fp2_mont_sub_inplace( P , X1 );          // P    = X2*ZZ1 - X1
+  bls12_381_Fp2_mont_mul( Y2 , ZZZ1 , R );           //      = Y2*ZZZ1
+  bls12_381_Fp2_mont_sub_inplace( R , Y1 );          // R    = Y2*ZZZ1 - Y1
+  if (bls12_381_Fp2_mont_is_zero( P )) {
+    if (bls12_381_Fp2_mont_is_zero( R )) {
+      // the two points are the same
+      bls12_381_G2_xyzz_dbl( src1 , tgt );
+    }
+    else {
+      // the two points are negatives of each other
+      bls12_381_G2_xyzz_set_infinity( tgt );
+    }
+    return;
+  }
+  bls12_381_Fp2_mont_sqr( P , PP );                  // PP   = P^2
+  bls12_381_Fp2_mont_mul( P , PP , PPP );            // PPP  = P*PP
+  bls12_381_Fp2_mont_mul( X1 , PP , Q );             // Q    = X1*PP
+  bls12_381_Fp2_mont_mul( Y1 , PPP , T );            // T    = Y1*PPP
+  bls12_381_Fp2_mont_mul( ZZ1  , PP  , ZZ3  );       // ZZ3  = ZZ1*PP
+  bls12_381_Fp2_mont_mul( ZZZ1 , PPP , ZZZ3 );       // ZZZ3 = ZZZ1*PPP
+  bls12_381_Fp2_mont_sqr( R , X3 );                  //      = R^2
+  bls12_381_Fp2_mont_sub_inplace( X3 , PPP );        //      = R^2 - PPP
+  bls12_381_Fp2_mont_sub_inplace( X3 , Q );          //      = R^2 - PPP - Q
+  bls12_381_Fp2_mont_sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q
+  bls12_381_Fp2_mont_sub_inplace( Q , X3 );          // Q   := Q - X3
+  bls12_381_Fp2_mont_mul( R , Q , Y3 );              //      = R*(Q-X3)
+  bls12_381_Fp2_mont_sub_inplace( Y3 , T );          // Y3   = R*(Q-X3) - Y1*PPP
+}
+
+void bls12_381_G2_xyzz_madd_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bls12_381_G2_xyzz_madd_xyzz_aff( tgt , src2 , tgt );
+}
@@ -0,0 +1,297 @@
+
+// elliptic curve "BN128 ( Fp2 ) " in XYZZ coordinates, Montgomery field representation
+//
+// NOTE: generated code, do not edit!
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "bn128_G2_xyzz.h"
+#include "bn128_G2_affine.h"
+#include "bn128_Fp2_mont.h"
+
+#define NLIMBS_P 8
+
+#define X1   (src1)
+#define Y1   (src1 + 8)
+#define ZZ1  (src1 + 16)
+#define ZZZ1 (src1 + 24)
+
+#define X2   (src2)
+#define Y2   (src2 + 8)
+#define ZZ2  (src2 + 16)
+#define ZZZ2 (src2 + 24)
+
+#define X3   (tgt)
+#define Y3   (tgt + 8)
+#define ZZ3  (tgt + 16)
+#define ZZZ3 (tgt + 24)
+
+// the constants A and B of the equation
+const uint64_t bn128_G2_xyzz_const_A[8] = { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
+const uint64_t bn128_G2_xyzz_const_B[8] = { 0x3bf938e377b802a8, 0x020b1b273633535d, 0x26b7edf049755260, 0x2514c6324384a86d, 0x38e7ecccd1dcff67, 0x65f0b37d93ce0d3e, 0xd749d0dd22ac00aa, 0x0141b9ce4a688d4d };
+
+//------------------------------------------------------------------------------
+
+void bn128_G2_xyzz_set_infinity( uint64_t *tgt ) {
+  bn128_Fp2_mont_set_one ( X3  );
+  bn128_Fp2_mont_set_one ( Y3  );
+  bn128_Fp2_mont_set_zero( ZZ3 );
+  bn128_Fp2_mont_set_zero( ZZZ3 );
+}
+
+uint8_t bn128_G2_xyzz_is_infinity( const uint64_t *src1 ) {
+  return bn128_Fp2_mont_is_zero( ZZ1 );
+}
+
+void bn128_G2_xyzz_copy( const uint64_t *src1, uint64_t *tgt ) {
+  if (tgt != src1) { memcpy( tgt, src1, 256 ); }
+}
+
+// checks the curve equation `Y^2 = X^3 + A*X*ZZ^2 + B*ZZ^3` and `ZZ^3 = ZZZ^2`
+uint8_t bn128_G2_xyzz_is_on_curve( const uint64_t *src1 ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) return 1;
+  uint64_t zz2[8];
+  uint64_t zz3[8];
+  uint64_t   a[8];
+  uint64_t   b[8];
+  bn128_Fp2_mont_sqr( ZZ1 , zz2 );               // zz2 = ZZ^2
+  bn128_Fp2_mont_mul( ZZ1 , zz2 , zz3 );         // zz3 = ZZ^3
+  bn128_Fp2_mont_sqr( ZZZ1 , a );                // a   = ZZZ^2
+  if (!bn128_Fp2_mont_is_equal( a , zz3 )) return 0;
+  bn128_Fp2_mont_sqr( X1 , a );                  // a   = X^2
+  bn128_Fp2_mont_mul_inplace( a , X1 );          // a   = X^3 + A*X*ZZ^2
+  bn128_Fp2_mont_mul( bn128_G2_xyzz_const_B , zz3 , b );    // b   = B*ZZ^3
+  bn128_Fp2_mont_add_inplace( a , b );           // a   = X^3 + A*X*ZZ^2 + B*ZZ^3
+  bn128_Fp2_mont_sqr( Y1 , b );                  // b   = Y^2
+  return bn128_Fp2_mont_is_equal( a , b );
+}
+
+// checks whether two points are equal (as points of the curve)
+uint8_t bn128_G2_xyzz_is_equal( const uint64_t *src1, const uint64_t *src2 ) {
+  uint8_t inf1 = bn128_G2_xyzz_is_infinity( src1 );
+  uint8_t inf2 = bn128_G2_xyzz_is_infinity( src2 );
+  if (inf1 || inf2) { return (inf1 && inf2); }
+  uint64_t a[8];
+  uint64_t b[8];
+  bn128_Fp2_mont_mul( X1 , ZZ2 , a );
+  bn128_Fp2_mont_mul( X2 , ZZ1 , b );
+  if (!bn128_Fp2_mont_is_equal( a , b )) return 0;
+  bn128_Fp2_mont_mul( Y1 , ZZZ2 , a );
+  bn128_Fp2_mont_mul( Y2 , ZZZ1 , b );
+  return bn128_Fp2_mont_is_equal( a , b );
+}
+
+// converts from affine coordinates
+void bn128_G2_xyzz_from_affine( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_G2_affine_is_infinity( src1 )) {
+    bn128_G2_xyzz_set_infinity( tgt );
+    return;
+  }
+  memcpy( tgt, src1, 128 );
+  bn128_Fp2_mont_set_one( ZZ3  );
+  bn128_Fp2_mont_set_one( ZZZ3 );
+}
+
+// converts to affine coordinates:
+//   x = X/ZZ , y = Y/ZZZ
+// since `ZZ^3 = ZZZ^2`, we have `1/ZZ = (ZZ/ZZZ)^2`, so a single inversion is enough
+void bn128_G2_xyzz_to_affine( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_G2_affine_set_infinity( tgt );
+    return;
+  }
+  uint64_t iZZZ[8];
+  uint64_t  iZZ[8];
+  bn128_Fp2_mont_inv( ZZZ1 , iZZZ );             // iZZZ = 1/ZZZ
+  bn128_Fp2_mont_mul( ZZ1 , iZZZ , iZZ );        //      = ZZ/ZZZ
+  bn128_Fp2_mont_sqr_inplace( iZZ );             // iZZ  = 1/ZZ
+  bn128_Fp2_mont_mul( X1 , iZZ  , tgt );
+  bn128_Fp2_mont_mul( Y1 , iZZZ , tgt + 8 );
+}
+
+// converts to homogeneous projective coordinates, with `Z = ZZ*ZZZ`
+void bn128_G2_xyzz_to_proj( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_Fp2_mont_set_zero( tgt );
+    bn128_Fp2_mont_set_one ( tgt + 8 );
+    bn128_Fp2_mont_set_zero( tgt + 16 );
+    return;
+  }
+  uint64_t ZZ[8];
+  bn128_Fp2_mont_copy( ZZ1 , ZZ );               // careful, `src1` and `tgt` can overlap
+  bn128_Fp2_mont_mul( ZZ1 , ZZZ1 , tgt + 16 ); // Z = ZZ*ZZZ
+  bn128_Fp2_mont_mul( X1  , ZZZ1 , tgt );        // X = X*ZZZ
+  bn128_Fp2_mont_mul( Y1  , ZZ   , tgt + 8 );  // Y = Y*ZZ
+}
+
+// converts to Jacobian projective coordinates, with `Z = ZZZ`:
+// since `Z^2 = ZZ^3`, we have `X = X*ZZ^2` and `Y = Y*ZZZ^2`
+void bn128_G2_xyzz_to_jac( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_Fp2_mont_set_one ( tgt );
+    bn128_Fp2_mont_set_one ( tgt + 8 );
+    bn128_Fp2_mont_set_zero( tgt + 16 );
+    return;
+  }
+  uint64_t a[8];
+  uint64_t b[8];
+  bn128_Fp2_mont_sqr( ZZ1  , a );                // a = ZZ^2
+  bn128_Fp2_mont_sqr( ZZZ1 , b );                // b = ZZZ^2
+  bn128_Fp2_mont_copy( ZZZ1 , tgt + 16 );      // Z = ZZZ
+  bn128_Fp2_mont_mul( X1 , a , tgt );            // X = X*ZZ^2
+  bn128_Fp2_mont_mul( Y1 , b , tgt + 8 );      // Y = Y*ZZZ^2
+}
+
+// negates an elliptic curve point
+void bn128_G2_xyzz_neg( const uint64_t *src1, uint64_t *tgt ) {
+  if (tgt != src1) { memcpy( tgt, src1, 256 ); }
+  bn128_Fp2_mont_neg_inplace( Y3 );
+}
+
+void bn128_G2_xyzz_neg_inplace( uint64_t *tgt ) {
+  bn128_Fp2_mont_neg_inplace( Y3 );
+}
+
+// doubles an elliptic curve point
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#doubling-dbl-2008-s-1>
+void bn128_G2_xyzz_dbl( const uint64_t *src1, uint64_t *tgt ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_G2_xyzz_set_infinity( tgt );
+    return;
+  }
+  uint64_t U[8];
+  uint64_t V[8];
+  uint64_t W[8];
+  uint64_t S[8];
+  uint64_t M[8];
+  bn128_Fp2_mont_add( Y1 , Y1 , U );             // U   = 2*Y1
+  bn128_Fp2_mont_sqr( U , V );                   // V   = U^2
+  bn128_Fp2_mont_mul( U , V , W );               // W   = U*V
+  bn128_Fp2_mont_mul( X1 , V , S );              // S   = X1*V
+  bn128_Fp2_mont_sqr( X1 , M );                  //     = X1^2
+  bn128_Fp2_mont_add( M , M , U );               //     = 2*X1^2
+  bn128_Fp2_mont_add_inplace( M , U );           // M   = 3*X1^2
+  bn128_Fp2_mont_mul( W , Y1 , U );              // U  := W*Y1
+  bn128_Fp2_mont_mul( V , ZZ1 , ZZ3 );           // ZZ3  = V*ZZ1
+  bn128_Fp2_mont_mul( W , ZZZ1 , ZZZ3 );         // ZZZ3 = W*ZZZ1
+  bn128_Fp2_mont_sqr( M , X3 );                  //      = M^2
+  bn128_Fp2_mont_sub_inplace( X3 , S );          //      = M^2 - S
+  bn128_Fp2_mont_sub_inplace( X3 , S );          // X3   = M^2 - 2*S
+  bn128_Fp2_mont_sub_inplace( S , X3 );          // S   := S - X3
+  bn128_Fp2_mont_mul( M , S , Y3 );              //      = M*(S-X3)
+  bn128_Fp2_mont_sub_inplace( Y3 , U );          // Y3   = M*(S-X3) - W*Y1
+}
+
+void bn128_G2_xyzz_dbl_inplace( uint64_t *tgt ) {
+  bn128_G2_xyzz_dbl( tgt , tgt );
+}
+
+// adds two elliptic curve points
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-add-2008-s>
+void bn128_G2_xyzz_add( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_G2_xyzz_copy( src2 , tgt );
+    return;
+  }
+  if (bn128_G2_xyzz_is_infinity( src2 )) {
+    bn128_G2_xyzz_copy( src1 , tgt );
+    return;
+  }
+  uint64_t U1[8];
+  uint64_t S1[8];
+  uint64_t  P[8];
+  uint64_t  R[8];
+  uint64_t PP[8];
+  uint64_t PPP[8];
+  uint64_t  Q[8];
+  bn128_Fp2_mont_mul( X1 , ZZ2  , U1 );          // U1 = X1*ZZ2
+  bn128_Fp2_mont_mul( X2 , ZZ1  , P  );          // U2 = X2*ZZ1
+  bn128_Fp2_mont_sub_inplace( P , U1 );          // P  = U2 - U1
+  bn128_Fp2_mont_mul( Y1 , ZZZ2 , S1 );          // S1 = Y1*ZZZ2
+  bn128_Fp2_mont_mul( Y2 , ZZZ1 , R  );          // S2 = Y2*ZZZ1
+  bn128_Fp2_mont_sub_inplace( R , S1 );          // R  = S2 - S1
+  if (bn128_Fp2_mont_is_zero( P )) {
+    if (bn128_Fp2_mont_is_zero( R )) {
+      // the two points are the same
+      bn128_G2_xyzz_dbl( src1 , tgt );
+    }
+    else {
+      // the two points are negatives of each other
+      bn128_G2_xyzz_set_infinity( tgt );
+    }
+    return;
+  }
+  bn128_Fp2_mont_sqr( P , PP );                  // PP   = P^2
+  bn128_Fp2_mont_mul( P , PP , PPP );            // PPP  = P*PP
+  bn128_Fp2_mont_mul( U1 , PP , Q );             // Q    = U1*PP
+  bn128_Fp2_mont_mul_inplace( S1 , PPP );        // S1  := S1*PPP
+  bn128_Fp2_mont_mul( ZZ1  , ZZ2  , ZZ3  );      //      = ZZ1*ZZ2
+  bn128_Fp2_mont_mul_inplace( ZZ3 , PP );        // ZZ3  = ZZ1*ZZ2*PP
+  bn128_Fp2_mont_mul( ZZZ1 , ZZZ2 , ZZZ3 );      //      = ZZZ1*ZZZ2
+  bn128_Fp2_mont_mul_inplace( ZZZ3 , PPP );      // ZZZ3 = ZZZ1*ZZZ2*PPP
+  bn128_Fp2_mont_sqr( R , X3 );                  //      = R^2
+  bn128_Fp2_mont_sub_inplace( X3 , PPP );        //      = R^2 - PPP
+  bn128_Fp2_mont_sub_inplace( X3 , Q );          //      = R^2 - PPP - Q
+  bn128_Fp2_mont_sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q
+  bn128_Fp2_mont_sub_inplace( Q , X3 );          // Q   := Q - X3
+  bn128_Fp2_mont_mul( R , Q , Y3 );              //      = R*(Q-X3)
+  bn128_Fp2_mont_sub_inplace( Y3 , S1 );         // Y3   = R*(Q-X3) - S1*PPP
+}
+
+void bn128_G2_xyzz_add_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bn128_G2_xyzz_add( tgt , src2 , tgt );
+}
+
+// adds an XYZZ point (src1) and an affine point (src2), costing 8M + 2S
+// <https://hyperelliptic.org/EFD/g1p/auto-shortw-xyzz.html#addition-madd-2008-s>
+void bn128_G2_xyzz_madd_xyzz_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) {
+  if (bn128_G2_affine_is_infinity( src2 )) {
+    bn128_G2_xyzz_copy( src1 , tgt );
+    return;
+  }
+  if (bn128_G2_xyzz_is_infinity( src1 )) {
+    bn128_G2_xyzz_from_affine( src2 , tgt );
+    return;
+  }
+  uint64_t  P[8];
+  uint64_t  R[8];
+  uint64_t PP[8];
+  uint64_t PPP[8];
+  uint64_t  Q[8];
+  uint64_t  T[8];
+  bn128_Fp2_mont_mul( X2 , ZZ1  , P );           //      = X2*ZZ1
+  bn128_Fp2_mont_sub_inplace( P , X1 );          // P    = X2*ZZ1 - X1
+  bn128_Fp2_mont_mul( Y2 , ZZZ1 , R );           //      = Y2*ZZZ1
+  bn128_Fp2_mont_sub_inplace( R , Y1 );          // R    = Y2*ZZZ1 - Y1
+  if (bn128_Fp2_mont_is_zero( P )) {
+    if (bn128_Fp2_mont_is_zero( R )) {
+      // the two points are the same
+      bn128_G2_xyzz_dbl( src1 , tgt );
+    }
+    else {
+      // the two points are negatives of each other
+      bn128_G2_xyzz_set_infinity( tgt );
+    }
+    return;
+  }
+  bn128_Fp2_mont_sqr( P , PP );                  // PP   = P^2
+  bn128_Fp2_mont_mul( P , PP , PPP );            // PPP  = P*PP
+  bn128_Fp2_mont_mul( X1 , PP , Q );             // Q    = X1*PP
+  bn128_Fp2_mont_mul( Y1 , PPP , T );            // T    = Y1*PPP
+  bn128_Fp2_mont_mul( ZZ1  , PP  , ZZ3  );       // ZZ3  = ZZ1*PP
+  bn128_Fp2_mont_mul( ZZZ1 , PPP , ZZZ3 );       // ZZZ3 = ZZZ1*PPP
+  bn128_Fp2_mont_sqr( R , X3 );                  //      = R^2
+  bn128_Fp2_mont_sub_inplace( X3 , PPP );        //      = R^2 - PPP
+  bn128_Fp2_mont_sub_inplace( X3 , Q );          //      = R^2 - PPP - Q
+  bn128_Fp2_mont_sub_inplace( X3 , Q );          // X3   = R^2 - PPP - 2*Q
+  bn128_Fp2_mont_sub_inplace( Q , X3 );          // Q   := Q - X3
+  bn128_Fp2_mont_mul( R , Q , Y3 );              //      = R*(Q-X3)
+  bn128_Fp2_mont_sub_inplace( Y3 , T );          // Y3   = R*(Q-X3) - Y1*PPP
+}
+
+void bn128_G2_xyzz_madd_inplace( uint64_t *tgt, const uint64_t *src2 ) {
+  bn128_G2_xyzz_madd_xyzz_aff( tgt , src2 , tgt );
+}
@@ -0,0 +1,23 @@
+#include <stdint.h>
+
+extern void    bn128_G2_xyzz_set_infinity(       uint64_t *tgt );
+extern uint8_t bn128_G2_xyzz_is_infinity ( const uint64_t *src );
+extern void    bn128_G2_xyzz_copy        ( const uint64_t *src , uint64_t *tgt );
+
+extern uint8_t bn128_G2_xyzz_is_on_curve ( const uint64_t *src );
+extern uint8_t bn128_G2_xyzz_is_equal    ( const uint64_t *src1, const uint64_t *src2 );
+
+extern void bn128_G2_xyzz_from_affine ( const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_xyzz_to_affine   ( const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_xyzz_to_proj     ( const uint64_t *src , uint64_t *tgt );
+extern void bn128_G2_xyzz_to_jac      ( const uint64_t *src , uint64_t *tgt );
+
+extern void bn128_G2_xyzz_neg        ( const uint64_t *src ,       uint64_t *tgt );
+extern void bn128_G2_xyzz_dbl        ( const uint64_t *src ,       uint64_t *tgt );
+extern void bn128_G2_xyzz_add        ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+extern void bn128_G2_xyzz_madd_xyzz_aff( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+
+extern void bn128_G2_xyzz_neg_inplace (       uint64_t *tgt );
+extern void bn128_G2_xyzz_dbl_inplace (       uint64_t *tgt );
+extern void bn128_G2_xyzz_add_inplace (       uint64_t *tgt , const uint64_t *src2 );
+extern void bn128_G2_xyzz_madd_inplace(       uint64_t *tgt , const uint64_t *src2 );
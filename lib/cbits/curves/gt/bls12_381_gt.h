@@ -0,0 +1,17 @@
+#include <stdint.h>
+
+uint8_t bls12_381_gt_is_cyclotomic  (const uint64_t *src);
+uint8_t bls12_381_gt_is_in_subgroup (const uint64_t *src);
+
+void bls12_381_gt_pow_Fr_std (const uint64_t *src, const uint64_t *expo, uint64_t *tgt);
+void bls12_381_gt_pow_Fr_mont(const uint64_t *src, const uint64_t *expo, uint64_t *tgt);
+void bls12_381_gt_pow_gen    (const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len);
+
+void bls12_381_gt_compress        (const uint64_t *src, uint64_t *tgt);
+void bls12_381_gt_decompress      (const uint64_t *src, uint64_t *tgt);
+void bls12_381_gt_batch_decompress(int n, const uint64_t *src, uint64_t *tgt);
+
+// for testing purposes:
+void bls12_381_gt_phi      (const uint64_t *src, uint64_t *tgt);
+void bls12_381_gt_pow_lambda(const uint64_t *src, uint64_t *tgt);
+void bls12_381_gt_decompose(const uint64_t *expo, uint64_t *digits);
@@ -0,0 +1,284 @@
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+#include "assert.h"
+
+#include "curves/fields/mont/bn128_Fr_mont.h"
+#include "curves/fields/mont/bn128_Fp_mont.h"
+#include "curves/fields/mont/bn128_Fp2_mont.h"
+#include "curves/fields/mont/bn128_Fp6_mont.h"
+#include "curves/fields/mont/bn128_Fp12_mont.h"
+
+#include "curves/pairing/bn128_pairing.h"
+
+//------------------------------------------------------------------------------
+
+#define NWORDS_FR   4
+#define NWORDS_FP   4
+#define NWORDS_FP2  8
+#define NWORDS_FP6  24
+#define NWORDS_FP12 48
+
+//------------------------------------------------------------------------------
+
+// On GT, the Frobenius acts as exponentiation by `p = lambda0 (mod r)`,
+// where `lambda0 = 6*x^2` (x being the BN parameter).
+// We use `phi = frobenius` and `lambda = lambda0`, which is 127 bits.
+
+#define GT_NDIGITS    2
+#define GT_DIGIT_BITS 128
+
+const uint64_t bn128_gt_lambda[2] = { 0xf83e9682e87cfd46, 0x6f4d8248eeb859fb };
+
+void bn128_gt_phi(const uint64_t *src, uint64_t *tgt) {
+  bn128_Fp12_mont_frobenius( src , tgt );
+}
+
+//------------------------------------------------------------------------------
+// GLS-style exponentiation
+
+// Divides the `n`-word number `a` by `lambda` (bitwise long division).
+// The quotient overwrites `a`, the remainder (two words) goes into `rem`.
+// Note: `lambda < 2^127`, so the shifted remainder always fits into two words.
+void bn128_gt_divmod_lambda(int n, uint64_t *a, uint64_t *rem) {
+  const uint64_t l0 = bn128_gt_lambda[0];
+  const uint64_t l1 = bn128_gt_lambda[1];
+  uint64_t r0 = 0;
+  uint64_t r1 = 0;
+  for(int i=64*n-1; i>=0; i--) {
+    uint64_t mask = (1ULL << (i & 63));
+    r1 = (r1 << 1) | (r0 >> 63);
+    r0 = (r0 << 1) | ((a[i>>6] & mask) ? 1 : 0);
+    a[i>>6] &= ~mask;
+    if ( (r1 > l1) || (r1 == l1 && r0 >= l0) ) {
+      uint64_t borrow = (r0 < l0) ? 1 : 0;
+      r0 -= l0;
+      r1 -= l1 + borrow;
+      a[i>>6] |= mask;
+    }
+  }
+  rem[0] = r0;
+  rem[1] = r1;
+}
+
+// Decomposes an exponent `0 <= e < r` (in standard representation) in base `lambda`:
+//
+//   e = sum_j e_j * lambda^j
+//
+// into GT_NDIGITS digits, each of them fitting into GT_DIGIT_BITS bits.
+// The digits are stored in two words each.
+void bn128_gt_decompose(const uint64_t *expo, uint64_t *digits) {
+  uint64_t a[NWORDS_FR];
+  memcpy( a , expo , 8*NWORDS_FR );
+  for(int j=0; j<GT_NDIGITS-1; j++) {
+    bn128_gt_divmod_lambda( NWORDS_FR , a , digits + 2*j );
+  }
+  digits[2*(GT_NDIGITS-1)  ] = a[0];
+  digits[2*(GT_NDIGITS-1)+1] = a[1];
+}
+
+#define GT_WINDOW     4
+#define GT_WINDOW_MASK ((1<<GT_WINDOW) - 1)
+#define GT_TABLE_SIZE ((1<<GT_WINDOW) - 1)
+
+#define TABLE(j,k) (table + ((j)*GT_TABLE_SIZE + (k))*NWORDS_FP12)
+
+// Exponentiation in GT by an element of Fr (in standard representation).
+// With the decomposition `e = sum_j e_j * lambda^j` above, we have
+//
+//   g^e = prod_j phi^j(g)^(e_j)
+//
+// which is computed as a multi-exponentiation with fixed windows, the (cyclotomic)
+// squarings being shared between the GT_NDIGITS bases. Only the table of the first
+// base is computed by multiplications, the other ones are its images under `phi`.
+//
+// Note: the input must be in GT (the decomposition is not valid outside of it);
+// for arbitrary cyclotomic elements use `pow_gen` instead.
+void bn128_gt_pow_Fr_std(const uint64_t *src, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t digits[2*GT_NDIGITS];
+  bn128_gt_decompose( expo , digits );
+
+  // TABLE(j,k) = phi^j(src)^(k+1)
+  uint64_t *table = malloc( 8*NWORDS_FP12 * GT_NDIGITS * GT_TABLE_SIZE );
+  assert( table != 0 );
+  bn128_Fp12_mont_copy( src , TABLE(0,0) );
+  bn128_pairing_cyclotomic_sqr( src , TABLE(0,1) );
+  for(int k=2; k<GT_TABLE_SIZE; k++) {
+    bn128_Fp12_mont_mul( TABLE(0,k-1) , src , TABLE(0,k) );
+  }
+  for(int j=1; j<GT_NDIGITS; j++) {
+    for(int k=0; k<GT_TABLE_SIZE; k++) {
+      bn128_gt_phi( TABLE(j-1,k) , TABLE(j,k) );
+    }
+  }
+
+  uint64_t acc[NWORDS_FP12];
+  bn128_Fp12_mont_set_one( acc );
+  int started = 0;
+  for(int i=GT_DIGIT_BITS-GT_WINDOW; i>=0; i-=GT_WINDOW) {
+    if (started) {
+      for(int s=0; s<GT_WINDOW; s++) { bn128_pairing_cyclotomic_sqr( acc , acc ); }
+    }
+    for(int j=0; j<GT_NDIGITS; j++) {
+      int k = (digits[2*j + (i>>6)] >> (i & 63)) & GT_WINDOW_MASK;
+      if (k) {
+        bn128_Fp12_mont_mul_inplace( acc , TABLE(j,k-1) );
+        started = 1;
+      }
+    }
+  }
+
+  bn128_Fp12_mont_copy( acc , tgt );
+  free(table);
+}
+
+// Exponentiation in GT by an element of Fr (in Montgomery representation)
+void bn128_gt_pow_Fr_mont(const uint64_t *src, const uint64_t *expo, uint64_t *tgt) {
+  uint64_t std[NWORDS_FR];
+  bn128_Fr_mont_to_std( expo , std );
+  bn128_gt_pow_Fr_std( src , std , tgt );
+}
+
+// Exponentiation of an element of the cyclotomic subgroup by an arbitrary
+// nonnegative exponent of `expo_len` words, using cyclotomic squarings and
+// fixed windows. Unlike `pow_Fr_std`, this does not assume that the input is in GT.
+void bn128_gt_pow_gen(const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len) {
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !((expo[(nbits-1)>>6] >> ((nbits-1) & 63)) & 1) ) { nbits--; }
+  if (nbits == 0) {
+    bn128_Fp12_mont_set_one( tgt );
+    return;
+  }
+
+  uint64_t table[GT_TABLE_SIZE*NWORDS_FP12];
+  bn128_Fp12_mont_copy( src , table );
+  bn128_pairing_cyclotomic_sqr( src , table + NWORDS_FP12 );
+  for(int k=2; k<GT_TABLE_SIZE; k++) {
+    bn128_Fp12_mont_mul( table + (k-1)*NWORDS_FP12 , src , table + k*NWORDS_FP12 );
+  }
+
+  // the windows are aligned, so they never straddle a word boundary
+  int nwin = (nbits + GT_WINDOW - 1) / GT_WINDOW;
+  uint64_t acc[NWORDS_FP12];
+  for(int w=nwin-1; w>=0; w--) {
+    int i = w*GT_WINDOW;
+    int k = (expo[i>>6] >> (i & 63)) & GT_WINDOW_MASK;
+    if (w == nwin-1) {
+      bn128_Fp12_mont_copy( table + (k-1)*NWORDS_FP12 , acc );
+    }
+    else {
+      for(int s=0; s<GT_WINDOW; s++) { bn128_pairing_cyclotomic_sqr( acc , acc ); }
+      if (k) { bn128_Fp12_mont_mul_inplace( acc , table + (k-1)*NWORDS_FP12 ); }
+    }
+  }
+
+  bn128_Fp12_mont_copy( acc , tgt );
+}
+
+#undef TABLE
+
+
+// f^lambda = f^(6*x^2), for cyclotomic f
+void bn128_gt_pow_lambda(const uint64_t *src, uint64_t *tgt) {
+  bn128_gt_pow_gen( src , bn128_gt_lambda , tgt , 2 );
+}
+
+//------------------------------------------------------------------------------
+// membership tests
+
+// Checks whether an Fp12 element is in the cyclotomic subgroup, that is,
+// whether it is nonzero and `f^(p^4-p^2+1) = 1`
+uint8_t bn128_gt_is_cyclotomic(const uint64_t *src) {
+  if (bn128_Fp12_mont_is_zero( src )) return 0;
+  uint64_t a[NWORDS_FP12];
+  uint64_t b[NWORDS_FP12];
+  bn128_Fp12_mont_frobenius_k( src , 4 , a );
+  bn128_Fp12_mont_mul_inplace( a , src );
+  bn128_Fp12_mont_frobenius_2( src , b );
+  return bn128_Fp12_mont_is_equal( a , b );
+}
+
+// Checks whether an Fp12 element is in GT, the subgroup of order `r`.
+// The order of a cyclotomic element divides `p^4-p^2+1`, and `phi(f) = f^lambda`
+// means that it also divides `p - lambda0` (see above); the gcd of these is `r`.
+// This is much cheaper than computing `f^r`.
+uint8_t bn128_gt_is_in_subgroup(const uint64_t *src) {
+  if (!bn128_gt_is_cyclotomic( src )) return 0;
+  uint64_t a[NWORDS_FP12];
+  uint64_t b[NWORDS_FP12];
+  bn128_gt_phi      ( src , a );
+  bn128_gt_pow_lambda( src , b );
+  return bn128_Fp12_mont_is_equal( a , b );
+}
+
+
+//------------------------------------------------------------------------------
+// torus-based compression
+
+// Compression using the algebraic torus T2(Fp6). An element `f = a + b*w` of the
+// cyclotomic subgroup has norm `a^2 - v*b^2 = 1`, and if `f != 1,-1`, it is determined
+// by the single Fp6 element `c = (1+a)/b`, via `f = (c + w) / (c - w)`.
+// This halves the size of GT elements. The identity is encoded by `c = 0` (which
+// would otherwise correspond to -1, but that is not in GT).
+void bn128_gt_compress(const uint64_t *src, uint64_t *tgt) {
+  if (bn128_Fp6_mont_is_zero( src + NWORDS_FP6 )) {
+    bn128_Fp6_mont_set_zero( tgt );
+    return;
+  }
+  uint64_t t[NWORDS_FP6];
+  bn128_Fp6_mont_set_one   ( t );
+  bn128_Fp6_mont_add_inplace( t , src );
+  bn128_Fp6_mont_div( t , src + NWORDS_FP6 , tgt );
+}
+
+// computes the numerator `c^2 + v` and the denominator `c^2 - v` of the
+// `1` coefficient of the decompressed element
+void bn128_gt_decompress_num_den(const uint64_t *c, uint64_t *num, uint64_t *den) {
+  uint64_t one[NWORDS_FP2];
+  bn128_Fp2_mont_set_one( one );
+  bn128_Fp6_mont_sqr( c , num );
+  bn128_Fp6_mont_copy( num , den );
+  bn128_Fp2_mont_add_inplace( num + NWORDS_FP2 , one );
+  bn128_Fp2_mont_sub_inplace( den + NWORDS_FP2 , one );
+}
+
+// finishes the decompression, given `c^2 + v` and `1 / (c^2 - v)`:
+//   f = (c^2 + v + 2c*w) / (c^2 - v)
+void bn128_gt_decompress_finish(const uint64_t *c, const uint64_t *num, const uint64_t *den_inv, uint64_t *tgt) {
+  if (bn128_Fp6_mont_is_zero( c )) {
+    bn128_Fp12_mont_set_one( tgt );
+    return;
+  }
+  bn128_Fp6_mont_mul( num , den_inv , tgt );
+  bn128_Fp6_mont_add( c , c , tgt + NWORDS_FP6 );
+  bn128_Fp6_mont_mul_inplace( tgt + NWORDS_FP6 , den_inv );
+}
+
+// Decompression from T2(Fp6). Note: the result always has norm 1, but it is not
+// necessarily in GT; for untrusted inputs, use `is_in_subgroup` to check it
+void bn128_gt_decompress(const uint64_t *src, uint64_t *tgt) {
+  uint64_t num[NWORDS_FP6];
+  uint64_t den[NWORDS_FP6];
+  bn128_gt_decompress_num_den( src , num , den );
+  bn128_Fp6_mont_inv_inplace( den );
+  bn128_gt_decompress_finish( src , num , den , tgt );
+}
+
+// Decompresses `n` elements at the same time, sharing the inversions (since
+// `v` is not a square in Fp6, the denominators are never zero)
+void bn128_gt_batch_decompress(int n, const uint64_t *src, uint64_t *tgt) {
+  if (n <= 0) return;
+  uint64_t *num = malloc( 8*NWORDS_FP6 * n );
+  uint64_t *den = malloc( 8*NWORDS_FP6 * n );
+  assert( num != 0 );
+  assert( den != 0 );
+  for(int i=0; i<n; i++) {
+    bn128_gt_decompress_num_den( src + i*NWORDS_FP6 , num + i*NWORDS_FP6 , den + i*NWORDS_FP6 );
+  }
+  bn128_Fp6_mont_batch_inv( n , den , den );
+  for(int i=0; i<n; i++) {
+    bn128_gt_decompress_finish( src + i*NWORDS_FP6 , num + i*NWORDS_FP6 , den + i*NWORDS_FP6 , tgt + i*NWORDS_FP12 );
+  }
+  free(den);
+  free(num);
+}
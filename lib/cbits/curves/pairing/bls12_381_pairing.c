@@ -5,6 +5,7 @@
 
 #include "curves/fields/mont/bls12_381_Fp_mont.h"
 #include "curves/fields/mont/bls12_381_Fp2_mont.h"
+#include "curves/fields/mont/bls12_381_Fp6_mont.h"
 #include "curves/fields/mont/bls12_381_Fp12_mont.h"
 
 #include "curves/g1/affine/bls12_381_G1_affine.h"
@@ -12,10 +13,13 @@
 #include "curves/g1/proj/bls12_381_G1_proj.h"
 #include "curves/g2/proj/bls12_381_G2_proj.h"
 
+#include "parallel.h"
+
 //------------------------------------------------------------------------------
 
 #define NWORDS_FP   6
 #define NWORDS_FP2  12
+#define NWORDS_FP6  36
 #define NWORDS_FP12 72
 
 //------------------------------------------------------------------------------
@@ -89,6 +93,82 @@ void bls12_381_pairing_combine_w3_w2_1(const uint64_t *C, const uint64_t* B, con
   memcpy( tgt                 , A , 8*NWORDS_FP2 );
 }
 
+//------------------------------------------------------------------------------
+// sparse multiplication by line functions
+//
+// Fp12 = Fp6[w]/(w^2-v) and Fp6 = Fp2[v]/(v^3-xi), so the line functions above
+// have only 3 nonzero Fp2 coefficients (out of 6). The Fp2 coefficient `3*i+j`
+// belongs to `v^j * w^i`.
+
+extern uint64_t bls12_381_Fp6_mont_irred_coeffs[];
+
+// multiplication by the non-residue `xi = v^3` in Fp2
+void bls12_381_pairing_fp2_mul_by_xi(const uint64_t *src, uint64_t *tgt) {
+  bls12_381_Fp2_mont_mul( src , bls12_381_Fp6_mont_irred_coeffs , tgt );
+  bls12_381_Fp2_mont_neg_inplace( tgt );
+}
+
+// multiplication by `v` in Fp6
+void bls12_381_pairing_fp6_mul_by_v(const uint64_t *src, uint64_t *tgt) {
+  uint64_t tmp[NWORDS_FP2];
+  bls12_381_pairing_fp2_mul_by_xi( src + 2*NWORDS_FP2 , tmp );
+  bls12_381_Fp2_mont_copy( src +   NWORDS_FP2 , tgt + 2*NWORDS_FP2 );
+  bls12_381_Fp2_mont_copy( src                , tgt +   NWORDS_FP2 );
+  bls12_381_Fp2_mont_copy( tmp                , tgt                );
+}
+
+// multiplication in Fp6 by the sparse element `b0 + b1*v` (5 Fp2 multiplications)
+void bls12_381_pairing_fp6_mul_by_01(const uint64_t *src, const uint64_t *b0, const uint64_t *b1, uint64_t *tgt) {
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+  uint64_t s [NWORDS_FP2];
+  uint64_t u [NWORDS_FP2];
+  uint64_t z1[NWORDS_FP2];
+  const uint64_t *x0 = src;
+  const uint64_t *x1 = src +   NWORDS_FP2;
+  const uint64_t *x2 = src + 2*NWORDS_FP2;
+
+  bls12_381_Fp2_mont_mul( x0 , b0 , t0 );               // t0 = x0*b0
+  bls12_381_Fp2_mont_mul( x1 , b1 , t1 );               // t1 = x1*b1
+  bls12_381_Fp2_mont_add( x0 , x1 , s  );
+  bls12_381_Fp2_mont_add( b0 , b1 , u  );
+  bls12_381_Fp2_mont_mul( s  , u  , z1 );               
+  bls12_381_Fp2_mont_sub_inplace( z1 , t0 );
+  bls12_381_Fp2_mont_sub_inplace( z1 , t1 );            // z1 = x0*b1 + x1*b0
+  bls12_381_Fp2_mont_mul( x2 , b1 , s );
+  bls12_381_pairing_fp2_mul_by_xi( s , u );             //      xi*x2*b1
+  bls12_381_Fp2_mont_mul( x2 , b0 , s );                //      x2*b0
+  bls12_381_Fp2_mont_add( t1 , s  , tgt + 2*NWORDS_FP2 );  // z2 = x1*b1 + x2*b0
+  bls12_381_Fp2_mont_add( t0 , u  , tgt                );  // z0 = x0*b0 + xi*x2*b1
+  bls12_381_Fp2_mont_copy( z1 , tgt + NWORDS_FP2 );
+}
+
+// multiplication in Fp12 by the sparse element `c0 + c1*w^2 + c4*w^3` (see `combine_w3_w2_1`)
+void bls12_381_pairing_fp12_mul_by_014_inplace(uint64_t *f, const uint64_t *c0, const uint64_t *c1, const uint64_t *c4) {
+  uint64_t p[NWORDS_FP6];
+  uint64_t q[NWORDS_FP6];
+  uint64_t r[NWORDS_FP6];
+  uint64_t s[NWORDS_FP2];
+  uint64_t *a0 = f;
+  uint64_t *a1 = f + NWORDS_FP6;
+
+  bls12_381_pairing_fp6_mul_by_01( a0 , c0 , c1 , p );      // p = a0*(c0 + c1*v)
+  bls12_381_pairing_fp6_mul_by_v( a1 , q );
+  bls12_381_Fp6_mont_scale_by_base_field( c4 , q , r );     // r = a1*(c4*v)
+  bls12_381_Fp6_mont_add( a0 , a1 , q );
+  bls12_381_Fp2_mont_add( c1 , c4 , s );
+  bls12_381_pairing_fp6_mul_by_01( q , c0 , s , a1 );       // (a0+a1)*(c0 + (c1+c4)*v)
+  bls12_381_Fp6_mont_sub_inplace( a1 , p );
+  bls12_381_Fp6_mont_sub_inplace( a1 , r );                 // new a1 = a0*b1 + a1*b0
+  bls12_381_pairing_fp6_mul_by_v( r , q );
+  bls12_381_Fp6_mont_add( p , q , a0 );                     // new a0 = a0*b0 + v*a1*b1
+}
+
+// f *= line, where `line` was computed by `combine_w3_w2_1`
+void bls12_381_pairing_mul_by_line_inplace(uint64_t *f, const uint64_t *line) {
+  bls12_381_pairing_fp12_mul_by_014_inplace( f , line , line + NWORDS_FP2 , line + 4*NWORDS_FP2 );
+}
+
 //------------------------------------------------------------------------------
 // see "Fast Software Implementations of Bilinear Pairings" for the addition w/ line formulas
 
@@ -104,9 +184,41 @@ void bls12_381_pairing_combine_w3_w2_1(const uint64_t *C, const uint64_t* B, con
 
 //--------------------------------------
 
-// this doubles `T in G2`, and also computes the line function l_psi(2T)(P) in Fp12
-// P should be an affine point in G1, and T projective in G2 !
-void bls12_381_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line) {
+// The line functions are of the form `cy*Y_p + cx*X_p + c1` (placed into the
+// appropriate Fp12 slots, depending on the twist), where the Fp2 coefficients
+// `(cy,cx,c1)` depend only on the G2 points. These are stored consecutively
+// as `3*NWORDS_FP2` words, so that they can be also precomputed (see `prepare_G2`).
+
+#define LINE_CY(c) (c               )
+#define LINE_CX(c) (c +   NWORDS_FP2)
+#define LINE_C1(c) (c + 2*NWORDS_FP2)
+
+#define NWORDS_LINE_COEFFS (3*NWORDS_FP2)
+
+// evaluates the line with the given coefficients at the point P in G1 (affine)
+void bls12_381_pairing_line_eval(const uint64_t *P, const uint64_t *coeffs, uint64_t *line) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bls12_381_Fp2_mont_scale_by_prime_field( Py, LINE_CY(coeffs), A );
+  bls12_381_Fp2_mont_scale_by_prime_field( Px, LINE_CX(coeffs), B );
+  bls12_381_pairing_combine_w3_w2_1(A,B,LINE_C1(coeffs),line);
+}
+
+// f *= line, where the line has the given coefficients, evaluated at P in G1 (affine).
+// This is the same as `line_eval` followed by `mul_by_line_inplace`
+void bls12_381_pairing_mul_by_line_coeffs_inplace(uint64_t *f, const uint64_t *P, const uint64_t *coeffs) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bls12_381_Fp2_mont_scale_by_prime_field( Py, LINE_CY(coeffs), A );
+  bls12_381_Fp2_mont_scale_by_prime_field( Px, LINE_CX(coeffs), B );
+  bls12_381_pairing_fp12_mul_by_014_inplace( f , LINE_C1(coeffs) , B , A );
+}
+
+//--------------------------------------
+
+// this doubles `T in G2`, and also computes the coefficients of the line function l_psi(2T)
+// T should be projective in G2 !
+void bls12_381_pairing_miller_double_coeffs(uint64_t *T, uint64_t *coeffs) {
   uint64_t A[NWORDS_FP2];
   uint64_t B[NWORDS_FP2];
   uint64_t C[NWORDS_FP2];
@@ -115,7 +227,6 @@ void bls12_381_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *l
   uint64_t F[NWORDS_FP2];
   uint64_t G[NWORDS_FP2];
   uint64_t H[NWORDS_FP2];
-  uint64_t tmp12[NWORDS_FP12];
 
   bls12_381_Fp2_mont_mul(Tx, Ty, A);
   bls12_381_Fp2_mont_div_by_2_inplace(A);                   // A = (X*Y)/2
@@ -140,23 +251,26 @@ void bls12_381_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *l
   bls12_381_Fp2_mont_sub_inplace(Ty,C);      //      G^2 - 2*E^2
   bls12_381_Fp2_mont_sub_inplace(Ty,C);      // Y3 = G^2 - 3*E^2
 
-  bls12_381_Fp_mont_add(Px, Px, tmp12);                  // 2*X_p
-  bls12_381_Fp_mont_add_inplace(tmp12, Px);              // 3*X_p
-  bls12_381_Fp2_mont_scale_by_prime_field(tmp12, D, C);  // C = 3*X^2*X_p
-
-  bls12_381_Fp2_mont_sub_inplace(E,B);                   // E - B
-
-  bls12_381_Fp2_mont_scale_by_prime_field(Py, H, H);     // Y_p*H
-  bls12_381_Fp2_mont_neg_inplace(H);                     // -Y_p*H
+  bls12_381_Fp2_mont_add(D, D, LINE_CX(coeffs));        // 2*X^2
+  bls12_381_Fp2_mont_add_inplace(LINE_CX(coeffs), D);    // cx = 3*X^2
+  bls12_381_Fp2_mont_sub(E, B, LINE_C1(coeffs));         // c1 = E - B
+  bls12_381_Fp2_mont_neg(H, LINE_CY(coeffs));            // cy = -H
+}
 
-  bls12_381_pairing_combine_w3_w2_1(H,C,E,line);    // -H*Y_p*w^3 + 3*X^2*X_p*w^2 + (E-B)    
+// this doubles `T in G2`, and also computes the line function l_psi(2T)(P) in Fp12
+// P should be an affine point in G1, and T projective in G2 !
+// (D-twist: -H*Y_p + 3*X^2*X_p*w + (E-B)*w^3 ; M-twist: -H*Y_p*w^3 + 3*X^2*X_p*w^2 + (E-B))
+void bls12_381_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  bls12_381_pairing_miller_double_coeffs(T, coeffs);
+  bls12_381_pairing_line_eval(P, coeffs, line);
 }
 
 //--------------------------------------
 
-// this computes `T+=Q` in G2, and also computes the line function l_(T+Q)(P) in Fp12
-// NOTE: T is projective, but P (in G1) and Q (in G2) are affine!
-void bls12_381_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64_t *T, uint64_t *line) {
+// this computes `T+=Q` in G2, and also computes the coefficients of the line function l_(T+Q)
+// NOTE: T is projective, but Q (in G2) is affine!
+void bls12_381_pairing_miller_mixed_add_coeffs(const uint64_t *Q, uint64_t *T, uint64_t *coeffs) {
   uint64_t A[NWORDS_FP2];
   uint64_t B[NWORDS_FP2];
   uint64_t C[NWORDS_FP2];
@@ -166,16 +280,14 @@ void bls12_381_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, ui
   uint64_t G[NWORDS_FP2];
   uint64_t H[NWORDS_FP2];
   uint64_t I[NWORDS_FP2];
-  uint64_t J[NWORDS_FP2];
   uint64_t lambda[NWORDS_FP2];
   uint64_t theta [NWORDS_FP2];
-  uint64_t tmp12[NWORDS_FP12];
 
   bls12_381_Fp2_mont_mul(Qy,Tz,A);             // A = Y2 * Z
   bls12_381_Fp2_mont_mul(Qx,Tz,B);             // B = X2 * Z
   if ( bls12_381_Fp2_mont_is_equal(A,Ty) && bls12_381_Fp2_mont_is_equal(B,Tx) ) { 
     // Q = T
-    bls12_381_pairing_miller_double(P,T,line);
+    bls12_381_pairing_miller_double_coeffs(T,coeffs);
     return;
   }
 
@@ -198,13 +310,18 @@ void bls12_381_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, ui
   bls12_381_Fp2_mont_mul_inplace(Tz,E);        // Z3 = Z*E
   bls12_381_Fp2_mont_mul(theta ,Qx,A);         // theta*X2
   bls12_381_Fp2_mont_mul(lambda,Qy,B);         // lambda*Y2
-  bls12_381_Fp2_mont_sub(A,B,J);               // J = theta*X2 - lambda*Y2
-
-  bls12_381_Fp2_mont_scale_by_prime_field( Py, lambda, D );  // D = lambda * Y_p
-  bls12_381_Fp2_mont_scale_by_prime_field( Px, theta , C );  // C = theta  * X_p
-  bls12_381_Fp2_mont_neg_inplace(C);                         // ... - theta * X_p
+  bls12_381_Fp2_mont_sub(A,B,LINE_C1(coeffs));   // c1 = J = theta*X2 - lambda*Y2
+  bls12_381_Fp2_mont_copy(lambda,LINE_CY(coeffs)); // cy = lambda
+  bls12_381_Fp2_mont_neg (theta ,LINE_CX(coeffs)); // cx = -theta
+}
 
-  bls12_381_pairing_combine_w3_w2_1(D,C,J,line);  // lambda*Y_p*w^3 - theta*X_p*w^2 + J
+// this computes `T+=Q` in G2, and also computes the line function l_(T+Q)(P) in Fp12
+// NOTE: T is projective, but P (in G1) and Q (in G2) are affine!
+// (D-twist: lambda*Y_p - theta*X_p*w + J*w^3 ; M-twist: lambda*Y_p*w^3 - theta*X_p*w^2 + J)
+void bls12_381_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64_t *T, uint64_t *line) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  bls12_381_pairing_miller_mixed_add_coeffs(Q, T, coeffs);
+  bls12_381_pairing_line_eval(P, coeffs, line);
 }
 
 //--------------------------------------
@@ -212,7 +329,7 @@ void bls12_381_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, ui
 // inputs:  projective coordinates of points P in G1 and Q in G2 (affine points!)
 // outputs: the final value Fp12 and the final T point (projective, G2)
 void bls12_381_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f ) {
-  uint64_t line[NWORDS_FP12];
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
   uint64_t f[NWORDS_FP12]; 
   uint64_t T[3*NWORDS_FP2]; 
 
@@ -222,11 +339,11 @@ void bls12_381_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_
   uint64_t x = bls12_381_miller_loop_param;
   for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
     bls12_381_Fp12_mont_sqr_inplace(f);
-    bls12_381_pairing_miller_double(P,T,line);
-    bls12_381_Fp12_mont_mul_inplace(f,line);
+    bls12_381_pairing_miller_double_coeffs(T,coeffs);
+    bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
     if ((x>>i)&1) {
-      bls12_381_pairing_miller_mixed_add(P,Q,T,line);
-      bls12_381_Fp12_mont_mul_inplace(f,line);
+      bls12_381_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
     }
   }
 
@@ -235,15 +352,290 @@ void bls12_381_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_
 }
 
 //------------------------------------------------------------------------------
-// NOTE: currently the "hard exponentiation" dominates, so we should optimize that 
 
+//------------------------------------------------------------------------------
+// arithmetic in the cyclotomic subgroup
+//
+// After the easy part of the final exponentiation, we are in the cyclotomic
+// subgroup of Fp12 (of order p^4-p^2+1), where inversion is just conjugation
+// (see `Fp12_mont_cyclotomic_inv`), and squaring is much cheaper than in general
+// (Granger-Scott, Karabina).
+// The "slots" below refer to the Fp2 coefficients (see the sparse multiplication).
+
+// squaring in Fp4 = Fp2[s]/(s^2-xi): (x + y*s)^2 = (x^2 + xi*y^2) + 2*x*y*s
+void bls12_381_pairing_fp4_sqr(const uint64_t *x, const uint64_t *y, uint64_t *out_x, uint64_t *out_y) {
+  uint64_t t[NWORDS_FP2];
+  uint64_t u[NWORDS_FP2];
+  uint64_t s[NWORDS_FP2];
+  bls12_381_Fp2_mont_mul( x , y , t );                  // x*y
+  bls12_381_pairing_fp2_mul_by_xi( y , u );
+  bls12_381_Fp2_mont_add_inplace( u , x );              // x + xi*y
+  bls12_381_Fp2_mont_add( x , y , s );
+  bls12_381_Fp2_mont_mul_inplace( s , u );              // x^2 + xi*y^2 + (1+xi)*x*y
+  bls12_381_Fp2_mont_sub_inplace( s , t );
+  bls12_381_pairing_fp2_mul_by_xi( t , u );
+  bls12_381_Fp2_mont_sub( s , u , out_x );
+  bls12_381_Fp2_mont_add( t , t , out_y );
+}
+
+// tgt = 3*a - 2*b
+void bls12_381_pairing_fp2_3a_minus_2b(const uint64_t *a, const uint64_t *b, uint64_t *tgt) {
+  bls12_381_Fp2_mont_sub( a , b , tgt );
+  bls12_381_Fp2_mont_add_inplace( tgt , tgt );
+  bls12_381_Fp2_mont_add_inplace( tgt , a   );
+}
+
+// tgt = 3*a + 2*b
+void bls12_381_pairing_fp2_3a_plus_2b(const uint64_t *a, const uint64_t *b, uint64_t *tgt) {
+  bls12_381_Fp2_mont_add( a , b , tgt );
+  bls12_381_Fp2_mont_add_inplace( tgt , tgt );
+  bls12_381_Fp2_mont_add_inplace( tgt , a   );
+}
+
+// Granger-Scott squaring in the cyclotomic subgroup. Fp12 is viewed as a cubic 
+// extension of Fp4 = Fp2[w^3], the pairs of slots (0,4), (3,2) and (1,5) being
+// the Fp4 coefficients
+void bls12_381_pairing_cyclotomic_sqr(const uint64_t *src, uint64_t *tgt) {
+  uint64_t t[6*NWORDS_FP2];
+  uint64_t u[NWORDS_FP2];
+  bls12_381_pairing_fp4_sqr( src               , src + 4*NWORDS_FP2 , t              , t +   NWORDS_FP2 );
+  bls12_381_pairing_fp4_sqr( src + 3*NWORDS_FP2 , src + 2*NWORDS_FP2 , t + 2*NWORDS_FP2 , t + 3*NWORDS_FP2 );
+  bls12_381_pairing_fp4_sqr( src +   NWORDS_FP2 , src + 5*NWORDS_FP2 , t + 4*NWORDS_FP2 , t + 5*NWORDS_FP2 );
+  bls12_381_pairing_fp2_mul_by_xi( t + 5*NWORDS_FP2 , u );
+  bls12_381_pairing_fp2_3a_minus_2b( t                , src                , tgt                );
+  bls12_381_pairing_fp2_3a_plus_2b ( t +   NWORDS_FP2 , src + 4*NWORDS_FP2 , tgt + 4*NWORDS_FP2 );
+  bls12_381_pairing_fp2_3a_plus_2b ( u                , src + 3*NWORDS_FP2 , tgt + 3*NWORDS_FP2 );
+  bls12_381_pairing_fp2_3a_minus_2b( t + 4*NWORDS_FP2 , src + 2*NWORDS_FP2 , tgt + 2*NWORDS_FP2 );
+  bls12_381_pairing_fp2_3a_minus_2b( t + 2*NWORDS_FP2 , src +   NWORDS_FP2 , tgt +   NWORDS_FP2 );
+  bls12_381_pairing_fp2_3a_plus_2b ( t + 3*NWORDS_FP2 , src + 5*NWORDS_FP2 , tgt + 5*NWORDS_FP2 );
+}
+
+void bls12_381_pairing_cyclotomic_sqr_inplace(uint64_t *tgt) {
+  bls12_381_pairing_cyclotomic_sqr( tgt , tgt );
+}
+
+// Karabina's compressed squaring in the cyclotomic subgroup. Only the slots 
+// 1, 2, 3, 5 are used and updated; the remaining two can be recovered with
+// `cyclotomic_batch_decompress` below
+void bls12_381_pairing_cyclotomic_sqr_compressed(const uint64_t *src, uint64_t *tgt) {
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+  uint64_t t2[NWORDS_FP2];
+  uint64_t t3[NWORDS_FP2];
+  uint64_t t4[NWORDS_FP2];
+  uint64_t t5[NWORDS_FP2];
+  uint64_t t6[NWORDS_FP2];
+  const uint64_t *g1 = src +   NWORDS_FP2;
+  const uint64_t *g2 = src + 2*NWORDS_FP2;
+  const uint64_t *g3 = src + 3*NWORDS_FP2;
+  const uint64_t *g5 = src + 5*NWORDS_FP2;
+  uint64_t z1[NWORDS_FP2];
+  uint64_t z2[NWORDS_FP2];
+  uint64_t z3[NWORDS_FP2];
+  uint64_t z5[NWORDS_FP2];
+
+  bls12_381_Fp2_mont_sqr( g1 , t0 );                    // g1^2
+  bls12_381_Fp2_mont_sqr( g5 , t1 );                    // g5^2
+  bls12_381_Fp2_mont_add( g1 , g5 , t5 );
+  bls12_381_Fp2_mont_sqr( t5 , t2 );                    
+  bls12_381_Fp2_mont_add( t0 , t1 , t3 );
+  bls12_381_Fp2_mont_sub( t2 , t3 , t5 );               // 2*g1*g5
+  bls12_381_Fp2_mont_add( g3 , g2 , t6 );
+  bls12_381_Fp2_mont_sqr( t6 , t3 );                    // (g2+g3)^2
+  bls12_381_Fp2_mont_sqr( g3 , t2 );                    // g3^2
+  bls12_381_pairing_fp2_mul_by_xi( t5 , t6 );           // 2*xi*g1*g5
+  bls12_381_pairing_fp2_3a_plus_2b( t6 , g3 , z3 );     // z3 = 6*xi*g1*g5 + 2*g3
+
+  bls12_381_pairing_fp2_mul_by_xi( t1 , t4 );
+  bls12_381_Fp2_mont_add( t0 , t4 , t5 );               // g1^2 + xi*g5^2
+  bls12_381_pairing_fp2_3a_minus_2b( t5 , g2 , z2 );    // z2 = 3*(g1^2 + xi*g5^2) - 2*g2
+
+  bls12_381_Fp2_mont_sqr( g2 , t1 );                    // g2^2
+  bls12_381_pairing_fp2_mul_by_xi( t1 , t4 );
+  bls12_381_Fp2_mont_add( t2 , t4 , t5 );               // g3^2 + xi*g2^2
+  bls12_381_pairing_fp2_3a_minus_2b( t5 , g1 , z1 );    // z1 = 3*(g3^2 + xi*g2^2) - 2*g1
+
+  bls12_381_Fp2_mont_add( t2 , t1 , t0 );
+  bls12_381_Fp2_mont_sub( t3 , t0 , t5 );               // 2*g2*g3
+  bls12_381_pairing_fp2_3a_plus_2b( t5 , g5 , z5 );     // z5 = 6*g2*g3 + 2*g5
+
+  bls12_381_Fp2_mont_copy( z1 , tgt +   NWORDS_FP2 );
+  bls12_381_Fp2_mont_copy( z2 , tgt + 2*NWORDS_FP2 );
+  bls12_381_Fp2_mont_copy( z3 , tgt + 3*NWORDS_FP2 );
+  bls12_381_Fp2_mont_copy( z5 , tgt + 5*NWORDS_FP2 );
+}
+
+// Recovers the slots 0 and 4 of `n >= 1` compressed elements of the cyclotomic
+// subgroup, in place. The divisions are done with a single batch inversion.
+void bls12_381_pairing_cyclotomic_batch_decompress(int n, uint64_t *fs) {
+  assert( n >= 1 );
+  uint64_t *num = malloc( 8*NWORDS_FP2 * n );
+  uint64_t *den = malloc( 8*NWORDS_FP2 * n );
+  uint64_t *inv = malloc( 8*NWORDS_FP2 * n );
+  assert( num != 0 );
+  assert( den != 0 );
+  assert( inv != 0 );
+
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+
+  for(int k=0; k<n; k++) {
+    const uint64_t *f  = fs + k*NWORDS_FP12;
+    const uint64_t *g1 = f +   NWORDS_FP2;
+    const uint64_t *g2 = f + 2*NWORDS_FP2;
+    const uint64_t *g3 = f + 3*NWORDS_FP2;
+    const uint64_t *g5 = f + 5*NWORDS_FP2;
+    uint64_t *nm = num + k*NWORDS_FP2;
+    uint64_t *dn = den + k*NWORDS_FP2;
+    bls12_381_Fp2_mont_add( g3 , g3 , dn );
+    bls12_381_Fp2_mont_add_inplace( dn , dn );                // dn = 4*g3
+    if (bls12_381_Fp2_mont_is_zero(g3)) {
+      // g4 = 2*g1*g5 / g2
+      bls12_381_Fp2_mont_mul( g1 , g5 , nm );
+      bls12_381_Fp2_mont_add_inplace( nm , nm );
+      bls12_381_Fp2_mont_copy( g2 , dn );
+      // when g2 = g3 = 0, we also have g4 = 0 (for example the unit element)
+      if (bls12_381_Fp2_mont_is_zero(dn)) { bls12_381_Fp2_mont_set_one(dn); }
+    }
+    else {
+      // g4 = (xi*g5^2 + 3*g1^2 - 2*g2) / (4*g3)
+      bls12_381_Fp2_mont_sqr( g1 , t0 );
+      bls12_381_pairing_fp2_3a_minus_2b( t0 , g2 , t1 );
+      bls12_381_Fp2_mont_sqr( g5 , t0 );
+      bls12_381_pairing_fp2_mul_by_xi( t0 , nm );
+      bls12_381_Fp2_mont_add_inplace( nm , t1 );
+    }
+  }
+
+  bls12_381_Fp2_mont_batch_inv( n , den , inv );
+
+  for(int k=0; k<n; k++) {
+    uint64_t *f  = fs + k*NWORDS_FP12;
+    const uint64_t *g1 = f +   NWORDS_FP2;
+    const uint64_t *g2 = f + 2*NWORDS_FP2;
+    const uint64_t *g3 = f + 3*NWORDS_FP2;
+    const uint64_t *g5 = f + 5*NWORDS_FP2;
+    uint64_t *g0 = f;
+    uint64_t *g4 = f + 4*NWORDS_FP2;
+    bls12_381_Fp2_mont_mul( num + k*NWORDS_FP2 , inv + k*NWORDS_FP2 , g4 );
+    // g0 = xi*(2*g4^2 + g3*g5 - 3*g1*g2) + 1
+    bls12_381_Fp2_mont_mul( g1 , g2 , t1 );
+    bls12_381_Fp2_mont_sqr( g4 , t0 );
+    bls12_381_pairing_fp2_3a_minus_2b( t1 , t0 , t0 );
+    bls12_381_Fp2_mont_neg_inplace( t0 );
+    bls12_381_Fp2_mont_mul( g3 , g5 , t1 );
+    bls12_381_Fp2_mont_add_inplace( t0 , t1 );
+    bls12_381_pairing_fp2_mul_by_xi( t0 , g0 );
+    bls12_381_Fp2_mont_set_one( t1 );
+    bls12_381_Fp2_mont_add_inplace( g0 , t1 );
+  }
+
+  free(inv);
+  free(den);
+  free(num);
+}
+
+// exponentiation in the cyclotomic subgroup by a 64 bit exponent (square-and-multiply)
+void bls12_381_pairing_cyclotomic_pow_uint64(const uint64_t *src, uint64_t expo, uint64_t *tgt) {
+  uint64_t acc[NWORDS_FP12];
+  bls12_381_Fp12_mont_set_one( acc );
+  for(int i=63; i>=0; i--) {
+    bls12_381_pairing_cyclotomic_sqr_inplace( acc );
+    if ((expo >> i) & 1) { bls12_381_Fp12_mont_mul_inplace( acc , src ); }
+  }
+  bls12_381_Fp12_mont_copy( acc , tgt );
+}
+
+// exponentiation in the cyclotomic subgroup by a 64 bit exponent, using compressed
+// squarings. This is efficient when the exponent has only few nonzero bits: the 
+// squares corresponding to the nonzero bits are decompressed together at the end.
+void bls12_381_pairing_cyclotomic_pow_uint64_compressed(const uint64_t *src, uint64_t expo, uint64_t *tgt) {
+  int cnt = 0;
+  for(int i=1; i<64; i++) { if ((expo >> i) & 1) cnt++; }
+  if (cnt == 0) {
+    if (expo & 1) { bls12_381_Fp12_mont_copy( src , tgt ); } else { bls12_381_Fp12_mont_set_one( tgt ); }
+    return;
+  }
+
+  uint64_t *sqs = malloc( 8*NWORDS_FP12 * cnt );
+  assert( sqs != 0 );
+  uint64_t acc[NWORDS_FP12];
+  uint64_t cur[NWORDS_FP12];
+  if (expo & 1) { bls12_381_Fp12_mont_copy( src , acc ); } else { bls12_381_Fp12_mont_set_one( acc ); }
+  bls12_381_Fp12_mont_copy( src , cur );
+  int k = 0;
+  for(int i=1; k<cnt; i++) {
+    bls12_381_pairing_cyclotomic_sqr_compressed( cur , cur );     // x^(2^i)
+    if ((expo >> i) & 1) { bls12_381_Fp12_mont_copy( cur , sqs + (k++)*NWORDS_FP12 ); }
+  }
+  bls12_381_pairing_cyclotomic_batch_decompress( cnt , sqs );
+
+  for(int k=0; k<cnt; k++) { bls12_381_Fp12_mont_mul_inplace( acc , sqs + k*NWORDS_FP12 ); }
+  bls12_381_Fp12_mont_copy( acc , tgt );
+  free(sqs);
+}
+
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// exponentiation in the cyclotomic subgroup by a nonnegative bigint exponent of
+// `expo_len` words, using left-to-right sliding windows (with precomputed odd powers)
+// and cyclotomic squarings
+void bls12_381_pairing_cyclotomic_pow_gen(const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len) {
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }
+  if (nbits == 0) {
+    bls12_381_Fp12_mont_set_one( tgt );
+    return;
+  }
+
+  // table[k] = src^(2k+1)
+  int w = (nbits <= 64) ? 3 : 4;
+  uint64_t table[8*NWORDS_FP12];
+  uint64_t acc  [NWORDS_FP12];
+  bls12_381_Fp12_mont_copy( src , table );
+  bls12_381_pairing_cyclotomic_sqr( src , acc );
+  for(int k=1; k<(1<<(w-1)); k++) {
+    bls12_381_Fp12_mont_mul( table + (k-1)*NWORDS_FP12 , acc , table + k*NWORDS_FP12 );
+  }
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bls12_381_pairing_cyclotomic_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bls12_381_Fp12_mont_copy( table + (d>>1)*NWORDS_FP12 , acc );
+      first = 0;
+    }
+    else {
+      for(int k=i; k>=j; k--) { bls12_381_pairing_cyclotomic_sqr_inplace( acc ); }
+      bls12_381_Fp12_mont_mul_inplace( acc , table + (d>>1)*NWORDS_FP12 );
+    }
+    i = j - 1;
+  }
+  bls12_381_Fp12_mont_copy( acc , tgt );
+}
+
+#undef EXPO_BIT
+
+//------------------------------------------------------------------------------
+
+
+// reference implementation of the hard part of the final exponentiation
 
 const uint64_t bls12_381_pairing_lam2_lam0[6] = { 0x73fefffeaaa9ffff, 0x7efb5555d8a7cffd, 0xd1bb89fe01c38e69, 0x6cd40a3c157b538a, 0x1fb322654a7cef70, 0x0000000000000000 };
 const uint64_t bls12_381_pairing_lam1[6]      = { 0x73ffffffffff5554, 0x9d586d584eacaaaa, 0xc49f25e1a737f5e2, 0x26a48d1bb889d46d, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bls12_381_pairing_p_lam2[6]    = { 0x9b560000aaab0000, 0x6c2f6d56d2021801, 0x2f1b4444d201019b, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bls12_381_pairing_lam3[6]      = { 0x8c00aaab0000aaaa, 0x396c8c005555e156, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 };
 
-void bls12_381_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
+void bls12_381_pairing_hard_expo_reference(const uint64_t *src, uint64_t *tgt) {
   uint64_t A0[NWORDS_FP12]; 
   uint64_t A1[NWORDS_FP12]; 
   uint64_t A2[NWORDS_FP12]; 
@@ -302,28 +694,68 @@ void bls12_381_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
 
 }
 
+// the absolute value of the BLS curve parameter `x = -0xd201000000010000`,
+// and `(1-x)/3`
+const uint64_t bls12_381_pairing_abs_param_x      = 0xd201000000010000;
+const uint64_t bls12_381_pairing_one_minus_x_per_3 = 0x460055555555aaab;
+
+// exponentiation by the (negative) curve parameter `x` in the cyclotomic subgroup
+void bls12_381_pairing_cyclotomic_pow_x(const uint64_t *src, uint64_t *tgt) {
+  bls12_381_pairing_cyclotomic_pow_uint64_compressed( src , bls12_381_pairing_abs_param_x , tgt );
+  bls12_381_Fp12_mont_cyclotomic_inv_inplace( tgt );
+}
+
+// The hard part of the final exponentiation, ie. x -> x^((p^4-p^2+1)/r), for
+// an input in the cyclotomic subgroup. Uses the factorization
+//
+//   (p^4-p^2+1)/r = (x-1)^2/3 * (x+p) * (x^2+p^2-1) + 1
+//
+// (see eg. Hayashida, Hayasaka and Teruya: "Efficient final exponentiation via 
+// cyclotomic structure for pairings over families of elliptic curves")
+void bls12_381_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
+  uint64_t t0[NWORDS_FP12];
+  uint64_t t1[NWORDS_FP12];
+  uint64_t t2[NWORDS_FP12];
+
+  bls12_381_pairing_cyclotomic_pow_uint64( src , bls12_381_pairing_one_minus_x_per_3 , t0 );
+  bls12_381_Fp12_mont_cyclotomic_inv_inplace( t0 );             // t0 = f^((x-1)/3)
+
+  bls12_381_pairing_cyclotomic_pow_x( t0 , t1 );
+  bls12_381_Fp12_mont_cyclotomic_inv_inplace( t0 );
+  bls12_381_Fp12_mont_mul_inplace( t0 , t1 );                   // t0 = f^((x-1)^2/3)
+
+  bls12_381_pairing_cyclotomic_pow_x( t0 , t1 );
+  bls12_381_Fp12_mont_frobenius_inplace( t0 );
+  bls12_381_Fp12_mont_mul_inplace( t0 , t1 );                   // t0 = t0^(x+p)
+
+  bls12_381_pairing_cyclotomic_pow_x( t0 , t1 );
+  bls12_381_pairing_cyclotomic_pow_x( t1 , t2 );                // t2 = t0^(x^2)
+  bls12_381_Fp12_mont_cyclotomic_inv( t0 , t1 );
+  bls12_381_Fp12_mont_mul_inplace( t2 , t1 );
+  bls12_381_Fp12_mont_frobenius_2_inplace( t0 );
+  bls12_381_Fp12_mont_mul_inplace( t0 , t2 );                   // t0 = t0^(x^2+p^2-1)
+
+  bls12_381_Fp12_mont_mul( t0 , src , tgt );
+}
+
 //--------------------------------------
 
 
-// exponentiation (in Fp12) to the power `(p^12-1)/r`
-void bls12_381_pairing_final_expo(const uint64_t *src, uint64_t *tgt) {
+// the easy part of the final exponentiation, ie. x -> x^((p^6-1)*(p^2+1))
+void bls12_381_pairing_easy_expo(const uint64_t *src, uint64_t *tgt) {
   uint64_t A[NWORDS_FP12]; 
-  uint64_t B[NWORDS_FP12]; 
 
-  bls12_381_Fp12_mont_copy(src, A);
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^p
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^(p^2)
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^(p^3)
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^(p^4)
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^(p^5)
-  bls12_381_Fp12_mont_frobenius_inplace(A);      // x^(p^6)
+  bls12_381_Fp12_mont_conjugate(src, A);        // x^(p^6)
   bls12_381_Fp12_mont_div_inplace(A, src);       // x^(p^6 - 1)
 
-  bls12_381_Fp12_mont_copy(A, B);
-  bls12_381_Fp12_mont_frobenius_inplace(B);      // y^p
-  bls12_381_Fp12_mont_frobenius_inplace(B);      // y^(p^2)
-  bls12_381_Fp12_mont_mul_inplace(B, A);         // y^(p^2 + 1)
+  bls12_381_Fp12_mont_frobenius_2(A, tgt);       // y^(p^2)
+  bls12_381_Fp12_mont_mul_inplace(tgt, A);       // y^(p^2 + 1)
+}
 
+// exponentiation (in Fp12) to the power `(p^12-1)/r`
+void bls12_381_pairing_final_expo(const uint64_t *src, uint64_t *tgt) {
+  uint64_t B[NWORDS_FP12]; 
+  bls12_381_pairing_easy_expo(src, B);
   bls12_381_pairing_hard_expo(B, tgt);
 }
 
@@ -360,3 +792,502 @@ void bls12_381_pairing_projective(const uint64_t *P, const uint64_t *Q, uint64_t
 }
 
 //------------------------------------------------------------------------------
+
+// Miller loops with the running points `T` in affine coordinates.
+//
+// Affine doubling and addition need a division per step; when running several
+// Miller loops in lockstep, the inversions are shared between all the pairs using
+// Montgomery's batch inversion, so each step costs a single Fp2 inversion in total.
+// For enough pairs, this is cheaper than the projective formulas.
+//
+// The resulting lines are the projective ones scaled by some elements of Fp2 (which
+// are killed by the final exponentiation), namely `Y_p - lambda*X_p + (lambda*x_T - y_T)`.
+// So the Miller function differs from `multi_miller_loop`, but the pairing is the same.
+
+// f *= line, where the affine line is `Y_p - lambda*X_p + c1` (with the appropriate twist)
+void bls12_381_pairing_mul_by_affine_line_inplace(uint64_t *f, const uint64_t *P, const uint64_t *lambda, const uint64_t *c1) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bls12_381_Fp2_mont_from_prime_field( Py, A );
+  bls12_381_Fp2_mont_scale_by_prime_field( Px, lambda, B );
+  bls12_381_Fp2_mont_neg_inplace( B );
+  bls12_381_pairing_fp12_mul_by_014_inplace( f , c1 , B , A );
+}
+
+// the slope of the tangent at T, as a fraction `3*x^2 / 2*y`
+void bls12_381_pairing_affine_slope_double(const uint64_t *T, uint64_t *num, uint64_t *den) {
+  bls12_381_Fp2_mont_sqr( Tx , den );
+  bls12_381_Fp2_mont_add( den , den , num );
+  bls12_381_Fp2_mont_add_inplace( num , den );          // num = 3*x^2
+  bls12_381_Fp2_mont_add( Ty , Ty , den );              // den = 2*y
+}
+
+// the slope of the line through T and Q, as a fraction `(y_Q - y_T) / (x_Q - x_T)`.
+// Note: T = -Q cannot happen during the Miller loop, as T is a small multiple of Q.
+void bls12_381_pairing_affine_slope_add(const uint64_t *T, const uint64_t *Q, uint64_t *num, uint64_t *den) {
+  if ( bls12_381_Fp2_mont_is_equal(Tx,Qx) && bls12_381_Fp2_mont_is_equal(Ty,Qy) ) {
+    // Q = T
+    bls12_381_pairing_affine_slope_double(T, num, den);
+    return;
+  }
+  bls12_381_Fp2_mont_sub( Qy , Ty , num );
+  bls12_381_Fp2_mont_sub( Qx , Tx , den );
+}
+
+// One step of the affine multi-Miller loop: for all the `m` pairs, computes `T += Q`
+// (or `T = 2*T` if `Qs` is NULL), and multiplies `f` by the corresponding lines.
+// Ps, Qs and Ts are arrays of `m` affine points; `buf` is a scratch buffer of `3*m` Fp2 elements
+void bls12_381_pairing_affine_multi_step(int m, const uint64_t *Ps, const uint64_t *Qs, uint64_t *Ts, uint64_t *buf, uint64_t *f) {
+  uint64_t *nums = buf;
+  uint64_t *dens = buf +   m*NWORDS_FP2;
+  uint64_t *invs = buf + 2*m*NWORDS_FP2;
+
+  for(int j=0; j<m; j++) {
+    const uint64_t *T = Ts + j*(2*NWORDS_FP2);
+    if (Qs) {
+      bls12_381_pairing_affine_slope_add( T, Qs + j*(2*NWORDS_FP2), nums + j*NWORDS_FP2, dens + j*NWORDS_FP2 );
+    }
+    else {
+      bls12_381_pairing_affine_slope_double( T, nums + j*NWORDS_FP2, dens + j*NWORDS_FP2 );
+    }
+  }
+
+  bls12_381_Fp2_mont_batch_inv( m, dens, invs );
+
+  for(int j=0; j<m; j++) {
+    const uint64_t *P  = Ps + j*(2*NWORDS_FP );
+    uint64_t       *T  = Ts + j*(2*NWORDS_FP2);
+    const uint64_t *x2 = Qs ? (Qs + j*(2*NWORDS_FP2)) : T;
+    uint64_t lambda[NWORDS_FP2];
+    uint64_t c1[NWORDS_FP2];
+    uint64_t x3[NWORDS_FP2];
+    uint64_t tmp[NWORDS_FP2];
+
+    bls12_381_Fp2_mont_mul( nums + j*NWORDS_FP2 , invs + j*NWORDS_FP2 , lambda );
+    bls12_381_Fp2_mont_sqr( lambda , x3 );
+    bls12_381_Fp2_mont_sub_inplace( x3 , Tx );
+    bls12_381_Fp2_mont_sub_inplace( x3 , x2 );              // x3 = lambda^2 - x1 - x2
+    bls12_381_Fp2_mont_mul( lambda , Tx , c1 );
+    bls12_381_Fp2_mont_sub_inplace( c1 , Ty );              // c1 = lambda*x1 - y1
+    bls12_381_Fp2_mont_mul( lambda , x3 , tmp );
+    bls12_381_Fp2_mont_sub( c1 , tmp , Ty );                // y3 = lambda*(x1 - x3) - y1
+    bls12_381_Fp2_mont_copy( x3 , Tx );
+
+    bls12_381_pairing_mul_by_affine_line_inplace( f, P, lambda, c1 );
+  }
+}
+
+// The same as `multi_miller_loop`, but with affine coordinates and batched inversions
+// (the result differs by a factor which is killed by the final exponentiation)
+void bls12_381_pairing_multi_miller_loop_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f) {
+  uint64_t f[NWORDS_FP12];
+  int N1 = (n>0 ? n : 1);
+
+  uint64_t *Pc  = malloc( 8 * (2*NWORDS_FP ) * N1 );
+  uint64_t *Qc  = malloc( 8 * (2*NWORDS_FP2) * N1 );
+  uint64_t *Ts  = malloc( 8 * (2*NWORDS_FP2) * N1 );
+  uint64_t *buf = malloc( 8 * (3*NWORDS_FP2) * N1 );
+  assert( Pc  != 0 );
+  assert( Qc  != 0 );
+  assert( Ts  != 0 );
+  assert( buf != 0 );
+
+  // the non-trivial pairs, and the initial T = Q points
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P = Ps + k*(2*NWORDS_FP );
+    const uint64_t *Q = Qs + k*(2*NWORDS_FP2);
+    if ( !bls12_381_G1_affine_is_infinity(P) && !bls12_381_G2_affine_is_infinity(Q) ) {
+      bls12_381_G1_affine_copy( P, Pc + m*(2*NWORDS_FP ) );
+      bls12_381_G2_affine_copy( Q, Qc + m*(2*NWORDS_FP2) );
+      bls12_381_G2_affine_copy( Q, Ts + m*(2*NWORDS_FP2) );
+      m++;
+    }
+  }
+
+  bls12_381_Fp12_mont_set_one(f);
+
+  if (m > 0) {
+    uint64_t x = bls12_381_miller_loop_param;
+    for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+      bls12_381_Fp12_mont_sqr_inplace(f);
+      bls12_381_pairing_affine_multi_step( m, Pc, NULL, Ts, buf, f );
+      if ((x>>i)&1) {
+        bls12_381_pairing_affine_multi_step( m, Pc, Qc, Ts, buf, f );
+      }
+    }
+  }
+
+  bls12_381_Fp12_mont_copy(f, out_f);
+  free(buf);
+  free(Ts);
+  free(Qc);
+  free(Pc);
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, using the affine Miller loop.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bls12_381_pairing_multi_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bls12_381_pairing_multi_miller_loop_affine(n,Ps,Qs,f);
+  bls12_381_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+// Miller loops of several pairs of points, run in lockstep so that the squarings
+// of the accumulator `f` are shared. Pairs where either point is the infinity are skipped.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively.
+// The output is the product of the Miller functions (before the final exponentiation)
+void bls12_381_pairing_multi_miller_loop(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  uint64_t f[NWORDS_FP12];
+
+  int      *idx = malloc( sizeof(int)            * (n>0 ? n : 1) );
+  uint64_t *Ts  = malloc( 8 * (3*NWORDS_FP2)     * (n>0 ? n : 1) );
+  assert( idx != 0 );
+  assert( Ts  != 0 );
+
+  // the non-trivial pairs, and the initial T = Q points
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P = Ps + k*(2*NWORDS_FP );
+    const uint64_t *Q = Qs + k*(2*NWORDS_FP2);
+    if ( !bls12_381_G1_affine_is_infinity(P) && !bls12_381_G2_affine_is_infinity(Q) ) {
+      bls12_381_G2_proj_from_affine(Q, Ts + m*(3*NWORDS_FP2));
+      idx[m++] = k;
+    }
+  }
+
+  bls12_381_Fp12_mont_set_one(f);
+
+  uint64_t x = bls12_381_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bls12_381_Fp12_mont_sqr_inplace(f);
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps + idx[j]*(2*NWORDS_FP);
+      uint64_t       *T = Ts +      j*(3*NWORDS_FP2);
+      bls12_381_pairing_miller_double_coeffs(T,coeffs);
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
+    }
+    if ((x>>i)&1) {
+      for(int j=0; j<m; j++) {
+        const uint64_t *P = Ps + idx[j]*(2*NWORDS_FP );
+        const uint64_t *Q = Qs + idx[j]*(2*NWORDS_FP2);
+        uint64_t       *T = Ts +      j*(3*NWORDS_FP2);
+        bls12_381_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+        bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
+      }
+    }
+  }
+
+  bls12_381_Fp12_mont_copy(f, out_f);
+  free(Ts);
+  free(idx);
+}
+
+// above this many pairs, the affine Miller loop (with batched inversions) is faster
+#define MULTI_MILLER_AFFINE_THRESHOLD 16
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, with a single final exponentiation.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bls12_381_pairing_multi(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  if (n > MULTI_MILLER_AFFINE_THRESHOLD) {
+    bls12_381_pairing_multi_miller_loop_affine(n,Ps,Qs,f);
+  }
+  else {
+    bls12_381_pairing_multi_miller_loop(n,Ps,Qs,f);
+  }
+  bls12_381_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+// "prepared" G2 points: when one of the arguments of the pairing is fixed (for example
+// the G2 generator or [tau]_2 in KZG, or a public key), all the line coefficients of
+// the Miller loop can be precomputed, so that no G2 arithmetic remains in the pairing.
+//
+// layout: `prep[0]` is 1 if Q is the infinity (and 0 otherwise), followed by
+// the coefficients `(cy,cx,c1)` of the lines, in the order the Miller loop consumes them
+
+#define PREPARED_G2_NLINES  68
+#define PREPARED_G2_NWORDS  2449    // 1 + NLINES*NWORDS_LINE_COEFFS
+
+int bls12_381_pairing_prepared_G2_nwords() {
+  return PREPARED_G2_NWORDS;
+}
+
+// precomputes the line coefficients for the affine point Q in G2.
+// Requires a target buffer of size `PREPARED_G2_NWORDS`
+void bls12_381_pairing_prepare_G2(const uint64_t *Q, uint64_t *prep) {
+  uint64_t T[3*NWORDS_FP2];
+
+  if ( bls12_381_G2_affine_is_infinity(Q) ) {
+    memset( prep, 0, 8*PREPARED_G2_NWORDS );
+    prep[0] = 1;
+    return;
+  }
+
+  prep[0] = 0;
+  uint64_t *coeffs = prep + 1;
+  bls12_381_G2_proj_from_affine(Q,T);
+
+  uint64_t x = bls12_381_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bls12_381_pairing_miller_double_coeffs(T,coeffs);
+    coeffs += NWORDS_LINE_COEFFS;
+    if ((x>>i)&1) {
+      bls12_381_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+      coeffs += NWORDS_LINE_COEFFS;
+    }
+  }
+
+  assert( coeffs == prep + PREPARED_G2_NWORDS );
+}
+
+// Miller loops of several pairs of points, where the G2 points are prepared.
+// Ps is an array of `n` affine points in G1, and preps are `n` consecutive prepared
+// G2 points (each of size `PREPARED_G2_NWORDS`). Pairs where either point is the
+// infinity are skipped. The output is the product of the Miller functions
+void bls12_381_pairing_multi_miller_loop_prepared(int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *out_f) {
+  uint64_t f[NWORDS_FP12];
+
+  int *idx = malloc( sizeof(int) * (n>0 ? n : 1) );
+  assert( idx != 0 );
+
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P    = Ps    + k*(2*NWORDS_FP);
+    const uint64_t *prep = preps + k*PREPARED_G2_NWORDS;
+    if ( !bls12_381_G1_affine_is_infinity(P) && !prep[0] ) { idx[m++] = k; }
+  }
+
+  bls12_381_Fp12_mont_set_one(f);
+
+  int ofs = 1;     // offset of the current line in the prepared points
+  uint64_t x = bls12_381_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bls12_381_Fp12_mont_sqr_inplace(f);
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+      const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,c);
+    }
+    ofs += NWORDS_LINE_COEFFS;
+    if ((x>>i)&1) {
+      for(int j=0; j<m; j++) {
+        const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+        const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+        bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,c);
+      }
+      ofs += NWORDS_LINE_COEFFS;
+    }
+  }
+
+  // the remaining lines (the two extra lines of the optimal Ate pairing for BN curves)
+  while (ofs < PREPARED_G2_NWORDS) {
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+      const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,P,c);
+    }
+    ofs += NWORDS_LINE_COEFFS;
+  }
+
+  bls12_381_Fp12_mont_copy(f, out_f);
+  free(idx);
+}
+
+// computes the pairing `e(P,Q)`, where Q in G2 is prepared
+// P is an affine point in G1, tgt is in Fp12
+void bls12_381_pairing_affine_prepared(const uint64_t *P, const uint64_t *prep, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bls12_381_pairing_multi_miller_loop_prepared(1,P,prep,f);
+  bls12_381_pairing_final_expo(f,tgt);
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, where the Q_i are prepared
+// Ps is an array of `n` affine points in G1, preps is `n` consecutive prepared G2 points
+// tgt is in Fp12
+void bls12_381_pairing_multi_prepared(int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bls12_381_pairing_multi_miller_loop_prepared(n,Ps,preps,f);
+  bls12_381_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// parallel pairing
+//
+// Latency-oriented versions, which run the independent parts of a single pairing
+// (or of a product of pairings) on the worker threads of `parallel.h`. With a single
+// thread, these fall back to the sequential versions.
+
+// The Miller loop is split at the bit `k = MILLER_SPLIT_BIT` of the loop parameter
+// `s = a*2^k + b`. The first part of the loop ends with `f_a` and `T = [a]Q`, and the
+// rest only squares `f` and multiplies it by lines depending on `T` and `Q`. Hence
+//
+//   f_s = (f_a)^(2^k) * g
+//
+// where `g` is the second part of the loop started from `f = 1` and `T = [a]Q` (computed
+// by a scalar multiplication), so the two parts are independent. The projective
+// coordinates of `T` differ from the sequential loop, thus the lines differ by factors
+// in Fp2; these are killed by the final exponentiation.
+#define MILLER_SPLIT_BIT 42
+
+typedef struct {
+  const uint64_t *P;
+  const uint64_t *Q;
+        uint64_t *f_hi;     // (f_a)^(2^k)
+        uint64_t *f_lo;     // g
+        uint64_t *T;        // the final T
+} bls12_381_pairing_miller_split_ctx_t;
+
+void bls12_381_pairing_miller_split_task(void *ctx, int idx) {
+  bls12_381_pairing_miller_split_ctx_t *c = (bls12_381_pairing_miller_split_ctx_t*) ctx;
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  uint64_t T [3*NWORDS_FP2];
+  uint64_t Q0[3*NWORDS_FP2];
+  uint64_t x = bls12_381_miller_loop_param;
+  bls12_381_G2_proj_from_affine(c->Q,Q0);
+  if (idx == 0) {
+    // the top bits of the loop, then the squarings
+    uint64_t *f = c->f_hi;
+    bls12_381_Fp12_mont_set_one(f);
+    bls12_381_G2_proj_copy(Q0,T);
+    for(int i=MILLER_LOOP_LENGTH-1; i>=MILLER_SPLIT_BIT; i--) {
+      bls12_381_Fp12_mont_sqr_inplace(f);
+      bls12_381_pairing_miller_double_coeffs(T,coeffs);
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      if ((x>>i)&1) {
+        bls12_381_pairing_miller_mixed_add_coeffs(c->Q,T,coeffs);
+        bls12_381_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      }
+    }
+    for(int i=0; i<MILLER_SPLIT_BIT; i++) { bls12_381_Fp12_mont_sqr_inplace(f); }
+  }
+  else {
+    // the bottom bits, starting from T = [a]Q; here `a` includes the implicit top bit
+    uint64_t *f = c->f_lo;
+    uint64_t a = (x >> MILLER_SPLIT_BIT) | (1ULL << (MILLER_LOOP_LENGTH - MILLER_SPLIT_BIT));
+    bls12_381_G2_proj_scl_small(a,Q0,T);
+    bls12_381_Fp12_mont_set_one(f);
+    for(int i=MILLER_SPLIT_BIT-1; i>=0; i--) {
+      if (i < MILLER_SPLIT_BIT-1) { bls12_381_Fp12_mont_sqr_inplace(f); }      // no need to square 1
+      bls12_381_pairing_miller_double_coeffs(T,coeffs);
+      bls12_381_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      if ((x>>i)&1) {
+        bls12_381_pairing_miller_mixed_add_coeffs(c->Q,T,coeffs);
+        bls12_381_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      }
+    }
+    bls12_381_G2_proj_copy(T,c->T);
+  }
+}
+
+// the Miller loop, split into two parts running in parallel (see above).
+// The output is the same as `miller_loop`, up to a factor in Fp2
+void bls12_381_pairing_miller_loop_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f ) {
+  if (parallel_get_num_threads() < 2) {
+    bls12_381_pairing_miller_loop(P,Q,out_T,out_f);
+    return;
+  }
+  uint64_t f_hi[NWORDS_FP12];
+  uint64_t f_lo[NWORDS_FP12];
+  bls12_381_pairing_miller_split_ctx_t ctx;
+  ctx.P    = P;
+  ctx.Q    = Q;
+  ctx.f_hi = f_hi;
+  ctx.f_lo = f_lo;
+  ctx.T    = out_T;
+  parallel_for( 2, bls12_381_pairing_miller_split_task, &ctx );
+  bls12_381_Fp12_mont_mul(f_hi,f_lo,out_f);
+}
+
+// The hard part of the final exponentiation is a chain of exponentiations by `x`,
+// each depending on the previous one, so there is nothing to parallelize there
+void bls12_381_pairing_hard_expo_parallel(const uint64_t *src, uint64_t *tgt) {
+  bls12_381_pairing_hard_expo(src,tgt);
+}
+
+// the final exponentiation, with the hard part computed in parallel
+void bls12_381_pairing_final_expo_parallel(const uint64_t *src, uint64_t *tgt) {
+  uint64_t B[NWORDS_FP12];
+  bls12_381_pairing_easy_expo(src, B);
+  bls12_381_pairing_hard_expo_parallel(B, tgt);
+}
+
+// computes the optimal Ate pairing, running the two halves of the Miller loop in parallel
+// P and Q are affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bls12_381_pairing_affine_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  uint64_t T[3*NWORDS_FP2];
+  if ( bls12_381_G1_affine_is_infinity(P) || bls12_381_G2_affine_is_infinity(Q) ) {
+    bls12_381_Fp12_mont_set_one(tgt);
+    return;
+  }
+  bls12_381_pairing_miller_loop_parallel(P,Q,T,f);
+  bls12_381_pairing_final_expo_parallel(f,tgt);
+}
+
+typedef struct {
+  int n;
+  int nchunks;
+  const uint64_t *Ps;
+  const uint64_t *Qs;
+        uint64_t *fs;
+} bls12_381_pairing_multi_ctx_t;
+
+void bls12_381_pairing_multi_chunk_task(void *ctx, int j) {
+  bls12_381_pairing_multi_ctx_t *c = (bls12_381_pairing_multi_ctx_t*) ctx;
+  int a = ( j   *c->n) / c->nchunks;
+  int b = ((j+1)*c->n) / c->nchunks;
+  const uint64_t *Ps = c->Ps + a*(2*NWORDS_FP );
+  const uint64_t *Qs = c->Qs + a*(2*NWORDS_FP2);
+  if (b-a > MULTI_MILLER_AFFINE_THRESHOLD) {
+    bls12_381_pairing_multi_miller_loop_affine(b-a,Ps,Qs,c->fs + j*NWORDS_FP12);
+  }
+  else {
+    bls12_381_pairing_multi_miller_loop(b-a,Ps,Qs,c->fs + j*NWORDS_FP12);
+  }
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, running the Miller loops of
+// disjoint chunks of the pairs in parallel, followed by the (parallel) final exponentiation.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bls12_381_pairing_multi_parallel(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  if (n == 1) {
+    bls12_381_pairing_affine_parallel(Ps,Qs,tgt);
+    return;
+  }
+  int nchunks = parallel_get_num_threads();
+  if (nchunks > n) { nchunks = n; }
+  if (nchunks < 2) {
+    bls12_381_pairing_multi(n,Ps,Qs,tgt);
+    return;
+  }
+
+  uint64_t *fs = malloc( 8*NWORDS_FP12 * nchunks );
+  assert( fs != 0 );
+  bls12_381_pairing_multi_ctx_t ctx;
+  ctx.n       = n;
+  ctx.nchunks = nchunks;
+  ctx.Ps      = Ps;
+  ctx.Qs      = Qs;
+  ctx.fs      = fs;
+  parallel_for( nchunks, bls12_381_pairing_multi_chunk_task, &ctx );
+
+  uint64_t f[NWORDS_FP12];
+  bls12_381_Fp12_mont_copy(fs,f);
+  for(int j=1; j<nchunks; j++) { bls12_381_Fp12_mont_mul_inplace(f, fs + j*NWORDS_FP12); }
+  free(fs);
+  bls12_381_pairing_final_expo_parallel(f,tgt);
+}
+
+//------------------------------------------------------------------------------
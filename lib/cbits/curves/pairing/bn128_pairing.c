@@ -5,6 +5,7 @@
 
 #include "curves/fields/mont/bn128_Fp_mont.h"
 #include "curves/fields/mont/bn128_Fp2_mont.h"
+#include "curves/fields/mont/bn128_Fp6_mont.h"
 #include "curves/fields/mont/bn128_Fp12_mont.h"
 
 #include "curves/g1/affine/bn128_G1_affine.h"
@@ -12,10 +13,13 @@
 #include "curves/g1/proj/bn128_G1_proj.h"
 #include "curves/g2/proj/bn128_G2_proj.h"
 
+#include "parallel.h"
+
 //------------------------------------------------------------------------------
 
 #define NWORDS_FP   4
 #define NWORDS_FP2  8
+#define NWORDS_FP6  24
 #define NWORDS_FP12 48
 
 //------------------------------------------------------------------------------
@@ -83,6 +87,81 @@ void bn128_pairing_combine_1_w_w3(const uint64_t *A, const uint64_t* B, const ui
   memcpy( tgt + 4*NWORDS_FP2  , C , 8*NWORDS_FP2 );
 }
 
+//------------------------------------------------------------------------------
+// sparse multiplication by line functions
+//
+// Fp12 = Fp6[w]/(w^2-v) and Fp6 = Fp2[v]/(v^3-xi), so the line functions above
+// have only 3 nonzero Fp2 coefficients (out of 6). The Fp2 coefficient `3*i+j`
+// belongs to `v^j * w^i`.
+
+extern uint64_t bn128_Fp6_mont_irred_coeffs[];
+
+// multiplication by the non-residue `xi = v^3` in Fp2
+void bn128_pairing_fp2_mul_by_xi(const uint64_t *src, uint64_t *tgt) {
+  bn128_Fp2_mont_mul( src , bn128_Fp6_mont_irred_coeffs , tgt );
+  bn128_Fp2_mont_neg_inplace( tgt );
+}
+
+// multiplication by `v` in Fp6
+void bn128_pairing_fp6_mul_by_v(const uint64_t *src, uint64_t *tgt) {
+  uint64_t tmp[NWORDS_FP2];
+  bn128_pairing_fp2_mul_by_xi( src + 2*NWORDS_FP2 , tmp );
+  bn128_Fp2_mont_copy( src +   NWORDS_FP2 , tgt + 2*NWORDS_FP2 );
+  bn128_Fp2_mont_copy( src                , tgt +   NWORDS_FP2 );
+  bn128_Fp2_mont_copy( tmp                , tgt                );
+}
+
+// multiplication in Fp6 by the sparse element `b0 + b1*v` (5 Fp2 multiplications)
+void bn128_pairing_fp6_mul_by_01(const uint64_t *src, const uint64_t *b0, const uint64_t *b1, uint64_t *tgt) {
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+  uint64_t s [NWORDS_FP2];
+  uint64_t u [NWORDS_FP2];
+  uint64_t z1[NWORDS_FP2];
+  const uint64_t *x0 = src;
+  const uint64_t *x1 = src +   NWORDS_FP2;
+  const uint64_t *x2 = src + 2*NWORDS_FP2;
+
+  bn128_Fp2_mont_mul( x0 , b0 , t0 );               // t0 = x0*b0
+  bn128_Fp2_mont_mul( x1 , b1 , t1 );               // t1 = x1*b1
+  bn128_Fp2_mont_add( x0 , x1 , s  );
+  bn128_Fp2_mont_add( b0 , b1 , u  );
+  bn128_Fp2_mont_mul( s  , u  , z1 );               
+  bn128_Fp2_mont_sub_inplace( z1 , t0 );
+  bn128_Fp2_mont_sub_inplace( z1 , t1 );            // z1 = x0*b1 + x1*b0
+  bn128_Fp2_mont_mul( x2 , b1 , s );
+  bn128_pairing_fp2_mul_by_xi( s , u );             //      xi*x2*b1
+  bn128_Fp2_mont_mul( x2 , b0 , s );                //      x2*b0
+  bn128_Fp2_mont_add( t1 , s  , tgt + 2*NWORDS_FP2 );  // z2 = x1*b1 + x2*b0
+  bn128_Fp2_mont_add( t0 , u  , tgt                );  // z0 = x0*b0 + xi*x2*b1
+  bn128_Fp2_mont_copy( z1 , tgt + NWORDS_FP2 );
+}
+
+// multiplication in Fp12 by the sparse element `c0 + c3*w + c4*w^3` (see `combine_1_w_w3`)
+void bn128_pairing_fp12_mul_by_034_inplace(uint64_t *f, const uint64_t *c0, const uint64_t *c3, const uint64_t *c4) {
+  uint64_t p[NWORDS_FP6];
+  uint64_t q[NWORDS_FP6];
+  uint64_t r[NWORDS_FP6];
+  uint64_t s[NWORDS_FP2];
+  uint64_t *a0 = f;
+  uint64_t *a1 = f + NWORDS_FP6;
+
+  bn128_Fp6_mont_scale_by_base_field( c0 , a0 , p );   // p = a0*c0
+  bn128_pairing_fp6_mul_by_01( a1 , c3 , c4 , r );      // r = a1*(c3 + c4*v)
+  bn128_Fp6_mont_add( a0 , a1 , q );
+  bn128_Fp2_mont_add( c0 , c3 , s );
+  bn128_pairing_fp6_mul_by_01( q , s , c4 , a1 );       // (a0+a1)*(c0+c3 + c4*v)
+  bn128_Fp6_mont_sub_inplace( a1 , p );
+  bn128_Fp6_mont_sub_inplace( a1 , r );                 // new a1 = a0*b1 + a1*b0
+  bn128_pairing_fp6_mul_by_v( r , q );
+  bn128_Fp6_mont_add( p , q , a0 );                     // new a0 = a0*b0 + v*a1*b1
+}
+
+// f *= line, where `line` was computed by `combine_1_w_w3`
+void bn128_pairing_mul_by_line_inplace(uint64_t *f, const uint64_t *line) {
+  bn128_pairing_fp12_mul_by_034_inplace( f , line , line + 3*NWORDS_FP2 , line + 4*NWORDS_FP2 );
+}
+
 //------------------------------------------------------------------------------
 // see "Fast Software Implementations of Bilinear Pairings" for the addition w/ line formulas
 
@@ -98,9 +177,41 @@ void bn128_pairing_combine_1_w_w3(const uint64_t *A, const uint64_t* B, const ui
 
 //--------------------------------------
 
-// this doubles `T in G2`, and also computes the line function l_psi(2T)(P) in Fp12
-// P should be an affine point in G1, and T projective in G2 !
-void bn128_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line) {
+// The line functions are of the form `cy*Y_p + cx*X_p + c1` (placed into the
+// appropriate Fp12 slots, depending on the twist), where the Fp2 coefficients
+// `(cy,cx,c1)` depend only on the G2 points. These are stored consecutively
+// as `3*NWORDS_FP2` words, so that they can be also precomputed (see `prepare_G2`).
+
+#define LINE_CY(c) (c               )
+#define LINE_CX(c) (c +   NWORDS_FP2)
+#define LINE_C1(c) (c + 2*NWORDS_FP2)
+
+#define NWORDS_LINE_COEFFS (3*NWORDS_FP2)
+
+// evaluates the line with the given coefficients at the point P in G1 (affine)
+void bn128_pairing_line_eval(const uint64_t *P, const uint64_t *coeffs, uint64_t *line) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bn128_Fp2_mont_scale_by_prime_field( Py, LINE_CY(coeffs), A );
+  bn128_Fp2_mont_scale_by_prime_field( Px, LINE_CX(coeffs), B );
+  bn128_pairing_combine_1_w_w3 (A,B,LINE_C1(coeffs),line);
+}
+
+// f *= line, where the line has the given coefficients, evaluated at P in G1 (affine).
+// This is the same as `line_eval` followed by `mul_by_line_inplace`
+void bn128_pairing_mul_by_line_coeffs_inplace(uint64_t *f, const uint64_t *P, const uint64_t *coeffs) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bn128_Fp2_mont_scale_by_prime_field( Py, LINE_CY(coeffs), A );
+  bn128_Fp2_mont_scale_by_prime_field( Px, LINE_CX(coeffs), B );
+  bn128_pairing_fp12_mul_by_034_inplace( f , A , B , LINE_C1(coeffs) );
+}
+
+//--------------------------------------
+
+// this doubles `T in G2`, and also computes the coefficients of the line function l_psi(2T)
+// T should be projective in G2 !
+void bn128_pairing_miller_double_coeffs(uint64_t *T, uint64_t *coeffs) {
   uint64_t A[NWORDS_FP2];
   uint64_t B[NWORDS_FP2];
   uint64_t C[NWORDS_FP2];
@@ -109,7 +220,6 @@ void bn128_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line)
   uint64_t F[NWORDS_FP2];
   uint64_t G[NWORDS_FP2];
   uint64_t H[NWORDS_FP2];
-  uint64_t tmp12[NWORDS_FP12];
 
   bn128_Fp2_mont_mul(Tx, Ty, A);
   bn128_Fp2_mont_div_by_2_inplace(A);                   // A = (X*Y)/2
@@ -134,23 +244,26 @@ void bn128_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line)
   bn128_Fp2_mont_sub_inplace(Ty,C);      //      G^2 - 2*E^2
   bn128_Fp2_mont_sub_inplace(Ty,C);      // Y3 = G^2 - 3*E^2
 
-  bn128_Fp_mont_add(Px, Px, tmp12);                  // 2*X_p
-  bn128_Fp_mont_add_inplace(tmp12, Px);              // 3*X_p
-  bn128_Fp2_mont_scale_by_prime_field(tmp12, D, C);  // C = 3*X^2*X_p
-
-  bn128_Fp2_mont_sub_inplace(E,B);                   // E - B
-
-  bn128_Fp2_mont_scale_by_prime_field(Py, H, H);     // Y_p*H
-  bn128_Fp2_mont_neg_inplace(H);                     // -Y_p*H
+  bn128_Fp2_mont_add(D, D, LINE_CX(coeffs));        // 2*X^2
+  bn128_Fp2_mont_add_inplace(LINE_CX(coeffs), D);    // cx = 3*X^2
+  bn128_Fp2_mont_sub(E, B, LINE_C1(coeffs));         // c1 = E - B
+  bn128_Fp2_mont_neg(H, LINE_CY(coeffs));            // cy = -H
+}
 
-  bn128_pairing_combine_1_w_w3 (H,C,E,line);    // -H*Y_p     + 3*X^2*X_p*w   + (E-B)*w^3
+// this doubles `T in G2`, and also computes the line function l_psi(2T)(P) in Fp12
+// P should be an affine point in G1, and T projective in G2 !
+// (D-twist: -H*Y_p + 3*X^2*X_p*w + (E-B)*w^3 ; M-twist: -H*Y_p*w^3 + 3*X^2*X_p*w^2 + (E-B))
+void bn128_pairing_miller_double(const uint64_t *P, uint64_t *T, uint64_t *line) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  bn128_pairing_miller_double_coeffs(T, coeffs);
+  bn128_pairing_line_eval(P, coeffs, line);
 }
 
 //--------------------------------------
 
-// this computes `T+=Q` in G2, and also computes the line function l_(T+Q)(P) in Fp12
-// NOTE: T is projective, but P (in G1) and Q (in G2) are affine!
-void bn128_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64_t *T, uint64_t *line) {
+// this computes `T+=Q` in G2, and also computes the coefficients of the line function l_(T+Q)
+// NOTE: T is projective, but Q (in G2) is affine!
+void bn128_pairing_miller_mixed_add_coeffs(const uint64_t *Q, uint64_t *T, uint64_t *coeffs) {
   uint64_t A[NWORDS_FP2];
   uint64_t B[NWORDS_FP2];
   uint64_t C[NWORDS_FP2];
@@ -160,16 +273,14 @@ void bn128_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64
   uint64_t G[NWORDS_FP2];
   uint64_t H[NWORDS_FP2];
   uint64_t I[NWORDS_FP2];
-  uint64_t J[NWORDS_FP2];
   uint64_t lambda[NWORDS_FP2];
   uint64_t theta [NWORDS_FP2];
-  uint64_t tmp12[NWORDS_FP12];
 
   bn128_Fp2_mont_mul(Qy,Tz,A);             // A = Y2 * Z
   bn128_Fp2_mont_mul(Qx,Tz,B);             // B = X2 * Z
   if ( bn128_Fp2_mont_is_equal(A,Ty) && bn128_Fp2_mont_is_equal(B,Tx) ) { 
     // Q = T
-    bn128_pairing_miller_double(P,T,line);
+    bn128_pairing_miller_double_coeffs(T,coeffs);
     return;
   }
 
@@ -192,13 +303,18 @@ void bn128_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64
   bn128_Fp2_mont_mul_inplace(Tz,E);        // Z3 = Z*E
   bn128_Fp2_mont_mul(theta ,Qx,A);         // theta*X2
   bn128_Fp2_mont_mul(lambda,Qy,B);         // lambda*Y2
-  bn128_Fp2_mont_sub(A,B,J);               // J = theta*X2 - lambda*Y2
-
-  bn128_Fp2_mont_scale_by_prime_field( Py, lambda, D );  // D = lambda * Y_p
-  bn128_Fp2_mont_scale_by_prime_field( Px, theta , C );  // C = theta  * X_p
-  bn128_Fp2_mont_neg_inplace(C);                         // ... - theta * X_p
+  bn128_Fp2_mont_sub(A,B,LINE_C1(coeffs));   // c1 = J = theta*X2 - lambda*Y2
+  bn128_Fp2_mont_copy(lambda,LINE_CY(coeffs)); // cy = lambda
+  bn128_Fp2_mont_neg (theta ,LINE_CX(coeffs)); // cx = -theta
+}
 
-  bn128_pairing_combine_1_w_w3 (D,C,J,line);  // lambda*Y_p     - theta*X_p*w   + J*w^3
+// this computes `T+=Q` in G2, and also computes the line function l_(T+Q)(P) in Fp12
+// NOTE: T is projective, but P (in G1) and Q (in G2) are affine!
+// (D-twist: lambda*Y_p - theta*X_p*w + J*w^3 ; M-twist: lambda*Y_p*w^3 - theta*X_p*w^2 + J)
+void bn128_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64_t *T, uint64_t *line) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  bn128_pairing_miller_mixed_add_coeffs(Q, T, coeffs);
+  bn128_pairing_line_eval(P, coeffs, line);
 }
 
 //--------------------------------------
@@ -206,7 +322,7 @@ void bn128_pairing_miller_mixed_add(const uint64_t *P, const uint64_t *Q, uint64
 // inputs:  projective coordinates of points P in G1 and Q in G2 (affine points!)
 // outputs: the final value Fp12 and the final T point (projective, G2)
 void bn128_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f ) {
-  uint64_t line[NWORDS_FP12];
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
   uint64_t f[NWORDS_FP12]; 
   uint64_t T[3*NWORDS_FP2]; 
 
@@ -216,11 +332,11 @@ void bn128_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_t *o
   uint64_t x = bn128_miller_loop_param;
   for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
     bn128_Fp12_mont_sqr_inplace(f);
-    bn128_pairing_miller_double(P,T,line);
-    bn128_Fp12_mont_mul_inplace(f,line);
+    bn128_pairing_miller_double_coeffs(T,coeffs);
+    bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
     if ((x>>i)&1) {
-      bn128_pairing_miller_mixed_add(P,Q,T,line);
-      bn128_Fp12_mont_mul_inplace(f,line);
+      bn128_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+      bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
     }
   }
 
@@ -229,14 +345,289 @@ void bn128_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_t *o
 }
 
 //------------------------------------------------------------------------------
-// NOTE: currently the "hard exponentiation" dominates, so we should optimize that 
 
+//------------------------------------------------------------------------------
+// arithmetic in the cyclotomic subgroup
+//
+// After the easy part of the final exponentiation, we are in the cyclotomic
+// subgroup of Fp12 (of order p^4-p^2+1), where inversion is just conjugation
+// (see `Fp12_mont_cyclotomic_inv`), and squaring is much cheaper than in general
+// (Granger-Scott, Karabina).
+// The "slots" below refer to the Fp2 coefficients (see the sparse multiplication).
+
+// squaring in Fp4 = Fp2[s]/(s^2-xi): (x + y*s)^2 = (x^2 + xi*y^2) + 2*x*y*s
+void bn128_pairing_fp4_sqr(const uint64_t *x, const uint64_t *y, uint64_t *out_x, uint64_t *out_y) {
+  uint64_t t[NWORDS_FP2];
+  uint64_t u[NWORDS_FP2];
+  uint64_t s[NWORDS_FP2];
+  bn128_Fp2_mont_mul( x , y , t );                  // x*y
+  bn128_pairing_fp2_mul_by_xi( y , u );
+  bn128_Fp2_mont_add_inplace( u , x );              // x + xi*y
+  bn128_Fp2_mont_add( x , y , s );
+  bn128_Fp2_mont_mul_inplace( s , u );              // x^2 + xi*y^2 + (1+xi)*x*y
+  bn128_Fp2_mont_sub_inplace( s , t );
+  bn128_pairing_fp2_mul_by_xi( t , u );
+  bn128_Fp2_mont_sub( s , u , out_x );
+  bn128_Fp2_mont_add( t , t , out_y );
+}
+
+// tgt = 3*a - 2*b
+void bn128_pairing_fp2_3a_minus_2b(const uint64_t *a, const uint64_t *b, uint64_t *tgt) {
+  bn128_Fp2_mont_sub( a , b , tgt );
+  bn128_Fp2_mont_add_inplace( tgt , tgt );
+  bn128_Fp2_mont_add_inplace( tgt , a   );
+}
+
+// tgt = 3*a + 2*b
+void bn128_pairing_fp2_3a_plus_2b(const uint64_t *a, const uint64_t *b, uint64_t *tgt) {
+  bn128_Fp2_mont_add( a , b , tgt );
+  bn128_Fp2_mont_add_inplace( tgt , tgt );
+  bn128_Fp2_mont_add_inplace( tgt , a   );
+}
+
+// Granger-Scott squaring in the cyclotomic subgroup. Fp12 is viewed as a cubic 
+// extension of Fp4 = Fp2[w^3], the pairs of slots (0,4), (3,2) and (1,5) being
+// the Fp4 coefficients
+void bn128_pairing_cyclotomic_sqr(const uint64_t *src, uint64_t *tgt) {
+  uint64_t t[6*NWORDS_FP2];
+  uint64_t u[NWORDS_FP2];
+  bn128_pairing_fp4_sqr( src               , src + 4*NWORDS_FP2 , t              , t +   NWORDS_FP2 );
+  bn128_pairing_fp4_sqr( src + 3*NWORDS_FP2 , src + 2*NWORDS_FP2 , t + 2*NWORDS_FP2 , t + 3*NWORDS_FP2 );
+  bn128_pairing_fp4_sqr( src +   NWORDS_FP2 , src + 5*NWORDS_FP2 , t + 4*NWORDS_FP2 , t + 5*NWORDS_FP2 );
+  bn128_pairing_fp2_mul_by_xi( t + 5*NWORDS_FP2 , u );
+  bn128_pairing_fp2_3a_minus_2b( t                , src                , tgt                );
+  bn128_pairing_fp2_3a_plus_2b ( t +   NWORDS_FP2 , src + 4*NWORDS_FP2 , tgt + 4*NWORDS_FP2 );
+  bn128_pairing_fp2_3a_plus_2b ( u                , src + 3*NWORDS_FP2 , tgt + 3*NWORDS_FP2 );
+  bn128_pairing_fp2_3a_minus_2b( t + 4*NWORDS_FP2 , src + 2*NWORDS_FP2 , tgt + 2*NWORDS_FP2 );
+  bn128_pairing_fp2_3a_minus_2b( t + 2*NWORDS_FP2 , src +   NWORDS_FP2 , tgt +   NWORDS_FP2 );
+  bn128_pairing_fp2_3a_plus_2b ( t + 3*NWORDS_FP2 , src + 5*NWORDS_FP2 , tgt + 5*NWORDS_FP2 );
+}
+
+void bn128_pairing_cyclotomic_sqr_inplace(uint64_t *tgt) {
+  bn128_pairing_cyclotomic_sqr( tgt , tgt );
+}
+
+// Karabina's compressed squaring in the cyclotomic subgroup. Only the slots 
+// 1, 2, 3, 5 are used and updated; the remaining two can be recovered with
+// `cyclotomic_batch_decompress` below
+void bn128_pairing_cyclotomic_sqr_compressed(const uint64_t *src, uint64_t *tgt) {
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+  uint64_t t2[NWORDS_FP2];
+  uint64_t t3[NWORDS_FP2];
+  uint64_t t4[NWORDS_FP2];
+  uint64_t t5[NWORDS_FP2];
+  uint64_t t6[NWORDS_FP2];
+  const uint64_t *g1 = src +   NWORDS_FP2;
+  const uint64_t *g2 = src + 2*NWORDS_FP2;
+  const uint64_t *g3 = src + 3*NWORDS_FP2;
+  const uint64_t *g5 = src + 5*NWORDS_FP2;
+  uint64_t z1[NWORDS_FP2];
+  uint64_t z2[NWORDS_FP2];
+  uint64_t z3[NWORDS_FP2];
+  uint64_t z5[NWORDS_FP2];
+
+  bn128_Fp2_mont_sqr( g1 , t0 );                    // g1^2
+  bn128_Fp2_mont_sqr( g5 , t1 );                    // g5^2
+  bn128_Fp2_mont_add( g1 , g5 , t5 );
+  bn128_Fp2_mont_sqr( t5 , t2 );                    
+  bn128_Fp2_mont_add( t0 , t1 , t3 );
+  bn128_Fp2_mont_sub( t2 , t3 , t5 );               // 2*g1*g5
+  bn128_Fp2_mont_add( g3 , g2 , t6 );
+  bn128_Fp2_mont_sqr( t6 , t3 );                    // (g2+g3)^2
+  bn128_Fp2_mont_sqr( g3 , t2 );                    // g3^2
+  bn128_pairing_fp2_mul_by_xi( t5 , t6 );           // 2*xi*g1*g5
+  bn128_pairing_fp2_3a_plus_2b( t6 , g3 , z3 );     // z3 = 6*xi*g1*g5 + 2*g3
+
+  bn128_pairing_fp2_mul_by_xi( t1 , t4 );
+  bn128_Fp2_mont_add( t0 , t4 , t5 );               // g1^2 + xi*g5^2
+  bn128_pairing_fp2_3a_minus_2b( t5 , g2 , z2 );    // z2 = 3*(g1^2 + xi*g5^2) - 2*g2
+
+  bn128_Fp2_mont_sqr( g2 , t1 );                    // g2^2
+  bn128_pairing_fp2_mul_by_xi( t1 , t4 );
+  bn128_Fp2_mont_add( t2 , t4 , t5 );               // g3^2 + xi*g2^2
+  bn128_pairing_fp2_3a_minus_2b( t5 , g1 , z1 );    // z1 = 3*(g3^2 + xi*g2^2) - 2*g1
+
+  bn128_Fp2_mont_add( t2 , t1 , t0 );
+  bn128_Fp2_mont_sub( t3 , t0 , t5 );               // 2*g2*g3
+  bn128_pairing_fp2_3a_plus_2b( t5 , g5 , z5 );     // z5 = 6*g2*g3 + 2*g5
+
+  bn128_Fp2_mont_copy( z1 , tgt +   NWORDS_FP2 );
+  bn128_Fp2_mont_copy( z2 , tgt + 2*NWORDS_FP2 );
+  bn128_Fp2_mont_copy( z3 , tgt + 3*NWORDS_FP2 );
+  bn128_Fp2_mont_copy( z5 , tgt + 5*NWORDS_FP2 );
+}
+
+// Recovers the slots 0 and 4 of `n >= 1` compressed elements of the cyclotomic
+// subgroup, in place. The divisions are done with a single batch inversion.
+void bn128_pairing_cyclotomic_batch_decompress(int n, uint64_t *fs) {
+  assert( n >= 1 );
+  uint64_t *num = malloc( 8*NWORDS_FP2 * n );
+  uint64_t *den = malloc( 8*NWORDS_FP2 * n );
+  uint64_t *inv = malloc( 8*NWORDS_FP2 * n );
+  assert( num != 0 );
+  assert( den != 0 );
+  assert( inv != 0 );
+
+  uint64_t t0[NWORDS_FP2];
+  uint64_t t1[NWORDS_FP2];
+
+  for(int k=0; k<n; k++) {
+    const uint64_t *f  = fs + k*NWORDS_FP12;
+    const uint64_t *g1 = f +   NWORDS_FP2;
+    const uint64_t *g2 = f + 2*NWORDS_FP2;
+    const uint64_t *g3 = f + 3*NWORDS_FP2;
+    const uint64_t *g5 = f + 5*NWORDS_FP2;
+    uint64_t *nm = num + k*NWORDS_FP2;
+    uint64_t *dn = den + k*NWORDS_FP2;
+    bn128_Fp2_mont_add( g3 , g3 , dn );
+    bn128_Fp2_mont_add_inplace( dn , dn );                // dn = 4*g3
+    if (bn128_Fp2_mont_is_zero(g3)) {
+      // g4 = 2*g1*g5 / g2
+      bn128_Fp2_mont_mul( g1 , g5 , nm );
+      bn128_Fp2_mont_add_inplace( nm , nm );
+      bn128_Fp2_mont_copy( g2 , dn );
+      // when g2 = g3 = 0, we also have g4 = 0 (for example the unit element)
+      if (bn128_Fp2_mont_is_zero(dn)) { bn128_Fp2_mont_set_one(dn); }
+    }
+    else {
+      // g4 = (xi*g5^2 + 3*g1^2 - 2*g2) / (4*g3)
+      bn128_Fp2_mont_sqr( g1 , t0 );
+      bn128_pairing_fp2_3a_minus_2b( t0 , g2 , t1 );
+      bn128_Fp2_mont_sqr( g5 , t0 );
+      bn128_pairing_fp2_mul_by_xi( t0 , nm );
+      bn128_Fp2_mont_add_inplace( nm , t1 );
+    }
+  }
+
+  bn128_Fp2_mont_batch_inv( n , den , inv );
+
+  for(int k=0; k<n; k++) {
+    uint64_t *f  = fs + k*NWORDS_FP12;
+    const uint64_t *g1 = f +   NWORDS_FP2;
+    const uint64_t *g2 = f + 2*NWORDS_FP2;
+    const uint64_t *g3 = f + 3*NWORDS_FP2;
+    const uint64_t *g5 = f + 5*NWORDS_FP2;
+    uint64_t *g0 = f;
+    uint64_t *g4 = f + 4*NWORDS_FP2;
+    bn128_Fp2_mont_mul( num + k*NWORDS_FP2 , inv + k*NWORDS_FP2 , g4 );
+    // g0 = xi*(2*g4^2 + g3*g5 - 3*g1*g2) + 1
+    bn128_Fp2_mont_mul( g1 , g2 , t1 );
+    bn128_Fp2_mont_sqr( g4 , t0 );
+    bn128_pairing_fp2_3a_minus_2b( t1 , t0 , t0 );
+    bn128_Fp2_mont_neg_inplace( t0 );
+    bn128_Fp2_mont_mul( g3 , g5 , t1 );
+    bn128_Fp2_mont_add_inplace( t0 , t1 );
+    bn128_pairing_fp2_mul_by_xi( t0 , g0 );
+    bn128_Fp2_mont_set_one( t1 );
+    bn128_Fp2_mont_add_inplace( g0 , t1 );
+  }
+
+  free(inv);
+  free(den);
+  free(num);
+}
+
+// exponentiation in the cyclotomic subgroup by a 64 bit exponent (square-and-multiply)
+void bn128_pairing_cyclotomic_pow_uint64(const uint64_t *src, uint64_t expo, uint64_t *tgt) {
+  uint64_t acc[NWORDS_FP12];
+  bn128_Fp12_mont_set_one( acc );
+  for(int i=63; i>=0; i--) {
+    bn128_pairing_cyclotomic_sqr_inplace( acc );
+    if ((expo >> i) & 1) { bn128_Fp12_mont_mul_inplace( acc , src ); }
+  }
+  bn128_Fp12_mont_copy( acc , tgt );
+}
+
+// exponentiation in the cyclotomic subgroup by a 64 bit exponent, using compressed
+// squarings. This is efficient when the exponent has only few nonzero bits: the 
+// squares corresponding to the nonzero bits are decompressed together at the end.
+void bn128_pairing_cyclotomic_pow_uint64_compressed(const uint64_t *src, uint64_t expo, uint64_t *tgt) {
+  int cnt = 0;
+  for(int i=1; i<64; i++) { if ((expo >> i) & 1) cnt++; }
+  if (cnt == 0) {
+    if (expo & 1) { bn128_Fp12_mont_copy( src , tgt ); } else { bn128_Fp12_mont_set_one( tgt ); }
+    return;
+  }
+
+  uint64_t *sqs = malloc( 8*NWORDS_FP12 * cnt );
+  assert( sqs != 0 );
+  uint64_t acc[NWORDS_FP12];
+  uint64_t cur[NWORDS_FP12];
+  if (expo & 1) { bn128_Fp12_mont_copy( src , acc ); } else { bn128_Fp12_mont_set_one( acc ); }
+  bn128_Fp12_mont_copy( src , cur );
+  int k = 0;
+  for(int i=1; k<cnt; i++) {
+    bn128_pairing_cyclotomic_sqr_compressed( cur , cur );     // x^(2^i)
+    if ((expo >> i) & 1) { bn128_Fp12_mont_copy( cur , sqs + (k++)*NWORDS_FP12 ); }
+  }
+  bn128_pairing_cyclotomic_batch_decompress( cnt , sqs );
+
+  for(int k=0; k<cnt; k++) { bn128_Fp12_mont_mul_inplace( acc , sqs + k*NWORDS_FP12 ); }
+  bn128_Fp12_mont_copy( acc , tgt );
+  free(sqs);
+}
+
+#define EXPO_BIT(i) ((expo[(i)>>6] >> ((i)&63)) & 1)
+
+// exponentiation in the cyclotomic subgroup by a nonnegative bigint exponent of
+// `expo_len` words, using left-to-right sliding windows (with precomputed odd powers)
+// and cyclotomic squarings
+void bn128_pairing_cyclotomic_pow_gen(const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len) {
+  int nbits = 64*expo_len;
+  while( (nbits > 0) && !EXPO_BIT(nbits-1) ) { nbits--; }
+  if (nbits == 0) {
+    bn128_Fp12_mont_set_one( tgt );
+    return;
+  }
+
+  // table[k] = src^(2k+1)
+  int w = (nbits <= 64) ? 3 : 4;
+  uint64_t table[8*NWORDS_FP12];
+  uint64_t acc  [NWORDS_FP12];
+  bn128_Fp12_mont_copy( src , table );
+  bn128_pairing_cyclotomic_sqr( src , acc );
+  for(int k=1; k<(1<<(w-1)); k++) {
+    bn128_Fp12_mont_mul( table + (k-1)*NWORDS_FP12 , acc , table + k*NWORDS_FP12 );
+  }
+
+  int first = 1;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!EXPO_BIT(i)) {
+      bn128_pairing_cyclotomic_sqr_inplace( acc );
+      i--;
+      continue;
+    }
+    int j = (i >= w-1) ? (i-w+1) : 0;
+    while (!EXPO_BIT(j)) { j++; }
+    int d = 0;
+    for(int k=i; k>=j; k--) { d = (d<<1) | EXPO_BIT(k); }
+    if (first) {
+      bn128_Fp12_mont_copy( table + (d>>1)*NWORDS_FP12 , acc );
+      first = 0;
+    }
+    else {
+      for(int k=i; k>=j; k--) { bn128_pairing_cyclotomic_sqr_inplace( acc ); }
+      bn128_Fp12_mont_mul_inplace( acc , table + (d>>1)*NWORDS_FP12 );
+    }
+    i = j - 1;
+  }
+  bn128_Fp12_mont_copy( acc , tgt );
+}
+
+#undef EXPO_BIT
+
+//------------------------------------------------------------------------------
+
+
+// reference implementation of the hard part of the final exponentiation
 
 const uint64_t bn128_pairing_p_minus_lam0[4]                = { 0xb687f7e0078302b6, 0x3a97459a6afe5ea2, 0xb3c4d79d41a91759, 0x0000000000000000 };
 const uint64_t bn128_pairing_lam1_minus_lam0_minus_2lam2[4] = { 0x9d797039be763ba8, 0x0000000000000001, 0x0000000000000000, 0x0000000000000000 };
 const uint64_t bn128_pairing_lam2[4]                        = { 0xf83e9682e87cfd46, 0x6f4d8248eeb859fb, 0x0000000000000000, 0x0000000000000000 };
 
-void bn128_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
+void bn128_pairing_hard_expo_reference(const uint64_t *src, uint64_t *tgt) {
   uint64_t A0[NWORDS_FP12]; 
   uint64_t A1[NWORDS_FP12]; 
   uint64_t A2[NWORDS_FP12]; 
@@ -296,66 +687,136 @@ void bn128_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
   bn128_Fp12_mont_mul_inplace(tgt,A3);
 }
 
+// the BN curve parameter `x` (so that p = 36x^4 + 36x^3 + 24x^2 + 6x + 1)
+const uint64_t bn128_pairing_bn_param_x = 0x44e992b44a6909f1;
+
+// The hard part of the final exponentiation, ie. x -> x^((p^4-p^2+1)/r), for
+// an input in the cyclotomic subgroup. Uses the decomposition
+//
+//   (p^4-p^2+1)/r = lam0 + lam1*p + lam2*p^2 + lam3*p^3 
+//   lam3 = 1
+//   lam2 = 6x^2 + 1
+//   lam1 = -36x^3 - 18x^2 - 12x + 1
+//   lam0 = -36x^3 - 30x^2 - 18x - 2
+//
+// and the addition chain of Scott, Benger, Charlemagne, Perez and Kachisa:
+// "On the final exponentiation for calculating pairings on ordinary elliptic curves"
+void bn128_pairing_hard_expo(const uint64_t *src, uint64_t *tgt) {
+  uint64_t fx [NWORDS_FP12];
+  uint64_t fx2[NWORDS_FP12];
+  uint64_t fx3[NWORDS_FP12];
+  uint64_t y0 [NWORDS_FP12];
+  uint64_t y1 [NWORDS_FP12];
+  uint64_t y2 [NWORDS_FP12];
+  uint64_t y3 [NWORDS_FP12];
+  uint64_t y4 [NWORDS_FP12];
+  uint64_t y5 [NWORDS_FP12];
+  uint64_t y6 [NWORDS_FP12];
+  uint64_t t0 [NWORDS_FP12];
+  uint64_t t1 [NWORDS_FP12];
+
+  bn128_pairing_cyclotomic_pow_uint64( src , bn128_pairing_bn_param_x , fx  );    // f^x
+  bn128_pairing_cyclotomic_pow_uint64( fx  , bn128_pairing_bn_param_x , fx2 );    // f^(x^2)
+  bn128_pairing_cyclotomic_pow_uint64( fx2 , bn128_pairing_bn_param_x , fx3 );    // f^(x^3)
+
+  bn128_Fp12_mont_frobenius  ( src , t0 );
+  bn128_Fp12_mont_frobenius_2( src , t1 );
+  bn128_Fp12_mont_mul( t0 , t1 , y0 );
+  bn128_Fp12_mont_frobenius_3( src , t1 );
+  bn128_Fp12_mont_mul_inplace( y0 , t1 );                 // y0 = f^p * f^(p^2) * f^(p^3)
+
+  bn128_Fp12_mont_cyclotomic_inv( src , y1 );             // y1 = 1/f
+
+  bn128_Fp12_mont_frobenius_2( fx2 , y2 );                // y2 = (f^(x^2))^(p^2)
+
+  bn128_Fp12_mont_frobenius( fx , t1 );
+  bn128_Fp12_mont_cyclotomic_inv( t1 , y3 );              // y3 = 1/(f^x)^p
+
+  bn128_Fp12_mont_frobenius( fx2 , t0 );
+  bn128_Fp12_mont_mul( fx , t0 , y4 );
+  bn128_Fp12_mont_cyclotomic_inv_inplace( y4 );           // y4 = 1/(f^x * (f^(x^2))^p)
+
+  bn128_Fp12_mont_cyclotomic_inv( fx2 , y5 );             // y5 = 1/f^(x^2)
+
+  bn128_Fp12_mont_frobenius( fx3 , t0 );
+  bn128_Fp12_mont_mul( fx3 , t0 , y6 );
+  bn128_Fp12_mont_cyclotomic_inv_inplace( y6 );           // y6 = 1/(f^(x^3) * (f^(x^3))^p)
+
+  // result = y0 * y1^2 * y2^6 * y3^12 * y4^18 * y5^30 * y6^36
+  bn128_pairing_cyclotomic_sqr( y6 , t0 );
+  bn128_Fp12_mont_mul_inplace( t0 , y4 );
+  bn128_Fp12_mont_mul_inplace( t0 , y5 );                 // t0 = y6^2 * y4 * y5
+  bn128_Fp12_mont_mul( y3 , y5 , t1 );
+  bn128_Fp12_mont_mul_inplace( t1 , t0 );                 // t1 = y3 * y5 * t0
+  bn128_Fp12_mont_mul_inplace( t0 , y2 );                 // t0 = t0 * y2
+  bn128_pairing_cyclotomic_sqr_inplace( t1 );
+  bn128_Fp12_mont_mul_inplace( t1 , t0 );
+  bn128_pairing_cyclotomic_sqr_inplace( t1 );             // t1 = (t1^2 * t0)^2
+  bn128_Fp12_mont_mul( t1 , y1 , t0 );                    // t0 = t1 * y1
+  bn128_Fp12_mont_mul_inplace( t1 , y0 );                 // t1 = t1 * y0
+  bn128_pairing_cyclotomic_sqr_inplace( t0 );
+  bn128_Fp12_mont_mul( t0 , t1 , tgt );                   // t0^2 * t1
+}
+
 //--------------------------------------
 
 
-// exponentiation (in Fp12) to the power `(p^12-1)/r`
-void bn128_pairing_final_expo(const uint64_t *src, uint64_t *tgt) {
+// the easy part of the final exponentiation, ie. x -> x^((p^6-1)*(p^2+1))
+void bn128_pairing_easy_expo(const uint64_t *src, uint64_t *tgt) {
   uint64_t A[NWORDS_FP12]; 
-  uint64_t B[NWORDS_FP12]; 
 
-  bn128_Fp12_mont_copy(src, A);
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^p
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^(p^2)
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^(p^3)
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^(p^4)
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^(p^5)
-  bn128_Fp12_mont_frobenius_inplace(A);      // x^(p^6)
+  bn128_Fp12_mont_conjugate(src, A);        // x^(p^6)
   bn128_Fp12_mont_div_inplace(A, src);       // x^(p^6 - 1)
 
-  bn128_Fp12_mont_copy(A, B);
-  bn128_Fp12_mont_frobenius_inplace(B);      // y^p
-  bn128_Fp12_mont_frobenius_inplace(B);      // y^(p^2)
-  bn128_Fp12_mont_mul_inplace(B, A);         // y^(p^2 + 1)
+  bn128_Fp12_mont_frobenius_2(A, tgt);       // y^(p^2)
+  bn128_Fp12_mont_mul_inplace(tgt, A);       // y^(p^2 + 1)
+}
 
+// exponentiation (in Fp12) to the power `(p^12-1)/r`
+void bn128_pairing_final_expo(const uint64_t *src, uint64_t *tgt) {
+  uint64_t B[NWORDS_FP12]; 
+  bn128_pairing_easy_expo(src, B);
   bn128_pairing_hard_expo(B, tgt);
 }
 
 //------------------------------------------------------------------------------
 
+// the two extra lines of the optimal Ate pairing for BN curves, with T = [6x+2]Q
+// from the Miller loop: f = f * line(T, pi(Q)) * line(T+pi(Q), -pi^2(Q)).
+// Note: T is overwritten
+void bn128_pairing_miller_extra_lines(const uint64_t *P, const uint64_t *Q, uint64_t *T, uint64_t *f) {
+  uint64_t line [NWORDS_FP12];    // Fp12
+  uint64_t T2[3*NWORDS_FP2];      // proj G2
+  uint64_t phiQ [2*NWORDS_FP2];   // affine G2
+  uint64_t phi2Q[2*NWORDS_FP2];   // affine G2
+
+  bn128_pairing_frobenius_G2(Q   , phiQ );          //  pi(Q)
+  bn128_pairing_frobenius_G2(phiQ, phi2Q);          //  pi^2(Q)
+  bn128_G2_affine_neg_inplace(phi2Q);               // -pi^2(Q)
+
+  bn128_G2_proj_madd_proj_aff(T,phiQ,T2);           // T2 = T + phiQ;
+
+  bn128_pairing_miller_mixed_add(P,phiQ,T,line);    //         line(T, phiQ)
+  bn128_pairing_mul_by_line_inplace(f,line);        // f = f * line(T, phiQ)
+
+  bn128_pairing_miller_mixed_add(P,phi2Q,T2,line);  //         line(T+phiQ, -phi2Q)
+  bn128_pairing_mul_by_line_inplace(f,line);        // f = f * line(T+phiQ, -phi2Q)
+}
+
 // computes the optimal Ate pairing for BN128. 
 // P and Q are affine points in G1 and G2, respectively
 // tgt is in Fp12
 void bn128_pairing_affine(const uint64_t *P, const uint64_t *Q, uint64_t *tgt) {
   uint64_t f [NWORDS_FP12];      // Fp12
-  uint64_t f2[NWORDS_FP12];      // Fp12
   uint64_t T [3*NWORDS_FP2];     // proj G2
-  uint64_t T2[3*NWORDS_FP2];     // proj G2
-  uint64_t phiQ [2*NWORDS_FP2];  // affine G2
-  uint64_t phi2Q[2*NWORDS_FP2];  // affine G2
 
   if ( bn128_G1_affine_is_infinity(P) || bn128_G2_affine_is_infinity(Q) ) {
     bn128_Fp12_mont_set_one(tgt);
     return;
   }
 
-  bn128_pairing_frobenius_G2(Q   , phiQ );          //  pi(Q)
-  bn128_pairing_frobenius_G2(phiQ, phi2Q);          //  pi^2(Q)
-  bn128_G2_affine_neg_inplace(phi2Q);               // -pi^2(Q)
-
   bn128_pairing_miller_loop(P,Q,T,f);
-
-  //uint64_t tmp[3*NWORDS_FP2];
-  //bn128_G2_proj_from_affine(phiQ,tmp);
-  //bn128_G2_proj_add(T,tmp,T2);
-  bn128_G2_proj_madd_proj_aff(T,phiQ,T2);           // T2 = T + phiQ;
-
-  bn128_pairing_miller_mixed_add(P,phiQ,T,f2);      //         line(T, phiQ)
-  bn128_Fp12_mont_mul_inplace(f,f2);                // f = f * line(T, phiQ)
-
-  bn128_pairing_miller_mixed_add(P,phi2Q,T2,f2);    //         line(T+phiQ, -phi2Q)
-  bn128_Fp12_mont_mul_inplace(f,f2);                // f = f * line(T+phiQ, -phi2Q)
- 
+  bn128_pairing_miller_extra_lines(P,Q,T,f);
   bn128_pairing_final_expo(f, tgt);
 }
 
@@ -374,3 +835,600 @@ void bn128_pairing_projective(const uint64_t *P, const uint64_t *Q, uint64_t *tg
 }
 
 //------------------------------------------------------------------------------
+
+// Miller loops with the running points `T` in affine coordinates.
+//
+// Affine doubling and addition need a division per step; when running several
+// Miller loops in lockstep, the inversions are shared between all the pairs using
+// Montgomery's batch inversion, so each step costs a single Fp2 inversion in total.
+// For enough pairs, this is cheaper than the projective formulas.
+//
+// The resulting lines are the projective ones scaled by some elements of Fp2 (which
+// are killed by the final exponentiation), namely `Y_p - lambda*X_p + (lambda*x_T - y_T)`.
+// So the Miller function differs from `multi_miller_loop`, but the pairing is the same.
+
+// f *= line, where the affine line is `Y_p - lambda*X_p + c1` (with the appropriate twist)
+void bn128_pairing_mul_by_affine_line_inplace(uint64_t *f, const uint64_t *P, const uint64_t *lambda, const uint64_t *c1) {
+  uint64_t A[NWORDS_FP2];
+  uint64_t B[NWORDS_FP2];
+  bn128_Fp2_mont_from_prime_field( Py, A );
+  bn128_Fp2_mont_scale_by_prime_field( Px, lambda, B );
+  bn128_Fp2_mont_neg_inplace( B );
+  bn128_pairing_fp12_mul_by_034_inplace( f , A , B , c1 );
+}
+
+// the slope of the tangent at T, as a fraction `3*x^2 / 2*y`
+void bn128_pairing_affine_slope_double(const uint64_t *T, uint64_t *num, uint64_t *den) {
+  bn128_Fp2_mont_sqr( Tx , den );
+  bn128_Fp2_mont_add( den , den , num );
+  bn128_Fp2_mont_add_inplace( num , den );          // num = 3*x^2
+  bn128_Fp2_mont_add( Ty , Ty , den );              // den = 2*y
+}
+
+// the slope of the line through T and Q, as a fraction `(y_Q - y_T) / (x_Q - x_T)`.
+// Note: T = -Q cannot happen during the Miller loop, as T is a small multiple of Q.
+void bn128_pairing_affine_slope_add(const uint64_t *T, const uint64_t *Q, uint64_t *num, uint64_t *den) {
+  if ( bn128_Fp2_mont_is_equal(Tx,Qx) && bn128_Fp2_mont_is_equal(Ty,Qy) ) {
+    // Q = T
+    bn128_pairing_affine_slope_double(T, num, den);
+    return;
+  }
+  bn128_Fp2_mont_sub( Qy , Ty , num );
+  bn128_Fp2_mont_sub( Qx , Tx , den );
+}
+
+// One step of the affine multi-Miller loop: for all the `m` pairs, computes `T += Q`
+// (or `T = 2*T` if `Qs` is NULL), and multiplies `f` by the corresponding lines.
+// Ps, Qs and Ts are arrays of `m` affine points; `buf` is a scratch buffer of `3*m` Fp2 elements
+void bn128_pairing_affine_multi_step(int m, const uint64_t *Ps, const uint64_t *Qs, uint64_t *Ts, uint64_t *buf, uint64_t *f) {
+  uint64_t *nums = buf;
+  uint64_t *dens = buf +   m*NWORDS_FP2;
+  uint64_t *invs = buf + 2*m*NWORDS_FP2;
+
+  for(int j=0; j<m; j++) {
+    const uint64_t *T = Ts + j*(2*NWORDS_FP2);
+    if (Qs) {
+      bn128_pairing_affine_slope_add( T, Qs + j*(2*NWORDS_FP2), nums + j*NWORDS_FP2, dens + j*NWORDS_FP2 );
+    }
+    else {
+      bn128_pairing_affine_slope_double( T, nums + j*NWORDS_FP2, dens + j*NWORDS_FP2 );
+    }
+  }
+
+  bn128_Fp2_mont_batch_inv( m, dens, invs );
+
+  for(int j=0; j<m; j++) {
+    const uint64_t *P  = Ps + j*(2*NWORDS_FP );
+    uint64_t       *T  = Ts + j*(2*NWORDS_FP2);
+    const uint64_t *x2 = Qs ? (Qs + j*(2*NWORDS_FP2)) : T;
+    uint64_t lambda[NWORDS_FP2];
+    uint64_t c1[NWORDS_FP2];
+    uint64_t x3[NWORDS_FP2];
+    uint64_t tmp[NWORDS_FP2];
+
+    bn128_Fp2_mont_mul( nums + j*NWORDS_FP2 , invs + j*NWORDS_FP2 , lambda );
+    bn128_Fp2_mont_sqr( lambda , x3 );
+    bn128_Fp2_mont_sub_inplace( x3 , Tx );
+    bn128_Fp2_mont_sub_inplace( x3 , x2 );              // x3 = lambda^2 - x1 - x2
+    bn128_Fp2_mont_mul( lambda , Tx , c1 );
+    bn128_Fp2_mont_sub_inplace( c1 , Ty );              // c1 = lambda*x1 - y1
+    bn128_Fp2_mont_mul( lambda , x3 , tmp );
+    bn128_Fp2_mont_sub( c1 , tmp , Ty );                // y3 = lambda*(x1 - x3) - y1
+    bn128_Fp2_mont_copy( x3 , Tx );
+
+    bn128_pairing_mul_by_affine_line_inplace( f, P, lambda, c1 );
+  }
+}
+
+// The same as `multi_miller_loop`, but with affine coordinates and batched inversions
+// (the result differs by a factor which is killed by the final exponentiation)
+void bn128_pairing_multi_miller_loop_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f) {
+  uint64_t f[NWORDS_FP12];
+  int N1 = (n>0 ? n : 1);
+
+  uint64_t *Pc  = malloc( 8 * (2*NWORDS_FP ) * N1 );
+  uint64_t *Qc  = malloc( 8 * (2*NWORDS_FP2) * N1 );
+  uint64_t *Ts  = malloc( 8 * (2*NWORDS_FP2) * N1 );
+  uint64_t *buf = malloc( 8 * (3*NWORDS_FP2) * N1 );
+  assert( Pc  != 0 );
+  assert( Qc  != 0 );
+  assert( Ts  != 0 );
+  assert( buf != 0 );
+
+  // the non-trivial pairs, and the initial T = Q points
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P = Ps + k*(2*NWORDS_FP );
+    const uint64_t *Q = Qs + k*(2*NWORDS_FP2);
+    if ( !bn128_G1_affine_is_infinity(P) && !bn128_G2_affine_is_infinity(Q) ) {
+      bn128_G1_affine_copy( P, Pc + m*(2*NWORDS_FP ) );
+      bn128_G2_affine_copy( Q, Qc + m*(2*NWORDS_FP2) );
+      bn128_G2_affine_copy( Q, Ts + m*(2*NWORDS_FP2) );
+      m++;
+    }
+  }
+
+  bn128_Fp12_mont_set_one(f);
+
+  if (m > 0) {
+    uint64_t x = bn128_miller_loop_param;
+    for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+      bn128_Fp12_mont_sqr_inplace(f);
+      bn128_pairing_affine_multi_step( m, Pc, NULL, Ts, buf, f );
+      if ((x>>i)&1) {
+        bn128_pairing_affine_multi_step( m, Pc, Qc, Ts, buf, f );
+      }
+    }
+
+    // the two extra lines of the optimal Ate pairing: T += pi(Q), then the line through T and -pi^2(Q)
+    for(int j=0; j<m; j++) {
+      uint64_t tmp[2*NWORDS_FP2];
+      bn128_pairing_frobenius_G2( Qc + j*(2*NWORDS_FP2), tmp );
+      bn128_G2_affine_copy( tmp, Qc + j*(2*NWORDS_FP2) );                     //  pi(Q)
+    }
+    bn128_pairing_affine_multi_step( m, Pc, Qc, Ts, buf, f );
+    for(int j=0; j<m; j++) {
+      uint64_t tmp[2*NWORDS_FP2];
+      bn128_pairing_frobenius_G2( Qc + j*(2*NWORDS_FP2), tmp );
+      bn128_G2_affine_neg( tmp, Qc + j*(2*NWORDS_FP2) );                      // -pi^2(Q)
+    }
+    bn128_pairing_affine_multi_step( m, Pc, Qc, Ts, buf, f );
+  }
+
+  bn128_Fp12_mont_copy(f, out_f);
+  free(buf);
+  free(Ts);
+  free(Qc);
+  free(Pc);
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, using the affine Miller loop.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bn128_pairing_multi_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bn128_pairing_multi_miller_loop_affine(n,Ps,Qs,f);
+  bn128_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+// Miller loops of several pairs of points, run in lockstep so that the squarings
+// of the accumulator `f` are shared. Pairs where either point is the infinity are skipped.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively.
+// The output is the product of the Miller functions (before the final exponentiation)
+void bn128_pairing_multi_miller_loop(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f) {
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  uint64_t f[NWORDS_FP12];
+
+  int      *idx = malloc( sizeof(int)            * (n>0 ? n : 1) );
+  uint64_t *Ts  = malloc( 8 * (3*NWORDS_FP2)     * (n>0 ? n : 1) );
+  assert( idx != 0 );
+  assert( Ts  != 0 );
+
+  // the non-trivial pairs, and the initial T = Q points
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P = Ps + k*(2*NWORDS_FP );
+    const uint64_t *Q = Qs + k*(2*NWORDS_FP2);
+    if ( !bn128_G1_affine_is_infinity(P) && !bn128_G2_affine_is_infinity(Q) ) {
+      bn128_G2_proj_from_affine(Q, Ts + m*(3*NWORDS_FP2));
+      idx[m++] = k;
+    }
+  }
+
+  bn128_Fp12_mont_set_one(f);
+
+  uint64_t x = bn128_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bn128_Fp12_mont_sqr_inplace(f);
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps + idx[j]*(2*NWORDS_FP);
+      uint64_t       *T = Ts +      j*(3*NWORDS_FP2);
+      bn128_pairing_miller_double_coeffs(T,coeffs);
+      bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
+    }
+    if ((x>>i)&1) {
+      for(int j=0; j<m; j++) {
+        const uint64_t *P = Ps + idx[j]*(2*NWORDS_FP );
+        const uint64_t *Q = Qs + idx[j]*(2*NWORDS_FP2);
+        uint64_t       *T = Ts +      j*(3*NWORDS_FP2);
+        bn128_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+        bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);
+      }
+    }
+  }
+
+  // the two extra lines of the optimal Ate pairing
+  for(int j=0; j<m; j++) {
+    const uint64_t *P = Ps + idx[j]*(2*NWORDS_FP );
+    const uint64_t *Q = Qs + idx[j]*(2*NWORDS_FP2);
+    uint64_t       *T = Ts +      j*(3*NWORDS_FP2);
+    uint64_t T2[3*NWORDS_FP2];     // proj G2
+    uint64_t phiQ [2*NWORDS_FP2];  // affine G2
+    uint64_t phi2Q[2*NWORDS_FP2];  // affine G2
+
+    bn128_pairing_frobenius_G2(Q   , phiQ );          //  pi(Q)
+    bn128_pairing_frobenius_G2(phiQ, phi2Q);          //  pi^2(Q)
+    bn128_G2_affine_neg_inplace(phi2Q);               // -pi^2(Q)
+
+    bn128_G2_proj_madd_proj_aff(T,phiQ,T2);           // T2 = T + phiQ;
+
+    bn128_pairing_miller_mixed_add_coeffs(phiQ,T,coeffs);    //         line(T, phiQ)
+    bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);     // f = f * line(T, phiQ)
+
+    bn128_pairing_miller_mixed_add_coeffs(phi2Q,T2,coeffs);  //         line(T+phiQ, -phi2Q)
+    bn128_pairing_mul_by_line_coeffs_inplace(f,P,coeffs);     // f = f * line(T+phiQ, -phi2Q)
+  }
+
+  bn128_Fp12_mont_copy(f, out_f);
+  free(Ts);
+  free(idx);
+}
+
+// above this many pairs, the affine Miller loop (with batched inversions) is faster
+#define MULTI_MILLER_AFFINE_THRESHOLD 16
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, with a single final exponentiation.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bn128_pairing_multi(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  if (n > MULTI_MILLER_AFFINE_THRESHOLD) {
+    bn128_pairing_multi_miller_loop_affine(n,Ps,Qs,f);
+  }
+  else {
+    bn128_pairing_multi_miller_loop(n,Ps,Qs,f);
+  }
+  bn128_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+// "prepared" G2 points: when one of the arguments of the pairing is fixed (for example
+// the G2 generator or [tau]_2 in KZG, or a public key), all the line coefficients of
+// the Miller loop can be precomputed, so that no G2 arithmetic remains in the pairing.
+//
+// layout: `prep[0]` is 1 if Q is the infinity (and 0 otherwise), followed by
+// the coefficients `(cy,cx,c1)` of the lines, in the order the Miller loop consumes them
+
+#define PREPARED_G2_NLINES  102
+#define PREPARED_G2_NWORDS  2449    // 1 + NLINES*NWORDS_LINE_COEFFS
+
+int bn128_pairing_prepared_G2_nwords() {
+  return PREPARED_G2_NWORDS;
+}
+
+// precomputes the line coefficients for the affine point Q in G2.
+// Requires a target buffer of size `PREPARED_G2_NWORDS`
+void bn128_pairing_prepare_G2(const uint64_t *Q, uint64_t *prep) {
+  uint64_t T[3*NWORDS_FP2];
+
+  if ( bn128_G2_affine_is_infinity(Q) ) {
+    memset( prep, 0, 8*PREPARED_G2_NWORDS );
+    prep[0] = 1;
+    return;
+  }
+
+  prep[0] = 0;
+  uint64_t *coeffs = prep + 1;
+  bn128_G2_proj_from_affine(Q,T);
+
+  uint64_t x = bn128_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bn128_pairing_miller_double_coeffs(T,coeffs);
+    coeffs += NWORDS_LINE_COEFFS;
+    if ((x>>i)&1) {
+      bn128_pairing_miller_mixed_add_coeffs(Q,T,coeffs);
+      coeffs += NWORDS_LINE_COEFFS;
+    }
+  }
+
+  // the two extra lines of the optimal Ate pairing
+  uint64_t T2[3*NWORDS_FP2];     // proj G2
+  uint64_t phiQ [2*NWORDS_FP2];  // affine G2
+  uint64_t phi2Q[2*NWORDS_FP2];  // affine G2
+
+  bn128_pairing_frobenius_G2(Q   , phiQ );          //  pi(Q)
+  bn128_pairing_frobenius_G2(phiQ, phi2Q);          //  pi^2(Q)
+  bn128_G2_affine_neg_inplace(phi2Q);               // -pi^2(Q)
+
+  bn128_G2_proj_madd_proj_aff(T,phiQ,T2);           // T2 = T + phiQ;
+
+  bn128_pairing_miller_mixed_add_coeffs(phiQ,T,coeffs);    // line(T, phiQ)
+  coeffs += NWORDS_LINE_COEFFS;
+  bn128_pairing_miller_mixed_add_coeffs(phi2Q,T2,coeffs);  // line(T+phiQ, -phi2Q)
+  coeffs += NWORDS_LINE_COEFFS;
+
+  assert( coeffs == prep + PREPARED_G2_NWORDS );
+}
+
+// Miller loops of several pairs of points, where the G2 points are prepared.
+// Ps is an array of `n` affine points in G1, and preps are `n` consecutive prepared
+// G2 points (each of size `PREPARED_G2_NWORDS`). Pairs where either point is the
+// infinity are skipped. The output is the product of the Miller functions
+void bn128_pairing_multi_miller_loop_prepared(int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *out_f) {
+  uint64_t f[NWORDS_FP12];
+
+  int *idx = malloc( sizeof(int) * (n>0 ? n : 1) );
+  assert( idx != 0 );
+
+  int m = 0;
+  for(int k=0; k<n; k++) {
+    const uint64_t *P    = Ps    + k*(2*NWORDS_FP);
+    const uint64_t *prep = preps + k*PREPARED_G2_NWORDS;
+    if ( !bn128_G1_affine_is_infinity(P) && !prep[0] ) { idx[m++] = k; }
+  }
+
+  bn128_Fp12_mont_set_one(f);
+
+  int ofs = 1;     // offset of the current line in the prepared points
+  uint64_t x = bn128_miller_loop_param;
+  for(int i=MILLER_LOOP_LENGTH-1; i>=0; i--) {
+    bn128_Fp12_mont_sqr_inplace(f);
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+      const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+      bn128_pairing_mul_by_line_coeffs_inplace(f,P,c);
+    }
+    ofs += NWORDS_LINE_COEFFS;
+    if ((x>>i)&1) {
+      for(int j=0; j<m; j++) {
+        const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+        const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+        bn128_pairing_mul_by_line_coeffs_inplace(f,P,c);
+      }
+      ofs += NWORDS_LINE_COEFFS;
+    }
+  }
+
+  // the remaining lines (the two extra lines of the optimal Ate pairing for BN curves)
+  while (ofs < PREPARED_G2_NWORDS) {
+    for(int j=0; j<m; j++) {
+      const uint64_t *P = Ps    + idx[j]*(2*NWORDS_FP);
+      const uint64_t *c = preps + idx[j]*PREPARED_G2_NWORDS + ofs;
+      bn128_pairing_mul_by_line_coeffs_inplace(f,P,c);
+    }
+    ofs += NWORDS_LINE_COEFFS;
+  }
+
+  bn128_Fp12_mont_copy(f, out_f);
+  free(idx);
+}
+
+// computes the pairing `e(P,Q)`, where Q in G2 is prepared
+// P is an affine point in G1, tgt is in Fp12
+void bn128_pairing_affine_prepared(const uint64_t *P, const uint64_t *prep, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bn128_pairing_multi_miller_loop_prepared(1,P,prep,f);
+  bn128_pairing_final_expo(f,tgt);
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, where the Q_i are prepared
+// Ps is an array of `n` affine points in G1, preps is `n` consecutive prepared G2 points
+// tgt is in Fp12
+void bn128_pairing_multi_prepared(int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  bn128_pairing_multi_miller_loop_prepared(n,Ps,preps,f);
+  bn128_pairing_final_expo(f,tgt);
+}
+
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// parallel pairing
+//
+// Latency-oriented versions, which run the independent parts of a single pairing
+// (or of a product of pairings) on the worker threads of `parallel.h`. With a single
+// thread, these fall back to the sequential versions.
+
+// The Miller loop is split at the bit `k = MILLER_SPLIT_BIT` of the loop parameter
+// `s = a*2^k + b`. The first part of the loop ends with `f_a` and `T = [a]Q`, and the
+// rest only squares `f` and multiplies it by lines depending on `T` and `Q`. Hence
+//
+//   f_s = (f_a)^(2^k) * g
+//
+// where `g` is the second part of the loop started from `f = 1` and `T = [a]Q` (computed
+// by a scalar multiplication), so the two parts are independent. The projective
+// coordinates of `T` differ from the sequential loop, thus the lines differ by factors
+// in Fp2; these are killed by the final exponentiation.
+#define MILLER_SPLIT_BIT 40
+
+typedef struct {
+  const uint64_t *P;
+  const uint64_t *Q;
+        uint64_t *f_hi;     // (f_a)^(2^k)
+        uint64_t *f_lo;     // g
+        uint64_t *T;        // the final T
+} bn128_pairing_miller_split_ctx_t;
+
+void bn128_pairing_miller_split_task(void *ctx, int idx) {
+  bn128_pairing_miller_split_ctx_t *c = (bn128_pairing_miller_split_ctx_t*) ctx;
+  uint64_t coeffs[NWORDS_LINE_COEFFS];
+  uint64_t T [3*NWORDS_FP2];
+  uint64_t Q0[3*NWORDS_FP2];
+  uint64_t x = bn128_miller_loop_param;
+  bn128_G2_proj_from_affine(c->Q,Q0);
+  if (idx == 0) {
+    // the top bits of the loop, then the squarings
+    uint64_t *f = c->f_hi;
+    bn128_Fp12_mont_set_one(f);
+    bn128_G2_proj_copy(Q0,T);
+    for(int i=MILLER_LOOP_LENGTH-1; i>=MILLER_SPLIT_BIT; i--) {
+      bn128_Fp12_mont_sqr_inplace(f);
+      bn128_pairing_miller_double_coeffs(T,coeffs);
+      bn128_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      if ((x>>i)&1) {
+        bn128_pairing_miller_mixed_add_coeffs(c->Q,T,coeffs);
+        bn128_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      }
+    }
+    for(int i=0; i<MILLER_SPLIT_BIT; i++) { bn128_Fp12_mont_sqr_inplace(f); }
+  }
+  else {
+    // the bottom bits, starting from T = [a]Q; here `a` includes the implicit top bit
+    uint64_t *f = c->f_lo;
+    uint64_t a = (x >> MILLER_SPLIT_BIT) | (1ULL << (MILLER_LOOP_LENGTH - MILLER_SPLIT_BIT));
+    bn128_G2_proj_scl_small(a,Q0,T);
+    bn128_Fp12_mont_set_one(f);
+    for(int i=MILLER_SPLIT_BIT-1; i>=0; i--) {
+      if (i < MILLER_SPLIT_BIT-1) { bn128_Fp12_mont_sqr_inplace(f); }      // no need to square 1
+      bn128_pairing_miller_double_coeffs(T,coeffs);
+      bn128_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      if ((x>>i)&1) {
+        bn128_pairing_miller_mixed_add_coeffs(c->Q,T,coeffs);
+        bn128_pairing_mul_by_line_coeffs_inplace(f,c->P,coeffs);
+      }
+    }
+    bn128_G2_proj_copy(T,c->T);
+  }
+}
+
+// the Miller loop, split into two parts running in parallel (see above).
+// The output is the same as `miller_loop`, up to a factor in Fp2
+void bn128_pairing_miller_loop_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f ) {
+  if (parallel_get_num_threads() < 2) {
+    bn128_pairing_miller_loop(P,Q,out_T,out_f);
+    return;
+  }
+  uint64_t f_hi[NWORDS_FP12];
+  uint64_t f_lo[NWORDS_FP12];
+  bn128_pairing_miller_split_ctx_t ctx;
+  ctx.P    = P;
+  ctx.Q    = Q;
+  ctx.f_hi = f_hi;
+  ctx.f_lo = f_lo;
+  ctx.T    = out_T;
+  parallel_for( 2, bn128_pairing_miller_split_task, &ctx );
+  bn128_Fp12_mont_mul(f_hi,f_lo,out_f);
+}
+
+// The hard part of the final exponentiation, using the decomposition of the reference
+// implementation above: the three exponentiations `A0`, `A1`, `A2` are independent,
+// so they run in parallel (each with sliding windows and cyclotomic squarings).
+// The longest of them has about the same number of squarings as the sequential
+// addition chain, but much fewer multiplications.
+
+typedef struct {
+  const uint64_t *src;
+        uint64_t *As;
+} bn128_pairing_hard_expo_ctx_t;
+
+void bn128_pairing_hard_expo_task(void *ctx, int j) {
+  bn128_pairing_hard_expo_ctx_t *c = (bn128_pairing_hard_expo_ctx_t*) ctx;
+  uint64_t *A = c->As + j*NWORDS_FP12;
+  switch(j) {
+    case 0: bn128_pairing_cyclotomic_pow_gen( c->src , bn128_pairing_p_minus_lam0                , A , 3 ); break;
+    case 1: bn128_pairing_cyclotomic_pow_gen( c->src , bn128_pairing_lam1_minus_lam0_minus_2lam2 , A , 2 ); break;
+    case 2: bn128_pairing_cyclotomic_pow_gen( c->src , bn128_pairing_lam2                        , A , 2 ); break;
+  }
+}
+
+void bn128_pairing_hard_expo_parallel(const uint64_t *src, uint64_t *tgt) {
+  if (parallel_get_num_threads() < 2) {
+    bn128_pairing_hard_expo(src,tgt);
+    return;
+  }
+  uint64_t As[3*NWORDS_FP12];
+  uint64_t A3[NWORDS_FP12];
+  uint64_t *A0 = As;
+  uint64_t *A1 = As +   NWORDS_FP12;
+  uint64_t *A2 = As + 2*NWORDS_FP12;
+  bn128_pairing_hard_expo_ctx_t ctx;
+  ctx.src = src;
+  ctx.As  = As;
+  parallel_for( 3, bn128_pairing_hard_expo_task, &ctx );
+
+  bn128_Fp12_mont_frobenius( src, A3 );                  // x0^p
+  bn128_Fp12_mont_cyclotomic_inv_inplace( A0 );
+  bn128_Fp12_mont_mul_inplace( A0, A3 );                 // x0^p / x0^(p-lam0) = x0^lam0
+  bn128_Fp12_mont_mul_inplace( A1, A0 );
+  bn128_Fp12_mont_mul_inplace( A1, A2 );
+  bn128_Fp12_mont_mul_inplace( A1, A2 );                 // x0^lam1
+
+  bn128_Fp12_mont_frobenius_3( src, A3 );                // frob^3(x0)
+  bn128_Fp12_mont_frobenius_inplace( A1 );               // frob  (x0^lam1)
+  bn128_Fp12_mont_frobenius_2( A2, tgt );                // frob^2(x0^lam2)
+  bn128_Fp12_mont_mul_inplace( tgt, A0 );
+  bn128_Fp12_mont_mul_inplace( tgt, A1 );
+  bn128_Fp12_mont_mul_inplace( tgt, A3 );
+}
+
+// the final exponentiation, with the hard part computed in parallel
+void bn128_pairing_final_expo_parallel(const uint64_t *src, uint64_t *tgt) {
+  uint64_t B[NWORDS_FP12];
+  bn128_pairing_easy_expo(src, B);
+  bn128_pairing_hard_expo_parallel(B, tgt);
+}
+
+// computes the optimal Ate pairing, running the independent parts in parallel
+// P and Q are affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bn128_pairing_affine_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *tgt) {
+  uint64_t f[NWORDS_FP12];
+  uint64_t T[3*NWORDS_FP2];
+  if ( bn128_G1_affine_is_infinity(P) || bn128_G2_affine_is_infinity(Q) ) {
+    bn128_Fp12_mont_set_one(tgt);
+    return;
+  }
+  bn128_pairing_miller_loop_parallel(P,Q,T,f);
+  bn128_pairing_miller_extra_lines(P,Q,T,f);
+  bn128_pairing_final_expo_parallel(f,tgt);
+}
+
+typedef struct {
+  int n;
+  int nchunks;
+  const uint64_t *Ps;
+  const uint64_t *Qs;
+        uint64_t *fs;
+} bn128_pairing_multi_ctx_t;
+
+void bn128_pairing_multi_chunk_task(void *ctx, int j) {
+  bn128_pairing_multi_ctx_t *c = (bn128_pairing_multi_ctx_t*) ctx;
+  int a = ( j   *c->n) / c->nchunks;
+  int b = ((j+1)*c->n) / c->nchunks;
+  const uint64_t *Ps = c->Ps + a*(2*NWORDS_FP );
+  const uint64_t *Qs = c->Qs + a*(2*NWORDS_FP2);
+  if (b-a > MULTI_MILLER_AFFINE_THRESHOLD) {
+    bn128_pairing_multi_miller_loop_affine(b-a,Ps,Qs,c->fs + j*NWORDS_FP12);
+  }
+  else {
+    bn128_pairing_multi_miller_loop(b-a,Ps,Qs,c->fs + j*NWORDS_FP12);
+  }
+}
+
+// computes the product of pairings `prod_i e(P_i,Q_i)`, running the Miller loops of
+// disjoint chunks of the pairs in parallel, followed by the (parallel) final exponentiation.
+// Ps and Qs are arrays of `n` affine points in G1 and G2, respectively
+// tgt is in Fp12
+void bn128_pairing_multi_parallel(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt) {
+  if (n == 1) {
+    bn128_pairing_affine_parallel(Ps,Qs,tgt);
+    return;
+  }
+  int nchunks = parallel_get_num_threads();
+  if (nchunks > n) { nchunks = n; }
+  if (nchunks < 2) {
+    bn128_pairing_multi(n,Ps,Qs,tgt);
+    return;
+  }
+
+  uint64_t *fs = malloc( 8*NWORDS_FP12 * nchunks );
+  assert( fs != 0 );
+  bn128_pairing_multi_ctx_t ctx;
+  ctx.n       = n;
+  ctx.nchunks = nchunks;
+  ctx.Ps      = Ps;
+  ctx.Qs      = Qs;
+  ctx.fs      = fs;
+  parallel_for( nchunks, bn128_pairing_multi_chunk_task, &ctx );
+
+  uint64_t f[NWORDS_FP12];
+  bn128_Fp12_mont_copy(fs,f);
+  for(int j=1; j<nchunks; j++) { bn128_Fp12_mont_mul_inplace(f, fs + j*NWORDS_FP12); }
+  free(fs);
+  bn128_pairing_final_expo_parallel(f,tgt);
+}
+
+//------------------------------------------------------------------------------
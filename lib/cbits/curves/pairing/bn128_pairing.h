@@ -2,10 +2,36 @@
 
 void bn128_pairing_affine    (const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
 void bn128_pairing_projective(const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
+void bn128_pairing_multi     (int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
+void bn128_pairing_multi_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
+
+// prepared G2 points (precomputed line coefficients)
+int  bn128_pairing_prepared_G2_nwords();
+void bn128_pairing_prepare_G2     (const uint64_t *Q, uint64_t *prep);
+void bn128_pairing_affine_prepared(const uint64_t *P, const uint64_t *prep, uint64_t *tgt);
+void bn128_pairing_multi_prepared (int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *tgt);
+
+// parallel versions, using the threads of `parallel.h`
+void bn128_pairing_affine_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
+void bn128_pairing_multi_parallel (int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
 
 // for testing purposes:
 void bn128_pairing_psi        (const uint64_t *src, uint64_t *tgt);
 void bn128_pairing_inverse_psi(const uint64_t *src, uint64_t *tgt);
 void bn128_pairing_final_expo (const uint64_t *src, uint64_t *tgt);
 void bn128_pairing_hard_expo  (const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_hard_expo_reference(const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_final_expo_parallel(const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_hard_expo_parallel (const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_cyclotomic_sqr(const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_cyclotomic_sqr_compressed(const uint64_t *src, uint64_t *tgt);
+void bn128_pairing_cyclotomic_batch_decompress(int n, uint64_t *fs);
+void bn128_pairing_cyclotomic_pow_uint64(const uint64_t *src, uint64_t expo, uint64_t *tgt);
+void bn128_pairing_cyclotomic_pow_uint64_compressed(const uint64_t *src, uint64_t expo, uint64_t *tgt);
+void bn128_pairing_cyclotomic_pow_gen(const uint64_t *src, const uint64_t *expo, uint64_t *tgt, int expo_len);
 void bn128_pairing_miller_loop(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f );
+void bn128_pairing_miller_loop_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *out_T, uint64_t *out_f );
+void bn128_pairing_multi_miller_loop(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f);
+void bn128_pairing_multi_miller_loop_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *out_f);
+void bn128_pairing_multi_miller_loop_prepared(int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *out_f);
+void bn128_pairing_mul_by_line_inplace(uint64_t *f, const uint64_t *line);
@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include "bls12_381_Fr_mont.h"
+#include "parallel.h"
 
 #define NLIMBS 4
 
@@ -221,8 +222,8 @@ void bls12_381_poly_mont_mul_naive( int  n1, const uint64_t *src1
   }
 }
 
-// evaluate a polynomial at a single point
-void bls12_381_poly_mont_eval_at( int  n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {
+// evaluate a polynomial at a single point, naive algorithm
+void bls12_381_poly_mont_eval_at_naive( int  n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {
   uint64_t run[NLIMBS];               // x^i
   bls12_381_Fr_mont_set_zero(tgt);
   bls12_381_Fr_mont_set_one (run);
@@ -242,11 +243,140 @@ void bls12_381_poly_mont_eval_at( int  n1, const uint64_t *src1, const uint64_t
   }
 }
 
+// -----------------------------------------------------------------------------
+// evaluation at a single point
 
-// polynomial long division
+// below this size we don't bother with multithreaded evaluation
+#define EVAL_PARALLEL_THRESHOLD 16384
+
+// evaluate a polynomial at a single point, using Horner's rule
+void bls12_381_poly_mont_eval_at_horner( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {
+  if (n1 <= 0) {
+    bls12_381_Fr_mont_set_zero( tgt );
+    return;
+  }
+  uint64_t acc[NLIMBS];
+  bls12_381_Fr_mont_copy( SRC1(n1-1) , acc );
+  for(int i=n1-2; i>=0; i--) {
+    bls12_381_Fr_mont_mul_inplace( acc , loc );
+    bls12_381_Fr_mont_add_inplace( acc , SRC1(i) );
+  }
+  bls12_381_Fr_mont_copy( acc , tgt );
+}
+
+typedef struct {
+  int             n1;
+  int             chunk;
+  const uint64_t *src1;
+  const uint64_t *loc;
+        uint64_t *vals;
+} bls12_381_poly_mont_eval_chunks_ctx_t;
+
+// Horner evaluation of the `j`-th chunk of coefficients
+void bls12_381_poly_mont_eval_chunk_task( void *ctx, int j ) {
+  bls12_381_poly_mont_eval_chunks_ctx_t *c = (bls12_381_poly_mont_eval_chunks_ctx_t*) ctx;
+  int a = j * c->chunk;
+  int b = MIN( a + c->chunk , c->n1 );
+  bls12_381_poly_mont_eval_at_horner( b-a, c->src1 + a*NLIMBS, c->loc, c->vals + j*NLIMBS );
+}
+
+// evaluate a polynomial at a single point. Large polynomials are split into
+// chunks which are evaluated in parallel (using Horner's rule), and the
+// partial results are recombined with a Horner step in `loc^chunk_size`
+void bls12_381_poly_mont_eval_at( int n1, const uint64_t *src1, const uint64_t *loc, uint64_t *tgt ) {
+  int T = parallel_get_num_threads();
+  if ( (n1 < EVAL_PARALLEL_THRESHOLD) || (T <= 1) ) {
+    bls12_381_poly_mont_eval_at_horner( n1, src1, loc, tgt );
+    return;
+  }
+
+  int chunk = (n1 + T - 1) / T;
+  int m     = (n1 + chunk - 1) / chunk;
+  uint64_t *vals = malloc( 8*NLIMBS * m );
+  assert( vals != 0 );
+
+  bls12_381_poly_mont_eval_chunks_ctx_t ctx;
+  ctx.n1    = n1;
+  ctx.chunk = chunk;
+  ctx.src1  = src1;
+  ctx.loc   = loc;
+  ctx.vals  = vals;
+  parallel_for( m, bls12_381_poly_mont_eval_chunk_task, &ctx );
+
+  uint64_t step[NLIMBS];
+  bls12_381_Fr_mont_pow_uint64( loc, (uint64_t)chunk, step );
+  bls12_381_poly_mont_eval_at_horner( m, vals, step, tgt );
+  free(vals);
+}
+
+// -----------------------------------------------------------------------------
+// evaluating many polynomials at the same point
+
+typedef struct {
+  const int       *ns;
+  const uint64_t **polys;
+  const uint64_t  *pows;
+        uint64_t  *out;
+} bls12_381_poly_mont_eval_many_ctx_t;
+
+// dot product of the coefficients with the power table
+void bls12_381_poly_mont_eval_many_task( void *ctx, int k ) {
+  bls12_381_poly_mont_eval_many_ctx_t *c = (bls12_381_poly_mont_eval_many_ctx_t*) ctx;
+  const uint64_t *src1 = c->polys[k];
+  const uint64_t *pows = c->pows;
+  int n1 = c->ns[k];
+  uint64_t acc[NLIMBS];
+  uint64_t tmp[NLIMBS];
+  bls12_381_Fr_mont_set_zero( acc );
+  for(int i=0; i<n1; i++) {
+    bls12_381_Fr_mont_mul( SRC1(i) , pows + i*NLIMBS , tmp );
+    bls12_381_Fr_mont_add_inplace( acc , tmp );
+  }
+  bls12_381_Fr_mont_copy( acc , c->out + k*NLIMBS );
+}
+
+// Evaluates `K` polynomials at the same point. The powers of `loc` are computed
+// only once, then each evaluation is a dot product (these run in parallel).
+// Requires a target buffer of size `K`
+void bls12_381_poly_mont_eval_many_at
+  ( int  K                           // number of polynomials
+  , const int *ns                    // sizes of the polynomials
+  , const uint64_t **polys           // pointers to the polynomials
+  , const uint64_t *loc              // the location to evaluate at
+  ,       uint64_t *out              // target buffer
+  ) {
+
+  int N = 0;
+  for(int k=0; k<K; k++) {
+    if (ns[k] > N) { N = ns[k]; }
+  }
+  if (N == 0) {
+    for(int k=0; k<K; k++) { bls12_381_Fr_mont_set_zero( out + k*NLIMBS ); }
+    return;
+  }
+
+  uint64_t *pows = malloc( 8*NLIMBS * N );
+  assert( pows != 0 );
+  bls12_381_Fr_mont_set_one( pows );
+  for(int i=1; i<N; i++) {
+    bls12_381_Fr_mont_mul( pows + (i-1)*NLIMBS , loc , pows + i*NLIMBS );
+  }
+
+  bls12_381_poly_mont_eval_many_ctx_t ctx;
+  ctx.ns    = ns;
+  ctx.polys = polys;
+  ctx.pows  = pows;
+  ctx.out   = out;
+  parallel_for( K, bls12_381_poly_mont_eval_many_task, &ctx );
+
+  free(pows);
+}
+
+
+// polynomial long division, schoolbook algorithm
 // allocate at least `deg(p) - deg(q) + 1` field elements for the quotient
 // and at least `deg(q)` for the remainder
-void bls12_381_poly_mont_long_div( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {
+void bls12_381_poly_mont_long_div_naive( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {
   int deg_p = bls12_381_poly_mont_degree( n1, src1 );
   int deg_q = bls12_381_poly_mont_degree( n2, src2 );
   assert( (!quot) || (nquot >= deg_p - deg_q + 1) );
@@ -296,18 +426,6 @@ void bls12_381_poly_mont_long_div( int n1, const uint64_t *src1, int n2, const u
   free(tgt);
 }
 
-// polynomial quotient
-// allocate at least `deg(p) - deg(q) + 1` field elements for quotient
-void bls12_381_poly_mont_quot( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot ) {
-  bls12_381_poly_mont_long_div( n1, src1, n2, src2, nquot, quot, 0, 0 );
-}
-
-// polynomial remainder
-// allocate at least `deg(q)` field elements for the remainder
-void bls12_381_poly_mont_rem( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nrem, uint64_t *rem ) {
-  bls12_381_poly_mont_long_div( n1, src1, n2, src2, 0, 0, nrem, rem );
-}
-
 
 // divide by the vanishing polynomial of a coset `(x^n - eta)`
 // This should be much faster than the general-purpose long division
@@ -523,3 +641,538 @@ void bls12_381_poly_mont_ntt_inverse(int m, const uint64_t *gen, const uint64_t
 
 // -----------------------------------------------------------------------------
  
+
+// -----------------------------------------------------------------------------
+
+// the largest FFT-friendly subgroup has size `2^FFT_MAX_LOG`
+#define FFT_MAX_LOG 32
+
+// the generator of the largest FFT-friendly subgroup
+const uint64_t bls12_381_poly_mont_fft_gen[4] = { 0xb9b58d8c5f0e466a, 0x5b1b4c801819d7ec, 0x0af53ae352a31e64, 0x5bf3adda19e9b27b };
+
+// below this size we use the naive multiplication algorithm
+#define MUL_NTT_THRESHOLD 48
+
+// returns the generator of the multiplicative subgroup of size `2^m`
+void bls12_381_poly_mont_fft_subgroup_gen( int m, uint64_t *gen ) {
+  assert( (m >= 0) && (m <= FFT_MAX_LOG) );
+  bls12_381_Fr_mont_copy( bls12_381_poly_mont_fft_gen, gen );
+  for(int i=m; i<FFT_MAX_LOG; i++) { bls12_381_Fr_mont_sqr_inplace( gen ); }
+}
+
+// the smallest `m` such that `2^m >= n`
+int bls12_381_poly_mont_ceil_log2( int n ) {
+  int m = 0;
+  while( (1<<m) < n ) { m++; }
+  return m;
+}
+
+// inverse NTT, computed as the forward NTT with the inverse generator followed by
+// a scaling with `1/N`; this avoids the field inversions of `ntt_inverse_noalloc`
+// `buf` should be a scratch buffer of size `2N`
+void bls12_381_poly_mont_ntt_inverse_fwd_noalloc(int m, const uint64_t *gen_inv, const uint64_t *src, uint64_t *buf, uint64_t *tgt) {
+  int N = (1<<m);
+  uint64_t ninv[NLIMBS];
+  bls12_381_Fr_mont_set_one( ninv );
+  for(int i=0; i<m; i++) { bls12_381_Fr_mont_mul_inplace( ninv , bls12_381_poly_mont_oneHalf ); }     // 1/N = (1/2)^m
+  bls12_381_poly_mont_ntt_forward_noalloc( m, 1, gen_inv, src, buf, tgt );
+  for(int i=0; i<N; i++) { bls12_381_Fr_mont_mul_inplace( tgt + i*NLIMBS , ninv ); }
+}
+
+// Multiply two polynomials using NTT.
+// Requires a target buffer of size `(n1+n2-1)` (!)
+void bls12_381_poly_mont_mul_ntt( int  n1, const uint64_t *src1
+             , int  n2, const uint64_t *src2
+             ,                uint64_t *tgt ) {
+
+  int N3 = n1+n2-1;
+  if ( (n1 <= 0) || (n2 <= 0) ) {
+    for(int k=0; k<N3; k++) { bls12_381_Fr_mont_set_zero( TGT(k) ); }
+    return;
+  }
+
+  int m = bls12_381_poly_mont_ceil_log2( N3 );
+  int N = (1<<m);
+  assert( m <= FFT_MAX_LOG );
+
+  uint64_t gen[NLIMBS];
+  uint64_t ginv[NLIMBS];
+  bls12_381_poly_mont_fft_subgroup_gen( m, gen );
+  bls12_381_Fr_mont_inv( gen, ginv );
+
+  // layout: [ padded input | 1st transform | 2nd transform | NTT scratch (2N) ]
+  uint64_t *buf = malloc( 8*NLIMBS * (5*N) );
+  assert( buf != 0 );
+  uint64_t *pad = buf;
+  uint64_t *us  = buf +   N*NLIMBS;
+  uint64_t *vs  = buf + 2*N*NLIMBS;
+  uint64_t *scr = buf + 3*N*NLIMBS;
+
+  memcpy( pad, src1, 8*NLIMBS*n1 );
+  memset( pad + n1*NLIMBS, 0, 8*NLIMBS*(N-n1) );
+  bls12_381_poly_mont_ntt_forward_noalloc( m, 1, gen, pad, scr, us );
+
+  if ( (src1 == src2) && (n1 == n2) ) {
+    // squaring
+    for(int i=0; i<N; i++) { bls12_381_Fr_mont_sqr_inplace( us + i*NLIMBS ); }
+  }
+  else {
+    memcpy( pad, src2, 8*NLIMBS*n2 );
+    memset( pad + n2*NLIMBS, 0, 8*NLIMBS*(N-n2) );
+    bls12_381_poly_mont_ntt_forward_noalloc( m, 1, gen, pad, scr, vs );
+    for(int i=0; i<N; i++) { bls12_381_Fr_mont_mul_inplace( us + i*NLIMBS , vs + i*NLIMBS ); }
+  }
+
+  bls12_381_poly_mont_ntt_inverse_fwd_noalloc( m, ginv, us, scr, pad );
+  memcpy( tgt, pad, 8*NLIMBS*N3 );
+
+  free(buf);
+}
+
+// Multiply two polynomials.
+// Uses the naive algorithm for small inputs and NTT for larger ones.
+// Requires a target buffer of size `(n1+n2-1)` (!)
+void bls12_381_poly_mont_mul( int  n1, const uint64_t *src1
+         , int  n2, const uint64_t *src2
+         ,                uint64_t *tgt ) {
+
+  if (MIN(n1,n2) <= MUL_NTT_THRESHOLD) {
+    bls12_381_poly_mont_mul_naive( n1, src1, n2, src2, tgt );
+  }
+  else {
+    bls12_381_poly_mont_mul_ntt  ( n1, src1, n2, src2, tgt );
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// relative cost of the NTT-based division, per `n*log2(n)` (measured)
+#define LONG_DIV_FAST_FACTOR 24
+
+// Inverse of a power series modulo `x^k`, via Newton iteration:
+//   g_{2l} = g_l * (2 - f*g_l)  mod x^{2l}
+// The constant term of the input must be nonzero.
+// Requires a target buffer of size `k`
+void bls12_381_poly_mont_inv_series( int n1, const uint64_t *src1, int k, uint64_t *tgt ) {
+  assert( n1 >= 1 );
+  assert( !bls12_381_Fr_mont_is_zero( SRC1(0) ) );
+  if (k <= 0) return;
+
+  bls12_381_Fr_mont_inv( SRC1(0), TGT(0) );
+
+  int Nmax = 4 * (1 << bls12_381_poly_mont_ceil_log2(k));
+  uint64_t *buf = malloc( 8*NLIMBS * (5*Nmax) );
+  assert( buf != 0 );
+  uint64_t *pad = buf;
+  uint64_t *us  = buf +   Nmax*NLIMBS;
+  uint64_t *vs  = buf + 2*Nmax*NLIMBS;
+  uint64_t *scr = buf + 3*Nmax*NLIMBS;
+
+  int l = 1;
+  while (l < k) {
+    // here `tgt` contains g_l, and f*g_l = 1 mod x^l
+    int l2 = 2*l;
+    int N  = 4*l;
+    int m  = bls12_381_poly_mont_ceil_log2( N );
+    uint64_t gen[NLIMBS];
+    uint64_t ginv[NLIMBS];
+    bls12_381_poly_mont_fft_subgroup_gen( m, gen );
+    bls12_381_Fr_mont_inv( gen, ginv );
+
+    int nf = MIN( n1 , l2 );
+    memcpy( pad, src1, 8*NLIMBS*nf );
+    memset( pad + nf*NLIMBS, 0, 8*NLIMBS*(N-nf) );
+    bls12_381_poly_mont_ntt_forward_noalloc( m, 1, gen, pad, scr, us );      // f mod x^(2l)
+
+    memcpy( pad, tgt, 8*NLIMBS*l );
+    memset( pad + l*NLIMBS, 0, 8*NLIMBS*(N-l) );
+    bls12_381_poly_mont_ntt_forward_noalloc( m, 1, gen, pad, scr, vs );      // g_l
+
+    for(int i=0; i<N; i++) {
+      bls12_381_Fr_mont_mul_inplace( us + i*NLIMBS , vs + i*NLIMBS );
+      bls12_381_Fr_mont_mul_inplace( us + i*NLIMBS , vs + i*NLIMBS );      // f * g_l^2
+    }
+    bls12_381_poly_mont_ntt_inverse_fwd_noalloc( m, ginv, us, scr, pad );
+
+    // since f*g_l^2 = g_l mod x^l, the lower half of 2*g_l - f*g_l^2 is simply g_l
+    int kk = MIN( l2 , k );
+    for(int i=l; i<kk; i++) {
+      bls12_381_Fr_mont_neg( pad + i*NLIMBS , TGT(i) );
+    }
+    l = l2;
+  }
+
+  free(buf);
+}
+
+// polynomial long division via reversed multiplication:
+//   rev(quot) = rev(p) * rev(q)^-1  mod x^(deg(p)-deg(q)+1)
+// where the inverse power series is computed by Newton iteration.
+// allocate at least `deg(p) - deg(q) + 1` field elements for the quotient
+// and at least `deg(q)` for the remainder
+void bls12_381_poly_mont_long_div_fast( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {
+  int deg_p = bls12_381_poly_mont_degree( n1, src1 );
+  int deg_q = bls12_381_poly_mont_degree( n2, src2 );
+  assert( (!quot) || (nquot >= deg_p - deg_q + 1) );
+  assert( (!rem ) || (nrem  >= deg_q)             );
+
+  if ( (deg_q < 0) || (deg_p < deg_q) ) {
+    // trivial cases (division by zero, or zero quotient)
+    bls12_381_poly_mont_long_div_naive( n1, src1, n2, src2, nquot, quot, nrem, rem );
+    return;
+  }
+
+  int nq  = deg_p - deg_q + 1;     // size of the quotient
+  int nrq = MIN( nq , deg_q+1 );   // we only need rev(q) mod x^nq
+
+  uint64_t *revp = malloc( 8*NLIMBS * nq     );
+  uint64_t *revq = malloc( 8*NLIMBS * nrq    );
+  uint64_t *qinv = malloc( 8*NLIMBS * nq     );
+  uint64_t *prod = malloc( 8*NLIMBS * (2*nq) );
+  assert( revp != 0 );
+  assert( revq != 0 );
+  assert( qinv != 0 );
+  assert( prod != 0 );
+
+  for(int i=0; i<nq ; i++) { bls12_381_Fr_mont_copy( SRC1(deg_p-i) , revp + i*NLIMBS ); }
+  for(int i=0; i<nrq; i++) { bls12_381_Fr_mont_copy( SRC2(deg_q-i) , revq + i*NLIMBS ); }
+
+  bls12_381_poly_mont_inv_series( nrq, revq, nq, qinv );
+  bls12_381_poly_mont_mul( nq, revp, nq, qinv, prod );   // we only need the lowest `nq` coefficients
+
+  // the quotient is the reverse of the product mod x^nq; reuse `revp`
+  uint64_t *qt = revp;
+  for(int i=0; i<nq; i++) { bls12_381_Fr_mont_copy( prod + (nq-1-i)*NLIMBS , qt + i*NLIMBS ); }
+
+  if (quot) {
+    memcpy( quot, qt, 8*NLIMBS*nq );
+    for(int j=nq; j<nquot; j++) { bls12_381_Fr_mont_set_zero( QUOT(j) ); }
+  }
+
+  if (rem) {
+    // rem = p - q*quot mod x^deg(q)
+    if (deg_q > 0) {
+      int na = deg_q;
+      int nb = MIN( nq , deg_q );
+      uint64_t *qq = malloc( 8*NLIMBS * (na+nb-1) );
+      assert( qq != 0 );
+      bls12_381_poly_mont_mul( na, src2, nb, qt, qq );
+      for(int i=0; i<deg_q; i++) {
+        bls12_381_Fr_mont_sub( SRC1(i) , qq + i*NLIMBS , REM(i) );
+      }
+      free(qq);
+    }
+    for(int j=deg_q; j<nrem; j++) { bls12_381_Fr_mont_set_zero( REM(j) ); }
+  }
+
+  free(prod);
+  free(qinv);
+  free(revq);
+  free(revp);
+}
+
+// polynomial long division
+// dispatches to the schoolbook or the fast algorithm based on the sizes:
+// schoolbook needs `(deg(p)-deg(q)+1)*(deg(q)+1)` multiplications, while
+// the fast one is a few NTTs of size `O(deg(p))`
+// allocate at least `deg(p) - deg(q) + 1` field elements for the quotient
+// and at least `deg(q)` for the remainder
+void bls12_381_poly_mont_long_div( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot, int nrem, uint64_t *rem ) {
+  int deg_p = bls12_381_poly_mont_degree( n1, src1 );
+  int deg_q = bls12_381_poly_mont_degree( n2, src2 );
+  int64_t cost_naive = (int64_t)(deg_p - deg_q + 1) * (int64_t)(deg_q + 1);
+  int64_t cost_fast  = (int64_t)LONG_DIV_FAST_FACTOR * (int64_t)(deg_p + 1) * bls12_381_poly_mont_ceil_log2( deg_p + 1 );
+  if ( (deg_q >= 0) && (deg_p >= deg_q) && (cost_naive > cost_fast) ) {
+    bls12_381_poly_mont_long_div_fast ( n1, src1, n2, src2, nquot, quot, nrem, rem );
+  }
+  else {
+    bls12_381_poly_mont_long_div_naive( n1, src1, n2, src2, nquot, quot, nrem, rem );
+  }
+}
+
+// polynomial quotient
+// allocate at least `deg(p) - deg(q) + 1` field elements for quotient
+void bls12_381_poly_mont_quot( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nquot, uint64_t *quot ) {
+  bls12_381_poly_mont_long_div( n1, src1, n2, src2, nquot, quot, 0, 0 );
+}
+
+// polynomial remainder
+// allocate at least `deg(q)` field elements for the remainder
+void bls12_381_poly_mont_rem( int n1, const uint64_t *src1, int n2, const uint64_t *src2, int nrem, uint64_t *rem ) {
+  bls12_381_poly_mont_long_div( n1, src1, n2, src2, 0, 0, nrem, rem );
+}
+
+// -----------------------------------------------------------------------------
+// subproduct trees, multipoint evaluation and interpolation
+//
+// The subproduct tree of the points `a_0 .. a_{n-1}` has `ceil(log2(n))+1` levels.
+// The node `k` on level `j` is the (monic) product of the linear factors `(x - a_i)`
+// for `k*2^j <= i < min( (k+1)*2^j , n )`, and is stored in a slot of `2^j+1`
+// field elements; the levels are stored consecutively, starting with the leaves.
+
+// the number of points below the node `k` on level `j`
+int bls12_381_poly_mont_subproduct_node_count( int npts, int j, int k ) {
+  int w = (1<<j);
+  return MIN( w , npts - k*w );
+}
+
+// offset (in field elements) of the node `k` on level `j`
+int bls12_381_poly_mont_subproduct_node_offset( int npts, int j, int k ) {
+  int ofs = 0;
+  for(int i=0; i<j; i++) {
+    int w = (1<<i);
+    ofs += ((npts + w - 1) >> i) * (w + 1);
+  }
+  return ofs + k*((1<<j) + 1);
+}
+
+// below nodes of this size, multipoint evaluation falls back to direct evaluation
+#define MULTI_EVAL_LEAF_LOG 4
+
+// size of the subproduct tree buffer, in field elements
+int bls12_381_poly_mont_subproduct_tree_size( int npts ) {
+  if (npts <= 0) return 0;
+  int L = bls12_381_poly_mont_ceil_log2( npts );
+  return bls12_381_poly_mont_subproduct_node_offset( npts, L+1, 0 );
+}
+
+// Builds the subproduct tree of a set of points.
+// Requires a target buffer of size `subproduct_tree_size(npts)`
+void bls12_381_poly_mont_subproduct_tree( int npts, const uint64_t *pts, uint64_t *tree ) {
+  if (npts <= 0) return;
+  int L = bls12_381_poly_mont_ceil_log2( npts );
+
+  // leaves: x - a_i
+  for(int i=0; i<npts; i++) {
+    uint64_t *leaf = tree + 2*i*NLIMBS;
+    bls12_381_Fr_mont_neg    ( pts + i*NLIMBS , leaf );
+    bls12_381_Fr_mont_set_one( leaf + NLIMBS );
+  }
+
+  for(int j=1; j<=L; j++) {
+    int cnt = ( (npts + (1<<j) - 1) >> j );
+    for(int k=0; k<cnt; k++) {
+      int c  = bls12_381_poly_mont_subproduct_node_count( npts, j  , k     );
+      int cl = bls12_381_poly_mont_subproduct_node_count( npts, j-1, 2*k   );
+      uint64_t       *node  = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j  , k     );
+      const uint64_t *left  = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j-1, 2*k   );
+      const uint64_t *right = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j-1, 2*k+1 );
+      if (c == cl) {
+        // no right child
+        memcpy( node, left, 8*NLIMBS*(c+1) );
+      }
+      else {
+        int cr = c - cl;
+        bls12_381_poly_mont_mul( cl+1, left, cr+1, right, node );
+      }
+    }
+  }
+}
+
+// Evaluates a polynomial at the points of a precomputed subproduct tree,
+// by reducing it modulo the nodes, going down the tree.
+// Requires a target buffer of size `npts`
+void bls12_381_poly_mont_multi_eval_with_tree( int npts, const uint64_t *tree, int n1, const uint64_t *src1, uint64_t *tgt ) {
+  if (npts <= 0) return;
+  int L = bls12_381_poly_mont_ceil_log2( npts );
+
+  // remainders for all the nodes of a level; the node `k` on level `j` is at `k*2^j`
+  uint64_t *cur = malloc( 8*NLIMBS * npts );
+  uint64_t *nxt = malloc( 8*NLIMBS * npts );
+  assert( cur != 0 );
+  assert( nxt != 0 );
+
+  const uint64_t *root = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, L, 0 );
+  bls12_381_poly_mont_rem( n1, src1, npts+1, root, npts, cur );
+
+  int j0 = MIN( L , MULTI_EVAL_LEAF_LOG );
+  for(int j=L; j>j0; j--) {
+    int w   = (1<<j);
+    int h   = (w>>1);
+    int cnt = ( (npts + w - 1) >> j );
+    for(int k=0; k<cnt; k++) {
+      int c  = bls12_381_poly_mont_subproduct_node_count( npts, j, k );
+      const uint64_t *r = cur + k*w*NLIMBS;
+      for(int t=0; t<2; t++) {
+        int kk = 2*k + t;
+        if (kk*h >= npts) break;
+        int cc = bls12_381_poly_mont_subproduct_node_count( npts, j-1, kk );
+        if (cc == c) {
+          // single child, the remainder is already reduced
+          memcpy( nxt + kk*h*NLIMBS, r, 8*NLIMBS*c );
+        }
+        else {
+          const uint64_t *child = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j-1, kk );
+          bls12_381_poly_mont_rem( c, r, cc+1, child, cc, nxt + kk*h*NLIMBS );
+        }
+      }
+    }
+    uint64_t *tmp = cur; cur = nxt; nxt = tmp;
+  }
+
+  // small nodes: evaluate the remainders directly (the leaves are `x - a_i`)
+  int w0 = (1<<j0);
+  for(int i=0; i<npts; i++) {
+    uint64_t a[NLIMBS];
+    int k = (i >> j0);
+    int c = bls12_381_poly_mont_subproduct_node_count( npts, j0, k );
+    bls12_381_Fr_mont_neg( tree + 2*i*NLIMBS , a );
+    bls12_381_poly_mont_eval_at( c, cur + k*w0*NLIMBS, a, TGT(i) );
+  }
+
+  free(nxt);
+  free(cur);
+}
+
+// Evaluates a polynomial at `npts` arbitrary points.
+// Requires a target buffer of size `npts`
+void bls12_381_poly_mont_multi_eval( int n1, const uint64_t *src1, int npts, const uint64_t *pts, uint64_t *tgt ) {
+  if (npts <= 0) return;
+  uint64_t *tree = malloc( 8*NLIMBS * bls12_381_poly_mont_subproduct_tree_size(npts) );
+  assert( tree != 0 );
+  bls12_381_poly_mont_subproduct_tree( npts, pts, tree );
+  bls12_381_poly_mont_multi_eval_with_tree( npts, tree, n1, src1, tgt );
+  free(tree);
+}
+
+// Lagrange interpolation using a precomputed subproduct tree: computes the unique
+// polynomial of degree less than `npts` taking the values `ys` at the points.
+// The points must be distinct.
+// Requires a target buffer of size `npts`
+void bls12_381_poly_mont_interpolate_with_tree( int npts, const uint64_t *tree, const uint64_t *ys, uint64_t *tgt ) {
+  if (npts <= 0) return;
+  int L = bls12_381_poly_mont_ceil_log2( npts );
+
+  uint64_t *cur = malloc( 8*NLIMBS * npts );
+  uint64_t *nxt = malloc( 8*NLIMBS * npts );
+  uint64_t *tmp = malloc( 8*NLIMBS * npts );
+  assert( cur != 0 );
+  assert( nxt != 0 );
+  assert( tmp != 0 );
+
+  // the barycentric weights are `1 / m'(a_i)`, where `m` is the root of the tree
+  const uint64_t *root = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, L, 0 );
+  uint64_t one[NLIMBS];
+  uint64_t idx[NLIMBS];
+  bls12_381_Fr_mont_set_one ( one );
+  bls12_381_Fr_mont_set_zero( idx );
+  for(int i=0; i<npts; i++) {
+    bls12_381_Fr_mont_add_inplace( idx, one );
+    bls12_381_Fr_mont_mul( root + (i+1)*NLIMBS , idx , tmp + i*NLIMBS );
+  }
+  bls12_381_poly_mont_multi_eval_with_tree( npts, tree, npts, tmp, nxt );
+  bls12_381_Fr_mont_batch_inv( npts, nxt, tmp );
+  for(int i=0; i<npts; i++) {
+    bls12_381_Fr_mont_mul( ys + i*NLIMBS , tmp + i*NLIMBS , cur + i*NLIMBS );
+  }
+
+  // combine going up the tree: P = P_left * M_right + P_right * M_left
+  for(int j=1; j<=L; j++) {
+    int w   = (1<<j);
+    int h   = (w>>1);
+    int cnt = ( (npts + w - 1) >> j );
+    for(int k=0; k<cnt; k++) {
+      int c  = bls12_381_poly_mont_subproduct_node_count( npts, j  , k   );
+      int cl = bls12_381_poly_mont_subproduct_node_count( npts, j-1, 2*k );
+      uint64_t *pl = cur + (2*k  )*h*NLIMBS;
+      uint64_t *pr = cur + (2*k+1)*h*NLIMBS;
+      uint64_t *p  = nxt +     k  *w*NLIMBS;
+      if (c == cl) {
+        memcpy( p, pl, 8*NLIMBS*c );
+      }
+      else {
+        int cr = c - cl;
+        const uint64_t *left  = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j-1, 2*k   );
+        const uint64_t *right = tree + NLIMBS * bls12_381_poly_mont_subproduct_node_offset( npts, j-1, 2*k+1 );
+        bls12_381_poly_mont_mul( cl, pl, cr+1, right, p   );
+        bls12_381_poly_mont_mul( cr, pr, cl+1, left , tmp );
+        for(int i=0; i<c; i++) { bls12_381_Fr_mont_add_inplace( p + i*NLIMBS , tmp + i*NLIMBS ); }
+      }
+    }
+    uint64_t *sw = cur; cur = nxt; nxt = sw;
+  }
+
+  memcpy( tgt, cur, 8*NLIMBS*npts );
+  free(tmp);
+  free(nxt);
+  free(cur);
+}
+
+// Lagrange interpolation at `npts` arbitrary (distinct) points.
+// Requires a target buffer of size `npts`
+void bls12_381_poly_mont_interpolate( int npts, const uint64_t *pts, const uint64_t *ys, uint64_t *tgt ) {
+  if (npts <= 0) return;
+  uint64_t *tree = malloc( 8*NLIMBS * bls12_381_poly_mont_subproduct_tree_size(npts) );
+  assert( tree != 0 );
+  bls12_381_poly_mont_subproduct_tree( npts, pts, tree );
+  bls12_381_poly_mont_interpolate_with_tree( npts, tree, ys, tgt );
+  free(tree);
+}
+
+// -----------------------------------------------------------------------------
+// polynomials in evaluation form (values on an FFT-friendly subgroup)
+
+// the table of the elements `[1,g,g^2,...,g^(N-1)]` of the subgroup of size `N=2^m`
+// Requires a target buffer of size `2^m`
+void bls12_381_poly_mont_fft_domain( int m, uint64_t *tgt ) {
+  int N = (1<<m);
+  uint64_t gen[NLIMBS];
+  bls12_381_poly_mont_fft_subgroup_gen( m, gen );
+  bls12_381_Fr_mont_set_one( TGT(0) );
+  for(int i=1; i<N; i++) {
+    bls12_381_Fr_mont_mul( TGT(i-1) , gen , TGT(i) );
+  }
+}
+
+// Barycentric evaluation of a polynomial given by its values `ys` on the subgroup
+// of size `N=2^m`, at an arbitrary location `z`:
+//
+//   p(z) = (z^N - 1)/N * sum_i ys[i] * g^i / (z - g^i)
+//
+// `domain` is the table of the subgroup elements (see `fft_domain`).
+// This needs a single batch inversion.
+void bls12_381_poly_mont_eval_lagrange_at( int m, const uint64_t *domain, const uint64_t *ys, const uint64_t *loc, uint64_t *tgt ) {
+  int N = (1<<m);
+  assert( N >= 1 );
+
+  for(int i=0; i<N; i++) {
+    if (bls12_381_Fr_mont_is_equal( loc , domain + i*NLIMBS )) {
+      // `z` is in the domain
+      bls12_381_Fr_mont_copy( ys + i*NLIMBS , tgt );
+      return;
+    }
+  }
+
+  uint64_t *buf = malloc( 8*NLIMBS * (2*N) );
+  assert( buf != 0 );
+  uint64_t *diff = buf;
+  uint64_t *dinv = buf + N*NLIMBS;
+
+  for(int i=0; i<N; i++) {
+    bls12_381_Fr_mont_sub( loc , domain + i*NLIMBS , diff + i*NLIMBS );
+  }
+  bls12_381_Fr_mont_batch_inv( N, diff, dinv );
+
+  uint64_t acc[NLIMBS];
+  uint64_t tmp[NLIMBS];
+  bls12_381_Fr_mont_set_zero( acc );
+  for(int i=0; i<N; i++) {
+    bls12_381_Fr_mont_mul( ys + i*NLIMBS , domain + i*NLIMBS , tmp );
+    bls12_381_Fr_mont_mul_inplace( tmp , dinv + i*NLIMBS );
+    bls12_381_Fr_mont_add_inplace( acc , tmp );
+  }
+
+  // (z^N - 1) / N
+  uint64_t zn[NLIMBS];
+  uint64_t one[NLIMBS];
+  bls12_381_Fr_mont_copy( loc , zn );
+  for(int i=0; i<m; i++) {
+    bls12_381_Fr_mont_sqr_inplace( zn );
+    bls12_381_Fr_mont_mul_inplace( acc , bls12_381_poly_mont_oneHalf );
+  }
+  bls12_381_Fr_mont_set_one( one );
+  bls12_381_Fr_mont_sub_inplace( zn , one );
+  bls12_381_Fr_mont_mul( acc , zn , tgt );
+
+  free(buf);
+}
@@ -0,0 +1,113 @@
+
+// === simple multithreading support ===
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "parallel.h"
+
+#if defined(_WIN32) && !defined(NO_THREADS)
+#define NO_THREADS
+#endif
+
+#ifndef NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define MAX_THREADS 256
+
+// 0 means "not yet initialized". This can be accessed from several (Haskell)
+// threads at the same time, so all accesses are atomic
+int parallel_num_threads = 0;
+
+int parallel_get_num_threads() {
+#ifdef NO_THREADS
+  return 1;
+#else
+  int n = __atomic_load_n( &parallel_num_threads, __ATOMIC_RELAXED );
+  if (n <= 0) {
+    long m = sysconf( _SC_NPROCESSORS_ONLN );
+    n = (m < 1) ? 1 : ( (m > MAX_THREADS) ? MAX_THREADS : (int)m );
+    // only replaces the uninitialized value, so a concurrent `parallel_set_num_threads` wins
+    int expected = 0;
+    __atomic_compare_exchange_n( &parallel_num_threads, &expected, n, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+  }
+  return n;
+#endif
+}
+
+// setting it to 0 resets to the default (the number of CPU cores)
+void parallel_set_num_threads( int n ) {
+  int m = (n > MAX_THREADS) ? MAX_THREADS : ( (n < 0) ? 0 : n );
+  __atomic_store_n( &parallel_num_threads, m, __ATOMIC_RELAXED );
+}
+
+#ifndef NO_THREADS
+
+typedef struct {
+  int   ntasks;
+  int   nthreads;
+  int   thread_idx;
+  void *ctx;
+  void (*task)(void *ctx, int i);
+} parallel_worker_t;
+
+// the worker `t` runs the tasks `t, t+T, t+2T, ...`
+void *parallel_worker( void *arg ) {
+  parallel_worker_t *w = (parallel_worker_t*) arg;
+  for(int i=w->thread_idx; i<w->ntasks; i+=w->nthreads) {
+    (w->task)( w->ctx, i );
+  }
+  return 0;
+}
+
+#endif
+
+void parallel_for( int ntasks, void (*task)(void *ctx, int i), void *ctx ) {
+  int T = parallel_get_num_threads();
+  if (T > ntasks) { T = ntasks; }
+  if (T <= 1) {
+    for(int i=0; i<ntasks; i++) { task( ctx, i ); }
+    return;
+  }
+#ifndef NO_THREADS
+  pthread_t         threads[MAX_THREADS];
+  parallel_worker_t workers[MAX_THREADS];
+  for(int t=0; t<T; t++) {
+    workers[t].ntasks     = ntasks;
+    workers[t].nthreads   = T;
+    workers[t].thread_idx = t;
+    workers[t].ctx        = ctx;
+    workers[t].task       = task;
+  }
+  // the calling thread is worker 0
+  int spawned = 1;
+  for(int t=1; t<T; t++) {
+    if (pthread_create( &threads[t], 0, parallel_worker, &workers[t] ) != 0) break;
+    spawned++;
+  }
+  // if we could not create enough threads, the remaining tasks run here
+  for(int t=spawned; t<T; t++) { parallel_worker( &workers[t] ); }
+  parallel_worker( &workers[0] );
+  for(int t=1; t<spawned; t++) { pthread_join( threads[t], 0 ); }
+#endif
+}
+
+#ifndef NO_THREADS
+pthread_mutex_t parallel_once_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+void parallel_call_once( int *done, void (*init)() ) {
+  if (__atomic_load_n( done, __ATOMIC_ACQUIRE )) return;
+#ifndef NO_THREADS
+  pthread_mutex_lock( &parallel_once_mutex );
+#endif
+  if (!*done) {
+    init();
+    __atomic_store_n( done, 1, __ATOMIC_RELEASE );
+  }
+#ifndef NO_THREADS
+  pthread_mutex_unlock( &parallel_once_mutex );
+#endif
+}
@@ -0,0 +1,17 @@
+
+// === simple multithreading support ===
+//
+// If `NO_THREADS` is defined (or on Windows), everything runs on the calling thread.
+
+extern int  parallel_get_num_threads();
+extern void parallel_set_num_threads( int n );
+
+// runs `task(ctx,i)` for all `0 <= i < ntasks`, distributed among the threads.
+// There is no persistent thread pool: each call creates (at most) `T-1` new threads,
+// where `T = parallel_get_num_threads()`, and joins them before returning, so this
+// is only worth it for coarse-grained work.
+extern void parallel_for( int ntasks, void (*task)(void *ctx, int i), void *ctx );
+
+// runs `init()` if `*done` is not yet set, then sets it; the calls are serialized,
+// so this can be used to lazily initialize (static) tables from several threads
+extern void parallel_call_once( int *done, void (*init)() );
@@ -0,0 +1,22 @@
+
+// === SHA-256 and expand_message_xmd (RFC 9380) ===
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t state[8];
+  uint64_t nbytes;           // total number of bytes processed
+  uint8_t  block[64];        // the partial block
+  int      block_len;
+} sha256_ctx_t;
+
+extern void sha256_init  ( sha256_ctx_t *ctx );
+extern void sha256_update( sha256_ctx_t *ctx, const uint8_t *msg, int len );
+extern void sha256_final ( sha256_ctx_t *ctx, uint8_t *digest );
+
+extern void sha256( const uint8_t *msg, int len, uint8_t *digest );
+
+extern uint8_t expand_message_xmd_sha256
+  ( const uint8_t *dst, int dst_len
+  , const uint8_t *msg, int msg_len
+  , int len_in_bytes, uint8_t *tgt );
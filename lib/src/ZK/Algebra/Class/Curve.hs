@@ -90,9 +90,9 @@ class (Group a, Field (BaseField a), Field (ScalarField a)) => Curve a where
   scalarMul   :: ScalarField a -> a -> a
   -- | multi-scalar multiplication  
   msm :: FlatArray (ScalarField a) -> FlatArray a -> a
-  -- | curve forward FFT
+  -- | curve forward FFT (the points must be in the prime-order subgroup)
   curveFFT :: FFTSubgroup (ScalarField a) -> FlatArray a -> FlatArray a
-  -- | curve inverse FFT
+  -- | curve inverse FFT (the points must be in the prime-order subgroup)
   curveIFFT :: FFTSubgroup (ScalarField a) -> FlatArray a -> FlatArray a
 
 -- | Convenient alias for 'scalarMul'
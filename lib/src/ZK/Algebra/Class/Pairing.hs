@@ -77,4 +77,7 @@ class
 
     pairing :: Proxy c -> G1 c -> G2 c -> Fp12 c
 
+    -- | Product of pairings (shared Miller loop, single final exponentiation)
+    pairingMulti :: Proxy c -> [(G1 c, G2 c)] -> Fp12 c
+
 --------------------------------------------------------------------------------
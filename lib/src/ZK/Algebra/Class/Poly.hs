@@ -15,6 +15,7 @@ import Data.Kind
 import ZK.Algebra.Class.Field
 import ZK.Algebra.Class.Flat
 import ZK.Algebra.Class.FFT
+import ZK.Algebra.Class.Misc ( Log2 )
 
 --------------------------------------------------------------------------------
 -- * Univariate polynomials over (finite) fields
@@ -28,6 +29,8 @@ class (Ring p, Field (Coeff p), WrappedArray p, Element p ~ Coeff p) => Univaria
   kthCoeff :: Int -> p -> Coeff p
   -- | Evaluation
   evalAt :: Coeff p -> p -> Coeff p
+  -- | Evaluation of many polynomials at the same point
+  evalManyAt :: Coeff p -> [p] -> [Coeff p]
   -- | Scaling
   scale :: Coeff p -> p -> p
   -- | Create a polynomial from coefficiens
@@ -50,6 +53,10 @@ class (Ring p, Field (Coeff p), WrappedArray p, Element p ~ Coeff p) => Univaria
   divByVanishing :: p -> (Int, Coeff p) -> (p,p)
   -- | Quotient by the coset vanishing polynomial @(x^n - eta)@
   quotByVanishing :: p -> (Int, Coeff p) -> Maybe p
+  -- | Evaluation at many points
+  polyMultiEval :: FlatArray (Coeff p) -> p -> FlatArray (Coeff p)
+  -- | Lagrange interpolation at arbitrary (distinct) points
+  polyInterpolate :: FlatArray (Coeff p) -> FlatArray (Coeff p) -> p
 
 -- | Polynomials which over an FFT-friend field support NTT operations
 class (Univariate p, FFTField (Coeff p)) => UnivariateFFT p where
@@ -58,6 +65,22 @@ class (Univariate p, FFTField (Coeff p)) => UnivariateFFT p where
   -- | Inverse number-theoretical transform (interpolate on a subgroup)
   intt :: FFTSubgroup (Coeff p) -> FlatArray (Coeff p) -> p
 
+-- | Polynomials in evaluation form, that is, given by their values on an
+-- FFT-friendly subgroup (the size of which is part of the value)
+class (UnivariateFFT (CoeffForm l), WrappedArray l, Element l ~ Coeff (CoeffForm l)) => EvaluationForm l where
+  -- | The corresponding polynomial type in coefficient form
+  type CoeffForm l :: Type
+  -- | @log2@ of the size of the evaluation domain
+  evalDomainLogSize :: l -> Log2
+  -- | Evaluation at an arbitrary point (barycentric formula)
+  evalFormAt :: Coeff (CoeffForm l) -> l -> Coeff (CoeffForm l)
+  -- | Evaluates on the subgroup of the given size (the degree must be smaller than the size)
+  fromCoeffForm :: Log2 -> CoeffForm l -> l
+  -- | Interpolates the coefficient form
+  toCoeffForm :: l -> CoeffForm l
+  -- | Pointwise multiplication (this is the product modulo @x^N - 1@)
+  evalFormMul :: l -> l -> l
+
 --------------------------------------------------------------------------------
 -- * Some generic functions
 
@@ -25,6 +25,8 @@ module ZK.Algebra.Curves.BLS12_381.Fp.Mont
   , inv , div , divBy2 , batchInv
     -- * Exponentiation
   , pow , pow_
+    -- * Square roots
+  , isSquare , squareRoot
     -- * Random
   , rnd
     -- * Export to C
@@ -138,6 +140,12 @@ instance C.MontgomeryField Fp where
   batchToStandardRep   = batchToStd
   batchFromStandardRep = batchFromStd
 
+-- | The square root of a field element, if it exists
+squareRoot :: Fp -> Maybe Fp
+squareRoot x = case sqrt_ x of
+  (y,True) -> Just y
+  _        -> Nothing
+
 
 ----------------------------------------
 
@@ -414,3 +422,23 @@ pow_ (MkFp fptr1) x = unsafePerformIO $ do
     withForeignPtr fptr2 $ \ptr2 -> do
       c_bls12_381_Fp_mont_pow_uint64 ptr1 x ptr2
   return (MkFp fptr2)
+
+foreign import ccall unsafe "bls12_381_Fp_mont_is_square" c_bls12_381_Fp_mont_is_square :: Ptr Word64 -> IO Word8
+
+{-# NOINLINE isSquare #-}
+isSquare :: Fp -> Bool
+isSquare (MkFp fptr) = unsafePerformIO $ do
+  cret <- withForeignPtr fptr $ \ptr -> do
+    c_bls12_381_Fp_mont_is_square ptr
+  return (cret /= 0)
+
+foreign import ccall unsafe "bls12_381_Fp_mont_sqrt" c_bls12_381_Fp_mont_sqrt :: Ptr Word64 -> Ptr Word64 -> IO Word8
+
+{-# NOINLINE sqrt_ #-}
+sqrt_ :: Fp -> (Fp, Bool)
+sqrt_ (MkFp fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 6
+  cret <- withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_Fp_mont_sqrt ptr1 ptr2
+  return (MkFp fptr2, cret /=0)
@@ -404,7 +404,7 @@ powBigInt384 (MkFp12 fptr1) (MkBigInt384 fptr2) = unsafePerformIO $ do
   withForeignPtr fptr1 $ \ptr1 -> do
     withForeignPtr fptr2 $ \ptr2 -> do
       withForeignPtr fptr3 $ \ptr3 -> do
-        c_bls12_381_Fp12_mont_pow_gen ptr1 ptr2 ptr3 72
+        c_bls12_381_Fp12_mont_pow_gen ptr1 ptr2 ptr3 6
   return (MkFp12 fptr3)
 
 ----------------------------------------
@@ -25,6 +25,8 @@ module ZK.Algebra.Curves.BLS12_381.Fp2.Mont
     -- * Relation to the base and prime fields
   , embedBase , embedPrime
   , scaleBase , scalePrime
+    -- * Square roots
+  , isSquare , squareRoot
     -- * Frobenius automorphism
   , frob
     -- * Random
@@ -111,6 +113,12 @@ rnd = do
 instance M.Rnd Fp2 where
   rndIO = rnd
 
+-- | The square root of a field element, if it exists
+squareRoot :: Fp2 -> Maybe Fp2
+squareRoot x = case sqrt_ x of
+  (y,True) -> Just y
+  _        -> Nothing
+
 instance C.Ring Fp2 where
   ringNamePxy _ = "BLS12_381/Fp2"
   ringSizePxy _ = C.ringSizePxy (Proxy @Fp) ^ 2
@@ -364,7 +372,7 @@ powBigInt384 (MkFp2 fptr1) (MkBigInt384 fptr2) = unsafePerformIO $ do
   withForeignPtr fptr1 $ \ptr1 -> do
     withForeignPtr fptr2 $ \ptr2 -> do
       withForeignPtr fptr3 $ \ptr3 -> do
-        c_bls12_381_Fp2_mont_pow_gen ptr1 ptr2 ptr3 12
+        c_bls12_381_Fp2_mont_pow_gen ptr1 ptr2 ptr3 6
   return (MkFp2 fptr3)
 
 ----------------------------------------
@@ -533,3 +541,23 @@ frob (MkFp2 fptr1) = unsafePerformIO $ do
     withForeignPtr fptr2 $ \ptr2 -> do
       c_bls12_381_Fp2_mont_frobenius ptr1 ptr2
   return (MkFp2 fptr2)
+
+foreign import ccall unsafe "bls12_381_Fp2_mont_is_square" c_bls12_381_Fp2_mont_is_square :: Ptr Word64 -> IO Word8
+
+{-# NOINLINE isSquare #-}
+isSquare :: Fp2 -> Bool
+isSquare (MkFp2 fptr) = unsafePerformIO $ do
+  cret <- withForeignPtr fptr $ \ptr -> do
+    c_bls12_381_Fp2_mont_is_square ptr
+  return (cret /= 0)
+
+foreign import ccall unsafe "bls12_381_Fp2_mont_sqrt" c_bls12_381_Fp2_mont_sqrt :: Ptr Word64 -> Ptr Word64 -> IO Word8
+
+{-# NOINLINE sqrt_ #-}
+sqrt_ :: Fp2 -> (Fp2, Bool)
+sqrt_ (MkFp2 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 12
+  cret <- withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_Fp2_mont_sqrt ptr1 ptr2
+  return (MkFp2 fptr2, cret /=0)
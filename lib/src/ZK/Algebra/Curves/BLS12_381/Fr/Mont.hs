@@ -25,6 +25,8 @@ module ZK.Algebra.Curves.BLS12_381.Fr.Mont
   , inv , div , divBy2 , batchInv
     -- * Exponentiation
   , pow , pow_
+    -- * Square roots
+  , isSquare , squareRoot
     -- * FFT
   , fftDomain
     -- * Random
@@ -142,6 +144,12 @@ instance C.MontgomeryField Fr where
   batchToStandardRep   = batchToStd
   batchFromStandardRep = batchFromStd
 
+-- | The square root of a field element, if it exists
+squareRoot :: Fr -> Maybe Fr
+squareRoot x = case sqrt_ x of
+  (y,True) -> Just y
+  _        -> Nothing
+
 fftDomain :: FFTSubgroup Fr
 fftDomain = MkFFTSubgroup gen (M.Log2 32) where
   gen :: Fr
@@ -425,3 +433,23 @@ pow_ (MkFr fptr1) x = unsafePerformIO $ do
     withForeignPtr fptr2 $ \ptr2 -> do
       c_bls12_381_Fr_mont_pow_uint64 ptr1 x ptr2
   return (MkFr fptr2)
+
+foreign import ccall unsafe "bls12_381_Fr_mont_is_square" c_bls12_381_Fr_mont_is_square :: Ptr Word64 -> IO Word8
+
+{-# NOINLINE isSquare #-}
+isSquare :: Fr -> Bool
+isSquare (MkFr fptr) = unsafePerformIO $ do
+  cret <- withForeignPtr fptr $ \ptr -> do
+    c_bls12_381_Fr_mont_is_square ptr
+  return (cret /= 0)
+
+foreign import ccall unsafe "bls12_381_Fr_mont_sqrt" c_bls12_381_Fr_mont_sqrt :: Ptr Word64 -> Ptr Word64 -> IO Word8
+
+{-# NOINLINE sqrt_ #-}
+sqrt_ :: Fr -> (Fr, Bool)
+sqrt_ (MkFr fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 4
+  cret <- withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_Fr_mont_sqrt ptr1 ptr2
+  return (MkFr fptr2, cret /=0)
@@ -1,22 +1,22 @@
 
--- | BLS12-381 curve, Jacobian (or weighted) projective coordinates, Montgomery field representation
+-- | BLS12-381 ( Fp )  curve, Jacobian (or weighted) projective coordinates, Montgomery field representation
 --
 -- * NOTE 1: This module is intented to be imported qualified
 --
 -- * NOTE 2: Generated code, do not edit!
 --
 
-{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies #-}
+{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies, PatternSynonyms #-}
 module ZK.Algebra.Curves.BLS12_381.G1.Jac
   ( G1(..)
-  , primeP , primeR , cofactor , curveA , curveB
     -- * Parameters
+  , primeP , primeR , cofactor , curveA , curveB
   , genG1 , infinity
     -- * Curve points
   , coords , mkPoint , mkPointMaybe , unsafeMkPoint
     -- * Conversion to\/from affine
   , fromAffine , toAffine
-  , batchFromAffine , batchToAffine
+  , batchFromAffine , batchToAffine , batchToAffineParallel
   , normalize
     -- * Predicates
   , isEqual , isSame
@@ -52,6 +52,7 @@ import System.IO.Unsafe
 import ZK.Algebra.Curves.BLS12_381.Fp.Mont ( Fp(..) )
 import ZK.Algebra.Curves.BLS12_381.Fr.Mont ( Fr(..) )
 import qualified ZK.Algebra.Curves.BLS12_381.Fp.Mont as Fp
+import qualified ZK.Algebra.Curves.BLS12_381.Fp.Mont as Base
 import qualified ZK.Algebra.Curves.BLS12_381.Fr.Mont as Fr
 import qualified ZK.Algebra.Curves.BLS12_381.Fr.Std
 import qualified ZK.Algebra.BigInt.BigInt384 as BigP
@@ -67,14 +68,16 @@ import           ZK.Algebra.Class.FFT
 
 --------------------------------------------------------------------------------
 
--- | The sizes of the fields Fp, Fr, and the cofactor of the subgroup G1
 primeP, primeR, cofactor :: Integer
 primeP = Fp.prime
 primeR = Fr.prime
 cofactor = 76329603384216526031706109802092473003
 
+type Base = Fp
+pattern MkBase fptr = MkFp fptr
+
 -- | parameters A and B of the curve equation @y^2 = x^3 + A*x + B@
-curveA, curveB :: Fp
+curveA, curveB :: Integer
 curveA = 0
 curveB = 4
 
@@ -90,22 +93,22 @@ genG1 = mkPoint (x, y, Fp.one) where
 newtype G1 = MkG1 (ForeignPtr Word64)
 
 -- | Note: this throws an exception if the point is not on the curve
-mkPoint :: (Fp, Fp, Fp) -> G1
+mkPoint :: (Base, Base, Base) -> G1
 mkPoint xyz = case mkPointMaybe xyz of
   Just pt -> pt
   Nothing -> error "mkPoint: point is not on the curve"
 
-mkPointMaybe :: (Fp, Fp, Fp) -> Maybe G1
+mkPointMaybe :: (Base, Base, Base) -> Maybe G1
 mkPointMaybe xyz = let pt = unsafeMkPoint xyz in
   case isOnCurve pt of { True -> Just pt ; False -> Nothing }
 
 -- | The point at infinity, @{1 : 1 : 0}@
 infinity :: G1
-infinity = unsafeMkPoint (Fp.one, Fp.one, Fp.zero)
+infinity = unsafeMkPoint (Base.one, Base.one, Base.zero)
 
 {-# NOINLINE unsafeMkPoint #-}
-unsafeMkPoint :: (Fp, Fp, Fp) -> G1
-unsafeMkPoint (MkFp fptr1 , MkFp fptr2 , MkFp fptr3) = unsafePerformIO $ do
+unsafeMkPoint :: (Base, Base, Base) -> G1
+unsafeMkPoint (MkBase fptr1 , MkBase fptr2 , MkBase fptr3) = unsafePerformIO $ do
   fptr4 <- mallocForeignPtrArray 18
   withForeignPtr fptr1 $ \ptr1 -> do
     withForeignPtr fptr2 $ \ptr2 -> do
@@ -117,7 +120,7 @@ unsafeMkPoint (MkFp fptr1 , MkFp fptr2 , MkFp fptr3) = unsafePerformIO $ do
   return (MkG1 fptr4)
 
 {-# NOINLINE coords #-}
-coords :: G1 -> (Fp, Fp, Fp)
+coords :: G1 -> (Base, Base, Base)
 coords (MkG1 fptr4) = unsafePerformIO $ do
   fptr1 <- mallocForeignPtrArray 6
   fptr2 <- mallocForeignPtrArray 6
@@ -129,7 +132,7 @@ coords (MkG1 fptr4) = unsafePerformIO $ do
           copyBytes ptr1 (        ptr4   ) 48
           copyBytes ptr2 (plusPtr ptr4 48) 48
           copyBytes ptr3 (plusPtr ptr4 96) 48
-  return (MkFp fptr1, MkFp fptr2, MkFp fptr3)
+  return (MkBase fptr1, MkBase fptr2, MkBase fptr3)
 
 -- | Returns a uniformly random element /in the subgroup G1/.
 -- Note: this is slow, because it uses exponentiation.
@@ -138,7 +141,7 @@ rndG1_naive = do
   k <- Fr.rnd :: IO Fr
   return (sclFr k genG1)
 
--- | Returns a uniformly random element /in the subgroup G1/
+-- | Returns a uniformly random element /in the subgroup G1/.
 rndG1 :: IO G1
 rndG1 = rndG1_naive
 
@@ -165,7 +168,7 @@ instance M.Rnd G1 where
   rndIO = rndG1
 
 instance C.Group G1 where
-  grpName _    = "BLS12-381 / G1"
+  grpName _    = "BLS12-381 / G1 "
   grpIsUnit    = ZK.Algebra.Curves.BLS12_381.G1.Jac.isInfinity
   grpUnit      = ZK.Algebra.Curves.BLS12_381.G1.Jac.infinity
   grpNormalize = normalize
@@ -177,8 +180,8 @@ instance C.Group G1 where
   grpScale     = sclBig
 
 instance C.Curve G1 where
-  curveNamePxy _ = "BLS12-381 ( Fp )"
-  type BaseField   G1 = Fp
+  curveNamePxy _ = "BLS12-381 ( Fp ) "
+  type BaseField   G1 = Base
   type ScalarField G1 = Fr
   isOnCurve   = ZK.Algebra.Curves.BLS12_381.G1.Jac.isOnCurve
   isInfinity  = ZK.Algebra.Curves.BLS12_381.G1.Jac.isInfinity
@@ -189,12 +192,12 @@ instance C.Curve G1 where
   curveFFT    = ZK.Algebra.Curves.BLS12_381.G1.Jac.forwardFFT
   curveIFFT   = ZK.Algebra.Curves.BLS12_381.G1.Jac.inverseFFT
 
-instance C.ProjCurve G1 where
+instance C.JacCurve G1 where
   type AffinePoint G1 = ZK.Algebra.Curves.BLS12_381.G1.Affine.G1
   fromAffine = ZK.Algebra.Curves.BLS12_381.G1.Jac.fromAffine
+  toAffine   = ZK.Algebra.Curves.BLS12_381.G1.Jac.toAffine
   batchFromAffine = ZK.Algebra.Curves.BLS12_381.G1.Jac.batchFromAffine
   batchToAffine   = ZK.Algebra.Curves.BLS12_381.G1.Jac.batchToAffine
-  toAffine   = ZK.Algebra.Curves.BLS12_381.G1.Jac.toAffine
   coords3    = ZK.Algebra.Curves.BLS12_381.G1.Jac.coords
   mkPoint3   = ZK.Algebra.Curves.BLS12_381.G1.Jac.mkPoint
   mixedAdd   = ZK.Algebra.Curves.BLS12_381.G1.Jac.madd
@@ -266,6 +269,7 @@ foreign import ccall unsafe "bls12_381_G1_jac_fft_forward" c_bls12_381_G1_jac_ff
 
 {-# NOINLINE forwardFFT #-}
 -- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 forwardFFT :: FFTSubgroup Fr -> FlatArray G1 -> FlatArray G1
 forwardFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "forwardNTT: subgroup size differs from the array size"
@@ -279,6 +283,7 @@ forwardFFT sg (MkFlatArray n fptr2)
 
 {-# NOINLINE inverseFFT #-}
 -- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 inverseFFT :: FFTSubgroup Fr -> FlatArray G1 -> FlatArray G1
 inverseFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "inverseNTT: subgroup size differs from the array size"
@@ -393,6 +398,17 @@ batchToAffine (MkFlatArray n fptr1) = unsafePerformIO $ do
       c_bls12_381_G1_jac_batch_to_affine (fromIntegral n) ptr1 ptr2
   return (MkFlatArray n fptr2)
 
+foreign import ccall unsafe "bls12_381_G1_jac_batch_to_affine_parallel" c_bls12_381_G1_jac_batch_to_affine_parallel :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE batchToAffineParallel #-}
+batchToAffineParallel :: FlatArray (ZK.Algebra.Curves.BLS12_381.G1.Jac.G1) -> FlatArray (ZK.Algebra.Curves.BLS12_381.G1.Affine.G1)
+batchToAffineParallel (MkFlatArray n fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray (n*12)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_jac_batch_to_affine_parallel (fromIntegral n) ptr1 ptr2
+  return (MkFlatArray n fptr2)
+
 foreign import ccall unsafe "bls12_381_G1_jac_neg" c_bls12_381_G1_jac_neg :: Ptr Word64 -> Ptr Word64 -> IO ()
 
 {-# NOINLINE neg #-}
@@ -14,7 +14,7 @@ module ZK.Algebra.Curves.BLS12_381.G1.Proj
   , coords , mkPoint , mkPointMaybe , unsafeMkPoint
     -- * Conversion to\/from affine
   , fromAffine , toAffine
-  , batchFromAffine , batchToAffine
+  , batchFromAffine , batchToAffine , batchToAffineParallel
   , normalize
     -- * Predicates
   , isEqual , isSame
@@ -22,7 +22,16 @@ module ZK.Algebra.Curves.BLS12_381.G1.Proj
     -- * Addition and doubling
   , neg , add , madd, dbl , sub
     -- * Scaling
-  , sclFr , sclBig , sclSmall
+  , sclFr , sclBig , sclSmall , sclFrCT
+  , sclFrGLV
+    -- * Cofactor clearing
+  , clearCofactor
+    -- * Fixed-base scaling
+  , sclGen , CombTable , combTable , sclComb
+    -- * Structured reference strings (for testing)
+  , srsMonomial , srsLagrange , srsToLagrange
+    -- * Hashing to the curve
+  , hashToCurve , encodeToCurve , hashToCurveMany
     -- * Random
   , rndG1 , rndG1_naive
     -- * Multi-scalar multiplication
@@ -143,7 +152,9 @@ rndG1_naive = do
 
 -- | Returns a uniformly random element /in the subgroup G1/.
 rndG1 :: IO G1
-rndG1 = rndG1_naive
+rndG1 = do
+  k <- Fr.rnd :: IO Fr
+  return (sclGen k)
 
 --------------------------------------------------------------------------------
 
@@ -269,6 +280,7 @@ foreign import ccall unsafe "bls12_381_G1_proj_fft_forward" c_bls12_381_G1_proj_
 
 {-# NOINLINE forwardFFT #-}
 -- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 forwardFFT :: FFTSubgroup Fr -> FlatArray G1 -> FlatArray G1
 forwardFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "forwardNTT: subgroup size differs from the array size"
@@ -282,6 +294,7 @@ forwardFFT sg (MkFlatArray n fptr2)
 
 {-# NOINLINE inverseFFT #-}
 -- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 inverseFFT :: FFTSubgroup Fr -> FlatArray G1 -> FlatArray G1
 inverseFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "inverseNTT: subgroup size differs from the array size"
@@ -294,6 +307,134 @@ inverseFFT sg (MkFlatArray n fptr2)
       return (MkFlatArray n fptr3)
 
 
+foreign import ccall unsafe "bls12_381_G1_proj_comb_precompute" c_bls12_381_G1_proj_comb_precompute :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_comb_scl_Fr_mont" c_bls12_381_G1_proj_comb_scl_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_scl_gen_Fr_mont" c_bls12_381_G1_proj_scl_gen_Fr_mont :: Ptr Word64 -> Ptr Word64 -> IO ()
+
+-- | Precomputed table for fixed-base scalar multiplication (see 'combTable')
+newtype CombTable = MkCombTable (ForeignPtr Word64)
+
+{-# NOINLINE combTable #-}
+-- | Precomputes the table for fast scalar multiplications of a fixed base point.
+-- This costs about as much as 20-30 scalar multiplications (and uses 95 kilobytes),
+-- so it only pays off when the same base is multiplied many times
+combTable :: G1 -> CombTable
+combTable (MkG1 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 12240
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_proj_comb_precompute ptr1 ptr2
+  return (MkCombTable fptr2)
+
+{-# NOINLINE sclComb #-}
+-- | Scalar multiplication of a fixed base point, using its precomputed table
+sclComb :: CombTable -> Fr -> G1
+sclComb (MkCombTable fptr1) (MkFr fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 18
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_comb_scl_Fr_mont ptr1 ptr2 ptr3
+  return (MkG1 fptr3)
+
+{-# NOINLINE sclGen #-}
+-- | Multiplies the subgroup generator by a scalar (using a table which is
+-- precomputed on first use). This is much faster than @sclFr k genG1@
+sclGen :: Fr -> G1
+sclGen (MkFr fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 18
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_proj_scl_gen_Fr_mont ptr1 ptr2
+  return (MkG1 fptr2)
+
+
+foreign import ccall unsafe "bls12_381_G1_proj_srs_generate" c_bls12_381_G1_proj_srs_generate :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_srs_generate_lagrange" c_bls12_381_G1_proj_srs_generate_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_srs_monomial_to_lagrange" c_bls12_381_G1_proj_srs_monomial_to_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE srsMonomial #-}
+-- | The "powers of tau" @[ tau^i * gen | i <- [0..n-1] ]@ in affine coordinates.
+-- Only for testing: whoever knows @tau@ can forge proofs!
+srsMonomial :: Int -> Fr -> FlatArray ZK.Algebra.Curves.BLS12_381.G1.Affine.G1
+srsMonomial n (MkFr fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray (n*12)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_proj_srs_generate (fromIntegral n) ptr1 ptr2
+  return (MkFlatArray n fptr2)
+
+{-# NOINLINE srsLagrange #-}
+-- | The same setup in the Lagrange basis of the subgroup, that is @[ L_k(tau) * gen ]@
+-- in affine coordinates. Only for testing: whoever knows @tau@ can forge proofs!
+srsLagrange :: FFTSubgroup Fr -> Fr -> FlatArray ZK.Algebra.Curves.BLS12_381.G1.Affine.G1
+srsLagrange sg (MkFr fptr2) = unsafePerformIO $ do
+  let n = fftSubgroupSize sg
+  fptr3 <- mallocForeignPtrArray (n*12)
+  L.withFlat (fftSubgroupGen sg) $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_srs_generate_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3
+  return (MkFlatArray n fptr3)
+
+{-# NOINLINE srsToLagrange #-}
+-- | Converts an existing setup @[tau^i * gen]@ (for example from a ceremony, where
+-- nobody knows @tau@) to the Lagrange basis, using the group FFT
+-- (so the points must be in the prime-order subgroup)
+srsToLagrange :: FFTSubgroup Fr -> FlatArray ZK.Algebra.Curves.BLS12_381.G1.Affine.G1 -> FlatArray ZK.Algebra.Curves.BLS12_381.G1.Affine.G1
+srsToLagrange sg (MkFlatArray n fptr2)
+  | fftSubgroupSize sg /= n   = error "srsToLagrange: subgroup size differs from the array size"
+  | otherwise                 = unsafePerformIO $ do
+      fptr3 <- mallocForeignPtrArray (n*12)
+      L.withFlat (fftSubgroupGen sg) $ \ptr1 -> do
+        withForeignPtr fptr2 $ \ptr2 -> do
+          withForeignPtr fptr3 $ \ptr3 -> do
+            c_bls12_381_G1_proj_srs_monomial_to_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3
+      return (MkFlatArray n fptr3)
+
+
+foreign import ccall unsafe "bls12_381_G1_proj_hash_to_curve" c_bls12_381_G1_proj_hash_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_encode_to_curve" c_bls12_381_G1_proj_encode_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_G1_proj_hash_to_curve_batch" c_bls12_381_G1_proj_hash_to_curve_batch :: CInt -> Ptr Word8 -> CInt -> Ptr Word8 -> Ptr CInt -> Ptr Word64 -> IO ()
+
+{-# NOINLINE hashToCurve #-}
+-- | Hashes a message to the subgroup (@hash_to_curve@ of RFC 9380). The first
+-- argument is the domain separation tag.
+hashToCurve :: [Word8] -> [Word8] -> G1
+hashToCurve dst msg = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 18
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArrayLen msg $ \msg_len ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_hash_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3
+  return (MkG1 fptr3)
+
+{-# NOINLINE encodeToCurve #-}
+-- | The non-uniform variant @encode_to_curve@ of RFC 9380 (it is faster, but
+-- its output is not indistinguishable from a random oracle)
+encodeToCurve :: [Word8] -> [Word8] -> G1
+encodeToCurve dst msg = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 18
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArrayLen msg $ \msg_len ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_encode_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3
+  return (MkG1 fptr3)
+
+{-# NOINLINE hashToCurveMany #-}
+-- | Hashes many messages at the same time (sharing the inversions), with affine output
+hashToCurveMany :: [Word8] -> [[Word8]] -> FlatArray ZK.Algebra.Curves.BLS12_381.G1.Affine.G1
+hashToCurveMany dst msgs = unsafePerformIO $ do
+  let n = length msgs
+  fptr3 <- mallocForeignPtrArray (n*12)
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArray (concat msgs) $ \ptr2 -> do
+      withArray (map (fromIntegral . length) msgs) $ \ptr_lens -> do
+        withForeignPtr fptr3 $ \ptr3 -> do
+          c_bls12_381_G1_proj_hash_to_curve_batch (fromIntegral n) ptr1 (fromIntegral dst_len) ptr2 ptr_lens ptr3
+  return (MkFlatArray n fptr3)
+
+
 -- | Sage setup code to experiment with this curve
 sageSetup :: [String]
 sageSetup = 
@@ -428,6 +569,17 @@ batchToAffine (MkFlatArray n fptr1) = unsafePerformIO $ do
       c_bls12_381_G1_proj_batch_to_affine (fromIntegral n) ptr1 ptr2
   return (MkFlatArray n fptr2)
 
+foreign import ccall unsafe "bls12_381_G1_proj_batch_to_affine_parallel" c_bls12_381_G1_proj_batch_to_affine_parallel :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE batchToAffineParallel #-}
+batchToAffineParallel :: FlatArray (ZK.Algebra.Curves.BLS12_381.G1.Proj.G1) -> FlatArray (ZK.Algebra.Curves.BLS12_381.G1.Affine.G1)
+batchToAffineParallel (MkFlatArray n fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray (n*12)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_proj_batch_to_affine_parallel (fromIntegral n) ptr1 ptr2
+  return (MkFlatArray n fptr2)
+
 foreign import ccall unsafe "bls12_381_G1_proj_neg" c_bls12_381_G1_proj_neg :: Ptr Word64 -> Ptr Word64 -> IO ()
 
 {-# NOINLINE neg #-}
@@ -520,3 +672,38 @@ sclSmallNonNeg k1 (MkG1 fptr2) = unsafePerformIO $ do
     withForeignPtr fptr3 $ \ptr3 -> do
       c_bls12_381_G1_proj_scl_small (fromIntegral k1) ptr2 ptr3
   return (MkG1 fptr3)
+
+foreign import ccall unsafe "bls12_381_G1_proj_scl_ct_Fr_mont" c_bls12_381_G1_proj_scl_ct_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE sclFrCT #-}
+sclFrCT :: Fr -> G1 -> G1
+sclFrCT (MkFr fptr1) (MkG1 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 18
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_scl_ct_Fr_mont ptr1 ptr2 ptr3
+  return (MkG1 fptr3)
+
+foreign import ccall unsafe "bls12_381_G1_proj_scl_glv_Fr_mont" c_bls12_381_G1_proj_scl_glv_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE sclFrGLV #-}
+sclFrGLV :: Fr -> G1 -> G1
+sclFrGLV (MkFr fptr1) (MkG1 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 18
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bls12_381_G1_proj_scl_glv_Fr_mont ptr1 ptr2 ptr3
+  return (MkG1 fptr3)
+
+foreign import ccall unsafe "bls12_381_G1_proj_clear_cofactor" c_bls12_381_G1_proj_clear_cofactor :: Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE clearCofactor #-}
+clearCofactor :: G1 -> G1
+clearCofactor (MkG1 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 18
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bls12_381_G1_proj_clear_cofactor ptr1 ptr2
+  return (MkG1 fptr2)
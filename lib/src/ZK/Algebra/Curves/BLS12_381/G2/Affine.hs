@@ -150,10 +150,12 @@ msmStd :: L.FlatArray ZK.Algebra.Curves.BLS12_381.Fr.Std.Fr -> L.FlatArray ZK.Al
 msmStd cs gs = Proj.toAffine $ Proj.msmStd cs gs
 
 -- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 forwardFFT :: FFTSubgroup Fr -> L.FlatArray G2 -> L.FlatArray G2
 forwardFFT sg = Proj.batchToAffine . Proj.forwardFFT sg . Proj.batchFromAffine
 
 -- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 inverseFFT :: FFTSubgroup Fr -> L.FlatArray G2 -> L.FlatArray G2
 inverseFFT sg = Proj.batchToAffine . Proj.inverseFFT sg . Proj.batchFromAffine
 
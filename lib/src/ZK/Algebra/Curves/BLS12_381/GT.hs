@@ -0,0 +1,146 @@
+-- | The target group GT of the pairing for BLS12_381 curve
+--
+-- GT is the subgroup of order @r@ of the multiplicative group of Fp12;
+-- its elements are represented as 'Fp12' values.
+
+-- NOTE 1: This module is intented to be imported qualified
+-- NOTE 2: Generated code, do not edit!
+
+{-# LANGUAGE BangPatterns #-}
+module ZK.Algebra.Curves.BLS12_381.GT
+  ( -- * Predicates
+    isCyclotomic
+  , isInSubgroup
+    -- * Group operations
+  , inv
+  , pow
+  , powFr
+    -- * Compression
+  , compress
+  , decompress
+  , batchDecompress
+  )
+  where
+
+--------------------------------------------------------------------------------
+  
+import Data.Word
+import Foreign.C
+import Foreign.Ptr
+import Foreign.ForeignPtr
+import Foreign.Marshal
+import System.IO.Unsafe
+
+import ZK.Algebra.Class.Flat as L
+import ZK.Algebra.Helpers
+
+import ZK.Algebra.Curves.BLS12_381.Fr.Mont   ( Fr(..)   )
+import ZK.Algebra.Curves.BLS12_381.Fp6.Mont  ( Fp6(..)  )
+import ZK.Algebra.Curves.BLS12_381.Fp12.Mont ( Fp12(..) )
+
+--------------------------------------------------------------------------------
+
+foreign import ccall unsafe "bls12_381_gt_is_cyclotomic"     c_gt_is_cyclotomic     :: Ptr Word64 -> IO Word8
+foreign import ccall unsafe "bls12_381_gt_is_in_subgroup"    c_gt_is_in_subgroup    :: Ptr Word64 -> IO Word8
+foreign import ccall unsafe "bls12_381_Fp12_mont_cyclotomic_inv" c_cyclotomic_inv :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_gt_pow_Fr_mont"       c_gt_pow_Fr_mont       :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_gt_pow_gen"           c_gt_pow_gen           :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> CInt -> IO ()
+foreign import ccall unsafe "bls12_381_gt_compress"          c_gt_compress          :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_gt_decompress"        c_gt_decompress        :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_gt_batch_decompress"  c_gt_batch_decompress  :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+--------------------------------------------------------------------------------
+
+{-# NOINLINE isCyclotomic #-}
+-- | Whether the element is in the cyclotomic subgroup (of order @p^4-p^2+1@)
+isCyclotomic :: Fp12 -> Bool
+isCyclotomic (MkFp12 fptr) = unsafePerformIO $ do
+  cret <- withForeignPtr fptr $ \ptr -> do
+    c_gt_is_cyclotomic ptr
+  return (cret /= 0)
+
+{-# NOINLINE isInSubgroup #-}
+-- | Whether the element is in GT (the subgroup of order @r@)
+isInSubgroup :: Fp12 -> Bool
+isInSubgroup (MkFp12 fptr) = unsafePerformIO $ do
+  cret <- withForeignPtr fptr $ \ptr -> do
+    c_gt_is_in_subgroup ptr
+  return (cret /= 0)
+
+--------------------------------------------------------------------------------
+
+{-# NOINLINE inv #-}
+-- | Inversion in the cyclotomic subgroup (which is just the conjugation)
+inv :: Fp12 -> Fp12
+inv (MkFp12 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_cyclotomic_inv ptr1 ptr2
+  return (MkFp12 fptr2)
+
+-- | Exponentiation in the cyclotomic subgroup by an arbitrary integer
+pow :: Fp12 -> Integer -> Fp12
+pow x e
+  | e >= 0     =      powNonNeg x         e
+  | otherwise  = inv (powNonNeg x (negate e))
+
+{-# NOINLINE powNonNeg #-}
+powNonNeg :: Fp12 -> Integer -> Fp12
+powNonNeg (MkFp12 fptr1) expo = unsafePerformIO $ do
+  let (n,ws) = toWord64sLE_ expo
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withArray (ws ++ [0]) $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_gt_pow_gen ptr1 ptr2 ptr3 (fromIntegral n)
+  return (MkFp12 fptr3)
+
+{-# NOINLINE powFr #-}
+-- | Exponentiation of an element of GT by an element of Fr. This uses the
+-- Frobenius endomorphism to decompose the exponent, and is much faster than 'pow'.
+-- The input must be in GT!
+powFr :: Fp12 -> Fr -> Fp12
+powFr (MkFp12 fptr1) (MkFr fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_gt_pow_Fr_mont ptr1 ptr2 ptr3
+  return (MkFp12 fptr3)
+
+--------------------------------------------------------------------------------
+
+{-# NOINLINE compress #-}
+-- | Compresses an element of GT into a single Fp6 element (torus-based compression)
+compress :: Fp12 -> Fp6
+compress (MkFp12 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 36
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_gt_compress ptr1 ptr2
+  return (MkFp6 fptr2)
+
+{-# NOINLINE decompress #-}
+-- | Inverse of 'compress'. Note: the result is not necessarily in GT, so
+-- untrusted inputs should be checked with 'isInSubgroup'
+decompress :: Fp6 -> Fp12
+decompress (MkFp6 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_gt_decompress ptr1 ptr2
+  return (MkFp12 fptr2)
+
+{-# NOINLINE batchDecompress #-}
+-- | Decompresses many elements at once, sharing the field inversions
+batchDecompress :: [Fp6] -> [Fp12]
+batchDecompress [] = []
+batchDecompress cs = unsafePerformIO $ do
+  let MkFlatArray n fptr1 = L.packFlatArrayFromList cs
+  fptr2 <- mallocForeignPtrArray (n * 72)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_gt_batch_decompress (fromIntegral n) ptr1 ptr2
+  return (L.unpackFlatArrayToList (MkFlatArray n fptr2))
+
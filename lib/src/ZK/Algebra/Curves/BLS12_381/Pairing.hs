@@ -7,6 +7,16 @@
 module ZK.Algebra.Curves.BLS12_381.Pairing
   ( pairing
   , pairingProj
+  , pairingMulti
+  , pairingMultiAffine
+    -- * parallel versions
+  , pairingParallel
+  , pairingMultiParallel
+    -- * prepared G2 points
+  , PreparedG2
+  , prepareG2
+  , pairingPrepared
+  , pairingMultiPrepared
   )
   where
 
@@ -16,12 +26,15 @@ import Control.Monad
 import System.IO.Unsafe
 
 import Data.Word
+import Foreign.C
 import Foreign.Ptr
 import Foreign.ForeignPtr
 import Foreign.Marshal.Alloc
+import Foreign.Marshal.Array
 
 import ZK.Algebra.Class.Field   as F
 import ZK.Algebra.Class.Curve   as C
+import ZK.Algebra.Class.Flat    as L
 import qualified ZK.Algebra.Class.Pairing as P
 
 import ZK.Algebra.Curves.BLS12_381.Fr.Mont ( Fr   )
@@ -65,15 +78,20 @@ instance P.PairingCurve 'P.BLS12_381 where
   type ProjG2 'P.BLS12_381 = ProjG2.G2
   type Poly   'P.BLS12_381 = Poly
 
-  pairing _proxy = ZK.Algebra.Curves.BLS12_381.Pairing.pairing
+  pairing      _proxy = ZK.Algebra.Curves.BLS12_381.Pairing.pairing
+  pairingMulti _proxy = ZK.Algebra.Curves.BLS12_381.Pairing.pairingMulti
 
 --------------------------------------------------------------------------------
 
 -- void bls12_381_pairing_affine    (const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
 -- void bls12_381_pairing_projective(const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
+-- void bls12_381_pairing_multi     (int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
+-- void bls12_381_pairing_multi_affine(int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
 
 foreign import ccall unsafe "bls12_381_pairing_affine"     c_pairing_affine     :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
 foreign import ccall unsafe "bls12_381_pairing_projective" c_pairing_projective :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_pairing_multi"      c_pairing_multi      :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_pairing_multi_affine" c_pairing_multi_affine :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
 
 {-# NOINLINE pairing #-}
 pairing :: G1 -> G2 -> Fp12
@@ -95,3 +113,121 @@ pairingProj (ProjG1.MkG1 fptr1) (ProjG2.MkG2 fptr2) = unsafePerformIO $ do
         c_pairing_projective ptr1 ptr2 ptr3
   return (Fp12.MkFp12 fptr3)
 
+{-# NOINLINE pairingMulti #-}
+-- | Product of pairings @prod_i e(P_i,Q_i)@. The Miller loops are run in lockstep,
+-- and there is only a single final exponentiation, so this is much faster than
+-- multiplying the individual pairings
+pairingMulti :: [(G1,G2)] -> Fp12
+pairingMulti pairs = unsafePerformIO $ do
+  let MkFlatArray n fptr1 = L.packFlatArrayFromList (map fst pairs)
+  let MkFlatArray _ fptr2 = L.packFlatArrayFromList (map snd pairs)
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_multi (fromIntegral n) ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
+{-# NOINLINE pairingMultiAffine #-}
+-- | Same as 'pairingMulti', but always uses the affine Miller loop with batched
+-- inversions (which 'pairingMulti' also selects automatically for many pairs)
+pairingMultiAffine :: [(G1,G2)] -> Fp12
+pairingMultiAffine pairs = unsafePerformIO $ do
+  let MkFlatArray n fptr1 = L.packFlatArrayFromList (map fst pairs)
+  let MkFlatArray _ fptr2 = L.packFlatArrayFromList (map snd pairs)
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_multi_affine (fromIntegral n) ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
+--------------------------------------------------------------------------------
+
+-- void bls12_381_pairing_affine_parallel(const uint64_t *P, const uint64_t *Q, uint64_t *tgt);
+-- void bls12_381_pairing_multi_parallel (int n, const uint64_t *Ps, const uint64_t *Qs, uint64_t *tgt);
+
+foreign import ccall unsafe "bls12_381_pairing_affine_parallel" c_pairing_affine_parallel :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_pairing_multi_parallel"  c_pairing_multi_parallel  :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE pairingParallel #-}
+-- | Same as 'pairing', but the independent parts of the computation (the two halves
+-- of the Miller loop, and for BN curves the exponentiations in the final exponentiation)
+-- run on several threads. This reduces the latency of a single pairing on idle cores.
+pairingParallel :: G1 -> G2 -> Fp12
+pairingParallel (AffG1.MkG1 fptr1) (AffG2.MkG2 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_affine_parallel ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
+{-# NOINLINE pairingMultiParallel #-}
+-- | Same as 'pairingMulti', but the Miller loops of different pairs run on
+-- several threads
+pairingMultiParallel :: [(G1,G2)] -> Fp12
+pairingMultiParallel pairs = unsafePerformIO $ do
+  let MkFlatArray n fptr1 = L.packFlatArrayFromList (map fst pairs)
+  let MkFlatArray _ fptr2 = L.packFlatArrayFromList (map snd pairs)
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_multi_parallel (fromIntegral n) ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
+--------------------------------------------------------------------------------
+
+-- | A G2 point with all the line coefficients of the Miller loop precomputed.
+-- Useful when one of the pairing arguments is fixed (eg. the G2 generator,
+-- the KZG @[tau]_2@, or a public key).
+newtype PreparedG2 = MkPreparedG2 (ForeignPtr Word64)
+
+-- void bls12_381_pairing_prepare_G2     (const uint64_t *Q, uint64_t *prep);
+-- void bls12_381_pairing_affine_prepared(const uint64_t *P, const uint64_t *prep, uint64_t *tgt);
+-- void bls12_381_pairing_multi_prepared (int n, const uint64_t *Ps, const uint64_t *preps, uint64_t *tgt);
+
+foreign import ccall unsafe "bls12_381_pairing_prepare_G2"      c_pairing_prepare_G2      :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_pairing_affine_prepared" c_pairing_affine_prepared :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_pairing_multi_prepared"  c_pairing_multi_prepared  :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+-- | Size of a prepared G2 point in words
+preparedNWords :: Int
+preparedNWords = 2449
+
+{-# NOINLINE prepareG2 #-}
+prepareG2 :: G2 -> PreparedG2
+prepareG2 (AffG2.MkG2 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray preparedNWords
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_pairing_prepare_G2 ptr1 ptr2
+  return (MkPreparedG2 fptr2)
+
+{-# NOINLINE pairingPrepared #-}
+pairingPrepared :: G1 -> PreparedG2 -> Fp12
+pairingPrepared (AffG1.MkG1 fptr1) (MkPreparedG2 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_affine_prepared ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
+{-# NOINLINE pairingMultiPrepared #-}
+-- | Product of pairings @prod_i e(P_i,Q_i)@, where the @Q_i@ are prepared
+pairingMultiPrepared :: [(G1,PreparedG2)] -> Fp12
+pairingMultiPrepared pairs = unsafePerformIO $ do
+  let MkFlatArray n fptr1 = L.packFlatArrayFromList (map fst pairs)
+  fptr2 <- mallocForeignPtrArray (max 1 n * preparedNWords)
+  fptr3 <- mallocForeignPtrArray 72
+  withForeignPtr fptr2 $ \ptr2 -> do
+    forM_ (zip [0..] (map snd pairs)) $ \(k, MkPreparedG2 fptr) -> do
+      withForeignPtr fptr $ \ptr -> copyArray (advancePtr ptr2 (k*preparedNWords)) ptr preparedNWords
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_pairing_multi_prepared (fromIntegral n) ptr1 ptr2 ptr3
+  return (Fp12.MkFp12 fptr3)
+
@@ -0,0 +1,192 @@
+-- | Univariate polynomials over 'ZK.Algebra.Curves.BLS12_381.Fr.Mont.Fr' in evaluation form,
+-- that is, given by their values on an FFT-friendly multiplicative subgroup
+-- (equivalently, as linear combinations of the Lagrange basis polynomials of the subgroup)
+--
+-- * NOTE 1: This module is intented to be imported qualified
+--
+-- * NOTE 2: Generated code, do not edit!
+--
+
+{-# LANGUAGE BangPatterns, ForeignFunctionInterface, TypeFamilies, FlexibleInstances #-}
+module ZK.Algebra.Curves.BLS12_381.Poly.Lagrange
+  ( EvalPoly(..)
+    -- * Evaluation form
+  , mkEvalPoly
+  , evalValues
+  , evalDomainLogSize
+  , evalDomain
+    -- * Conversion
+  , fromCoeffForm
+  , toCoeffForm
+    -- * Evaluation
+  , evalAt
+    -- * Pointwise operations
+  , neg , add , sub , mul
+  , scale
+    -- * Cached domains
+  , cachedSubgroup
+  , cachedDomain
+  )
+  where
+
+--------------------------------------------------------------------------------
+
+import Data.Word
+
+import Foreign.C
+import Foreign.Ptr
+import Foreign.Marshal
+import Foreign.ForeignPtr
+
+import System.IO.Unsafe
+
+import ZK.Algebra.Curves.BLS12_381.Fr.Mont ( Fr(..) )
+import ZK.Algebra.Curves.BLS12_381.Poly ( Poly(..) )
+import qualified ZK.Algebra.Curves.BLS12_381.Poly as Poly
+import qualified ZK.Algebra.Curves.BLS12_381.Array as Arr
+
+import           ZK.Algebra.Class.Flat  as L
+import           ZK.Algebra.Class.FFT   as T
+import           ZK.Algebra.Class.Misc  ( Log2(..) , fromLog2 , exp2_ , integerLog2 )
+import qualified ZK.Algebra.Class.Poly  as P
+
+--------------------------------------------------------------------------------
+
+-- | A polynomial in evaluation form: its values on the subgroup of size @2^m@,
+-- in the natural order @[ p(1), p(g), p(g^2), ... ]@
+data EvalPoly = MkEvalPoly !Log2 !(FlatArray Fr)
+
+instance Eq EvalPoly where
+  (MkEvalPoly m1 arr1) == (MkEvalPoly m2 arr2) = (m1 == m2) && (arr1 == arr2)
+
+instance Show EvalPoly where
+  show (MkEvalPoly m arr) = "EvalPoly " ++ show (fromLog2 m) ++ " " ++ show (L.unpackFlatArrayToList arr)
+
+instance L.WrappedArray EvalPoly where
+  type Element EvalPoly = Fr
+  wrapArray   = mkEvalPoly
+  unwrapArray = evalValues
+
+instance P.EvaluationForm EvalPoly where
+  type CoeffForm EvalPoly = Poly
+  evalDomainLogSize = ZK.Algebra.Curves.BLS12_381.Poly.Lagrange.evalDomainLogSize
+  evalFormAt        = ZK.Algebra.Curves.BLS12_381.Poly.Lagrange.evalAt
+  fromCoeffForm     = ZK.Algebra.Curves.BLS12_381.Poly.Lagrange.fromCoeffForm
+  toCoeffForm       = ZK.Algebra.Curves.BLS12_381.Poly.Lagrange.toCoeffForm
+  evalFormMul       = ZK.Algebra.Curves.BLS12_381.Poly.Lagrange.mul
+
+-- | Wraps the values on a subgroup (the size must be a power of two)
+mkEvalPoly :: FlatArray Fr -> EvalPoly
+mkEvalPoly arr
+  | n >= 1 && exp2_ m == n  = MkEvalPoly m arr
+  | otherwise               = error "mkEvalPoly: the size of the array is not a power of two"
+  where
+    n = flatArrayLength arr
+    m = integerLog2 (fromIntegral n)
+
+-- | The values on the subgroup
+evalValues :: EvalPoly -> FlatArray Fr
+evalValues (MkEvalPoly _ arr) = arr
+
+-- | @log2@ of the size of the evaluation domain
+evalDomainLogSize :: EvalPoly -> Log2
+evalDomainLogSize (MkEvalPoly m _) = m
+
+-- | The evaluation domain
+evalDomain :: EvalPoly -> FFTSubgroup Fr
+evalDomain (MkEvalPoly m _) = cachedSubgroup m
+
+--------------------------------------------------------------------------------
+
+foreign import ccall unsafe "bls12_381_poly_mont_fft_domain"       c_bls12_381_poly_mont_fft_domain       :: CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_poly_mont_eval_lagrange_at" c_bls12_381_poly_mont_eval_lagrange_at :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bls12_381_poly_mont_ntt_forward"      c_bls12_381_poly_mont_ntt_forward      :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+-- | The subgroups and their elements, indexed by @log2@ of the size
+-- (these are only computed when first needed)
+domainCache :: [(FFTSubgroup Fr, FlatArray Fr)]
+domainCache = [ (getFFTSubgroup (Log2 m), makeDomain m) | m <- [0..32] ]
+
+{-# NOINLINE makeDomain #-}
+makeDomain :: Int -> FlatArray Fr
+makeDomain m = unsafePerformIO $ do
+  let n = 2^m
+  fptr <- mallocForeignPtrArray (n*4)
+  withForeignPtr fptr $ \ptr -> c_bls12_381_poly_mont_fft_domain (fromIntegral m) ptr
+  return (MkFlatArray n fptr)
+
+-- | The subgroup of size @2^m@ (cached)
+cachedSubgroup :: Log2 -> FFTSubgroup Fr
+cachedSubgroup (Log2 m) = fst (domainCache !! m)
+
+-- | The elements @[1,g,g^2,...]@ of the subgroup of size @2^m@ (cached)
+cachedDomain :: Log2 -> FlatArray Fr
+cachedDomain (Log2 m) = snd (domainCache !! m)
+
+--------------------------------------------------------------------------------
+
+{-# NOINLINE fromCoeffForm #-}
+-- | Evaluates a polynomial on the subgroup of size @2^m@.
+-- The degree of the polynomial must be smaller than the size of the subgroup.
+fromCoeffForm :: Log2 -> Poly -> EvalPoly
+fromCoeffForm logm@(Log2 m) poly@(MkPoly (MkFlatArray n1 fptr1))
+  | Poly.degree poly >= n  = error "fromCoeffForm: the degree of the polynomial is too large for this domain"
+  | otherwise              = unsafePerformIO $ do
+      let k = min n n1
+      fptr2 <- mallocForeignPtrArray (n*4)
+      fptr3 <- mallocForeignPtrArray (n*4)
+      withFlat (fftSubgroupGen (cachedSubgroup logm)) $ \ptr0 -> do
+        withForeignPtr fptr1 $ \ptr1 -> do
+          withForeignPtr fptr2 $ \ptr2 -> do
+            withForeignPtr fptr3 $ \ptr3 -> do
+              copyBytes ptr2 ptr1 (8*4*k)
+              fillBytes (plusPtr ptr2 (8*4*k)) 0 (8*4*(n-k))
+              c_bls12_381_poly_mont_ntt_forward (fromIntegral m) ptr0 ptr2 ptr3
+      return (MkEvalPoly logm (MkFlatArray n fptr3))
+  where
+    n = 2^m
+
+-- | Interpolates the coefficient form
+toCoeffForm :: EvalPoly -> Poly
+toCoeffForm (MkEvalPoly m arr) = Poly.inverseNTT (cachedSubgroup m) arr
+
+{-# NOINLINE evalAt #-}
+-- | Evaluates at an arbitrary location (using the barycentric formula)
+evalAt :: Fr -> EvalPoly -> Fr
+evalAt (MkFr fptr1) (MkEvalPoly logm@(Log2 m) (MkFlatArray _ fptr2)) = unsafePerformIO $ do
+  let MkFlatArray _ fptr0 = cachedDomain logm
+  fptr3 <- mallocForeignPtrArray 4
+  withForeignPtr fptr0 $ \ptr0 -> do
+    withForeignPtr fptr1 $ \ptr1 -> do
+      withForeignPtr fptr2 $ \ptr2 -> do
+        withForeignPtr fptr3 $ \ptr3 -> do
+          c_bls12_381_poly_mont_eval_lagrange_at (fromIntegral m) ptr0 ptr2 ptr1 ptr3
+  return (MkFr fptr3)
+
+--------------------------------------------------------------------------------
+
+pointwise2 :: String -> (FlatArray Fr -> FlatArray Fr -> FlatArray Fr) -> EvalPoly -> EvalPoly -> EvalPoly
+pointwise2 name f (MkEvalPoly m1 arr1) (MkEvalPoly m2 arr2)
+  | m1 /= m2   = error (name ++ ": incompatible evaluation domains")
+  | otherwise  = MkEvalPoly m1 (f arr1 arr2)
+
+-- | Negation
+neg :: EvalPoly -> EvalPoly
+neg (MkEvalPoly m arr) = MkEvalPoly m (Arr.neg arr)
+
+-- | Addition
+add :: EvalPoly -> EvalPoly -> EvalPoly
+add = pointwise2 "add" Arr.add
+
+-- | Subtraction
+sub :: EvalPoly -> EvalPoly -> EvalPoly
+sub = pointwise2 "sub" Arr.sub
+
+-- | Pointwise multiplication. Note: this is the product modulo @(x^N - 1)@,
+-- so it agrees with the polynomial product only if the degree of that is less than @N@.
+mul :: EvalPoly -> EvalPoly -> EvalPoly
+mul = pointwise2 "mul" Arr.mul
+
+-- | Multiplies by a constant
+scale :: Fr -> EvalPoly -> EvalPoly
+scale c (MkEvalPoly m arr) = MkEvalPoly m (Arr.scale c arr)
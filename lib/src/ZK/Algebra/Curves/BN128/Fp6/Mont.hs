@@ -389,7 +389,7 @@ powBigInt256 (MkFp6 fptr1) (MkBigInt256 fptr2) = unsafePerformIO $ do
   withForeignPtr fptr1 $ \ptr1 -> do
     withForeignPtr fptr2 $ \ptr2 -> do
       withForeignPtr fptr3 $ \ptr3 -> do
-        c_bn128_Fp6_mont_pow_gen ptr1 ptr2 ptr3 24
+        c_bn128_Fp6_mont_pow_gen ptr1 ptr2 ptr3 4
   return (MkFp6 fptr3)
 
 ----------------------------------------
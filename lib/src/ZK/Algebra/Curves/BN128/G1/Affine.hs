@@ -149,10 +149,12 @@ msmStd :: L.FlatArray ZK.Algebra.Curves.BN128.Fr.Std.Fr -> L.FlatArray ZK.Algebr
 msmStd cs gs = Proj.toAffine $ Proj.msmStd cs gs
 
 -- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 forwardFFT :: FFTSubgroup Fr -> L.FlatArray G1 -> L.FlatArray G1
 forwardFFT sg = Proj.batchToAffine . Proj.forwardFFT sg . Proj.batchFromAffine
 
 -- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 inverseFFT :: FFTSubgroup Fr -> L.FlatArray G1 -> L.FlatArray G1
 inverseFFT sg = Proj.batchToAffine . Proj.inverseFFT sg . Proj.batchFromAffine
 
@@ -14,7 +14,7 @@ module ZK.Algebra.Curves.BN128.G2.Proj
   , coords , mkPoint , mkPointMaybe , unsafeMkPoint
     -- * Conversion to\/from affine
   , fromAffine , toAffine
-  , batchFromAffine , batchToAffine
+  , batchFromAffine , batchToAffine , batchToAffineParallel
   , normalize
     -- * Predicates
   , isEqual , isSame
@@ -22,7 +22,15 @@ module ZK.Algebra.Curves.BN128.G2.Proj
     -- * Addition and doubling
   , neg , add , madd, dbl , sub
     -- * Scaling
-  , sclFr , sclBig , sclSmall
+  , sclFr , sclBig , sclSmall , sclFrCT
+    -- * Cofactor clearing
+  , clearCofactor
+    -- * Fixed-base scaling
+  , sclGen , CombTable , combTable , sclComb
+    -- * Structured reference strings (for testing)
+  , srsMonomial , srsLagrange , srsToLagrange
+    -- * Hashing to the curve
+  , hashToCurve , encodeToCurve , hashToCurveMany
     -- * Random
   , rndG2 , rndG2_naive
     -- * Multi-scalar multiplication
@@ -144,7 +152,9 @@ rndG2_naive = do
 
 -- | Returns a uniformly random element /in the subgroup G2/.
 rndG2 :: IO G2
-rndG2 = rndG2_naive
+rndG2 = do
+  k <- Fr.rnd :: IO Fr
+  return (sclGen k)
 
 --------------------------------------------------------------------------------
 
@@ -270,6 +280,7 @@ foreign import ccall unsafe "bn128_G2_proj_fft_forward" c_bn128_G2_proj_fft_forw
 
 {-# NOINLINE forwardFFT #-}
 -- | Forward FFT for groups (converting @[L_k(tau)]@ points to @[tau^i]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 forwardFFT :: FFTSubgroup Fr -> FlatArray G2 -> FlatArray G2
 forwardFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "forwardNTT: subgroup size differs from the array size"
@@ -283,6 +294,7 @@ forwardFFT sg (MkFlatArray n fptr2)
 
 {-# NOINLINE inverseFFT #-}
 -- | Inverse FFT for groups (converting @[tau^i]@ points to @[L_k(tau)]@ points)
+-- The points must be in the prime-order subgroup (the scalars are only defined modulo @r@)
 inverseFFT :: FFTSubgroup Fr -> FlatArray G2 -> FlatArray G2
 inverseFFT sg (MkFlatArray n fptr2)
   | fftSubgroupSize sg /= n   = error "inverseNTT: subgroup size differs from the array size"
@@ -295,6 +307,134 @@ inverseFFT sg (MkFlatArray n fptr2)
       return (MkFlatArray n fptr3)
 
 
+foreign import ccall unsafe "bn128_G2_proj_comb_precompute" c_bn128_G2_proj_comb_precompute :: Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_comb_scl_Fr_mont" c_bn128_G2_proj_comb_scl_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_scl_gen_Fr_mont" c_bn128_G2_proj_scl_gen_Fr_mont :: Ptr Word64 -> Ptr Word64 -> IO ()
+
+-- | Precomputed table for fixed-base scalar multiplication (see 'combTable')
+newtype CombTable = MkCombTable (ForeignPtr Word64)
+
+{-# NOINLINE combTable #-}
+-- | Precomputes the table for fast scalar multiplications of a fixed base point.
+-- This costs about as much as 20-30 scalar multiplications (and uses 127 kilobytes),
+-- so it only pays off when the same base is multiplied many times
+combTable :: G2 -> CombTable
+combTable (MkG2 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 16320
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_G2_proj_comb_precompute ptr1 ptr2
+  return (MkCombTable fptr2)
+
+{-# NOINLINE sclComb #-}
+-- | Scalar multiplication of a fixed base point, using its precomputed table
+sclComb :: CombTable -> Fr -> G2
+sclComb (MkCombTable fptr1) (MkFr fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 24
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_G2_proj_comb_scl_Fr_mont ptr1 ptr2 ptr3
+  return (MkG2 fptr3)
+
+{-# NOINLINE sclGen #-}
+-- | Multiplies the subgroup generator by a scalar (using a table which is
+-- precomputed on first use). This is much faster than @sclFr k genG2@
+sclGen :: Fr -> G2
+sclGen (MkFr fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 24
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_G2_proj_scl_gen_Fr_mont ptr1 ptr2
+  return (MkG2 fptr2)
+
+
+foreign import ccall unsafe "bn128_G2_proj_srs_generate" c_bn128_G2_proj_srs_generate :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_srs_generate_lagrange" c_bn128_G2_proj_srs_generate_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_srs_monomial_to_lagrange" c_bn128_G2_proj_srs_monomial_to_lagrange :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE srsMonomial #-}
+-- | The "powers of tau" @[ tau^i * gen | i <- [0..n-1] ]@ in affine coordinates.
+-- Only for testing: whoever knows @tau@ can forge proofs!
+srsMonomial :: Int -> Fr -> FlatArray ZK.Algebra.Curves.BN128.G2.Affine.G2
+srsMonomial n (MkFr fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray (n*16)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_G2_proj_srs_generate (fromIntegral n) ptr1 ptr2
+  return (MkFlatArray n fptr2)
+
+{-# NOINLINE srsLagrange #-}
+-- | The same setup in the Lagrange basis of the subgroup, that is @[ L_k(tau) * gen ]@
+-- in affine coordinates. Only for testing: whoever knows @tau@ can forge proofs!
+srsLagrange :: FFTSubgroup Fr -> Fr -> FlatArray ZK.Algebra.Curves.BN128.G2.Affine.G2
+srsLagrange sg (MkFr fptr2) = unsafePerformIO $ do
+  let n = fftSubgroupSize sg
+  fptr3 <- mallocForeignPtrArray (n*16)
+  L.withFlat (fftSubgroupGen sg) $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_G2_proj_srs_generate_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3
+  return (MkFlatArray n fptr3)
+
+{-# NOINLINE srsToLagrange #-}
+-- | Converts an existing setup @[tau^i * gen]@ (for example from a ceremony, where
+-- nobody knows @tau@) to the Lagrange basis, using the group FFT
+-- (so the points must be in the prime-order subgroup)
+srsToLagrange :: FFTSubgroup Fr -> FlatArray ZK.Algebra.Curves.BN128.G2.Affine.G2 -> FlatArray ZK.Algebra.Curves.BN128.G2.Affine.G2
+srsToLagrange sg (MkFlatArray n fptr2)
+  | fftSubgroupSize sg /= n   = error "srsToLagrange: subgroup size differs from the array size"
+  | otherwise                 = unsafePerformIO $ do
+      fptr3 <- mallocForeignPtrArray (n*16)
+      L.withFlat (fftSubgroupGen sg) $ \ptr1 -> do
+        withForeignPtr fptr2 $ \ptr2 -> do
+          withForeignPtr fptr3 $ \ptr3 -> do
+            c_bn128_G2_proj_srs_monomial_to_lagrange (fromIntegral $ M.fromLog2 $ fftSubgroupLogSize sg) ptr1 ptr2 ptr3
+      return (MkFlatArray n fptr3)
+
+
+foreign import ccall unsafe "bn128_G2_proj_hash_to_curve" c_bn128_G2_proj_hash_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_encode_to_curve" c_bn128_G2_proj_encode_to_curve :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_G2_proj_hash_to_curve_batch" c_bn128_G2_proj_hash_to_curve_batch :: CInt -> Ptr Word8 -> CInt -> Ptr Word8 -> Ptr CInt -> Ptr Word64 -> IO ()
+
+{-# NOINLINE hashToCurve #-}
+-- | Hashes a message to the subgroup (@hash_to_curve@ of RFC 9380). The first
+-- argument is the domain separation tag.
+hashToCurve :: [Word8] -> [Word8] -> G2
+hashToCurve dst msg = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 24
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArrayLen msg $ \msg_len ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_G2_proj_hash_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3
+  return (MkG2 fptr3)
+
+{-# NOINLINE encodeToCurve #-}
+-- | The non-uniform variant @encode_to_curve@ of RFC 9380 (it is faster, but
+-- its output is not indistinguishable from a random oracle)
+encodeToCurve :: [Word8] -> [Word8] -> G2
+encodeToCurve dst msg = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 24
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArrayLen msg $ \msg_len ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_G2_proj_encode_to_curve ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) ptr3
+  return (MkG2 fptr3)
+
+{-# NOINLINE hashToCurveMany #-}
+-- | Hashes many messages at the same time (sharing the inversions), with affine output
+hashToCurveMany :: [Word8] -> [[Word8]] -> FlatArray ZK.Algebra.Curves.BN128.G2.Affine.G2
+hashToCurveMany dst msgs = unsafePerformIO $ do
+  let n = length msgs
+  fptr3 <- mallocForeignPtrArray (n*16)
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArray (concat msgs) $ \ptr2 -> do
+      withArray (map (fromIntegral . length) msgs) $ \ptr_lens -> do
+        withForeignPtr fptr3 $ \ptr3 -> do
+          c_bn128_G2_proj_hash_to_curve_batch (fromIntegral n) ptr1 (fromIntegral dst_len) ptr2 ptr_lens ptr3
+  return (MkFlatArray n fptr3)
+
+
 -- | Sage setup code to experiment with this curve
 sageSetup :: [String]
 sageSetup = [ "# Sage for G2: TODO" ]
@@ -405,6 +545,17 @@ batchToAffine (MkFlatArray n fptr1) = unsafePerformIO $ do
       c_bn128_G2_proj_batch_to_affine (fromIntegral n) ptr1 ptr2
   return (MkFlatArray n fptr2)
 
+foreign import ccall unsafe "bn128_G2_proj_batch_to_affine_parallel" c_bn128_G2_proj_batch_to_affine_parallel :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE batchToAffineParallel #-}
+batchToAffineParallel :: FlatArray (ZK.Algebra.Curves.BN128.G2.Proj.G2) -> FlatArray (ZK.Algebra.Curves.BN128.G2.Affine.G2)
+batchToAffineParallel (MkFlatArray n fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray (n*16)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_G2_proj_batch_to_affine_parallel (fromIntegral n) ptr1 ptr2
+  return (MkFlatArray n fptr2)
+
 foreign import ccall unsafe "bn128_G2_proj_neg" c_bn128_G2_proj_neg :: Ptr Word64 -> Ptr Word64 -> IO ()
 
 {-# NOINLINE neg #-}
@@ -497,3 +648,26 @@ sclSmallNonNeg k1 (MkG2 fptr2) = unsafePerformIO $ do
     withForeignPtr fptr3 $ \ptr3 -> do
       c_bn128_G2_proj_scl_small (fromIntegral k1) ptr2 ptr3
   return (MkG2 fptr3)
+
+foreign import ccall unsafe "bn128_G2_proj_scl_ct_Fr_mont" c_bn128_G2_proj_scl_ct_Fr_mont :: Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE sclFrCT #-}
+sclFrCT :: Fr -> G2 -> G2
+sclFrCT (MkFr fptr1) (MkG2 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray 24
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_G2_proj_scl_ct_Fr_mont ptr1 ptr2 ptr3
+  return (MkG2 fptr3)
+
+foreign import ccall unsafe "bn128_G2_proj_clear_cofactor" c_bn128_G2_proj_clear_cofactor :: Ptr Word64 -> Ptr Word64 -> IO ()
+
+{-# NOINLINE clearCofactor #-}
+clearCofactor :: G2 -> G2
+clearCofactor (MkG2 fptr1) = unsafePerformIO $ do
+  fptr2 <- mallocForeignPtrArray 24
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_G2_proj_clear_cofactor ptr1 ptr2
+  return (MkG2 fptr2)
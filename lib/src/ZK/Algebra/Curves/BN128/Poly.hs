@@ -20,6 +20,7 @@ module ZK.Algebra.Curves.BN128.Poly
   , constTermOf
   , kthCoeff
   , evalAt
+  , evalManyAt
     -- * Constant polynomials
   , constPoly
   , mbConst
@@ -32,15 +33,20 @@ module ZK.Algebra.Curves.BN128.Poly
   , showPoly, showPoly'
     -- * Ring operations
   , neg , add , sub
-  , mul , mulNaive
+  , mul , mulNaive , mulNTT
   , sqr
     -- * Linear combinations
   , scale
     -- * Polynomial division
   , longDiv , quot , rem
+  , longDivNaive , longDivFast
   , divByVanishing, quotByVanishing
     -- * NTT
   , forwardNTT , inverseNTT
+    -- * Multipoint evaluation and interpolation
+  , SubproductTree , subproductTree
+  , multiEvalAt , multiEvalWithTree
+  , interpolate , interpolateWithTree
     -- * Random
   , rndPoly , rnd
   )
@@ -130,8 +136,6 @@ instance Num Poly where
   abs    = id
   signum = \_ -> constPoly 1
 
-mul = mulNaive       -- TEMPORARY !!!
-
 sqr x = mul x x      -- TEMPORARY ???
 
 instance M.Rnd Poly where
@@ -157,6 +161,7 @@ instance P.Univariate Poly where
   degree          = ZK.Algebra.Curves.BN128.Poly.degree
   kthCoeff        = ZK.Algebra.Curves.BN128.Poly.kthCoeff
   evalAt          = ZK.Algebra.Curves.BN128.Poly.evalAt
+  evalManyAt      = ZK.Algebra.Curves.BN128.Poly.evalManyAt
   scale           = ZK.Algebra.Curves.BN128.Poly.scale
   mkPoly          = ZK.Algebra.Curves.BN128.Poly.mkPoly
   mkPolyFlat      = ZK.Algebra.Curves.BN128.Poly.mkPolyFlatArr
@@ -168,6 +173,8 @@ instance P.Univariate Poly where
   polyRem         = ZK.Algebra.Curves.BN128.Poly.rem
   divByVanishing  = ZK.Algebra.Curves.BN128.Poly.divByVanishing
   quotByVanishing = ZK.Algebra.Curves.BN128.Poly.quotByVanishing
+  polyMultiEval   = ZK.Algebra.Curves.BN128.Poly.multiEvalAt
+  polyInterpolate = ZK.Algebra.Curves.BN128.Poly.interpolate
 
 --------------------------------------------------------------------------------
 
@@ -207,6 +214,8 @@ foreign import ccall unsafe "bn128_poly_mont_add"       c_bn128_poly_mont_add
 foreign import ccall unsafe "bn128_poly_mont_sub"       c_bn128_poly_mont_sub       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
 foreign import ccall unsafe "bn128_poly_mont_scale"     c_bn128_poly_mont_scale     :: Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
 foreign import ccall unsafe "bn128_poly_mont_mul_naive" c_bn128_poly_mont_mul_naive :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_mul_ntt"   c_bn128_poly_mont_mul_ntt   :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_mul"       c_bn128_poly_mont_mul       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
 
 {-# NOINLINE degree #-}
 -- | The degree of a polynomial. By definition, the degree of the constant
@@ -301,26 +310,70 @@ scale (MkFr fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do
         c_bn128_poly_mont_scale ptr1 (fromIntegral n2) ptr2 ptr3
   return (XPoly n3 fptr3)
 
-{-# NOINLINE mulNaive #-}
+-- | Multiplication of polynomials (naive for small inputs, NTT-based for large ones)
+mul :: Poly -> Poly -> Poly
+mul = mulWith c_bn128_poly_mont_mul
+
 -- | Multiplication of polynomials, naive algorithm
 mulNaive :: Poly -> Poly -> Poly
-mulNaive (XPoly n1 fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do
+mulNaive = mulWith c_bn128_poly_mont_mul_naive
+
+-- | Multiplication of polynomials, using NTT
+mulNTT :: Poly -> Poly -> Poly
+mulNTT = mulWith c_bn128_poly_mont_mul_ntt
+
+{-# NOINLINE mulWith #-}
+mulWith :: (CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()) -> Poly -> Poly -> Poly
+mulWith cfun (XPoly n1 fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do
   let n3 = n1 + n2 - 1
   fptr3 <- mallocForeignPtrArray (n3*4)
   withForeignPtr fptr1 $ \ptr1 -> do
     withForeignPtr fptr2 $ \ptr2 -> do
       withForeignPtr fptr3 $ \ptr3 -> do
-        c_bn128_poly_mont_mul_naive (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 ptr3
+        cfun (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 ptr3
   return (XPoly n3 fptr3)
 
-foreign import ccall unsafe "bn128_poly_mont_long_div" c_bn128_poly_mont_long_div :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
-foreign import ccall unsafe "bn128_poly_mont_quot"     c_bn128_poly_mont_quot     :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
-foreign import ccall unsafe "bn128_poly_mont_rem"      c_bn128_poly_mont_rem      :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_eval_many_at" c_bn128_poly_mont_eval_many_at :: CInt -> Ptr CInt -> Ptr (Ptr Word64) -> Ptr Word64 -> Ptr Word64 -> IO ()
 
-{-# NOINLINE longDiv #-}
--- | Polynomial long division
+{-# NOINLINE evalManyAt #-}
+-- | Evaluate many polynomials at the same location @x@ (the powers of @x@ are shared)
+evalManyAt :: Fr -> [Poly] -> [Fr]
+evalManyAt (MkFr fptr1) polys = unsafePerformIO $ do
+  let k = length polys
+  fptr3 <- mallocForeignPtrArray (k*4)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtrList [ fptr | XPoly _ fptr <- polys ] $ \ptrs -> do
+      withArray [ fromIntegral n | XPoly n _ <- polys ] $ \pns -> do
+        withArray ptrs $ \pptrs -> do
+          withForeignPtr fptr3 $ \ptr3 -> do
+            c_bn128_poly_mont_eval_many_at (fromIntegral k) pns pptrs ptr1 ptr3
+  return (L.unpackFlatArrayToList (MkFlatArray k fptr3))
+
+withForeignPtrList :: [ForeignPtr a] -> ([Ptr a] -> IO b) -> IO b
+withForeignPtrList []     action = action []
+withForeignPtrList (f:fs) action = withForeignPtr f $ \p -> withForeignPtrList fs $ \ps -> action (p:ps)
+
+foreign import ccall unsafe "bn128_poly_mont_long_div"       c_bn128_poly_mont_long_div       :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_long_div_naive" c_bn128_poly_mont_long_div_naive :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_long_div_fast"  c_bn128_poly_mont_long_div_fast  :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_quot"           c_bn128_poly_mont_quot           :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_rem"            c_bn128_poly_mont_rem            :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()
+
+-- | Polynomial long division (dispatches to the naive or the fast algorithm based on the sizes)
 longDiv :: Poly -> Poly -> (Poly, Poly)
-longDiv poly1@(XPoly n1 fptr1) poly2@(XPoly n2 fptr2) = unsafePerformIO $ do
+longDiv = longDivWith c_bn128_poly_mont_long_div
+
+-- | Polynomial long division, schoolbook algorithm
+longDivNaive :: Poly -> Poly -> (Poly, Poly)
+longDivNaive = longDivWith c_bn128_poly_mont_long_div_naive
+
+-- | Polynomial long division, via Newton iteration and NTT-based multiplication
+longDivFast :: Poly -> Poly -> (Poly, Poly)
+longDivFast = longDivWith c_bn128_poly_mont_long_div_fast
+
+{-# NOINLINE longDivWith #-}
+longDivWith :: (CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> IO ()) -> Poly -> Poly -> (Poly, Poly)
+longDivWith cfun poly1@(XPoly n1 fptr1) poly2@(XPoly n2 fptr2) = unsafePerformIO $ do
   let d2 = degree poly2
   let nq = max 0 (n1-d2)
   let nr = max 0 d2
@@ -330,7 +383,7 @@ longDiv poly1@(XPoly n1 fptr1) poly2@(XPoly n2 fptr2) = unsafePerformIO $ do
     withForeignPtr fptr2 $ \ptr2 -> do
       withForeignPtr fptr3 $ \ptr3 -> do
         withForeignPtr fptr4 $ \ptr4 -> do
-          c_bn128_poly_mont_long_div (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 (fromIntegral nq) ptr3 (fromIntegral nr) ptr4
+          cfun (fromIntegral n1) ptr1 (fromIntegral n2) ptr2 (fromIntegral nq) ptr3 (fromIntegral nr) ptr4
   return (XPoly nq fptr3, XPoly nr fptr4)
 
 {-# NOINLINE quot #-}
@@ -424,3 +477,56 @@ inverseNTT sg (MkFlatArray n fptr2)
 instance P.UnivariateFFT Poly where
   ntt  = forwardNTT
   intt = inverseNTT
+
+foreign import ccall unsafe "bn128_poly_mont_subproduct_tree_size"  c_bn128_poly_mont_subproduct_tree_size  :: CInt -> IO CInt
+foreign import ccall unsafe "bn128_poly_mont_subproduct_tree"       c_bn128_poly_mont_subproduct_tree       :: CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_multi_eval_with_tree"  c_bn128_poly_mont_multi_eval_with_tree  :: CInt -> Ptr Word64 -> CInt -> Ptr Word64 -> Ptr Word64 -> IO ()
+foreign import ccall unsafe "bn128_poly_mont_interpolate_with_tree" c_bn128_poly_mont_interpolate_with_tree :: CInt -> Ptr Word64 -> Ptr Word64 -> Ptr Word64 -> IO ()
+
+-- | A precomputed subproduct tree over a set of points, for repeated
+-- multipoint evaluation and interpolation on the same points
+data SubproductTree = MkSubproductTree !Int !(ForeignPtr Word64)
+
+{-# NOINLINE subproductTree #-}
+-- | Builds the subproduct tree of the given points
+subproductTree :: FlatArray Fr -> SubproductTree
+subproductTree (MkFlatArray npts fptr1) = unsafePerformIO $ do
+  size  <- fromIntegral <$> c_bn128_poly_mont_subproduct_tree_size (fromIntegral npts)
+  fptr2 <- mallocForeignPtrArray (size*4)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      c_bn128_poly_mont_subproduct_tree (fromIntegral npts) ptr1 ptr2
+  return (MkSubproductTree npts fptr2)
+
+{-# NOINLINE multiEvalWithTree #-}
+-- | Evaluates a polynomial at the points of a precomputed subproduct tree
+multiEvalWithTree :: SubproductTree -> Poly -> FlatArray Fr
+multiEvalWithTree (MkSubproductTree npts fptr1) (XPoly n2 fptr2) = unsafePerformIO $ do
+  fptr3 <- mallocForeignPtrArray (npts*4)
+  withForeignPtr fptr1 $ \ptr1 -> do
+    withForeignPtr fptr2 $ \ptr2 -> do
+      withForeignPtr fptr3 $ \ptr3 -> do
+        c_bn128_poly_mont_multi_eval_with_tree (fromIntegral npts) ptr1 (fromIntegral n2) ptr2 ptr3
+  return (MkFlatArray npts fptr3)
+
+{-# NOINLINE interpolateWithTree #-}
+-- | Lagrange interpolation on the (distinct) points of a precomputed subproduct tree
+interpolateWithTree :: SubproductTree -> FlatArray Fr -> Poly
+interpolateWithTree (MkSubproductTree npts fptr1) (MkFlatArray n2 fptr2)
+  | npts /= n2  = error "interpolateWithTree: number of values differs from the number of points"
+  | otherwise   = unsafePerformIO $ do
+      fptr3 <- mallocForeignPtrArray (npts*4)
+      withForeignPtr fptr1 $ \ptr1 -> do
+        withForeignPtr fptr2 $ \ptr2 -> do
+          withForeignPtr fptr3 $ \ptr3 -> do
+            c_bn128_poly_mont_interpolate_with_tree (fromIntegral npts) ptr1 ptr2 ptr3
+      return (XPoly npts fptr3)
+
+-- | Evaluates a polynomial at many points (using a subproduct tree)
+multiEvalAt :: FlatArray Fr -> Poly -> FlatArray Fr
+multiEvalAt pts = multiEvalWithTree (subproductTree pts)
+
+-- | Lagrange interpolation: @interpolate xs ys@ is the unique polynomial of degree
+-- less than @n@ taking the values @ys@ at the (distinct) points @xs@
+interpolate :: FlatArray Fr -> FlatArray Fr -> Poly
+interpolate pts = interpolateWithTree (subproductTree pts)
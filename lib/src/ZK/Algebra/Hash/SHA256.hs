@@ -0,0 +1,48 @@
+-- | Wrappers around the C implementation of SHA-256 and @expand_message_xmd@
+-- (RFC 9380), which is used by hashing to curves
+
+{-# LANGUAGE ForeignFunctionInterface #-}
+module ZK.Algebra.Hash.SHA256 where
+
+--------------------------------------------------------------------------------
+
+import Data.Word
+
+import Foreign.C
+import Foreign.Ptr
+import Foreign.Marshal
+
+import System.IO.Unsafe
+
+--------------------------------------------------------------------------------
+
+-- void    sha256( const uint8_t *msg, int len, uint8_t *digest );
+-- uint8_t expand_message_xmd_sha256( const uint8_t *dst, int dst_len, const uint8_t *msg, int msg_len, int len_in_bytes, uint8_t *tgt );
+
+foreign import ccall unsafe "sha256" c_sha256 :: Ptr Word8 -> CInt -> Ptr Word8 -> IO ()
+foreign import ccall unsafe "expand_message_xmd_sha256" c_expand_message_xmd_sha256 :: Ptr Word8 -> CInt -> Ptr Word8 -> CInt -> CInt -> Ptr Word8 -> IO Word8
+
+{-# NOINLINE sha256 #-}
+-- | The SHA-256 hash of a message (32 bytes)
+sha256 :: [Word8] -> [Word8]
+sha256 msg = unsafePerformIO $ do
+  withArrayLen msg $ \msg_len ptr1 -> do
+    allocaArray 32 $ \ptr2 -> do
+      c_sha256 ptr1 (fromIntegral msg_len) ptr2
+      peekArray 32 ptr2
+
+{-# NOINLINE expandMessageXMD #-}
+-- | @expandMessageXMD dst msg len@ is @expand_message_xmd@ of RFC 9380 with SHA-256,
+-- the first argument is the domain separation tag. Returns @Nothing@ if the
+-- requested length is too big (more than 255 blocks of 32 bytes)
+expandMessageXMD :: [Word8] -> [Word8] -> Int -> Maybe [Word8]
+expandMessageXMD dst msg len = unsafePerformIO $ do
+  withArrayLen dst $ \dst_len ptr1 -> do
+    withArrayLen msg $ \msg_len ptr2 -> do
+      allocaArray (max 1 len) $ \ptr3 -> do
+        ok <- c_expand_message_xmd_sha256 ptr1 (fromIntegral dst_len) ptr2 (fromIntegral msg_len) (fromIntegral len) ptr3
+        if ok /= 0
+          then Just <$> peekArray len ptr3
+          else return Nothing
+
+--------------------------------------------------------------------------------
@@ -0,0 +1,183 @@
+-- | KZG polynomial commitments, generic over pairing curves
+--
+-- This includes batch verification of many opening proofs (with a random
+-- linear combination), and bisection to locate the invalid ones.
+--
+
+{-# LANGUAGE
+      ScopedTypeVariables, TypeFamilies, DataKinds, KindSignatures,
+      BangPatterns, StandaloneDeriving, FlexibleContexts
+  #-}
+module ZK.Algebra.KZG where
+
+--------------------------------------------------------------------------------
+
+import Data.Proxy
+import Data.Kind
+
+import Control.Monad
+
+import ZK.Algebra.API
+import ZK.Algebra.Class.Pairing
+
+--------------------------------------------------------------------------------
+-- * setup
+
+data KZGSetup (c :: SomeCurve) = MkKZGSetup
+  { _kzgDomain    :: FFTDomain (Fr c)
+  , _tauG1s       :: FlatArray (G1 c)
+  , _lagrangeTaus :: FlatArray (G1 c)
+  , _g2TauG2      :: (G2 c, G2 c)
+  }
+
+data VerifierKey (c :: SomeCurve) = VerifKey
+  { _g1   :: !(G1 c)
+  , _g2   :: !(G2 c)
+  , _tau2 :: !(G2 c)
+  }
+
+extractVerifierKey :: forall c. PairingCurve c => KZGSetup c -> VerifierKey c
+extractVerifierKey setup = VerifKey g1 g2 tau2 where
+  g1 = peekFlatArray (_tauG1s setup) 0
+  (g2,tau2) = _g2TauG2 setup
+
+-- | Creates a setup with the given secret @tau@ (only for testing!)
+mkKZGSetup :: forall c. PairingCurve c => Proxy c -> Fr c -> Log2 -> KZGSetup c
+mkKZGSetup pxy tau m = setup where
+
+  n      = exp2_ m
+  dom    = getFFTDomain m
+  tauG1s = packFlatArrayFromList' n (taus tau n)
+
+  g1 = curveSubgroupGen :: G1 c
+  g2 = curveSubgroupGen :: G2 c
+
+  setup = MkKZGSetup
+    { _kzgDomain    = dom
+    , _tauG1s       = tauG1s
+    , _lagrangeTaus = curveIFFT dom tauG1s
+    , _g2TauG2      = (g2, tau <**> g2)
+    }
+
+  taus :: Fr c -> Int -> [G1 c]
+  taus !tau n = go n 1 where
+    go 0 _    = []
+    go k !acc = acc <**> g1 : go (k-1) (tau*acc)
+
+-- | Creates a setup with a random secret (only for testing!)
+newKZGSetup :: forall c. PairingCurve c => Proxy c -> Log2 -> IO (KZGSetup c)
+newKZGSetup pxy m = do
+  tau <- rndIO
+  return $ mkKZGSetup pxy tau m
+
+--------------------------------------------------------------------------------
+-- * commitments
+
+newtype Commitment c
+  = Com (G1 c)
+
+deriving instance PairingCurve c => Eq   (Commitment c)
+deriving instance PairingCurve c => Show (Commitment c)
+
+commitPoly :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> Poly c -> Commitment c
+commitPoly pxy setup poly = (Com com) where
+  coeffs = unwrapArray poly
+  tauG1s = takeFlatArray (flatArrayLength coeffs) (_tauG1s setup)
+  com    = msm coeffs tauG1s
+
+commitValues :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> FlatArray (Fr c) -> Commitment c
+commitValues pxy setup values
+  | fftDomainSize dom == flatArrayLength values = (Com com)
+  | otherwise = error "commitValues: expecting a vector of the same size as the KZG setup domain"
+  where
+    com = msm values (_lagrangeTaus setup)
+    dom = _kzgDomain setup
+
+commitInterpolate :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> FlatArray (Fr c) -> Commitment c
+commitInterpolate pxy setup values
+  | fftDomainSize dom == flatArrayLength values = com
+  | otherwise = error "commitInterpolate: expecting a vector of the same size as the KZG setup domain"
+  where
+    com = commitPoly pxy setup (intt dom values)
+    dom = _kzgDomain setup
+
+--------------------------------------------------------------------------------
+-- * opening proofs
+
+data Opening c = Opening
+  { _location :: !(Fr c)
+  , _value    :: !(Fr c)
+  , _proof    :: !(G1 c)
+  }
+
+deriving instance PairingCurve c => Eq   (Opening c)
+deriving instance PairingCurve c => Show (Opening c)
+
+openingProof :: forall c. PairingCurve c => Proxy c -> KZGSetup c -> Poly c -> Fr c -> Opening c
+openingProof pxy setup poly loc = Opening loc val prf where
+  val = evalAt loc poly
+  mb  = quotByVanishing (poly - constPoly val) (1,loc)   -- divide (p-val) by (x-loc)
+  prf = case mb of
+    Just q  -> let Com prf = commitPoly pxy setup q in prf
+    Nothing -> error "openingProof: fatal error, should not happen"
+
+verifyProof :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> Commitment c -> Opening c -> Bool
+verifyProof pxy (VerifKey g1 g2 tau2) (Com comP) (Opening x0 y0 comQ) = (lhs == rhs) where
+  lhs = pairing pxy comQ  tau2
+  rhs = pairing pxy point g2
+  point = comP <+> (scalarMul x0 comQ <-> scalarMul y0 g1)
+
+--------------------------------------------------------------------------------
+-- * batch verification
+
+-- | Verifies many opening proofs at once. Using random scalars @r_i@, the @N@
+-- pairing equations
+--
+-- > e(Q_i, [tau]_2) == e(P_i + x_i*Q_i - y_i*G1, G2)
+--
+-- are combined into the single equation
+--
+-- > e(sum r_i*Q_i, [tau]_2) == e(sum r_i*P_i + sum (r_i*x_i)*Q_i - (sum r_i*y_i)*G1, G2)
+--
+-- so the cost is two MSMs and a product of two pairings, instead of @2N@ pairings.
+-- If any of the proofs is invalid, this fails with overwhelming probability.
+batchVerifyProofs :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> [(Commitment c, Opening c)] -> IO Bool
+batchVerifyProofs pxy vkey items = do
+  rs <- replicateM (length items) rndIO
+  return (batchVerifyWith pxy vkey rs items)
+
+-- | Like 'batchVerifyProofs', but when the batch fails, it is bisected to locate
+-- the invalid proofs. Returns the (0-based) indices of the failing items, so an
+-- empty list means success. With @k@ invalid proofs, this needs @O(k*log(N))@ batch checks.
+batchVerifyProofsBisect :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> [(Commitment c, Opening c)] -> IO [Int]
+batchVerifyProofsBisect pxy vkey items = do
+  rs <- replicateM (length items) rndIO
+  return (batchBisectWith pxy vkey rs items)
+
+-- | Batch verification with the given random scalars
+batchVerifyWith :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> [Fr c] -> [(Commitment c, Opening c)] -> Bool
+batchVerifyWith _   _                     _  []    = True
+batchVerifyWith pxy (VerifKey g1 g2 tau2) rs items = (prod == 1) where
+  n    = length items
+  coms = [ comP | (Com comP, _) <- items ]
+  prfs = map (_proof    . snd) items
+  locs = map (_location . snd) items
+  vals = map (_value    . snd) items
+  rxs  = zipWith (*) rs locs
+  ry   = sum (zipWith (*) rs vals)
+  lhs  = msm (packFlatArrayFromList' n rs) (packFlatArrayFromList' n prfs)
+  rhs  = msm (packFlatArrayFromList' (2*n) (rs ++ rxs)) (packFlatArrayFromList' (2*n) (coms ++ prfs)) <-> scalarMul ry g1
+  prod = pairingMulti pxy [ (lhs, tau2) , (grpNeg rhs, g2) ]
+
+-- | Bisection with the given random scalars (see 'batchVerifyProofsBisect')
+batchBisectWith :: forall c. PairingCurve c => Proxy c -> VerifierKey c -> [Fr c] -> [(Commitment c, Opening c)] -> [Int]
+batchBisectWith pxy vkey rs items = go (zip [0..] (zip rs items)) where
+  go :: [(Int, (Fr c, (Commitment c, Opening c)))] -> [Int]
+  go [] = []
+  go xs
+    | batchVerifyWith pxy vkey (map (fst . snd) xs) (map (snd . snd) xs) = []
+    | otherwise = case xs of
+        [(i,_)] -> [i]
+        _       -> let (as,bs) = splitAt (div (length xs) 2) xs in go as ++ go bs
+
+--------------------------------------------------------------------------------
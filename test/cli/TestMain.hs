@@ -41,7 +41,9 @@ help = do
   putStrLn " - jac_curve"
   putStrLn " - affine_curve_g2"
   putStrLn " - proj_curve_g2"
+  putStrLn " - jac_curve_g2"
   putStrLn " - pairings"
+  putStrLn " - hash_to_curve"
   putStrLn " - poly"
   putStrLn ""
 
@@ -61,7 +63,9 @@ validNames =
   , "projcurve"   , "projective"   , "proj" 
   , "projcurveg2" , "projectiveg2" , "projg2"
   , "jaccurve" , "jacobiancurve" , "jacobian"
+  , "jaccurveg2" , "jacobiancurveg2" , "jacobiang2"
   , "pairing", "pairings"
+  , "hashtocurve" , "h2c"
   , "poly" , "polynomial" , "univariate"
   ]
 
@@ -106,10 +110,16 @@ testMain what n = case canonicalizeName what of
   "jaccurve"      -> runTestsJacCurve n
   "jacobian"      -> runTestsJacCurve n
   "jacobiancurve" -> runTestsJacCurve n
+  "jaccurveg2"      -> runTestsJacCurveG2 n
+  "jacobiang2"      -> runTestsJacCurveG2 n
+  "jacobiancurveg2" -> runTestsJacCurveG2 n
 
   "pairing"     -> runTestsPairings n
   "pairings"    -> runTestsPairings n
 
+  "hashtocurve" -> runTestsHashToCurve n
+  "h2c"         -> runTestsHashToCurve n
+
   "poly"        -> runTestsPolys n 
   "polynomial"  -> runTestsPolys n 
   "univariate"  -> runTestsPolys n
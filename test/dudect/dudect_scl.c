@@ -0,0 +1,195 @@
+
+// dudect-style timing leakage test for the scalar multiplication
+//
+// see: Reparaz, Balasch, Verbauwhede: "Dude, is my code constant time?"
+// <https://eprint.iacr.org/2016/1123>
+//
+// We time the scalar multiplication for two classes of secret scalars: a fixed
+// one (zero), and uniformly random ones, interleaved randomly. Then Welch's
+// t-test is applied to the two distributions (also after cropping the slowest
+// measurements at a few percentiles). A |t| above 10 means that the timing
+// certainly depends on the scalar; below 4.5 means no leakage was detected.
+//
+// usage (from the root of the repo, after the C code was generated):
+//
+//   gcc -O2 -DARCH_X86_64 $(find lib/cbits -type d | sed 's/^/-I/') \
+//     test/dudect/dudect_scl.c $(find lib/cbits -name '*.c') -lpthread -lm -o dudect_scl
+//
+//   ./dudect_scl ct       [nbatches]     # the constant-time version
+//   ./dudect_scl windowed [nbatches]     # the default (variable time) version
+//
+// The constant-time version only calls the branch-free `_ct` field operations,
+// so it does not need -DCONSTANT_TIME (which makes all the field operations
+// branch-free, at some cost).
+// Add -DBLS12_381 to test BLS12-381 instead of BN254, and -DTEST_G2 to test G2.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef BLS12_381
+#include "bls12_381_G1_proj.h"
+#include "bls12_381_G2_proj.h"
+#define CURVE_NAME "BLS12-381"
+#define G1_(name) bls12_381_G1_proj_##name
+#define G2_(name) bls12_381_G2_proj_##name
+#define NLIMBS_P 6
+#else
+#include "bn128_G1_proj.h"
+#include "bn128_G2_proj.h"
+#define CURVE_NAME "BN254"
+#define G1_(name) bn128_G1_proj_##name
+#define G2_(name) bn128_G2_proj_##name
+#define NLIMBS_P 4
+#endif
+
+#ifdef TEST_G2
+#define GRP(name)  G2_(name)
+#define GEN        G2_(gen_G2)
+#define GRP_NAME   "G2"
+#define POINT_SIZE (6*NLIMBS_P)
+#else
+#define GRP(name)  G1_(name)
+#define GEN        G1_(gen_G1)
+#define GRP_NAME   "G1"
+#define POINT_SIZE (3*NLIMBS_P)
+#endif
+
+#define NLIMBS_R 4
+
+extern const uint64_t GEN[];
+
+#define BATCH_SIZE  1000
+#define NCROPS      10
+
+//------------------------------------------------------------------------------
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+static inline uint64_t cpucycles() { return __rdtsc(); }
+#else
+static inline uint64_t cpucycles() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+// xorshift; the scalars do not need to be cryptographically random here
+static uint64_t rnd_state = 0x9e3779b97f4a7c15;
+static uint64_t rnd64() {
+  rnd_state ^= rnd_state << 13;
+  rnd_state ^= rnd_state >>  7;
+  rnd_state ^= rnd_state << 17;
+  return rnd_state;
+}
+
+//------------------------------------------------------------------------------
+// online Welch t-test
+
+typedef struct { double n[2]; double mean[2]; double m2[2]; } ttest_ctx;
+
+static void ttest_push(ttest_ctx *ctx, double x, int cls) {
+  ctx->n[cls] += 1;
+  double delta = x - ctx->mean[cls];
+  ctx->mean[cls] += delta / ctx->n[cls];
+  ctx->m2[cls]   += delta * (x - ctx->mean[cls]);
+}
+
+static double ttest_compute(const ttest_ctx *ctx) {
+  if (ctx->n[0] < 2 || ctx->n[1] < 2) return 0;
+  double var0 = ctx->m2[0] / (ctx->n[0] - 1);
+  double var1 = ctx->m2[1] / (ctx->n[1] - 1);
+  double den  = sqrt( var0/ctx->n[0] + var1/ctx->n[1] );
+  return (den > 0) ? (ctx->mean[0] - ctx->mean[1]) / den : 0;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t*)a;
+  uint64_t y = *(const uint64_t*)b;
+  return (x < y) ? -1 : (x > y);
+}
+
+//------------------------------------------------------------------------------
+
+typedef void (*scl_fun)(const uint64_t *kst, const uint64_t *src, uint64_t *tgt);
+
+int main(int argc, char **argv) {
+
+  scl_fun fun   = GRP(scl_ct_Fr_std);
+  int nbatches = 100;
+  if (argc > 1) {
+    if      (!strcmp(argv[1],"ct"      )) { fun = GRP(scl_ct_Fr_std); }
+    else if (!strcmp(argv[1],"windowed")) { fun = GRP(scl_Fr_std   ); }
+    else { printf("usage: %s [ct|windowed] [nbatches]\n", argv[0]); return 1; }
+  }
+  if (argc > 2) { nbatches = atoi(argv[2]); }
+
+  printf("dudect test of `%s` scalar multiplication in %s %s\n",
+    (fun == GRP(scl_ct_Fr_std)) ? "constant-time" : "windowed", CURVE_NAME, GRP_NAME);
+
+  uint64_t *scalars = malloc( 8*NLIMBS_R*BATCH_SIZE );
+  uint64_t *cycles  = malloc( 8*BATCH_SIZE );
+  uint8_t  *classes = malloc( BATCH_SIZE );
+  uint64_t  tmp[POINT_SIZE];
+
+  ttest_ctx ctx[NCROPS+1];
+  memset(ctx, 0, sizeof(ctx));
+  uint64_t crops[NCROPS];
+
+  for(int b=0; b<nbatches; b++) {
+
+    for(int i=0; i<BATCH_SIZE; i++) {
+      uint64_t *k = scalars + i*NLIMBS_R;
+      classes[i] = rnd64() & 1;
+      for(int j=0; j<NLIMBS_R; j++) { k[j] = classes[i] ? rnd64() : 0; }
+      k[NLIMBS_R-1] &= 0x0fffffffffffffff;     // keep the scalar below the prime
+    }
+
+    for(int i=0; i<BATCH_SIZE; i++) {
+      uint64_t t0 = cpucycles();
+      fun( scalars + i*NLIMBS_R , GEN , tmp );
+      uint64_t t1 = cpucycles();
+      cycles[i] = t1 - t0;
+    }
+
+    // the cropping thresholds are set from the first batch
+    if (b == 0) {
+      uint64_t *sorted = malloc( 8*BATCH_SIZE );
+      memcpy(sorted, cycles, 8*BATCH_SIZE);
+      qsort(sorted, BATCH_SIZE, 8, cmp_u64);
+      for(int c=0; c<NCROPS; c++) {
+        double pct = 1 - pow(0.5, 10.0*(c+1)/NCROPS);
+        crops[c] = sorted[ (int)(pct*(BATCH_SIZE-1)) ];
+      }
+      free(sorted);
+      continue;
+    }
+
+    for(int i=0; i<BATCH_SIZE; i++) {
+      ttest_push( &ctx[0] , cycles[i] , classes[i] );
+      for(int c=0; c<NCROPS; c++) {
+        if (cycles[i] < crops[c]) { ttest_push( &ctx[c+1] , cycles[i] , classes[i] ); }
+      }
+    }
+
+    double max_t = 0;
+    for(int c=0; c<=NCROPS; c++) {
+      double t = fabs( ttest_compute(&ctx[c]) );
+      if (t > max_t) { max_t = t; }
+    }
+    printf("measurements: %7d | mean cycles (fixed / random): %10.0f / %10.0f | max |t| = %7.2f | %s\n",
+      (int)(ctx[0].n[0] + ctx[0].n[1]), ctx[0].mean[0], ctx[0].mean[1], max_t,
+      (max_t > 10) ? "definitely not constant time" :
+      (max_t > 4.5) ? "probably not constant time" : "no leakage detected yet" );
+    fflush(stdout);
+  }
+
+  free(scalars);
+  free(cycles);
+  free(classes);
+  return 0;
+}
@@ -0,0 +1,116 @@
+
+// counts the field multiplications and squarings in the curve group operations
+//
+// The field operations live in separate translation units, so we can intercept
+// them with the linker's `--wrap` option, without touching the library itself.
+// On G1 the multiplication by `3B` is done with additions, so it is not counted;
+// on G2 it is a proper multiplication (in the counts of proj dbl and add).
+//
+// usage (from the root of the repo, after the C code was generated):
+//
+//   INCS=$(find lib/cbits -type d | sed 's/^/-I/')
+//   WRAPS=$(for f in mul mul_inplace sqr sqr_inplace; do echo -Wl,--wrap=bn128_Fp_mont_$f; done)
+//   gcc -O2 -DARCH_X86_64 $INCS test/opcount/opcount_curve.c $(find lib/cbits -name '*.c') -lpthread -lm $WRAPS -o opcount_curve
+//
+//   ./opcount_curve
+//
+// Add -DBLS12_381 (and wrap the `bls12_381_Fp_mont_*` functions) to count
+// BLS12-381 instead of BN254; add -DTEST_G2 (and wrap `*_Fp2_mont_*`) for G2,
+// in which case the operations counted are in Fp2.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef BLS12_381
+#include "bls12_381_G1_proj.h"
+#include "bls12_381_G1_jac.h"
+#include "bls12_381_G2_proj.h"
+#include "bls12_381_G2_jac.h"
+#define CURVE_NAME "BLS12-381"
+#define G1_(name) bls12_381_G1_##name
+#define G2_(name) bls12_381_G2_##name
+#define FP_(name)  bls12_381_Fp_mont_##name
+#define FP2_(name) bls12_381_Fp2_mont_##name
+#define NLIMBS_P 6
+#else
+#include "bn128_G1_proj.h"
+#include "bn128_G1_jac.h"
+#include "bn128_G2_proj.h"
+#include "bn128_G2_jac.h"
+#define CURVE_NAME "BN254"
+#define G1_(name) bn128_G1_##name
+#define G2_(name) bn128_G2_##name
+#define FP_(name)  bn128_Fp_mont_##name
+#define FP2_(name) bn128_Fp2_mont_##name
+#define NLIMBS_P 4
+#endif
+
+#ifdef TEST_G2
+#define GRP(name)  G2_(name)
+#define GEN        G2_(proj_gen_G2)
+#define FLD(name)  FP2_(name)
+#define GRP_NAME   "G2"
+#define FLD_SIZE   (2*NLIMBS_P)
+#else
+#define GRP(name)  G1_(name)
+#define GEN        G1_(proj_gen_G1)
+#define FLD(name)  FP_(name)
+#define GRP_NAME   "G1"
+#define FLD_SIZE   NLIMBS_P
+#endif
+
+extern const uint64_t GEN[];
+
+//------------------------------------------------------------------------------
+
+static long nmul = 0;
+static long nsqr = 0;
+
+// (the extra indirection is needed to expand the `FLD(...)` argument first)
+#define WRAP(name)  WRAP_(name)
+#define REAL(name)  REAL_(name)
+#define WRAP_(name) __wrap_##name
+#define REAL_(name) __real_##name
+
+void REAL(FLD(mul))        ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt );
+void REAL(FLD(mul_inplace))( uint64_t *tgt, const uint64_t *src2 );
+void REAL(FLD(sqr))        ( const uint64_t *src1, uint64_t *tgt );
+void REAL(FLD(sqr_inplace))( uint64_t *tgt );
+
+void WRAP(FLD(mul))        ( const uint64_t *src1, const uint64_t *src2, uint64_t *tgt ) { nmul++; REAL(FLD(mul))( src1, src2, tgt ); }
+void WRAP(FLD(mul_inplace))( uint64_t *tgt, const uint64_t *src2 )                       { nmul++; REAL(FLD(mul_inplace))( tgt, src2 ); }
+void WRAP(FLD(sqr))        ( const uint64_t *src1, uint64_t *tgt )                       { nsqr++; REAL(FLD(sqr))( src1, tgt ); }
+void WRAP(FLD(sqr_inplace))( uint64_t *tgt )                                             { nsqr++; REAL(FLD(sqr_inplace))( tgt ); }
+
+static void reset()                  { nmul = 0; nsqr = 0; }
+static void report(const char *name) { printf("  %-10s : %2ldM + %2ldS\n", name, nmul, nsqr); }
+
+//------------------------------------------------------------------------------
+
+int main() {
+
+  // two generic points (with Z != 1)
+  uint64_t P[3*FLD_SIZE], Q[3*FLD_SIZE], R[3*FLD_SIZE];
+  GRP(proj_scl_small)( 1234567, GEN, P );
+  GRP(proj_scl_small)( 7654321, GEN, Q );
+
+  printf("field operations in %s %s:\n", CURVE_NAME, GRP_NAME);
+
+  reset(); GRP(proj_dbl)( P, R );    report("proj dbl");
+  reset(); GRP(proj_add)( P, Q, R ); report("proj add");
+
+  uint64_t PA[2*FLD_SIZE], QA[2*FLD_SIZE];
+  GRP(proj_to_affine)( P, PA );
+  GRP(proj_to_affine)( Q, QA );
+  GRP(jac_from_affine)( PA, P );
+  GRP(jac_from_affine)( QA, Q );
+  GRP(jac_dbl_inplace)( P );
+  GRP(jac_dbl_inplace)( Q );
+
+  reset(); GRP(jac_dbl)( P, R );     report("jac dbl");
+  reset(); GRP(jac_add)( P, Q, R );  report("jac add");
+
+  return 0;
+}
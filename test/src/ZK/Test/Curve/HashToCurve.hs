@@ -0,0 +1,190 @@
+-- | Tests for hashing to the curves (RFC 9380): known answer tests, and
+-- comparing the batched version against the single one
+
+{-# LANGUAGE ScopedTypeVariables, TypeApplications #-}
+module ZK.Test.Curve.HashToCurve where
+
+--------------------------------------------------------------------------------
+
+import Data.Char
+import Data.Word
+
+import Control.Monad
+
+import System.Random
+import System.IO
+
+import ZK.Algebra.Class.Flat
+import ZK.Algebra.Class.Curve
+
+import ZK.Algebra.Hash.SHA256
+
+import qualified ZK.Algebra.Curves.BN128.G1.Proj         as BN128.G1
+import qualified ZK.Algebra.Curves.BN128.G2.Proj         as BN128.G2
+
+import qualified ZK.Algebra.Curves.BLS12_381.Fp2.Mont    as BLS12_381.Fp2
+import qualified ZK.Algebra.Curves.BLS12_381.G1.Proj     as BLS12_381.G1
+import qualified ZK.Algebra.Curves.BLS12_381.G2.Proj     as BLS12_381.G2
+
+--------------------------------------------------------------------------------
+
+runHashToCurveTests :: Int -> IO ()
+runHashToCurveTests n = do
+  let n' = min n 100
+  _ <- checkKAT "expand_message_xmd"    kat_expand_message_xmd
+  _ <- checkKAT "BLS12-381 G1 (RO)"     kat_BLS12_381_G1_RO
+  _ <- checkKAT "BLS12-381 G1 (NU)"     kat_BLS12_381_G1_NU
+  _ <- checkKAT "BLS12-381 G2 (RO)"     kat_BLS12_381_G2_RO
+  _ <- checkKAT "BN254 G1 (RO, NU)"     kat_BN254_G1
+  _ <- doTests n' "many vs. one (BLS G1)" (prop_hash_many BLS12_381.G1.hashToCurveMany BLS12_381.G1.hashToCurve)
+  _ <- doTests n' "many vs. one (BLS G2)" (prop_hash_many BLS12_381.G2.hashToCurveMany BLS12_381.G2.hashToCurve)
+  _ <- doTests n' "many vs. one (BN G1)"  (prop_hash_many BN128.G1.hashToCurveMany     BN128.G1.hashToCurve    )
+  _ <- doTests n' "many vs. one (BN G2)"  (prop_hash_many BN128.G2.hashToCurveMany     BN128.G2.hashToCurve    )
+  return ()
+
+--------------------------------------------------------------------------------
+
+doTests :: Int -> String -> IO Bool -> IO Bool
+doTests n name testAction =
+  do
+    let str = " - " ++ name ++ "... "
+    putStr $ str ++ replicate (30 - length str) ' '
+    hFlush stdout
+    oks <- forM [1..n] $ \i -> testAction
+    let ok = and oks
+    case ok of
+      True  -> putStrLn $ "ok (passed " ++ show n ++ " tests)"
+      False -> putStrLn $ "FAILED!! (FAILED " ++ show (countFalses oks) ++ " tests!)"
+    return ok
+  where
+    countFalses :: [Bool] -> Int
+    countFalses = length . filter (==False)
+
+checkKAT :: String -> [Bool] -> IO Bool
+checkKAT name oks = do
+  let str = " - " ++ name ++ "... "
+  putStr $ str ++ replicate (30 - length str) ' '
+  let n  = length oks
+  let ok = and oks
+  case ok of
+    True  -> putStrLn $ "ok (passed " ++ show n ++ " known answer tests)"
+    False -> putStrLn $ "FAILED!! (FAILED " ++ show (length (filter not oks)) ++ " known answer tests!)"
+  return ok
+
+--------------------------------------------------------------------------------
+-- * helpers
+
+ascii :: String -> [Word8]
+ascii = map (fromIntegral . ord)
+
+hexBytes :: String -> [Word8]
+hexBytes (a:b:rest) = fromIntegral (16 * digitToInt a + digitToInt b) : hexBytes rest
+hexBytes _          = []
+
+-- | The test messages of RFC 9380, Appendix J
+msgEmpty, msgAbc :: [Word8]
+msgEmpty = []
+msgAbc   = ascii "abc"
+
+--------------------------------------------------------------------------------
+-- * known answer tests (RFC 9380, Appendix K.1 and J.9, J.10)
+
+kat_expand_message_xmd :: [Bool]
+kat_expand_message_xmd =
+  [ expandMessageXMD dst msgEmpty 0x20 == Just (hexBytes "68a985b87eb6b46952128911f2a4412bbc302a9d759667f87f7a21d803f07235")
+  , expandMessageXMD dst msgAbc   0x20 == Just (hexBytes "d8ccab23b5985ccea865c6c97b6e5b8350e794e603b4b97902f53a8a0d605615")
+  , expandMessageXMD dst msgEmpty 0x80 == Just (hexBytes $ concat
+      [ "af84c27ccfd45d41914fdff5df25293e221afc53d8ad2ac06d5e3e29485dadbe"
+      , "e0d121587713a3e0dd4d5e69e93eb7cd4f5df4cd103e188cf60cb02edc3edf18"
+      , "eda8576c412b18ffb658e3dd6ec849469b979d444cf7b26911a08e63cf31f9dc"
+      , "c541708d3491184472c2c29bb749d4286b004ceb5ee6b9a7fa5b646c993f0ced" ] )
+  ]
+  where
+    dst = ascii "QUUX-V01-CS02-with-expander-SHA256-128"
+
+kat_BLS12_381_G1_RO :: [Bool]
+kat_BLS12_381_G1_RO =
+  [ BLS12_381.G1.hashToCurve dst msgEmpty == BLS12_381.G1.mkPoint
+      ( 0x052926add2207b76ca4fa57a8734416c8dc95e24501772c814278700eed6d1e4e8cf62d9c09db0fac349612b759e79a1
+      , 0x08ba738453bfed09cb546dbb0783dbb3a5f1f566ed67bb6be0e8c67e2e81a4cc68ee29813bb7994998f3eae0c9c6a265
+      , 1 )
+  , BLS12_381.G1.hashToCurve dst msgAbc == BLS12_381.G1.mkPoint
+      ( 0x03567bc5ef9c690c2ab2ecdf6a96ef1c139cc0b2f284dca0a9a7943388a49a3aee664ba5379a7655d3c68900be2f6903
+      , 0x0b9c15f3fe6e5cf4211f346271d7b01c8f3b28be689c8429c85b67af215533311f0b8dfaaa154fa6b88176c229f2885d
+      , 1 )
+  ]
+  where
+    dst = ascii "QUUX-V01-CS02-with-BLS12381G1_XMD:SHA-256_SSWU_RO_"
+
+kat_BLS12_381_G1_NU :: [Bool]
+kat_BLS12_381_G1_NU =
+  [ BLS12_381.G1.encodeToCurve dst msgEmpty == BLS12_381.G1.mkPoint
+      ( 0x184bb665c37ff561a89ec2122dd343f20e0f4cbcaec84e3c3052ea81d1834e192c426074b02ed3dca4e7676ce4ce48ba
+      , 0x04407b8d35af4dacc809927071fc0405218f1401a6d15af775810e4e460064bcc9468beeba82fdc751be70476c888bf3
+      , 1 )
+  , BLS12_381.G1.encodeToCurve dst msgAbc == BLS12_381.G1.mkPoint
+      ( 0x009769f3ab59bfd551d53a5f846b9984c59b97d6842b20a2c565baa167945e3d026a3755b6345df8ec7e6acb6868ae6d
+      , 0x1532c00cf61aa3d0ce3e5aa20c3b531a2abd2c770a790a2613818303c6b830ffc0ecf6c357af3317b9575c567f11cd2c
+      , 1 )
+  ]
+  where
+    dst = ascii "QUUX-V01-CS02-with-BLS12381G1_XMD:SHA-256_SSWU_NU_"
+
+kat_BLS12_381_G2_RO :: [Bool]
+kat_BLS12_381_G2_RO =
+  [ BLS12_381.G2.hashToCurve dst msgEmpty == BLS12_381.G2.mkPoint
+      ( BLS12_381.Fp2.pack
+          ( 0x0141ebfbdca40eb85b87142e130ab689c673cf60f1a3e98d69335266f30d9b8d4ac44c1038e9dcdd5393faf5c41fb78a
+          , 0x05cb8437535e20ecffaef7752baddf98034139c38452458baeefab379ba13dff5bf5dd71b72418717047f5b0f37da03d )
+      , BLS12_381.Fp2.pack
+          ( 0x0503921d7f6a12805e72940b963c0cf3471c7b2a524950ca195d11062ee75ec076daf2d4bc358c4b190c0c98064fdd92
+          , 0x12424ac32561493f3fe3c260708a12b7c620e7be00099a974e259ddc7d1f6395c3c811cdd19f1e8dbf3e9ecfdcbab8d6 )
+      , 1 )
+  , BLS12_381.G2.hashToCurve dst msgAbc == BLS12_381.G2.mkPoint
+      ( BLS12_381.Fp2.pack
+          ( 0x02c2d18e033b960562aae3cab37a27ce00d80ccd5ba4b7fe0e7a210245129dbec7780ccc7954725f4168aff2787776e6
+          , 0x139cddbccdc5e91b9623efd38c49f81a6f83f175e80b06fc374de9eb4b41dfe4ca3a230ed250fbe3a2acf73a41177fd8 )
+      , BLS12_381.Fp2.pack
+          ( 0x1787327b68159716a37440985269cf584bcb1e621d3a7202be6ea05c4cfe244aeb197642555a0645fb87bf7466b2ba48
+          , 0x00aa65dae3c8d732d10ecd2c50f8a1baf3001578f71c694e03866e9f3d49ac1e1ce70dd94a733534f106d4cec0eddd16 )
+      , 1 )
+  ]
+  where
+    dst = ascii "QUUX-V01-CS02-with-BLS12381G2_XMD:SHA-256_SSWU_RO_"
+
+-- | BN254 is not covered by RFC 9380; these are the test vectors of the suites
+-- @BN254G1_XMD:SHA-256_SVDW_RO_@ and @_NU_@ as used by gnark-crypto
+kat_BN254_G1 :: [Bool]
+kat_BN254_G1 =
+  [ BN128.G1.hashToCurve dstRO msgEmpty == BN128.G1.mkPoint
+      ( 0x0a976ab906170db1f9638d376514dbf8c42aef256a54bbd48521f20749e59e86
+      , 0x02925ead66b9e68bfc309b014398640ab55f6619ab59bc1fab2210ad4c4d53d5
+      , 1 )
+  , BN128.G1.encodeToCurve dstNU msgEmpty == BN128.G1.mkPoint
+      ( 0x1bb8810e2ceaf04786d4efd216fc2820ddd9363712efc736ada11049d8af5925
+      , 0x1efbf8d54c60d865cce08437668ea30f5bf90d287dbd9b5af31da852915e8f11
+      , 1 )
+  ]
+  where
+    dstRO = ascii "QUUX-V01-CS02-with-BN254G1_XMD:SHA-256_SVDW_RO_"
+    dstNU = ascii "QUUX-V01-CS02-with-BN254G1_XMD:SHA-256_SVDW_NU_"
+
+--------------------------------------------------------------------------------
+-- * properties
+
+-- | @hashToCurveMany dst == map (hashToCurve dst)@, on a random number of
+-- random messages (of random lengths)
+prop_hash_many
+  :: forall g. ProjCurve g
+  => ([Word8] -> [[Word8]] -> FlatArray (AffinePoint g))
+  -> ([Word8] -> [Word8] -> g)
+  -> IO Bool
+prop_hash_many hashMany hashOne = do
+  k    <- randomRIO (0,10)
+  msgs <- replicateM k $ do
+    len <- randomRIO (0,100)
+    replicateM len randomIO
+  let dst = ascii "ZIKKURAT-TEST-HASH-TO-CURVE"
+  return (unpackFlatArrayToList (hashMany dst msgs) == map (toAffine . hashOne dst) msgs)
+
+--------------------------------------------------------------------------------
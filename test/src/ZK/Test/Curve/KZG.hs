@@ -0,0 +1,124 @@
+-- | Property tests for KZG commitments and their batch verification
+
+{-# LANGUAGE ScopedTypeVariables, DataKinds, TypeFamilies, TypeApplications #-}
+module ZK.Test.Curve.KZG where
+
+--------------------------------------------------------------------------------
+
+import Data.Proxy
+
+import Control.Monad
+
+import System.Random
+import System.IO
+
+import ZK.Algebra.API
+import ZK.Algebra.Class.Pairing
+import ZK.Algebra.KZG
+
+import ZK.Algebra.Curves.BN128.Pairing     ()
+import ZK.Algebra.Curves.BLS12_381.Pairing ()
+
+--------------------------------------------------------------------------------
+
+runTestsKZG_BN128 :: Int -> IO ()
+runTestsKZG_BN128 n = do
+  let n' = min n 10
+  runKZGTests n' (Proxy @'BN128)
+
+runTestsKZG_BLS12_381 :: Int -> IO ()
+runTestsKZG_BLS12_381 n = do
+  let n' = min n 10
+  runKZGTests n' (Proxy @'BLS12_381)
+
+--------------------------------------------------------------------------------
+
+runKZGTests :: forall c. PairingCurve c => Int -> Proxy c -> IO ()
+runKZGTests n pxy = do
+  _ <- doTests n "single openings"        (prop_single_openings pxy)
+  _ <- doTests n "valid batch passes"     (prop_batch_valid     pxy)
+  _ <- doTests n "invalid batch fails"    (prop_batch_invalid   pxy)
+  _ <- doTests n "bisection finds errors" (prop_batch_bisect    pxy)
+  return ()
+
+--------------------------------------------------------------------------------
+
+doTests :: Int -> String -> IO Bool -> IO Bool
+doTests n name testAction =
+  do
+    let str = " - " ++ name ++ "... "
+    putStr $ str ++ replicate (30 - length str) ' '
+    hFlush stdout
+    oks <- forM [1..n] $ \i -> testAction
+    let ok = and oks
+    case ok of
+      True  -> putStrLn $ "ok (passed " ++ show n ++ " tests)"
+      False -> putStrLn $ "FAILED!! (FAILED " ++ show (countFalses oks) ++ " tests!)"
+    return ok
+  where
+    countFalses :: [Bool] -> Int
+    countFalses = length . filter (==False)
+
+--------------------------------------------------------------------------------
+-- * random instances
+
+-- | A random setup of size 8 and a random polynomial, with @k@ opening
+-- proofs at random locations
+rndOpenings :: forall c. PairingCurve c => Proxy c -> Int -> IO (VerifierKey c, [(Commitment c, Opening c)])
+rndOpenings pxy k = do
+  setup <- newKZGSetup pxy (Log2 3)
+  let dom = _kzgDomain setup
+  let n   = fftDomainSize dom
+  ys   <- replicateM n rndIO
+  locs <- replicateM k rndIO
+  let values = packFlatArrayFromList' n ys
+  let poly   = intt dom values :: Poly c
+  let com    = commitValues pxy setup values
+  return ( extractVerifierKey setup , [ (com, openingProof pxy setup poly x) | x <- locs ] )
+
+-- | Makes an opening invalid, either by changing the claimed value or the proof
+corrupt :: forall c. PairingCurve c => Bool -> (Commitment c, Opening c) -> (Commitment c, Opening c)
+corrupt False (com, o) = (com, o { _value = _value o + 1 })
+corrupt True  (com, o) = (com, o { _proof = _proof o <+> curveSubgroupGen })
+
+--------------------------------------------------------------------------------
+-- * properties
+
+prop_single_openings :: forall c. PairingCurve c => Proxy c -> IO Bool
+prop_single_openings pxy = do
+  (vkey, items) <- rndOpenings pxy 3
+  which <- randomIO
+  let ok1 = and [ verifyProof pxy vkey com o | (com, o) <- items ]
+  let ok2 = not $ or [ verifyProof pxy vkey com o | (com, o) <- map (corrupt which) items ]
+  return (ok1 && ok2)
+
+prop_batch_valid :: forall c. PairingCurve c => Proxy c -> IO Bool
+prop_batch_valid pxy = do
+  k <- randomRIO (1,12)
+  (vkey, items) <- rndOpenings pxy k
+  ok   <- batchVerifyProofs       pxy vkey items
+  idxs <- batchVerifyProofsBisect pxy vkey items
+  return (ok && null idxs)
+
+prop_batch_invalid :: forall c. PairingCurve c => Proxy c -> IO Bool
+prop_batch_invalid pxy = do
+  k <- randomRIO (1,12)
+  (vkey, items) <- rndOpenings pxy k
+  j     <- randomRIO (0,k-1)
+  which <- randomIO
+  let items' = [ if i == j then corrupt which item else item | (i,item) <- zip [0..] items ]
+  ok <- batchVerifyProofs pxy vkey items'
+  return (not ok)
+
+-- | The bisection must return exactly the indices of the corrupted openings
+prop_batch_bisect :: forall c. PairingCurve c => Proxy c -> IO Bool
+prop_batch_bisect pxy = do
+  k <- randomRIO (1,16)
+  (vkey, items) <- rndOpenings pxy k
+  bads  <- filterM (\_ -> (==0) <$> randomRIO (0,3::Int)) [0..k-1]
+  which <- randomIO
+  let items' = [ if elem i bads then corrupt which item else item | (i,item) <- zip [0..] items ]
+  idxs <- batchVerifyProofsBisect pxy vkey items'
+  return (idxs == bads)
+
+--------------------------------------------------------------------------------
@@ -27,6 +27,9 @@ import qualified ZK.Algebra.Curves.BLS12_381.G2.Affine   as BLS12_381
 import qualified ZK.Algebra.Curves.BN128.Pairing         as Fast.BN128
 import qualified ZK.Algebra.Curves.BLS12_381.Pairing     as Fast.BLS12_381
 
+import qualified ZK.Algebra.Curves.BN128.GT              as GT.BN128
+import qualified ZK.Algebra.Curves.BLS12_381.GT          as GT.BLS12_381
+
 import qualified ZK.Algebra.Reference.Pairing.BN128      as Ref.BN128
 import qualified ZK.Algebra.Reference.Pairing.BLS12_381  as Ref.BLS12_381
 
@@ -118,6 +121,14 @@ pairingProps_BN128 =
   , PairingProp12   prop_ref_right_inf_bn128         "<a,inf> = 1"
   , PairingPropII   prop_ref_nondegenerate_bn128     "non-degenerate"
   , PairingProp12   prop_ref_against_fast_bn128      "ref against fast"
+  , PairingProp112  prop_multi_vs_single_bn128       "multi-pairing"
+  , PairingProp112  prop_multi_affine_bn128          "multi-pairing affine"
+  , PairingProp112  prop_parallel_bn128              "parallel pairing"
+  , PairingProp12   prop_prepared_bn128              "prepared G2"
+  , PairingProp112  prop_multi_prepared_bn128        "multi-pairing prepared"
+  , PairingProp12   prop_gt_member_bn128             "GT membership"
+  , PairingPropI12  prop_gt_pow_bn128                "GT exponentiation"
+  , PairingProp12   prop_gt_compress_bn128           "GT compression"
   ]
 
 pairingProps_BLS12_381 :: [PairingProp BLS12_381.G1 BLS12_381.G2]
@@ -131,6 +142,14 @@ pairingProps_BLS12_381 =
   , PairingProp12   prop_ref_right_inf_bls12_381     "<a,inf> = 1"
   , PairingPropII   prop_ref_nondegenerate_bls12_381 "non-degenerate"
   , PairingProp12   prop_ref_against_fast_bls12_381  "ref against fast"
+  , PairingProp112  prop_multi_vs_single_bls12_381   "multi-pairing"
+  , PairingProp112  prop_multi_affine_bls12_381      "multi-pairing affine"
+  , PairingProp112  prop_parallel_bls12_381          "parallel pairing"
+  , PairingProp12   prop_prepared_bls12_381          "prepared G2"
+  , PairingProp112  prop_multi_prepared_bls12_381    "multi-pairing prepared"
+  , PairingProp12   prop_gt_member_bls12_381         "GT membership"
+  , PairingPropI12  prop_gt_pow_bls12_381            "GT exponentiation"
+  , PairingProp12   prop_gt_compress_bls12_381       "GT compression"
   ]
 
 ----------------------------------------
@@ -162,6 +181,42 @@ prop_ref_nondegenerate_bn128 k l = (k==0) || (l==0) || Ref.BN128.pairing (grpSca
 prop_ref_against_fast_bn128 :: BN128.G1 -> BN128.G2 -> Bool
 prop_ref_against_fast_bn128 a b = Ref.BN128.pairing a b == Fast.BN128.pairing a b
 
+prop_multi_vs_single_bn128 :: BN128.G1 -> BN128.G1 -> BN128.G2 -> Bool
+prop_multi_vs_single_bn128 a b c = Fast.BN128.pairingMulti [(a,c),(b,d),(grpUnit,c)] == (Fast.BN128.pairing a c) * (Fast.BN128.pairing b d) where
+  d = grpScale 3 c
+
+prop_multi_affine_bn128 :: BN128.G1 -> BN128.G1 -> BN128.G2 -> Bool
+prop_multi_affine_bn128 a b c = Fast.BN128.pairingMultiAffine pairs == Fast.BN128.pairingMulti pairs where
+  pairs = [(a,c),(b,grpScale 3 c),(grpUnit,c),(a,c)]
+
+prop_parallel_bn128 :: BN128.G1 -> BN128.G1 -> BN128.G2 -> Bool
+prop_parallel_bn128 a b c = Fast.BN128.pairingParallel a c == Fast.BN128.pairing a c
+                      && Fast.BN128.pairingMultiParallel pairs == Fast.BN128.pairingMulti pairs where
+  pairs = [(a,c),(b,grpScale 3 c),(grpUnit,c),(a,c),(b,grpUnit)]
+
+prop_prepared_bn128 :: BN128.G1 -> BN128.G2 -> Bool
+prop_prepared_bn128 a b = Fast.BN128.pairingPrepared a (Fast.BN128.prepareG2 b) == Fast.BN128.pairing a b
+
+prop_multi_prepared_bn128 :: BN128.G1 -> BN128.G1 -> BN128.G2 -> Bool
+prop_multi_prepared_bn128 a b c = Fast.BN128.pairingMultiPrepared pairs == Fast.BN128.pairingMulti [(a,c),(b,d),(a,grpUnit)] where
+  d     = grpScale 3 c
+  pairs = [ (a, Fast.BN128.prepareG2 c) , (b, Fast.BN128.prepareG2 d) , (a, Fast.BN128.prepareG2 grpUnit) ]
+
+prop_gt_member_bn128 :: BN128.G1 -> BN128.G2 -> Bool
+prop_gt_member_bn128 a b = GT.BN128.isInSubgroup e && GT.BN128.isCyclotomic e && not (GT.BN128.isInSubgroup (e + 1)) where
+  e = Fast.BN128.pairing a b
+
+prop_gt_pow_bn128 :: Integer -> BN128.G1 -> BN128.G2 -> Bool
+prop_gt_pow_bn128 k a b = GT.BN128.powFr e (fromInteger k) == power e k && GT.BN128.pow e k == power e k
+                     && GT.BN128.powFr e (fromInteger big) == power e big where
+  e   = Fast.BN128.pairing a b
+  big = k * 2^200 + 12345
+
+prop_gt_compress_bn128 :: BN128.G1 -> BN128.G2 -> Bool
+prop_gt_compress_bn128 a b = GT.BN128.decompress (GT.BN128.compress e) == e 
+                        && GT.BN128.batchDecompress (map GT.BN128.compress [e,1,e*e]) == [e,1,e*e] where
+  e = Fast.BN128.pairing a b
+
 ----------------------------------------
 
 prop_ref_left_linear_bls12_381 :: BLS12_381.G1 -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
@@ -191,5 +246,41 @@ prop_ref_nondegenerate_bls12_381 k l = (k==0) || (l==0) || Ref.BLS12_381.pairing
 prop_ref_against_fast_bls12_381 :: BLS12_381.G1 -> BLS12_381.G2 -> Bool
 prop_ref_against_fast_bls12_381 a b = Ref.BLS12_381.pairing a b == Fast.BLS12_381.pairing a b
 
+prop_multi_vs_single_bls12_381 :: BLS12_381.G1 -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_multi_vs_single_bls12_381 a b c = Fast.BLS12_381.pairingMulti [(a,c),(b,d),(grpUnit,c)] == (Fast.BLS12_381.pairing a c) * (Fast.BLS12_381.pairing b d) where
+  d = grpScale 3 c
+
+prop_multi_affine_bls12_381 :: BLS12_381.G1 -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_multi_affine_bls12_381 a b c = Fast.BLS12_381.pairingMultiAffine pairs == Fast.BLS12_381.pairingMulti pairs where
+  pairs = [(a,c),(b,grpScale 3 c),(grpUnit,c),(a,c)]
+
+prop_parallel_bls12_381 :: BLS12_381.G1 -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_parallel_bls12_381 a b c = Fast.BLS12_381.pairingParallel a c == Fast.BLS12_381.pairing a c
+                      && Fast.BLS12_381.pairingMultiParallel pairs == Fast.BLS12_381.pairingMulti pairs where
+  pairs = [(a,c),(b,grpScale 3 c),(grpUnit,c),(a,c),(b,grpUnit)]
+
+prop_prepared_bls12_381 :: BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_prepared_bls12_381 a b = Fast.BLS12_381.pairingPrepared a (Fast.BLS12_381.prepareG2 b) == Fast.BLS12_381.pairing a b
+
+prop_multi_prepared_bls12_381 :: BLS12_381.G1 -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_multi_prepared_bls12_381 a b c = Fast.BLS12_381.pairingMultiPrepared pairs == Fast.BLS12_381.pairingMulti [(a,c),(b,d),(a,grpUnit)] where
+  d     = grpScale 3 c
+  pairs = [ (a, Fast.BLS12_381.prepareG2 c) , (b, Fast.BLS12_381.prepareG2 d) , (a, Fast.BLS12_381.prepareG2 grpUnit) ]
+
+prop_gt_member_bls12_381 :: BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_gt_member_bls12_381 a b = GT.BLS12_381.isInSubgroup e && GT.BLS12_381.isCyclotomic e && not (GT.BLS12_381.isInSubgroup (e + 1)) where
+  e = Fast.BLS12_381.pairing a b
+
+prop_gt_pow_bls12_381 :: Integer -> BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_gt_pow_bls12_381 k a b = GT.BLS12_381.powFr e (fromInteger k) == power e k && GT.BLS12_381.pow e k == power e k
+                     && GT.BLS12_381.powFr e (fromInteger big) == power e big where
+  e   = Fast.BLS12_381.pairing a b
+  big = k * 2^200 + 12345
+
+prop_gt_compress_bls12_381 :: BLS12_381.G1 -> BLS12_381.G2 -> Bool
+prop_gt_compress_bls12_381 a b = GT.BLS12_381.decompress (GT.BLS12_381.compress e) == e 
+                        && GT.BLS12_381.batchDecompress (map GT.BLS12_381.compress [e,1,e*e]) == [e,1,e*e] where
+  e = Fast.BLS12_381.pairing a b
+
 --------------------------------------------------------------------------------
 
@@ -96,6 +96,8 @@ runCurveOnlyTests n pxy = do
       x <- rndIO @a
       return (test k x) 
 
+    CurvePropIO test name -> doTests n name (test pxy)
+
 runProjCurveOnlyTests :: forall a. ProjCurve a => Int -> Proxy a -> IO ()
 runProjCurveOnlyTests n pxy = do
 
@@ -164,6 +166,7 @@ data CurveProp
   | CurveProp2  (forall a. Curve a  => a -> a -> Bool     ) String
   | CurveProp3  (forall a. Curve a  => a -> a -> a -> Bool) String
   | CurvePropI1 (forall a. Curve a  => Int -> a -> Bool   ) String
+  | CurvePropIO (forall a. Curve a  => Proxy a -> IO Bool ) String
 
 data ProjCurveProp
   = ProjCurveProp1  (forall a. ProjCurve a  => a -> Bool            ) String
@@ -207,6 +210,7 @@ groupProps =
   , GroupProp1 prop_is_zero                     "is zero"
   , GroupProp1 prop_is_equal                    "is equal"
   , GroupProp1 prop_dbl                         "dbl def"
+  , GroupProp1 prop_dbl_unit                    "dbl unit"
   , GroupProp2 prop_dbl_distributive_1          "dbl distributive /1"
   , GroupProp2 prop_dbl_distributive_2          "dbl distributive /2"
   , GroupProp1 prop_neg_neg                     "neg . neg == id"
@@ -287,6 +291,9 @@ prop_neg_add x y = grpNeg (grpAdd x y) == (grpNeg x) `grpAdd` (grpNeg y)
 prop_dbl :: Group a => a -> Bool
 prop_dbl x = grpAdd x x == grpDbl x
 
+prop_dbl_unit :: forall a. Group a => a -> Bool
+prop_dbl_unit _ = grpIsUnit u && u == grpUnit where u = grpDbl (grpUnit :: a)
+
 prop_dbl_distributive_1 :: Group a => a -> a -> Bool
 prop_dbl_distributive_1 x y = (grpDbl (x `grpAdd` y)) == ((grpDbl x) `grpAdd` (grpDbl y))
 
@@ -387,6 +394,7 @@ curveOnlyProps =
   , CurveProp2  prop_is_on_curve_sub           "sub on curve"
   , CurvePropI1 prop_is_on_curve_scale         "scale on curve"
   , CurveProp1  prop_normalize_on_curve        "normalize on curve"
+  , CurvePropIO prop_msm_with_units            "msm with unit inputs"
   ]
 
 prop_is_on_curve :: Curve a => a -> Bool
@@ -410,6 +418,19 @@ prop_is_on_curve_sub x y = isOnCurve (grpSub x y)
 prop_is_on_curve_scale :: Curve a => Int -> a -> Bool
 prop_is_on_curve_scale k x = isOnCurve (grpScale_ k x)
 
+-- | MSM where some of the points (and some of the scalars) are zero, compared
+-- to the naive sum; also an MSM of only units
+prop_msm_with_units :: forall a. Curve a => Proxy a -> IO Bool
+prop_msm_with_units _ = do
+  n  <- randomRIO (1,100)
+  ks <- replicateM n $ randomRIO (0,3::Int) >>= \b -> if b == 0 then return zero    else rndIO
+  ps <- replicateM n $ randomRIO (0,2::Int) >>= \b -> if b == 0 then return grpUnit else rndIO @a
+  let ref   = grpSum (zipWith scalarMul ks ps)
+  let us    = replicate n (grpUnit :: a)
+  let ok1   = msm (packFlatArrayFromList' n ks) (packFlatArrayFromList' n ps) == ref
+  let ok2   = msm (packFlatArrayFromList' n ks) (packFlatArrayFromList' n us) == grpUnit
+  return (ok1 && ok2)
+
 --------------------------------------------------------------------------------
 -- * projective properties
 
@@ -419,6 +440,7 @@ projCurveOnlyProps =
   , ProjCurvePropA   prop_from_to_affine            "toAffine . fromAffine"  
   , ProjCurveProp3   prop_batch_to_from_affine      "batch from/to affine"
   , ProjCurveProp3A  prop_batch_from_to_affine      "batch to/from affine"
+  , ProjCurveProp3   prop_batch_to_affine_vs_single "batch vs. single to affine"
   , ProjCurveProp1   prop_is_on_curve_toAffine      "oncurve(toAffine(x))"  
   , ProjCurveProp1   prop_normalize_then_toAffine   "toAffine(normalize(x))"  
   , ProjCurvePropA   prop_is_on_curve_fromAffine    "oncurve(fromAffine(x))"  
@@ -455,6 +477,14 @@ prop_batch_from_to_affine _ x y z = lhs == rhs where
   out = batchToAffine @a (batchFromAffine @a inp)     :: FlatArray (AffinePoint a)
   rhs = unpackFlatArrayToList out                     :: [AffinePoint a]
 
+-- with points at infinity in between, which are skipped by the batch inversion
+prop_batch_to_affine_vs_single :: forall a. ProjCurve a => a -> a -> a -> Bool
+prop_batch_to_affine_vs_single x y z = lhs == rhs where
+  inps = [grpUnit, x, grpDbl y, grpSub x x, z, grpAdd y z, grpUnit] :: [a]
+  lhs  = map toAffine inps                                           :: [AffinePoint a]
+  out  = batchToAffine @a (packFlatArrayFromList inps)               :: FlatArray (AffinePoint a)
+  rhs  = unpackFlatArrayToList out                                   :: [AffinePoint a]
+
 prop_is_on_curve_toAffine :: ProjCurve a => a -> Bool
 prop_is_on_curve_toAffine x = isOnCurve (toAffine x)
 
@@ -0,0 +1,285 @@
+-- | Property tests for the curve-specific functionality (which is not
+-- exposed through the type classes, like GLV or fixed-base scaling)
+
+{-# LANGUAGE ScopedTypeVariables, TypeApplications, TypeFamilies, FlexibleContexts #-}
+module ZK.Test.Curve.Specific where
+
+--------------------------------------------------------------------------------
+
+import Data.Proxy
+
+import Control.Monad
+
+import System.Random
+import System.IO
+
+import ZK.Algebra.Class.Field
+import ZK.Algebra.Class.Curve
+import ZK.Algebra.Class.Flat
+import ZK.Algebra.Class.FFT
+import ZK.Algebra.Class.Misc
+
+import qualified ZK.Algebra.Curves.BN128.Fr.Mont         as BN128.Fr
+import qualified ZK.Algebra.Curves.BN128.Fp2.Mont        as BN128.Fp2
+import qualified ZK.Algebra.Curves.BN128.G1.Proj         as BN128.G1
+import qualified ZK.Algebra.Curves.BN128.G2.Proj         as BN128.G2
+import qualified ZK.Algebra.Curves.BN128.G1.Jac          as BN128.G1.Jac
+import qualified ZK.Algebra.Curves.BN128.G2.Jac          as BN128.G2.Jac
+
+import qualified ZK.Algebra.Curves.BLS12_381.Fr.Mont     as BLS12_381.Fr
+import qualified ZK.Algebra.Curves.BLS12_381.Fp.Mont     as BLS12_381.Fp
+import qualified ZK.Algebra.Curves.BLS12_381.Fp2.Mont    as BLS12_381.Fp2
+import qualified ZK.Algebra.Curves.BLS12_381.G1.Proj     as BLS12_381.G1
+import qualified ZK.Algebra.Curves.BLS12_381.G2.Proj     as BLS12_381.G2
+import qualified ZK.Algebra.Curves.BLS12_381.G1.Jac      as BLS12_381.G1.Jac
+import qualified ZK.Algebra.Curves.BLS12_381.G2.Jac      as BLS12_381.G2.Jac
+
+--------------------------------------------------------------------------------
+
+runTestsSpecificG1_BN128 :: Int -> IO ()
+runTestsSpecificG1_BN128 n = do
+  let n' = min n 25
+  runSpecificTests n' (Proxy @BN128.Fr.Fr) (Proxy @BN128.G1.G1) specificPropsG1_BN128
+
+runTestsSpecificG2_BN128 :: Int -> IO ()
+runTestsSpecificG2_BN128 n = do
+  let n' = min n 25
+  runSpecificTests n' (Proxy @BN128.Fr.Fr) (Proxy @BN128.G2.G2) specificPropsG2_BN128
+
+runTestsSpecificG1_BLS12_381 :: Int -> IO ()
+runTestsSpecificG1_BLS12_381 n = do
+  let n' = min n 25
+  runSpecificTests n' (Proxy @BLS12_381.Fr.Fr) (Proxy @BLS12_381.G1.G1) specificPropsG1_BLS12_381
+
+runTestsSpecificG2_BLS12_381 :: Int -> IO ()
+runTestsSpecificG2_BLS12_381 n = do
+  let n' = min n 25
+  runSpecificTests n' (Proxy @BLS12_381.Fr.Fr) (Proxy @BLS12_381.G2.G2) specificPropsG2_BLS12_381
+
+--------------------------------------------------------------------------------
+
+runSpecificTests :: forall f g. (Rnd f, Rnd g) => Int -> Proxy f -> Proxy g -> [SpecificProp f g] -> IO ()
+runSpecificTests n pxy1 pxy2 properties = do
+
+  forM_ properties $ \prop -> case prop of
+
+    SpecificProp1 test name -> doTests n name $ do
+      x <- rndIO @g
+      return (test x)
+
+    SpecificPropF1 test name -> doTests n name $ do
+      k <- rndIO @f
+      x <- rndIO @g
+      return (test k x)
+
+    SpecificPropIO test name -> doTests n name test
+
+--------------------------------------------------------------------------------
+
+doTests :: Int -> String -> IO Bool -> IO Bool
+doTests n name testAction =
+  do
+    let str = " - " ++ name ++ "... "
+    putStr $ str ++ replicate (30 - length str) ' '
+    hFlush stdout
+    oks <- forM [1..n] $ \i -> testAction
+    let ok = and oks
+    case ok of
+      True  -> putStrLn $ "ok (passed " ++ show n ++ " tests)"
+      False -> putStrLn $ "FAILED!! (FAILED " ++ show (countFalses oks) ++ " tests!)"
+    return ok
+  where
+    countFalses :: [Bool] -> Int
+    countFalses = length . filter (==False)
+
+--------------------------------------------------------------------------------
+
+data SpecificProp f g
+  = SpecificProp1  (     g -> Bool) String
+  | SpecificPropF1 (f -> g -> Bool) String
+  | SpecificPropIO (IO Bool       ) String
+
+--------------------------------------------------------------------------------
+-- * properties
+
+specificPropsG1_BN128 :: [SpecificProp BN128.Fr.Fr BN128.G1.G1]
+specificPropsG1_BN128 =
+  [ SpecificPropF1 (prop_glv_vs_scl BN128.G1.sclFrGLV BN128.G1.sclFr)  "GLV vs. scale"
+  , SpecificProp1  (prop_glv_edge   BN128.G1.sclFrGLV BN128.G1.sclFr)  "GLV edge cases"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BN128.G1.G1))             "ifft . fft == id"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BN128.G1.Jac.G1))         "ifft . fft == id (jac)"
+  , SpecificPropF1 (prop_scl_gen  BN128.G1.sclGen BN128.G1.sclFr BN128.G1.genG1)  "sclGen vs. scale"
+  , SpecificPropF1 (prop_scl_comb BN128.G1.combTable BN128.G1.sclComb BN128.G1.sclFr)  "sclComb vs. scale"
+  , SpecificPropF1 (prop_scl_ct   BN128.G1.sclFrCT BN128.G1.sclFr)     "sclFrCT vs. scale"
+  , SpecificPropIO (prop_srs_monomial BN128.G1.srsMonomial (Proxy @BN128.G1.G1))  "srsMonomial vs. scale"
+  , SpecificPropIO (prop_srs_lagrange BN128.G1.srsMonomial BN128.G1.srsLagrange BN128.G1.srsToLagrange (Proxy @BN128.G1.G1))  "srsLagrange vs. convert"
+  ]
+
+specificPropsG2_BN128 :: [SpecificProp BN128.Fr.Fr BN128.G2.G2]
+specificPropsG2_BN128 =
+  [ SpecificPropIO (prop_fft_inverse (Proxy @BN128.G2.G2))             "ifft . fft == id"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BN128.G2.Jac.G2))         "ifft . fft == id (jac)"
+  , SpecificPropF1 (prop_scl_gen  BN128.G2.sclGen BN128.G2.sclFr BN128.G2.genG2)  "sclGen vs. scale"
+  , SpecificPropF1 (prop_scl_comb BN128.G2.combTable BN128.G2.sclComb BN128.G2.sclFr)  "sclComb vs. scale"
+  , SpecificPropF1 (prop_scl_ct   BN128.G2.sclFrCT BN128.G2.sclFr)     "sclFrCT vs. scale"
+  , SpecificPropIO (prop_srs_monomial BN128.G2.srsMonomial (Proxy @BN128.G2.G2))  "srsMonomial vs. scale"
+  , SpecificPropIO (prop_srs_lagrange BN128.G2.srsMonomial BN128.G2.srsLagrange BN128.G2.srsToLagrange (Proxy @BN128.G2.G2))  "srsLagrange vs. convert"
+  , SpecificPropIO (prop_raw_not_in_subgroup BN128.Fp2.squareRoot BN128.G2.curveB BN128.G2.isInSubgroup)  "raw point not in subgroup"
+  , SpecificPropIO (prop_clear_cofactor BN128.Fp2.squareRoot BN128.G2.curveB BN128.G2.clearCofactor heffG2_BN128)  "clearCofactor vs. scale"
+  , SpecificPropIO (prop_clear_cofactor_subgroup BN128.Fp2.squareRoot BN128.G2.curveB BN128.G2.isInSubgroup BN128.G2.clearCofactor)  "clearCofactor in subgroup"
+  ]
+
+specificPropsG1_BLS12_381 :: [SpecificProp BLS12_381.Fr.Fr BLS12_381.G1.G1]
+specificPropsG1_BLS12_381 =
+  [ SpecificPropF1 (prop_glv_vs_scl BLS12_381.G1.sclFrGLV BLS12_381.G1.sclFr)  "GLV vs. scale"
+  , SpecificProp1  (prop_glv_edge   BLS12_381.G1.sclFrGLV BLS12_381.G1.sclFr)  "GLV edge cases"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BLS12_381.G1.G1))                 "ifft . fft == id"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BLS12_381.G1.Jac.G1))             "ifft . fft == id (jac)"
+  , SpecificPropF1 (prop_scl_gen  BLS12_381.G1.sclGen BLS12_381.G1.sclFr BLS12_381.G1.genG1)  "sclGen vs. scale"
+  , SpecificPropF1 (prop_scl_comb BLS12_381.G1.combTable BLS12_381.G1.sclComb BLS12_381.G1.sclFr)  "sclComb vs. scale"
+  , SpecificPropF1 (prop_scl_ct   BLS12_381.G1.sclFrCT BLS12_381.G1.sclFr)     "sclFrCT vs. scale"
+  , SpecificPropIO (prop_srs_monomial BLS12_381.G1.srsMonomial (Proxy @BLS12_381.G1.G1))  "srsMonomial vs. scale"
+  , SpecificPropIO (prop_srs_lagrange BLS12_381.G1.srsMonomial BLS12_381.G1.srsLagrange BLS12_381.G1.srsToLagrange (Proxy @BLS12_381.G1.G1))  "srsLagrange vs. convert"
+  , SpecificPropIO (prop_raw_not_in_subgroup BLS12_381.Fp.squareRoot (fromInteger BLS12_381.G1.curveB) BLS12_381.G1.isInSubgroup)  "raw point not in subgroup"
+  , SpecificPropIO (prop_clear_cofactor BLS12_381.Fp.squareRoot (fromInteger BLS12_381.G1.curveB) BLS12_381.G1.clearCofactor heffG1_BLS12_381)  "clearCofactor vs. scale"
+  , SpecificPropIO (prop_clear_cofactor_subgroup BLS12_381.Fp.squareRoot (fromInteger BLS12_381.G1.curveB) BLS12_381.G1.isInSubgroup BLS12_381.G1.clearCofactor)  "clearCofactor in subgroup"
+  ]
+
+specificPropsG2_BLS12_381 :: [SpecificProp BLS12_381.Fr.Fr BLS12_381.G2.G2]
+specificPropsG2_BLS12_381 =
+  [ SpecificPropIO (prop_fft_inverse (Proxy @BLS12_381.G2.G2))                 "ifft . fft == id"
+  , SpecificPropIO (prop_fft_inverse (Proxy @BLS12_381.G2.Jac.G2))             "ifft . fft == id (jac)"
+  , SpecificPropF1 (prop_scl_gen  BLS12_381.G2.sclGen BLS12_381.G2.sclFr BLS12_381.G2.genG2)  "sclGen vs. scale"
+  , SpecificPropF1 (prop_scl_comb BLS12_381.G2.combTable BLS12_381.G2.sclComb BLS12_381.G2.sclFr)  "sclComb vs. scale"
+  , SpecificPropF1 (prop_scl_ct   BLS12_381.G2.sclFrCT BLS12_381.G2.sclFr)     "sclFrCT vs. scale"
+  , SpecificPropIO (prop_srs_monomial BLS12_381.G2.srsMonomial (Proxy @BLS12_381.G2.G2))  "srsMonomial vs. scale"
+  , SpecificPropIO (prop_srs_lagrange BLS12_381.G2.srsMonomial BLS12_381.G2.srsLagrange BLS12_381.G2.srsToLagrange (Proxy @BLS12_381.G2.G2))  "srsLagrange vs. convert"
+  , SpecificPropIO (prop_raw_not_in_subgroup BLS12_381.Fp2.squareRoot BLS12_381.G2.curveB BLS12_381.G2.isInSubgroup)  "raw point not in subgroup"
+  , SpecificPropIO (prop_clear_cofactor BLS12_381.Fp2.squareRoot BLS12_381.G2.curveB BLS12_381.G2.clearCofactor heffG2_BLS12_381)  "clearCofactor vs. scale"
+  , SpecificPropIO (prop_clear_cofactor_subgroup BLS12_381.Fp2.squareRoot BLS12_381.G2.curveB BLS12_381.G2.isInSubgroup BLS12_381.G2.clearCofactor)  "clearCofactor in subgroup"
+  ]
+
+--------------------------------------------------------------------------------
+-- * GLV
+
+prop_glv_vs_scl :: Eq g => (f -> g -> g) -> (f -> g -> g) -> f -> g -> Bool
+prop_glv_vs_scl glv scl k x = glv k x == scl k x
+
+-- | Scalars 0, 1, -1 and the point at infinity
+prop_glv_edge :: (Group g, Field f) => (f -> g -> g) -> (f -> g -> g) -> g -> Bool
+prop_glv_edge glv scl x = and
+  [ glv k y == scl k y | k <- [ zero , one , negate one ] , y <- [ x , grpUnit ] ]
+
+--------------------------------------------------------------------------------
+-- * fixed-base scaling
+
+-- | Scaling the generator with the precomputed table (also with scalars 0, 1, -1)
+prop_scl_gen :: (Eq g, Field f) => (f -> g) -> (f -> g -> g) -> g -> f -> g -> Bool
+prop_scl_gen sclGen scl gen k _ = and
+  [ sclGen l == scl l gen | l <- [ k , zero , one , negate one ] ]
+
+-- | Comb scaling of an arbitrary point, and of the point at infinity
+prop_scl_comb :: (Group g, Field f) => (g -> t) -> (t -> f -> g) -> (f -> g -> g) -> f -> g -> Bool
+prop_scl_comb table comb scl k x = and
+  [ comb (table y) l == scl l y | l <- [ k , zero , one , negate one ] , y <- [ x , grpUnit ] ]
+
+--------------------------------------------------------------------------------
+-- * constant-time scaling
+
+-- | Constant-time scaling agrees with the default one (also with scalars 0, 1, -1
+-- and the point at infinity)
+prop_scl_ct :: (Group g, Field f) => (f -> g -> g) -> (f -> g -> g) -> f -> g -> Bool
+prop_scl_ct sclCT scl k x = and
+  [ sclCT l y == scl l y | l <- [ k , zero , one , negate one ] , y <- [ x , grpUnit ] ]
+
+--------------------------------------------------------------------------------
+-- * trusted setup
+
+-- | @srsMonomial n tau@ is @[ tau^i * gen | i <- [0..n-1] ]@ (computed here by
+-- iterated scaling)
+prop_srs_monomial
+  :: forall g. ProjCurve g
+  => (Int -> ScalarField g -> FlatArray (AffinePoint g)) -> Proxy g -> IO Bool
+prop_srs_monomial srsMonomial _ = do
+  n   <- randomRIO (1,20)
+  tau <- rndIO @(ScalarField g)
+  let xs = take n $ iterate (scalarMul tau) (curveSubgroupGen :: g)
+  return (unpackFlatArrayToList (srsMonomial n tau) == map toAffine xs)
+
+-- | The Lagrange basis setup generated directly is the same as the converted
+-- monomial one: @srsLagrange sg == srsToLagrange sg . srsMonomial n@
+prop_srs_lagrange
+  :: forall g. (ProjCurve g, FFTField (ScalarField g))
+  => (Int -> ScalarField g -> FlatArray (AffinePoint g))
+  -> (FFTSubgroup (ScalarField g) -> ScalarField g -> FlatArray (AffinePoint g))
+  -> (FFTSubgroup (ScalarField g) -> FlatArray (AffinePoint g) -> FlatArray (AffinePoint g))
+  -> Proxy g -> IO Bool
+prop_srs_lagrange srsMonomial srsLagrange srsToLagrange _ = do
+  m   <- randomRIO (0,4)
+  tau <- rndIO @(ScalarField g)
+  let sg  = getFFTSubgroup (Log2 m) :: FFTSubgroup (ScalarField g)
+  let ys1 = unpackFlatArrayToList (srsLagrange sg tau)
+  let ys2 = unpackFlatArrayToList (srsToLagrange sg (srsMonomial (2^m) tau))
+  return (ys1 == ys2)
+
+--------------------------------------------------------------------------------
+-- * subgroup check and cofactor clearing
+
+-- | The effective cofactors @h_eff@ of RFC 9380 (on BN254 G2 this is the cofactor itself)
+heffG1_BLS12_381, heffG2_BLS12_381, heffG2_BN128 :: Integer
+heffG1_BLS12_381 = 0xd201000000010001
+heffG2_BLS12_381 = 0x0bc69f08f2ee75b3584c6a0ea91b352888e2a8e9145ad7689986ff031508ffe1329c2f178731db956d82bf015d1212b02ec0ec69d7477c1ae954cbc06689f6a359894c0adebbf6b4e8020005aaa95551
+heffG2_BN128     = BN128.G2.cofactor
+
+-- | A random point of the whole curve @y^2 = x^3 + b@ (so in general not in the
+-- subgroup), from a random @x@ coordinate
+rndCurvePoint :: forall g. ProjCurve g => (BaseField g -> Maybe (BaseField g)) -> BaseField g -> IO g
+rndCurvePoint squareRoot b = do
+  x <- rndIO @(BaseField g)
+  case squareRoot (x*x*x + b) of
+    Just y  -> return (mkPoint3 (x,y,1))
+    Nothing -> rndCurvePoint squareRoot b
+
+-- | A point outside the subgroup is rejected (the cofactor is big, so a random
+-- curve point is in the subgroup only with negligible probability)
+prop_raw_not_in_subgroup
+  :: forall g. ProjCurve g
+  => (BaseField g -> Maybe (BaseField g)) -> BaseField g -> (g -> Bool) -> IO Bool
+prop_raw_not_in_subgroup squareRoot b isInSubgroup = do
+  p <- rndCurvePoint @g squareRoot b
+  return (isOnCurve p && not (isInSubgroup p))
+
+-- | @clearCofactor p == scale h_eff p@
+prop_clear_cofactor
+  :: forall g. ProjCurve g
+  => (BaseField g -> Maybe (BaseField g)) -> BaseField g -> (g -> g) -> Integer -> IO Bool
+prop_clear_cofactor squareRoot b clearCofactor heff = do
+  p <- rndCurvePoint @g squareRoot b
+  return (clearCofactor p == grpScale heff p)
+
+-- | @isInSubgroup (clearCofactor p)@
+prop_clear_cofactor_subgroup
+  :: forall g. ProjCurve g
+  => (BaseField g -> Maybe (BaseField g)) -> BaseField g -> (g -> Bool) -> (g -> g) -> IO Bool
+prop_clear_cofactor_subgroup squareRoot b isInSubgroup clearCofactor = do
+  p <- rndCurvePoint @g squareRoot b
+  return (isInSubgroup (clearCofactor p))
+
+--------------------------------------------------------------------------------
+-- * group FFT
+
+-- | @curveIFFT . curveFFT == id@ and @curveFFT . curveIFFT == id@, on random
+-- points of the subgroup (the FFT is only well-defined there)
+prop_fft_inverse :: forall g. (Curve g, FFTField (ScalarField g)) => Proxy g -> IO Bool
+prop_fft_inverse _ = do
+  m  <- randomRIO (0,5)
+  let n  = 2^m
+  xs <- replicateM n (rndIO @g)
+  let sg  = getFFTSubgroup (Log2 m) :: FFTSubgroup (ScalarField g)
+  let arr = packFlatArrayFromList' n xs
+  let ys1 = unpackFlatArrayToList (curveIFFT sg (curveFFT  sg arr))
+  let ys2 = unpackFlatArrayToList (curveFFT  sg (curveIFFT sg arr))
+  return (ys1 == xs && ys2 == xs)
+
+--------------------------------------------------------------------------------
+
@@ -199,6 +199,8 @@ ringProps =
   , RingProp1 prop_power_3                     "3-th power"
   , RingProp1 prop_power_4                     "4-th power"
   , RingProp1 prop_power_5                     "5-th power"
+  , RingProp1 prop_power_add_big               "big power additive"
+  , RingProp1 prop_power_mul_big               "big power multiplicative"
   ]
 
 fieldOnlyProps :: [FieldProp]
@@ -336,6 +338,17 @@ prop_power_4 x = power x 4 == x*x*x*x
 prop_power_5 :: Ring a => a -> Bool
 prop_power_5 x = power x 5 == x*x*x*x*x
 
+-- | large exponents (these exercise the windowed exponentiation)
+bigExpo1, bigExpo2 :: Integer
+bigExpo1 = 3^(150::Int) + 12345
+bigExpo2 = 2^(200::Int) - 1
+
+prop_power_add_big :: Ring a => a -> Bool
+prop_power_add_big x = power x (bigExpo1 + bigExpo2) == power x bigExpo1 * power x bigExpo2
+
+prop_power_mul_big :: Ring a => a -> Bool
+prop_power_mul_big x = power (power x bigExpo1) 1000003 == power x (bigExpo1 * 1000003)
+
 --------------------------------------------------------------------------------
 -- * Field properties
 
@@ -1,7 +1,7 @@
 
 -- | Property tests for (univariate) polynomials
 
-{-# LANGUAGE ScopedTypeVariables, Rank2Types, TypeApplications #-}
+{-# LANGUAGE ScopedTypeVariables, Rank2Types, TypeApplications, FlexibleContexts #-}
 module ZK.Test.Poly.Properties where
 
 --------------------------------------------------------------------------------
@@ -58,6 +58,14 @@ runPolyTests n pxy = do
       xs <- replicateM 7 $ rndIO @(Coeff a)
       return (test (Proxy @a) xs) 
 
+-- | Tests for polynomials in evaluation form
+runEvalFormTests :: forall l. (EvaluationForm l, Eq l) => Int -> Proxy l -> IO ()
+runEvalFormTests n pxy = do
+
+  forM_ evalFormProps $ \(EvalFormProp test name) -> doTests n name $ do
+    xs <- replicateM 7 $ rndIO @(Coeff (CoeffForm l))
+    return (test pxy xs) 
+
 --------------------------------------------------------------------------------
 
 doTests :: Int -> String -> IO Bool -> IO Bool
@@ -86,6 +94,9 @@ data PolyProp
   | PolyPropFF  (forall a. Univariate    a  => Proxy a -> Coeff a -> Coeff a -> Bool) String
   | PolyPropFFT (forall a. UnivariateFFT a  => Proxy a -> [Coeff a] -> Bool) String
 
+data EvalFormProp
+  = EvalFormProp (forall l. (EvaluationForm l, Eq l) => Proxy l -> [Coeff (CoeffForm l)] -> Bool) String
+
 --------------------------------------------------------------------------------
 
 genericRingProps :: [PolyProp]
@@ -127,6 +138,7 @@ specificPolyProps =
   , PolyPropF1 prop_scale_by_minus_one  "scale by -1" 
   , PolyProp2  prop_mul_vs_ref          "mul vs. reference" 
   , PolyPropF1 prop_eval_vs_ref         "evalAt vs. reference"
+  , PolyPropF1 prop_eval_many_vs_eval   "evalManyAt vs. evalAt"
   , PolyProp1  prop_const_term          "constTerm"
   , PolyPropFF prop_mbConst             "mbConst"
   , PolyProp1  prop_kthCoeff            "kthCoeff"
@@ -139,6 +151,11 @@ specificPolyProps =
   , PolyPropFFT prop_ntt_then_intt      "intt . ntt == id"
   , PolyPropFFT prop_intt_then_ntt      "ntt . intt == id"
   , PolyPropFFT prop_ntt_vs_eval        "ntt vs. evalAt"
+  , PolyPropFFT prop_mul_large_vs_ref   "mul vs. ref. (large)"
+  , PolyPropFFT prop_longdiv_large      "long division (large)"
+  , PolyPropFFT prop_eval_large_vs_ref  "evalAt vs. ref. (large)"
+  , PolyPropFFT prop_multi_eval_vs_eval "multiEval vs. evalAt"
+  , PolyPropFFT prop_interpolate        "interpolate . multiEval"
   ]
 
 --------------------------------------------------------------------------------
@@ -309,6 +326,10 @@ prop_mul_vs_ref p q = (p * q == mulRef p q)
 prop_eval_vs_ref :: Univariate p => Coeff p -> p -> Bool
 prop_eval_vs_ref x p = (evalAt x p == evalRef x p)
 
+prop_eval_many_vs_eval :: Univariate p => Coeff p -> p -> Bool
+prop_eval_many_vs_eval x p = evalManyAt x ps == map (evalAt x) ps where
+  ps = [ p , p*p , p + 1 , 0 , scale x p ]
+
 prop_const_term :: Univariate p => p -> Bool
 prop_const_term p = constTermOf p == kthCoeff 0 p
 
@@ -391,3 +412,81 @@ prop_ntt_vs_eval _pxy input = (us == vs) where
   vs    = [ evalAt x poly | x <- enumerateSubgroup sg ]  :: [Coeff p]
 
 --------------------------------------------------------------------------------
+
+-- | Large polynomials, so that the NTT-based algorithms are also exercised
+largePoly :: forall p. Univariate p => Int -> Int -> [Coeff p] -> p
+largePoly k n input = mkPoly cs where
+  cs = take n $ drop k $ zipWith (*) (cycle input) someNumbers
+
+prop_mul_large_vs_ref :: forall p. UnivariateFFT p => Proxy p -> [Coeff p] -> Bool
+prop_mul_large_vs_ref _pxy input = (p * q == mulRef p q) where
+  p = largePoly 0  100 input :: p
+  q = largePoly 13  80 input :: p
+
+prop_longdiv_large :: forall p. UnivariateFFT p => Proxy p -> [Coeff p] -> Bool
+prop_longdiv_large _pxy input = (degree r < degree q) && (p == q*d + r) where
+  p     = largePoly 0  2100 input :: p
+  q     = largePoly 17 1000 input :: p
+  (d,r) = polyLongDiv p q
+
+-- | This is large enough so that the evaluation is done in parallel chunks
+prop_eval_large_vs_ref :: forall p. UnivariateFFT p => Proxy p -> [Coeff p] -> Bool
+prop_eval_large_vs_ref _pxy input = (evalAt x poly == ref) where
+  poly = largePoly 3 20000 input                                         :: p
+  x    = head input + 5                                                  :: Coeff p
+  ref  = foldl' (+) 0 $ zipWith (*) (coeffs poly) (iterate (*x) 1)
+
+-- | Points for the multipoint evaluation tests
+somePoints :: forall f. Field f => Int -> [f] -> [f]
+somePoints n input = take n $ zipWith (+) (cycle input) (drop 3 someNumbers)
+
+prop_multi_eval_vs_eval :: forall p. UnivariateFFT p => Proxy p -> [Coeff p] -> Bool
+prop_multi_eval_vs_eval _pxy input = (us == vs) where
+  poly = largePoly 0 90 input                                            :: p
+  xs   = somePoints 70 input                                             :: [Coeff p]
+  us   = unpackFlatArrayToList $ polyMultiEval (packFlatArrayFromList xs) poly
+  vs   = [ evalAt x poly | x <- xs ]
+
+prop_interpolate :: forall p. UnivariateFFT p => Proxy p -> [Coeff p] -> Bool
+prop_interpolate _pxy input = (polyInterpolate xarr yarr == poly) where
+  poly = largePoly 5 70 input                                            :: p
+  xarr = packFlatArrayFromList (somePoints 70 input)                     :: FlatArray (Coeff p)
+  yarr = polyMultiEval xarr poly                                         :: FlatArray (Coeff p)
+
+--------------------------------------------------------------------------------
+
+evalFormProps :: [EvalFormProp]
+evalFormProps =
+  [ EvalFormProp prop_evalform_roundtrip  "toCoeff . fromCoeff == id"
+  , EvalFormProp prop_evalform_at_vs_ref  "evalFormAt vs. evalAt"
+  , EvalFormProp prop_evalform_at_domain  "evalFormAt on the domain"
+  , EvalFormProp prop_evalform_mul        "evalFormMul vs. poly mul"
+  ]
+
+prop_evalform_roundtrip :: forall l. (EvaluationForm l, Eq l) => Proxy l -> [Coeff (CoeffForm l)] -> Bool
+prop_evalform_roundtrip _pxy input = (toCoeffForm lpoly == poly) where
+  poly  = largePoly 0 27 input           :: CoeffForm l
+  lpoly = fromCoeffForm (Log2 5) poly    :: l
+
+prop_evalform_at_vs_ref :: forall l. (EvaluationForm l, Eq l) => Proxy l -> [Coeff (CoeffForm l)] -> Bool
+prop_evalform_at_vs_ref _pxy input = (evalFormAt x lpoly == evalAt x poly) where
+  poly  = largePoly 3 32 input           :: CoeffForm l
+  lpoly = fromCoeffForm (Log2 5) poly    :: l
+  x     = head input + 7
+
+prop_evalform_at_domain :: forall l. (EvaluationForm l, Eq l) => Proxy l -> [Coeff (CoeffForm l)] -> Bool
+prop_evalform_at_domain _pxy input = (us == vs) where
+  poly  = largePoly 1 30 input           :: CoeffForm l
+  lpoly = fromCoeffForm (Log2 5) poly    :: l
+  xs    = enumerateSubgroup (getFFTSubgroup (Log2 5))
+  us    = [ evalFormAt x lpoly | x <- xs ]
+  vs    = unpackFlatArrayToList (unwrapArray lpoly)
+
+prop_evalform_mul :: forall l. (EvaluationForm l, Eq l) => Proxy l -> [Coeff (CoeffForm l)] -> Bool
+prop_evalform_mul _pxy input = (toCoeffForm (evalFormMul lp lq) == p * q) where
+  p  = largePoly 0  15 input             :: CoeffForm l
+  q  = largePoly 11 17 input             :: CoeffForm l
+  lp = fromCoeffForm (Log2 5) p          :: l
+  lq = fromCoeffForm (Log2 5) q          :: l
+
+--------------------------------------------------------------------------------
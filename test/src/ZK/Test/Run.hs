@@ -12,10 +12,13 @@ import ZK.Algebra.Class.Curve
 import ZK.Test.Platform.Properties  ( runPlatformTests )
 import ZK.Test.Field.Properties ( runRingTests  , runFieldTests , runExtFieldTests )
 import ZK.Test.Curve.Properties ( runGroupTests , runCurveTests , runProjCurveTests )
-import ZK.Test.Poly.Properties  ( runPolyTests )
+import ZK.Test.Poly.Properties  ( runPolyTests , runEvalFormTests )
 import ZK.Test.Field.Ref_BN254     ( runTests_compare_BN254     )
 import ZK.Test.Field.Ref_BLS12_381 ( runTests_compare_BLS12_381 )
 import ZK.Test.Curve.Pairings ( runTestsPairing_BN128 , runTestsPairing_BLS12_381 )
+import ZK.Test.Curve.KZG      ( runTestsKZG_BN128 , runTestsKZG_BLS12_381 )
+import ZK.Test.Curve.HashToCurve ( runHashToCurveTests )
+import ZK.Test.Curve.Specific ( runTestsSpecificG1_BN128 , runTestsSpecificG1_BLS12_381 , runTestsSpecificG2_BN128 , runTestsSpecificG2_BLS12_381 )
 
 import qualified ZK.Algebra.BigInt.Platform            as Platform
 
@@ -45,16 +48,20 @@ import qualified ZK.Algebra.Curves.BN128.G1.Proj       as BN128_G1_Proj
 import qualified ZK.Algebra.Curves.BN128.G1.Jac        as BN128_G1_Jac
 import qualified ZK.Algebra.Curves.BN128.G1.Affine     as BN128_G1_Affine
 import qualified ZK.Algebra.Curves.BN128.G2.Proj       as BN128_G2_Proj
+import qualified ZK.Algebra.Curves.BN128.G2.Jac        as BN128_G2_Jac
 import qualified ZK.Algebra.Curves.BN128.G2.Affine     as BN128_G2_Affine
 
 import qualified ZK.Algebra.Curves.BLS12_381.G1.Proj   as BLS12_381_G1_Proj
 import qualified ZK.Algebra.Curves.BLS12_381.G1.Jac    as BLS12_381_G1_Jac
 import qualified ZK.Algebra.Curves.BLS12_381.G1.Affine as BLS12_381_G1_Affine
 import qualified ZK.Algebra.Curves.BLS12_381.G2.Proj   as BLS12_381_G2_Proj
+import qualified ZK.Algebra.Curves.BLS12_381.G2.Jac    as BLS12_381_G2_Jac
 import qualified ZK.Algebra.Curves.BLS12_381.G2.Affine as BLS12_381_G2_Affine
 
 import qualified ZK.Algebra.Curves.BN128.Poly          as BN128_Poly
 import qualified ZK.Algebra.Curves.BLS12_381.Poly      as BLS12_381_Poly
+import qualified ZK.Algebra.Curves.BN128.Poly.Lagrange     as BN128_Lagrange
+import qualified ZK.Algebra.Curves.BLS12_381.Poly.Lagrange as BLS12_381_Lagrange
 
 --------------------------------------------------------------------------------
 
@@ -77,8 +84,10 @@ runTestsAll n = do
   runTestsAffineCurve   n
   runTestsJacCurve      n
   runTestsProjCurveG2   n
+  runTestsJacCurveG2    n
   runTestsAffineCurveG2 n
   runTestsPairings      n
+  runTestsHashToCurve   n
   runTestsPolys         n
   runTestsCompare       n
 
@@ -105,9 +114,22 @@ runTestsPolys n = do
   printHeader "running tests for BLS12-381/Poly"
   runPolyTests n (Proxy @BLS12_381_Poly.Poly)
 
+  printHeader "running tests for BLS12-381/Poly/Lagrange"
+  runEvalFormTests n (Proxy @BLS12_381_Lagrange.EvalPoly)
+
   printHeader "running tests for BN128/Poly"
   runPolyTests n (Proxy @BN128_Poly.Poly)
 
+  printHeader "running tests for BN128/Poly/Lagrange"
+  runEvalFormTests n (Proxy @BN128_Lagrange.EvalPoly)
+
+----------------------------------------
+
+runTestsHashToCurve :: Int -> IO ()
+runTestsHashToCurve n = do
+  printHeader "running tests for hashing to curves"
+  runHashToCurveTests n
+
 ----------------------------------------
 
 runTestsPairings :: Int -> IO ()
@@ -119,6 +141,12 @@ runTestsPairings n = do
   printHeader "running tests for BN128/Pairing"
   runTestsPairing_BN128 n
 
+  printHeader "running tests for BLS12-381/KZG"
+  runTestsKZG_BLS12_381 n
+
+  printHeader "running tests for BN128/KZG"
+  runTestsKZG_BN128 n
+
   -- printHeader "running tests for BLS12-381/Pairing"
   -- runPairingTests n (Proxy @BLS12_381.G1) (Proxy @BLS12_381.G2)
 
@@ -133,18 +161,30 @@ runTestsProjCurve n = do
   printHeader "running tests for BLS12-381/G1/Proj"
   runProjCurveTests n (Proxy @BLS12_381_G1_Proj.G1)
 
+  printHeader "running curve-specific tests for BLS12-381/G1"
+  runTestsSpecificG1_BLS12_381 n
+
   printHeader "running tests for BN128/G1/Proj"
   runProjCurveTests n (Proxy @BN128_G1_Proj.G1)
 
+  printHeader "running curve-specific tests for BN128/G1"
+  runTestsSpecificG1_BN128 n
+
 runTestsProjCurveG2 :: Int -> IO ()
 runTestsProjCurveG2 n = do
 
   printHeader "running tests for BLS12-381/G2/Proj"
   runProjCurveTests n (Proxy @BLS12_381_G2_Proj.G2)
 
+  printHeader "running curve-specific tests for BLS12-381/G2"
+  runTestsSpecificG2_BLS12_381 n
+
   printHeader "running tests for BN128/G2/Proj"
   runProjCurveTests n (Proxy @BN128_G2_Proj.G2)
 
+  printHeader "running curve-specific tests for BN128/G2"
+  runTestsSpecificG2_BN128 n
+
 ----------------------------------------
 
 runTestsJacCurve :: Int -> IO ()
@@ -156,6 +196,15 @@ runTestsJacCurve n = do
   printHeader "running tests for BN128/G1/Jac"
   runProjCurveTests n (Proxy @BN128_G1_Jac.G1)
 
+runTestsJacCurveG2 :: Int -> IO ()
+runTestsJacCurveG2 n = do
+
+  printHeader "running tests for BLS12-381/G2/Jac"
+  runProjCurveTests n (Proxy @BLS12_381_G2_Jac.G2)
+
+  printHeader "running tests for BN128/G2/Jac"
+  runProjCurveTests n (Proxy @BN128_G2_Jac.G2)
+
 ----------------------------------------
 
 runTestsAffineCurve :: Int -> IO ()